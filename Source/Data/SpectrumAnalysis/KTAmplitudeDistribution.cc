@@ -9,6 +9,8 @@
 
 #include "KTLogger.hh"
 
+#include <algorithm>
+
 namespace Katydid
 {
     KTLOGGER(datalog, "KTAmplitudeDistribution");
@@ -17,92 +19,297 @@ namespace Katydid
 
     KTAmplitudeDistribution::KTAmplitudeDistribution() :
             KTExtensibleData< KTAmplitudeDistribution >(),
-            fDistributions(1, ComponentDistributions(1, NULL))
+            fDistributions(),
+            fNFreqBins(0),
+            fNDistBins(0),
+            fRowStride(0)
     {
+        InitializeNull(1, 1);
     }
 
     KTAmplitudeDistribution::~KTAmplitudeDistribution()
     {
-        ClearDistributions();
     }
 
     void KTAmplitudeDistribution::SetDistValue(double value, unsigned freqBin, unsigned iDistBin, unsigned component)
     {
 #ifdef Katydid_DEBUG
-        if (component > fDistributions.size())
+        if (component >= fDistributions.size())
         {
             KTERROR(datalog, "Data does not contain component " << component);
             return;
         }
-        if (freqBin > fDistributions[component].size() || fDistributions[component][freqBin] == NULL)
+        if (freqBin >= fNFreqBins || iDistBin >= fNDistBins)
         {
-            KTERROR(datalog, "Data does not contain frequency bin " << freqBin << " for component " << component << ", or it hasn't been initialized");
+            KTERROR(datalog, "Data does not contain frequency bin " << freqBin << " and dist bin " << iDistBin << " for component " << component << ", or it hasn't been initialized");
             return;
         }
 #endif
-        (*fDistributions[component][freqBin])(iDistBin) = value;
+        fDistributions[component].fCounts[size_t(freqBin) * fRowStride + iDistBin] = value;
         return;
     }
 
     void KTAmplitudeDistribution::AddToDist(unsigned freqBin, unsigned iDistBin, unsigned component, double weight)
     {
 #ifdef Katydid_DEBUG
-        if (component > fDistributions.size())
+        if (component >= fDistributions.size())
         {
             KTERROR(datalog, "Data does not contain component " << component);
             return;
         }
-        if (freqBin > fDistributions[component].size() || fDistributions[component][freqBin] == NULL)
+        if (freqBin >= fNFreqBins || iDistBin >= fNDistBins)
         {
-            KTERROR(datalog, "Data does not contain frequency bin " << freqBin << " for component " << component << ", or it hasn't been initialized");
+            KTERROR(datalog, "Data does not contain frequency bin " << freqBin << " and dist bin " << iDistBin << " for component " << component << ", or it hasn't been initialized");
             return;
         }
-        if (iDistBin > fDistributions[component][freqBin]->size())
+#endif
+        fDistributions[component].fCounts[size_t(freqBin) * fRowStride + iDistBin] += weight;
+        return;
+    }
+
+    void KTAmplitudeDistribution::AddToDist(unsigned freqBin, double distValue, unsigned component, double weight)
+    {
+#ifdef Katydid_DEBUG
+        if (component >= fDistributions.size())
         {
-            KTERROR(datalog, "Data does not contain dist bin " << iDistBin);
+            KTERROR(datalog, "Data does not contain component " << component);
+            return;
+        }
+        if (freqBin >= fNFreqBins || fNDistBins == 0)
+        {
+            KTERROR(datalog, "Data does not contain frequency bin " << freqBin << " for component " << component << ", or it hasn't been initialized");
             return;
         }
 #endif
-        (*fDistributions[component][freqBin])(iDistBin) = (*fDistributions[component][freqBin])(iDistBin) + weight;
+        AddToDist(freqBin, FindDistBin(distValue, freqBin, component), component, weight);
         return;
     }
 
-    void KTAmplitudeDistribution::AddToDist(unsigned freqBin, double distValue, unsigned component, double weight)
+    void KTAmplitudeDistribution::AddToDists(const double* values, unsigned firstFreqBin, unsigned nValues, unsigned component, double weight)
     {
 #ifdef Katydid_DEBUG
-        if (component > fDistributions.size())
+        if (component >= fDistributions.size())
         {
             KTERROR(datalog, "Data does not contain component " << component);
             return;
         }
-        if (freqBin > fDistributions[component].size() || fDistributions[component][freqBin] == NULL)
+        if (firstFreqBin + nValues > fNFreqBins || fNDistBins == 0)
         {
-            KTERROR(datalog, "Data does not contain frequency bin " << freqBin << " for component " << component << ", or it hasn't been initialized");
+            KTERROR(datalog, "Data does not contain frequency bins [" << firstFreqBin << ", " << firstFreqBin + nValues << ") for component " << component << ", or it hasn't been initialized");
             return;
         }
 #endif
-        AddToDist(freqBin, unsigned(fDistributions[component][freqBin]->FindBin(distValue)), component, weight);
+        ComponentDistributions& dists = fDistributions[component];
+        const double* distMin = dists.fDistMin.data() + firstFreqBin;
+        const double* invDistBinWidth = dists.fInvDistBinWidth.data() + firstFreqBin;
+        double* counts = dists.fCounts.data() + size_t(firstFreqBin) * fRowStride;
+        const size_t rowStride = fRowStride;
+        const double lastBin = double(fNDistBins - 1);
+
+        // The values are handled in blocks: first the distribution bins for the whole block are calculated,
+        // which vectorizes, and then the counts are incremented.
+        // Each frequency bin has its own row, so the increments within a block never touch the same element.
+        unsigned distBins[sFillBlockSize];
+        for (unsigned blockStart = 0; blockStart < nValues; blockStart += sFillBlockSize)
+        {
+            const unsigned blockSize = nValues - blockStart < sFillBlockSize ? nValues - blockStart : sFillBlockSize;
+            const double* blockValues = values + blockStart;
+            const double* blockDistMin = distMin + blockStart;
+            const double* blockInvWidth = invDistBinWidth + blockStart;
+            double* blockCounts = counts + blockStart * rowStride;
+
+#pragma omp simd
+            for (unsigned iValue = 0; iValue < blockSize; ++iValue)
+            {
+                distBins[iValue] = CalculateDistBin(blockValues[iValue], blockDistMin[iValue], blockInvWidth[iValue], lastBin);
+            }
+
+#pragma omp simd
+            for (unsigned iValue = 0; iValue < blockSize; ++iValue)
+            {
+                blockCounts[iValue * rowStride + distBins[iValue]] += weight;
+            }
+        }
         return;
     }
 
+    bool KTAmplitudeDistribution::ClearDistributions()
+    {
+        fDistributions.clear();
+        fNFreqBins = 0;
+        fNDistBins = 0;
+        fRowStride = 0;
+        return true;
+    }
+
+    bool KTAmplitudeDistribution::InitializeNull(unsigned nComponents, unsigned nFreqBins)
+    {
+        ClearDistributions();
+        fNFreqBins = nFreqBins;
+        fDistributions.resize(nComponents);
+        for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
+        {
+            ComponentDistributions& dists = fDistributions[iComponent];
+            dists.fDistMin.assign(nFreqBins, 0.);
+            dists.fDistMax.assign(nFreqBins, 1.);
+            dists.fInvDistBinWidth.assign(nFreqBins, 0.);
+        }
+        return true;
+    }
+
+    bool KTAmplitudeDistribution::InitializeNew(unsigned nComponents, unsigned nFreqBins, unsigned distNBins, double distMin, double distMax)
+    {
+        return InitializeBuffer(nComponents, nFreqBins, distNBins, distMin, distMax, 0);
+    }
+
     bool KTAmplitudeDistribution::InitializeADistribution(unsigned component, unsigned freqBin, unsigned distNBins, double distMin, double distMax)
     {
-        if (component > fDistributions.size())
+        if (component >= fDistributions.size())
         {
             KTERROR(datalog, "Data does not contain component " << component);
             return false;
         }
-        if (freqBin > fDistributions[component].size())
+        if (freqBin >= fNFreqBins)
         {
             KTERROR(datalog, "Data does not contain frequency bin " << freqBin << " for component " << component);
             return false;
         }
+        if (fNDistBins == 0)
+        {
+            // First distribution to be initialized: this sets the number of bins for all of them
+            fNDistBins = distNBins;
+            fRowStride = distNBins;
+            for (unsigned iComponent = 0; iComponent < fDistributions.size(); ++iComponent)
+            {
+                fDistributions[iComponent].fCounts.assign(size_t(fNFreqBins) * fRowStride, 0.);
+            }
+        }
+        else if (distNBins != fNDistBins)
+        {
+            KTERROR(datalog, "All distributions must have the same number of bins (" << fNDistBins << "); requested: " << distNBins);
+            return false;
+        }
         KTDEBUG(datalog, "Initializing distribution for component " << component << ", frequency bin " << freqBin << ", (" << distNBins << ", " << distMin << ", " << distMax << ")");
-        delete fDistributions[component][freqBin];
-        fDistributions[component][freqBin] = new Distribution(distNBins, distMin, distMax);
+        ComponentDistributions& dists = fDistributions[component];
+        std::fill_n(dists.fCounts.begin() + size_t(freqBin) * fRowStride, fNDistBins, 0.);
+        SetDistRange(dists, freqBin, distMin, distMax);
         return true;
     }
 
+    bool KTAmplitudeDistribution::InitializeBuffer(unsigned nComponents, unsigned nFreqBins, unsigned distNBins, double distMin, double distMax, unsigned bufferSize)
+    {
+        if (distNBins == 0)
+        {
+            KTERROR(datalog, "Distributions must have at least one bin");
+            return false;
+        }
+        ClearDistributions();
+        fNFreqBins = nFreqBins;
+        fNDistBins = distNBins;
+        fRowStride = std::max(distNBins, bufferSize);
+        fDistributions.resize(nComponents);
+        for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
+        {
+            ComponentDistributions& dists = fDistributions[iComponent];
+            dists.fCounts.assign(size_t(nFreqBins) * fRowStride, 0.);
+            dists.fDistMin.resize(nFreqBins);
+            dists.fDistMax.resize(nFreqBins);
+            dists.fInvDistBinWidth.resize(nFreqBins);
+            for (unsigned iFreqBin = 0; iFreqBin < nFreqBins; ++iFreqBin)
+            {
+                SetDistRange(dists, iFreqBin, distMin, distMax);
+            }
+        }
+        return true;
+    }
 
-} /* namespace Katydid */
+    void KTAmplitudeDistribution::AddToBuffer(const double* values, unsigned firstFreqBin, unsigned nValues, unsigned iEntry, unsigned component)
+    {
+#ifdef Katydid_DEBUG
+        if (component >= fDistributions.size())
+        {
+            KTERROR(datalog, "Data does not contain component " << component);
+            return;
+        }
+        if (firstFreqBin + nValues > fNFreqBins || iEntry >= fRowStride)
+        {
+            KTERROR(datalog, "Data does not contain frequency bins [" << firstFreqBin << ", " << firstFreqBin + nValues << ") or buffer entry " << iEntry << " for component " << component);
+            return;
+        }
+#endif
+        // Each frequency bin's buffered values are contiguous, so the range of a row can be found with one pass over it
+        double* buffer = fDistributions[component].fCounts.data() + size_t(firstFreqBin) * fRowStride + iEntry;
+        const size_t rowStride = fRowStride;
+        for (unsigned iValue = 0; iValue < nValues; ++iValue)
+        {
+            buffer[iValue * rowStride] = values[iValue];
+        }
+        return;
+    }
+
+    bool KTAmplitudeDistribution::CreateDistributionsFromBuffer(unsigned nEntries, unsigned firstFreqBin, unsigned nFreqBins)
+    {
+        if (nEntries == 0 || nEntries > fRowStride)
+        {
+            KTERROR(datalog, "Invalid number of buffered entries: " << nEntries << " (buffer size: " << fRowStride << ")");
+            return false;
+        }
+        if (firstFreqBin + nFreqBins > fNFreqBins)
+        {
+            KTERROR(datalog, "Data does not contain frequency bins [" << firstFreqBin << ", " << firstFreqBin + nFreqBins << ")");
+            return false;
+        }
+
+        // The rows are moved from the buffer stride to the distribution stride in place.
+        // Row i of the distributions ends at or before the start of buffer row (i + 1), so moving the rows in order only overwrites buffer rows that have already been used;
+        // the row's own buffered values are copied out before it's overwritten.
+        const size_t bufferStride = fRowStride;
+        const size_t distStride = fNDistBins;
+        const unsigned lastFreqBin = firstFreqBin + nFreqBins;
+        const double lastBin = double(fNDistBins - 1);
+        std::vector< double > entries(nEntries);
+        for (unsigned iComponent = 0; iComponent < fDistributions.size(); ++iComponent)
+        {
+            ComponentDistributions& dists = fDistributions[iComponent];
+            double* storage = dists.fCounts.data();
+            for (unsigned iFreqBin = 0; iFreqBin < fNFreqBins; ++iFreqBin)
+            {
+                bool buffered = iFreqBin >= firstFreqBin && iFreqBin < lastFreqBin;
+                if (buffered)
+                {
+                    std::copy(storage + iFreqBin * bufferStride, storage + iFreqBin * bufferStride + nEntries, entries.begin());
+                }
+
+                double* row = storage + iFreqBin * distStride;
+                std::fill_n(row, distStride, 0.);
+                if (! buffered) continue;
+
+                std::pair< std::vector< double >::const_iterator, std::vector< double >::const_iterator > range = std::minmax_element(entries.begin(), entries.end());
+                SetDistRange(dists, iFreqBin, *range.first, *range.second);
 
+                const double distMin = dists.fDistMin[iFreqBin];
+                const double invDistBinWidth = dists.fInvDistBinWidth[iFreqBin];
+                for (unsigned iEntry = 0; iEntry < nEntries; ++iEntry)
+                {
+                    row[CalculateDistBin(entries[iEntry], distMin, invDistBinWidth, lastBin)] += 1.;
+                }
+            }
+            dists.fCounts.resize(size_t(fNFreqBins) * distStride);
+        }
+        fRowStride = fNDistBins;
+
+        KTDEBUG(datalog, "Distributions created from " << nEntries << " buffered entries for frequency bins [" << firstFreqBin << ", " << lastFreqBin << ")");
+        return true;
+    }
+
+    void KTAmplitudeDistribution::SetDistRange(ComponentDistributions& dists, unsigned freqBin, double distMin, double distMax)
+    {
+        dists.fDistMin[freqBin] = distMin;
+        dists.fDistMax[freqBin] = distMax;
+        // A distribution with no width (e.g. from a buffer of identical values) puts everything in the first bin
+        dists.fInvDistBinWidth[freqBin] = distMax > distMin ? double(fNDistBins) / (distMax - distMin) : 0.;
+        return;
+    }
+
+
+} /* namespace Katydid */
@@ -10,101 +10,242 @@
 
 #include "KTData.hh"
 
-#include "KTPhysicalArray.hh"
-
+#include <sys/types.h>
 #include <vector>
 
 namespace Katydid
 {
+    /*!
+     @class KTAmplitudeDistribution
+     @author N. S. Oblath
+
+     @brief Histograms of amplitude, one for each frequency bin of each component
+
+     @details
+     The histograms for a component are stored in one contiguous (frequency bin x distribution bin) block,
+     so each frequency bin's histogram is a row of that block.  All of the histograms, in all components, share one number of bins;
+     each frequency bin has its own range.  The number of bins is set by InitializeNew or InitializeBuffer, or by the first call to
+     InitializeADistribution after InitializeNull; InitializeADistribution reports an error and returns false if a different number is requested.
+
+     Values outside of a histogram's range are added to the first or last bin.
+
+     GetDistribution returns a view of a row; the values are not copied.
+
+     While a distributor is collecting values to determine the ranges (see InitializeBuffer),
+     the buffered values are kept in the same storage as the histograms, and the histograms are not valid until CreateDistributionsFromBuffer is called.
+    */
     class KTAmplitudeDistribution : public Nymph::KTExtensibleData< KTAmplitudeDistribution >
     {
         public:
-            typedef KTPhysicalArray< 1, double > Distribution; // histogram over amplitude distribution index
-            typedef std::vector< Distribution* > ComponentDistributions; // indexed over frequency-axis bins
-            typedef std::vector< ComponentDistributions > Distributions; // indexed over component
+            /*!
+             @brief Read-only view of the histogram for one frequency bin
+
+             @details
+             Has the read interface of a 1-D KTPhysicalArray (size, bin access, and range information).
+             It's only valid until the distributions are re-initialized or destroyed.
+            */
+            class Distribution
+            {
+                public:
+                    typedef double value_type;
+                    typedef const double* const_iterator;
+
+                public:
+                    Distribution(const double* data, unsigned nBins, double rangeMin, double rangeMax, double invBinWidth);
 
+                    size_t size() const;
+                    bool empty() const;
+
+                    double GetRangeMin() const;
+                    double GetRangeMax() const;
+                    double GetBinWidth() const;
+                    double GetBinLowEdge(size_t bin) const;
+                    double GetBinCenter(size_t bin) const;
+                    ssize_t FindBin(double pos) const;
+
+                    const double* GetData() const;
+                    const double& operator()(unsigned i) const;
+
+                    const_iterator begin() const;
+                    const_iterator end() const;
+
+                private:
+                    const double* fData;
+                    unsigned fNBins;
+                    double fRangeMin;
+                    double fRangeMax;
+                    double fInvBinWidth;
+            };
+
+        private:
+            struct ComponentDistributions
+            {
+                std::vector< double > fCounts; // nFreqBins x row stride; indexed as [freqBin * stride + distBin]
+                std::vector< double > fDistMin; // indexed over frequency-axis bins
+                std::vector< double > fDistMax; // indexed over frequency-axis bins
+                std::vector< double > fInvDistBinWidth; // indexed over frequency-axis bins
+            };
+            typedef std::vector< ComponentDistributions > Distributions; // indexed over component
 
         public:
             KTAmplitudeDistribution();
             virtual ~KTAmplitudeDistribution();
 
-            const Distribution& GetDistribution(unsigned freqBins, unsigned component = 0) const;
+            Distribution GetDistribution(unsigned freqBin, unsigned component = 0) const;
 
             unsigned GetNComponents() const;
             unsigned GetNFreqBins() const;
+            unsigned GetNDistBins() const;
 
             void SetDistValue(double value, unsigned freqBin, unsigned iDistBin, unsigned component = 0);
 
             void AddToDist(unsigned freqBin, unsigned iDistBin, unsigned component = 0, double weight = 1.);
             void AddToDist(unsigned freqBin, double distValue, unsigned component = 0, double weight = 1.);
 
-            unsigned FindDistBin(double value, unsigned freqBin, unsigned component = 0);
+            /// Adds values[i] to the distribution for frequency bin (firstFreqBin + i), for i in [0, nValues)
+            void AddToDists(const double* values, unsigned firstFreqBin, unsigned nValues, unsigned component = 0, double weight = 1.);
+
+            unsigned FindDistBin(double value, unsigned freqBin, unsigned component = 0) const;
 
             bool ClearDistributions();
 
-            /// Clear distributions and initialize new vectors with NULL distribution pointers
+            /// Clear distributions and initialize new, empty distributions; their number of bins and ranges are set with InitializeADistribution
             bool InitializeNull(unsigned nComponents, unsigned nFreqBins);
-            /// Clear distributions and initialize new vectors with new, uniform, distributions pointers
+            /// Clear distributions and initialize new, uniform, distributions
             bool InitializeNew(unsigned nComponents, unsigned nFreqBins, unsigned distNBins, double distMin, double distMax);
-            /// Initialize a single new distribution (only removes the specified distribution, if it already exists)
+            /// Initialize a single distribution (only clears the specified distribution); all distributions must have the same number of bins
             bool InitializeADistribution(unsigned component, unsigned freqBin, unsigned distNBins, double distMin, double distMax);
 
+            /// Clear distributions and use their storage to buffer up to bufferSize values for each frequency bin; the distributions' default range is [distMin, distMax)
+            bool InitializeBuffer(unsigned nComponents, unsigned nFreqBins, unsigned distNBins, double distMin, double distMax, unsigned bufferSize);
+            /// Stores values[i] as buffer entry iEntry for frequency bin (firstFreqBin + i), for i in [0, nValues)
+            void AddToBuffer(const double* values, unsigned firstFreqBin, unsigned nValues, unsigned iEntry, unsigned component = 0);
+            /// Sets the range of the distributions for [firstFreqBin, firstFreqBin + nFreqBins) from their first nEntries buffered values, and fills them with those values; the other distributions are left empty
+            bool CreateDistributionsFromBuffer(unsigned nEntries, unsigned firstFreqBin, unsigned nFreqBins);
+
         private:
+            void SetDistRange(ComponentDistributions& dists, unsigned freqBin, double distMin, double distMax);
+
+            static unsigned CalculateDistBin(double value, double distMin, double invDistBinWidth, double lastBin);
+
             Distributions fDistributions;
+            unsigned fNFreqBins;
+            unsigned fNDistBins;
+            /// Distance between the rows of a component's storage; larger than fNDistBins only while buffering
+            unsigned fRowStride;
+
+            /// Number of frequency bins that have their distribution bins calculated at a time in AddToDists
+            static const unsigned sFillBlockSize = 512;
 
         public:
             static const std::string sName;
     };
 
-    inline const KTAmplitudeDistribution::Distribution& KTAmplitudeDistribution::GetDistribution(unsigned freqBins, unsigned component) const
+    inline KTAmplitudeDistribution::Distribution::Distribution(const double* data, unsigned nBins, double rangeMin, double rangeMax, double invBinWidth) :
+            fData(data),
+            fNBins(nBins),
+            fRangeMin(rangeMin),
+            fRangeMax(rangeMax),
+            fInvBinWidth(invBinWidth)
     {
-        return *fDistributions[component][freqBins];
     }
 
-    inline unsigned KTAmplitudeDistribution::GetNComponents() const
+    inline size_t KTAmplitudeDistribution::Distribution::size() const
     {
-        return unsigned(fDistributions.size());
+        return fNBins;
     }
 
-    inline unsigned KTAmplitudeDistribution::GetNFreqBins() const
+    inline bool KTAmplitudeDistribution::Distribution::empty() const
     {
-        return unsigned(fDistributions[0].size());
+        return fNBins == 0;
     }
 
-    inline bool KTAmplitudeDistribution::ClearDistributions()
+    inline double KTAmplitudeDistribution::Distribution::GetRangeMin() const
     {
-        for (unsigned iComponent = 0; iComponent < fDistributions.size(); ++iComponent)
-        {
-            for (unsigned iFreqBin = 0; iFreqBin < fDistributions[iComponent].size(); iFreqBin++)
-            {
-                delete fDistributions[iComponent][iFreqBin];
-            }
-        }
-        return true;
+        return fRangeMin;
+    }
+
+    inline double KTAmplitudeDistribution::Distribution::GetRangeMax() const
+    {
+        return fRangeMax;
     }
 
-    inline bool KTAmplitudeDistribution::InitializeNull(unsigned nComponents, unsigned nFreqBins)
+    inline double KTAmplitudeDistribution::Distribution::GetBinWidth() const
     {
-        //fDistributions.resize(nComponents, ComponentDistributions(nFreqBins, NULL));
-        fDistributions.resize(nComponents);
-        for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
-        {
-            fDistributions[iComponent].resize(nFreqBins, NULL);
-        }
-        return true;
+        return fNBins == 0 ? 0. : (fRangeMax - fRangeMin) / double(fNBins);
     }
 
-    inline bool KTAmplitudeDistribution::InitializeNew(unsigned nComponents, unsigned nFreqBins, unsigned distNBins, double distMin, double distMax)
+    inline double KTAmplitudeDistribution::Distribution::GetBinLowEdge(size_t bin) const
     {
-        fDistributions.resize(nComponents, ComponentDistributions(nFreqBins, new Distribution(distNBins, distMin, distMax)));
-        return true;
+        return fRangeMin + GetBinWidth() * double(bin);
     }
 
-    inline unsigned KTAmplitudeDistribution::FindDistBin(double value, unsigned freqBin, unsigned component)
+    inline double KTAmplitudeDistribution::Distribution::GetBinCenter(size_t bin) const
     {
-        return fDistributions[component][freqBin]->FindBin(value);
+        return fRangeMin + GetBinWidth() * (double(bin) + 0.5);
     }
 
+    inline ssize_t KTAmplitudeDistribution::Distribution::FindBin(double pos) const
+    {
+        return fNBins == 0 ? 0 : ssize_t(KTAmplitudeDistribution::CalculateDistBin(pos, fRangeMin, fInvBinWidth, double(fNBins - 1)));
+    }
+
+    inline const double* KTAmplitudeDistribution::Distribution::GetData() const
+    {
+        return fData;
+    }
+
+    inline const double& KTAmplitudeDistribution::Distribution::operator()(unsigned i) const
+    {
+        return fData[i];
+    }
+
+    inline KTAmplitudeDistribution::Distribution::const_iterator KTAmplitudeDistribution::Distribution::begin() const
+    {
+        return fData;
+    }
+
+    inline KTAmplitudeDistribution::Distribution::const_iterator KTAmplitudeDistribution::Distribution::end() const
+    {
+        return fData + fNBins;
+    }
+
+
+    inline KTAmplitudeDistribution::Distribution KTAmplitudeDistribution::GetDistribution(unsigned freqBin, unsigned component) const
+    {
+        const ComponentDistributions& dists = fDistributions[component];
+        return Distribution(dists.fCounts.data() + size_t(freqBin) * fRowStride, fNDistBins, dists.fDistMin[freqBin], dists.fDistMax[freqBin], dists.fInvDistBinWidth[freqBin]);
+    }
+
+    inline unsigned KTAmplitudeDistribution::GetNComponents() const
+    {
+        return unsigned(fDistributions.size());
+    }
+
+    inline unsigned KTAmplitudeDistribution::GetNFreqBins() const
+    {
+        return fNFreqBins;
+    }
+
+    inline unsigned KTAmplitudeDistribution::GetNDistBins() const
+    {
+        return fNDistBins;
+    }
+
+    inline unsigned KTAmplitudeDistribution::FindDistBin(double value, unsigned freqBin, unsigned component) const
+    {
+        const ComponentDistributions& dists = fDistributions[component];
+        return fNDistBins == 0 ? 0 : CalculateDistBin(value, dists.fDistMin[freqBin], dists.fInvDistBinWidth[freqBin], double(fNDistBins - 1));
+    }
+
+    inline unsigned KTAmplitudeDistribution::CalculateDistBin(double value, double distMin, double invDistBinWidth, double lastBin)
+    {
+        // Clamped with comparisons rather than branches so that the calculation vectorizes; NaN ends up in the first bin
+        double pos = (value - distMin) * invDistBinWidth;
+        pos = pos > 0. ? pos : 0.;
+        pos = pos < lastBin ? pos : lastBin;
+        return unsigned(pos);
+    }
 
 } /* namespace Katydid */
 
@@ -53,10 +53,10 @@ namespace Katydid
     {
         unsigned oldSize = fSpectra.size();
 
-        // If old size is bigger than num, delete all the extra terms
+        // If old size is bigger than num, release all the extra terms
         for (unsigned iComponent = num; iComponent < oldSize; ++iComponent)
         {
-            delete fSpectra[iComponent];
+            KTFrequencySpectrumFFTW::Release(fSpectra[iComponent]);
         }
 
         //Resize old size is smaller than old size
@@ -89,10 +89,10 @@ namespace Katydid
     {
         unsigned oldSize = fSpectra.size();
 
-        // If old size is bigger than num, delete all the extra terms
+        // If old size is bigger than num, release all the extra terms
         for (unsigned iComponent = num; iComponent < oldSize; ++iComponent)
         {
-            delete fSpectra[iComponent];
+            KTPowerSpectrum::Release(fSpectra[iComponent]);
         }
 
         //Resize old size is smaller than old size
@@ -10,9 +10,9 @@
 
 #include "KTData.hh"
 
+#include "KTFlatMap.hh"
 #include "KTMemberVariable.hh"
 
-#include <map>
 #include <utility>
 #include <vector>
 
@@ -32,8 +32,12 @@ namespace Katydid
                 double fVariance;
                 double fNeighborhoodAmplitude;
                 Point(double abscissa, double ordinate, double threshold, double mean, double variance, double neighborhoodAmplitude) : fAbscissa(abscissa), fOrdinate(ordinate), fThreshold(threshold), fMean(mean), fVariance(variance), fNeighborhoodAmplitude(neighborhoodAmplitude) {}
+                bool operator==(const Point& rhs) const {return fAbscissa == rhs.fAbscissa && fOrdinate == rhs.fOrdinate && fThreshold == rhs.fThreshold && fMean == rhs.fMean && fVariance == rhs.fVariance && fNeighborhoodAmplitude == rhs.fNeighborhoodAmplitude;}
             };
-            typedef std::map< unsigned, Point > SetOfPoints;
+            /// Points stored contiguously in bin order
+            typedef KTFlatMap< unsigned, Point > SetOfPoints;
+            /// Contiguous list of (bin, point) pairs, used to collect points before adding them to the data
+            typedef std::vector< std::pair< unsigned, Point > > PointBuffer;
 
         protected:
             struct PerComponentData
@@ -50,6 +54,8 @@ namespace Katydid
             unsigned GetNComponents() const;
 
             void AddPoint(unsigned bin, const Point& point, unsigned component = 0);
+            /// Adds a list of points; this is most efficient if the points are in bin order and come after the points already present
+            void AddPoints(const PointBuffer& points, unsigned component = 0);
 
             KTDiscriminatedPoints1DData& SetNComponents(unsigned channels);
 
@@ -79,6 +85,18 @@ namespace Katydid
         fComponentData[component].fPoints.insert(std::make_pair(bin, point));
     }
 
+    inline void KTDiscriminatedPoints1DData::AddPoints(const PointBuffer& points, unsigned component)
+    {
+        if (component >= fComponentData.size()) fComponentData.resize(component+1);
+        SetOfPoints& setOfPoints = fComponentData[component].fPoints;
+        setOfPoints.reserve(setOfPoints.size() + points.size());
+        for (PointBuffer::const_iterator pIt = points.begin(); pIt != points.end(); ++pIt)
+        {
+            setOfPoints.insert(setOfPoints.end(), *pIt);
+        }
+        return;
+    }
+
     inline KTDiscriminatedPoints1DData& KTDiscriminatedPoints1DData::SetNComponents(unsigned channels)
     {
         fComponentData.resize(channels);
@@ -10,7 +10,8 @@
 
 #include "KTData.hh"
 
-#include <map>
+#include "KTFlatMap.hh"
+
 #include <utility>
 #include <vector>
 
@@ -38,8 +39,10 @@ namespace Katydid
                 double fVariance;
                 double fNeighborhoodAmplitude;
                 Point(double abscissa, double ordinate, double applicate, double threshold, double mean, double variance, double neighborhoodAmplitude) : fAbscissa(abscissa), fOrdinate(ordinate), fApplicate(applicate), fThreshold(threshold), fMean(mean), fVariance(variance), fNeighborhoodAmplitude(neighborhoodAmplitude) {}
+                bool operator==(const Point& rhs) const {return fAbscissa == rhs.fAbscissa && fOrdinate == rhs.fOrdinate && fApplicate == rhs.fApplicate && fThreshold == rhs.fThreshold && fMean == rhs.fMean && fVariance == rhs.fVariance && fNeighborhoodAmplitude == rhs.fNeighborhoodAmplitude;}
             };
-            typedef std::map< std::pair< unsigned, unsigned >, Point > SetOfPoints;
+            /// Points stored contiguously, ordered by (x bin, y bin)
+            typedef KTFlatMap< std::pair< unsigned, unsigned >, Point, KTPairCompare > SetOfPoints;
 
         protected:
             struct PerComponentData
@@ -18,6 +18,9 @@ namespace Katydid
     {
         fComponentData[0].fSpline = NULL;
         fComponentData[0].fVarianceSpline = NULL;
+        fComponentData[0].fTableNBins = 0;
+        fComponentData[0].fTableXMin = 0.;
+        fComponentData[0].fTableXMax = 0.;
     }
 
     KTGainVariationData::KTGainVariationData(const KTGainVariationData& orig) :
@@ -29,6 +32,10 @@ namespace Katydid
         {
             fComponentData[iComponent].fSpline = new KTSpline(*orig.fComponentData[iComponent].fSpline);
             fComponentData[iComponent].fVarianceSpline = new KTSpline(*orig.fComponentData[iComponent].fVarianceSpline);
+            fComponentData[iComponent].fTableNBins = orig.fComponentData[iComponent].fTableNBins;
+            fComponentData[iComponent].fTableXMin = orig.fComponentData[iComponent].fTableXMin;
+            fComponentData[iComponent].fTableXMax = orig.fComponentData[iComponent].fTableXMax;
+            fComponentData[iComponent].fTable = orig.fComponentData[iComponent].fTable;
         }
     }
 
@@ -52,6 +59,10 @@ namespace Katydid
             delete fComponentData[iComponent].fVarianceSpline;
             fComponentData[iComponent].fSpline = new KTSpline(*rhs.fComponentData[iComponent].fSpline);
             fComponentData[iComponent].fVarianceSpline = new KTSpline(*rhs.fComponentData[iComponent].fVarianceSpline);
+            fComponentData[iComponent].fTableNBins = rhs.fComponentData[iComponent].fTableNBins;
+            fComponentData[iComponent].fTableXMin = rhs.fComponentData[iComponent].fTableXMin;
+            fComponentData[iComponent].fTableXMax = rhs.fComponentData[iComponent].fTableXMax;
+            fComponentData[iComponent].fTable = rhs.fComponentData[iComponent].fTable;
         }
         return *this;
     }
@@ -71,10 +82,35 @@ namespace Katydid
         {
             fComponentData[iComponent].fSpline = NULL;
             fComponentData[iComponent].fVarianceSpline = NULL;
+            fComponentData[iComponent].fTableNBins = 0;
+            fComponentData[iComponent].fTableXMin = 0.;
+            fComponentData[iComponent].fTableXMax = 0.;
+            fComponentData[iComponent].fTable.reset();
         }
         return *this;
     }
 
+    void KTGainVariationData::SetTableBinning(unsigned nBins, double xMin, double xMax, unsigned component)
+    {
+        if (component >= fComponentData.size()) SetNComponents(component+1);
+        PerComponentData& compData = fComponentData[component];
+        if (compData.fTable && compData.fTable->Matches(nBins, xMin, xMax)) return;
+        compData.fTableNBins = nBins;
+        compData.fTableXMin = xMin;
+        compData.fTableXMax = xMax;
+        BuildTable(compData);
+    }
+
+    void KTGainVariationData::BuildTable(PerComponentData& compData)
+    {
+        if (compData.fSpline == NULL || compData.fTableNBins == 0)
+        {
+            compData.fTable.reset();
+            return;
+        }
+        compData.fTable = std::make_shared< const KTGainVariationTable >(compData.fSpline, compData.fVarianceSpline, compData.fTableNBins, compData.fTableXMin, compData.fTableXMax);
+    }
+
 #ifdef ROOT_FOUND
     TH1D* KTGainVariationData::CreateGainVariationHistogram(unsigned nBins, unsigned component, const std::string& name) const
     {
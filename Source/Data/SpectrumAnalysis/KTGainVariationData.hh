@@ -10,12 +10,14 @@
 
 #include "KTData.hh"
 
+#include "KTGainVariationTable.hh"
 #include "KTSpline.hh"
 
 #ifdef ROOT_FOUND
 #include "TH1.h"
 #endif
 
+#include <memory>
 #include <vector>
 
 namespace Katydid
@@ -29,6 +31,12 @@ namespace Katydid
             {
                 KTSpline* fSpline;
                 KTSpline* fVarianceSpline;
+                /// Binning of the table; the table is not built while fTableNBins is 0
+                unsigned fTableNBins;
+                double fTableXMin;
+                double fTableXMax;
+                /// Table of the current splines; shared by copies of the data
+                std::shared_ptr< const KTGainVariationTable > fTable;
             };
 
         public:
@@ -39,19 +47,33 @@ namespace Katydid
             KTGainVariationData& operator=(const KTGainVariationData& rhs);
 
             const KTSpline* GetSpline(unsigned component = 0) const;
+            /// If the spline is modified, call InvalidateTable() afterwards
             KTSpline* GetSpline(unsigned component = 0);
 
             const KTSpline* GetVarianceSpline(unsigned component = 0) const;
+            /// If the spline is modified, call InvalidateTable() afterwards
             KTSpline* GetVarianceSpline(unsigned component = 0);
 
             unsigned GetNComponents() const;
 
+            /// Returns the per-bin table of the splines; empty if the table binning or the spline has not been set
+            std::shared_ptr< const KTGainVariationTable > GetTable(unsigned component = 0) const;
+
+            /// Sets the binning of the table (nBins bins spanning [xMin, xMax)) and builds the table if the binning changed
+            void SetTableBinning(unsigned nBins, double xMin, double xMax, unsigned component = 0);
+
+            /// Rebuilds the table of a component from its current splines; needed after a spline is modified through the non-const getters
+            void InvalidateTable(unsigned component = 0);
+
+            /// Setting either spline rebuilds the table of that component with the current table binning
             void SetSpline(KTSpline* spline, unsigned component = 0);
             void SetVarianceSpline(KTSpline* spline, unsigned component = 0);
 
             KTGainVariationData& SetNComponents(unsigned components);
 
         private:
+            void BuildTable(PerComponentData& compData);
+
             std::vector< PerComponentData > fComponentData;
 
         public:
@@ -89,11 +111,22 @@ namespace Katydid
         return unsigned(fComponentData.size());
     }
 
+    inline std::shared_ptr< const KTGainVariationTable > KTGainVariationData::GetTable(unsigned component) const
+    {
+        return fComponentData[component].fTable;
+    }
+
+    inline void KTGainVariationData::InvalidateTable(unsigned component)
+    {
+        BuildTable(fComponentData[component]);
+    }
+
     inline void KTGainVariationData::SetSpline(KTSpline* spline, unsigned component)
     {
         if (component >= fComponentData.size()) fComponentData.resize(component+1);
         delete fComponentData[component].fSpline;
         fComponentData[component].fSpline = spline;
+        BuildTable(fComponentData[component]);
     }
 
     inline void KTGainVariationData::SetVarianceSpline(KTSpline* spline, unsigned component)
@@ -101,6 +134,7 @@ namespace Katydid
         if (component >= fComponentData.size()) fComponentData.resize(component+1);
         delete fComponentData[component].fVarianceSpline;
         fComponentData[component].fVarianceSpline = spline;
+        BuildTable(fComponentData[component]);
     }
 
 } /* namespace Katydid */
@@ -0,0 +1,70 @@
+/*
+ * KTGainVariationTable.cc
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ */
+
+#include "KTGainVariationTable.hh"
+
+#include "KTLogger.hh"
+#include "KTSpline.hh"
+
+#include <cmath>
+
+namespace Katydid
+{
+    KTLOGGER(gvtlog, "KTGainVariationTable");
+
+    KTGainVariationTable::KTGainVariationTable(const KTSpline* spline, const KTSpline* varSpline, unsigned nBins, double xMin, double xMax) :
+            fNBins(nBins),
+            fXMin(xMin),
+            fXMax(xMax),
+            fNormalizedMean(0.),
+            fNormalizedVariance(0.),
+            fMean(nBins),
+            fVariance(),
+            fSigma(),
+            fNormScale(),
+            fNormOffset()
+    {
+        KTDEBUG(gvtlog, "Creating gain-variation table for (" << nBins << ", " << xMin << ", " << xMax << ")");
+        if (nBins == 0) return;
+
+        double binWidth = (xMax - xMin) / (double)nBins;
+
+        double meanSum = 0.;
+        for (unsigned iBin = 0; iBin < nBins; ++iBin)
+        {
+            fMean[iBin] = spline->Evaluate(xMin + binWidth * ((double)iBin + 0.5));
+            meanSum += fMean[iBin];
+        }
+        fNormalizedMean = meanSum / (double)nBins;
+
+        if (varSpline == NULL) return;
+
+        fVariance.resize(nBins);
+        double varianceSum = 0.;
+        for (unsigned iBin = 0; iBin < nBins; ++iBin)
+        {
+            fVariance[iBin] = varSpline->Evaluate(xMin + binWidth * ((double)iBin + 0.5));
+            varianceSum += fVariance[iBin];
+        }
+        fNormalizedVariance = varianceSum / (double)nBins;
+
+        fSigma.resize(nBins);
+        fNormScale.resize(nBins);
+        fNormOffset.resize(nBins);
+        for (unsigned iBin = 0; iBin < nBins; ++iBin)
+        {
+            fSigma[iBin] = sqrt(fVariance[iBin]);
+            fNormScale[iBin] = sqrt(fNormalizedVariance / fVariance[iBin]);
+            fNormOffset[iBin] = fNormalizedMean - fMean[iBin] * fNormScale[iBin];
+        }
+    }
+
+    KTGainVariationTable::~KTGainVariationTable()
+    {
+    }
+
+} /* namespace Katydid */
@@ -0,0 +1,108 @@
+/**
+ @file KTGainVariationTable.hh
+ @brief Contains KTGainVariationTable
+ @details Per-bin lookup tables of the gain variation
+ @author: N. S. Oblath
+ @date: Oct 17, 2026
+ */
+
+#ifndef KTGAINVARIATIONTABLE_HH_
+#define KTGAINVARIATIONTABLE_HH_
+
+#include "KTMemberVariable.hh"
+
+#include <vector>
+
+namespace Katydid
+{
+    class KTSpline;
+
+    /*!
+     @class KTGainVariationTable
+     @author N. S. Oblath
+
+     @brief Gain variation (and its variance) evaluated once for each bin of a frequency range
+
+     @details
+     The splines are evaluated at the centers of nBins bins spanning [xMin, xMax).  Along with the background mean and variance,
+     the table holds the quantities derived from them that are used for every spectrum:
+     - the background standard deviation;
+     - the normalization scale and offset, such that the normalized value of a bin is
+       \f$\hat{x} = \langle\mu\rangle + (x - \mu) \sqrt{\langle\sigma^2\rangle / \sigma^2} = x \cdot scale + offset\f$.
+
+     If there is no variance spline, only the mean is available (HasVariance() returns false).
+
+     Tables are normally built by KTGainVariationData when its splines or its table binning are set, and obtained with KTGainVariationData::GetTable().
+     Processors that need a range the data has no table for (e.g. KTGainNormalization, KTVariableSpectrumDiscriminator) build and keep their own.
+    */
+    class KTGainVariationTable
+    {
+        public:
+            KTGainVariationTable(const KTSpline* spline, const KTSpline* varSpline, unsigned nBins, double xMin, double xMax);
+            ~KTGainVariationTable();
+
+            bool Matches(unsigned nBins, double xMin, double xMax) const;
+
+            MEMBERVARIABLE_NOSET(unsigned, NBins);
+            MEMBERVARIABLE_NOSET(double, XMin);
+            MEMBERVARIABLE_NOSET(double, XMax);
+
+            /// Average of the background mean over the range
+            MEMBERVARIABLE_NOSET(double, NormalizedMean);
+            /// Average of the background variance over the range
+            MEMBERVARIABLE_NOSET(double, NormalizedVariance);
+
+            bool HasVariance() const;
+
+            const double* GetMean() const;
+            const double* GetVariance() const;
+            const double* GetSigma() const;
+            const double* GetNormScale() const;
+            const double* GetNormOffset() const;
+
+        private:
+            std::vector< double > fMean;
+            std::vector< double > fVariance;
+            std::vector< double > fSigma;
+            std::vector< double > fNormScale;
+            std::vector< double > fNormOffset;
+    };
+
+    inline bool KTGainVariationTable::Matches(unsigned nBins, double xMin, double xMax) const
+    {
+        return nBins == fNBins && xMin == fXMin && xMax == fXMax;
+    }
+
+    inline bool KTGainVariationTable::HasVariance() const
+    {
+        return ! fVariance.empty();
+    }
+
+    inline const double* KTGainVariationTable::GetMean() const
+    {
+        return fMean.data();
+    }
+
+    inline const double* KTGainVariationTable::GetVariance() const
+    {
+        return fVariance.data();
+    }
+
+    inline const double* KTGainVariationTable::GetSigma() const
+    {
+        return fSigma.data();
+    }
+
+    inline const double* KTGainVariationTable::GetNormScale() const
+    {
+        return fNormScale.data();
+    }
+
+    inline const double* KTGainVariationTable::GetNormOffset() const
+    {
+        return fNormOffset.data();
+    }
+
+} /* namespace Katydid */
+
+#endif /* KTGAINVARIATIONTABLE_HH_ */
@@ -9,6 +9,8 @@
 
 #include "KTLogger.hh"
 
+#include <algorithm>
+
 namespace Katydid
 {
     KTLOGGER(kdtlog, "KTKDTreeData");
@@ -49,18 +51,34 @@ namespace Katydid
         if (dist == kManhattan)
         {
             KTDEBUG(kdtlog, "Creating index with Manhattan distance metric");
-            fComponentData[component].fTreeIndex = new KTTreeIndexManhattan< double, KTPointCloud< Point > >(fNDimensions, fComponentData[component].fCloud, nanoflann::KDTreeSingleIndexAdaptorParams(maxLeafSize));
+            fComponentData[component].fTreeIndex = new KTTreeIndexForest< double, KTPointCloud< Point >, KTManhattanMetric< double > >(fComponentData[component].fCloud, nanoflann::KDTreeSingleIndexAdaptorParams(maxLeafSize));
             fComponentData[component].fTreeIndex->BuildIndex();
         }
         else
         {
             KTDEBUG(kdtlog, "Creating index with Euclidean distance metric");
-            fComponentData[component].fTreeIndex = new KTTreeIndexEuclidean< double, KTPointCloud< Point > >(fNDimensions, fComponentData[component].fCloud, nanoflann::KDTreeSingleIndexAdaptorParams(maxLeafSize));
+            fComponentData[component].fTreeIndex = new KTTreeIndexForest< double, KTPointCloud< Point >, KTEuclideanMetric< double > >(fComponentData[component].fCloud, nanoflann::KDTreeSingleIndexAdaptorParams(maxLeafSize));
             fComponentData[component].fTreeIndex->BuildIndex();
         }
         return;
     }
 
+    void KTKDTreeData::UpdateIndex(unsigned component)
+    {
+        UpdateIndex(fComponentData[component].fDistanceMethod, fComponentData[component].fMaxLeafSize, component);
+    }
+
+    void KTKDTreeData::UpdateIndex(KTKDTreeData::DistanceMethod dist, unsigned maxLeafSize, unsigned component)
+    {
+        if (fComponentData[component].fTreeIndex == NULL || dist != fComponentData[component].fDistanceMethod || maxLeafSize != fComponentData[component].fMaxLeafSize)
+        {
+            BuildIndex(dist, maxLeafSize, component);
+            return;
+        }
+        fComponentData[component].fTreeIndex->AppendPoints();
+        return;
+    }
+
     void KTKDTreeData::RemovePoints(const std::vector< size_t >& points, unsigned component)
     {
 #ifndef NDEBUG
@@ -74,7 +92,20 @@ namespace Katydid
             //points.pop_back();
         }
         KTDEBUG(kdtlog, "Removing " << points.size() << " points; original size: " << origSize << "; new size: " << fComponentData[component].fCloud.fPoints.size());
-        BuildIndex();
+        BuildIndex(component);
+        return;
+    }
+
+    void KTKDTreeData::RemoveLeadingPoints(size_t nPoints, unsigned component)
+    {
+        SetOfPoints& setOfPoints = fComponentData[component].fCloud.fPoints;
+        nPoints = std::min(nPoints, setOfPoints.size());
+        setOfPoints.erase(setOfPoints.begin(), setOfPoints.begin() + nPoints);
+        if (fComponentData[component].fTreeIndex != NULL)
+        {
+            fComponentData[component].fTreeIndex->EvictPoints(nPoints);
+        }
+        KTDEBUG(kdtlog, "Removed " << nPoints << " leading points; " << setOfPoints.size() << " points remain");
         return;
     }
 
@@ -13,6 +13,7 @@
 #include "KTPointCloud.hh"
 #include "KTMemberVariable.hh"
 #include "KTKDTree.hh"
+#include "KTTreeIndexForest.hh"
 
 #include <map>
 #include <stdint.h>
@@ -49,6 +50,7 @@ namespace Katydid
 
             typedef KTPointCloud< Point >::SetOfPoints SetOfPoints;
             typedef KTTreeIndex< double > TreeIndex;
+            typedef KTIncrementalTreeIndex< double > IncrementalTreeIndex;
 
             enum DistanceMethod
             {
@@ -63,7 +65,7 @@ namespace Katydid
             struct PerComponentData
             {
                 KTPointCloud< Point > fCloud;
-                TreeIndex* fTreeIndex;
+                IncrementalTreeIndex* fTreeIndex;
                 unsigned fMaxLeafSize;
                 DistanceMethod fDistanceMethod;
                 PerComponentData() : fTreeIndex(NULL)
@@ -98,8 +100,12 @@ namespace Katydid
             void AddPoint(const Point& point, unsigned component = 0);
 
             void RemovePoint(unsigned pid, unsigned component = 0);
+            /// Removes arbitrary points; the index is rebuilt from scratch, so prefer FlagPoints where possible
             void RemovePoints(const std::vector< size_t >& points, unsigned component = 0);
 
+            /// Removes the first nPoints points (e.g. those that have left a sliding window); the index is kept up to date without rebuilding it
+            void RemoveLeadingPoints(size_t nPoints, unsigned component = 0);
+
             void ClearPoints(unsigned component = 0);
             void ClearIndex(unsigned component = 0);
 
@@ -109,6 +115,10 @@ namespace Katydid
             void BuildIndex(unsigned component = 0);
             void BuildIndex(DistanceMethod, unsigned maxLeafSize = 10, unsigned component = 0);
 
+            /// Adds the points added since the index was last built or updated to the index; builds the index if there isn't one, or if the settings have changed
+            void UpdateIndex(unsigned component = 0);
+            void UpdateIndex(DistanceMethod, unsigned maxLeafSize = 10, unsigned component = 0);
+
             KTKDTreeData& SetNComponents(unsigned channels);
 
         private:
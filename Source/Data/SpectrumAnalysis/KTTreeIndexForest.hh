@@ -0,0 +1,361 @@
+/*
+ * KTTreeIndexForest.hh
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ *
+ *  Incremental k-d tree index: a forest of nanoflann trees over blocks of points
+ */
+
+#ifndef KTTREEINDEXFOREST_HH_
+#define KTTREEINDEXFOREST_HH_
+
+#include "KTKDTree.hh"
+#include "KTLogger.hh"
+#include "KTPointCloud.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdint.h>
+#include <vector>
+
+namespace Katydid
+{
+    KTLOGGER(tiflog, "KTTreeIndexForest");
+
+    //***************************************
+    // Distance metrics for the forest
+    //***************************************
+
+    // The nanoflann adaptor for each metric, and the conversion between real distances and the distances used by the adaptor
+
+    template< typename TYPE >
+    struct KTManhattanMetric
+    {
+        template< typename DatasetAdaptor >
+        struct Adaptor
+        {
+            typedef nanoflann::L1_Adaptor< TYPE, DatasetAdaptor > type;
+        };
+        static TYPE ToIndexDistance(TYPE dist) {return dist;}
+        static TYPE FromIndexDistance(TYPE dist) {return dist;}
+    };
+
+    template< typename TYPE >
+    struct KTEuclideanMetric
+    {
+        template< typename DatasetAdaptor >
+        struct Adaptor
+        {
+            typedef nanoflann::L2_Simple_Adaptor< TYPE, DatasetAdaptor > type;
+        };
+        // nanoflann uses distance^2 for euclidean distances
+        static TYPE ToIndexDistance(TYPE dist) {return dist * dist;}
+        static TYPE FromIndexDistance(TYPE dist) {return sqrt(dist);}
+    };
+
+
+    //***************************************
+    // Incremental index interface
+    //***************************************
+
+    template< typename TYPE >
+    struct KTIncrementalTreeIndex : KTTreeIndex< TYPE >
+    {
+        virtual ~KTIncrementalTreeIndex() {}
+
+        /// Adds the points appended to the dataset since the index was last built or updated
+        virtual void AppendPoints() = 0;
+        /// Call after the first nPoints points have been erased from the front of the dataset
+        virtual void EvictPoints(size_t nPoints) = 0;
+    };
+
+
+    /*!
+     @class KTTreeIndexForest
+     @author N.S. Oblath
+
+     @brief k-d tree index that supports appending points and evicting the oldest ones without a full rebuild
+
+     @details
+     The points are indexed in blocks, each with its own nanoflann tree built over a copy of the block's coordinates.
+     When a block is appended, it's merged with the previous block as long as the previous block isn't larger
+     (logarithmic merging), so there are O(log N) blocks, and each point is re-indexed O(log N) times.
+
+     Points are evicted from the front of the dataset (e.g. slices that have left a sliding window).
+     The indices reported by the searches are indices in the dataset, so evicted points are skipped while searching;
+     blocks are dropped once all of their points have been evicted, and rebuilt once more than half of their points have been evicted.
+
+     Searches are done block by block with a single result set, so a k-nearest-neighbors search only
+     visits the parts of later blocks that could improve on the neighbors already found.
+     Neighbors from different blocks that are at the same distance are ordered by index.
+
+     The dataset must provide fPoints[i].fCoords (e.g. KTPointCloud) and the nanoflann dataset interface.
+    */
+
+    template< typename TYPE, typename DatasetAdaptor, typename Metric >
+    struct KTTreeIndexForest : KTIncrementalTreeIndex< TYPE >
+    {
+        typedef typename KTTreeIndex< TYPE >::PointId PointId;
+        typedef typename KTTreeIndex< TYPE >::Neighbors Neighbors;
+
+        typedef KTPointCloud< KT2DPoint< TYPE > > BlockCloud;
+        typedef nanoflann::KDTreeSingleIndexAdaptor< typename Metric::template Adaptor< BlockCloud >::type, BlockCloud, 2 > BlockTree;
+
+        struct Block
+        {
+            uint64_t fFirstId; // sequence number of the first point in the block
+            BlockCloud fCloud;
+            BlockTree* fTree;
+
+            Block(uint64_t firstId) : fFirstId(firstId), fCloud(), fTree(NULL) {}
+            ~Block() {delete fTree;}
+
+            inline size_t size() const {return fCloud.fPoints.size();}
+        };
+
+        /// Passes the points found in one block to the caller's result set, with dataset indices, skipping evicted points
+        template< typename RESULTSET >
+        struct BlockResultSet
+        {
+            RESULTSET& fResult;
+            uint64_t fFirstId;
+            uint64_t fFirstLiveId;
+
+            BlockResultSet(RESULTSET& result, uint64_t firstId, uint64_t firstLiveId) : fResult(result), fFirstId(firstId), fFirstLiveId(firstLiveId) {}
+
+            inline TYPE worstDist() const {return fResult.worstDist();}
+            inline bool full() const {return fResult.full();}
+            inline bool addPoint(TYPE dist, size_t index)
+            {
+                if (fFirstId + index < fFirstLiveId) return true;
+                return fResult.addPoint(dist, size_t(fFirstId + index - fFirstLiveId));
+            }
+        };
+
+        const DatasetAdaptor& fDataset;
+        unsigned fMaxLeafSize;
+        uint64_t fFirstLiveId; // sequence number of the first point in the dataset
+        uint64_t fNextId; // sequence number of the first point that isn't indexed yet
+        std::vector< Block* > fBlocks; // oldest first
+
+        KTTreeIndexForest(const DatasetAdaptor& inputData, const nanoflann::KDTreeSingleIndexAdaptorParams& params = nanoflann::KDTreeSingleIndexAdaptorParams()) :
+                fDataset(inputData),
+                fMaxLeafSize(params.leaf_max_size),
+                fFirstLiveId(0),
+                fNextId(0),
+                fBlocks()
+        {}
+        virtual ~KTTreeIndexForest()
+        {
+            FreeIndex();
+        }
+
+        //**************************
+        // Building and updating
+        //**************************
+
+        void FreeIndex()
+        {
+            for (typename std::vector< Block* >::iterator bIt = fBlocks.begin(); bIt != fBlocks.end(); ++bIt)
+            {
+                delete *bIt;
+            }
+            fBlocks.clear();
+            fNextId = fFirstLiveId;
+            return;
+        }
+
+        void BuildIndex()
+        {
+            FreeIndex();
+            AppendPoints();
+            return;
+        }
+
+        void AppendPoints()
+        {
+            size_t nIndexed = size();
+            size_t nPoints = fDataset.kdtree_get_point_count();
+            if (nPoints <= nIndexed) return;
+
+            Block* block = new Block(fNextId);
+            block->fCloud.fPoints.resize(nPoints - nIndexed);
+            for (size_t iPoint = nIndexed; iPoint < nPoints; ++iPoint)
+            {
+                block->fCloud.fPoints[iPoint - nIndexed].fCoords[0] = fDataset.fPoints[iPoint].fCoords[0];
+                block->fCloud.fPoints[iPoint - nIndexed].fCoords[1] = fDataset.fPoints[iPoint].fCoords[1];
+            }
+            fNextId += nPoints - nIndexed;
+
+            // merge with the previous blocks as long as they aren't larger than the new one
+            while (! fBlocks.empty() && NLivePoints(*fBlocks.back()) <= block->size())
+            {
+                Block* merged = LiveCopy(*fBlocks.back());
+                merged->fCloud.fPoints.insert(merged->fCloud.fPoints.end(), block->fCloud.fPoints.begin(), block->fCloud.fPoints.end());
+                delete fBlocks.back();
+                fBlocks.pop_back();
+                delete block;
+                block = merged;
+            }
+
+            BuildBlock(*block);
+            fBlocks.push_back(block);
+            KTDEBUG(tiflog, "Indexed " << nPoints - nIndexed << " new points; the index has " << fBlocks.size() << " blocks");
+            return;
+        }
+
+        void EvictPoints(size_t nPoints)
+        {
+            fFirstLiveId += nPoints;
+            if (fNextId < fFirstLiveId) fNextId = fFirstLiveId; // points that were evicted without being indexed
+
+            typename std::vector< Block* >::iterator firstKept = fBlocks.begin();
+            while (firstKept != fBlocks.end() && NLivePoints(**firstKept) == 0)
+            {
+                delete *firstKept;
+                ++firstKept;
+            }
+            fBlocks.erase(fBlocks.begin(), firstKept);
+
+            // don't let evicted points take up most of the oldest block
+            if (! fBlocks.empty() && 2 * NLivePoints(*fBlocks.front()) < fBlocks.front()->size())
+            {
+                Block* rebuilt = LiveCopy(*fBlocks.front());
+                BuildBlock(*rebuilt);
+                delete fBlocks.front();
+                fBlocks.front() = rebuilt;
+            }
+            return;
+        }
+
+        //**************************
+        // KTTreeIndex interface
+        //**************************
+
+        size_t size() const {return size_t(fNextId - fFirstLiveId);}
+        size_t Veclen() {return 2;}
+        size_t UsedMemory()
+        {
+            size_t memory = 0;
+            for (typename std::vector< Block* >::const_iterator bIt = fBlocks.begin(); bIt != fBlocks.end(); ++bIt)
+            {
+                memory += (*bIt)->fTree->usedMemory(*(*bIt)->fTree) + (*bIt)->size() * sizeof(KT2DPoint< TYPE >);
+            }
+            return memory;
+        }
+
+        void SaveIndex(FILE*)
+        {
+            KTERROR(tiflog, "Saving a k-d tree forest is not supported; rebuild it from the points instead");
+        }
+        void LoadIndex(FILE*)
+        {
+            KTERROR(tiflog, "Loading a k-d tree forest is not supported; rebuild it from the points instead");
+        }
+
+        void FindNeighbors(nanoflann::KNNResultSet< TYPE >& result, const TYPE* vec, const nanoflann::SearchParams& searchParams) const
+        {
+            SearchBlocks(result, vec, searchParams);
+        }
+        void FindNeighbors(nanoflann::RadiusResultSet< TYPE >& result, const TYPE* vec, const nanoflann::SearchParams& searchParams) const
+        {
+            SearchBlocks(result, vec, searchParams);
+        }
+        void KNNSearch(const TYPE* query_point, const size_t num_closest, size_t* out_indices, TYPE* out_distances_sq, const int /*nChecks_IGNORED*/=10) const
+        {
+            nanoflann::KNNResultSet< TYPE > resultSet(num_closest);
+            resultSet.init(out_indices, out_distances_sq);
+            SearchBlocks(resultSet, query_point, nanoflann::SearchParams());
+            return;
+        }
+        size_t RadiusSearch(const TYPE* query_point, const TYPE radius, std::vector< std::pair< size_t, TYPE > >& IndicesDists, const nanoflann::SearchParams& searchParams) const
+        {
+            nanoflann::RadiusResultSet< TYPE > resultSet(Metric::ToIndexDistance(radius), IndicesDists);
+            SearchBlocks(resultSet, query_point, searchParams);
+            if (searchParams.sorted) SortByDistance(IndicesDists);
+            return IndicesDists.size();
+        }
+        Neighbors NearestNeighborsByRadius(PointId pid, TYPE radius) const
+        {
+            Neighbors neighbors;
+            RadiusSearch(fDataset.fPoints[pid].fCoords, radius, neighbors.GetIndicesAndDists(), nanoflann::SearchParams(32, 0, true));
+            for (unsigned iPoint = 0; iPoint < neighbors.size(); ++iPoint)
+            {
+                neighbors.fIndicesAndDists[iPoint].second = Metric::FromIndexDistance(neighbors.fIndicesAndDists[iPoint].second);
+            }
+            return neighbors;
+        }
+        Neighbors NearestNeighborsByNumber(PointId pid, size_t nPoints) const
+        {
+            if (nPoints == 0) return Neighbors();
+
+            std::vector< size_t > indices(nPoints);
+            std::vector< TYPE > dists(nPoints);
+            nanoflann::KNNResultSet< TYPE > resultSet(nPoints);
+            resultSet.init(&indices[0], &dists[0]);
+            SearchBlocks(resultSet, fDataset.fPoints[pid].fCoords, nanoflann::SearchParams());
+
+            Neighbors neighbors;
+            for (size_t iPoint = 0; iPoint < resultSet.size(); ++iPoint)
+            {
+                neighbors.push_back(indices[iPoint], Metric::FromIndexDistance(dists[iPoint]));
+            }
+            SortByDistance(neighbors.GetIndicesAndDists());
+            return neighbors;
+        }
+
+        //**************************
+        // Internal functions
+        //**************************
+
+        inline size_t NLivePoints(const Block& block) const
+        {
+            uint64_t endId = block.fFirstId + block.size();
+            if (endId <= fFirstLiveId) return 0;
+            return size_t(endId - std::max(block.fFirstId, fFirstLiveId));
+        }
+
+        Block* LiveCopy(const Block& block) const
+        {
+            size_t nDead = block.size() - NLivePoints(block);
+            Block* copy = new Block(block.fFirstId + nDead);
+            copy->fCloud.fPoints.assign(block.fCloud.fPoints.begin() + nDead, block.fCloud.fPoints.end());
+            return copy;
+        }
+
+        void BuildBlock(Block& block) const
+        {
+            delete block.fTree;
+            block.fTree = new BlockTree(2, block.fCloud, nanoflann::KDTreeSingleIndexAdaptorParams(fMaxLeafSize));
+            block.fTree->buildIndex();
+            return;
+        }
+
+        template< typename RESULTSET >
+        void SearchBlocks(RESULTSET& result, const TYPE* vec, const nanoflann::SearchParams& searchParams) const
+        {
+            for (typename std::vector< Block* >::const_reverse_iterator bIt = fBlocks.rbegin(); bIt != fBlocks.rend(); ++bIt)
+            {
+                BlockResultSet< RESULTSET > blockResult(result, (*bIt)->fFirstId, fFirstLiveId);
+                (*bIt)->fTree->findNeighbors(blockResult, vec, searchParams);
+            }
+            return;
+        }
+
+        static bool CompareDistances(const std::pair< size_t, TYPE >& lhs, const std::pair< size_t, TYPE >& rhs)
+        {
+            return lhs.second < rhs.second || (lhs.second == rhs.second && lhs.first < rhs.first);
+        }
+
+        static void SortByDistance(std::vector< std::pair< size_t, TYPE > >& indicesDists)
+        {
+            std::sort(indicesDists.begin(), indicesDists.end(), CompareDistances);
+            return;
+        }
+    };
+
+} /* namespace Katydid */
+
+#endif /* KTTREEINDEXFOREST_HH_ */
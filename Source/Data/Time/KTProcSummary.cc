@@ -13,14 +13,22 @@ namespace Katydid
     KTProcSummary::KTProcSummary() :
             fNSlicesProcessed(0),
             fNRecordsProcessed(0),
-            fIntegratedTime(0.)
+            fIntegratedTime(0.),
+            fReadStallTime(0.),
+            fMeanReadQueueDepth(0.),
+            fNRecordCacheHits(0),
+            fNRecordCacheMisses(0)
     {
     }
 
     KTProcSummary::KTProcSummary(const KTProcSummary& orig) :
             fNSlicesProcessed(orig.fNSlicesProcessed),
             fNRecordsProcessed(orig.fNRecordsProcessed),
-            fIntegratedTime(orig.fIntegratedTime)
+            fIntegratedTime(orig.fIntegratedTime),
+            fReadStallTime(orig.fReadStallTime),
+            fMeanReadQueueDepth(orig.fMeanReadQueueDepth),
+            fNRecordCacheHits(orig.fNRecordCacheHits),
+            fNRecordCacheMisses(orig.fNRecordCacheMisses)
     {
     }
 
@@ -30,9 +38,13 @@ namespace Katydid
 
     KTProcSummary& KTProcSummary::operator=(const KTProcSummary& rhs)
     {
-        fNRecordsProcessed = rhs.fNSlicesProcessed;
+        fNRecordsProcessed = rhs.fNRecordsProcessed;
         fNSlicesProcessed = rhs.fNSlicesProcessed;
         fIntegratedTime = rhs.fIntegratedTime;
+        fReadStallTime = rhs.fReadStallTime;
+        fMeanReadQueueDepth = rhs.fMeanReadQueueDepth;
+        fNRecordCacheHits = rhs.fNRecordCacheHits;
+        fNRecordCacheMisses = rhs.fNRecordCacheMisses;
         return *this;
     }
 
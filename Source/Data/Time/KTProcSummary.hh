@@ -10,6 +10,7 @@
 
 #include "KTMemberVariable.hh"
 
+#include <cstdint>
 #include <string>
 
 namespace Katydid
@@ -27,6 +28,10 @@ namespace Katydid
             MEMBERVARIABLE(unsigned, NSlicesProcessed);
             MEMBERVARIABLE(unsigned, NRecordsProcessed); /// if any samples from a record were used, it's counted
             MEMBERVARIABLE(double, IntegratedTime); /// # of slices * slice size * bin width
+            MEMBERVARIABLE(double, ReadStallTime); /// time (s) spent waiting for the reader's read-ahead; only filled by readers that read ahead
+            MEMBERVARIABLE(double, MeanReadQueueDepth); /// average # of records read ahead when a record was needed
+            MEMBERVARIABLE(uint64_t, NRecordCacheHits); /// # of record reads served from records held by the reader
+            MEMBERVARIABLE(uint64_t, NRecordCacheMisses); /// # of record reads that needed a new record; only filled by readers that hold records
     };
 
 } /* namespace Katydid */
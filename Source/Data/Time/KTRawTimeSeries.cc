@@ -7,19 +7,24 @@
 
 #include "KTRawTimeSeries.hh"
 
+#include "KTObjectPool.hh"
+
 namespace Katydid
 {
+    typedef KTObjectPool< KTRawTimeSeries, KTRawTimeSeries::PoolKey > KTRawTimeSeriesPool;
 
     KTRawTimeSeries::KTRawTimeSeries() :
             KTVarTypePhysicalArray< uint64_t >(),
-            fSampleSize(1)
+            fSampleSize(1),
+            fBufferOwner()
     {
         SetAt(0., 0);
     }
 
     KTRawTimeSeries::KTRawTimeSeries(size_t dataTypeSize, uint32_t dataFormat, size_t nBins, double rangeMin, double rangeMax) :
             KTVarTypePhysicalArray< uint64_t >(dataTypeSize, dataFormat, nBins, rangeMin, rangeMax),
-            fSampleSize(1)
+            fSampleSize(1),
+            fBufferOwner()
     {
         for (unsigned iBin = 0; iBin < nBins; ++iBin)
         {
@@ -27,9 +32,18 @@ namespace Katydid
         }
     }
 
+    KTRawTimeSeries::KTRawTimeSeries(const std::shared_ptr< const void >& bufferOwner, const_storage_type data, size_t dataTypeSize, uint32_t dataFormat, size_t nBins, double rangeMin, double rangeMax) :
+            // the buffer may be shared with other slices, so the view is read-only
+            KTVarTypePhysicalArray< uint64_t >(const_cast< storage_type >(data), dataTypeSize, dataFormat, nBins, rangeMin, rangeMax, true),
+            fSampleSize(1),
+            fBufferOwner(bufferOwner)
+    {
+    }
+
     KTRawTimeSeries::KTRawTimeSeries(const KTRawTimeSeries& orig) :
             KTVarTypePhysicalArray< uint64_t >(orig),
-            fSampleSize(orig.fSampleSize)
+            fSampleSize(orig.fSampleSize),
+            fBufferOwner()
     {
     }
 
@@ -39,9 +53,37 @@ namespace Katydid
 
     KTRawTimeSeries& KTRawTimeSeries::operator=(const KTRawTimeSeries& rhs)
     {
+        if (&rhs == this) return *this;
         KTVarTypePhysicalArray< uint64_t >::operator=(rhs);
         fSampleSize = rhs.fSampleSize;
+        // the data were copied, so the buffer of the original view (if any) isn't needed
+        fBufferOwner.reset();
         return *this;
     }
 
+    KTRawTimeSeries* KTRawTimeSeries::Acquire(size_t dataTypeSize, uint32_t dataFormat, size_t nBins, double rangeMin, double rangeMax)
+    {
+        KTRawTimeSeries* ts = KTRawTimeSeriesPool::GetInstance().Take(PoolKey(dataTypeSize, dataFormat, nBins));
+        if (ts == NULL)
+        {
+            return new KTRawTimeSeries(dataTypeSize, dataFormat, nBins, rangeMin, rangeMax);
+        }
+        ts->SetRange(rangeMin, rangeMax);
+        ts->fSampleSize = 1;
+        ts->SetAxisLabel("");
+        return ts;
+    }
+
+    void KTRawTimeSeries::Release(KTRawTimeSeries* ts)
+    {
+        if (ts == NULL) return;
+        if (ts->IsView())
+        {
+            delete ts;
+            return;
+        }
+        KTRawTimeSeriesPool::GetInstance().Give(ts, PoolKey(ts->GetDataTypeSize(), ts->GetDataFormat(), ts->GetNBins()));
+        return;
+    }
+
 } /* namespace Katydid */
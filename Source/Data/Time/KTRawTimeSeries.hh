@@ -6,6 +6,15 @@
  *
  *  NOTE: For complex sampling, KTRawTimeSeries consists of a single array with interleaved real and imaginary samples.
  *        A KTRawTimeSeries with N complex samples will have 2*N bins.
+ *
+ *  NOTE: A KTRawTimeSeries can be a view of a buffer it doesn't own (e.g. a record held by an egg reader).
+ *        In that case it holds a reference-counted handle to the buffer's owner, which keeps the buffer alive.
+ *        Views are read-only (see KTVarTypePhysicalArray), so the buffer is never modified through them.
+ *        Copies of a view, and views that are assigned to, own a copy of the data.
+ *
+ *  NOTE: Acquire() and Release() recycle time series through an object pool (see KTObjectPool).
+ *        The contents of a time series returned by Acquire() are undefined.
+ *        Views are never pooled.
  */
 
 #ifndef KTRAWTIMESERIES_HH_
@@ -15,6 +24,9 @@
 
 #include "KTMemberVariable.hh"
 
+#include <memory>
+#include <tuple>
+
 namespace Katydid
 {
     
@@ -22,21 +34,41 @@ namespace Katydid
     class KTRawTimeSeries : public KTVarTypePhysicalArray< uint64_t >
     {
         public:
+            /// Key used for the object pool: data type size, data format, number of bins
+            typedef std::tuple< size_t, uint32_t, size_t > PoolKey;
+
             KTRawTimeSeries();
             KTRawTimeSeries(size_t dataTypeSize, uint32_t dataFormat, size_t nBins, double rangeMin, double rangeMax);
+            /// View constructor: reads the data buffer, which is kept alive by bufferOwner, without copying it
+            KTRawTimeSeries(const std::shared_ptr< const void >& bufferOwner, const_storage_type data, size_t dataTypeSize, uint32_t dataFormat, size_t nBins, double rangeMin, double rangeMax);
             KTRawTimeSeries(const KTRawTimeSeries& orig);
             virtual ~KTRawTimeSeries();
 
             KTRawTimeSeries& operator=(const KTRawTimeSeries& rhs);
 
+            /// Returns a time series from the pool if one with the same size and format is available; otherwise a new time series is created
+            static KTRawTimeSeries* Acquire(size_t dataTypeSize, uint32_t dataFormat, size_t nBins, double rangeMin, double rangeMax);
+            /// Returns the time series to the pool, or deletes it if the pool is full or the time series is a view
+            static void Release(KTRawTimeSeries* ts);
+
             /// Create an interface object with a different interface type
             template< typename XInterfaceType >
             KTVarTypePhysicalArray< XInterfaceType > CreateInterface() const;
 
             MEMBERVARIABLE(size_t, SampleSize);
 
+            bool IsView() const;
+
+        private:
+            std::shared_ptr< const void > fBufferOwner;
+
     };
 
+    inline bool KTRawTimeSeries::IsView() const
+    {
+        return ! fOwnsStorage;
+    }
+
     template< typename XInterfaceType >
     KTVarTypePhysicalArray< XInterfaceType > KTRawTimeSeries::CreateInterface() const
     {
@@ -22,7 +22,7 @@ namespace Katydid
     {
         while (! fTimeSeries.empty())
         {
-            delete fTimeSeries.back();
+            KTRawTimeSeries::Release(fTimeSeries.back());
             fTimeSeries.pop_back();
         }
     }
@@ -33,7 +33,7 @@ namespace Katydid
         // if num < oldSize
         for (unsigned iComponent = num; iComponent < oldSize; ++iComponent)
         {
-            delete fTimeSeries[iComponent];
+            KTRawTimeSeries::Release(fTimeSeries[iComponent]);
         }
         fTimeSeries.resize(num);
         // if num > oldSize
@@ -7,6 +7,11 @@
 
 #include "KTTimeSeries.hh"
 
+#include "KTTimeSeriesComplexFloat.hh"
+#include "KTTimeSeriesFFTW.hh"
+#include "KTTimeSeriesReal.hh"
+#include "KTTimeSeriesRealFloat.hh"
+
 namespace Katydid
 {
 
@@ -18,4 +23,34 @@ namespace Katydid
     {
     }
 
+    void KTTimeSeries::Release(KTTimeSeries* ts)
+    {
+        KTTimeSeriesReal* tsReal = dynamic_cast< KTTimeSeriesReal* >(ts);
+        if (tsReal != NULL)
+        {
+            KTTimeSeriesReal::Release(tsReal);
+            return;
+        }
+        KTTimeSeriesFFTW* tsFFTW = dynamic_cast< KTTimeSeriesFFTW* >(ts);
+        if (tsFFTW != NULL)
+        {
+            KTTimeSeriesFFTW::Release(tsFFTW);
+            return;
+        }
+        KTTimeSeriesRealFloat* tsRealFloat = dynamic_cast< KTTimeSeriesRealFloat* >(ts);
+        if (tsRealFloat != NULL)
+        {
+            KTTimeSeriesRealFloat::Release(tsRealFloat);
+            return;
+        }
+        KTTimeSeriesComplexFloat* tsComplexFloat = dynamic_cast< KTTimeSeriesComplexFloat* >(ts);
+        if (tsComplexFloat != NULL)
+        {
+            KTTimeSeriesComplexFloat::Release(tsComplexFloat);
+            return;
+        }
+        delete ts;
+        return;
+    }
+
 } /* namespace Katydid */
@@ -39,6 +39,9 @@ namespace Katydid
 
             virtual void Print(unsigned startPrint, unsigned nToPrint) const = 0;
 
+            /// Returns the time series to the pool for its concrete type (see, e.g., KTTimeSeriesReal::Release() and KTTimeSeriesFFTW::Release()), or deletes it
+            static void Release(KTTimeSeries* ts);
+
 #ifdef ROOT_FOUND
         public:
             virtual TH1D* CreateHistogram(const std::string& name = "hTimeSeries") const = 0;
@@ -0,0 +1,132 @@
+/*
+ * KTTimeSeriesComplexFloat.cc
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ */
+
+#include "KTTimeSeriesComplexFloat.hh"
+
+#include "KTLogger.hh"
+#include "KTObjectPool.hh"
+
+#ifdef ROOT_FOUND
+#include "TH1.h"
+#endif
+
+#include <sstream>
+
+using std::stringstream;
+
+namespace Katydid
+{
+    KTLOGGER(tslog, "KTTimeSeriesComplexFloat");
+
+    KTTimeSeriesComplexFloat::KTTimeSeriesComplexFloat() :
+            KTTimeSeries(),
+            KTPhysicalArray< 1, std::complex< float > >()
+    {
+    }
+
+    KTTimeSeriesComplexFloat::KTTimeSeriesComplexFloat(size_t nBins, double rangeMin, double rangeMax) :
+            KTTimeSeries(),
+            KTPhysicalArray< 1, std::complex< float > >(nBins, rangeMin, rangeMax)
+    {
+    }
+
+    KTTimeSeriesComplexFloat::KTTimeSeriesComplexFloat(const std::complex< float >& value, size_t nBins, double rangeMin, double rangeMax) :
+            KTTimeSeriesComplexFloat(nBins, rangeMin, rangeMax)
+    {
+        for (unsigned iBin = 0; iBin < nBins; ++iBin)
+        {
+            fData[iBin] = value;
+        }
+    }
+
+    KTTimeSeriesComplexFloat::KTTimeSeriesComplexFloat(const KTTimeSeriesComplexFloat& orig) :
+            KTTimeSeries(),
+            KTPhysicalArray< 1, std::complex< float > >(orig)
+    {
+    }
+
+    KTTimeSeriesComplexFloat::~KTTimeSeriesComplexFloat()
+    {
+    }
+
+    KTTimeSeriesComplexFloat& KTTimeSeriesComplexFloat::operator=(const KTTimeSeriesComplexFloat& rhs)
+    {
+        KTPhysicalArray< 1, std::complex< float > >::operator=(rhs);
+        return *this;
+    }
+
+    KTTimeSeriesComplexFloat* KTTimeSeriesComplexFloat::Acquire(size_t nBins, double rangeMin, double rangeMax)
+    {
+        KTTimeSeriesComplexFloat* ts = KTObjectPool< KTTimeSeriesComplexFloat >::GetInstance().Take(nBins);
+        if (ts == NULL)
+        {
+            return new KTTimeSeriesComplexFloat(nBins, rangeMin, rangeMax);
+        }
+        ts->SetRange(rangeMin, rangeMax);
+        ts->SetAxisLabel("");
+        ts->SetDataLabel("");
+        return ts;
+    }
+
+    void KTTimeSeriesComplexFloat::Release(KTTimeSeriesComplexFloat* ts)
+    {
+        if (ts == NULL) return;
+        KTObjectPool< KTTimeSeriesComplexFloat >::GetInstance().Give(ts, ts->size());
+        return;
+    }
+
+    void KTTimeSeriesComplexFloat::Print(unsigned startPrint, unsigned nToPrint) const
+    {
+        stringstream printStream;
+        for (unsigned iBin = startPrint; iBin < startPrint + nToPrint; ++iBin)
+        {
+            printStream << "Bin " << iBin << ";   x = " << GetBinCenter(iBin) <<
+                    ";   y = " << (*this)(iBin) << "\n";
+        }
+        KTDEBUG(tslog, "\n" << printStream.str());
+        return;
+    }
+
+#ifdef ROOT_FOUND
+    TH1D* KTTimeSeriesComplexFloat::CreateHistogram(const std::string& name) const
+    {
+        unsigned nBins = GetNBins();
+        TH1D* hist = new TH1D(name.c_str(), "Time Series", (int)nBins, GetRangeMin(), GetRangeMax());
+        for (unsigned iBin=0; iBin<nBins; ++iBin)
+        {
+            hist->SetBinContent((int)iBin+1, (*this)(iBin).real());
+        }
+        hist->SetXTitle("Time (s)");
+        hist->SetYTitle("Voltage (V)");
+        return hist;
+    }
+
+    TH1D* KTTimeSeriesComplexFloat::CreateAmplitudeDistributionHistogram(const std::string& name) const
+    {
+        double tMaxMag = -1.;
+        double tMinMag = 1.e9;
+        unsigned nBins = GetNTimeBins();
+        double value;
+        for (unsigned iBin=0; iBin<nBins; ++iBin)
+        {
+            value = (*this)(iBin).real();
+            if (value < tMinMag) tMinMag = value;
+            if (value > tMaxMag) tMaxMag = value;
+        }
+        if (tMinMag < 1. && tMaxMag > 1.) tMinMag = 0.;
+        TH1D* hist = new TH1D(name.c_str(), "Voltage Distribution", 100, tMinMag*0.95, tMaxMag*1.05);
+        for (unsigned iBin=0; iBin<nBins; ++iBin)
+        {
+            hist->Fill((*this)(iBin).real());
+        }
+        hist->SetXTitle("Voltage (V)");
+        return hist;
+    }
+
+#endif
+
+} /* namespace Katydid */
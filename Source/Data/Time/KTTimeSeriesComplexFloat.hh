@@ -0,0 +1,98 @@
+/*
+ * KTTimeSeriesComplexFloat.hh
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ */
+
+#ifndef KTTIMESERIESCOMPLEXFLOAT_HH_
+#define KTTIMESERIESCOMPLEXFLOAT_HH_
+
+#include "KTPhysicalArray.hh"
+#include "KTTimeSeries.hh"
+
+#include <complex>
+
+namespace Katydid
+{
+
+    /*!
+     @class KTTimeSeriesComplexFloat
+     @author N. S. Oblath
+
+     @brief Complex time series stored in single precision
+
+     @details
+     Single-precision counterpart of KTTimeSeriesFFTW.
+     std::complex< float > has the same layout as fftwf_complex (float[2]), so the storage is the interleaved real and imaginary parts,
+     and it can be handed to the single-precision FFTW interface with a reinterpret_cast.
+     As with KTTimeSeriesFFTW, the KTTimeSeries interface accesses the real part.
+    */
+    class KTTimeSeriesComplexFloat : public KTTimeSeries, public KTPhysicalArray< 1, std::complex< float > >
+    {
+        public:
+            KTTimeSeriesComplexFloat();
+            KTTimeSeriesComplexFloat(size_t nBins, double rangeMin=0., double rangeMax=1.);
+            KTTimeSeriesComplexFloat(const std::complex< float >& value, size_t nBins, double rangeMin=0., double rangeMax=1.);
+            KTTimeSeriesComplexFloat(const KTTimeSeriesComplexFloat& orig);
+            virtual ~KTTimeSeriesComplexFloat();
+
+            KTTimeSeriesComplexFloat& operator=(const KTTimeSeriesComplexFloat& rhs);
+
+            /// Returns a time series from the pool if one of the same size is available; otherwise a new time series is created.  The contents are undefined.
+            static KTTimeSeriesComplexFloat* Acquire(size_t nBins, double rangeMin=0., double rangeMax=1.);
+            /// Returns the time series to the pool, or deletes it if the pool is full
+            static void Release(KTTimeSeriesComplexFloat* ts);
+
+            virtual void Scale(double scale);
+
+            virtual unsigned GetNTimeBins() const;
+            virtual double GetTimeBinWidth() const;
+
+            virtual void SetValue(unsigned bin, double value);
+            virtual double GetValue(unsigned bin) const;
+
+            virtual void Print(unsigned startPrint, unsigned nToPrint) const;
+
+#ifdef ROOT_FOUND
+        public:
+            virtual TH1D* CreateHistogram(const std::string& name = "hTimeSeries") const;
+
+            virtual TH1D* CreateAmplitudeDistributionHistogram(const std::string& name = "hTimeSeriesDist") const;
+#endif
+    };
+
+    inline void KTTimeSeriesComplexFloat::Scale(double scale)
+    {
+        float floatScale = scale;
+        unsigned nBins = size();
+        for (unsigned iBin = 0; iBin < nBins; ++iBin)
+        {
+            fData[iBin] *= floatScale;
+        }
+        return;
+    }
+
+    inline unsigned KTTimeSeriesComplexFloat::GetNTimeBins() const
+    {
+        return this->size();
+    }
+
+    inline double KTTimeSeriesComplexFloat::GetTimeBinWidth() const
+    {
+        return this->GetBinWidth();
+    }
+
+    inline void KTTimeSeriesComplexFloat::SetValue(unsigned bin, double value)
+    {
+        (*this)(bin) = std::complex< float >(value, 0.f);
+        return;
+    }
+
+    inline double KTTimeSeriesComplexFloat::GetValue(unsigned bin) const
+    {
+        return (*this)(bin).real();
+    }
+
+} /* namespace Katydid */
+#endif /* KTTIMESERIESCOMPLEXFLOAT_HH_ */
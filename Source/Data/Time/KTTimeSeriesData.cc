@@ -19,7 +19,7 @@ namespace Katydid
     {
         while (! fTimeSeries.empty())
         {
-            delete fTimeSeries.back();
+            KTTimeSeries::Release(fTimeSeries.back());
             fTimeSeries.pop_back();
         }
     }
@@ -43,7 +43,7 @@ namespace Katydid
         // if num < oldSize
         for (unsigned iComponent = num; iComponent < oldSize; ++iComponent)
         {
-            delete fTimeSeries[iComponent];
+            KTTimeSeries::Release(fTimeSeries[iComponent]);
         }
         fTimeSeries.resize(num);
         // if num > oldSize
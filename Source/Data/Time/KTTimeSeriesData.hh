@@ -61,7 +61,7 @@ namespace Katydid
     inline void KTTimeSeriesDataCore::SetTimeSeries(KTTimeSeries* record, unsigned component)
     {
         if (component >= fTimeSeries.size()) SetNComponents(component+1);
-        if (fTimeSeries[component] != NULL) delete fTimeSeries[component];
+        if (fTimeSeries[component] != NULL) KTTimeSeries::Release(fTimeSeries[component]);
         fTimeSeries[component] = record;
         return;
     }
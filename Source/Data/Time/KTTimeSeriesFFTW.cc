@@ -8,6 +8,7 @@
 #include "KTTimeSeriesFFTW.hh"
 
 #include "KTLogger.hh"
+#include "KTObjectPool.hh"
 
 #ifdef ROOT_FOUND
 #include "TH1.h"
@@ -62,6 +63,26 @@ namespace Katydid
         return *this;
     }
 
+    KTTimeSeriesFFTW* KTTimeSeriesFFTW::Acquire(size_t nBins, double rangeMin, double rangeMax)
+    {
+        KTTimeSeriesFFTW* ts = KTObjectPool< KTTimeSeriesFFTW >::GetInstance().Take(nBins);
+        if (ts == NULL)
+        {
+            return new KTTimeSeriesFFTW(nBins, rangeMin, rangeMax);
+        }
+        ts->SetRange(rangeMin, rangeMax);
+        ts->SetAxisLabel("");
+        ts->SetDataLabel("");
+        return ts;
+    }
+
+    void KTTimeSeriesFFTW::Release(KTTimeSeriesFFTW* ts)
+    {
+        if (ts == NULL) return;
+        KTObjectPool< KTTimeSeriesFFTW >::GetInstance().Give(ts, ts->size());
+        return;
+    }
+
     void KTTimeSeriesFFTW::Print(unsigned startPrint, unsigned nToPrint) const
     {
         stringstream printStream;
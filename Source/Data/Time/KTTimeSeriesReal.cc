@@ -8,6 +8,7 @@
 #include "KTTimeSeriesReal.hh"
 
 #include "KTLogger.hh"
+#include "KTObjectPool.hh"
 
 #ifdef ROOT_FOUND
 #include "TH1.h"
@@ -58,6 +59,26 @@ namespace Katydid
         return *this;
     }
 
+    KTTimeSeriesReal* KTTimeSeriesReal::Acquire(size_t nBins, double rangeMin, double rangeMax)
+    {
+        KTTimeSeriesReal* ts = KTObjectPool< KTTimeSeriesReal >::GetInstance().Take(nBins);
+        if (ts == NULL)
+        {
+            return new KTTimeSeriesReal(nBins, rangeMin, rangeMax);
+        }
+        ts->SetRange(rangeMin, rangeMax);
+        ts->SetAxisLabel("");
+        ts->SetDataLabel("");
+        return ts;
+    }
+
+    void KTTimeSeriesReal::Release(KTTimeSeriesReal* ts)
+    {
+        if (ts == NULL) return;
+        KTObjectPool< KTTimeSeriesReal >::GetInstance().Give(ts, ts->size());
+        return;
+    }
+
     void KTTimeSeriesReal::Print(unsigned startPrint, unsigned nToPrint) const
     {
         stringstream printStream;
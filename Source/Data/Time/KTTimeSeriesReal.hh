@@ -25,6 +25,11 @@ namespace Katydid
 
             KTTimeSeriesReal& operator=(const KTTimeSeriesReal& rhs);
 
+            /// Returns a time series from the pool if one of the same size is available; otherwise a new time series is created.  The contents are undefined.
+            static KTTimeSeriesReal* Acquire(size_t nBins, double rangeMin=0., double rangeMax=1.);
+            /// Returns the time series to the pool, or deletes it if the pool is full
+            static void Release(KTTimeSeriesReal* ts);
+
             virtual void Scale(double scale);
 
             virtual unsigned GetNTimeBins() const;
@@ -0,0 +1,132 @@
+/*
+ * KTTimeSeriesRealFloat.cc
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ */
+
+#include "KTTimeSeriesRealFloat.hh"
+
+#include "KTLogger.hh"
+#include "KTObjectPool.hh"
+
+#ifdef ROOT_FOUND
+#include "TH1.h"
+#endif
+
+#include <sstream>
+
+using std::stringstream;
+
+namespace Katydid
+{
+    KTLOGGER(tslog, "KTTimeSeriesRealFloat");
+
+    KTTimeSeriesRealFloat::KTTimeSeriesRealFloat() :
+            KTTimeSeries(),
+            KTPhysicalArray< 1, float >()
+    {
+    }
+
+    KTTimeSeriesRealFloat::KTTimeSeriesRealFloat(size_t nBins, double rangeMin, double rangeMax) :
+            KTTimeSeries(),
+            KTPhysicalArray< 1, float >(nBins, rangeMin, rangeMax)
+    {
+    }
+
+    KTTimeSeriesRealFloat::KTTimeSeriesRealFloat(float value, size_t nBins, double rangeMin, double rangeMax) :
+            KTTimeSeriesRealFloat(nBins, rangeMin, rangeMax)
+    {
+        for (unsigned iBin = 0; iBin < nBins; ++iBin)
+        {
+            fData[iBin] = value;
+        }
+    }
+
+    KTTimeSeriesRealFloat::KTTimeSeriesRealFloat(const KTTimeSeriesRealFloat& orig) :
+            KTTimeSeries(),
+            KTPhysicalArray< 1, float >(orig)
+    {
+    }
+
+    KTTimeSeriesRealFloat::~KTTimeSeriesRealFloat()
+    {
+    }
+
+    KTTimeSeriesRealFloat& KTTimeSeriesRealFloat::operator=(const KTTimeSeriesRealFloat& rhs)
+    {
+        KTPhysicalArray< 1, float >::operator=(rhs);
+        return *this;
+    }
+
+    KTTimeSeriesRealFloat* KTTimeSeriesRealFloat::Acquire(size_t nBins, double rangeMin, double rangeMax)
+    {
+        KTTimeSeriesRealFloat* ts = KTObjectPool< KTTimeSeriesRealFloat >::GetInstance().Take(nBins);
+        if (ts == NULL)
+        {
+            return new KTTimeSeriesRealFloat(nBins, rangeMin, rangeMax);
+        }
+        ts->SetRange(rangeMin, rangeMax);
+        ts->SetAxisLabel("");
+        ts->SetDataLabel("");
+        return ts;
+    }
+
+    void KTTimeSeriesRealFloat::Release(KTTimeSeriesRealFloat* ts)
+    {
+        if (ts == NULL) return;
+        KTObjectPool< KTTimeSeriesRealFloat >::GetInstance().Give(ts, ts->size());
+        return;
+    }
+
+    void KTTimeSeriesRealFloat::Print(unsigned startPrint, unsigned nToPrint) const
+    {
+        stringstream printStream;
+        for (unsigned iBin = startPrint; iBin < startPrint + nToPrint; ++iBin)
+        {
+            printStream << "Bin " << iBin << ";   x = " << GetBinCenter(iBin) <<
+                    ";   y = " << (*this)(iBin) << "\n";
+        }
+        KTDEBUG(tslog, "\n" << printStream.str());
+        return;
+    }
+
+#ifdef ROOT_FOUND
+    TH1D* KTTimeSeriesRealFloat::CreateHistogram(const std::string& name) const
+    {
+        unsigned nBins = GetNBins();
+        TH1D* hist = new TH1D(name.c_str(), "Time Series", (int)nBins, GetRangeMin(), GetRangeMax());
+        for (unsigned iBin=0; iBin<nBins; ++iBin)
+        {
+            hist->SetBinContent((int)iBin+1, (*this)(iBin));
+        }
+        hist->SetXTitle("Time (s)");
+        hist->SetYTitle("Voltage (V)");
+        return hist;
+    }
+
+    TH1D* KTTimeSeriesRealFloat::CreateAmplitudeDistributionHistogram(const std::string& name) const
+    {
+        double tMaxMag = -1.;
+        double tMinMag = 1.e9;
+        unsigned nBins = GetNTimeBins();
+        double value;
+        for (unsigned iBin=0; iBin<nBins; ++iBin)
+        {
+            value = (*this)(iBin);
+            if (value < tMinMag) tMinMag = value;
+            if (value > tMaxMag) tMaxMag = value;
+        }
+        if (tMinMag < 1. && tMaxMag > 1.) tMinMag = 0.;
+        TH1D* hist = new TH1D(name.c_str(), "Voltage Distribution", 100, tMinMag*0.95, tMaxMag*1.05);
+        for (unsigned iBin=0; iBin<nBins; ++iBin)
+        {
+            hist->Fill((*this)(iBin));
+        }
+        hist->SetXTitle("Voltage (V)");
+        return hist;
+    }
+
+#endif
+
+} /* namespace Katydid */
@@ -0,0 +1,95 @@
+/*
+ * KTTimeSeriesRealFloat.hh
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ */
+
+#ifndef KTTIMESERIESREALFLOAT_HH_
+#define KTTIMESERIESREALFLOAT_HH_
+
+#include "KTPhysicalArray.hh"
+#include "KTTimeSeries.hh"
+
+namespace Katydid
+{
+
+    /*!
+     @class KTTimeSeriesRealFloat
+     @author N. S. Oblath
+
+     @brief Real time series stored in single precision
+
+     @details
+     Same interface as KTTimeSeriesReal, with half of the memory and memory bandwidth.
+     Single-precision voltages are more than enough for the 8- to 16-bit digitizers whose data they hold.
+     The KTTimeSeries interface still works in double precision.
+    */
+    class KTTimeSeriesRealFloat : public KTTimeSeries, public KTPhysicalArray< 1, float >
+    {
+        public:
+            KTTimeSeriesRealFloat();
+            KTTimeSeriesRealFloat(size_t nBins, double rangeMin=0., double rangeMax=1.);
+            KTTimeSeriesRealFloat(float value, size_t nBins, double rangeMin=0., double rangeMax=1.);
+            KTTimeSeriesRealFloat(const KTTimeSeriesRealFloat& orig);
+            virtual ~KTTimeSeriesRealFloat();
+
+            KTTimeSeriesRealFloat& operator=(const KTTimeSeriesRealFloat& rhs);
+
+            /// Returns a time series from the pool if one of the same size is available; otherwise a new time series is created.  The contents are undefined.
+            static KTTimeSeriesRealFloat* Acquire(size_t nBins, double rangeMin=0., double rangeMax=1.);
+            /// Returns the time series to the pool, or deletes it if the pool is full
+            static void Release(KTTimeSeriesRealFloat* ts);
+
+            virtual void Scale(double scale);
+
+            virtual unsigned GetNTimeBins() const;
+            virtual double GetTimeBinWidth() const;
+
+            virtual void SetValue(unsigned bin, double value);
+            virtual double GetValue(unsigned bin) const;
+
+            virtual void Print(unsigned startPrint, unsigned nToPrint) const;
+
+#ifdef ROOT_FOUND
+        public:
+            virtual TH1D* CreateHistogram(const std::string& name = "hTimeSeries") const;
+
+            virtual TH1D* CreateAmplitudeDistributionHistogram(const std::string& name = "hTimeSeriesDist") const;
+#endif
+    };
+
+    inline void KTTimeSeriesRealFloat::Scale(double scale)
+    {
+        float floatScale = scale;
+        unsigned nBins = size();
+        for (unsigned iBin = 0; iBin < nBins; ++iBin)
+        {
+            fData[iBin] *= floatScale;
+        }
+        return;
+    }
+
+    inline unsigned KTTimeSeriesRealFloat::GetNTimeBins() const
+    {
+        return this->size();
+    }
+
+    inline double KTTimeSeriesRealFloat::GetTimeBinWidth() const
+    {
+        return this->GetBinWidth();
+    }
+
+    inline void KTTimeSeriesRealFloat::SetValue(unsigned bin, double value)
+    {
+        (*this)(bin) = value;
+        return;
+    }
+
+    inline double KTTimeSeriesRealFloat::GetValue(unsigned bin) const
+    {
+        return (*this)(bin);
+    }
+
+} /* namespace Katydid */
+#endif /* KTTIMESERIESREALFLOAT_HH_ */
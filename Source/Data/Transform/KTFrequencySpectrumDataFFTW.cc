@@ -20,7 +20,7 @@ namespace Katydid
     {
         while (! fSpectra.empty())
         {
-            delete fSpectra.back();
+            KTFrequencySpectrumFFTW::Release(fSpectra.back());
             fSpectra.pop_back();
         }
     }
@@ -44,7 +44,7 @@ namespace Katydid
         // if components < oldSize
         for (unsigned iComponent = components; iComponent < oldSize; ++iComponent)
         {
-            delete fSpectra[iComponent];
+            KTFrequencySpectrumFFTW::Release(fSpectra[iComponent]);
         }
         fSpectra.resize(components);
         // if components > oldSize
@@ -116,7 +116,7 @@ namespace Katydid
     inline void KTFrequencySpectrumDataFFTWCore::SetSpectrum(KTFrequencySpectrumFFTW* record, unsigned component)
     {
         if (component >= fSpectra.size()) SetNComponents(component+1);
-        else delete fSpectra[component];
+        else KTFrequencySpectrumFFTW::Release(fSpectra[component]);
         fSpectra[component] = record;
         return;
     }
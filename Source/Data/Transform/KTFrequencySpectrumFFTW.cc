@@ -8,6 +8,7 @@
 #include "KTFrequencySpectrumFFTW.hh"
 
 #include "KTLogger.hh"
+#include "KTObjectPool.hh"
 #include "KTPowerSpectrum.hh"
 #include "KTFrequencySpectrumPolar.hh"
 
@@ -88,6 +89,39 @@ namespace Katydid
     {
     }
 
+    KTFrequencySpectrumFFTW* KTFrequencySpectrumFFTW::Acquire(size_t nBins, double rangeMin, double rangeMax, bool arrayOrderIsFlipped)
+    {
+        KTFrequencySpectrumFFTW* fs = KTObjectPool< KTFrequencySpectrumFFTW >::GetInstance().Take(nBins);
+        if (fs == NULL)
+        {
+            return new KTFrequencySpectrumFFTW(nBins, rangeMin, rangeMax, arrayOrderIsFlipped);
+        }
+        // the size-dependent members are already correct; everything else is reset to the state given by the constructor
+        fs->SetRange(rangeMin, rangeMax);
+        fs->fIsArrayOrderFlipped = arrayOrderIsFlipped;
+        if (arrayOrderIsFlipped)
+        {
+            fs->fConstBinAccess = &KTFrequencySpectrumFFTW::ReorderedBinAccess;
+            fs->fBinAccess = &KTFrequencySpectrumFFTW::ReorderedBinAccess;
+        }
+        else
+        {
+            fs->fConstBinAccess = &KTFrequencySpectrumFFTW::AsIsBinAccess;
+            fs->fBinAccess = &KTFrequencySpectrumFFTW::AsIsBinAccess;
+        }
+        fs->fNTimeBins = 0;
+        fs->SetAxisLabel("");
+        fs->SetDataLabel("");
+        return fs;
+    }
+
+    void KTFrequencySpectrumFFTW::Release(KTFrequencySpectrumFFTW* fs)
+    {
+        if (fs == NULL) return;
+        KTObjectPool< KTFrequencySpectrumFFTW >::GetInstance().Give(fs, fs->size());
+        return;
+    }
+
     KTFrequencySpectrumFFTW& KTFrequencySpectrumFFTW::operator=(const KTFrequencySpectrumFFTW& rhs)
     {
         KTPhysicalArray< 1, fftw_complex >::operator=(rhs);
@@ -175,6 +209,25 @@ namespace Katydid
     }
 
     KTPowerSpectrum* KTFrequencySpectrumFFTW::CreatePowerSpectrum() const
+    {
+        // multiplying by 1 is exact, so this is identical to not scaling
+        return CreateScaledPowerSpectrum(1.);
+    }
+
+    KTPowerSpectrum* KTFrequencySpectrumFFTW::CreateScaledPowerSpectrum(double amplitudeScale) const
+    {
+        return CreateScaledPowerSpectrum< double >(fData, amplitudeScale);
+    }
+
+#ifdef FFTWF_FOUND
+    KTPowerSpectrum* KTFrequencySpectrumFFTW::CreateScaledPowerSpectrum(const fftwf_complex* data, float amplitudeScale) const
+    {
+        return CreateScaledPowerSpectrum< float >(data, amplitudeScale);
+    }
+#endif
+
+    template< typename XValue >
+    KTPowerSpectrum* KTFrequencySpectrumFFTW::CreateScaledPowerSpectrum(const XValue (*data)[2], XValue amplitudeScale) const
     {
         // This function creates a power spectrum that runs from the smallest to the largest absolute frequency.
         // It can handle frequency ranges that do or don't cross DC, and that are symmetric or asymmetric.
@@ -191,7 +244,8 @@ namespace Katydid
             nBins = size();
         }
 
-        KTPowerSpectrum* newPS = new KTPowerSpectrum(nBins, minFreq, maxFreq);
+        // the spectrum is zeroed here, so a recycled spectrum can be used
+        KTPowerSpectrum* newPS = KTPowerSpectrum::Acquire(nBins, minFreq, maxFreq);
         for (unsigned iBin = 0; iBin < nBins; ++iBin) (*newPS)(iBin) = 0.;
 
         int dcBin = FindBin(0.);
@@ -212,22 +266,26 @@ namespace Katydid
         }
         //KTWARN( fslog, "firstPosFreqBin = " << firstPosFreqBin << "; lastPosFreqBin = " << lastPosFreqBin << "; firstNegFreqBin = " << firstNegFreqBin << "; lastNegFreqBin = " << lastNegFreqBin);
 
-        double scaling = 1. / KTPowerSpectrum::GetResistance() / (double)GetNTimeBins();
+        // power-spectrum bins run up in absolute frequency: positive-frequency bins map to (iBin - firstPosFreqBin),
+        // and negative-frequency bins to (negFreqOffset - iBin), which is 1 for the bin just below DC if the range crosses DC
+        int negFreqOffset = dcBin >= (int)size() ? (int)size() - 1 : dcBin;
+
+        XValue scaling = XValue(1. / KTPowerSpectrum::GetResistance() / (double)GetNTimeBins());
 
-        double valueImag, valueReal;
+        XValue valueImag, valueReal;
 #pragma omp parallel for private(valueReal, valueImag)
         for (unsigned iBin = firstPosFreqBin; iBin < lastPosFreqBin; ++iBin)
         {
-            valueReal = (*this)(iBin)[0];
-            valueImag = (*this)(iBin)[1];
-            (*newPS)(iBin) = (valueReal * valueReal + valueImag * valueImag) * scaling;
+            valueReal = data[ArrayIndex(iBin)][0] * amplitudeScale;
+            valueImag = data[ArrayIndex(iBin)][1] * amplitudeScale;
+            (*newPS)(iBin - firstPosFreqBin) = (valueReal * valueReal + valueImag * valueImag) * scaling;
         }
 #pragma omp parallel for private(valueReal, valueImag)
         for (unsigned iBin = firstNegFreqBin; iBin < lastNegFreqBin; ++iBin)
         {
-            valueReal = (*this)(iBin)[0];
-            valueImag = (*this)(iBin)[1];
-            (*newPS)(iBin) = (valueReal * valueReal + valueImag * valueImag) * scaling;
+            valueReal = data[ArrayIndex(iBin)][0] * amplitudeScale;
+            valueImag = data[ArrayIndex(iBin)][1] * amplitudeScale;
+            (*newPS)(negFreqOffset - iBin) += (valueReal * valueReal + valueImag * valueImag) * scaling;
         }
 
         return newPS;
@@ -29,6 +29,11 @@ namespace Katydid
             KTFrequencySpectrumFFTW(const KTFrequencySpectrumFFTW& orig);
             virtual ~KTFrequencySpectrumFFTW();
 
+            /// Returns a spectrum from the pool if one of the same size is available; otherwise a new spectrum is created.  The contents are undefined.
+            static KTFrequencySpectrumFFTW* Acquire(size_t nBins, double rangeMin=0., double rangeMax=1., bool arrayOrderIsFlipped=false);
+            /// Returns the spectrum to the pool, or deletes it if the pool is full
+            static void Release(KTFrequencySpectrumFFTW* fs);
+
         public:
             bool GetIsArrayOrderFlipped() const;
             bool GetIsSizeEven() const;
@@ -82,6 +87,13 @@ namespace Katydid
             const fftw_complex& AsIsBinAccess(unsigned i) const;
             fftw_complex& AsIsBinAccess(unsigned i);
 
+            /// Position in the array of bin i
+            size_t ArrayIndex(unsigned i) const;
+
+            /// Fills a power spectrum from data laid out like this spectrum's array; XValue is the precision of the data and the calculation
+            template< typename XValue >
+            KTPowerSpectrum* CreateScaledPowerSpectrum(const XValue (*data)[2], XValue amplitudeScale) const;
+
         public:
             // normal KTFrequencySpectrumPolar functions
 
@@ -96,6 +108,14 @@ namespace Katydid
 
             virtual KTFrequencySpectrumPolar* CreateFrequencySpectrumPolar() const;
             virtual KTPowerSpectrum* CreatePowerSpectrum() const;
+            /// Same as CreatePowerSpectrum(), except that the amplitudes are multiplied by amplitudeScale as they're read.
+            /// This gives the same result as Scale(amplitudeScale) followed by CreatePowerSpectrum(), without modifying this spectrum.
+            KTPowerSpectrum* CreateScaledPowerSpectrum(double amplitudeScale) const;
+#ifdef FFTWF_FOUND
+            /// Same as CreateScaledPowerSpectrum(double), except that the amplitudes are read from single-precision data that's laid out like this spectrum's array
+            /// (e.g. KTForwardFFTW::GetSinglePrecisionOutput()), and the power is calculated in single precision.
+            KTPowerSpectrum* CreateScaledPowerSpectrum(const fftwf_complex* data, float amplitudeScale) const;
+#endif
 
             void Print(unsigned startPrint, unsigned nToPrint) const;
 
@@ -151,6 +171,12 @@ namespace Katydid
         return (i >= fCenterBin) ? fData[i - fCenterBin] : fData[i + fLeftOfCenterOffset];
     }
 
+    inline size_t KTFrequencySpectrumFFTW::ArrayIndex(unsigned i) const
+    {
+        if (! fIsArrayOrderFlipped) return i;
+        return (i >= fCenterBin) ? i - fCenterBin : i + fLeftOfCenterOffset;
+    }
+
     inline const fftw_complex& KTFrequencySpectrumFFTW::AsIsBinAccess(unsigned i) const
     {
         return fData[i];
@@ -131,6 +131,10 @@ namespace Katydid
             firstNegFreqBin = dcBin; // lastNegFreqBin = dcBin;
         }
 
+        // power-spectrum bins run up in absolute frequency: positive-frequency bins map to (iBin - firstPosFreqBin),
+        // and negative-frequency bins to (negFreqOffset - iBin), which is 1 for the bin just below DC if the range crosses DC
+        int negFreqOffset = dcBin >= (int)size() ? (int)size() - 1 : dcBin;
+
         double scaling = 1. / KTPowerSpectrum::GetResistance() / (double)GetNTimeBins();
 
         double value;
@@ -138,13 +142,13 @@ namespace Katydid
         for (unsigned iBin = firstPosFreqBin; iBin < lastPosFreqBin; ++iBin)
         {
             value = (*this)(iBin).abs();
-            (*newPS)(iBin) = value * value * scaling;
+            (*newPS)(iBin - firstPosFreqBin) = value * value * scaling;
         }
 #pragma omp parallel for private(value)
         for (unsigned iBin = firstNegFreqBin; iBin < lastNegFreqBin; ++iBin)
         {
             value = (*this)(iBin).abs();
-            (*newPS)(iBin) = value * value * scaling;
+            (*newPS)(negFreqOffset - iBin) += value * value * scaling;
         }
 
         return newPS;
@@ -8,6 +8,7 @@
 #include "KTPowerSpectrum.hh"
 
 #include "KTLogger.hh"
+#include "KTObjectPool.hh"
 
 namespace Katydid
 {
@@ -68,6 +69,27 @@ namespace Katydid
     }
 
 
+    KTPowerSpectrum* KTPowerSpectrum::Acquire(size_t nBins, double rangeMin, double rangeMax)
+    {
+        KTPowerSpectrum* ps = KTObjectPool< KTPowerSpectrum >::GetInstance().Take(nBins);
+        if (ps == NULL)
+        {
+            return new KTPowerSpectrum(nBins, rangeMin, rangeMax);
+        }
+        ps->SetRange(rangeMin, rangeMax);
+        ps->fMode = kPower;
+        ps->SetAxisLabel("Frequency (Hz)");
+        ps->SetDataLabel("Power (W)");
+        return ps;
+    }
+
+    void KTPowerSpectrum::Release(KTPowerSpectrum* ps)
+    {
+        if (ps == NULL) return;
+        KTObjectPool< KTPowerSpectrum >::GetInstance().Give(ps, ps->size());
+        return;
+    }
+
     KTPowerSpectrum& KTPowerSpectrum::operator=(const KTPowerSpectrum& rhs)
     {
         KTPhysicalArray< 1, double >::operator=(rhs);
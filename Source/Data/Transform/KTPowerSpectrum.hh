@@ -34,6 +34,11 @@ namespace Katydid
             KTPowerSpectrum(const KTPowerSpectrum& orig);
             virtual ~KTPowerSpectrum();
 
+            /// Returns a spectrum from the pool if one of the same size is available; otherwise a new spectrum is created.  The contents are undefined.
+            static KTPowerSpectrum* Acquire(size_t nBins, double rangeMin=0., double rangeMax=1.);
+            /// Returns the spectrum to the pool, or deletes it if the pool is full
+            static void Release(KTPowerSpectrum* ps);
+
             unsigned GetNFrequencyBins() const;
             double GetFrequencyBinWidth() const;
 
@@ -19,7 +19,7 @@ namespace Katydid
     {
         while (! fSpectra.empty())
         {
-            delete fSpectra.back();
+            KTPowerSpectrum::Release(fSpectra.back());
             fSpectra.pop_back();
         }
     }
@@ -43,7 +43,7 @@ namespace Katydid
         // if num < oldSize
         for (unsigned iComponent = num; iComponent < oldSize; ++iComponent)
         {
-            delete fSpectra[iComponent];
+            KTPowerSpectrum::Release(fSpectra[iComponent]);
         }
         fSpectra.resize(num);
         // if num > oldSize
@@ -102,7 +102,7 @@ namespace Katydid
     inline void KTPowerSpectrumDataCore::SetSpectrum(KTPowerSpectrum* spectrum, unsigned component)
     {
         if (component >= fSpectra.size()) SetNComponents(component+1);
-        else delete fSpectra[component];
+        else KTPowerSpectrum::Release(fSpectra[component]);
         fSpectra[component] = spectrum;
         return;
     }
@@ -0,0 +1,251 @@
+/*
+ * KTSpectrogram.cc
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ */
+
+#include "KTSpectrogram.hh"
+
+#include "KTLogger.hh"
+
+#ifdef ROOT_FOUND
+#include "TH2.h"
+#endif
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace Katydid
+{
+    KTLOGGER(datalog, "KTSpectrogram");
+
+    // Rows start on cache-line boundaries
+    static const size_t sRowAlignment = 64; // bytes
+    static const unsigned sRowAlignmentElements = sRowAlignment / sizeof(double);
+
+    KTSpectrogram::KTSpectrogram() :
+            KTFrequencyDomainArray(),
+            fData(NULL),
+            fNTimeBins(0),
+            fNFreqBins(0),
+            fRowStride(0),
+            fTimeAxis(0., 1., new KTNBinsInArray< 1, FixedSize >(0)),
+            fFrequencyAxis(0., 1., new KTNBinsInArray< 1, FixedSize >(0)),
+            fMode(KTPowerSpectrum::kPower),
+            fOrdinateLabel("Power (W)")
+    {
+        fTimeAxis.SetAxisLabel("Time (s)");
+        fFrequencyAxis.SetAxisLabel("Frequency (Hz)");
+    }
+
+    KTSpectrogram::KTSpectrogram(unsigned nTimeBins, double timeMin, double timeMax, unsigned nFreqBins, double freqMin, double freqMax) :
+            KTFrequencyDomainArray(),
+            fData(NULL),
+            fNTimeBins(0),
+            fNFreqBins(0),
+            fRowStride(0),
+            fTimeAxis(timeMin, timeMax, new KTNBinsInArray< 1, FixedSize >(nTimeBins)),
+            fFrequencyAxis(freqMin, freqMax, new KTNBinsInArray< 1, FixedSize >(nFreqBins)),
+            fMode(KTPowerSpectrum::kPower),
+            fOrdinateLabel("Power (W)")
+    {
+        fTimeAxis.SetAxisLabel("Time (s)");
+        fFrequencyAxis.SetAxisLabel("Frequency (Hz)");
+        Allocate(nTimeBins, nFreqBins);
+    }
+
+    KTSpectrogram::KTSpectrogram(const KTMultiPS& spectra) :
+            KTSpectrogram()
+    {
+        const KTPowerSpectrum* firstPS = NULL;
+        for (KTMultiPS::const_iterator psIt = spectra.begin(); psIt != spectra.end() && firstPS == NULL; ++psIt)
+        {
+            firstPS = *psIt;
+        }
+        if (firstPS == NULL)
+        {
+            KTWARN(datalog, "No power spectra were present; the spectrogram will be empty");
+            return;
+        }
+
+        fTimeAxis.SetRange(spectra.GetRangeMin(), spectra.GetRangeMax());
+        fFrequencyAxis.SetRange(firstPS->GetRangeMin(), firstPS->GetRangeMax());
+        Resize(spectra.size(), firstPS->size());
+        OverrideMode(firstPS->GetMode());
+
+        for (unsigned iTime = 0; iTime < fNTimeBins; ++iTime)
+        {
+            if (spectra(iTime) == NULL || ! SetRow(iTime, *spectra(iTime)))
+            {
+                FillRow(iTime, 0.);
+            }
+        }
+    }
+
+    KTSpectrogram::KTSpectrogram(const KTSpectrogram& orig) :
+            KTFrequencyDomainArray(),
+            fData(NULL),
+            fNTimeBins(0),
+            fNFreqBins(0),
+            fRowStride(0),
+            fTimeAxis(orig.fTimeAxis),
+            fFrequencyAxis(orig.fFrequencyAxis),
+            fMode(orig.fMode),
+            fOrdinateLabel(orig.fOrdinateLabel)
+    {
+        Allocate(orig.fNTimeBins, orig.fNFreqBins);
+        if (fData != NULL) memcpy(fData, orig.fData, (size_t)fNTimeBins * fRowStride * sizeof(double));
+    }
+
+    KTSpectrogram::~KTSpectrogram()
+    {
+        Free();
+    }
+
+    KTSpectrogram& KTSpectrogram::operator=(const KTSpectrogram& rhs)
+    {
+        if (&rhs == this) return *this;
+        Resize(rhs.fNTimeBins, rhs.fNFreqBins);
+        fTimeAxis.SetRange(rhs.fTimeAxis.GetRangeMin(), rhs.fTimeAxis.GetRangeMax());
+        fFrequencyAxis.SetRange(rhs.fFrequencyAxis.GetRangeMin(), rhs.fFrequencyAxis.GetRangeMax());
+        fTimeAxis.SetAxisLabel(rhs.fTimeAxis.GetAxisLabel());
+        fFrequencyAxis.SetAxisLabel(rhs.fFrequencyAxis.GetAxisLabel());
+        fMode = rhs.fMode;
+        fOrdinateLabel = rhs.fOrdinateLabel;
+        if (fData != NULL) memcpy(fData, rhs.fData, (size_t)fNTimeBins * fRowStride * sizeof(double));
+        return *this;
+    }
+
+    KTSpectrogram& KTSpectrogram::operator=(double value)
+    {
+        for (unsigned iTime = 0; iTime < fNTimeBins; ++iTime)
+        {
+            FillRow(iTime, value);
+        }
+        return *this;
+    }
+
+    void KTSpectrogram::Resize(unsigned nTimeBins, unsigned nFreqBins)
+    {
+        if (nTimeBins != fNTimeBins)
+        {
+            fTimeAxis.SetNBinsFunc(new KTNBinsInArray< 1, FixedSize >(nTimeBins));
+            fTimeAxis.SetRange(fTimeAxis.GetRangeMin(), fTimeAxis.GetRangeMax());
+        }
+        if (nFreqBins != fNFreqBins)
+        {
+            fFrequencyAxis.SetNBinsFunc(new KTNBinsInArray< 1, FixedSize >(nFreqBins));
+            fFrequencyAxis.SetRange(fFrequencyAxis.GetRangeMin(), fFrequencyAxis.GetRangeMax());
+        }
+        if (nTimeBins == fNTimeBins && nFreqBins == fNFreqBins) return;
+        Free();
+        Allocate(nTimeBins, nFreqBins);
+        return;
+    }
+
+    void KTSpectrogram::OverrideMode(KTPowerSpectrum::Mode mode)
+    {
+        fMode = mode;
+        fOrdinateLabel = mode == KTPowerSpectrum::kPSD ? "Power Spectral Density (W/Hz)" : "Power (W)";
+        return;
+    }
+
+    bool KTSpectrogram::SetRow(unsigned iTime, const KTPowerSpectrum& spectrum)
+    {
+        if (spectrum.size() != fNFreqBins)
+        {
+            KTERROR(datalog, "Spectrum size (" << spectrum.size() << ") does not match the number of frequency bins in the spectrogram (" << fNFreqBins << ")");
+            return false;
+        }
+        memcpy(GetRowData(iTime), spectrum.GetData(), fNFreqBins * sizeof(double));
+        return true;
+    }
+
+    void KTSpectrogram::FillRow(unsigned iTime, double value)
+    {
+        double* row = GetRowData(iTime);
+        for (unsigned iFreq = 0; iFreq < fNFreqBins; ++iFreq)
+        {
+            row[iFreq] = value;
+        }
+        return;
+    }
+
+    KTPowerSpectrum* KTSpectrogram::CreatePowerSpectrum(unsigned iTime) const
+    {
+        KTPowerSpectrum* newPS = KTPowerSpectrum::Acquire(fNFreqBins, fFrequencyAxis.GetRangeMin(), fFrequencyAxis.GetRangeMax());
+        memcpy(newPS->GetData(), GetRowData(iTime), fNFreqBins * sizeof(double));
+        newPS->OverrideMode(fMode);
+        newPS->SetDataLabel(fOrdinateLabel);
+        return newPS;
+    }
+
+    void KTSpectrogram::ShiftRows(unsigned firstRow)
+    {
+        if (firstRow == 0) return;
+        if (firstRow > fNTimeBins) firstRow = fNTimeBins;
+
+        unsigned nKept = fNTimeBins - firstRow;
+        if (nKept != 0) memmove(fData, GetRowData(firstRow), (size_t)nKept * fRowStride * sizeof(double));
+        memset(GetRowData(nKept), 0, (size_t)firstRow * fRowStride * sizeof(double));
+
+        double shift = firstRow * fTimeAxis.GetBinWidth();
+        fTimeAxis.SetRange(fTimeAxis.GetRangeMin() + shift, fTimeAxis.GetRangeMax() + shift);
+        return;
+    }
+
+    void KTSpectrogram::Allocate(unsigned nTimeBins, unsigned nFreqBins)
+    {
+        fNTimeBins = nTimeBins;
+        fNFreqBins = nFreqBins;
+        fRowStride = ((nFreqBins + sRowAlignmentElements - 1) / sRowAlignmentElements) * sRowAlignmentElements;
+
+        size_t nBytes = (size_t)fNTimeBins * fRowStride * sizeof(double);
+        if (nBytes == 0)
+        {
+            fData = NULL;
+            return;
+        }
+        void* newData = NULL;
+        if (posix_memalign(&newData, sRowAlignment, nBytes) != 0)
+        {
+            KTERROR(datalog, "Unable to allocate " << nBytes << " bytes for a spectrogram");
+            throw std::bad_alloc();
+        }
+        fData = static_cast< double* >(newData);
+        return;
+    }
+
+    void KTSpectrogram::Free()
+    {
+        free(fData);
+        fData = NULL;
+        return;
+    }
+
+#ifdef ROOT_FOUND
+    TH2D* KTSpectrogram::CreatePowerHistogram(const std::string& name) const
+    {
+        TH2D* hist = new TH2D(name.c_str(), "Spectrogram",
+                fNTimeBins, fTimeAxis.GetRangeMin(), fTimeAxis.GetRangeMax(),
+                fNFreqBins, fFrequencyAxis.GetRangeMin(), fFrequencyAxis.GetRangeMax());
+
+        for (unsigned iTime = 0; iTime < fNTimeBins; ++iTime)
+        {
+            const double* row = GetRowData(iTime);
+            for (unsigned iFreq = 0; iFreq < fNFreqBins; ++iFreq)
+            {
+                hist->SetBinContent(iTime + 1, iFreq + 1, row[iFreq]);
+            }
+        }
+
+        hist->SetXTitle(fTimeAxis.GetAxisLabel().c_str());
+        hist->SetYTitle(fFrequencyAxis.GetAxisLabel().c_str());
+        hist->SetZTitle(fOrdinateLabel.c_str());
+        return hist;
+    }
+#endif
+
+} /* namespace Katydid */
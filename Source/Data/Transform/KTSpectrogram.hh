@@ -0,0 +1,278 @@
+/*
+ * KTSpectrogram.hh
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ */
+
+#ifndef KTSPECTROGRAM_HH_
+#define KTSPECTROGRAM_HH_
+
+#include "KTFrequencyDomainArray.hh"
+#include "KTAxisProperties.hh"
+#include "KTPowerSpectrum.hh"
+
+#ifdef ROOT_FOUND
+class TH2D;
+#endif
+
+#include <string>
+
+namespace Katydid
+{
+    typedef KTPhysicalArray< 1, KTPowerSpectrum* > KTMultiPS;
+
+    /*!
+     @class KTSpectrogramRowView
+     @author N. S. Oblath
+
+     @brief Zero-copy view of one time bin (row) of a KTSpectrogram
+
+     @details
+     The view has the read interface of KTPowerSpectrum (size, bin access, and frequency-axis information),
+     but the values stay in the spectrogram's storage.  It's only valid as long as the spectrogram isn't resized or destroyed.
+
+     Use KTSpectrogramRow to modify the row, and KTConstSpectrogramRow to read it.
+    */
+    template< typename XValueType >
+    class KTSpectrogramRowView
+    {
+        public:
+            typedef XValueType value_type;
+            typedef XValueType* iterator;
+            typedef XValueType* const_iterator;
+
+        public:
+            KTSpectrogramRowView(XValueType* data, const KTAxisProperties< 1 >& axis) :
+                    fData(data),
+                    fAxis(&axis)
+            {}
+
+            size_t size() const                 { return fAxis->size(); }
+            bool empty() const                  { return fAxis->empty(); }
+
+            unsigned GetNFrequencyBins() const  { return fAxis->size(); }
+            double GetFrequencyBinWidth() const { return fAxis->GetBinWidth(); }
+
+            double GetBinWidth() const          { return fAxis->GetBinWidth(); }
+            double GetRangeMin() const          { return fAxis->GetRangeMin(); }
+            double GetRangeMax() const          { return fAxis->GetRangeMax(); }
+            double GetBinLowEdge(size_t bin) const { return fAxis->GetBinLowEdge(bin); }
+            double GetBinCenter(size_t bin) const  { return fAxis->GetBinCenter(bin); }
+            ssize_t FindBin(double pos) const   { return fAxis->FindBin(pos); }
+
+            const KTAxisProperties< 1 >& GetAxis() const { return *fAxis; }
+
+            XValueType* GetData() const         { return fData; }
+
+            XValueType& operator()(unsigned i) const { return fData[i]; }
+
+            iterator begin() const              { return fData; }
+            iterator end() const                { return fData + fAxis->size(); }
+
+        private:
+            XValueType* fData;
+            const KTAxisProperties< 1 >* fAxis;
+    };
+
+    typedef KTSpectrogramRowView< double > KTSpectrogramRow;
+    typedef KTSpectrogramRowView< const double > KTConstSpectrogramRow;
+
+
+    /*!
+     @class KTSpectrogram
+     @author N. S. Oblath
+
+     @brief Dense power spectrogram: time bins x frequency bins in one contiguous, aligned block
+
+     @details
+     The values are stored row-major: each time bin is a row of frequency bins.
+     Every row starts on an aligned boundary, so the distance between rows (the row stride) can be larger than the number of frequency bins.
+     The padding at the end of each row is not part of the spectrogram, and its contents are undefined.
+
+     The time and frequency axes are described with KTAxisProperties< 1 >; as a KTFrequencyDomainArray, the spectrogram's axis is the frequency axis.
+
+     Rows can be accessed without copying through KTSpectrogramRow and KTConstSpectrogramRow, which look like KTPowerSpectrum.
+     A spectrogram can also be made from a set of power spectra (e.g. from KTMultiPSData or KTPSCollectionData); null spectra give rows of zeros.
+    */
+    class KTSpectrogram : public KTFrequencyDomainArray
+    {
+        public:
+            KTSpectrogram();
+            KTSpectrogram(unsigned nTimeBins, double timeMin, double timeMax, unsigned nFreqBins, double freqMin, double freqMax);
+            explicit KTSpectrogram(const KTMultiPS& spectra);
+            KTSpectrogram(const KTSpectrogram& orig);
+            virtual ~KTSpectrogram();
+
+            KTSpectrogram& operator=(const KTSpectrogram& rhs);
+
+            /// Sets all of the values in the spectrogram
+            KTSpectrogram& operator=(double value);
+
+            /// Changes the dimensions of the spectrogram; the axis ranges are kept, and the contents are undefined
+            void Resize(unsigned nTimeBins, unsigned nFreqBins);
+
+        public:
+            unsigned GetNTimeBins() const;
+            unsigned GetNFrequencyBins() const;
+            /// Distance, in elements, from the start of one row to the start of the next
+            unsigned GetRowStride() const;
+
+            double GetTimeBinWidth() const;
+            double GetFrequencyBinWidth() const;
+
+            const KTAxisProperties< 1 >& GetTimeAxis() const;
+            KTAxisProperties< 1 >& GetTimeAxis();
+
+            /// Access the frequency axis
+            const KTAxisProperties< 1 >& GetAxis() const;
+            KTAxisProperties< 1 >& GetAxis();
+
+            const std::string& GetOrdinateLabel() const;
+
+            KTPowerSpectrum::Mode GetMode() const;
+            /// Labels the values as power or PSD; the values themselves are not changed
+            void OverrideMode(KTPowerSpectrum::Mode mode);
+
+        public:
+            const double* GetData() const;
+            double* GetData();
+
+            const double* GetRowData(unsigned iTime) const;
+            double* GetRowData(unsigned iTime);
+
+            const double& operator()(unsigned iTime, unsigned iFreq) const;
+            double& operator()(unsigned iTime, unsigned iFreq);
+
+            KTConstSpectrogramRow GetRow(unsigned iTime) const;
+            KTSpectrogramRow GetRow(unsigned iTime);
+
+            /// Copies a spectrum into a row; returns false if the number of frequency bins doesn't match
+            bool SetRow(unsigned iTime, const KTPowerSpectrum& spectrum);
+            /// Sets all of the values in a row
+            void FillRow(unsigned iTime, double value);
+
+            /// Creates a power spectrum with a copy of a row
+            KTPowerSpectrum* CreatePowerSpectrum(unsigned iTime) const;
+
+            /// Moves rows [firstRow, nTimeBins) to the start of the spectrogram and zeroes the rest; the time axis is moved with them
+            void ShiftRows(unsigned firstRow);
+
+        private:
+            void Allocate(unsigned nTimeBins, unsigned nFreqBins);
+            void Free();
+
+            double* fData;
+            unsigned fNTimeBins;
+            unsigned fNFreqBins;
+            unsigned fRowStride;
+
+            KTAxisProperties< 1 > fTimeAxis;
+            KTAxisProperties< 1 > fFrequencyAxis;
+
+            KTPowerSpectrum::Mode fMode;
+            std::string fOrdinateLabel;
+
+#ifdef ROOT_FOUND
+        public:
+            TH2D* CreatePowerHistogram(const std::string& name = "hSpectrogram") const;
+#endif
+    };
+
+    inline unsigned KTSpectrogram::GetNTimeBins() const
+    {
+        return fNTimeBins;
+    }
+
+    inline unsigned KTSpectrogram::GetNFrequencyBins() const
+    {
+        return fNFreqBins;
+    }
+
+    inline unsigned KTSpectrogram::GetRowStride() const
+    {
+        return fRowStride;
+    }
+
+    inline double KTSpectrogram::GetTimeBinWidth() const
+    {
+        return fTimeAxis.GetBinWidth();
+    }
+
+    inline double KTSpectrogram::GetFrequencyBinWidth() const
+    {
+        return fFrequencyAxis.GetBinWidth();
+    }
+
+    inline const KTAxisProperties< 1 >& KTSpectrogram::GetTimeAxis() const
+    {
+        return fTimeAxis;
+    }
+
+    inline KTAxisProperties< 1 >& KTSpectrogram::GetTimeAxis()
+    {
+        return fTimeAxis;
+    }
+
+    inline const KTAxisProperties< 1 >& KTSpectrogram::GetAxis() const
+    {
+        return fFrequencyAxis;
+    }
+
+    inline KTAxisProperties< 1 >& KTSpectrogram::GetAxis()
+    {
+        return fFrequencyAxis;
+    }
+
+    inline const std::string& KTSpectrogram::GetOrdinateLabel() const
+    {
+        return fOrdinateLabel;
+    }
+
+    inline KTPowerSpectrum::Mode KTSpectrogram::GetMode() const
+    {
+        return fMode;
+    }
+
+    inline const double* KTSpectrogram::GetData() const
+    {
+        return fData;
+    }
+
+    inline double* KTSpectrogram::GetData()
+    {
+        return fData;
+    }
+
+    inline const double* KTSpectrogram::GetRowData(unsigned iTime) const
+    {
+        return fData + (size_t)iTime * fRowStride;
+    }
+
+    inline double* KTSpectrogram::GetRowData(unsigned iTime)
+    {
+        return fData + (size_t)iTime * fRowStride;
+    }
+
+    inline const double& KTSpectrogram::operator()(unsigned iTime, unsigned iFreq) const
+    {
+        return fData[(size_t)iTime * fRowStride + iFreq];
+    }
+
+    inline double& KTSpectrogram::operator()(unsigned iTime, unsigned iFreq)
+    {
+        return fData[(size_t)iTime * fRowStride + iFreq];
+    }
+
+    inline KTConstSpectrogramRow KTSpectrogram::GetRow(unsigned iTime) const
+    {
+        return KTConstSpectrogramRow(GetRowData(iTime), fFrequencyAxis);
+    }
+
+    inline KTSpectrogramRow KTSpectrogram::GetRow(unsigned iTime)
+    {
+        return KTSpectrogramRow(GetRowData(iTime), fFrequencyAxis);
+    }
+
+} /* namespace Katydid */
+#endif /* KTSPECTROGRAM_HH_ */
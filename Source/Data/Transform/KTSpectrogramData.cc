@@ -0,0 +1,57 @@
+/*
+ * KTSpectrogramData.cc
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ */
+
+#include "KTSpectrogramData.hh"
+
+namespace Katydid
+{
+    KTSpectrogramDataCore::KTSpectrogramDataCore() :
+            KTFrequencyDomainArrayData(),
+            fSpectrograms()
+    {
+    }
+
+    KTSpectrogramDataCore::~KTSpectrogramDataCore()
+    {
+        while (! fSpectrograms.empty())
+        {
+            delete fSpectrograms.back();
+            fSpectrograms.pop_back();
+        }
+    }
+
+
+    const std::string KTSpectrogramData::sName("spectrogram");
+
+    KTSpectrogramData::KTSpectrogramData() :
+            KTSpectrogramDataCore(),
+            KTExtensibleData()
+    {
+    }
+
+    KTSpectrogramData::~KTSpectrogramData()
+    {
+    }
+
+    KTSpectrogramData& KTSpectrogramData::SetNComponents(unsigned components)
+    {
+        unsigned oldSize = fSpectrograms.size();
+        // if components < oldSize
+        for (unsigned iComponent = components; iComponent < oldSize; ++iComponent)
+        {
+            delete fSpectrograms[iComponent];
+        }
+        fSpectrograms.resize(components);
+        // if components > oldSize
+        for (unsigned iComponent = oldSize; iComponent < components; ++iComponent)
+        {
+            fSpectrograms[iComponent] = NULL;
+        }
+        return *this;
+    }
+
+} /* namespace Katydid */
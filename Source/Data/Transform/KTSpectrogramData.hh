@@ -0,0 +1,93 @@
+/*
+ * KTSpectrogramData.hh
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ */
+
+#ifndef KTSPECTROGRAMDATA_HH_
+#define KTSPECTROGRAMDATA_HH_
+
+#include "KTData.hh"
+
+#include "KTSpectrogram.hh"
+
+#include <vector>
+
+namespace Katydid
+{
+
+    class KTSpectrogramDataCore : public KTFrequencyDomainArrayData
+    {
+        public:
+            KTSpectrogramDataCore();
+            virtual ~KTSpectrogramDataCore();
+
+            unsigned GetNComponents() const;
+
+            const KTSpectrogram* GetSpectrogram(unsigned component = 0) const;
+            KTSpectrogram* GetSpectrogram(unsigned component = 0);
+
+            const KTFrequencyDomainArray* GetArray(unsigned component = 0) const;
+            KTFrequencyDomainArray* GetArray(unsigned component = 0);
+
+            /// Takes ownership of the spectrogram
+            void SetSpectrogram(KTSpectrogram* spectrogram, unsigned component = 0);
+
+            virtual KTSpectrogramDataCore& SetNComponents(unsigned components) = 0;
+
+        protected:
+            std::vector< KTSpectrogram* > fSpectrograms;
+    };
+
+
+    class KTSpectrogramData : public KTSpectrogramDataCore, public Nymph::KTExtensibleData< KTSpectrogramData >
+    {
+        public:
+            KTSpectrogramData();
+            virtual ~KTSpectrogramData();
+
+            KTSpectrogramData& SetNComponents(unsigned components);
+
+        public:
+            static const std::string sName;
+
+    };
+
+
+    inline unsigned KTSpectrogramDataCore::GetNComponents() const
+    {
+        return unsigned(fSpectrograms.size());
+    }
+
+    inline const KTSpectrogram* KTSpectrogramDataCore::GetSpectrogram(unsigned component) const
+    {
+        return fSpectrograms[component];
+    }
+
+    inline KTSpectrogram* KTSpectrogramDataCore::GetSpectrogram(unsigned component)
+    {
+        return fSpectrograms[component];
+    }
+
+    inline const KTFrequencyDomainArray* KTSpectrogramDataCore::GetArray(unsigned component) const
+    {
+        return fSpectrograms[component];
+    }
+
+    inline KTFrequencyDomainArray* KTSpectrogramDataCore::GetArray(unsigned component)
+    {
+        return fSpectrograms[component];
+    }
+
+    inline void KTSpectrogramDataCore::SetSpectrogram(KTSpectrogram* spectrogram, unsigned component)
+    {
+        if (component >= fSpectrograms.size()) SetNComponents(component+1);
+        else delete fSpectrograms[component];
+        fSpectrograms[component] = spectrogram;
+        return;
+    }
+
+} /* namespace Katydid */
+
+#endif /* KTSPECTROGRAMDATA_HH_ */
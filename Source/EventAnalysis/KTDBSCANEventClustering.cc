@@ -129,7 +129,7 @@ namespace Katydid
     {
         KTPROG(tclog, "Starting DBSCAN event clustering");
 
-        KTDBSCAN< DistanceMatrix > dbScan;
+        KTDBSCAN< TrackIndex > dbScan;
 
         dbScan.SetRadius(1.);
         dbScan.SetMinPoints(fMinPoints);
@@ -175,13 +175,13 @@ namespace Katydid
                 normPoints[iPoint++] = newPoint;
             }
 
-            DistanceMatrix distMat;
-            distMat.ComputeDistances< TrackDistance< Point > >(normPoints);
+            TrackIndex trackIndex;
+            trackIndex.BuildIndex(normPoints);
 
             // do the clustering!
             KTINFO(tclog, "Starting DBSCAN");
-            KTDBSCAN< DistanceMatrix >::DBSResults results;
-            if (! dbScan.DoClustering(distMat, results))
+            KTDBSCAN< TrackIndex >::DBSResults results;
+            if (! dbScan.DoClustering(trackIndex, results))
             {
                 KTERROR(tclog, "An error occurred while clustering");
                 return false;
@@ -190,7 +190,7 @@ namespace Katydid
 
             // loop over the clusters found, and create data objects for them
             KTDEBUG(tclog, "Found " << results.fClusters.size() << " clusters; creating candidate events");
-            for (vector< KTDBSCAN< DistanceMatrix >::Cluster >::const_iterator clustIt = results.fClusters.begin(); clustIt != results.fClusters.end(); ++clustIt)
+            for (vector< KTDBSCAN< TrackIndex >::Cluster >::const_iterator clustIt = results.fClusters.begin(); clustIt != results.fClusters.end(); ++clustIt)
             {
                 if (clustIt->empty())
                 {
@@ -209,7 +209,7 @@ namespace Katydid
                 eventData.SetAcquisitionID(fCompTracks[0][0].GetAcquisitionID());
                 eventData.SetEventID(fDataCount);
 
-                for (KTDBSCAN< DistanceMatrix >::Cluster::const_iterator pointIdIt = clustIt->begin(); pointIdIt != clustIt->end(); ++pointIdIt)
+                for (KTDBSCAN< TrackIndex >::Cluster::const_iterator pointIdIt = clustIt->begin(); pointIdIt != clustIt->end(); ++pointIdIt)
                 {
                     eventData.AddTrack(fCompTracks[iComponent][*pointIdIt]);
                 }
@@ -27,36 +27,6 @@ namespace Katydid
     
     class KTProcessedTrackData;
 
-    // Track distance
-    // Vector format for representing tracks: (tstart, fstart, tend, fend)
-    // Dimension t: for tstart_1 < tstart_2, Dt = max(0, tstart_2 - tend_1)
-    // Dimension f: Df = fstart_2 - fend_1
-    // Dist = sqrt(Dt^2 + Df^2)
-    template < typename VEC_T >
-    class TrackDistance
-    {
-        protected:
-            typedef VEC_T vector_type;
-
-            double GetDistance(const VEC_T v1, const VEC_T v2)
-            {
-                double deltaT, deltaF;
-                if (v1(0) < v2(0))
-                {
-                    deltaT = std::max(0., v2(0) - v1(2));
-                    deltaF = v2(1) - v1(3);
-                }
-                else
-                {
-                    deltaT = std::max(0., v1(0) - v2(2));
-                    deltaF = v1(1) - v2(3);
-                }
-                return sqrt(deltaT * deltaT + deltaF * deltaF);
-            };
-
-    };
-
-
     /*!
      @class KTDBSCANEventClustering
      @author N.S. Oblath
@@ -72,6 +42,11 @@ namespace Katydid
      scaled to a unit circle.  Those scaling factors are applied to every point before the data is passed to the
      DBSCAN algorithm.
 
+     Neighbor searches:
+     Tracks are compared with TrackDistance (see KTDistanceMatrix.hh): the gap between the end of the earlier track and the start of
+     the later one.  Rather than filling an NxN distance matrix, the tracks are stored in a KTTrackDistanceIndex, which only
+     calculates the distances to tracks that can be within the radius.  The clusters are the same as with the distance matrix.
+
      Configuration name: "dbscan-event-clustering"
 
      Available configuration values:
@@ -90,9 +65,9 @@ namespace Katydid
     class KTDBSCANEventClustering : public Nymph::KTPrimaryProcessor
     {
         public:
-            typedef KTSymmetricDistanceMatrix< double > DistanceMatrix;
-            typedef DistanceMatrix::Point Point;
-            typedef DistanceMatrix::Points Points;
+            typedef KTTrackDistanceIndex< double > TrackIndex;
+            typedef TrackIndex::Point Point;
+            typedef TrackIndex::Points Points;
 
             const static unsigned fNDimensions;
             const static unsigned fNPointsPerTrack;
@@ -17,10 +17,12 @@
 #include <boost/numeric/ublas/matrix_proxy.hpp>
 #include <boost/numeric/ublas/vector.hpp>
 
+#include <algorithm>
 #include <cfloat>
 #include <cmath>
 #include <vector>
 
+#include "KTKDTree.hh"
 #include "KTLogger.hh"
 
 namespace Katydid
@@ -56,6 +58,41 @@ namespace Katydid
 
     };
 
+    // Track distance
+    // Vector format for representing tracks: (tstart, fstart, tend, fend)
+    // Dimension t: for tstart_1 < tstart_2, Dt = max(0, tstart_2 - tend_1)
+    // Dimension f: Df = fstart_2 - fend_1
+    // Dist = sqrt(Dt^2 + Df^2)
+    template < typename VEC_T >
+    class TrackDistance
+    {
+        public:
+            static double Calculate(const VEC_T& v1, const VEC_T& v2)
+            {
+                double deltaT, deltaF;
+                if (v1(0) < v2(0))
+                {
+                    deltaT = std::max(0., v2(0) - v1(2));
+                    deltaF = v2(1) - v1(3);
+                }
+                else
+                {
+                    deltaT = std::max(0., v1(0) - v2(2));
+                    deltaF = v1(1) - v2(3);
+                }
+                return sqrt(deltaT * deltaT + deltaF * deltaF);
+            };
+
+        protected:
+            typedef VEC_T vector_type;
+
+            double GetDistance(const VEC_T v1, const VEC_T v2)
+            {
+                return Calculate(v1, v2);
+            };
+
+    };
+
     template <typename Distance_Policy>   // this allows to provide a static mechanism for pseudo-like
     // inheritance, which is optimal from a performance point of view.
     class Distance : Distance_Policy
@@ -201,5 +238,148 @@ namespace Katydid
         }
     };
 
+    /*!
+     @class KTTrackDistanceIndex
+     @author N.S. Oblath
+
+     @brief Region queries for tracks with the TrackDistance metric, without a distance matrix
+
+     @details
+     Tracks are 4-D points, (tstart, fstart, tend, fend), scaled so that the clustering radius is the same on both axes.
+     NearestNeighborsByRadius() finds the same neighbors, in the same (ascending) order, as a KTSymmetricDistanceMatrix
+     filled with TrackDistance, and returns them with the same interface as KTTreeIndex.
+
+     The earlier-starting track of a pair has to end within the radius (in both time and frequency) of the start of the later track.
+     The tracks are therefore kept sorted twice, by (start-frequency cell, start time) and by (end-frequency cell, start time).
+     A query visits the frequency cells within the radius of the track, and in each cell only the tracks that start in the
+     time window that can hold a neighbor; the exact distance is calculated for those candidates.
+     For the window in which the neighbor starts first, the longest track sets how far back in time the search goes.
+
+     Memory use is O(N).
+    */
+
+    template< typename TYPE >
+    struct KTTrackDistanceIndex
+    {
+        typedef TYPE value_type;
+
+        typedef boost::numeric::ublas::vector< TYPE > Point;
+        typedef std::vector< Point > Points;
+
+        typedef size_t PointId;
+        typedef typename KTTreeIndex< TYPE >::Neighbors Neighbors;
+
+        struct Entry
+        {
+            long fCell;
+            TYPE fStartTime;
+            PointId fPointId;
+
+            bool operator<(const Entry& rhs) const
+            {
+                return fCell < rhs.fCell || (fCell == rhs.fCell && fStartTime < rhs.fStartTime);
+            }
+        };
+        typedef std::vector< Entry > Entries;
+
+        Points fPoints;
+        Entries fByStartFrequency;
+        Entries fByEndFrequency;
+        TYPE fCellWidth;
+        TYPE fMaxTrackLength;
+
+        KTTrackDistanceIndex(TYPE cellWidth = 1.) :
+                fPoints(),
+                fByStartFrequency(),
+                fByEndFrequency(),
+                fCellWidth(cellWidth),
+                fMaxTrackLength(0.)
+        {}
+
+        inline size_t size() const {return fPoints.size();}
+
+        void BuildIndex(const Points& points)
+        {
+            fPoints = points;
+            fMaxTrackLength = 0.;
+
+            size_t nPoints = fPoints.size();
+            fByStartFrequency.resize(nPoints);
+            fByEndFrequency.resize(nPoints);
+            for (PointId pid = 0; pid < nPoints; ++pid)
+            {
+                const Point& track = fPoints[pid];
+                fByStartFrequency[pid].fCell = Cell(track(1));
+                fByStartFrequency[pid].fStartTime = track(0);
+                fByStartFrequency[pid].fPointId = pid;
+                fByEndFrequency[pid].fCell = Cell(track(3));
+                fByEndFrequency[pid].fStartTime = track(0);
+                fByEndFrequency[pid].fPointId = pid;
+                fMaxTrackLength = std::max(fMaxTrackLength, track(2) - track(0));
+            }
+            std::sort(fByStartFrequency.begin(), fByStartFrequency.end());
+            std::sort(fByEndFrequency.begin(), fByEndFrequency.end());
+
+            KTDEBUG(dmlog, "Indexed " << nPoints << " tracks; longest track: " << fMaxTrackLength);
+            return;
+        }
+
+        /// Distance between two tracks, as it would be stored in a KTSymmetricDistanceMatrix
+        inline TYPE GetDistance(PointId pid1, PointId pid2) const
+        {
+            if (pid1 < pid2) return TrackDistance< Point >::Calculate(fPoints[pid1], fPoints[pid2]);
+            return TrackDistance< Point >::Calculate(fPoints[pid2], fPoints[pid1]);
+        }
+
+        Neighbors NearestNeighborsByRadius(PointId pid, TYPE threshold) const
+        {
+            Neighbors neighbors;
+
+            const Point& track = fPoints[pid];
+            // neighbors that start after this track: they start close to where this track ends
+            AddNeighbors(fByStartFrequency, pid, threshold, track(3), track(0), track(2) + threshold, neighbors);
+            // neighbors that start before this track: they end close to where this track starts
+            AddNeighbors(fByEndFrequency, pid, threshold, track(1), track(0) - threshold - fMaxTrackLength, track(0), neighbors);
+
+            // tracks that start at the same time as this one are found by both searches
+            typename Neighbors::IndicesAndDists& indDists = neighbors.GetIndicesAndDists();
+            std::sort(indDists.begin(), indDists.end());
+            indDists.erase(std::unique(indDists.begin(), indDists.end()), indDists.end());
+
+            return neighbors;
+        }
+
+        inline long Cell(TYPE frequency) const
+        {
+            return long(std::floor(frequency / fCellWidth));
+        }
+
+        void AddNeighbors(const Entries& entries, PointId pid, TYPE threshold, TYPE frequency, TYPE minStartTime, TYPE maxStartTime, Neighbors& neighbors) const
+        {
+            // the search windows are widened slightly so that rounding can't exclude a track that passes the exact distance check
+            TYPE freqMargin = threshold + 1.e-9 * (std::fabs(frequency) + threshold);
+            TYPE timeMargin = 1.e-9 * (std::fabs(minStartTime) + std::fabs(maxStartTime) + threshold);
+
+            Entry bound;
+            bound.fStartTime = minStartTime - timeMargin;
+            bound.fPointId = 0;
+            long lastCell = Cell(frequency + freqMargin);
+            for (bound.fCell = Cell(frequency - freqMargin); bound.fCell <= lastCell; ++bound.fCell)
+            {
+                for (typename Entries::const_iterator eIt = std::lower_bound(entries.begin(), entries.end(), bound);
+                        eIt != entries.end() && eIt->fCell == bound.fCell && eIt->fStartTime <= maxStartTime + timeMargin; ++eIt)
+                {
+                    if (eIt->fPointId == pid) continue;
+                    TYPE dist = GetDistance(pid, eIt->fPointId);
+                    if (dist < threshold)
+                    {
+                        neighbors.push_back(eIt->fPointId, dist);
+                    }
+                }
+            }
+            return;
+        }
+    };
+
 } /* namespace Katydid */
 #endif /* KTDISTANCEMATRIX_HH_ */
@@ -12,6 +12,7 @@
 #include "KTLinearFitResult.hh"
 #include "KTPowerFitData.hh"
 #include "KTSpectrumCollectionData.hh"
+#include "KTSpectrogramData.hh"
 #include "KTLogger.hh"
 #include "KTTimeSeries.hh"
 #include "KTTimeSeriesReal.hh"
@@ -88,6 +89,7 @@ namespace Katydid
                     fPreCalcSlot("gv", this, &KTLinearDensityProbeFit::SetPreCalcGainVar)
     {
         RegisterSlot( "thresh-points", this, &KTLinearDensityProbeFit::SlotFunctionThreshPoints );
+        RegisterSlot( "thresh-points-spectrogram", this, &KTLinearDensityProbeFit::SlotFunctionThreshPointsSpectrogram );
     }
 
     KTLinearDensityProbeFit::~KTLinearDensityProbeFit()
@@ -115,12 +117,36 @@ namespace Katydid
 
     bool KTLinearDensityProbeFit::ChooseAlgorithm( KTProcessedTrackData& data, KTDiscriminatedPoints2DData& pts, KTPSCollectionData& fullSpectrogram )
     {
-        if (fDoDensityMaximization && ! DensityMaximization(data, pts, fullSpectrogram))
+        if (fullSpectrogram.GetSpectra() == NULL)
+        {
+            KTERROR(evlog, "The spectrum collection is empty");
+            return false;
+        }
+        // The spectra are read as the rows of a dense spectrogram
+        KTSpectrogram spectrogram( *fullSpectrogram.GetSpectra() );
+        return ChooseAlgorithm( data, pts, spectrogram, GetWindow( fullSpectrogram ) );
+    }
+
+    bool KTLinearDensityProbeFit::ChooseAlgorithm( KTProcessedTrackData& data, KTDiscriminatedPoints2DData& pts, KTSpectrogramData& fullSpectrogram )
+    {
+        unsigned component = data.GetComponent();
+        if (component >= fullSpectrogram.GetNComponents() || fullSpectrogram.GetSpectrogram(component) == NULL)
+        {
+            KTERROR(evlog, "No spectrogram is present for component " << component);
+            return false;
+        }
+        const KTSpectrogram& spectrogram = *fullSpectrogram.GetSpectrogram(component);
+        return ChooseAlgorithm( data, pts, spectrogram, GetWindow( spectrogram ) );
+    }
+
+    bool KTLinearDensityProbeFit::ChooseAlgorithm( KTProcessedTrackData& data, KTDiscriminatedPoints2DData& pts, const KTSpectrogram& spectrogram, const SpectrogramWindow& window )
+    {
+        if (fDoDensityMaximization && ! DensityMaximization(data, pts, spectrogram, window))
         {
             KTERROR(evlog, "Something went wrong performing the density maximization algorithm!");
             return false;
         }
-        if (fDoProjectionAnalysis && ! ProjectionAnalysis(data, pts, fullSpectrogram))
+        if (fDoProjectionAnalysis && ! ProjectionAnalysis(data, pts, window))
         {
             KTERROR(evlog, "Something went wrong performing the projection analysis algorithm!");
             return false;
@@ -129,6 +155,28 @@ namespace Katydid
         return true;
     }
 
+    KTLinearDensityProbeFit::SpectrogramWindow KTLinearDensityProbeFit::GetWindow( const KTPSCollectionData& fullSpectrogram )
+    {
+        SpectrogramWindow window;
+        window.fStartTime = fullSpectrogram.GetStartTime();
+        window.fEndTime = fullSpectrogram.GetEndTime();
+        window.fDeltaT = fullSpectrogram.GetDeltaT();
+        window.fMinFreq = fullSpectrogram.GetMinFreq();
+        window.fMaxFreq = fullSpectrogram.GetMaxFreq();
+        return window;
+    }
+
+    KTLinearDensityProbeFit::SpectrogramWindow KTLinearDensityProbeFit::GetWindow( const KTSpectrogram& spectrogram )
+    {
+        SpectrogramWindow window;
+        window.fStartTime = spectrogram.GetTimeAxis().GetRangeMin();
+        window.fEndTime = spectrogram.GetTimeAxis().GetRangeMax();
+        window.fDeltaT = spectrogram.GetTimeBinWidth();
+        window.fMinFreq = spectrogram.GetAxis().GetRangeMin();
+        window.fMaxFreq = spectrogram.GetAxis().GetRangeMax();
+        return window;
+    }
+
     // Determines the significance of a 1D peak in Sigma or SNR
     // x is a vector of 1D data
     // omit contains the indices of points to omit from noise calculation
@@ -202,6 +250,23 @@ namespace Katydid
     // Main method for density maximization algorithm
     bool KTLinearDensityProbeFit::DensityMaximization(KTProcessedTrackData& data, KTDiscriminatedPoints2DData& pts, KTPSCollectionData& fullSpectrogram)
     {
+        if (fullSpectrogram.GetSpectra() == NULL)
+        {
+            KTERROR(evlog, "The spectrum collection is empty");
+            return false;
+        }
+        KTSpectrogram spectrogram( *fullSpectrogram.GetSpectra() );
+        return DensityMaximization( data, pts, spectrogram, GetWindow( fullSpectrogram ) );
+    }
+
+    bool KTLinearDensityProbeFit::DensityMaximization(KTProcessedTrackData& data, KTDiscriminatedPoints2DData& pts, const KTSpectrogram& spectrogram, const SpectrogramWindow& window)
+    {
+        if (spectrogram.GetNTimeBins() == 0)
+        {
+            KTERROR(evlog, "The spectrogram is empty");
+            return false;
+        }
+
         KTLinearFitResult& newData = data.Of< KTLinearFitResult >();
 
         unsigned trackComponent = data.GetComponent();
@@ -258,12 +323,12 @@ namespace Katydid
 
         // Window and spectrogram parameters
 
-        double ps_xmin = fullSpectrogram.GetStartTime();
-        double ps_xmax = fullSpectrogram.GetEndTime();
-        double ps_ymin = (*fullSpectrogram.GetSpectra())(0)->GetRangeMin();
+        double ps_xmin = window.fStartTime;
+        double ps_xmax = window.fEndTime;
+        double ps_ymin = spectrogram.GetAxis().GetRangeMin();
         //     ps_ymax will not be necessary
-        double ps_dx   = fullSpectrogram.GetDeltaT();
-        double ps_dy   = (*fullSpectrogram.GetSpectra())(0)->GetFrequencyBinWidth();
+        double ps_dx   = window.fDeltaT;
+        double ps_dy   = spectrogram.GetFrequencyBinWidth();
 
         // We add +1 for the underflow bin
         int xBinStart = floor( (data.GetStartTimeInAcq() - ps_xmin) / ps_dx ) + 1;
@@ -289,50 +354,52 @@ namespace Katydid
         KTSpline* spline = fGVData.GetSpline(trackComponent);
 
         // First we compute the unweighted projection
-        const KTPhysicalArray< 1, KTPowerSpectrum* > spectra = *fullSpectrogram.GetSpectra();
-        vector< double > unweighted(spectra.size());
-        for( KTPhysicalArray< 1, KTPowerSpectrum* >::const_iterator it = spectra.begin(); it != spectra.end(); ++it )
+        // Each spectrum is a row of the spectrogram
+        int nSpectra = spectrogram.GetNTimeBins();
+        int nFreqBins = spectrogram.GetNFrequencyBins();
+        vector< double > unweighted(nSpectra);
+        for( iSpectrum = 0; iSpectrum < nSpectra; ++iSpectrum )
         {
+            KTConstSpectrogramRow spectrum = spectrogram.GetRow(iSpectrum);
+
             // Set x value and starting y-bin
             xVal = ps_xmin + (iSpectrum - 1) * ps_dx;
-            yBinStart = (*it)->FindBin( alphaBoundLower + q_fit * xVal );
+            yBinStart = spectrum.FindBin( alphaBoundLower + q_fit * xVal );
 
             // Unweighted power = sum of raw power spectrum
             unweighted[iSpectrum] = 0;
-            for( int iBin = yBinStart; iBin < yBinStart + yWindow && iBin < (*it)->GetNFrequencyBins(); ++iBin )
+            for( int iBin = yBinStart; iBin < yBinStart + yWindow && iBin < nFreqBins; ++iBin )
             {
                 yVal = ps_ymin + ps_dy * (iBin - 1);
 
                 // We reevaluate the spline rather than deal with the appropriate index of power_minus_bkgd
-                unweighted[iSpectrum] += (**it)(iBin) - spline->Evaluate( yVal );
+                unweighted[iSpectrum] += spectrum(iBin) - spline->Evaluate( yVal );
             }
-            ++iSpectrum;
         }
 
         KTDEBUG(evlog, "Computing weighted projection");
 
         // Weighted projection
         double cumulative = 0.;
-        iSpectrum = 0;
-        vector< double > weighted(spectra.size());
-        for( KTPhysicalArray< 1, KTPowerSpectrum* >::const_iterator it = spectra.begin(); it != spectra.end(); ++it )
+        vector< double > weighted(nSpectra);
+        for( iSpectrum = 0; iSpectrum < nSpectra; ++iSpectrum )
         {
+            KTConstSpectrogramRow spectrum = spectrogram.GetRow(iSpectrum);
             cumulative = 0.;
 
             xVal = ps_xmin + (iSpectrum - 1) * ps_dx;
-            yBinStart = (*it)->FindBin( alphaBoundLower + q_fit * xVal );
+            yBinStart = spectrum.FindBin( alphaBoundLower + q_fit * xVal );
 
-            for( int iBin = yBinStart; iBin < yBinStart + yWindow && iBin < (*it)->GetNFrequencyBins(); ++iBin )
+            for( int iBin = yBinStart; iBin < yBinStart + yWindow && iBin < nFreqBins; ++iBin )
             {
                 yVal = ps_ymin + ps_dy * (iBin - 1);
 
                 // Calculate delta-f using the fit values
                 delta_f = yVal - (q_fit * xVal + newData.GetIntercept(0));
-                cumulative += delta_f * ((**it)(iBin) - spline->Evaluate( yVal )) / unweighted[iSpectrum];
+                cumulative += delta_f * (spectrum(iBin) - spline->Evaluate( yVal )) / unweighted[iSpectrum];
             }
 
             weighted[iSpectrum] = cumulative;
-            ++iSpectrum;
         }
 
         // Discrete Cosine Transform (real -> real) of type I
@@ -385,6 +452,11 @@ namespace Katydid
 
     // Main method for power projection algorithm
     bool KTLinearDensityProbeFit::ProjectionAnalysis(KTProcessedTrackData& data, KTDiscriminatedPoints2DData& pts, KTPSCollectionData& fullSpectrogram)
+    {
+        return ProjectionAnalysis( data, pts, GetWindow( fullSpectrogram ) );
+    }
+
+    bool KTLinearDensityProbeFit::ProjectionAnalysis(KTProcessedTrackData& data, KTDiscriminatedPoints2DData& pts, const SpectrogramWindow& window)
     {
         KTPowerFitData& newData = data.Of< KTPowerFitData >();
 
@@ -392,8 +464,8 @@ namespace Katydid
         double q = data.GetSlope();
 
         // Intercept range is determined by the spectrogram window
-        double minAlpha = fullSpectrogram.GetMinFreq() - q * fullSpectrogram.GetStartTime();
-        double maxAlpha = fullSpectrogram.GetMaxFreq() - q * fullSpectrogram.GetEndTime();
+        double minAlpha = window.fMinFreq - q * window.fStartTime;
+        double maxAlpha = window.fMaxFreq - q * window.fEndTime;
 
         // Begin brute-force sweep
         alpha = minAlpha;
@@ -700,6 +772,42 @@ namespace Katydid
             return;
         }
 
+        EmitResults( data );
+        return;
+    }
+
+    void KTLinearDensityProbeFit::SlotFunctionThreshPointsSpectrogram( Nymph::KTDataPtr data )
+    {
+        // Check to ensure that the required data types are present
+        if (! data->Has< KTProcessedTrackData >())
+        {
+            KTERROR(avlog_hh, "Data not found with type < KTProcessedTrackData >!");
+            return;
+        }
+        if (! data->Has< KTDiscriminatedPoints2DData >())
+        {
+            KTERROR(avlog_hh, "Data not found with type < KTDiscriminatedPoints2DData >!");
+            return;
+        }
+        if (! data->Has< KTSpectrogramData >())
+        {
+            KTERROR(avlog_hh, "Data not found with type < KTSpectrogramData >!");
+            return;
+        }
+
+        // Call the function
+        if( !ChooseAlgorithm( data->Of< KTProcessedTrackData >(), data->Of< KTDiscriminatedPoints2DData >(), data->Of< KTSpectrogramData >() ) )
+        {
+            KTERROR(avlog_hh, "Density probe analysis failed.");
+            return;
+        }
+
+        EmitResults( data );
+        return;
+    }
+
+    void KTLinearDensityProbeFit::EmitResults( Nymph::KTDataPtr data )
+    {
         // Emit appropriate signal
         if( fDoDensityMaximization )
         {
@@ -709,7 +817,6 @@ namespace Katydid
         {
             fPowerFitSignal( data );
         }
-
         return;
     }
 
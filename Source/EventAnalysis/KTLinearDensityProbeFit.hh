@@ -41,6 +41,8 @@ namespace Katydid
     class KTDiscriminatedPoints2DData;
     class KTLinearFitResult;
     class KTPSCollectionData;
+    class KTSpectrogram;
+    class KTSpectrogramData;
 
     /*!
      @class KTLinearDensityProbeFit
@@ -73,6 +75,10 @@ namespace Katydid
             parameters are configurable), and central moments up to the 4th (kurtosis) are calculated. The results are stored in KTPowerFitData. It is
             anticipated that these results will differ between signal and sideband peaks, in a way which is not necessarily simple.
 
+     The spectrogram can be given either as a KTPSCollectionData (e.g. from KTSpectrogramCollector) or as a dense KTSpectrogramData;
+     both algorithms read the power spectra as rows of a KTSpectrogram, so the collection is converted to that form first.
+     For KTSpectrogramData, the spectrogram of the track's component is used, and its time and frequency axes give the time and frequency windows.
+
      Available configuration values:
      - "do-density-maximization": bool -- whether or not to perform the density maximization algorithm
      - "do-projection-analysis": bool -- whether or not to perform the rotate-and-project analysis
@@ -86,6 +92,7 @@ namespace Katydid
 
      Slots:
      - "thresh-points": void (Nymph::KTDataPtr) -- Performs fit analysis on a set of 2D Points; Requires KTProcessedTrackData, KTDiscriminatedPoints2DData, and KTPSCollectionData; Adds KTLinearFitResult
+     - "thresh-points-spectrogram": void (Nymph::KTDataPtr) -- Performs fit analysis on a set of 2D Points; Requires KTProcessedTrackData, KTDiscriminatedPoints2DData, and KTSpectrogramData; Adds KTLinearFitResult
      - "gv": void (Nymph::KTDataPtr) -- Stores gain variation for later use with spectrogram; Requires KTGainVariationData
 
      Signals:
@@ -115,14 +122,31 @@ namespace Katydid
             MEMBERVARIABLE(double, Threshold);
 
         public:
+            /// Time and frequency bounds of the spectrogram that the algorithms work on
+            struct SpectrogramWindow
+            {
+                double fStartTime;
+                double fEndTime;
+                double fDeltaT;
+                double fMinFreq;
+                double fMaxFreq;
+            };
+
             bool ChooseAlgorithm(KTProcessedTrackData& data, KTDiscriminatedPoints2DData& pts, KTPSCollectionData& fullSpectrogram);
+            bool ChooseAlgorithm(KTProcessedTrackData& data, KTDiscriminatedPoints2DData& pts, KTSpectrogramData& fullSpectrogram);
             bool SetPreCalcGainVar(KTGainVariationData& gvData);
             bool DensityMaximization(KTProcessedTrackData& data, KTDiscriminatedPoints2DData& pts, KTPSCollectionData& fullSpectrogram);
+            bool DensityMaximization(KTProcessedTrackData& data, KTDiscriminatedPoints2DData& pts, const KTSpectrogram& spectrogram, const SpectrogramWindow& window);
             bool ProjectionAnalysis(KTProcessedTrackData& data, KTDiscriminatedPoints2DData& pts, KTPSCollectionData& fullSpectrogram);
+            bool ProjectionAnalysis(KTProcessedTrackData& data, KTDiscriminatedPoints2DData& pts, const SpectrogramWindow& window);
             bool PerformTest(KTDiscriminatedPoints2DData& pts, KTLinearFitResult& newData, double fProbeWidth, double fStepSize, unsigned component=0);
             double FindIntercept( KTDiscriminatedPoints2DData& pts, double dalpha, double q, double width );
 
         private:
+            bool ChooseAlgorithm(KTProcessedTrackData& data, KTDiscriminatedPoints2DData& pts, const KTSpectrogram& spectrogram, const SpectrogramWindow& window);
+            static SpectrogramWindow GetWindow(const KTPSCollectionData& fullSpectrogram);
+            static SpectrogramWindow GetWindow(const KTSpectrogram& spectrogram);
+
             KTGainVariationData fGVData;
 
             int fNPeaks;
@@ -141,6 +165,8 @@ namespace Katydid
 
         private:
             void SlotFunctionThreshPoints( Nymph::KTDataPtr data );
+            void SlotFunctionThreshPointsSpectrogram( Nymph::KTDataPtr data );
+            void EmitResults( Nymph::KTDataPtr data );
             Nymph::KTSlotDataOneType< KTGainVariationData > fPreCalcSlot;
     };
 
@@ -0,0 +1,379 @@
+/*
+ * KTPowerSpectrumCache.cc
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ */
+
+#include "KTPowerSpectrumCache.hh"
+
+#include "KTLogger.hh"
+#include "KTPowerSpectrum.hh"
+#include "KTSliceHeader.hh"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace Katydid
+{
+    KTLOGGER(cachelog, "KTPowerSpectrumCache");
+
+    namespace
+    {
+        bool EntryTimeLess(const KTPowerSpectrumCache::Entry& entry, double time)
+        {
+            return entry.fTimeInRun < time;
+        }
+
+        bool TimeEntryLess(double time, const KTPowerSpectrumCache::Entry& entry)
+        {
+            return time < entry.fTimeInRun;
+        }
+
+        uint64_t SpectrumBytes(const KTPowerSpectrum& spectrum)
+        {
+            return uint64_t(spectrum.size() * sizeof(double) + sizeof(KTPowerSpectrum));
+        }
+
+        // header (number of bins, range, mode) followed by the bin values
+        uint64_t RecordBytes(uint64_t nBins)
+        {
+            return sizeof(uint64_t) + 2 * sizeof(double) + sizeof(int) + nBins * sizeof(double);
+        }
+    }
+
+    KTPowerSpectrumCache::KTPowerSpectrumCache() :
+            fMemoryBudget(0),
+            fMaxAge(0.),
+            fMemoryUsed(0),
+            fEpoch(0),
+            fSpillFilename(),
+            fSpillFileBytes(0),
+            fSpillLiveBytes(0),
+            fEntries(),
+            fFirstInMemory(),
+            fSpillFile(),
+            fSpillBuffer(NULL)
+    {
+    }
+
+    KTPowerSpectrumCache::~KTPowerSpectrumCache()
+    {
+        Clear();
+        if (fSpillFile.is_open())
+        {
+            fSpillFile.close();
+            std::remove(fSpillFilename.c_str());
+        }
+        delete fSpillBuffer;
+    }
+
+    bool KTPowerSpectrumCache::SetSpillFilename(const std::string& filename)
+    {
+        // spilled entries refer to the old file, so start over
+        Clear();
+        if (fSpillFile.is_open())
+        {
+            fSpillFile.close();
+            std::remove(fSpillFilename.c_str());
+        }
+
+        fSpillFilename = filename;
+        if (fSpillFilename.empty()) return true;
+
+        if (! OpenSpillFile(true))
+        {
+            fSpillFilename.clear();
+            return false;
+        }
+        KTINFO(cachelog, "Power spectra that don't fit in memory will be written to <" << fSpillFilename << ">");
+        return true;
+    }
+
+    bool KTPowerSpectrumCache::Add(const KTPowerSpectrum& spectrum, const KTSliceHeader& slice, unsigned component)
+    {
+        if (! IsEnabled()) return true;
+
+        if (component >= fEntries.size())
+        {
+            fEntries.resize(component + 1);
+            fFirstInMemory.resize(component + 1, 0);
+        }
+
+        Entries& entries = fEntries[component];
+        if (! entries.empty() && slice.GetTimeInRun() < entries.back().fTimeInRun)
+        {
+            KTERROR(cachelog, "Spectra must be cached in time order; time in run " << slice.GetTimeInRun() << " is before the latest cached spectrum (" << entries.back().fTimeInRun << ")");
+            return false;
+        }
+
+        KTPowerSpectrum* copy = KTPowerSpectrum::Acquire(spectrum.size(), spectrum.GetRangeMin(), spectrum.GetRangeMax());
+        std::memcpy(copy->GetData(), spectrum.GetData(), spectrum.size() * sizeof(double));
+        copy->OverrideMode(spectrum.GetMode());
+
+        Entry entry;
+        entry.fTimeInRun = slice.GetTimeInRun();
+        entry.fTimeInAcq = slice.GetTimeInAcq();
+        entry.fSliceLength = slice.GetSliceLength();
+        entry.fEpoch = fEpoch;
+        entry.fSpectrum = copy;
+        entry.fFilePos = -1;
+        entry.fFileBytes = 0;
+        entries.push_back(entry);
+        fMemoryUsed += SpectrumBytes(*copy);
+
+        RemoveExpired(component);
+        EnforceBudget();
+
+        // Reclaim the space of removed spectra once it's more than the space of the spectra that are still in the file;
+        // each spilled spectrum is then copied at most once on average
+        if (fSpillFile.is_open() && fSpillFileBytes - fSpillLiveBytes > fSpillLiveBytes)
+        {
+            if (! CompactSpillFile())
+            {
+                KTWARN(cachelog, "Unable to reclaim space in the spill file <" << fSpillFilename << ">");
+            }
+        }
+        return true;
+    }
+
+    void KTPowerSpectrumCache::Clear()
+    {
+        for (std::vector< Entries >::iterator compIt = fEntries.begin(); compIt != fEntries.end(); ++compIt)
+        {
+            for (Entries::iterator entryIt = compIt->begin(); entryIt != compIt->end(); ++entryIt)
+            {
+                KTPowerSpectrum::Release(entryIt->fSpectrum);
+            }
+        }
+        fEntries.clear();
+        fFirstInMemory.clear();
+        fMemoryUsed = 0;
+        fSpillFileBytes = 0;
+        fSpillLiveBytes = 0;
+
+        if (fSpillFile.is_open())
+        {
+            fSpillFile.close();
+            OpenSpillFile(true);
+        }
+        return;
+    }
+
+    void KTPowerSpectrumCache::FindInterval(unsigned component, double startTime, double endTime, EntryCIt& begin, EntryCIt& end) const
+    {
+        if (component >= fEntries.size())
+        {
+            begin = end = EntryCIt();
+            return;
+        }
+        const Entries& entries = fEntries[component];
+        begin = std::lower_bound(entries.begin(), entries.end(), startTime, EntryTimeLess);
+        end = std::upper_bound(begin, entries.end(), endTime, TimeEntryLess);
+        return;
+    }
+
+    const KTPowerSpectrum* KTPowerSpectrumCache::GetSpectrum(const Entry& entry)
+    {
+        if (entry.fSpectrum != NULL) return entry.fSpectrum;
+        if (entry.fFilePos < 0 || ! fSpillFile.is_open()) return NULL;
+
+        uint64_t nBins = 0;
+        double range[2];
+        int mode = 0;
+        fSpillFile.clear();
+        fSpillFile.seekg(entry.fFilePos);
+        fSpillFile.read(reinterpret_cast< char* >(&nBins), sizeof(nBins));
+        fSpillFile.read(reinterpret_cast< char* >(range), sizeof(range));
+        fSpillFile.read(reinterpret_cast< char* >(&mode), sizeof(mode));
+        if (! fSpillFile)
+        {
+            KTERROR(cachelog, "Unable to read a spectrum header from the spill file");
+            return NULL;
+        }
+
+        if (fSpillBuffer == NULL || fSpillBuffer->size() != nBins)
+        {
+            delete fSpillBuffer;
+            fSpillBuffer = new KTPowerSpectrum(nBins, range[0], range[1]);
+        }
+        else
+        {
+            fSpillBuffer->SetRange(range[0], range[1]);
+        }
+        fSpillBuffer->OverrideMode(KTPowerSpectrum::Mode(mode));
+
+        fSpillFile.read(reinterpret_cast< char* >(fSpillBuffer->GetData()), nBins * sizeof(double));
+        if (! fSpillFile)
+        {
+            KTERROR(cachelog, "Unable to read a spectrum from the spill file");
+            return NULL;
+        }
+        return fSpillBuffer;
+    }
+
+    bool KTPowerSpectrumCache::Spill(Entry& entry)
+    {
+        const KTPowerSpectrum& spectrum = *entry.fSpectrum;
+        uint64_t nBins = spectrum.size();
+        double range[2] = {spectrum.GetRangeMin(), spectrum.GetRangeMax()};
+        int mode = int(spectrum.GetMode());
+
+        fSpillFile.clear();
+        fSpillFile.seekp(fSpillFileBytes);
+        std::streamoff pos = fSpillFileBytes;
+        fSpillFile.write(reinterpret_cast< const char* >(&nBins), sizeof(nBins));
+        fSpillFile.write(reinterpret_cast< const char* >(range), sizeof(range));
+        fSpillFile.write(reinterpret_cast< const char* >(&mode), sizeof(mode));
+        fSpillFile.write(reinterpret_cast< const char* >(spectrum.GetData()), nBins * sizeof(double));
+        if (! fSpillFile)
+        {
+            KTERROR(cachelog, "Unable to write a spectrum to the spill file <" << fSpillFilename << ">");
+            return false;
+        }
+        entry.fFilePos = pos;
+        entry.fFileBytes = RecordBytes(nBins);
+        fSpillFileBytes += entry.fFileBytes;
+        fSpillLiveBytes += entry.fFileBytes;
+        return true;
+    }
+
+    void KTPowerSpectrumCache::EnforceBudget()
+    {
+        while (fMemoryUsed > fMemoryBudget)
+        {
+            // the oldest spectrum in memory of any component is removed first; the most recent spectrum of each component is always kept
+            unsigned component = fEntries.size();
+            double oldestTime = 0.;
+            for (unsigned iComponent = 0; iComponent < fEntries.size(); ++iComponent)
+            {
+                if (fFirstInMemory[iComponent] + 1 >= fEntries[iComponent].size()) continue;
+                double time = fEntries[iComponent][fFirstInMemory[iComponent]].fTimeInRun;
+                if (component == fEntries.size() || time < oldestTime)
+                {
+                    component = iComponent;
+                    oldestTime = time;
+                }
+            }
+            if (component == fEntries.size()) break;
+
+            Entries& entries = fEntries[component];
+            size_t& first = fFirstInMemory[component];
+            Entry& oldest = entries[first];
+            fMemoryUsed -= SpectrumBytes(*oldest.fSpectrum);
+            if (fSpillFile.is_open() && Spill(oldest))
+            {
+                KTPowerSpectrum::Release(oldest.fSpectrum);
+                oldest.fSpectrum = NULL;
+                ++first;
+            }
+            else
+            {
+                KTPowerSpectrum::Release(oldest.fSpectrum);
+                entries.erase(entries.begin() + first);
+            }
+        }
+        return;
+    }
+
+    void KTPowerSpectrumCache::RemoveExpired(unsigned component)
+    {
+        if (fMaxAge <= 0.) return;
+
+        Entries& entries = fEntries[component];
+        size_t& first = fFirstInMemory[component];
+        double oldestTime = entries.back().fTimeInRun - fMaxAge;
+        while (entries.size() > 1 && entries.front().fTimeInRun < oldestTime)
+        {
+            Entry& oldest = entries.front();
+            if (oldest.fSpectrum != NULL)
+            {
+                fMemoryUsed -= SpectrumBytes(*oldest.fSpectrum);
+                KTPowerSpectrum::Release(oldest.fSpectrum);
+            }
+            else if (oldest.fFilePos >= 0)
+            {
+                fSpillLiveBytes -= oldest.fFileBytes;
+            }
+            entries.pop_front();
+            if (first > 0) --first;
+        }
+        return;
+    }
+
+    bool KTPowerSpectrumCache::CompactSpillFile()
+    {
+        fSpillFile.close();
+        if (fSpillLiveBytes == 0)
+        {
+            return OpenSpillFile(true);
+        }
+
+        std::string newFilename(fSpillFilename + ".compact");
+        std::ofstream newFile(newFilename.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+        std::ifstream oldFile(fSpillFilename.c_str(), std::ios::in | std::ios::binary);
+
+        // The entries keep their old positions until the new file is in place
+        std::vector< std::streamoff > newPositions;
+        std::vector< char > buffer;
+        std::streamoff newPos = 0;
+        for (std::vector< Entries >::const_iterator compIt = fEntries.begin(); compIt != fEntries.end() && newFile && oldFile; ++compIt)
+        {
+            for (EntryCIt entryIt = compIt->begin(); entryIt != compIt->end(); ++entryIt)
+            {
+                if (entryIt->fSpectrum != NULL || entryIt->fFilePos < 0) continue;
+                buffer.resize(entryIt->fFileBytes);
+                oldFile.seekg(entryIt->fFilePos);
+                oldFile.read(buffer.data(), buffer.size());
+                newFile.write(buffer.data(), buffer.size());
+                if (! newFile || ! oldFile) break;
+                newPositions.push_back(newPos);
+                newPos += entryIt->fFileBytes;
+            }
+        }
+        bool copied = newFile && oldFile;
+        newFile.close();
+        oldFile.close();
+
+        if (! copied || std::rename(newFilename.c_str(), fSpillFilename.c_str()) != 0)
+        {
+            KTERROR(cachelog, "Unable to copy the cached spectra to the new spill file <" << newFilename << ">");
+            std::remove(newFilename.c_str());
+            OpenSpillFile(false);
+            return false;
+        }
+
+        std::vector< std::streamoff >::const_iterator posIt = newPositions.begin();
+        for (std::vector< Entries >::iterator compIt = fEntries.begin(); compIt != fEntries.end(); ++compIt)
+        {
+            for (Entries::iterator entryIt = compIt->begin(); entryIt != compIt->end(); ++entryIt)
+            {
+                if (entryIt->fSpectrum != NULL || entryIt->fFilePos < 0) continue;
+                entryIt->fFilePos = *posIt++;
+            }
+        }
+        KTDEBUG(cachelog, "Spill file compacted from " << fSpillFileBytes << " to " << newPos << " bytes");
+        fSpillFileBytes = uint64_t(newPos);
+        return OpenSpillFile(false);
+    }
+
+    bool KTPowerSpectrumCache::OpenSpillFile(bool truncate)
+    {
+        std::ios::openmode mode = std::ios::in | std::ios::out | std::ios::binary;
+        if (truncate)
+        {
+            mode |= std::ios::trunc;
+            fSpillFileBytes = 0;
+            fSpillLiveBytes = 0;
+        }
+        fSpillFile.open(fSpillFilename.c_str(), mode);
+        if (! fSpillFile.is_open())
+        {
+            KTERROR(cachelog, "Unable to open spill file <" << fSpillFilename << ">");
+            return false;
+        }
+        return true;
+    }
+
+} /* namespace Katydid */
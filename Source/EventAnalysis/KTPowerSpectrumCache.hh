@@ -0,0 +1,151 @@
+/**
+ @file KTPowerSpectrumCache.hh
+ @brief Contains KTPowerSpectrumCache
+ @details Bounded, time-indexed cache of recent power spectra
+ @author: N.S. Oblath
+ @date: Oct 17, 2026
+ */
+
+#ifndef KTPOWERSPECTRUMCACHE_HH_
+#define KTPOWERSPECTRUMCACHE_HH_
+
+#include "KTMemberVariable.hh"
+
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Katydid
+{
+    class KTPowerSpectrum;
+    class KTSliceHeader;
+
+    /*!
+     @class KTPowerSpectrumCache
+     @author N.S. Oblath
+
+     @brief Bounded, time-indexed cache of recent power spectra
+
+     @details
+     Copies of the power spectra are kept per component in order of their time in run, so the spectra within a time interval
+     are found with a binary search (FindInterval()).
+
+     The spectra in memory are limited by the memory budget (in bytes), which is shared by all of the components; when it's exceeded,
+     the oldest spectra (by time in run, whichever component they belong to) are dropped, except that the most recent spectrum of each component is kept.
+     If a spill file is set, the dropped spectra are written to that file instead, and they remain available through GetSpectrum().
+     The spill file is emptied when the cache is cleared, and removed when the cache is destroyed.
+
+     If the maximum age is set, spectra older than that (relative to the latest spectrum of the same component) are removed,
+     whether they're in memory or in the spill file.  The space of the removed spectra in the spill file is reclaimed
+     once it's larger than the space of the spectra that are still there: the remaining spectra are copied to a new file
+     (or, if none remain, the file is emptied).  So with a maximum age the spill file doesn't grow without bound.
+
+     Spectra are also tagged with an epoch number, which is advanced with NewEpoch() (e.g. at the start of a new acquisition),
+     so that users can avoid combining spectra across a discontinuity.
+
+     Spectra must be added in order of increasing time in run.
+    */
+    class KTPowerSpectrumCache
+    {
+        public:
+            struct Entry
+            {
+                double fTimeInRun;
+                double fTimeInAcq;
+                double fSliceLength;
+                unsigned fEpoch;
+                KTPowerSpectrum* fSpectrum; // NULL if the spectrum has been spilled to disk
+                std::streamoff fFilePos; // position in the spill file; -1 if the spectrum was never spilled
+                uint64_t fFileBytes; // size of the spectrum's record in the spill file
+            };
+            typedef std::deque< Entry > Entries;
+            typedef Entries::const_iterator EntryCIt;
+
+        public:
+            KTPowerSpectrumCache();
+            ~KTPowerSpectrumCache();
+
+            /// Maximum number of bytes of spectra kept in memory; 0 disables the cache
+            MEMBERVARIABLE(uint64_t, MemoryBudget);
+            /// Spectra more than this much time in run older than the latest spectrum of their component are removed; 0 (default) keeps them
+            MEMBERVARIABLE(double, MaxAge);
+            MEMBERVARIABLE_NOSET(uint64_t, MemoryUsed);
+            MEMBERVARIABLE_NOSET(unsigned, Epoch);
+            MEMBERVARIABLEREF_NOSET(std::string, SpillFilename);
+            /// Size of the spill file and of the spectra in it that are still cached
+            MEMBERVARIABLE_NOSET(uint64_t, SpillFileBytes);
+            MEMBERVARIABLE_NOSET(uint64_t, SpillLiveBytes);
+
+            /// Sets the file used to store spectra that no longer fit in memory; an empty filename disables spilling
+            bool SetSpillFilename(const std::string& filename);
+
+            bool IsEnabled() const;
+
+            /// Stores a copy of the spectrum
+            bool Add(const KTPowerSpectrum& spectrum, const KTSliceHeader& slice, unsigned component);
+
+            /// Advances the epoch number given to spectra that are added from now on
+            void NewEpoch();
+
+            /// Removes all spectra (including those spilled to disk)
+            void Clear();
+
+            /// Returns the range of entries with time in run in [startTime, endTime]
+            void FindInterval(unsigned component, double startTime, double endTime, EntryCIt& begin, EntryCIt& end) const;
+
+            /// Returns the spectrum for an entry; spilled spectra are read into a buffer that's reused by the next call
+            const KTPowerSpectrum* GetSpectrum(const Entry& entry);
+
+            unsigned GetNComponents() const;
+            bool IsEmpty(unsigned component) const;
+            /// Time in run of the most recent spectrum; only valid if the component is not empty
+            double GetLatestTime(unsigned component) const;
+
+        private:
+            bool Spill(Entry& entry);
+            /// Removes (or spills) the oldest spectra in memory, of any component, until the memory used is within the budget
+            void EnforceBudget();
+            void RemoveExpired(unsigned component);
+            /// Copies the spectra that are still cached to a new spill file, and replaces the old file with it
+            bool CompactSpillFile();
+            bool OpenSpillFile(bool truncate);
+
+            std::vector< Entries > fEntries;
+            /// Index of the first entry in each component that is still in memory
+            std::vector< size_t > fFirstInMemory;
+
+            std::fstream fSpillFile;
+            KTPowerSpectrum* fSpillBuffer;
+    };
+
+    inline bool KTPowerSpectrumCache::IsEnabled() const
+    {
+        return fMemoryBudget > 0;
+    }
+
+    inline void KTPowerSpectrumCache::NewEpoch()
+    {
+        ++fEpoch;
+        return;
+    }
+
+    inline unsigned KTPowerSpectrumCache::GetNComponents() const
+    {
+        return unsigned(fEntries.size());
+    }
+
+    inline bool KTPowerSpectrumCache::IsEmpty(unsigned component) const
+    {
+        return component >= fEntries.size() || fEntries[component].empty();
+    }
+
+    inline double KTPowerSpectrumCache::GetLatestTime(unsigned component) const
+    {
+        return fEntries[component].back().fTimeInRun;
+    }
+
+} /* namespace Katydid */
+
+#endif /* KTPOWERSPECTRUMCACHE_HH_ */
@@ -16,9 +16,12 @@
 #include "KTPowerSpectrumData.hh"
 #include "KTData.hh"
 #include "KTMultiPSData.hh"
+#include "KTSpectrogramData.hh"
 
 #include <set>
 #include <algorithm>
+#include <cstring>
+#include <limits>
 
 namespace Katydid
 {
@@ -35,6 +38,7 @@ namespace Katydid
             fMaxBin(1),
             fCalculateMinBin(true),
             fCalculateMaxBin(true),
+            fSpectrumCache(),
             fLeadTime(0.),
             fTrailTime(0.),
             fLeadFreq(0.),
@@ -44,12 +48,18 @@ namespace Katydid
             fPrevSliceTimeInRun(0.),
             fPrevSliceTimeInAcq(0.),
             fNSpectrograms(0),
+            fCacheMaxTrackLength(1.),
+            fSpectrogramOutput(false),
+            fWaterfallSets(),
+            fOpenWaterfalls(),
+            fLastRowEndTime(-std::numeric_limits< double >::max()),
             fWaterfallSignal("ps-coll", this),
             fTrackSlot("track", this, &KTSpectrogramCollector::ReceiveTrack),
             fMPTrackSlot("mp-track", this, &KTSpectrogramCollector::ReceiveMPTrack),
             fMPEventSlot("mp-event", this, &KTSpectrogramCollector::ReceiveMPEvent)
     {
         RegisterSlot( "ps", this, &KTSpectrogramCollector::SlotFunctionPSData );
+        RegisterSlot( "spectrogram", this, &KTSpectrogramCollector::SlotFunctionSpectrogramData );
     }
 
     KTSpectrogramCollector::~KTSpectrogramCollector()
@@ -59,6 +69,19 @@ namespace Katydid
     // Emit Signal
     void KTSpectrogramCollector::FinishSC( Nymph::KTDataPtr data, unsigned comp )
     {
+        if( fSpectrogramOutput )
+        {
+            KTPSCollectionData& collection = data->Of< KTPSCollectionData >();
+            KTSpectrogramData& sgData = data->Of< KTSpectrogramData >().SetNComponents( collection.GetNComponents() );
+            for( unsigned iComponent = 0; iComponent < collection.GetNComponents(); ++iComponent )
+            {
+                if( collection.GetSpectra( iComponent ) == NULL ) continue;
+                KTSpectrogram* spectrogram = new KTSpectrogram( *collection.GetSpectra( iComponent ) );
+                // The spectra were placed in time bins of width DeltaT, starting at the start time
+                spectrogram->GetTimeAxis().SetRange( collection.GetStartTime(), collection.GetStartTime() + spectrogram->GetNTimeBins() * collection.GetDeltaT() );
+                sgData.SetSpectrogram( spectrogram, iComponent );
+            }
+        }
         fWaterfallSignal( data );
     }
 
@@ -84,6 +107,21 @@ namespace Katydid
         SetUseTrackFreqs(node->get_value< bool >("use-track-freqs", fUseTrackFreqs));
         SetFullEvent(node->get_value< bool >("full-event", fFullEvent));
 
+        if (node->has("cache-memory"))
+        {
+            fSpectrumCache.SetMemoryBudget(uint64_t(node->get_value< double >("cache-memory") * 1048576.));
+        }
+        SetCacheMaxTrackLength(node->get_value< double >("cache-max-track-length", fCacheMaxTrackLength));
+        SetSpectrogramOutput(node->get_value< bool >("spectrogram-output", fSpectrogramOutput));
+        if (node->has("cache-spill-file"))
+        {
+            if (! fSpectrumCache.SetSpillFilename(node->get_value("cache-spill-file")))
+            {
+                KTERROR(evlog, "Unable to set up the spill file for the spectrum cache");
+                return false;
+            }
+        }
+
         return true;
     }
 
@@ -130,9 +168,12 @@ namespace Katydid
         }
 
         // Add to fWaterfallSets
-        fWaterfallSets[component].insert( std::make_pair( ptr, newWaterfall ) );
+        if( ! RegisterWaterfall( ptr, newWaterfall, component ) )
+        {
+            return false;
+        }
 
-        KTINFO(evlog, "Added track to component " << component << ". Now listening to a total of " << fWaterfallSets[component].size() << " tracks");
+        KTINFO(evlog, "Added track to component " << component << ". Now listening to a total of " << fOpenWaterfalls[component].size() << " tracks");
         KTINFO(evlog, "Track length: " << trackData.GetEndTimeInRunC() - trackData.GetStartTimeInRunC());
         KTINFO(evlog, "Track slope: " << trackData.GetSlope());
 
@@ -253,9 +294,12 @@ namespace Katydid
         }
 
         // Add to fWaterfallSets
-        fWaterfallSets[component].insert( std::make_pair( ptr, newWaterfall ) );
+        if( ! RegisterWaterfall( ptr, newWaterfall, component ) )
+        {
+            return false;
+        }
 
-        KTINFO(evlog, "Added track to component " << component << ". Now listening to a total of " << fWaterfallSets[component].size() << " tracks");
+        KTINFO(evlog, "Added track to component " << component << ". Now listening to a total of " << fOpenWaterfalls[component].size() << " tracks");
         KTINFO(evlog, "Track length: " << overallEndTime - overallStartTime);
 
         return true;   
@@ -399,61 +443,163 @@ namespace Katydid
 
         // Add to fWaterfallSets
         newWaterfall->SetSpectrogramCounter(fNSpectrograms);
-        fWaterfallSets[component].insert( std::make_pair( ptr, newWaterfall ) );
+        if( ! RegisterWaterfall( ptr, newWaterfall, component ) )
+        {
+            return false;
+        }
         fNSpectrograms +=1;
 
-        KTINFO(evlog, "Added track to component " << component << ". Now listening to a total of " << fWaterfallSets[component].size() << " tracks");
+        KTINFO(evlog, "Added track to component " << component << ". Now listening to a total of " << fOpenWaterfalls[component].size() << " tracks");
         KTINFO(evlog, "Track length: " << overallEndTime - overallStartTime);
 
         return true;
     }
 
+    bool KTSpectrogramCollector::RegisterWaterfall( Nymph::KTDataPtr ptr, KTPSCollectionData* waterfall, unsigned component )
+    {
+        std::pair< WaterfallSet::iterator, bool > inserted = fWaterfallSets[component].insert( std::make_pair( ptr, waterfall ) );
+        if( ! inserted.second )
+        {
+            // As before, a spectrogram with the same start time as one that's already being collected is ignored;
+            // it's owned by ptr, so it's deleted along with it
+            KTDEBUG(evlog, "A spectrogram starting at " << waterfall->GetStartTime() << " is already being collected; ignoring this one");
+            return true;
+        }
+
+        // A track that arrives after its spectra is filled from the cache
+        if( fSpectrumCache.IsEnabled() && ! fSpectrumCache.IsEmpty(component) && FillFromCache( inserted.first, component ) )
+        {
+            return true;
+        }
+
+        // Keep the open spectrograms in order of start time
+        std::vector< WaterfallSet::iterator >& open = fOpenWaterfalls[component];
+        std::vector< WaterfallSet::iterator >::iterator position = open.end();
+        while( position != open.begin() && (*(position - 1))->second->GetStartTime() > waterfall->GetStartTime() )
+        {
+            --position;
+        }
+        open.insert( position, inserted.first );
+
+        return true;
+    }
+
+    bool KTSpectrogramCollector::FillFromCache( WaterfallSet::iterator waterfallIt, unsigned component )
+    {
+        KTPSCollectionData* waterfall = waterfallIt->second;
+
+        KTPowerSpectrumCache::EntryCIt begin, end;
+        fSpectrumCache.FindInterval( component, waterfall->GetStartTime(), waterfall->GetEndTime(), begin, end );
+        // If the time window has passed, no more spectra will arrive for this spectrogram
+        bool windowPassed = fSpectrumCache.GetLatestTime( component ) > waterfall->GetEndTime();
+
+        if( begin == end )
+        {
+            if( windowPassed )
+            {
+                KTWARN(evlog, "The spectra for the time window [" << waterfall->GetStartTime() << ", " << waterfall->GetEndTime() << "] are no longer cached; will not collect this track");
+            }
+            return windowPassed;
+        }
+
+        KTDEBUG(evlog, "Filling spectrogram [" << waterfall->GetStartTime() << ", " << waterfall->GetEndTime() << "] with " << end - begin << " cached spectra");
+        unsigned epoch = begin->fEpoch;
+        double lastTimeInAcq = begin->fTimeInAcq;
+        for( KTPowerSpectrumCache::EntryCIt entryIt = begin; entryIt != end; ++entryIt )
+        {
+            // Spectra from a new acquisition end the spectrogram, as if the emit had been forced
+            if( entryIt->fEpoch != epoch )
+            {
+                windowPassed = true;
+                break;
+            }
+            const KTPowerSpectrum* ps = fSpectrumCache.GetSpectrum( *entryIt );
+            if( ps == NULL )
+            {
+                KTERROR(evlog, "Unable to get the cached spectrum at time " << entryIt->fTimeInRun);
+                continue;
+            }
+            waterfall->SetDeltaT( entryIt->fSliceLength );
+            waterfall->AddSpectrum( entryIt->fTimeInRun, *ps, component );
+            waterfall->SetFilling( true );
+            lastTimeInAcq = entryIt->fTimeInAcq;
+        }
+
+        if( windowPassed && waterfall->GetFilling() )
+        {
+            waterfall->SetFilling( false );
+            CloseWaterfall( *waterfallIt, lastTimeInAcq, component );
+        }
+        return windowPassed;
+    }
+
+    void KTSpectrogramCollector::CloseWaterfall( const WaterfallSet::value_type& waterfall, double lastTimeInAcq, unsigned component )
+    {
+        // Emit signal
+        KTINFO(evlog, "Finished a track; emitting signal");
+
+        KTINFO(evlog, "Old start time: " << waterfall.second->GetStartTime());
+        KTINFO(evlog, "Old end time: " << waterfall.second->GetEndTime());
+
+        KTINFO(evlog, "Last slice acquisition time:" << lastTimeInAcq);
+
+        // Convert start and end times from run to acquistion
+        waterfall.second->SetStartTime( waterfall.second->GetStartTime() - waterfall.second->GetEndTime() + lastTimeInAcq );
+        waterfall.second->SetEndTime( lastTimeInAcq );
+
+        KTINFO(evlog, "New start time: " << waterfall.second->GetStartTime());
+        KTINFO(evlog, "New end time: " << waterfall.second->GetEndTime());
+
+        FinishSC( waterfall.first, component );
+        return;
+    }
+
     bool KTSpectrogramCollector::ConsiderSpectrum( KTPowerSpectrum& ps, KTSliceHeader& slice, unsigned component, bool forceEmit )
     {
         KTDEBUG(evlog, "Now cross-checking slice timestamp with known tracks");
-        // Iterate through each track which has been added
-        for( auto it = fWaterfallSets[component].begin(); it != fWaterfallSets[component].end(); ++it )
+        // Iterate through the open spectrograms; the ones that are still open afterwards are moved to the front
+        std::vector< WaterfallSet::iterator >& open = fOpenWaterfalls[component];
+        std::vector< WaterfallSet::iterator >::iterator keepIt = open.begin();
+        std::vector< WaterfallSet::iterator >::iterator it = open.begin();
+        for( ; it != open.end(); ++it )
         {
-            KTDEBUG(evlog, "slice's time in run: " << slice.GetTimeInRun() << ";  compared to track [" << it->second->GetStartTime() << ", " << it->second->GetEndTime() << "]");
+            KTPSCollectionData* waterfall = (*it)->second;
+            // The open spectrograms are in order of start time, so none of the rest have started yet
+            if( slice.GetTimeInRun() < waterfall->GetStartTime() ) break;
+
+            KTDEBUG(evlog, "slice's time in run: " << slice.GetTimeInRun() << ";  compared to track [" << waterfall->GetStartTime() << ", " << waterfall->GetEndTime() << "]");
             // If the slice time coincides with the track time window, add the spectrum
             // The forceEmit flag overrides this; essentially guarantees the spectrum will be interpreted as outside the track window
-            if( !forceEmit && slice.GetTimeInRun() >= it->second->GetStartTime() && slice.GetTimeInRun() <= it->second->GetEndTime() )
+            if( !forceEmit && slice.GetTimeInRun() <= waterfall->GetEndTime() )
             {
                 KTINFO(evlog, "Adding spectrum. Time in acquisition = " << slice.GetTimeInAcq());
-                it->second->SetDeltaT( slice.GetSliceLength() );
-                it->second->AddSpectrum( slice.GetTimeInRun(), ps, component );
-                it->second->SetFilling( true );
+                waterfall->SetDeltaT( slice.GetSliceLength() );
+                waterfall->AddSpectrum( slice.GetTimeInRun(), ps, component );
+                waterfall->SetFilling( true );
+                *keepIt++ = *it;
             }
-            else
+            else if( waterfall->GetFilling() )
             {
                 // If GetFilling() is true, we've reached the end of the track time window
                 // forceEmit=true sends all tracks to this clause, and those still filling will be closed & signals emitted
-                if( it->second->GetFilling() )
-                {
-                    it->second->SetFilling( false );
-
-                    // Emit signal
-                    KTINFO(evlog, "Finished a track; emitting signal");
-
-                    KTINFO(evlog, "Old start time: " << it->second->GetStartTime());
-                    KTINFO(evlog, "Old end time: " << it->second->GetEndTime());
-
-                    KTINFO(evlog, "Slice acquisition time:" << slice.GetTimeInAcq());
-
-                    // Convert start and end times from run to acquistion
-                    it->second->SetStartTime( it->second->GetStartTime() - it->second->GetEndTime() + fPrevSliceTimeInAcq );
-                    it->second->SetEndTime( fPrevSliceTimeInAcq );
-
-                    KTINFO(evlog, "New start time: " << it->second->GetStartTime());
-                    KTINFO(evlog, "New end time: " << it->second->GetEndTime());
-
-                    FinishSC( it->first, component );
-                }
-                else
-                {
-                    it->second->SetFilling( false );
-                }
+                waterfall->SetFilling( false );
+                CloseWaterfall( **it, fPrevSliceTimeInAcq, component );
+            }
+            else if( slice.GetTimeInRun() <= waterfall->GetEndTime() )
+            {
+                // Forced emit before this spectrogram received any spectra; it can still be filled
+                *keepIt++ = *it;
             }
+            // Otherwise the time window has passed, and the spectrogram is no longer open
+        }
+        keepIt = std::copy( it, open.end(), keepIt );
+        open.erase( keepIt, open.end() );
+
+        // A late track can need spectra from as far back as its length plus the lead and trail times
+        fSpectrumCache.SetMaxAge( fCacheMaxTrackLength + fLeadTime + fTrailTime );
+        if( ! fSpectrumCache.Add( ps, slice, component ) )
+        {
+            KTWARN(evlog, "Unable to cache the spectrum at time " << slice.GetTimeInRun());
         }
 
         SetPrevSliceTimeInRun( slice.GetTimeInRun() );
@@ -465,17 +611,22 @@ namespace Katydid
         return true;
     }
 
+    void KTSpectrogramCollector::AddComponents( unsigned nComponents )
+    {
+        if( fWaterfallSets.size() < nComponents )
+        {
+            fWaterfallSets.resize( nComponents );
+            fOpenWaterfalls.resize( nComponents );
+        }
+        return;
+    }
+
     bool KTSpectrogramCollector::ReceiveTrack( KTProcessedTrackData& data )
     {
         unsigned iComponent = data.GetComponent();
 
         // Increase size of fWaterfallSets if necessary
-        int fWSsize = fWaterfallSets.size();
-        std::set< std::pair< Nymph::KTDataPtr, KTPSCollectionData* >, KTTrackCompare > blankSet;
-        for( int i = fWSsize; i <= iComponent; i++ )
-        {
-            fWaterfallSets.push_back( blankSet );
-        }
+        AddComponents( iComponent + 1 );
 
         // Add track
         if( !AddTrack( data, iComponent ) )
@@ -491,12 +642,7 @@ namespace Katydid
         unsigned iComponent = data.GetComponent();
 
         // Increase size of fWaterfallSets if necessary
-        int fWSsize = fWaterfallSets.size();
-        std::set< std::pair< Nymph::KTDataPtr, KTPSCollectionData* >, KTTrackCompare > blankSet;
-        for( int i = fWSsize; i <= iComponent; i++ )
-        {
-            fWaterfallSets.push_back( blankSet );
-        }
+        AddComponents( iComponent + 1 );
 
         // Add track
         if( !AddMPTrack( data, iComponent ) )
@@ -512,12 +658,7 @@ namespace Katydid
         unsigned iComponent = data.GetComponent();
 
         // Increase size of fWaterfallSets if necessary
-        int fWSsize = fWaterfallSets.size();
-        std::set< std::pair< Nymph::KTDataPtr, KTPSCollectionData* >, KTTrackCompare > blankSet;
-        for( int i = fWSsize; i <= iComponent; i++ )
-        {
-            fWaterfallSets.push_back( blankSet );
-        }
+        AddComponents( iComponent + 1 );
 
         // Add track
         if( !AddMPEvent( data, iComponent ) )
@@ -542,30 +683,153 @@ namespace Katydid
             KTDEBUG(evlog, "Maximum bin set to " << fMaxBin);
         }
 
-        if( fWaterfallSets.empty() )
+        unsigned nComponents = PrepareComponents( data.GetNComponents(), forceEmit );
+
+        for (unsigned iComponent=0; iComponent<nComponents; ++iComponent)
         {
-            KTWARN(evlog, "I have no tracks to receive a spectrum! Did you remember to send me processed tracks first? Continuing anyway...");
-            return true;
+            if (! ConsiderSpectrum(*data.GetSpectrum(iComponent), sliceData, iComponent, forceEmit))
+            {
+                KTERROR(evlog, "Spectrogram collector could not receive spectrum! (component " << iComponent << ")");
+                return false;
+            }
         }
+        KTINFO(evlog, "Spectrum finished processing. Awaiting next spectrum");
 
-        int nComponents = data.GetNComponents();
+        return true;
+    }
 
-        if( nComponents > fWaterfallSets.size() )
+    bool KTSpectrogramCollector::ReceiveSpectrogram( KTSpectrogramData& data, KTSliceHeader& sliceData, bool forceEmit )
+    {
+        KTDEBUG(evlog, "Receiving spectrogram");
+        if( data.GetNComponents() == 0 || data.GetSpectrogram(0) == NULL ) return true;
+
+        const KTSpectrogram& firstSpectrogram = *data.GetSpectrogram(0);
+        unsigned nTimeBins = firstSpectrogram.GetNTimeBins();
+        unsigned nFreqBins = firstSpectrogram.GetNFrequencyBins();
+        double timeBinWidth = firstSpectrogram.GetTimeBinWidth();
+        if( nTimeBins == 0 ) return true;
+
+        if (fCalculateMinBin)
         {
-            KTINFO(evlog, "Receiving spectrum with " << nComponents << " components but limiting to " << fWaterfallSets.size() << " from list of tracks");
-            nComponents = fWaterfallSets.size();
+            SetMinBin(firstSpectrogram.GetAxis().FindBin(fMinFrequency));
+            KTDEBUG(evlog, "Minimum bin set to " << fMinBin);
+        }
+        if (fCalculateMaxBin)
+        {
+            SetMaxBin(firstSpectrogram.GetAxis().FindBin(fMaxFrequency));
+            KTDEBUG(evlog, "Maximum bin set to " << fMaxBin);
         }
 
-        for (unsigned iComponent=0; iComponent<nComponents; ++iComponent)
+        for( unsigned iComponent = 1; iComponent < data.GetNComponents(); ++iComponent )
         {
-            if (! ConsiderSpectrum(*data.GetSpectrum(iComponent), sliceData, iComponent, forceEmit))
+            const KTSpectrogram* spectrogram = data.GetSpectrogram(iComponent);
+            if( spectrogram == NULL || spectrogram->GetNTimeBins() != nTimeBins || spectrogram->GetNFrequencyBins() != nFreqBins )
             {
-                KTERROR(evlog, "Spectrogram collector could not receive spectrum! (component " << iComponent << ")");
+                KTERROR(evlog, "Spectrogram for component " << iComponent << " does not match the one for component 0");
                 return false;
             }
         }
-        KTINFO(evlog, "Spectrum finished processing. Awaiting next spectrum");
+
+        if( ! fSpectrumCache.IsEnabled() && fWaterfallSets.empty() )
+        {
+            KTWARN(evlog, "I have no tracks to receive a spectrogram! Did you remember to send me processed tracks first? Continuing anyway...");
+            return true;
+        }
+
+        bool newAcquisition = sliceData.GetIsNewAcquisition();
+        if( newAcquisition )
+        {
+            fLastRowEndTime = -std::numeric_limits< double >::max();
+        }
+
+        // Rows are copied into this spectrum one at a time, and the slice header is updated to describe the row
+        KTPowerSpectrum rowSpectrum( nFreqBins, firstSpectrogram.GetAxis().GetRangeMin(), firstSpectrogram.GetAxis().GetRangeMax() );
+        KTSliceHeader rowHeader;
+        rowHeader.CopySliceHeaderOnly( sliceData );
+        rowHeader.SetSliceLength( timeBinWidth );
+        rowHeader.SetNSlicesIncluded( 1 );
+
+        for( unsigned iRow = 0; iRow < nTimeBins; ++iRow )
+        {
+            double rowTime = firstSpectrogram.GetTimeAxis().GetBinLowEdge( iRow );
+            bool forceRow = (iRow == 0 && newAcquisition) || (iRow == nTimeBins - 1 && forceEmit);
+            // Allow for rounding in the bin edges of overlapping spectrograms
+            if( ! forceRow && rowTime < fLastRowEndTime - 0.5 * timeBinWidth ) continue;
+
+            rowHeader.SetTimeInRun( rowTime );
+            rowHeader.SetTimeInAcq( sliceData.GetTimeInAcq() + (rowTime - sliceData.GetTimeInRun()) );
+            rowHeader.SetIsNewAcquisition( iRow == 0 && newAcquisition );
+
+            unsigned nComponents = PrepareComponents( data.GetNComponents(), forceRow );
+            for( unsigned iComponent = 0; iComponent < nComponents; ++iComponent )
+            {
+                const KTSpectrogram& spectrogram = *data.GetSpectrogram(iComponent);
+                rowSpectrum.OverrideMode( spectrogram.GetMode() );
+                std::memcpy( rowSpectrum.GetData(), spectrogram.GetRowData( iRow ), nFreqBins * sizeof(double) );
+                if( ! ConsiderSpectrum( rowSpectrum, rowHeader, iComponent, forceRow ) )
+                {
+                    KTERROR(evlog, "Spectrogram collector could not receive spectrogram row " << iRow << "! (component " << iComponent << ")");
+                    return false;
+                }
+            }
+            fLastRowEndTime = rowTime + timeBinWidth;
+        }
+        KTINFO(evlog, "Spectrogram finished processing. Awaiting next spectrogram");
 
         return true;
     }
+
+    unsigned KTSpectrogramCollector::PrepareComponents( unsigned nComponents, bool forceEmit )
+    {
+        if( fSpectrumCache.IsEnabled() )
+        {
+            // Spectra are cached even if there are no tracks yet
+            AddComponents( nComponents );
+            if( forceEmit )
+            {
+                fSpectrumCache.NewEpoch();
+            }
+        }
+        else if( fWaterfallSets.empty() )
+        {
+            KTWARN(evlog, "I have no tracks to receive a spectrum! Did you remember to send me processed tracks first? Continuing anyway...");
+            return 0;
+        }
+
+        if( nComponents > fWaterfallSets.size() )
+        {
+            KTINFO(evlog, "Receiving spectrum with " << nComponents << " components but limiting to " << fWaterfallSets.size() << " from list of tracks");
+            nComponents = fWaterfallSets.size();
+        }
+        return nComponents;
+    }
+
+    void KTSpectrogramCollector::SlotFunctionSpectrogramData( Nymph::KTDataPtr data )
+    {
+        if (! data->Has< KTSpectrogramData >())
+        {
+            KTERROR(evlog, "Data not found with type < KTSpectrogramData >!");
+            return;
+        }
+        if (! data->Has< KTSliceHeader >())
+        {
+            KTERROR(evlog, "Data not found with type < KTSliceHeader >!");
+            return;
+        }
+
+        // A new acquisition forces an emit at the first row; the last data forces an emit at the last row
+        bool force = data->GetLastData();
+        if (force)
+        {
+            KTDEBUG(evlog, "Reached last-data, forcing emit");
+        }
+
+        if (! ReceiveSpectrogram(data->Of< KTSpectrogramData >(), data->Of< KTSliceHeader >(), force))
+        {
+            KTERROR(evlog, "Something went wrong while analyzing data with type < KTSpectrogramData >");
+            return;
+        }
+
+        return;
+    }
 } // namespace Katydid
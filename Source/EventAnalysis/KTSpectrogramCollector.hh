@@ -13,10 +13,12 @@
 #include "KTSlot.hh"
 #include "KTLogger.hh"
 
+#include "KTPowerSpectrumCache.hh"
 #include "KTSpectrumCollectionData.hh"
 #include "KTSliceHeader.hh"
 
 #include <set>
+#include <vector>
 
 
 namespace Katydid
@@ -28,6 +30,7 @@ namespace Katydid
     class KTProcessedTrackData;
     class KTMultiPeakTrackData;
     class KTMultiTrackEventData;
+    class KTSpectrogramData;
 
     /*
      @class KTSpectrogramCollector
@@ -36,6 +39,19 @@ namespace Katydid
      @details
      Supports an arbitrary number of tracks to collect simultaneously. Collection begins when a spectrum is received which matches the timestamp
      of the beginning of a track. A signal is emitted when the spectrum matches the end time.
+
+     Only the spectrograms that are still open (in order of start time) are checked for each spectrum, so finished spectrograms cost nothing.
+
+     Optionally, recent power spectra are kept in a time-indexed cache (see KTPowerSpectrumCache) with a limited amount of memory.
+     A track that arrives after (some of) its spectra is then filled from the cache with a binary search over time,
+     including its lead time, and is emitted right away if its time window has already passed.
+     This way tracks don't have to be found before the spectra are run through the collector.
+
+     Dense spectrograms (e.g. from KTStreamingSTFT or KTSpectrogramStriper) can be received instead of individual power spectra.
+     Each row is treated like a power spectrum whose time in run is the low edge of the row's time bin.
+     Rows that were already received (e.g. because the stripes overlap) are skipped.
+     Optionally, the collected spectrograms are also emitted as dense KTSpectrogramData.
+
      Configuration name: "spectrogram-collector"
      
      Available configuration values:
@@ -49,15 +65,20 @@ namespace Katydid
      - "trail-freq": double -- frequency above the track to end collection
      - "use-track-freqs": bool -- if true, the min/max frequencies are calculated from the track and the lead/trail frequencies; if false, min/max-frequency is used
      - "full-event": bool -- if true, collect the full spectrogram of an MP-event. If false, collect only the first track grouping (fEventSequenceID==0)
+     - "cache-memory": double -- memory (in MB) used to cache recent power spectra; 0 (default) disables the cache
+     - "cache-spill-file": string -- if given, cached spectra that don't fit in memory are written to this file, and are still available to late tracks
+     - "cache-max-track-length": double -- length (in s) of the longest track that can be filled from the cache; older spectra (allowing for the lead and trail times) are removed from the cache and the spill file; default is 1 s
+     - "spectrogram-output": bool -- if true, each collected spectrogram is also added to the emitted data as a KTSpectrogramData; default is false
      
      Slots:
      - "track": void (Nymph::KTDataPtr) -- Adds a track to the list of active spectrogram collections; Requires KTProcessedTrackData; Adds nothing
      - "mp-track": void (Nymph::KTDataPtr) -- Adds a multi-peak track to the list of active spectrogram collections; Requires KTMultiPeakTrackData; Adds nothing
      - "mp-event": void (Nymph::KTDatPtr) -- Adds a multi-peak event to the list of active spectrogram collections; Requires KTMultiTrackEventData; Adds nothing
      - "ps": void (Nymph::KTDataPtr) -- Adds a power spectrum to the appropriate spectrogram(s), if any; Requires KTPowerSpectrumData and KTSliceHeader; Adds nothing
+     - "spectrogram": void (Nymph::KTDataPtr) -- Adds the rows of a dense spectrogram to the appropriate spectrogram(s), if any; Requires KTSpectrogramData and KTSliceHeader; Adds nothing
      
      Signals:
-     - "ps-coll": void (Nymph::KTDataPtr) -- Emitted upon completion of a spectrogram (waterfall plot); Guarantees KTPSCollectionData
+     - "ps-coll": void (Nymph::KTDataPtr) -- Emitted upon completion of a spectrogram (waterfall plot); Guarantees KTPSCollectionData, and KTSpectrogramData if "spectrogram-output" is set
     */
 
     class KTSpectrogramCollector : public Nymph::KTProcessor
@@ -81,6 +102,8 @@ namespace Katydid
             MEMBERVARIABLE(double, PrevSliceTimeInRun);
             MEMBERVARIABLE(double, PrevSliceTimeInAcq);
             MEMBERVARIABLE(uint64_t, NSpectrograms);
+            MEMBERVARIABLE(double, CacheMaxTrackLength);
+            MEMBERVARIABLE(bool, SpectrogramOutput);
 
         public:
             void SetMinFrequency( double freq );
@@ -92,6 +115,13 @@ namespace Katydid
             bool fCalculateMinBin;
             bool fCalculateMaxBin;
 
+        public:
+            const KTPowerSpectrumCache& GetSpectrumCache() const;
+            KTPowerSpectrumCache& GetSpectrumCache();
+
+        private:
+            KTPowerSpectrumCache fSpectrumCache;
+
         public:
             bool AddTrack(KTProcessedTrackData& trackData, unsigned component);
             bool AddMPTrack(KTMultiPeakTrackData& mpTrackData, unsigned component);
@@ -101,6 +131,8 @@ namespace Katydid
             bool ReceiveMPTrack(KTMultiPeakTrackData& data);
             bool ReceiveMPEvent(KTMultiTrackEventData& data);
             bool ReceiveSpectrum(KTPowerSpectrumData& data, KTSliceHeader& sliceData, bool forceEmit = false);
+            /// The slice header describes the first row; forceEmit applies to the last row
+            bool ReceiveSpectrogram(KTSpectrogramData& data, KTSliceHeader& sliceData, bool forceEmit = false);
             void FinishSC( Nymph::KTDataPtr data, unsigned comp );
 
         private:
@@ -119,6 +151,16 @@ namespace Katydid
             std::vector< WaterfallSet >& WaterfallSets();
 
         private:
+            void AddComponents(unsigned nComponents);
+            /// Returns the number of components that spectra should be considered for; 0 if there's nothing to do
+            unsigned PrepareComponents(unsigned nComponents, bool forceEmit);
+            /// Adds the spectrogram to fWaterfallSets and fills it from the cache; it's added to the open spectrograms if it still needs spectra.
+            /// A spectrogram with the same start time as one that's already in the set is ignored.
+            bool RegisterWaterfall(Nymph::KTDataPtr ptr, KTPSCollectionData* waterfall, unsigned component);
+            /// Returns true if the spectrogram is complete (or its spectra are no longer available)
+            bool FillFromCache(WaterfallSet::iterator waterfallIt, unsigned component);
+            void CloseWaterfall(const WaterfallSet::value_type& waterfall, double lastTimeInAcq, unsigned component);
+
             // The spectrograms are stored in a vector of sets of pairs of Nymph::KTDataPtr and KTPSCollectionData. The levels to this hierarchy are:
             //      Vector - each element corresponds to a component
             //      Set    - each element corresponds to a track
@@ -128,6 +170,12 @@ namespace Katydid
 
             std::vector< WaterfallSet > fWaterfallSets;
 
+            // Spectrograms that can still receive spectra, in order of start time
+            std::vector< std::vector< WaterfallSet::iterator > > fOpenWaterfalls;
+
+            // End time of the last spectrogram row that was received, so that overlapping rows are only used once
+            double fLastRowEndTime;
+
             //***************
             // Signals
             //***************
@@ -144,6 +192,7 @@ namespace Katydid
             Nymph::KTSlotDataOneType< KTMultiPeakTrackData > fMPTrackSlot;
             Nymph::KTSlotDataOneType< KTMultiTrackEventData > fMPEventSlot;
             void SlotFunctionPSData( Nymph::KTDataPtr data );
+            void SlotFunctionSpectrogramData( Nymph::KTDataPtr data );
 
     };
 
@@ -189,6 +238,16 @@ namespace Katydid
         return;
     }
 
+    inline const KTPowerSpectrumCache& KTSpectrogramCollector::GetSpectrumCache() const
+    {
+        return fSpectrumCache;
+    }
+
+    inline KTPowerSpectrumCache& KTSpectrogramCollector::GetSpectrumCache()
+    {
+        return fSpectrumCache;
+    }
+
     inline void KTSpectrogramCollector::SetMinFrequency(double freq)
     {
         fMinFrequency = freq;
@@ -0,0 +1,173 @@
+/*
+ * ProfileDACConversion.cc
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ *
+ *  Compares the throughput of the per-sample DAC conversion (through the KTVarTypePhysicalArray interface)
+ *  with the whole-buffer conversion kernels in KTSingleChannelDAC.
+ *
+ *  Usage: ProfileDACConversion [# of samples per slice] [# of slices]
+ */
+
+#include "KTEggHeader.hh"
+#include "KTLogger.hh"
+#include "KTRawTimeSeries.hh"
+#include "KTSingleChannelDAC.hh"
+#include "KTTimeSeriesFFTW.hh"
+#include "KTTimeSeriesReal.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <random>
+
+using namespace std;
+using namespace Katydid;
+
+KTLOGGER(proflog, "ProfileDACConversion");
+
+struct Result
+{
+    double fSamplesPerSecBefore;
+    double fSamplesPerSecAfter;
+    bool fIdentical;
+};
+
+// Per-sample conversion, as done before the whole-buffer kernels existed
+template< typename XInterfaceType >
+double ConvertPerSample(KTSingleChannelDAC& dac, const KTVarTypePhysicalArray< XInterfaceType >& ifc, double* output)
+{
+    unsigned nSamples = ifc.size();
+    for (unsigned iSample = 0; iSample < nSamples; ++iSample)
+    {
+        output[iSample] = dac.Convert(ifc(iSample));
+    }
+    return output[0];
+}
+
+Result Profile(unsigned dataTypeSize, uint32_t dataFormat, KTChannelHeader::TimeSeriesDataType tsType, unsigned nSamples, unsigned nSlices)
+{
+    KTChannelHeader header;
+    header.SetDataTypeSize(dataTypeSize);
+    header.SetDataFormat(dataFormat);
+    header.SetBitDepth(dataTypeSize * 8);
+    header.SetBitAlignment(sBitsAlignedRight);
+    header.SetVoltageOffset(-0.25);
+    header.SetVoltageRange(0.5);
+    header.SetDACGain(-1.);
+    header.SetTSDataType(tsType);
+
+    KTSingleChannelDAC dac;
+    if (! dac.InitializeWithHeader(&header))
+    {
+        KTERROR(proflog, "Unable to initialize the DAC");
+        exit(-1);
+    }
+
+    // fill the raw time series with random levels
+    KTRawTimeSeries raw(dataTypeSize, dataFormat, nSamples, 0., 1.);
+    mt19937 generator(1234);
+    uniform_int_distribution< unsigned > levelDist(0, (1 << (dataTypeSize * 8)) - 1);
+    uint8_t* storage = raw.GetStorage();
+    for (unsigned iByte = 0; iByte < raw.GetNBytes(); iByte += dataTypeSize)
+    {
+        unsigned level = levelDist(generator);
+        for (unsigned iSubByte = 0; iSubByte < dataTypeSize; ++iSubByte)
+        {
+            storage[iByte + iSubByte] = (level >> (8 * iSubByte)) & 0xFF;
+        }
+    }
+
+    vector< double > before(nSamples);
+    vector< double > after(nSamples);
+    double checksum = 0.;
+
+    // before: per-sample conversion through the interface
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (unsigned iSlice = 0; iSlice < nSlices; ++iSlice)
+    {
+        if (dataFormat == sDigitizedS)
+        {
+            checksum += ConvertPerSample(dac, KTVarTypePhysicalArray< int64_t >(raw, false), before.data());
+        }
+        else
+        {
+            checksum += ConvertPerSample(dac, raw, before.data());
+        }
+    }
+    double timeBefore = chrono::duration< double >(chrono::steady_clock::now() - start).count();
+
+    // after: whole-buffer kernels, including the allocation of the output time series
+    start = chrono::steady_clock::now();
+    for (unsigned iSlice = 0; iSlice < nSlices; ++iSlice)
+    {
+        KTTimeSeries* ts = dac.ConvertTimeSeries(&raw);
+        if (iSlice == 0)
+        {
+            if (tsType == KTChannelHeader::kReal)
+            {
+                const double* data = static_cast< KTTimeSeriesReal* >(ts)->GetData();
+                after.assign(data, data + nSamples);
+            }
+            else
+            {
+                const double* data = reinterpret_cast< const double* >(static_cast< KTTimeSeriesFFTW* >(ts)->GetData());
+                after.assign(data, data + nSamples);
+            }
+        }
+        checksum += ts->GetValue(0);
+        KTTimeSeries::Release(ts);
+    }
+    double timeAfter = chrono::duration< double >(chrono::steady_clock::now() - start).count();
+
+    KTDEBUG(proflog, "Checksum (ignore): " << checksum);
+
+    Result result;
+    result.fSamplesPerSecBefore = double(nSamples) * double(nSlices) / timeBefore;
+    result.fSamplesPerSecAfter = double(nSamples) * double(nSlices) / timeAfter;
+    result.fIdentical = before == after;
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned nSamples = 1048576;
+    unsigned nSlices = 100;
+    if (argc > 1) nSamples = atoi(argv[1]);
+    if (argc > 2) nSlices = atoi(argv[2]);
+    // complex data is interleaved, so there must be an even number of raw samples
+    nSamples -= nSamples % 2;
+
+    KTINFO(proflog, "Profiling DAC conversion with " << nSlices << " slices of " << nSamples << " raw samples");
+
+    unsigned sizes[] = {1, 2};
+    uint32_t formats[] = {sDigitizedUS, sDigitizedS};
+    KTChannelHeader::TimeSeriesDataType tsTypes[] = {KTChannelHeader::kReal, KTChannelHeader::kIQ};
+
+    bool allIdentical = true;
+    for (unsigned size : sizes)
+    {
+        for (uint32_t format : formats)
+        {
+            for (KTChannelHeader::TimeSeriesDataType tsType : tsTypes)
+            {
+                Result result = Profile(size, format, tsType, nSamples, nSlices);
+                KTINFO(proflog, size << "-byte " << (format == sDigitizedS ? "signed" : "unsigned") <<
+                        " --> " << (tsType == KTChannelHeader::kReal ? "real" : "fftw") << ":\n" <<
+                        "\tBefore (per sample): " << result.fSamplesPerSecBefore << " samples/s\n" <<
+                        "\tAfter (kernel):      " << result.fSamplesPerSecAfter << " samples/s\n" <<
+                        "\tSpeedup: " << result.fSamplesPerSecAfter / result.fSamplesPerSecBefore << '\n' <<
+                        "\tIdentical output: " << (result.fIdentical ? "yes" : "NO"));
+                allIdentical = allIdentical && result.fIdentical;
+            }
+        }
+    }
+
+    if (! allIdentical)
+    {
+        KTERROR(proflog, "The kernel conversion did not match the per-sample conversion");
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,131 @@
+/*
+ * ProfileSequentialTrackFinder.cc
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ *
+ *  Measures the time KTSequentialTrackFinder takes per slice as a function of the average number of active lines.
+ *
+ *  Each configuration has N parallel tracks that turn on and off (so lines are continuously created and retired),
+ *  plus N noise points per slice at random frequencies (which create short-lived single-point lines).
+ *
+ *  Usage: ProfileSequentialTrackFinder [# of slices]
+ */
+
+#include "KTDiscriminatedPoints1DData.hh"
+#include "KTLogger.hh"
+#include "KTSequentialTrackFinder.hh"
+#include "KTSliceHeader.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+using namespace std;
+using namespace Katydid;
+
+KTLOGGER(proflog, "ProfileSequentialTrackFinder");
+
+bool CompareBins(const pair< unsigned, KTDiscriminatedPoints1DData::Point >& lhs, const pair< unsigned, KTDiscriminatedPoints1DData::Point >& rhs)
+{
+    return lhs.first < rhs.first;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned nSlices = 2000;
+    if (argc > 1) nSlices = atoi(argv[1]);
+
+    const double sampleRate = 200.e6; // Hz
+    const unsigned sliceSize = 16384;
+    const double binWidth = sampleRate / double(sliceSize); // Hz
+    const double sliceLength = double(sliceSize) / sampleRate; // s
+    const unsigned nBins = sliceSize / 2;
+
+    const double slope = 3.e8; // Hz/s
+    const unsigned trackSpacing = 8; // bins
+    const unsigned trackOnSlices = 20;
+    const unsigned trackPeriod = 25;
+
+    const unsigned nTrackCounts = 6;
+    const unsigned trackCounts[nTrackCounts] = {10, 30, 100, 300, 600, 1000};
+
+    KTINFO(proflog, "Profiling KTSequentialTrackFinder with " << nSlices << " slices; " << binWidth << " Hz bins");
+
+    for (unsigned iCount = 0; iCount < nTrackCounts; ++iCount)
+    {
+        unsigned nTracks = trackCounts[iCount];
+        if (nTracks * trackSpacing >= nBins) break;
+
+        KTSequentialTrackFinder finder;
+        finder.SetMinFrequency(0.);
+        finder.SetMaxFrequency(0.5 * sampleRate);
+        finder.SetFrequencyAcceptance(3. * binWidth);
+        finder.SetTimeGapTolerance(1.5 * sliceLength);
+        finder.SetInitialSlope(slope);
+        finder.SetMinPoints(3);
+
+        mt19937 generator(2026);
+        uniform_int_distribution< unsigned > noiseBinDist(1, nBins - 2);
+
+        KTSliceHeader header;
+        header.SetNComponents(1);
+        header.SetSampleRate(sampleRate);
+        header.SetRawSliceSize(sliceSize);
+        header.SetSliceSize(sliceSize);
+        header.SetSliceLength(sliceLength);
+
+        double activeLineSum = 0.;
+        chrono::duration< double > elapsed(0.);
+
+        for (unsigned iSlice = 0; iSlice < nSlices; ++iSlice)
+        {
+            double time = double(iSlice) * sliceLength;
+            header.SetTimeInRun(time);
+            header.SetTimeInAcq(time);
+            header.SetSliceNumber(iSlice);
+
+            // the points are collected in a buffer and added in bin order
+            KTDiscriminatedPoints1DData::PointBuffer buffer;
+            for (unsigned iTrack = 0; iTrack < nTracks; ++iTrack)
+            {
+                unsigned phase = (iSlice + iTrack) % trackPeriod;
+                if (phase >= trackOnSlices) continue;
+                // each track segment starts at its own base frequency and drifts by the slope
+                double frequency = double(trackSpacing * iTrack + trackSpacing / 2) * binWidth + slope * double(phase) * sliceLength;
+                unsigned bin = unsigned(frequency / binWidth);
+                buffer.push_back(make_pair(bin, KTDiscriminatedPoints1DData::Point(frequency, 20. + double(iTrack % 7), 5., 1., 1., 20.)));
+            }
+            for (unsigned iNoise = 0; iNoise < nTracks; ++iNoise)
+            {
+                unsigned bin = noiseBinDist(generator);
+                buffer.push_back(make_pair(bin, KTDiscriminatedPoints1DData::Point((double(bin) + 0.5) * binWidth, 6., 5., 1., 1., 6.)));
+            }
+            stable_sort(buffer.begin(), buffer.end(), CompareBins);
+
+            KTDiscriminatedPoints1DData points;
+            points.SetNComponents(1);
+            points.SetNBins(nBins);
+            points.SetBinWidth(binWidth);
+            points.AddPoints(buffer);
+
+            activeLineSum += double(finder.GetNActiveLines());
+
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            finder.CollectDiscrimPointsFromSlice(header, points);
+            elapsed += chrono::steady_clock::now() - start;
+        }
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        finder.AcquisitionIsOver();
+        elapsed += chrono::steady_clock::now() - start;
+
+        KTINFO(proflog, "Tracks: " << nTracks << ";  active lines: " << activeLineSum / double(nSlices)
+                << ";  time per slice: " << 1.e6 * elapsed.count() / double(nSlices) << " us"
+                << ";  candidates: " << finder.GetCandidates().size());
+    }
+
+    return 0;
+}
@@ -0,0 +1,364 @@
+/*
+ * TestAmplitudeDistribution.cc
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ *
+ *  Checks the flat-storage amplitude distributions (KTAmplitudeDistribution) and the threaded filling in KTAmplitudeDistributor
+ *  against a reference that keeps each frequency bin's values separately and histograms them one at a time.
+ *
+ *  - Direct path: values are added to a range of frequency bins with AddToDists; about an eighth of them are outside
+ *    of the distribution range, so they have to be clamped to the first or last bin.
+ *  - Buffered path: values are buffered with AddToBuffer for a range of frequency bins, and the distributions are created
+ *    with CreateDistributionsFromBuffer, which compacts the rows from the buffer stride to the distribution stride in place.
+ *    Buffer sizes smaller than, equal to, and larger than the number of distribution bins are tested, as is a partly-filled buffer.
+ *    Each distribution's range has to be that of its buffered values, and the frequency bins outside of the range have to stay empty.
+ *    More values are then added directly.
+ *  - Threaded fill: KTAmplitudeDistributor fills the distributions from polar spectra with 1 thread and with several threads,
+ *    with and without the buffer; the results have to match the reference exactly.
+ *  - InitializeADistribution has to refuse a number of bins that differs from that of the other distributions.
+ *
+ *  Usage: TestAmplitudeDistribution
+ */
+
+#include "KTAmplitudeDistribution.hh"
+#include "KTAmplitudeDistributor.hh"
+#include "KTFrequencySpectrumDataPolar.hh"
+#include "KTFrequencySpectrumPolar.hh"
+#include "KTLogger.hh"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+using namespace Katydid;
+
+KTLOGGER(testlog, "TestAmplitudeDistribution");
+
+namespace Katydid
+{
+    // Keeps the distributions emitted by the distributor
+    class DistributionCollector : public Nymph::KTProcessor
+    {
+        public:
+            DistributionCollector() :
+                    Nymph::KTProcessor(),
+                    fData()
+            {
+                this->RegisterSlot("collect", this, &DistributionCollector::Collect);
+            }
+            virtual ~DistributionCollector() {}
+
+            bool Configure(const scarab::param_node*)
+            {
+                return true;
+            }
+
+            void Collect(Nymph::KTDataPtr dataPtr)
+            {
+                fData = dataPtr;
+                return;
+            }
+
+            Nymph::KTDataPtr fData;
+    };
+}
+
+const unsigned sNComponents = 2;
+const unsigned sNDistBins = 37;
+
+// Reference histograms: each frequency bin's values are kept and histogrammed separately
+struct Reference
+{
+    vector< vector< double > > fMin; // [component][freq bin]
+    vector< vector< double > > fMax;
+    vector< vector< vector< double > > > fCounts; // [component][freq bin][dist bin]
+
+    Reference(unsigned nFreqBins, double distMin, double distMax) :
+            fMin(sNComponents, vector< double >(nFreqBins, distMin)),
+            fMax(sNComponents, vector< double >(nFreqBins, distMax)),
+            fCounts(sNComponents, vector< vector< double > >(nFreqBins, vector< double >(sNDistBins, 0.)))
+    {}
+
+    // Values below the range go in the first bin, and values at or above the end of the range go in the last bin
+    void Add(double value, unsigned freqBin, unsigned component, double weight = 1.)
+    {
+        double min = fMin[component][freqBin];
+        double max = fMax[component][freqBin];
+        double invBinWidth = max > min ? double(sNDistBins) / (max - min) : 0.;
+        double pos = (value - min) * invBinWidth;
+        unsigned distBin = pos <= 0. ? 0 : pos >= double(sNDistBins - 1) ? sNDistBins - 1 : unsigned(pos);
+        fCounts[component][freqBin][distBin] += weight;
+        return;
+    }
+
+    // Sets the range of a frequency bin from its values, and histograms them
+    void CreateFromValues(const vector< double >& values, unsigned freqBin, unsigned component)
+    {
+        fMin[component][freqBin] = *min_element(values.begin(), values.end());
+        fMax[component][freqBin] = *max_element(values.begin(), values.end());
+        for (unsigned iValue = 0; iValue < values.size(); ++iValue)
+        {
+            Add(values[iValue], freqBin, component);
+        }
+        return;
+    }
+};
+
+// Returns the number of frequency bins whose distributions differ from the reference
+unsigned Compare(const KTAmplitudeDistribution& dists, const Reference& reference)
+{
+    unsigned nBad = 0;
+    unsigned nFreqBins = reference.fCounts[0].size();
+    if (dists.GetNComponents() != sNComponents || dists.GetNFreqBins() != nFreqBins || dists.GetNDistBins() != sNDistBins)
+    {
+        KTERROR(testlog, "The distributions have " << dists.GetNComponents() << " components, " << dists.GetNFreqBins() << " frequency bins, and " <<
+                dists.GetNDistBins() << " distribution bins; expected " << sNComponents << ", " << nFreqBins << ", and " << sNDistBins);
+        return 1;
+    }
+    for (unsigned iComponent = 0; iComponent < sNComponents; ++iComponent)
+    {
+        for (unsigned iFreqBin = 0; iFreqBin < nFreqBins; ++iFreqBin)
+        {
+            KTAmplitudeDistribution::Distribution dist = dists.GetDistribution(iFreqBin, iComponent);
+            bool isBad = dist.size() != sNDistBins || dist.GetRangeMin() != reference.fMin[iComponent][iFreqBin] || dist.GetRangeMax() != reference.fMax[iComponent][iFreqBin];
+            for (unsigned iDistBin = 0; iDistBin < sNDistBins && ! isBad; ++iDistBin)
+            {
+                isBad = dist(iDistBin) != reference.fCounts[iComponent][iFreqBin][iDistBin];
+            }
+            if (isBad)
+            {
+                if (nBad == 0)
+                {
+                    KTERROR(testlog, "Component " << iComponent << ", frequency bin " << iFreqBin << " differs from the reference; range: [" << dist.GetRangeMin() << ", " <<
+                            dist.GetRangeMax() << ") (expected [" << reference.fMin[iComponent][iFreqBin] << ", " << reference.fMax[iComponent][iFreqBin] << "))");
+                }
+                ++nBad;
+            }
+        }
+    }
+    return nBad;
+}
+
+unsigned TestDirect(mt19937& generator)
+{
+    const unsigned nFreqBins = 3000, firstBin = 100, nBins = 2000;
+    const double distMin = 0., distMax = 3.;
+    uniform_real_distribution< double > uniform(-0.5, 3.5);
+
+    KTAmplitudeDistribution dists;
+    dists.InitializeNew(sNComponents, nFreqBins, sNDistBins, distMin, distMax);
+    Reference reference(nFreqBins, distMin, distMax);
+
+    vector< double > values(nBins);
+    for (unsigned iSlice = 0; iSlice < 50; ++iSlice)
+    {
+        double weight = iSlice % 2 == 0 ? 1. : 0.5;
+        for (unsigned iComponent = 0; iComponent < sNComponents; ++iComponent)
+        {
+            for (unsigned iValue = 0; iValue < nBins; ++iValue) values[iValue] = uniform(generator);
+            // the edges of the range, and values far outside of it
+            values[0] = distMin;
+            values[1] = distMax;
+            values[2] = -1.e6;
+            values[3] = 1.e6;
+            dists.AddToDists(values.data(), firstBin, nBins, iComponent, weight);
+            for (unsigned iValue = 0; iValue < nBins; ++iValue) reference.Add(values[iValue], firstBin + iValue, iComponent, weight);
+        }
+    }
+
+    unsigned nBad = Compare(dists, reference);
+    KTINFO(testlog, "Direct fill: " << nBad << " frequency bins differ from the reference");
+    return nBad;
+}
+
+unsigned TestBuffered(mt19937& generator, unsigned bufferSize, unsigned nEntries)
+{
+    const unsigned nFreqBins = 3000, firstBin = 5, nBins = 2900;
+    uniform_real_distribution< double > uniform(-0.5, 3.5);
+
+    KTAmplitudeDistribution dists;
+    dists.InitializeBuffer(sNComponents, nFreqBins, sNDistBins, 0., 1., bufferSize);
+    Reference reference(nFreqBins, 0., 1.);
+
+    vector< vector< vector< double > > > buffered(sNComponents, vector< vector< double > >(nBins));
+    vector< double > values(nBins);
+    for (unsigned iEntry = 0; iEntry < nEntries; ++iEntry)
+    {
+        for (unsigned iComponent = 0; iComponent < sNComponents; ++iComponent)
+        {
+            for (unsigned iValue = 0; iValue < nBins; ++iValue)
+            {
+                values[iValue] = uniform(generator);
+                buffered[iComponent][iValue].push_back(values[iValue]);
+            }
+            dists.AddToBuffer(values.data(), firstBin, nBins, iEntry, iComponent);
+        }
+    }
+
+    if (! dists.CreateDistributionsFromBuffer(nEntries, firstBin, nBins))
+    {
+        KTERROR(testlog, "Unable to create the distributions from the buffer");
+        return 1;
+    }
+    for (unsigned iComponent = 0; iComponent < sNComponents; ++iComponent)
+    {
+        for (unsigned iValue = 0; iValue < nBins; ++iValue) reference.CreateFromValues(buffered[iComponent][iValue], firstBin + iValue, iComponent);
+    }
+
+    unsigned nBad = Compare(dists, reference);
+
+    // more values, which now go straight to the distributions; some are outside of the ranges set from the buffer
+    for (unsigned iSlice = 0; iSlice < 20; ++iSlice)
+    {
+        for (unsigned iComponent = 0; iComponent < sNComponents; ++iComponent)
+        {
+            for (unsigned iValue = 0; iValue < nBins; ++iValue) values[iValue] = uniform(generator) * 1.2;
+            dists.AddToDists(values.data(), firstBin, nBins, iComponent);
+            for (unsigned iValue = 0; iValue < nBins; ++iValue) reference.Add(values[iValue], firstBin + iValue, iComponent);
+        }
+    }
+
+    nBad += Compare(dists, reference);
+    KTINFO(testlog, "Buffer size " << bufferSize << ", " << nEntries << " entries: " << nBad << " frequency bins differ from the reference");
+    return nBad;
+}
+
+unsigned TestDistributor(mt19937& generator, bool useBuffer)
+{
+    const unsigned nFreqBins = 20000, minBin = 10, maxBin = 19990;
+    const unsigned nSlices = 20, bufferSize = 8;
+    const double distMin = 0., distMax = 2.;
+    uniform_real_distribution< double > uniform(-1., 1.);
+
+    // the same spectra are given to each distributor
+    vector< Nymph::KTDataPtr > slices(nSlices);
+    for (unsigned iSlice = 0; iSlice < nSlices; ++iSlice)
+    {
+        slices[iSlice].reset(new Nymph::KTData());
+        KTFrequencySpectrumDataPolar& fsData = slices[iSlice]->Of< KTFrequencySpectrumDataPolar >();
+        fsData.SetNComponents(sNComponents);
+        for (unsigned iComponent = 0; iComponent < sNComponents; ++iComponent)
+        {
+            KTFrequencySpectrumPolar* spectrum = new KTFrequencySpectrumPolar(nFreqBins, 0., 100.e6);
+            for (unsigned iBin = 0; iBin < nFreqBins; ++iBin) spectrum->SetRect(iBin, uniform(generator), uniform(generator));
+            fsData.SetSpectrum(spectrum, iComponent);
+        }
+    }
+
+    // the distributions only cover [minBin, maxBin]; the other frequency bins keep the default range and stay empty
+    Reference reference(nFreqBins, distMin, distMax);
+    for (unsigned iComponent = 0; iComponent < sNComponents; ++iComponent)
+    {
+        for (unsigned iBin = minBin; iBin <= maxBin; ++iBin)
+        {
+            vector< double > magnitudes(nSlices);
+            for (unsigned iSlice = 0; iSlice < nSlices; ++iSlice)
+            {
+                magnitudes[iSlice] = slices[iSlice]->Of< KTFrequencySpectrumDataPolar >().GetSpectrumPolar(iComponent)->GetAbs(iBin);
+            }
+            if (useBuffer)
+            {
+                reference.CreateFromValues(vector< double >(magnitudes.begin(), magnitudes.begin() + bufferSize), iBin, iComponent);
+                for (unsigned iSlice = bufferSize; iSlice < nSlices; ++iSlice) reference.Add(magnitudes[iSlice], iBin, iComponent);
+            }
+            else
+            {
+                for (unsigned iSlice = 0; iSlice < nSlices; ++iSlice) reference.Add(magnitudes[iSlice], iBin, iComponent);
+            }
+        }
+    }
+
+    vector< unsigned > threadCounts(1, 1);
+#ifdef USE_OPENMP
+    unsigned maxThreads = omp_get_max_threads();
+    threadCounts.push_back(2);
+    threadCounts.push_back(3);
+    threadCounts.push_back(max(maxThreads, 4u));
+#endif
+
+    unsigned nBad = 0;
+    for (unsigned iCount = 0; iCount < threadCounts.size(); ++iCount)
+    {
+        KTAmplitudeDistributor distributor;
+        distributor.SetMinBin(minBin);
+        distributor.SetMaxBin(maxBin);
+        distributor.SetDistNBins(sNDistBins);
+        distributor.SetUseBuffer(useBuffer);
+        distributor.SetBufferSize(bufferSize);
+        distributor.SetDistMin(distMin);
+        distributor.SetDistMax(distMax);
+        distributor.SetNThreads(threadCounts[iCount]);
+
+        DistributionCollector collector;
+        distributor.ConnectASlot("amp-dist", &collector, "collect");
+
+        for (unsigned iSlice = 0; iSlice < nSlices; ++iSlice)
+        {
+            if (! distributor.AddValues(slices[iSlice]->Of< KTFrequencySpectrumDataPolar >()))
+            {
+                KTERROR(testlog, "Unable to add slice " << iSlice);
+                return nBad + 1;
+            }
+        }
+        distributor.FinishAmpDist();
+
+        if (! collector.fData)
+        {
+            KTERROR(testlog, "No distributions were emitted");
+            ++nBad;
+            continue;
+        }
+        unsigned nDiff = Compare(collector.fData->Of< KTAmplitudeDistribution >(), reference);
+        KTINFO(testlog, "Distributor " << (useBuffer ? "with" : "without") << " the buffer, " << threadCounts[iCount] << " thread(s): " <<
+                nDiff << " frequency bins differ from the reference");
+        if (nDiff != 0) ++nBad;
+    }
+    return nBad;
+}
+
+unsigned TestBinCount()
+{
+    KTAmplitudeDistribution dists;
+    dists.InitializeNull(sNComponents, 4);
+    if (! dists.InitializeADistribution(0, 2, sNDistBins, 1., 2.) || ! dists.InitializeADistribution(1, 3, sNDistBins, 0., 5.))
+    {
+        KTERROR(testlog, "Unable to initialize distributions with the same number of bins");
+        return 1;
+    }
+    if (dists.InitializeADistribution(0, 1, sNDistBins + 1, 1., 2.))
+    {
+        KTERROR(testlog, "A distribution with a different number of bins was accepted");
+        return 1;
+    }
+    KTINFO(testlog, "A distribution with a different number of bins was refused");
+    return 0;
+}
+
+int main()
+{
+    mt19937 generator(20130430);
+
+    unsigned nBad = 0;
+    nBad += TestDirect(generator);
+    nBad += TestBuffered(generator, 10, 10);
+    nBad += TestBuffered(generator, sNDistBins, sNDistBins);
+    nBad += TestBuffered(generator, 200, 150);
+    nBad += TestDistributor(generator, false);
+    nBad += TestDistributor(generator, true);
+    nBad += TestBinCount();
+
+    if (nBad != 0)
+    {
+        KTERROR(testlog, nBad << " problems found in the amplitude distributions");
+        return -1;
+    }
+
+    KTINFO(testlog, "The amplitude distributions match the reference");
+    return 0;
+}
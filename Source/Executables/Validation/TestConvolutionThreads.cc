@@ -0,0 +1,254 @@
+/*
+ * TestConvolutionThreads.cc
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ *
+ *  Checks that the parallel overlap-save convolution (KTConvolution1D) gives exactly the same spectra with 1 thread
+ *  as with several threads, and that the 1-thread result matches a direct convolution.
+ *
+ *  Three power spectra, three FFTW frequency spectra and three polar frequency spectra are convolved in batches,
+ *  as the components of a data object are.  The number of bins is not a multiple of the step size,
+ *  so the short block at the end of each spectrum is included.  Both convolution and cross-correlation are checked
+ *  for thread independence; the direct-convolution check is done for convolution.
+ *  Without OpenMP, only the comparison with the direct convolution is done.
+ *
+ *  The kernel is written to a file in the working directory, which is removed at the end.
+ *
+ *  Usage: TestConvolutionThreads
+ */
+
+#include "KTConvolution.hh"
+#include "KTFrequencySpectrumFFTW.hh"
+#include "KTFrequencySpectrumPolar.hh"
+#include "KTLogger.hh"
+#include "KTPowerSpectrum.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+using namespace Katydid;
+
+KTLOGGER(testlog, "TestConvolutionThreads");
+
+const unsigned sNSpectra = 3;
+const unsigned sNBins = 5000;
+const unsigned sKernelSize = 51;
+const unsigned sBlockSize = 256;
+
+struct BatchResults
+{
+    vector< KTPowerSpectrum* > fPS;
+    vector< KTFrequencySpectrumFFTW* > fFSFFTW;
+    vector< KTFrequencySpectrumPolar* > fFSPolar;
+
+    ~BatchResults()
+    {
+        for (unsigned iSpectrum = 0; iSpectrum < fPS.size(); ++iSpectrum) delete fPS[iSpectrum];
+        for (unsigned iSpectrum = 0; iSpectrum < fFSFFTW.size(); ++iSpectrum) delete fFSFFTW[iSpectrum];
+        for (unsigned iSpectrum = 0; iSpectrum < fFSPolar.size(); ++iSpectrum) delete fFSPolar[iSpectrum];
+    }
+};
+
+struct Inputs
+{
+    vector< const KTPowerSpectrum* > fPS;
+    vector< const KTFrequencySpectrumFFTW* > fFSFFTW;
+    vector< const KTFrequencySpectrumPolar* > fFSPolar;
+};
+
+bool Convolve(const string& kernelFile, const string& transformType, const Inputs& inputs, BatchResults& results)
+{
+    KTConvolution1D conv;
+    conv.SetKernel(kernelFile);
+    conv.SetBlockSize(sBlockSize);
+    conv.SetNormalizeKernel(true);
+    conv.SetTransformType(transformType);
+    if (! conv.FinishSetup())
+    {
+        KTERROR(testlog, "Unable to set up the convolution");
+        return false;
+    }
+
+    int block = conv.GetBlockSize();
+    int overlap = sKernelSize - 1;
+    int step = block - overlap;
+
+    return conv.ConvolveBatch(inputs.fPS, results.fPS, block, step, overlap) &&
+            conv.ConvolveBatch(inputs.fFSFFTW, results.fFSFFTW, block, step, overlap) &&
+            conv.ConvolveBatch(inputs.fFSPolar, results.fFSPolar, block, step, overlap);
+}
+
+// Returns the number of bins that differ between the two sets of results
+unsigned CompareResults(const BatchResults& lhs, const BatchResults& rhs)
+{
+    unsigned nDiff = 0;
+    for (unsigned iSpectrum = 0; iSpectrum < sNSpectra; ++iSpectrum)
+    {
+        for (unsigned iBin = 0; iBin < sNBins; ++iBin)
+        {
+            if ((*lhs.fPS[iSpectrum])(iBin) != (*rhs.fPS[iSpectrum])(iBin)) ++nDiff;
+            if ((*lhs.fFSFFTW[iSpectrum])(iBin)[0] != (*rhs.fFSFFTW[iSpectrum])(iBin)[0] ||
+                    (*lhs.fFSFFTW[iSpectrum])(iBin)[1] != (*rhs.fFSFFTW[iSpectrum])(iBin)[1]) ++nDiff;
+            if (lhs.fFSPolar[iSpectrum]->GetReal(iBin) != rhs.fFSPolar[iSpectrum]->GetReal(iBin) ||
+                    lhs.fFSPolar[iSpectrum]->GetImag(iBin) != rhs.fFSPolar[iSpectrum]->GetImag(iBin)) ++nDiff;
+        }
+    }
+    return nDiff;
+}
+
+// Direct convolution with the normalized kernel: out[i] = sum_j kernel[j] * in[i - j]
+double DirectConvolution(const vector< double >& kernel, const vector< double >& input, unsigned iBin)
+{
+    double sum = 0.;
+    for (unsigned j = 0; j < kernel.size() && j <= iBin; ++j) sum += kernel[j] * input[iBin - j];
+    return sum;
+}
+
+// Returns the largest difference between the results and a direct convolution of the inputs
+double CompareWithDirect(const vector< double >& kernel, const Inputs& inputs, const BatchResults& results)
+{
+    double maxDiff = 0.;
+    vector< double > psIn(sNBins), fftwReIn(sNBins), fftwImIn(sNBins), polarReIn(sNBins), polarImIn(sNBins);
+    for (unsigned iSpectrum = 0; iSpectrum < sNSpectra; ++iSpectrum)
+    {
+        for (unsigned iBin = 0; iBin < sNBins; ++iBin)
+        {
+            psIn[iBin] = (*inputs.fPS[iSpectrum])(iBin);
+            fftwReIn[iBin] = (*inputs.fFSFFTW[iSpectrum])(iBin)[0];
+            fftwImIn[iBin] = (*inputs.fFSFFTW[iSpectrum])(iBin)[1];
+            polarReIn[iBin] = inputs.fFSPolar[iSpectrum]->GetReal(iBin);
+            polarImIn[iBin] = inputs.fFSPolar[iSpectrum]->GetImag(iBin);
+        }
+        for (unsigned iBin = 0; iBin < sNBins; ++iBin)
+        {
+            maxDiff = max(maxDiff, fabs((*results.fPS[iSpectrum])(iBin) - DirectConvolution(kernel, psIn, iBin)));
+            maxDiff = max(maxDiff, fabs((*results.fFSFFTW[iSpectrum])(iBin)[0] - DirectConvolution(kernel, fftwReIn, iBin)));
+            maxDiff = max(maxDiff, fabs((*results.fFSFFTW[iSpectrum])(iBin)[1] - DirectConvolution(kernel, fftwImIn, iBin)));
+            maxDiff = max(maxDiff, fabs(results.fFSPolar[iSpectrum]->GetReal(iBin) - DirectConvolution(kernel, polarReIn, iBin)));
+            maxDiff = max(maxDiff, fabs(results.fFSPolar[iSpectrum]->GetImag(iBin) - DirectConvolution(kernel, polarImIn, iBin)));
+        }
+    }
+    return maxDiff;
+}
+
+int main()
+{
+    // Gaussian kernel
+    vector< double > kernel(sKernelSize);
+    double norm = 0.;
+    for (unsigned iBin = 0; iBin < sKernelSize; ++iBin)
+    {
+        double x = (double(iBin) - 0.5 * double(sKernelSize - 1)) / 8.;
+        kernel[iBin] = exp(-0.5 * x * x);
+        norm += kernel[iBin];
+    }
+
+    string kernelFile("TestConvolutionThreads_kernel.json");
+    ofstream kernelStream(kernelFile.c_str());
+    kernelStream.precision(17);
+    kernelStream << "{\n    \"kernel\": [";
+    for (unsigned iBin = 0; iBin < sKernelSize; ++iBin)
+    {
+        kernelStream << (iBin == 0 ? "" : ", ") << kernel[iBin];
+    }
+    kernelStream << "]\n}\n";
+    kernelStream.close();
+
+    // the processor normalizes the kernel as it's read; the direct convolution uses the same normalization
+    for (unsigned iBin = 0; iBin < sKernelSize; ++iBin) kernel[iBin] = kernel[iBin] / norm;
+
+    // Random inputs
+    mt19937 generator(20170825);
+    uniform_real_distribution< double > uniform(-1., 1.);
+    Inputs inputs;
+    for (unsigned iSpectrum = 0; iSpectrum < sNSpectra; ++iSpectrum)
+    {
+        KTPowerSpectrum* ps = new KTPowerSpectrum(sNBins, 50.e6, 150.e6);
+        KTFrequencySpectrumFFTW* fsFFTW = new KTFrequencySpectrumFFTW(sNBins, 50.e6, 150.e6);
+        KTFrequencySpectrumPolar* fsPolar = new KTFrequencySpectrumPolar(sNBins, 50.e6, 150.e6);
+        for (unsigned iBin = 0; iBin < sNBins; ++iBin)
+        {
+            (*ps)(iBin) = uniform(generator) + 1.;
+            (*fsFFTW)(iBin)[0] = uniform(generator);
+            (*fsFFTW)(iBin)[1] = uniform(generator);
+            fsPolar->SetRect(iBin, uniform(generator), uniform(generator));
+        }
+        inputs.fPS.push_back(ps);
+        inputs.fFSFFTW.push_back(fsFFTW);
+        inputs.fFSPolar.push_back(fsPolar);
+    }
+
+    vector< unsigned > threadCounts(1, 1);
+#ifdef USE_OPENMP
+    unsigned maxThreads = omp_get_max_threads();
+    threadCounts.push_back(2);
+    threadCounts.push_back(3);
+    threadCounts.push_back(max(maxThreads, 4u));
+#endif
+
+    unsigned nBad = 0;
+    const string transformTypes[] = {"convolution", "cross-correlation"};
+    for (unsigned iType = 0; iType < 2; ++iType)
+    {
+        BatchResults serialResults;
+        for (unsigned iCount = 0; iCount < threadCounts.size(); ++iCount)
+        {
+#ifdef USE_OPENMP
+            omp_set_num_threads(threadCounts[iCount]);
+#endif
+            BatchResults results;
+            if (! Convolve(kernelFile, transformTypes[iType], inputs, iCount == 0 ? serialResults : results))
+            {
+                KTERROR(testlog, "The " << transformTypes[iType] << " failed with " << threadCounts[iCount] << " thread(s)");
+                ++nBad;
+                continue;
+            }
+
+            if (iCount == 0)
+            {
+                if (iType == 0)
+                {
+                    double maxDiff = CompareWithDirect(kernel, inputs, serialResults);
+                    KTINFO(testlog, "Largest difference from the direct convolution: " << maxDiff);
+                    if (maxDiff > 1.e-12) ++nBad;
+                }
+                continue;
+            }
+
+            unsigned nDiff = CompareResults(serialResults, results);
+            KTINFO(testlog, transformTypes[iType] << " with " << threadCounts[iCount] << " threads: " << nDiff << " bins differ from 1 thread");
+            if (nDiff != 0) ++nBad;
+        }
+    }
+#ifdef USE_OPENMP
+    omp_set_num_threads(maxThreads);
+#endif
+
+    for (unsigned iSpectrum = 0; iSpectrum < sNSpectra; ++iSpectrum)
+    {
+        delete inputs.fPS[iSpectrum];
+        delete inputs.fFSFFTW[iSpectrum];
+        delete inputs.fFSPolar[iSpectrum];
+    }
+    remove(kernelFile.c_str());
+
+    if (nBad != 0)
+    {
+        KTERROR(testlog, "The convolution depends on the number of threads, or differs from the direct convolution");
+        return -1;
+    }
+
+    KTINFO(testlog, "The convolution is the same for all numbers of threads");
+    return 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * TestDBSCANEventClustering.cc
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ *
+ *  Checks that DBSCAN clustering of tracks with KTTrackDistanceIndex (used by KTDBSCANEventClustering)
+ *  gives the same clusters and noise points as clustering with the full KTSymmetricDistanceMatrix.
+ *
+ *  The tracks are in normalized units (clustering radius = 1):
+ *   - events made of chains of tracks, each starting near where the previous one ended;
+ *   - isolated tracks at random times and frequencies;
+ *   - tracks that start at the same time, to check that ties are handled the same way.
+ *
+ *  Usage: ./TestDBSCANEventClustering [# of events]
+ */
+
+#include "KTDBSCAN.hh"
+#include "KTDistanceMatrix.hh"
+#include "KTLogger.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <random>
+
+using namespace Katydid;
+
+KTLOGGER(testlog, "TestDBSCANEventClustering");
+
+typedef KTSymmetricDistanceMatrix< double > DistanceMatrix;
+typedef KTTrackDistanceIndex< double > TrackIndex;
+typedef TrackIndex::Point Point;
+typedef TrackIndex::Points Points;
+
+Point MakeTrack(double startTime, double startFreq, double length, double slope)
+{
+    Point track(4);
+    track(0) = startTime;
+    track(1) = startFreq;
+    track(2) = startTime + length;
+    track(3) = startFreq + slope * length;
+    return track;
+}
+
+template< typename MatrixResults, typename IndexResults >
+bool SameResults(const MatrixResults& matResults, const IndexResults& results)
+{
+    if (matResults.fClusters.size() != results.fClusters.size())
+    {
+        KTERROR(testlog, "Number of clusters differs: " << matResults.fClusters.size() << " (matrix) vs. " << results.fClusters.size() << " (index)");
+        return false;
+    }
+    for (unsigned iCluster = 0; iCluster < matResults.fClusters.size(); ++iCluster)
+    {
+        if (matResults.fClusters[iCluster] != results.fClusters[iCluster])
+        {
+            KTERROR(testlog, "Cluster " << iCluster << " differs: " << matResults.fClusters[iCluster].size() << " (matrix) vs. " << results.fClusters[iCluster].size() << " (index) points");
+            return false;
+        }
+    }
+    if (matResults.fNoise != results.fNoise)
+    {
+        KTERROR(testlog, "Noise points differ");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned nEvents = 300;
+    if (argc > 1) nEvents = atoi(argv[1]);
+
+    std::mt19937 generator(20140804);
+    std::uniform_real_distribution< double > timeDist(0., 10. * double(nEvents));
+    std::uniform_real_distribution< double > freqDist(0., 200.);
+    std::uniform_real_distribution< double > lengthDist(0., 3.);
+    std::uniform_real_distribution< double > slopeDist(0., 2.);
+    std::uniform_real_distribution< double > jumpDist(-0.9, 0.9);
+    std::uniform_int_distribution< unsigned > nTracksDist(1, 6);
+
+    Points tracks;
+    for (unsigned iEvent = 0; iEvent < nEvents; ++iEvent)
+    {
+        double time = timeDist(generator);
+        double freq = freqDist(generator);
+        double slope = slopeDist(generator);
+        unsigned nTracks = nTracksDist(generator);
+        for (unsigned iTrack = 0; iTrack < nTracks; ++iTrack)
+        {
+            double length = lengthDist(generator);
+            tracks.push_back(MakeTrack(time, freq, length, slope));
+            // the next track starts near the end of this one
+            time += length + 0.5 * std::fabs(jumpDist(generator));
+            freq += slope * length + jumpDist(generator);
+        }
+        // sometimes add a second track starting at the same time
+        if (iEvent % 10 == 0)
+        {
+            tracks.push_back(MakeTrack(time, freq + jumpDist(generator), lengthDist(generator), slope));
+            tracks.push_back(MakeTrack(time, freq + jumpDist(generator), lengthDist(generator), slope));
+        }
+    }
+    // isolated tracks
+    for (unsigned iTrack = 0; iTrack < nEvents; ++iTrack)
+    {
+        tracks.push_back(MakeTrack(timeDist(generator), freqDist(generator), lengthDist(generator), slopeDist(generator)));
+    }
+
+    KTINFO(testlog, "Clustering " << tracks.size() << " tracks");
+
+    bool allMatch = true;
+    for (unsigned minPoints = 1; minPoints <= 3; ++minPoints)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        DistanceMatrix distMat;
+        distMat.ComputeDistances< TrackDistance< Point > >(tracks);
+        KTDBSCAN< DistanceMatrix > matDBSCAN(1., minPoints);
+        KTDBSCAN< DistanceMatrix >::DBSResults matResults;
+        matDBSCAN.DoClustering(distMat, matResults);
+
+        std::chrono::steady_clock::time_point mid = std::chrono::steady_clock::now();
+
+        TrackIndex trackIndex;
+        trackIndex.BuildIndex(tracks);
+        KTDBSCAN< TrackIndex > indexDBSCAN(1., minPoints);
+        KTDBSCAN< TrackIndex >::DBSResults indexResults;
+        indexDBSCAN.DoClustering(trackIndex, indexResults);
+
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        KTINFO(testlog, "Min points: " << minPoints << ";  clusters: " << matResults.fClusters.size()
+                << ";  matrix: " << std::chrono::duration< double >(mid - start).count() << " s"
+                << ";  index: " << std::chrono::duration< double >(end - mid).count() << " s");
+
+        if (! SameResults(matResults, indexResults))
+        {
+            KTERROR(testlog, "Index-based clustering does not match the distance matrix for min points = " << minPoints);
+            allMatch = false;
+        }
+    }
+
+    if (! allMatch) return -1;
+
+    KTINFO(testlog, "Index-based clustering matches the distance matrix");
+    return 0;
+}
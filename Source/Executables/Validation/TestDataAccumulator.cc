@@ -7,9 +7,16 @@
 
 #include "KTDataAccumulator.hh"
 #include "KTLogger.hh"
+#include "KTPowerSpectrum.hh"
+#include "KTPowerSpectrumData.hh"
 #include "KTTimeSeriesData.hh"
 #include "KTTimeSeriesReal.hh"
 
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
 #ifdef ROOT_FOUND
 #include "TFile.h"
 #include "TH1.h"
@@ -56,6 +63,53 @@ int main()
     const KTDataAccumulator::Accumulator& tsAcc = accumulator.GetAccumulator< KTTimeSeriesData >();
     KTINFO(vallog, "The TS accumulator has added " << tsAcc.GetSliceNumber() << " time series");
 
+    // Power spectra with a large offset, to check the running mean and variance against a two-pass calculation
+    const unsigned nSpectra = 200;
+    const unsigned nPSBins = 1000;
+    std::mt19937 generator(20131022);
+    std::normal_distribution< double > noise(0., 1.);
+    std::vector< std::vector< double > > values(nSpectra, std::vector< double >(nPSBins));
+
+    KTDataAccumulator psAccumulator;
+    psAccumulator.SetAccumulatorSize(nSpectra);
+    for (unsigned iSpectrum = 0; iSpectrum < nSpectra; ++iSpectrum)
+    {
+        KTPowerSpectrumData newData;
+        KTPowerSpectrum* newPS = new KTPowerSpectrum(nPSBins, 0., 1.);
+        for (unsigned iBin = 0; iBin < nPSBins; ++iBin)
+        {
+            values[iSpectrum][iBin] = 1.e8 + double(iBin) * noise(generator);
+            (*newPS)(iBin) = values[iSpectrum][iBin];
+        }
+        newData.SetSpectrum(newPS, 0);
+        psAccumulator.AddData(newData);
+    }
+
+    KTDataAccumulator::Accumulator& psAcc = psAccumulator.GetAccumulatorNonConst< KTPowerSpectrumData >();
+    psAcc.Finalize();
+    const KTPowerSpectrum* meanPS = psAcc.fData->Of< KTPowerSpectrumData >().GetSpectrum(0);
+    const KTFrequencySpectrumVariance* varPS = psAcc.fData->Of< KTPowerSpectrumVarianceData >().GetSpectrum(0);
+
+    double maxMeanDiff = 0., maxVarDiff = 0.;
+    for (unsigned iBin = 0; iBin < nPSBins; ++iBin)
+    {
+        double mean = 0.;
+        for (unsigned iSpectrum = 0; iSpectrum < nSpectra; ++iSpectrum) mean += values[iSpectrum][iBin];
+        mean /= double(nSpectra);
+        double variance = 0.;
+        for (unsigned iSpectrum = 0; iSpectrum < nSpectra; ++iSpectrum) variance += (values[iSpectrum][iBin] - mean) * (values[iSpectrum][iBin] - mean);
+        variance /= double(nSpectra);
+
+        maxMeanDiff = std::max(maxMeanDiff, std::fabs((*meanPS)(iBin) - mean) / mean);
+        maxVarDiff = std::max(maxVarDiff, std::fabs((*varPS)(iBin) - variance) / (variance + 1.));
+    }
+    KTINFO(vallog, "Largest relative differences from the two-pass mean and variance: " << maxMeanDiff << " and " << maxVarDiff);
+    if (maxMeanDiff > 1.e-12 || maxVarDiff > 1.e-6)
+    {
+        KTERROR(vallog, "The accumulated mean or variance is not correct");
+        return -1;
+    }
+
 #ifdef ROOT_FOUND
     TFile* output = new TFile("test_data_accumulator.root", "recreate");
     TH1D* tsHist = tsAcc.fData->Of< KTTimeSeriesData >().GetTimeSeries(0)->CreateHistogram("dataAcc_TS");
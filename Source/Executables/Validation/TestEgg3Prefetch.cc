@@ -0,0 +1,209 @@
+/*
+ * TestEgg3Prefetch.cc
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ *
+ *  Checks that KTEgg3Reader gives the same slices with and without record prefetching when reading across several files.
+ *
+ *  Two egg files are written, each with one acquisition of 16-bit samples; each sample's value encodes its file and its position
+ *  in the file.  The files are then read with no prefetching (plain and with the record history), and with prefetch queues of
+ *  1 and 4 records, in which case the prefetch thread opens the second file itself.
+ *  The slices are compared with the expected ones: in each file, slices start at the beginning of the file and advance by the
+ *  stride, as long as they fit in the file; a slice that would cross into the next file starts over at its beginning.
+ *  Both non-overlapping slices and overlapping slices (stride < slice size) are tested.
+ *
+ *  Usage: TestEgg3Prefetch [file prefix (default: TestEgg3Prefetch)]
+ */
+
+#include "KTConstants.hh"
+#include "KTEgg3Reader.hh"
+#include "KTLogger.hh"
+#include "KTRawTimeSeries.hh"
+#include "KTRawTimeSeriesData.hh"
+#include "KTSliceHeader.hh"
+
+#include "M3Monarch.hh"
+#include "M3Exception.hh"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace Katydid;
+
+KTLOGGER(testlog, "TestEgg3Prefetch");
+
+const unsigned sRecordSize = 64;
+const unsigned sNRecordsPerFile = 20;
+const unsigned sSampleSize = 2; // bytes
+
+uint16_t SampleValue(unsigned iFile, unsigned iSampleInFile)
+{
+    return uint16_t(iFile * 4096 + iSampleInFile);
+}
+
+bool WriteEgg(const string& filename, unsigned iFile)
+{
+    try
+    {
+        monarch3::Monarch3* egg = monarch3::Monarch3::OpenForWriting(filename);
+
+        monarch3::M3Header* header = egg->GetHeader();
+        header->SetFilename(filename);
+        header->SetRunDuration(sNRecordsPerFile * sRecordSize / 100);
+        header->SetTimestamp("2026-10-17T00:00:00Z");
+        header->SetDescription("Written by TestEgg3Prefetch");
+
+        unsigned streamNum = header->AddStream("test digitizer", 100, sRecordSize, 1, sSampleSize, sDigitizedUS, 16, sBitsAlignedLeft);
+
+        egg->WriteHeader();
+
+        monarch3::M3Stream* stream = egg->GetStream(streamNum);
+        monarch3::byte_type* data = stream->GetStreamRecord()->GetData();
+        for (unsigned iRecord = 0; iRecord < sNRecordsPerFile; ++iRecord)
+        {
+            for (unsigned iSample = 0; iSample < sRecordSize; ++iSample)
+            {
+                uint16_t value = SampleValue(iFile, iRecord * sRecordSize + iSample);
+                memcpy(data + iSample * sSampleSize, &value, sSampleSize);
+            }
+            if (! stream->WriteRecord(iRecord == 0))
+            {
+                KTERROR(testlog, "Unable to write record " << iRecord << " to <" << filename << ">");
+                return false;
+            }
+        }
+
+        egg->FinishWriting();
+        delete egg;
+    }
+    catch (monarch3::M3Exception& e)
+    {
+        KTERROR(testlog, "Unable to write <" << filename << ">: " << e.what());
+        return false;
+    }
+    return true;
+}
+
+// Reads all of the slices in the files; each slice is stored as its sample values
+bool ReadSlices(const KTEggReader::path_vec& filenames, unsigned sliceSize, unsigned stride, unsigned prefetchRecords, vector< vector< uint16_t > >& slices)
+{
+    KTEgg3Reader reader;
+    reader.SetSliceSize(sliceSize);
+    reader.SetStride(stride);
+    reader.SetPrefetchRecords(prefetchRecords);
+
+    if (! reader.BreakEgg(filenames))
+    {
+        KTERROR(testlog, "Egg files were not opened");
+        return false;
+    }
+
+    slices.clear();
+    while (true)
+    {
+        Nymph::KTDataPtr data = reader.HatchNextSlice();
+        if (! data) break;
+
+        const KTRawTimeSeries* ts = data->Of< KTRawTimeSeriesData >().GetTimeSeries(0);
+        if (ts == NULL || ts->GetNBins() != sliceSize)
+        {
+            KTERROR(testlog, "Slice " << slices.size() << " doesn't have the expected size");
+            return false;
+        }
+        slices.push_back(vector< uint16_t >(sliceSize));
+        memcpy(slices.back().data(), ts->GetStorage(), sliceSize * sSampleSize);
+    }
+
+    KTINFO(testlog, "Read " << slices.size() << " slices; records from the history: " << reader.GetNRecordCacheHits() <<
+            "; records from the file or prefetch queue: " << reader.GetNRecordCacheMisses());
+
+    reader.CloseEgg();
+    return true;
+}
+
+unsigned CompareSlices(const vector< vector< uint16_t > >& slices, const vector< vector< uint16_t > >& expected)
+{
+    if (slices.size() != expected.size())
+    {
+        KTERROR(testlog, "Read " << slices.size() << " slices; expected " << expected.size());
+        return 1;
+    }
+    unsigned nBad = 0;
+    for (unsigned iSlice = 0; iSlice < slices.size(); ++iSlice)
+    {
+        if (slices[iSlice] != expected[iSlice])
+        {
+            KTERROR(testlog, "Slice " << iSlice << " differs: starts with " << slices[iSlice][0] << "; expected " << expected[iSlice][0]);
+            ++nBad;
+        }
+    }
+    return nBad;
+}
+
+int main(int argc, char** argv)
+{
+    string prefix = argc > 1 ? argv[1] : "TestEgg3Prefetch";
+
+    const unsigned nFiles = 2;
+    KTEggReader::path_vec filenames;
+    for (unsigned iFile = 0; iFile < nFiles; ++iFile)
+    {
+        string filename = prefix + "_" + to_string(iFile) + ".egg";
+        if (! WriteEgg(filename, iFile)) return -1;
+        filenames.push_back(filename);
+    }
+
+    const unsigned sliceSize = 48;
+    const unsigned strides[] = {48, 32};
+    const unsigned prefetchRecords[] = {0, 1, 4};
+
+    unsigned nBad = 0;
+    for (unsigned iStride = 0; iStride < 2; ++iStride)
+    {
+        unsigned stride = strides[iStride];
+
+        vector< vector< uint16_t > > expected;
+        unsigned nSamplesInFile = sNRecordsPerFile * sRecordSize;
+        for (unsigned iFile = 0; iFile < nFiles; ++iFile)
+        {
+            for (unsigned start = 0; start + sliceSize <= nSamplesInFile; start += stride)
+            {
+                expected.push_back(vector< uint16_t >(sliceSize));
+                for (unsigned iSample = 0; iSample < sliceSize; ++iSample)
+                {
+                    expected.back()[iSample] = SampleValue(iFile, start + iSample);
+                }
+            }
+        }
+
+        for (unsigned iPrefetch = 0; iPrefetch < 3; ++iPrefetch)
+        {
+            KTINFO(testlog, "Slice size " << sliceSize << ", stride " << stride << ", prefetching " << prefetchRecords[iPrefetch] << " records");
+            vector< vector< uint16_t > > slices;
+            if (! ReadSlices(filenames, sliceSize, stride, prefetchRecords[iPrefetch], slices))
+            {
+                ++nBad;
+                continue;
+            }
+            nBad += CompareSlices(slices, expected);
+        }
+    }
+
+    for (unsigned iFile = 0; iFile < nFiles; ++iFile)
+    {
+        remove(filenames[iFile].native().c_str());
+    }
+
+    if (nBad != 0)
+    {
+        KTERROR(testlog, nBad << " problems found while reading across files");
+        return -1;
+    }
+
+    KTINFO(testlog, "The slices are the same with and without prefetching");
+    return 0;
+}
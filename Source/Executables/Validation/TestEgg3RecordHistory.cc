@@ -0,0 +1,207 @@
+/*
+ * TestEgg3RecordHistory.cc
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ *
+ *  Checks that KTEgg3Reader, without prefetching, takes the records that overlapping slices share from its record history
+ *  instead of reading them from the file again, and that the slices are unchanged by it.
+ *
+ *  An egg file is written with one acquisition of 16-bit samples; each sample's value encodes its position in the file.
+ *  It's then read with several slice sizes and strides:
+ *   - stride == slice size, and overlapping slices that never start before the record where the previous one ended:
+ *     there's nothing to take from the history, so there have to be no cache hits;
+ *   - 50% and 75% overlap, and slices that span several records: the next slice steps back to records that are held
+ *     in the history, so there have to be cache hits.
+ *  In no case is a record read from the file more than once, and the slices are compared with the expected ones.
+ *
+ *  Usage: TestEgg3RecordHistory [filename (default: TestEgg3RecordHistory.egg)]
+ */
+
+#include "KTConstants.hh"
+#include "KTEgg3Reader.hh"
+#include "KTLogger.hh"
+#include "KTRawTimeSeries.hh"
+#include "KTRawTimeSeriesData.hh"
+
+#include "M3Monarch.hh"
+#include "M3Exception.hh"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace Katydid;
+
+KTLOGGER(testlog, "TestEgg3RecordHistory");
+
+const unsigned sRecordSize = 64;
+const unsigned sNRecords = 24;
+const unsigned sSampleSize = 2; // bytes
+
+uint16_t SampleValue(unsigned iSample)
+{
+    return uint16_t(iSample + 1);
+}
+
+bool WriteEgg(const string& filename)
+{
+    try
+    {
+        monarch3::Monarch3* egg = monarch3::Monarch3::OpenForWriting(filename);
+
+        monarch3::M3Header* header = egg->GetHeader();
+        header->SetFilename(filename);
+        header->SetRunDuration(sNRecords * sRecordSize / 100);
+        header->SetTimestamp("2026-10-17T00:00:00Z");
+        header->SetDescription("Written by TestEgg3RecordHistory");
+
+        unsigned streamNum = header->AddStream("test digitizer", 100, sRecordSize, 1, sSampleSize, sDigitizedUS, 16, sBitsAlignedLeft);
+
+        egg->WriteHeader();
+
+        monarch3::M3Stream* stream = egg->GetStream(streamNum);
+        monarch3::byte_type* data = stream->GetStreamRecord()->GetData();
+        for (unsigned iRecord = 0; iRecord < sNRecords; ++iRecord)
+        {
+            for (unsigned iSample = 0; iSample < sRecordSize; ++iSample)
+            {
+                uint16_t value = SampleValue(iRecord * sRecordSize + iSample);
+                memcpy(data + iSample * sSampleSize, &value, sSampleSize);
+            }
+            if (! stream->WriteRecord(iRecord == 0))
+            {
+                KTERROR(testlog, "Unable to write record " << iRecord << " to <" << filename << ">");
+                return false;
+            }
+        }
+
+        egg->FinishWriting();
+        delete egg;
+    }
+    catch (monarch3::M3Exception& e)
+    {
+        KTERROR(testlog, "Unable to write <" << filename << ">: " << e.what());
+        return false;
+    }
+    return true;
+}
+
+// Reads the slices and checks them against the expected sample values; returns the number of problems found
+unsigned CheckSlices(const string& filename, unsigned sliceSize, unsigned stride)
+{
+    KTEgg3Reader reader;
+    reader.SetSliceSize(sliceSize);
+    reader.SetStride(stride);
+    reader.SetPrefetchRecords(0);
+
+    if (! reader.BreakEgg(KTEggReader::path_vec(1, filename)))
+    {
+        KTERROR(testlog, "Egg file was not opened");
+        return 1;
+    }
+
+    unsigned nBad = 0;
+    unsigned nSlices = 0;
+    while (true)
+    {
+        Nymph::KTDataPtr data = reader.HatchNextSlice();
+        if (! data) break;
+
+        const KTRawTimeSeries* ts = data->Of< KTRawTimeSeriesData >().GetTimeSeries(0);
+        if (ts == NULL || ts->GetNBins() != sliceSize)
+        {
+            KTERROR(testlog, "Slice " << nSlices << " doesn't have the expected size");
+            ++nBad;
+            break;
+        }
+
+        vector< uint16_t > slice(sliceSize);
+        memcpy(slice.data(), ts->GetStorage(), sliceSize * sSampleSize);
+        unsigned start = nSlices * stride;
+        for (unsigned iSample = 0; iSample < sliceSize; ++iSample)
+        {
+            if (slice[iSample] != SampleValue(start + iSample))
+            {
+                KTERROR(testlog, "Slice " << nSlices << " differs at sample " << iSample << ": " << slice[iSample] << "; expected " << SampleValue(start + iSample));
+                ++nBad;
+                break;
+            }
+        }
+        ++nSlices;
+    }
+
+    unsigned nExpectedSlices = (sNRecords * sRecordSize - sliceSize) / stride + 1;
+    if (nSlices != nExpectedSlices)
+    {
+        KTERROR(testlog, "Read " << nSlices << " slices; expected " << nExpectedSlices);
+        ++nBad;
+    }
+
+    uint64_t nHits = reader.GetNRecordCacheHits();
+    uint64_t nMisses = reader.GetNRecordCacheMisses();
+    KTINFO(testlog, "Read " << nSlices << " slices; records from the history: " << nHits << "; records from the file: " << nMisses);
+
+    // a slice that starts in a record before the one where the previous slice ended has to step back to it
+    bool stepsBack = false;
+    for (unsigned iSlice = 1; iSlice < nExpectedSlices; ++iSlice)
+    {
+        unsigned lastRecordOfPrevious = ((iSlice - 1) * stride + sliceSize - 1) / sRecordSize;
+        if ((iSlice * stride) / sRecordSize < lastRecordOfPrevious) stepsBack = true;
+    }
+
+    if (! stepsBack)
+    {
+        if (nHits != 0)
+        {
+            KTERROR(testlog, "Slices never step back to an earlier record, but " << nHits << " records were taken from the history");
+            ++nBad;
+        }
+    }
+    else
+    {
+        if (nHits == 0)
+        {
+            KTERROR(testlog, "Slices step back to earlier records, but no records were taken from the history");
+            ++nBad;
+        }
+    }
+    if (nMisses > sNRecords)
+    {
+        KTERROR(testlog, nMisses << " records were read from a file with " << sNRecords << " records; some were read more than once");
+        ++nBad;
+    }
+
+    reader.CloseEgg();
+    return nBad;
+}
+
+int main(int argc, char** argv)
+{
+    string filename = argc > 1 ? argv[1] : "TestEgg3RecordHistory.egg";
+    if (! WriteEgg(filename)) return -1;
+
+    // slice size, stride
+    const unsigned cases[][2] = {{48, 48}, {48, 24}, {48, 12}, {64, 32}, {160, 40}, {160, 16}};
+    const unsigned nCases = sizeof(cases) / sizeof(cases[0]);
+
+    unsigned nBad = 0;
+    for (unsigned iCase = 0; iCase < nCases; ++iCase)
+    {
+        KTINFO(testlog, "Slice size " << cases[iCase][0] << ", stride " << cases[iCase][1]);
+        nBad += CheckSlices(filename, cases[iCase][0], cases[iCase][1]);
+    }
+
+    remove(filename.c_str());
+
+    if (nBad != 0)
+    {
+        KTERROR(testlog, nBad << " problems found while reading overlapping slices");
+        return -1;
+    }
+
+    KTINFO(testlog, "Overlapping slices are read correctly, with the shared records taken from the history");
+    return 0;
+}
@@ -0,0 +1,223 @@
+/*
+ * TestFloatChain.cc
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ *
+ *  Compares the single-precision processing chain with the double-precision chain on the slices of an egg file.
+ *  Both chains are DAC --> window + FFT + power (KTSingleChannelDAC and KTWindowedFFTPower); only the precision differs.
+ *
+ *  For each channel, the power spectra from the two chains are compared bin by bin:
+ *   - Largest difference, relative to the peak power of the double-precision spectrum (i.e. in units of the dynamic range);
+ *   - Mean relative difference, over the bins whose power is above the tolerance times the peak power
+ *     (the relative difference isn't meaningful for bins with almost no power);
+ *   - Whether the peak bins are the same.
+ *  The time taken by each chain is also reported.
+ *
+ *  The test fails if the largest peak-normalized difference is larger than the tolerance, or if the peak bins differ.
+ *
+ *  Usage: TestFloatChain filename.egg [# of slices (default: 10)] [slice size (default: 16384)] [window type (default: hann)] [tolerance (default: 1e-5)]
+ */
+
+#include "KTEgg3Reader.hh"
+#include "KTEggHeader.hh"
+#include "KTLogger.hh"
+#include "KTPowerSpectrum.hh"
+#include "KTPowerSpectrumData.hh"
+#include "KTRawTimeSeriesData.hh"
+#include "KTSingleChannelDAC.hh"
+#include "KTTimeSeriesData.hh"
+#include "KTWindowedFFTPower.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+using namespace std;
+using namespace Katydid;
+
+KTLOGGER(testlog, "TestFloatChain");
+
+// Runs one chain on a slice: converts each channel with the DACs, then does the windowed FFT and power conversion
+bool RunChain(KTRawTimeSeriesData& rawData, vector< KTSingleChannelDAC >& dacs, KTWindowedFFTPower& power, bool isReal, KTTimeSeriesData& tsData)
+{
+    unsigned nChannels = rawData.GetNComponents();
+    tsData.SetNComponents(nChannels);
+    for (unsigned iChannel = 0; iChannel < nChannels; ++iChannel)
+    {
+        KTTimeSeries* ts = dacs[iChannel].ConvertTimeSeries(rawData.GetTimeSeries(iChannel));
+        if (ts == NULL) return false;
+        tsData.SetTimeSeries(ts, iChannel);
+    }
+    return isReal ? power.TransformRealToPS(tsData) : power.TransformComplexToPS(tsData);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        KTERROR(testlog, "No filename supplied");
+        KTINFO(testlog, "Usage: TestFloatChain filename.egg [# of slices] [slice size] [window type] [tolerance]");
+        return -1;
+    }
+    string filename(argv[1]);
+    unsigned nSlices = argc > 2 ? atoi(argv[2]) : 10;
+    unsigned sliceSize = argc > 3 ? atoi(argv[3]) : 16384;
+    string windowType = argc > 4 ? argv[4] : "hann";
+    double tolerance = argc > 5 ? atof(argv[5]) : 1.e-5;
+
+    KTINFO(testlog, "Comparing the single- and double-precision chains on <" << filename << ">\n" <<
+            "\tSlices: " << nSlices << "\n" <<
+            "\tSlice size: " << sliceSize << "\n" <<
+            "\tWindow: " << windowType << "\n" <<
+            "\tTolerance: " << tolerance);
+
+    KTEgg3Reader reader;
+    reader.SetSliceSize(sliceSize);
+    reader.SetStride(sliceSize);
+
+    Nymph::KTDataPtr headerPtr = reader.BreakAnEgg(filename);
+    if (! headerPtr)
+    {
+        KTERROR(testlog, "Egg file was not opened");
+        return -1;
+    }
+    KTEggHeader& header = headerPtr->Of< KTEggHeader >();
+
+    unsigned nChannels = header.GetNChannels();
+    bool isReal = header.GetChannelHeader(0)->GetTSDataType() == KTChannelHeader::kReal;
+    KTINFO(testlog, "Egg has " << nChannels << " channel(s) of " << (isReal ? "real" : "complex") << " data");
+
+    vector< KTSingleChannelDAC > doubleDACs(nChannels);
+    vector< KTSingleChannelDAC > floatDACs(nChannels);
+    for (unsigned iChannel = 0; iChannel < nChannels; ++iChannel)
+    {
+        floatDACs[iChannel].SetSinglePrecision(true);
+        if (! doubleDACs[iChannel].InitializeWithHeader(header.GetChannelHeader(iChannel)) ||
+                ! floatDACs[iChannel].InitializeWithHeader(header.GetChannelHeader(iChannel)))
+        {
+            KTERROR(testlog, "Unable to initialize the DACs for channel " << iChannel);
+            return -1;
+        }
+    }
+
+    KTWindowedFFTPower doublePower("double-power");
+    KTWindowedFFTPower floatPower("float-power");
+    if (! doublePower.SelectWindowFunction(windowType) || ! floatPower.SelectWindowFunction(windowType))
+    {
+        KTERROR(testlog, "Unable to select the window function <" << windowType << ">");
+        return -1;
+    }
+    if (! doublePower.InitializeWithHeader(header) || ! floatPower.InitializeWithHeader(header))
+    {
+        KTERROR(testlog, "Unable to initialize the transforms");
+        return -1;
+    }
+
+    double maxPeakNormDiff = 0.;
+    double sumMeanRelDiff = 0.;
+    unsigned nComparisons = 0;
+    unsigned nPeakMismatches = 0;
+    double doubleTime = 0., floatTime = 0.;
+
+    unsigned iSlice = 0;
+    for (; iSlice < nSlices; ++iSlice)
+    {
+        Nymph::KTDataPtr data = reader.HatchNextSlice();
+        if (! data || ! data->Has< KTRawTimeSeriesData >())
+        {
+            KTINFO(testlog, "No more slices after " << iSlice);
+            break;
+        }
+        KTRawTimeSeriesData& rawData = data->Of< KTRawTimeSeriesData >();
+
+        Nymph::KTDataPtr doubleData(new Nymph::KTData());
+        Nymph::KTDataPtr floatData(new Nymph::KTData());
+        KTTimeSeriesData& doubleTSData = doubleData->Of< KTTimeSeriesData >();
+        KTTimeSeriesData& floatTSData = floatData->Of< KTTimeSeriesData >();
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        bool doubleOK = RunChain(rawData, doubleDACs, doublePower, isReal, doubleTSData);
+        doubleTime += chrono::duration< double >(chrono::steady_clock::now() - start).count();
+
+        start = chrono::steady_clock::now();
+        bool floatOK = RunChain(rawData, floatDACs, floatPower, isReal, floatTSData);
+        floatTime += chrono::duration< double >(chrono::steady_clock::now() - start).count();
+
+        if (! doubleOK || ! floatOK)
+        {
+            KTERROR(testlog, "Slice " << iSlice << " could not be processed by the " << (doubleOK ? "single" : "double") << "-precision chain");
+            return -1;
+        }
+
+        const KTPowerSpectrumData& doublePSData = doubleData->Of< KTPowerSpectrumData >();
+        const KTPowerSpectrumData& floatPSData = floatData->Of< KTPowerSpectrumData >();
+        for (unsigned iChannel = 0; iChannel < nChannels; ++iChannel)
+        {
+            const KTPowerSpectrum* doublePS = doublePSData.GetSpectrum(iChannel);
+            const KTPowerSpectrum* floatPS = floatPSData.GetSpectrum(iChannel);
+            unsigned nBins = doublePS->size();
+            if (floatPS->size() != nBins)
+            {
+                KTERROR(testlog, "Spectrum sizes differ: " << nBins << " (double) vs. " << floatPS->size() << " (float)");
+                return -1;
+            }
+
+            const double* doubleValues = doublePS->GetData();
+            const double* floatValues = floatPS->GetData();
+            unsigned doublePeakBin = max_element(doubleValues, doubleValues + nBins) - doubleValues;
+            unsigned floatPeakBin = max_element(floatValues, floatValues + nBins) - floatValues;
+            double peak = doubleValues[doublePeakBin];
+
+            double maxDiff = 0., sumRelDiff = 0.;
+            unsigned nRelBins = 0;
+            for (unsigned iBin = 0; iBin < nBins; ++iBin)
+            {
+                double diff = fabs(floatValues[iBin] - doubleValues[iBin]);
+                maxDiff = max(maxDiff, diff);
+                if (doubleValues[iBin] > tolerance * peak)
+                {
+                    sumRelDiff += diff / doubleValues[iBin];
+                    ++nRelBins;
+                }
+            }
+            double peakNormDiff = peak > 0. ? maxDiff / peak : maxDiff;
+            double meanRelDiff = nRelBins > 0 ? sumRelDiff / double(nRelBins) : 0.;
+
+            KTDEBUG(testlog, "Slice " << iSlice << ", channel " << iChannel << ": max. difference / peak = " << peakNormDiff <<
+                    "; mean relative difference = " << meanRelDiff << "; peak bins: " << doublePeakBin << " (double), " << floatPeakBin << " (float)");
+
+            maxPeakNormDiff = max(maxPeakNormDiff, peakNormDiff);
+            sumMeanRelDiff += meanRelDiff;
+            ++nComparisons;
+            if (doublePeakBin != floatPeakBin) ++nPeakMismatches;
+        }
+    }
+
+    reader.CloseEgg();
+
+    if (nComparisons == 0)
+    {
+        KTERROR(testlog, "No slices were compared");
+        return -1;
+    }
+
+    KTINFO(testlog, "Compared " << nComparisons << " spectra from " << iSlice << " slice(s):\n" <<
+            "\tLargest difference / peak power: " << maxPeakNormDiff << "\n" <<
+            "\tMean relative difference: " << sumMeanRelDiff / double(nComparisons) << "\n" <<
+            "\tPeak-bin mismatches: " << nPeakMismatches << "\n" <<
+            "\tDouble-precision chain: " << doubleTime << " s\n" <<
+            "\tSingle-precision chain: " << floatTime << " s\n" <<
+            "\tSpeedup: " << doubleTime / floatTime);
+
+    if (maxPeakNormDiff > tolerance || nPeakMismatches != 0)
+    {
+        KTERROR(testlog, "The single-precision chain does not agree with the double-precision chain within the tolerance");
+        return -1;
+    }
+
+    KTINFO(testlog, "Test passed");
+    return 0;
+}
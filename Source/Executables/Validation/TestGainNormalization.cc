@@ -8,6 +8,9 @@
  *    From the ROOT file, you can make the following plots:
  *      - hPS + hNormPS: hNormPS will have a normalized mean and variance relative to hPS.
  *    Note that hPSOnlyPS and hPSAndVarPS are explicitly exactly the same.
+ *
+ *  The normalized spectrum is also checked against the normalization formula with the splines evaluated directly,
+ *  and against a normalization that uses the pre-calculated gain variation (which shares the same gain-variation table).
  */
 
 #include "KT2ROOT.hh"
@@ -21,9 +24,14 @@
 #include "KTPowerSpectrum.hh"
 #include "KTPowerSpectrumData.hh"
 #include "KTRandom.hh"
+#include "KTSpline.hh"
 
 #include "TFile.h"
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 
 using namespace Katydid;
 
@@ -102,6 +110,53 @@ int main()
     KTNormalizedPSData& normPSData = psData.Of< KTNormalizedPSData >();
     KTPowerSpectrum* normPS = normPSData.GetSpectrum(0);
 
+    KTINFO(testlog, "Checking the normalization");
+
+    const KTSpline* spline = gvData.GetSpline(0);
+    const KTSpline* varSpline = gvData.GetVarianceSpline(0);
+    std::vector< double > splineValues(nBins), varSplineValues(nBins);
+    double splineMean = 0., varSplineMean = 0.;
+    for (unsigned iBin=0; iBin<nBins; iBin++)
+    {
+        splineValues[iBin] = spline->Evaluate(ps->GetBinCenter(iBin));
+        varSplineValues[iBin] = varSpline->Evaluate(ps->GetBinCenter(iBin));
+        splineMean += splineValues[iBin];
+        varSplineMean += varSplineValues[iBin];
+    }
+    splineMean /= (double)nBins;
+    varSplineMean /= (double)nBins;
+
+    double maxDiff = 0.;
+    for (unsigned iBin=0; iBin<nBins; iBin++)
+    {
+        double expected = splineMean + ((*ps)(iBin) - splineValues[iBin]) * sqrt(varSplineMean / varSplineValues[iBin]);
+        maxDiff = std::max(maxDiff, fabs((*normPS)(iBin) - expected) / (fabs(expected) + 1.));
+    }
+    KTINFO(testlog, "Largest relative difference from the normalization formula: " << maxDiff);
+
+    KTGainNormalization preCalcGainNorm;
+    preCalcGainNorm.SetMinFrequency( minFreq );
+    preCalcGainNorm.SetMaxFrequency( maxFreq );
+    preCalcGainNorm.SetPreCalcGainVar(gvData);
+
+    KTPowerSpectrumData preCalcPSData;
+    preCalcPSData.SetNComponents( 1 );
+    preCalcPSData.SetSpectrum( new KTPowerSpectrum(*ps), 0 );
+    preCalcGainNorm.Normalize(preCalcPSData);
+    KTPowerSpectrum* preCalcNormPS = preCalcPSData.Of< KTNormalizedPSData >().GetSpectrum(0);
+
+    bool preCalcMatches = true;
+    for (unsigned iBin=0; iBin<nBins; iBin++)
+    {
+        if ((*preCalcNormPS)(iBin) != (*normPS)(iBin)) preCalcMatches = false;
+    }
+
+    if (maxDiff > 1.e-9 || ! preCalcMatches)
+    {
+        KTERROR(testlog, "Normalized spectrum is incorrect (largest difference from the formula: " << maxDiff << "; pre-calculated gain variation matches: " << preCalcMatches << ")");
+        return -1;
+    }
+
 #ifdef ROOT_FOUND
     KTINFO(testlog, "Writing histograms to a ROOT file");
 
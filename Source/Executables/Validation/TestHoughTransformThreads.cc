@@ -0,0 +1,172 @@
+/*
+ * TestHoughTransformThreads.cc
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ *
+ *  Checks that the tiled, multithreaded Hough transform (KTHoughTransform) gives exactly the same accumulator
+ *  with 1 thread as with several threads, and that both match a plain serial loop over the votes and the theta bins.
+ *
+ *  Two inputs are used:
+ *   - a dense spectrogram with a few lines and noise, which votes at integer (bin) coordinates and uses the radius tables;
+ *   - sparse time/frequency points, which vote at real-valued coordinates.
+ *  The number of threads changes the theta tile size, so the tiling is exercised as well.
+ *  Without OpenMP, only the comparison with the serial loop is done.
+ *
+ *  Usage: TestHoughTransformThreads
+ */
+
+#include "KTDiscriminatedPoint.hh"
+#include "KTHoughTransform.hh"
+#include "KTLogger.hh"
+#include "KTPhysicalArray.hh"
+#include "KTSpectrogram.hh"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+using namespace Katydid;
+
+KTLOGGER(testlog, "TestHoughTransformThreads");
+
+const unsigned sNThetaPoints = 181;
+const unsigned sNRPoints = 300;
+
+struct Vote
+{
+    double fX;
+    double fY;
+    double fValue;
+};
+
+// Serial Hough transform: every vote is added to every theta bin, in the order of the votes
+KTPhysicalArray< 2, double >* SerialTransform(const vector< Vote >& votes, double maxR)
+{
+    KTPhysicalArray< 2, double >* transform = new KTPhysicalArray< 2, double >(0., sNThetaPoints, 0., M_PI, sNRPoints, -maxR, maxR);
+    for (unsigned iTheta = 0; iTheta < sNThetaPoints; ++iTheta)
+    {
+        double theta = transform->GetBinCenter(1, iTheta);
+        double cosTheta = cos(theta);
+        double sinTheta = sin(theta);
+        for (vector< Vote >::const_iterator vIt = votes.begin(); vIt != votes.end(); ++vIt)
+        {
+            (*transform)(iTheta, transform->FindBin(2, vIt->fX * cosTheta + vIt->fY * sinTheta)) += vIt->fValue;
+        }
+    }
+    return transform;
+}
+
+// Returns the number of cells that differ
+unsigned CompareTransforms(const KTPhysicalArray< 2, double >& lhs, const KTPhysicalArray< 2, double >& rhs)
+{
+    unsigned nDiff = 0;
+    for (unsigned iTheta = 0; iTheta < sNThetaPoints; ++iTheta)
+    {
+        for (unsigned iR = 0; iR < sNRPoints; ++iR)
+        {
+            if (lhs(iTheta, iR) != rhs(iTheta, iR)) ++nDiff;
+        }
+    }
+    return nDiff;
+}
+
+int main()
+{
+    mt19937 generator(20121205);
+    normal_distribution< double > noise(0., 1.);
+    uniform_real_distribution< double > uniform(0., 1.);
+
+    // Dense spectrogram: noise plus three lines
+    const unsigned nTimeBins = 120;
+    const unsigned nFreqBins = 200;
+    KTSpectrogram spectrogram(nTimeBins, 0., 1.e-3, nFreqBins, 50.e6, 100.e6);
+    vector< Vote > spectrogramVotes;
+    for (unsigned iTime = 0; iTime < nTimeBins; ++iTime)
+    {
+        for (unsigned iFreq = 0; iFreq < nFreqBins; ++iFreq)
+        {
+            double value = fabs(noise(generator));
+            if (iFreq == (30 + iTime) % nFreqBins || iFreq == 150 - iTime / 2 || iFreq == 90) value += 10.;
+            spectrogram(iTime, iFreq) = value;
+            // the transform skips cells at or below the minimum value (0 by default)
+            if (value > 0.)
+            {
+                Vote vote = {double(iTime), double(iFreq), value};
+                spectrogramVotes.push_back(vote);
+            }
+        }
+    }
+
+    // Sparse points along a track, plus noise points
+    const double minTime = 0.2, timeLength = 0.05;
+    const double minFreq = 60.e6, freqWidth = 2.e6;
+    KTDiscriminatedPoints points;
+    for (unsigned iPoint = 0; iPoint < 400; ++iPoint)
+    {
+        double time = minTime + timeLength * uniform(generator);
+        double freq = iPoint % 2 == 0 ? minFreq + freqWidth * (time - minTime) / timeLength : minFreq + freqWidth * uniform(generator);
+        points.insert(KTDiscriminatedPoint(time, freq, 5. + fabs(noise(generator)), time, 0., 1., 0., 0));
+    }
+    vector< Vote > pointVotes;
+    double timeScaling = 1. / timeLength;
+    double freqScaling = 1. / freqWidth;
+    for (KTDiscriminatedPoints::const_iterator pIt = points.begin(); pIt != points.end(); ++pIt)
+    {
+        Vote vote = {(pIt->fTimeInRunC - minTime) * timeScaling, (pIt->fFrequency - minFreq) * freqScaling, pIt->fAmplitude};
+        pointVotes.push_back(vote);
+    }
+
+    KTPhysicalArray< 2, double >* serialSpectrogram = SerialTransform(spectrogramVotes, sqrt(double(nTimeBins*nTimeBins + nFreqBins*nFreqBins)));
+    KTPhysicalArray< 2, double >* serialPoints = SerialTransform(pointVotes, sqrt(2.));
+
+    vector< unsigned > threadCounts(1, 1);
+#ifdef USE_OPENMP
+    unsigned maxThreads = omp_get_max_threads();
+    threadCounts.push_back(2);
+    threadCounts.push_back(3);
+    threadCounts.push_back(max(maxThreads, 4u));
+#endif
+
+    unsigned nBad = 0;
+    for (unsigned iCount = 0; iCount < threadCounts.size(); ++iCount)
+    {
+#ifdef USE_OPENMP
+        omp_set_num_threads(threadCounts[iCount]);
+#endif
+        KTHoughTransform hough;
+        hough.SetNThetaPoints(sNThetaPoints);
+        hough.SetNRPoints(sNRPoints);
+
+        KTPhysicalArray< 2, double >* spectrogramTransform = hough.TransformSpectrum(&spectrogram);
+        unsigned nDiffSpectrogram = CompareTransforms(*spectrogramTransform, *serialSpectrogram);
+        delete spectrogramTransform;
+
+        KTPhysicalArray< 2, double >* pointsTransform = hough.TransformPoints(points, minTime, timeLength, minFreq, freqWidth);
+        unsigned nDiffPoints = CompareTransforms(*pointsTransform, *serialPoints);
+        delete pointsTransform;
+
+        KTINFO(testlog, threadCounts[iCount] << " thread(s): " << nDiffSpectrogram << " spectrogram cells and " << nDiffPoints << " point cells differ from the serial transform");
+        if (nDiffSpectrogram != 0 || nDiffPoints != 0) ++nBad;
+    }
+#ifdef USE_OPENMP
+    omp_set_num_threads(maxThreads);
+#endif
+
+    delete serialSpectrogram;
+    delete serialPoints;
+
+    if (nBad != 0)
+    {
+        KTERROR(testlog, "The Hough transform depends on the number of threads, or differs from the serial transform");
+        return -1;
+    }
+
+    KTINFO(testlog, "The Hough transform is the same for all numbers of threads");
+    return 0;
+}
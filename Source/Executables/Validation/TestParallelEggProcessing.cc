@@ -0,0 +1,460 @@
+/*
+ * TestParallelEggProcessing.cc
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ *
+ *  Checks that KTEggProcessor's parallel mode gives the same output as the serial mode.
+ *
+ *  The slices come from a synthetic egg reader, so no egg file is needed.
+ *  Each slice goes through the DAC and a checksum processor:
+ *   - in the serial run, the checksum processor is connected to the egg processor's "ts" signal;
+ *   - in the parallel runs, it's the worker chain, and a different amount of work per slice makes the workers finish out of order.
+ *  In every run a recorder is connected after the checksum, and notes the slice number, checksum, time-series values and
+ *  last-data flag of each slice it receives.
+ *  The parallel runs must record the slices in order, with the same values as the serial run.
+ *  Each worker chain must receive "egg-done" once.
+ *
+ *  Finally, the checksum processor in the worker chain is made to throw on one slice;
+ *  ProcessEgg() must then throw that exception in the calling thread instead of hanging or terminating.
+ *
+ *  Usage: ./TestParallelEggProcessing [# of slices]
+ */
+
+#include "KTEggHeader.hh"
+#include "KTEggProcessor.hh"
+#include "KTEggReader.hh"
+#include "KTLogger.hh"
+#include "KTProcessor.hh"
+#include "KTRawTimeSeries.hh"
+#include "KTRawTimeSeriesData.hh"
+#include "KTSliceHeader.hh"
+#include "KTSlot.hh"
+#include "KTTimeSeries.hh"
+#include "KTTimeSeriesData.hh"
+
+#include "param.hh"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace Katydid;
+using scarab::param_array;
+using scarab::param_node;
+using scarab::param_value;
+
+KTLOGGER(testlog, "TestParallelEggProcessing");
+
+namespace Katydid
+{
+    //*****************************
+    // Synthetic slices
+    //*****************************
+
+    static const double sAcquisitionRate = 100.e6; // Hz
+
+    class KTTestSliceReader : public KTEggReader
+    {
+        public:
+            KTTestSliceReader() :
+                    KTEggReader(),
+                    fSliceSize(0),
+                    fNSlicesProcessed(0)
+            {}
+            virtual ~KTTestSliceReader() {}
+
+            bool Configure(const KTEggProcessor& eggProc)
+            {
+                fSliceSize = eggProc.GetSliceSize();
+                return true;
+            }
+
+            Nymph::KTDataPtr BreakEgg(const path_vec&)
+            {
+                fNSlicesProcessed = 0;
+
+                Nymph::KTDataPtr headerPtr(new Nymph::KTData());
+                KTEggHeader& header = headerPtr->Of< KTEggHeader >();
+                header.SetAcquisitionRate(sAcquisitionRate);
+                header.SetNChannels(1);
+
+                KTChannelHeader* chanHeader = new KTChannelHeader();
+                chanHeader->SetNumber(0);
+                chanHeader->SetRawSliceSize(fSliceSize);
+                chanHeader->SetSliceSize(fSliceSize);
+                chanHeader->SetSliceStride(fSliceSize);
+                chanHeader->SetRecordSize(fSliceSize);
+                chanHeader->SetSampleSize(1);
+                chanHeader->SetDataTypeSize(1);
+                chanHeader->SetDataFormat(sDigitizedUS);
+                chanHeader->SetBitDepth(8);
+                chanHeader->SetBitAlignment(sBitsAlignedLeft);
+                chanHeader->SetVoltageOffset(-0.25);
+                chanHeader->SetVoltageRange(0.5);
+                chanHeader->SetDACGain(0.5 / 256.);
+                chanHeader->SetTSDataType(KTChannelHeader::kReal);
+                header.SetChannelHeader(chanHeader, 0);
+
+                return headerPtr;
+            }
+
+            Nymph::KTDataPtr HatchNextSlice()
+            {
+                Nymph::KTDataPtr newData(new Nymph::KTData());
+
+                KTSliceHeader& sliceHeader = newData->Of< KTSliceHeader >().SetNComponents(1);
+                sliceHeader.SetSampleRate(sAcquisitionRate);
+                sliceHeader.SetRawSliceSize(fSliceSize);
+                sliceHeader.SetSliceSize(fSliceSize);
+                sliceHeader.CalculateBinWidthAndSliceLength();
+                sliceHeader.SetSliceNumber(fNSlicesProcessed);
+                sliceHeader.SetTimeInRun(double(fNSlicesProcessed) * sliceHeader.GetSliceLength());
+
+                // a simple, deterministic pattern that differs from slice to slice
+                KTRawTimeSeries* newTS = new KTRawTimeSeries(1, sDigitizedUS, fSliceSize, 0., sliceHeader.GetSliceLength());
+                uint64_t state = 2654435761u * (fNSlicesProcessed + 1);
+                for (unsigned iBin = 0; iBin < fSliceSize; ++iBin)
+                {
+                    state = state * 6364136223846793005u + 1442695040888963407u;
+                    newTS->SetAt((state >> 56) & 0xff, iBin);
+                }
+                newData->Of< KTRawTimeSeriesData >().SetNComponents(1).SetTimeSeries(newTS, 0);
+
+                ++fNSlicesProcessed;
+                return newData;
+            }
+
+            bool CloseEgg()
+            {
+                return true;
+            }
+
+            unsigned GetNSlicesProcessed() const
+            {
+                return fNSlicesProcessed;
+            }
+            unsigned GetNRecordsProcessed() const
+            {
+                return fNSlicesProcessed;
+            }
+            double GetIntegratedTime() const
+            {
+                return double(fNSlicesProcessed * fSliceSize) / sAcquisitionRate;
+            }
+
+        private:
+            unsigned fSliceSize;
+            unsigned fNSlicesProcessed;
+    };
+
+    KT_REGISTER_EGGREADER(KTTestSliceReader, "test-slices");
+
+
+    //*****************************
+    // Per-slice processing
+    //*****************************
+
+    class KTTestSliceChecksum : public Nymph::KTExtensibleData< KTTestSliceChecksum >
+    {
+        public:
+            KTTestSliceChecksum() :
+                    Nymph::KTExtensibleData< KTTestSliceChecksum >(),
+                    fChecksum(0.)
+            {}
+            virtual ~KTTestSliceChecksum() {}
+
+            MEMBERVARIABLE(double, Checksum);
+
+        public:
+            static const std::string sName;
+    };
+
+    const std::string KTTestSliceChecksum::sName("test-slice-checksum");
+
+    /// Stands in for the processors that would normally be in a worker chain (windowing, FFT, etc.)
+    class KTTestChecksumProcessor : public Nymph::KTProcessor
+    {
+        public:
+            KTTestChecksumProcessor(const std::string& name = "test-checksum") :
+                    KTProcessor(name),
+                    fThrowAtSlice(-1),
+                    fChecksumSignal("checksum", this),
+                    fTSSlot("ts", this, &KTTestChecksumProcessor::Checksum, &fChecksumSignal),
+                    fDoneSlot("egg-done", this, &KTTestChecksumProcessor::EggDone)
+            {}
+            virtual ~KTTestChecksumProcessor() {}
+
+            bool Configure(const scarab::param_node* node)
+            {
+                if (node == NULL) return true;
+                fThrowAtSlice = node->get_value< int >("throw-at-slice", fThrowAtSlice);
+                return true;
+            }
+
+            bool Checksum(KTTimeSeriesData& tsData)
+            {
+                uint64_t sliceNumber = tsData.Of< KTSliceHeader >().GetSliceNumber();
+                if (fThrowAtSlice >= 0 && sliceNumber == uint64_t(fThrowAtSlice))
+                {
+                    throw std::runtime_error("checksum failure requested by the test");
+                }
+
+                // vary the amount of work so that the workers finish out of order
+                std::this_thread::sleep_for(std::chrono::microseconds(((sliceNumber * 7919) % 5) * 300));
+
+                const KTTimeSeries* ts = tsData.GetTimeSeries(0);
+                double checksum = 0.;
+                for (unsigned iBin = 0; iBin < ts->GetNTimeBins(); ++iBin)
+                {
+                    checksum += ts->GetValue(iBin) * double(iBin % 17 + 1);
+                }
+                tsData.Of< KTTestSliceChecksum >().SetChecksum(checksum);
+                return true;
+            }
+
+            void EggDone()
+            {
+                ++sNEggDone;
+                return;
+            }
+
+            static std::atomic< unsigned > sNEggDone;
+
+        private:
+            int fThrowAtSlice;
+
+            Nymph::KTSignalData fChecksumSignal;
+            Nymph::KTSlotDataOneType< KTTimeSeriesData > fTSSlot;
+            Nymph::KTSlotDone fDoneSlot;
+    };
+
+    std::atomic< unsigned > KTTestChecksumProcessor::sNEggDone(0);
+
+    KT_REGISTER_PROCESSOR(KTTestChecksumProcessor, "test-checksum");
+
+
+    //*****************************
+    // Output
+    //*****************************
+
+    struct RecordedSlice
+    {
+        uint64_t fSliceNumber;
+        bool fLastData;
+        double fChecksum;
+        std::vector< double > fValues;
+    };
+
+    class KTTestSliceRecorder : public Nymph::KTProcessor
+    {
+        public:
+            KTTestSliceRecorder(const std::string& name = "test-recorder") :
+                    KTProcessor(name),
+                    fSlices(),
+                    fTSSlot("ts", this, &KTTestSliceRecorder::Record)
+            {}
+            virtual ~KTTestSliceRecorder() {}
+
+            bool Configure(const scarab::param_node*)
+            {
+                return true;
+            }
+
+            bool Record(KTTimeSeriesData& tsData)
+            {
+                RecordedSlice slice;
+                slice.fSliceNumber = tsData.Of< KTSliceHeader >().GetSliceNumber();
+                slice.fLastData = tsData.Of< Nymph::KTData >().GetLastData();
+                slice.fChecksum = tsData.Has< KTTestSliceChecksum >() ? tsData.Of< KTTestSliceChecksum >().GetChecksum() : -1.;
+                const KTTimeSeries* ts = tsData.GetTimeSeries(0);
+                for (unsigned iBin = 0; iBin < ts->GetNTimeBins(); ++iBin)
+                {
+                    slice.fValues.push_back(ts->GetValue(iBin));
+                }
+                fSlices.push_back(slice);
+                return true;
+            }
+
+            std::vector< RecordedSlice > fSlices;
+
+        private:
+            Nymph::KTSlotDataOneType< KTTimeSeriesData > fTSSlot;
+    };
+}
+
+param_node EggConfig(unsigned nSlices, unsigned nWorkers, unsigned maxInFlight, int throwAtSlice)
+{
+    param_node config;
+    config.add("egg-reader", param_value("test-slices"));
+    config.add("filename", param_value("synthetic-slices"));
+    config.add("number-of-slices", param_value(nSlices));
+    config.add("slice-size", param_value(256));
+    config.add("progress-report-interval", param_value(0));
+    config.add("n-worker-threads", param_value(nWorkers));
+    config.add("max-slices-in-flight", param_value(maxInFlight));
+
+    if (nWorkers > 0)
+    {
+        param_node chain;
+
+        param_array processors;
+        param_node checksumProc;
+        checksumProc.add("type", param_value("test-checksum"));
+        checksumProc.add("name", param_value("checksum"));
+        processors.push_back(checksumProc);
+        chain.add("processors", processors);
+
+        param_array connections;
+        param_node tsConn;
+        tsConn.add("signal", param_value("worker:ts"));
+        tsConn.add("slot", param_value("checksum:ts"));
+        connections.push_back(tsConn);
+        param_node doneConn;
+        doneConn.add("signal", param_value("worker:egg-done"));
+        doneConn.add("slot", param_value("checksum:egg-done"));
+        connections.push_back(doneConn);
+        chain.add("connections", connections);
+
+        param_node checksumConfig;
+        checksumConfig.add("throw-at-slice", param_value(throwAtSlice));
+        chain.add("checksum", checksumConfig);
+
+        config.add("worker-chain", chain);
+    }
+    return config;
+}
+
+bool RunEggProcessor(unsigned nSlices, unsigned nWorkers, unsigned maxInFlight, std::vector< RecordedSlice >& slices)
+{
+    KTEggProcessor eggProc;
+    param_node config = EggConfig(nSlices, nWorkers, maxInFlight, -1);
+    if (! eggProc.Configure(&config))
+    {
+        KTERROR(testlog, "Unable to configure the egg processor");
+        return false;
+    }
+
+    KTTestChecksumProcessor checksum;
+    KTTestSliceRecorder recorder;
+    if (nWorkers == 0)
+    {
+        eggProc.ConnectASlot("ts", &checksum, "ts");
+        checksum.ConnectASlot("checksum", &recorder, "ts");
+    }
+    else
+    {
+        // the worker chain has already done the checksum
+        eggProc.ConnectASlot("ts", &recorder, "ts");
+    }
+
+    KTTestChecksumProcessor::sNEggDone = 0;
+    if (! eggProc.ProcessEgg())
+    {
+        KTERROR(testlog, "Processing failed");
+        return false;
+    }
+
+    if (KTTestChecksumProcessor::sNEggDone != nWorkers)
+    {
+        KTERROR(testlog, "The worker chains received egg-done " << KTTestChecksumProcessor::sNEggDone << " times; expected " << nWorkers);
+        return false;
+    }
+
+    slices = recorder.fSlices;
+    return true;
+}
+
+unsigned CompareRuns(const std::vector< RecordedSlice >& serial, const std::vector< RecordedSlice >& parallel)
+{
+    unsigned nBad = 0;
+    if (parallel.size() != serial.size())
+    {
+        KTERROR(testlog, "Recorded " << parallel.size() << " slices; the serial run recorded " << serial.size());
+        return 1;
+    }
+    for (unsigned iSlice = 0; iSlice < serial.size(); ++iSlice)
+    {
+        const RecordedSlice& lhs = serial[iSlice];
+        const RecordedSlice& rhs = parallel[iSlice];
+        if (rhs.fSliceNumber != iSlice)
+        {
+            KTERROR(testlog, "Slice " << rhs.fSliceNumber << " was emitted in position " << iSlice);
+            ++nBad;
+        }
+        if (rhs.fLastData != (iSlice == serial.size() - 1) || rhs.fLastData != lhs.fLastData)
+        {
+            KTERROR(testlog, "Slice " << iSlice << " has the wrong last-data flag");
+            ++nBad;
+        }
+        if (rhs.fChecksum != lhs.fChecksum || rhs.fValues != lhs.fValues)
+        {
+            KTERROR(testlog, "Slice " << iSlice << " differs from the serial run");
+            ++nBad;
+        }
+    }
+    return nBad;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned nSlices = 100;
+    if (argc > 1) nSlices = atoi(argv[1]);
+
+    std::vector< RecordedSlice > serial;
+    if (! RunEggProcessor(nSlices, 0, 0, serial)) return -1;
+    KTINFO(testlog, "Serial run: " << serial.size() << " slices");
+    if (serial.size() != nSlices)
+    {
+        KTERROR(testlog, "The serial run recorded " << serial.size() << " slices; expected " << nSlices);
+        return -1;
+    }
+
+    unsigned nBad = 0;
+    const unsigned nWorkers[] = {2, 4, 3};
+    const unsigned maxInFlight[] = {2, 0, 5};
+    for (unsigned iRun = 0; iRun < 3; ++iRun)
+    {
+        std::vector< RecordedSlice > parallel;
+        if (! RunEggProcessor(nSlices, nWorkers[iRun], maxInFlight[iRun], parallel)) return -1;
+        unsigned nBadRun = CompareRuns(serial, parallel);
+        KTINFO(testlog, nWorkers[iRun] << " workers, " << maxInFlight[iRun] << " max. slices in flight: " << nBadRun << " problems");
+        nBad += nBadRun;
+    }
+
+    // a failure in a worker must reach the calling thread
+    bool caught = false;
+    {
+        KTEggProcessor eggProc;
+        param_node config = EggConfig(nSlices, 4, 0, nSlices / 2);
+        KTTestSliceRecorder recorder;
+        if (! eggProc.Configure(&config)) return -1;
+        eggProc.ConnectASlot("ts", &recorder, "ts");
+        try
+        {
+            eggProc.ProcessEgg();
+        }
+        catch (std::runtime_error& e)
+        {
+            KTINFO(testlog, "Caught the worker's exception after " << recorder.fSlices.size() << " slices: " << e.what());
+            caught = recorder.fSlices.size() <= nSlices / 2;
+        }
+    }
+    if (! caught)
+    {
+        KTERROR(testlog, "The exception thrown by a worker was not passed to the calling thread before its slice was emitted");
+        ++nBad;
+    }
+
+    if (nBad != 0)
+    {
+        KTERROR(testlog, nBad << " problems were found with parallel processing");
+        return -1;
+    }
+
+    KTINFO(testlog, "Parallel processing matches serial processing");
+    return 0;
+}
@@ -0,0 +1,306 @@
+/*
+ * TestSequentialTrackFinderIndex.cc
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ *
+ *  Checks that KTSequentialTrackFinder, which looks up the active lines near each point with a frequency index,
+ *  finds the same tracks as a linear scan over all of the active lines (the way the lines were searched before the index).
+ *
+ *  The slices have tracks with positive and negative slopes that turn on and off, including tracks that cross,
+ *  plus noise points at random frequencies.  The initial frequency acceptance is larger than the frequency acceptance,
+ *  so that the second-point condition is exercised.
+ *  The reference scan uses a second finder, configured in the same way, for the slope calculation and the candidate cuts.
+ *  The candidates must have the same IDs and exactly the same points and slopes.
+ *
+ *  Usage: TestSequentialTrackFinderIndex [# of slices]
+ */
+
+#include "KTDiscriminatedPoints1DData.hh"
+#include "KTLogger.hh"
+#include "KTSequentialLineData.hh"
+#include "KTSequentialTrackFinder.hh"
+#include "KTSliceHeader.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace Katydid;
+
+KTLOGGER(testlog, "TestSequentialTrackFinderIndex");
+
+typedef KTSequentialTrackFinder::STFDiscriminatedPowerSortedPoints SortedPoints;
+
+// Linear scan over the active lines, in order of creation; this is the search that the frequency index replaced
+class LinearScanFinder
+{
+    public:
+        LinearScanFinder(KTSequentialTrackFinder& finder) :
+            fFinder(finder),
+            fActiveLines()
+        {}
+
+        void LoopOverHighPowerPoints(SortedPoints& points, uint64_t acqID, unsigned component)
+        {
+            for (SortedPoints::reverse_iterator pointIt = points.rbegin(); pointIt != points.rend(); ++pointIt)
+            {
+                if (pointIt->fAmplitude == 0.0 || pointIt->fFrequency == 0.0) continue;
+
+                bool match = false;
+                vector< KTSequentialLineData >::iterator lineIt = fActiveLines.begin();
+                while (lineIt != fActiveLines.end())
+                {
+                    if (lineIt->GetEndTimeInRunC() < pointIt->fTimeInRunC - fFinder.GetTimeGapTolerance())
+                    {
+                        if (lineIt->GetNPoints() >= fFinder.GetMinPoints())
+                        {
+                            lineIt->LineSNRTrimming(fFinder.GetTrimmingThreshold(), fFinder.GetMinPoints());
+                            if (lineIt->GetNPoints() >= fFinder.GetMinPoints() && lineIt->GetSlope() >= fFinder.GetMinSlope())
+                            {
+                                (fFinder.*(fFinder.fCalcSlope))(*lineIt);
+                                fFinder.EmitPreCandidate(*lineIt);
+                            }
+                        }
+                        lineIt = fActiveLines.erase(lineIt);
+                        continue;
+                    }
+
+                    bool timeCondition = pointIt->fTimeInRunC > lineIt->GetEndTimeInRunC();
+                    double frequencyDistance = std::abs(pointIt->fFrequency - (lineIt->GetEndFrequency() + lineIt->GetSlope()*(pointIt->fTimeInAcq - lineIt->GetEndTimeInAcq())));
+                    bool anyPointCondition = frequencyDistance < fFinder.GetFrequencyAcceptance();
+                    bool secondPointCondition = frequencyDistance < fFinder.GetInitialFrequencyAcceptance();
+                    if (timeCondition && (anyPointCondition || (lineIt->GetNPoints() == 1 && secondPointCondition)))
+                    {
+                        lineIt->AddPoint(*pointIt);
+                        (fFinder.*(fFinder.fCalcSlope))(*lineIt);
+                        match = true;
+                        break;
+                    }
+                    ++lineIt;
+                }
+
+                if (! match)
+                {
+                    KTSequentialLineData newLine;
+                    newLine.SetSlope(fFinder.GetInitialSlope());
+                    newLine.SetAcquisitionID(acqID);
+                    newLine.SetComponent(component);
+                    newLine.AddPoint(*pointIt);
+                    (fFinder.*(fFinder.fCalcSlope))(newLine);
+                    fActiveLines.push_back(newLine);
+                }
+            }
+            return;
+        }
+
+        void AcquisitionIsOver()
+        {
+            for (vector< KTSequentialLineData >::iterator lineIt = fActiveLines.begin(); lineIt != fActiveLines.end(); ++lineIt)
+            {
+                if (lineIt->GetNPoints() >= fFinder.GetMinPoints())
+                {
+                    lineIt->LineSNRTrimming(fFinder.GetTrimmingThreshold(), fFinder.GetMinPoints());
+                    if (lineIt->GetNPoints() >= fFinder.GetMinPoints() && lineIt->GetSlope() > fFinder.GetMinSlope())
+                    {
+                        fFinder.EmitPreCandidate(*lineIt);
+                    }
+                }
+            }
+            fActiveLines.clear();
+            return;
+        }
+
+    private:
+        KTSequentialTrackFinder& fFinder;
+        vector< KTSequentialLineData > fActiveLines;
+};
+
+void ConfigureFinder(KTSequentialTrackFinder& finder, double binWidth, double sliceLength, double maxFrequency)
+{
+    finder.SetMinFrequency(0.);
+    finder.SetMaxFrequency(maxFrequency);
+    finder.SetFrequencyAcceptance(2.5 * binWidth);
+    finder.SetInitialFrequencyAcceptance(6. * binWidth);
+    finder.SetTimeGapTolerance(2.5 * sliceLength);
+    finder.SetInitialSlope(0.);
+    finder.SetMinPoints(3);
+    finder.SetMinSlope(-1.e12);
+    return;
+}
+
+bool CompareBins(const pair< unsigned, KTDiscriminatedPoints1DData::Point >& lhs, const pair< unsigned, KTDiscriminatedPoints1DData::Point >& rhs)
+{
+    return lhs.first < rhs.first;
+}
+
+// Candidates keyed by candidate ID
+map< unsigned, const KTSequentialLineData* > CandidatesByID(const KTSequentialTrackFinder& finder)
+{
+    map< unsigned, const KTSequentialLineData* > candidates;
+    for (set< Nymph::KTDataPtr >::const_iterator it = finder.GetCandidates().begin(); it != finder.GetCandidates().end(); ++it)
+    {
+        const KTSequentialLineData& line = (*it)->Of< KTSequentialLineData >();
+        candidates[line.GetCandidateID()] = &line;
+    }
+    return candidates;
+}
+
+bool SameLine(const KTSequentialLineData& lhs, const KTSequentialLineData& rhs)
+{
+    if (lhs.GetSlope() != rhs.GetSlope() || lhs.GetPoints().size() != rhs.GetPoints().size()) return false;
+    KTDiscriminatedPoints::const_iterator rIt = rhs.GetPoints().begin();
+    for (KTDiscriminatedPoints::const_iterator lIt = lhs.GetPoints().begin(); lIt != lhs.GetPoints().end(); ++lIt, ++rIt)
+    {
+        if (lIt->fTimeInRunC != rIt->fTimeInRunC || lIt->fFrequency != rIt->fFrequency || lIt->fAmplitude != rIt->fAmplitude) return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned nSlices = 1000;
+    if (argc > 1) nSlices = atoi(argv[1]);
+
+    const double sampleRate = 100.e6; // Hz
+    const unsigned sliceSize = 4096;
+    const double binWidth = sampleRate / double(sliceSize); // Hz
+    const double sliceLength = double(sliceSize) / sampleRate; // s
+    const unsigned nBins = sliceSize / 2;
+
+    const unsigned nTracks = 60;
+    const unsigned nNoisePoints = 40;
+    const unsigned trackOnSlices = 30;
+    const unsigned trackPeriod = 40;
+
+    KTSequentialTrackFinder indexedFinder;
+    ConfigureFinder(indexedFinder, binWidth, sliceLength, 0.5 * sampleRate);
+
+    KTSequentialTrackFinder referenceFinder;
+    ConfigureFinder(referenceFinder, binWidth, sliceLength, 0.5 * sampleRate);
+    LinearScanFinder linearFinder(referenceFinder);
+
+    mt19937 generator(20181005);
+    uniform_int_distribution< unsigned > noiseBinDist(1, nBins - 2);
+    uniform_real_distribution< double > slopeDist(-2.e8, 2.e8); // Hz/s
+    uniform_real_distribution< double > powerDist(8., 30.);
+    uniform_int_distribution< unsigned > startBinDist(100, nBins - 100);
+
+    // each track gets a new start frequency and slope each time it turns on
+    vector< double > startFrequencies(nTracks), slopes(nTracks);
+    for (unsigned iTrack = 0; iTrack < nTracks; ++iTrack)
+    {
+        startFrequencies[iTrack] = (double(startBinDist(generator)) + 0.5) * binWidth;
+        slopes[iTrack] = slopeDist(generator);
+    }
+
+    KTSliceHeader header;
+    header.SetNComponents(1);
+    header.SetSampleRate(sampleRate);
+    header.SetRawSliceSize(sliceSize);
+    header.SetSliceSize(sliceSize);
+    header.SetSliceLength(sliceLength);
+    header.SetAcquisitionID(3);
+
+    unsigned maxActiveLines = 0;
+    for (unsigned iSlice = 0; iSlice < nSlices; ++iSlice)
+    {
+        double time = double(iSlice) * sliceLength;
+        header.SetTimeInRun(time);
+        header.SetTimeInAcq(time);
+        header.SetSliceNumber(iSlice);
+
+        KTDiscriminatedPoints1DData::PointBuffer buffer;
+        for (unsigned iTrack = 0; iTrack < nTracks; ++iTrack)
+        {
+            unsigned phase = (iSlice + 7 * iTrack) % trackPeriod;
+            if (phase == 0)
+            {
+                startFrequencies[iTrack] = (double(startBinDist(generator)) + 0.5) * binWidth;
+                slopes[iTrack] = slopeDist(generator);
+            }
+            if (phase >= trackOnSlices) continue;
+            double frequency = startFrequencies[iTrack] + slopes[iTrack] * double(phase) * sliceLength;
+            if (frequency <= 0. || frequency >= double(nBins) * binWidth) continue;
+            unsigned bin = unsigned(frequency / binWidth);
+            double power = powerDist(generator);
+            buffer.push_back(make_pair(bin, KTDiscriminatedPoints1DData::Point(frequency, power, 5., 1., 1., power)));
+        }
+        for (unsigned iNoise = 0; iNoise < nNoisePoints; ++iNoise)
+        {
+            unsigned bin = noiseBinDist(generator);
+            buffer.push_back(make_pair(bin, KTDiscriminatedPoints1DData::Point((double(bin) + 0.5) * binWidth, 6., 5., 1., 1., 6.)));
+        }
+        stable_sort(buffer.begin(), buffer.end(), CompareBins);
+
+        KTDiscriminatedPoints1DData points;
+        points.SetNComponents(1);
+        points.SetNBins(nBins);
+        points.SetBinWidth(binWidth);
+        points.AddPoints(buffer);
+
+        indexedFinder.CollectDiscrimPointsFromSlice(header, points);
+
+        // the same points, collected in the same way as the finder does, for the linear scan
+        double newTimeInAcq = header.GetTimeInAcq() + 0.5 * header.GetSliceLength();
+        double newTimeInRunC = header.GetTimeInRun() + 0.5 * header.GetSliceLength();
+        SortedPoints sortedPoints;
+        const KTDiscriminatedPoints1DData::SetOfPoints& incomingPts = points.GetSetOfPoints(0);
+        for (KTDiscriminatedPoints1DData::SetOfPoints::const_iterator pIt = incomingPts.begin(); pIt != incomingPts.end(); ++pIt)
+        {
+            sortedPoints.emplace(pIt, newTimeInRunC, newTimeInAcq);
+        }
+        linearFinder.LoopOverHighPowerPoints(sortedPoints, header.GetAcquisitionID(0), 0);
+
+        maxActiveLines = max(maxActiveLines, indexedFinder.GetNActiveLines());
+    }
+
+    indexedFinder.AcquisitionIsOver();
+    linearFinder.AcquisitionIsOver();
+
+    map< unsigned, const KTSequentialLineData* > indexedCandidates = CandidatesByID(indexedFinder);
+    map< unsigned, const KTSequentialLineData* > linearCandidates = CandidatesByID(referenceFinder);
+
+    KTINFO(testlog, "Up to " << maxActiveLines << " active lines; candidates: " << indexedCandidates.size() << " (indexed) vs. " << linearCandidates.size() << " (linear scan)");
+
+    unsigned nBad = 0;
+    if (indexedCandidates.size() != linearCandidates.size())
+    {
+        KTERROR(testlog, "The number of candidates differs");
+        ++nBad;
+    }
+    for (map< unsigned, const KTSequentialLineData* >::const_iterator it = indexedCandidates.begin(); it != indexedCandidates.end(); ++it)
+    {
+        map< unsigned, const KTSequentialLineData* >::const_iterator lIt = linearCandidates.find(it->first);
+        if (lIt == linearCandidates.end())
+        {
+            KTERROR(testlog, "Candidate " << it->first << " was only found with the index");
+            ++nBad;
+        }
+        else if (! SameLine(*it->second, *lIt->second))
+        {
+            KTERROR(testlog, "Candidate " << it->first << " differs: " << it->second->GetPoints().size() << " points with slope " << it->second->GetSlope() <<
+                    " (indexed) vs. " << lIt->second->GetPoints().size() << " points with slope " << lIt->second->GetSlope() << " (linear scan)");
+            ++nBad;
+        }
+    }
+
+    if (indexedCandidates.empty())
+    {
+        KTERROR(testlog, "No candidates were found, so nothing was compared");
+        return -1;
+    }
+
+    if (nBad != 0)
+    {
+        KTERROR(testlog, nBad << " differences between the indexed lookup and the linear scan");
+        return -1;
+    }
+
+    KTINFO(testlog, "The indexed lookup finds the same tracks as the linear scan");
+    return 0;
+}
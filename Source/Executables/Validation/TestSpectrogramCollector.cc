@@ -244,6 +244,67 @@ int main()
         KTINFO(testlog, "Produced " << spectrograms.size() << " spectrograms");
     }
 
+    // Now send the spectra first, and the tracks afterwards; the spectrograms are filled from the spectrum cache.
+    // The memory budget holds only a fraction of the spectra, so most of them come from the spill file.
+    KTINFO(testlog, "Repeating with the tracks arriving after the spectra");
+    KTSpectrogramCollector cachedSpec;
+    cachedSpec.SetMinFrequency( freqMin );
+    cachedSpec.SetMaxFrequency( freqMax );
+    cachedSpec.SetLeadTime( 20e-6 );
+    cachedSpec.SetTrailTime( 20e-6 );
+    cachedSpec.GetSpectrumCache().SetMemoryBudget( 100 * nFreqBins * sizeof(double) );
+    cachedSpec.GetSpectrumCache().SetSpillFilename( "spectrogram-collector-test-cache.bin" );
+
+    for( int i = 0; i < nTimeBins; i++ )
+    {
+        if( ! cachedSpec.ReceiveSpectrum( psArray[i], sArray[i] ) )
+        {
+            KTERROR(testlog, "Something went wrong adding spectrum" << i);
+        }
+    }
+    for( int i = 0; i < 5; i++ )
+    {
+        if( ! cachedSpec.ReceiveTrack( trackArray[i] ) )
+        {
+            KTERROR(testlog, "Something went wrong adding track" << i);
+        }
+    }
+
+    const KTSpectrogramCollector::WaterfallSet& cachedSpectrograms = cachedSpec.WaterfallSets()[0];
+    bool cachedMatch = cachedSpectrograms.size() == spectrograms.size();
+    for( auto specIt = spectrograms.begin(), cachedIt = cachedSpectrograms.begin(); cachedMatch && specIt != spectrograms.end(); ++specIt, ++cachedIt )
+    {
+        const KTMultiPS* spectra = specIt->second->GetSpectra(0);
+        const KTMultiPS* cachedSpectra = cachedIt->second->GetSpectra(0);
+        if( specIt->second->GetStartTime() != cachedIt->second->GetStartTime() || specIt->second->GetEndTime() != cachedIt->second->GetEndTime() ||
+            spectra->size() != cachedSpectra->size() )
+        {
+            cachedMatch = false;
+            break;
+        }
+        for( unsigned iSpectrum = 0; cachedMatch && iSpectrum < spectra->size(); ++iSpectrum )
+        {
+            const KTPowerSpectrum* ps = (*spectra)(iSpectrum);
+            const KTPowerSpectrum* cachedPS = (*cachedSpectra)(iSpectrum);
+            if( ps == NULL || cachedPS == NULL )
+            {
+                cachedMatch = ps == cachedPS;
+                continue;
+            }
+            for( unsigned iBin = 0; iBin < ps->size(); ++iBin )
+            {
+                if( (*ps)(iBin) != (*cachedPS)(iBin) ) cachedMatch = false;
+            }
+        }
+    }
+
+    if( ! cachedMatch )
+    {
+        KTERROR(testlog, "The spectrograms filled from the cache do not match");
+        return -1;
+    }
+    KTINFO(testlog, "The spectrograms filled from the cache match");
+
     // Fill a TH2D for each spectrogram and write to a file
 
 #ifdef ROOT_FOUND
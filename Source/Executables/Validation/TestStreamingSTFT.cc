@@ -0,0 +1,321 @@
+/*
+ * TestStreamingSTFT.cc
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ *
+ *  Checks that the batched short-time Fourier transform (KTStreamingSTFT), which transforms all of the frames in a batch
+ *  with one FFTW plan_many execution, gives the same power spectra as transforming each frame separately with KTWindowedFFTPower.
+ *
+ *  A stream of real or complex samples (noise plus a sinusoid) is split into slices of a size that is unrelated to the window,
+ *  hop, and batch sizes, and the slices are given to the streaming STFT in order; the stream is then flushed.
+ *  Each frame is then cut out of the stream and transformed on its own.  The cases include:
+ *   - rectangular windows (the plan reads the frames directly from the stream buffer) and Hann windows (the frames are copied out);
+ *   - overlapping frames, a hop larger than the window, and frames that span several slices;
+ *   - batch sizes that don't divide the number of frames, so the flush transforms a partial batch;
+ *   - per-frame ("ps") and per-batch ("stripe") output.
+ *  The number of frames, the frame numbers and start times, and the binnings have to match exactly.
+ *  The two FFTW plans aren't guaranteed to use the same algorithm, so the power in each bin has to match to within
+ *  a small fraction of the largest power in the spectrum.
+ *
+ *  Usage: TestStreamingSTFT
+ */
+
+#include "KTLogger.hh"
+#include "KTMultiPSData.hh"
+#include "KTPowerSpectrum.hh"
+#include "KTPowerSpectrumData.hh"
+#include "KTSliceHeader.hh"
+#include "KTStreamingSTFT.hh"
+#include "KTTimeSeriesData.hh"
+#include "KTTimeSeriesFFTW.hh"
+#include "KTTimeSeriesReal.hh"
+#include "KTWindowedFFTPower.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace Katydid;
+
+KTLOGGER(testlog, "TestStreamingSTFT");
+
+namespace Katydid
+{
+    // Keeps the data objects emitted by the STFT
+    class OutputCollector : public Nymph::KTProcessor
+    {
+        public:
+            OutputCollector() :
+                    Nymph::KTProcessor(),
+                    fOutput()
+            {
+                this->RegisterSlot("collect", this, &OutputCollector::Collect);
+            }
+            virtual ~OutputCollector() {}
+
+            bool Configure(const scarab::param_node*)
+            {
+                return true;
+            }
+
+            void Collect(Nymph::KTDataPtr dataPtr)
+            {
+                fOutput.push_back(dataPtr);
+                return;
+            }
+
+            std::vector< Nymph::KTDataPtr > fOutput;
+    };
+}
+
+const unsigned sNComponents = 2;
+const unsigned sSliceSize = 100;
+const unsigned sNSlices = 9;
+const double sBinWidth = 1.e-8; // s
+const double sTolerance = 1.e-10;
+
+struct TestCase
+{
+    bool fIsReal;
+    string fWindow;
+    unsigned fWindowSize;
+    unsigned fHopSize;
+    unsigned fFramesPerBatch;
+    bool fStripe;
+};
+
+// The input streams; the imaginary parts are only used for complex data
+struct Streams
+{
+    vector< vector< double > > fReal;
+    vector< vector< double > > fImag;
+};
+
+// Fills a data object with nBins samples of each stream, starting at the given sample
+void FillTimeSeries(KTTimeSeriesData& tsData, const Streams& streams, bool isReal, unsigned start, unsigned nBins)
+{
+    tsData.SetNComponents(sNComponents);
+    for (unsigned iComponent = 0; iComponent < sNComponents; ++iComponent)
+    {
+        if (isReal)
+        {
+            KTTimeSeriesReal* ts = new KTTimeSeriesReal(nBins, 0., nBins * sBinWidth);
+            for (unsigned iBin = 0; iBin < nBins; ++iBin)
+            {
+                (*ts)(iBin) = streams.fReal[iComponent][start + iBin];
+            }
+            tsData.SetTimeSeries(ts, iComponent);
+        }
+        else
+        {
+            KTTimeSeriesFFTW* ts = new KTTimeSeriesFFTW(nBins, 0., nBins * sBinWidth);
+            for (unsigned iBin = 0; iBin < nBins; ++iBin)
+            {
+                (*ts)(iBin)[0] = streams.fReal[iComponent][start + iBin];
+                (*ts)(iBin)[1] = streams.fImag[iComponent][start + iBin];
+            }
+            tsData.SetTimeSeries(ts, iComponent);
+        }
+    }
+    return;
+}
+
+// Returns the number of bins that differ by more than the tolerance, relative to the largest reference value
+unsigned CompareSpectra(const KTPowerSpectrum& batched, const KTPowerSpectrum& reference, double& maxRelDiff)
+{
+    if (batched.GetNFrequencyBins() != reference.GetNFrequencyBins() || batched.GetRangeMin() != reference.GetRangeMin() ||
+            batched.GetRangeMax() != reference.GetRangeMax())
+    {
+        KTERROR(testlog, "The binning differs\n" <<
+                "\tBatched:   " << batched.GetNFrequencyBins() << " bins from " << batched.GetRangeMin() << " to " << batched.GetRangeMax() << '\n' <<
+                "\tReference: " << reference.GetNFrequencyBins() << " bins from " << reference.GetRangeMin() << " to " << reference.GetRangeMax());
+        return reference.GetNFrequencyBins();
+    }
+
+    double maxValue = 0.;
+    for (unsigned iBin = 0; iBin < reference.GetNFrequencyBins(); ++iBin)
+    {
+        maxValue = max(maxValue, fabs(reference(iBin)));
+    }
+
+    unsigned nDiff = 0;
+    for (unsigned iBin = 0; iBin < reference.GetNFrequencyBins(); ++iBin)
+    {
+        double relDiff = fabs(batched(iBin) - reference(iBin)) / maxValue;
+        maxRelDiff = max(maxRelDiff, relDiff);
+        if (relDiff > sTolerance) ++nDiff;
+    }
+    return nDiff;
+}
+
+// Runs one case; returns the number of problems found
+unsigned RunCase(const TestCase& testCase, const Streams& streams)
+{
+    KTINFO(testlog, (testCase.fIsReal ? "Real" : "Complex") << " data; " << testCase.fWindow << " window of " << testCase.fWindowSize <<
+            " samples; hop: " << testCase.fHopSize << "; frames per batch: " << testCase.fFramesPerBatch << "; output: " << (testCase.fStripe ? "stripe" : "ps"));
+
+    KTStreamingSTFT stft;
+    stft.SetWindowSize(testCase.fWindowSize);
+    stft.SetHopSize(testCase.fHopSize);
+    stft.SetFramesPerBatch(testCase.fFramesPerBatch);
+    stft.SetOutput(testCase.fStripe ? KTStreamingSTFT::kStripe : KTStreamingSTFT::kPerFrame);
+    stft.GetFFT().SetTransformFlag("ESTIMATE");
+
+    KTWindowedFFTPower reference;
+    reference.GetFFT().SetTransformFlag("ESTIMATE");
+
+    if (! stft.SelectWindowFunction(testCase.fWindow) || ! reference.SelectWindowFunction(testCase.fWindow))
+    {
+        KTERROR(testlog, "Unable to select the window function <" << testCase.fWindow << ">");
+        return 1;
+    }
+
+    OutputCollector collector;
+    stft.ConnectASlot(testCase.fStripe ? "stripe" : "ps", &collector, "collect");
+
+    for (unsigned iSlice = 0; iSlice < sNSlices; ++iSlice)
+    {
+        KTSliceHeader header;
+        header.SetNComponents(sNComponents);
+        header.SetSliceNumber(iSlice);
+        header.SetIsNewAcquisition(iSlice == 0);
+        header.SetTimeInRun(double(iSlice * sSliceSize) * sBinWidth);
+        header.SetTimeInAcq(double(iSlice * sSliceSize) * sBinWidth);
+        header.SetSampleRate(1. / sBinWidth);
+        header.SetSliceSize(sSliceSize);
+        header.SetRawSliceSize(sSliceSize);
+
+        KTTimeSeriesData tsData;
+        FillTimeSeries(tsData, streams, testCase.fIsReal, iSlice * sSliceSize, sSliceSize);
+        bool added = testCase.fIsReal ? stft.AddRealData(header, tsData) : stft.AddComplexData(header, tsData);
+        if (! added)
+        {
+            KTERROR(testlog, "Unable to add slice " << iSlice);
+            return 1;
+        }
+    }
+    stft.Flush();
+
+    unsigned nBad = 0;
+    unsigned iFrame = 0;
+    double maxRelDiff = 0.;
+    for (unsigned iOutput = 0; iOutput < collector.fOutput.size(); ++iOutput)
+    {
+        const KTSliceHeader& header = collector.fOutput[iOutput]->Of< KTSliceHeader >();
+        unsigned nFramesInOutput = testCase.fStripe ? header.GetNSlicesIncluded() : 1;
+
+        double expectedTime = double(iFrame * testCase.fHopSize) * sBinWidth;
+        if (header.GetSliceNumber() != iFrame || fabs(header.GetTimeInRun() - expectedTime) > 1.e-3 * sBinWidth || header.GetSliceSize() != testCase.fWindowSize)
+        {
+            KTERROR(testlog, "Output " << iOutput << ": the header doesn't match frame " << iFrame << "; slice number: " << header.GetSliceNumber() <<
+                    "; time in run: " << header.GetTimeInRun() << " (expected " << expectedTime << "); slice size: " << header.GetSliceSize());
+            ++nBad;
+        }
+
+        for (unsigned iFrameInOutput = 0; iFrameInOutput < nFramesInOutput; ++iFrameInOutput, ++iFrame)
+        {
+            unsigned start = iFrame * testCase.fHopSize;
+            if (start + testCase.fWindowSize > sNSlices * sSliceSize)
+            {
+                KTERROR(testlog, "Frame " << iFrame << " extends past the end of the stream");
+                return nBad + 1;
+            }
+
+            Nymph::KTData referenceData;
+            KTTimeSeriesData& tsData = referenceData.Of< KTTimeSeriesData >();
+            FillTimeSeries(tsData, streams, testCase.fIsReal, start, testCase.fWindowSize);
+            bool transformed = testCase.fIsReal ? reference.TransformRealToPS(tsData) : reference.TransformComplexToPS(tsData);
+            if (! transformed)
+            {
+                KTERROR(testlog, "Unable to transform frame " << iFrame << " on its own");
+                return nBad + 1;
+            }
+
+            for (unsigned iComponent = 0; iComponent < sNComponents; ++iComponent)
+            {
+                const KTPowerSpectrum* referenceSpectrum = referenceData.Of< KTPowerSpectrumData >().GetSpectrum(iComponent);
+                const KTPowerSpectrum* batchedSpectrum = testCase.fStripe ?
+                        (*collector.fOutput[iOutput]->Of< KTMultiPSData >().GetSpectra(iComponent))(iFrameInOutput) :
+                        collector.fOutput[iOutput]->Of< KTPowerSpectrumData >().GetSpectrum(iComponent);
+                if (referenceSpectrum == NULL || batchedSpectrum == NULL)
+                {
+                    KTERROR(testlog, "Frame " << iFrame << ", component " << iComponent << ": missing spectrum");
+                    ++nBad;
+                    continue;
+                }
+                unsigned nDiff = CompareSpectra(*batchedSpectrum, *referenceSpectrum, maxRelDiff);
+                if (nDiff != 0)
+                {
+                    KTERROR(testlog, "Frame " << iFrame << ", component " << iComponent << ": " << nDiff << " bins differ");
+                    ++nBad;
+                }
+            }
+        }
+    }
+
+    unsigned nSamples = sNSlices * sSliceSize;
+    unsigned nExpectedFrames = (nSamples - testCase.fWindowSize) / testCase.fHopSize + 1;
+    if (iFrame != nExpectedFrames || stft.GetNFrames() != nExpectedFrames)
+    {
+        KTERROR(testlog, "Received " << iFrame << " frames (the STFT counted " << stft.GetNFrames() << "); expected " << nExpectedFrames);
+        ++nBad;
+    }
+
+    KTINFO(testlog, iFrame << " frames in " << collector.fOutput.size() << " outputs; largest relative difference: " << maxRelDiff);
+    return nBad;
+}
+
+int main()
+{
+    mt19937 generator(20261017);
+    normal_distribution< double > noise(0., 1.);
+
+    unsigned nSamples = sNSlices * sSliceSize;
+    Streams streams;
+    streams.fReal.resize(sNComponents, vector< double >(nSamples));
+    streams.fImag.resize(sNComponents, vector< double >(nSamples));
+    for (unsigned iComponent = 0; iComponent < sNComponents; ++iComponent)
+    {
+        double freq = 1.e7 * (iComponent + 1); // Hz
+        for (unsigned iSample = 0; iSample < nSamples; ++iSample)
+        {
+            double phase = 2. * M_PI * freq * double(iSample) * sBinWidth;
+            streams.fReal[iComponent][iSample] = 3. * cos(phase) + noise(generator);
+            streams.fImag[iComponent][iSample] = 3. * sin(phase) + noise(generator);
+        }
+    }
+
+    // real or complex, window, window size, hop, frames per batch, stripe output
+    const TestCase cases[] = {
+            {true, "rectangular", 64, 16, 5, false},
+            {true, "hann", 64, 16, 5, false},
+            {true, "hann", 64, 16, 7, true},
+            {true, "rectangular", 64, 80, 3, false},
+            {true, "hann", 50, 50, 4, true},
+            {true, "rectangular", 250, 25, 8, true},
+            {false, "rectangular", 32, 8, 16, false},
+            {false, "hann", 33, 10, 4, true},
+            {false, "rectangular", 64, 96, 2, true},
+            {false, "hann", 300, 10, 4, false}
+    };
+    const unsigned nCases = sizeof(cases) / sizeof(cases[0]);
+
+    unsigned nBad = 0;
+    for (unsigned iCase = 0; iCase < nCases; ++iCase)
+    {
+        nBad += RunCase(cases[iCase], streams);
+    }
+
+    if (nBad != 0)
+    {
+        KTERROR(testlog, nBad << " problems found; the batched STFT doesn't match the per-frame transforms");
+        return -1;
+    }
+
+    KTINFO(testlog, "The batched STFT matches the per-frame transforms in all " << nCases << " cases");
+    return 0;
+}
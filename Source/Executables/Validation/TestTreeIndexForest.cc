@@ -0,0 +1,198 @@
+/*
+ * TestTreeIndexForest.cc
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ *
+ *  Checks that the incremental k-d tree index (KTTreeIndexForest, used by KTKDTreeData) gives the same search results
+ *  as a nanoflann tree built from scratch over the same points.
+ *
+ *  The points are added slice by slice, as KTCreateKDTree does with a sliding window:
+ *   - after each slice is added, the index is updated with KTKDTreeData::UpdateIndex();
+ *   - once the window is full, the oldest slice is removed with KTKDTreeData::RemoveLeadingPoints().
+ *  Frequency bins are integers, so there are many points at the same distance from a query.
+ *
+ *  Radius searches must find the same points at the same distances.
+ *  k-nearest-neighbors searches must find the same distances; with ties at the k-th distance the points can differ,
+ *  so each point found is checked against its distance from the query instead.
+ *
+ *  Usage: ./TestTreeIndexForest [# of slices]
+ */
+
+#include "KTKDTree.hh"
+#include "KTKDTreeData.hh"
+#include "KTLogger.hh"
+#include "KTPointCloud.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace Katydid;
+
+KTLOGGER(testlog, "TestTreeIndexForest");
+
+typedef KTKDTreeData::Point Point;
+typedef KTPointCloud< Point > PointCloud;
+typedef std::vector< std::pair< size_t, double > > IndicesDists;
+
+bool CompareIndices(const std::pair< size_t, double >& lhs, const std::pair< size_t, double >& rhs)
+{
+    return lhs.first < rhs.first;
+}
+
+double IndexDistance(const double* query, const Point& point, KTKDTreeData::DistanceMethod dist)
+{
+    double d0 = query[0] - point.fCoords[0];
+    double d1 = query[1] - point.fCoords[1];
+    if (dist == KTKDTreeData::kManhattan) return std::fabs(d0) + std::fabs(d1);
+    return d0*d0 + d1*d1;
+}
+
+/// Compares radius and k-NN searches around the query point; returns the number of mismatches
+unsigned CompareSearches(const KTKDTreeData::TreeIndex& forest, const KTKDTreeData::TreeIndex& fresh, const KTKDTreeData::SetOfPoints& points, const double* query, KTKDTreeData::DistanceMethod dist)
+{
+    unsigned nBad = 0;
+
+    const double radii[] = {1., 2.5, 6.};
+    for (unsigned iRadius = 0; iRadius < 3; ++iRadius)
+    {
+        IndicesDists forestResults, freshResults;
+        forest.RadiusSearch(query, radii[iRadius], forestResults, nanoflann::SearchParams(32, 0, false));
+        fresh.RadiusSearch(query, radii[iRadius], freshResults, nanoflann::SearchParams(32, 0, false));
+        std::sort(forestResults.begin(), forestResults.end(), CompareIndices);
+        std::sort(freshResults.begin(), freshResults.end(), CompareIndices);
+        if (forestResults != freshResults)
+        {
+            KTERROR(testlog, "Radius search (r = " << radii[iRadius] << ") around (" << query[0] << ", " << query[1] << ") differs: "
+                    << forestResults.size() << " (forest) vs. " << freshResults.size() << " (fresh tree) points");
+            ++nBad;
+        }
+    }
+
+    const size_t nNeighbors[] = {1, 4, 16};
+    for (unsigned iK = 0; iK < 3; ++iK)
+    {
+        size_t k = std::min(nNeighbors[iK], points.size());
+        std::vector< size_t > forestIndices(k), freshIndices(k);
+        std::vector< double > forestDists(k), freshDists(k);
+        forest.KNNSearch(query, k, &forestIndices[0], &forestDists[0]);
+        fresh.KNNSearch(query, k, &freshIndices[0], &freshDists[0]);
+
+        bool same = true;
+        for (size_t iNeighbor = 0; iNeighbor < k && same; ++iNeighbor)
+        {
+            same = forestIndices[iNeighbor] < points.size() &&
+                   std::fabs(IndexDistance(query, points[forestIndices[iNeighbor]], dist) - forestDists[iNeighbor]) <= 1.e-9 * (1. + forestDists[iNeighbor]);
+        }
+        std::sort(forestDists.begin(), forestDists.end());
+        std::sort(freshDists.begin(), freshDists.end());
+        same = same && forestDists == freshDists;
+        if (! same)
+        {
+            KTERROR(testlog, "k-NN search (k = " << k << ") around (" << query[0] << ", " << query[1] << ") differs");
+            ++nBad;
+        }
+    }
+
+    return nBad;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned nSlices = 400;
+    if (argc > 1) nSlices = atoi(argv[1]);
+
+    const unsigned windowSize = 60; // slices
+    const unsigned checkEvery = 7; // slices
+    const unsigned nQueries = 20;
+
+    std::mt19937 generator(20140812);
+    std::poisson_distribution< unsigned > nPointsDist(25.);
+    std::uniform_int_distribution< unsigned > binDist(0, 200);
+    std::uniform_real_distribution< double > offsetDist(-2., 2.);
+
+    unsigned nBad = 0;
+    const KTKDTreeData::DistanceMethod methods[] = {KTKDTreeData::kManhattan, KTKDTreeData::kEuclidean};
+    for (unsigned iMethod = 0; iMethod < 2; ++iMethod)
+    {
+        KTKDTreeData::DistanceMethod dist = methods[iMethod];
+        KTINFO(testlog, "Testing the " << (dist == KTKDTreeData::kManhattan ? "Manhattan" : "Euclidean") << " distance metric");
+
+        KTKDTreeData treeData;
+        std::vector< size_t > pointsPerSlice;
+        unsigned nChecks = 0;
+
+        for (unsigned iSlice = 0; iSlice < nSlices; ++iSlice)
+        {
+            unsigned nPoints = nPointsDist(generator);
+            for (unsigned iPoint = 0; iPoint < nPoints; ++iPoint)
+            {
+                Point point;
+                point.fCoords[0] = double(iSlice);
+                point.fCoords[1] = double(binDist(generator));
+                point.fSliceNumber = iSlice;
+                treeData.AddPoint(point);
+            }
+            pointsPerSlice.push_back(nPoints);
+
+            if (pointsPerSlice.size() > windowSize)
+            {
+                treeData.RemoveLeadingPoints(pointsPerSlice.front());
+                pointsPerSlice.erase(pointsPerSlice.begin());
+            }
+
+            treeData.UpdateIndex(dist, 10);
+
+            if (iSlice % checkEvery != 0) continue;
+
+            const KTKDTreeData::SetOfPoints& points = treeData.GetSetOfPoints();
+            if (points.empty()) continue;
+
+            const KTKDTreeData::TreeIndex* forest = treeData.GetTreeIndex();
+            if (forest->size() != points.size())
+            {
+                KTERROR(testlog, "Slice " << iSlice << ": the forest indexes " << forest->size() << " points; there are " << points.size());
+                ++nBad;
+                continue;
+            }
+
+            PointCloud cloud;
+            cloud.fPoints = points;
+            KTKDTreeData::TreeIndex* fresh = NULL;
+            if (dist == KTKDTreeData::kManhattan) fresh = new KTTreeIndexManhattan< double, PointCloud >(2, cloud, nanoflann::KDTreeSingleIndexAdaptorParams(10));
+            else fresh = new KTTreeIndexEuclidean< double, PointCloud >(2, cloud, nanoflann::KDTreeSingleIndexAdaptorParams(10));
+            fresh->BuildIndex();
+
+            std::uniform_int_distribution< size_t > pointDist(0, points.size() - 1);
+            for (unsigned iQuery = 0; iQuery < nQueries; ++iQuery)
+            {
+                // queries at points in the window, and near them
+                const Point& point = points[pointDist(generator)];
+                double query[2] = {point.fCoords[0], point.fCoords[1]};
+                if (iQuery % 2 == 1)
+                {
+                    query[0] += offsetDist(generator);
+                    query[1] += offsetDist(generator);
+                }
+                nBad += CompareSearches(*forest, *fresh, points, query, dist);
+            }
+            ++nChecks;
+
+            delete fresh;
+        }
+
+        KTINFO(testlog, "Compared " << nChecks * nQueries << " queries; " << treeData.GetSetOfPoints().size() << " points in the final window");
+    }
+
+    if (nBad != 0)
+    {
+        KTERROR(testlog, nBad << " searches differ between the forest and the fresh tree");
+        return -1;
+    }
+
+    KTINFO(testlog, "The forest matches the fresh tree");
+    return 0;
+}
@@ -0,0 +1,203 @@
+/*
+ * TestWindowedFFTPower.cc
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ *
+ *  Checks that the fused processor (KTWindowedFFTPower) gives power spectra that are bit-for-bit the same as those from the chain
+ *  KTWindower --> KTForwardFFTW --> KTConvertToPower.
+ *
+ *  Two-channel real and complex time series (noise plus a sinusoid) are run through both, for several window functions and slice sizes,
+ *  converting to power spectra and to power spectral densities.  Every bin of every spectrum has to be exactly equal, as do the binnings.
+ *
+ *  Usage: TestWindowedFFTPower
+ */
+
+#include "KTConvertToPower.hh"
+#include "KTForwardFFTW.hh"
+#include "KTFrequencySpectrumDataFFTW.hh"
+#include "KTLogger.hh"
+#include "KTPowerSpectrum.hh"
+#include "KTPowerSpectrumData.hh"
+#include "KTTimeSeriesData.hh"
+#include "KTTimeSeriesFFTW.hh"
+#include "KTTimeSeriesReal.hh"
+#include "KTWindowedFFTPower.hh"
+#include "KTWindower.hh"
+
+#include <cmath>
+#include <random>
+#include <string>
+
+using namespace std;
+using namespace Katydid;
+
+KTLOGGER(testlog, "TestWindowedFFTPower");
+
+const unsigned sNComponents = 2;
+const double sBinWidth = 1.e-8; // s
+
+// Fills the data object with the same time series each time it's called with the same seed
+void FillTimeSeries(KTTimeSeriesData& tsData, unsigned nBins, bool isReal, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::normal_distribution< double > noise(0., 1.);
+
+    tsData.SetNComponents(sNComponents);
+    for (unsigned iComponent = 0; iComponent < sNComponents; ++iComponent)
+    {
+        double freq = 1.e7 * (iComponent + 1); // Hz
+        if (isReal)
+        {
+            KTTimeSeriesReal* ts = new KTTimeSeriesReal(nBins, 0., nBins * sBinWidth);
+            for (unsigned iBin = 0; iBin < nBins; ++iBin)
+            {
+                (*ts)(iBin) = 3. * sin(2. * M_PI * freq * ts->GetBinCenter(iBin)) + noise(generator);
+            }
+            tsData.SetTimeSeries(ts, iComponent);
+        }
+        else
+        {
+            KTTimeSeriesFFTW* ts = new KTTimeSeriesFFTW(nBins, 0., nBins * sBinWidth);
+            for (unsigned iBin = 0; iBin < nBins; ++iBin)
+            {
+                double phase = 2. * M_PI * freq * ts->GetBinCenter(iBin);
+                (*ts)(iBin)[0] = 3. * cos(phase) + noise(generator);
+                (*ts)(iBin)[1] = 3. * sin(phase) + noise(generator);
+            }
+            tsData.SetTimeSeries(ts, iComponent);
+        }
+    }
+    return;
+}
+
+// Returns the number of spectra that differ
+unsigned CompareSpectra(const KTPowerSpectrumData& chainData, const KTPowerSpectrumData& fusedData)
+{
+    unsigned nBad = 0;
+    for (unsigned iComponent = 0; iComponent < sNComponents; ++iComponent)
+    {
+        const KTPowerSpectrum* chain = chainData.GetSpectrum(iComponent);
+        const KTPowerSpectrum* fused = fusedData.GetSpectrum(iComponent);
+        if (chain == NULL || fused == NULL)
+        {
+            KTERROR(testlog, "Component " << iComponent << ": missing spectrum");
+            ++nBad;
+            continue;
+        }
+        if (chain->GetNFrequencyBins() != fused->GetNFrequencyBins() || chain->GetRangeMin() != fused->GetRangeMin() ||
+                chain->GetRangeMax() != fused->GetRangeMax() || chain->GetMode() != fused->GetMode())
+        {
+            KTERROR(testlog, "Component " << iComponent << ": the binning or the mode differs\n" <<
+                    "\tChain: " << chain->GetNFrequencyBins() << " bins from " << chain->GetRangeMin() << " to " << chain->GetRangeMax() << '\n' <<
+                    "\tFused: " << fused->GetNFrequencyBins() << " bins from " << fused->GetRangeMin() << " to " << fused->GetRangeMax());
+            ++nBad;
+            continue;
+        }
+
+        unsigned nDiffBins = 0;
+        unsigned firstDiffBin = 0;
+        for (unsigned iBin = 0; iBin < chain->GetNFrequencyBins(); ++iBin)
+        {
+            if ((*chain)(iBin) != (*fused)(iBin))
+            {
+                if (nDiffBins == 0) firstDiffBin = iBin;
+                ++nDiffBins;
+            }
+        }
+        if (nDiffBins != 0)
+        {
+            KTERROR(testlog, "Component " << iComponent << ": " << nDiffBins << " bins differ; first is bin " << firstDiffBin << ": " <<
+                    (*chain)(firstDiffBin) << " (chain) vs. " << (*fused)(firstDiffBin) << " (fused)");
+            ++nBad;
+        }
+    }
+    return nBad;
+}
+
+int main()
+{
+    const string windows[] = {"rectangular", "hann", "blackman-harris"};
+    const unsigned sizes[] = {1024, 1000};
+
+    unsigned nBad = 0;
+    unsigned nComparisons = 0;
+    for (unsigned iWindow = 0; iWindow < 3; ++iWindow)
+    {
+        // the processors are reused for each case, as they would be for each slice
+        KTWindower windower;
+        KTForwardFFTW fft;
+        KTConvertToPower toPower;
+        KTWindowedFFTPower fused;
+
+        fft.SetTransformFlag("ESTIMATE");
+        fused.GetFFT().SetTransformFlag("ESTIMATE");
+        if (! windower.SelectWindowFunction(windows[iWindow]) || ! fused.SelectWindowFunction(windows[iWindow]))
+        {
+            KTERROR(testlog, "Unable to select the window function <" << windows[iWindow] << ">");
+            return -1;
+        }
+
+        for (unsigned iSize = 0; iSize < 2; ++iSize)
+        {
+            unsigned nBins = sizes[iSize];
+            for (unsigned iType = 0; iType < 2; ++iType)
+            {
+                bool isReal = iType == 0;
+                if (! (isReal ? fft.InitializeForRealTDD(nBins) : fft.InitializeForComplexTDD(nBins)))
+                {
+                    KTERROR(testlog, "Unable to initialize the FFT");
+                    return -1;
+                }
+
+                for (unsigned iPSD = 0; iPSD < 2; ++iPSD)
+                {
+                    bool toPSD = iPSD == 1;
+                    KTINFO(testlog, "Window: " << windows[iWindow] << "; size: " << nBins << "; " << (isReal ? "real" : "complex") <<
+                            " time series; " << (toPSD ? "PSD" : "PS"));
+
+                    unsigned seed = 1000 * iWindow + 100 * iSize + 10 * iType + iPSD;
+
+                    // the windower works in place, so each path gets its own copy of the time series
+                    Nymph::KTData chainData;
+                    KTTimeSeriesData& chainTS = chainData.Of< KTTimeSeriesData >();
+                    FillTimeSeries(chainTS, nBins, isReal, seed);
+
+                    Nymph::KTData fusedData;
+                    KTTimeSeriesData& fusedTS = fusedData.Of< KTTimeSeriesData >();
+                    FillTimeSeries(fusedTS, nBins, isReal, seed);
+
+                    bool chainOK = isReal ? windower.WindowDataReal(chainTS) && fft.TransformRealData(chainTS) :
+                                            windower.WindowDataFFTW(chainTS) && fft.TransformComplexData(chainTS);
+                    if (chainOK)
+                    {
+                        KTFrequencySpectrumDataFFTW& fsData = chainData.Of< KTFrequencySpectrumDataFFTW >();
+                        chainOK = toPSD ? toPower.ToPowerSpectralDensity(fsData) : toPower.ToPowerSpectrum(fsData);
+                    }
+
+                    bool fusedOK = isReal ? (toPSD ? fused.TransformRealToPSD(fusedTS) : fused.TransformRealToPS(fusedTS)) :
+                                            (toPSD ? fused.TransformComplexToPSD(fusedTS) : fused.TransformComplexToPS(fusedTS));
+
+                    if (! chainOK || ! fusedOK)
+                    {
+                        KTERROR(testlog, "Transform failed (chain: " << chainOK << "; fused: " << fusedOK << ")");
+                        ++nBad;
+                        continue;
+                    }
+
+                    nBad += CompareSpectra(chainData.Of< KTPowerSpectrumData >(), fusedData.Of< KTPowerSpectrumData >());
+                    ++nComparisons;
+                }
+            }
+        }
+    }
+
+    if (nBad != 0)
+    {
+        KTERROR(testlog, nBad << " spectra differ between the chain and the fused processor");
+        return -1;
+    }
+
+    KTINFO(testlog, "The fused processor matches the chain bit for bit in " << nComparisons << " cases");
+    return 0;
+}
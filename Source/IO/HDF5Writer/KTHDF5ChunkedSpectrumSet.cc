@@ -0,0 +1,167 @@
+/*
+ * KTHDF5ChunkedSpectrumSet.cc
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ */
+
+#include "KTHDF5ChunkedSpectrumSet.hh"
+
+#include "KTHDF5Writer.hh"
+#include "KTLogger.hh"
+
+#include <algorithm>
+#include <sstream>
+
+namespace Katydid
+{
+    KTLOGGER(publog, "KTHDF5ChunkedSpectrumSet");
+
+    KTHDF5ChunkedSpectrumSet::KTHDF5ChunkedSpectrumSet(KTHDF5Writer* writer, const std::string& name, unsigned nComponents, unsigned nParts, unsigned nBins, unsigned chunkSlices, unsigned chunkBins, bool useCompression) :
+            fName(name),
+            fNComponents(nComponents),
+            fNParts(nParts),
+            fNBins(nBins),
+            fChunkSlices(std::max(chunkSlices, 1u)),
+            fChunkBins(chunkBins == 0 ? nBins : std::min(chunkBins, nBins)),
+            fUseCompression(useCompression),
+            fFrequencies(),
+            fWriter(writer),
+            fCurrentBlock(),
+            fRecycledBlocks(),
+            fNSlicesWritten(0),
+            fComponentDataSets(),
+            fSliceNumberDataSet(),
+            fDataSetsCreated(false)
+    {
+        StartBlock();
+    }
+
+    KTHDF5ChunkedSpectrumSet::~KTHDF5ChunkedSpectrumSet()
+    {
+    }
+
+    void KTHDF5ChunkedSpectrumSet::StartBlock()
+    {
+        if (! fRecycledBlocks.TryPop(fCurrentBlock))
+        {
+            fCurrentBlock.reset(new Block());
+            fCurrentBlock->fComponents.resize(fNComponents);
+            for (unsigned iComponent = 0; iComponent < fNComponents; ++iComponent)
+            {
+                fCurrentBlock->fComponents[iComponent].resize(fChunkSlices * fNParts * fNBins);
+            }
+            fCurrentBlock->fSliceNumbers.reserve(fChunkSlices);
+        }
+        fCurrentBlock->fSliceNumbers.clear();
+        return;
+    }
+
+    void KTHDF5ChunkedSpectrumSet::CommitSlice(uint64_t sliceNumber)
+    {
+        fCurrentBlock->fSliceNumbers.push_back(sliceNumber);
+        if (fCurrentBlock->fSliceNumbers.size() == fChunkSlices)
+        {
+            fWriter->QueueBlock(this, fCurrentBlock);
+            StartBlock();
+        }
+        return;
+    }
+
+    void KTHDF5ChunkedSpectrumSet::Flush()
+    {
+        if (fCurrentBlock->fSliceNumbers.empty()) return;
+        fWriter->QueueBlock(this, fCurrentBlock);
+        StartBlock();
+        return;
+    }
+
+    void KTHDF5ChunkedSpectrumSet::RecycleBlock(BlockPtr block)
+    {
+        fRecycledBlocks.Push(block);
+        return;
+    }
+
+    bool KTHDF5ChunkedSpectrumSet::CreateDataSets()
+    {
+        fWriter->AddGroup("/spectra");
+        H5::Group* group = fWriter->AddGroup("/spectra/" + fName);
+
+        H5::DSetCreatPropList plist;
+        hsize_t chunkDims[3] = {fChunkSlices, fNParts, fChunkBins};
+        plist.setChunk(3, chunkDims);
+        if (fUseCompression) plist.setDeflate(6);
+
+        hsize_t dims[3] = {0, fNParts, fNBins};
+        hsize_t maxDims[3] = {H5S_UNLIMITED, fNParts, fNBins};
+        H5::DataSpace dataSpace(3, dims, maxDims);
+
+        fComponentDataSets.clear();
+        for (unsigned iComponent = 0; iComponent < fNComponents; ++iComponent)
+        {
+            std::stringstream dsName;
+            dsName << "component_" << iComponent;
+            fComponentDataSets.push_back(group->createDataSet(dsName.str().c_str(), H5::PredType::NATIVE_DOUBLE, dataSpace, plist));
+        }
+
+        H5::DSetCreatPropList sliceNumberPList;
+        hsize_t sliceNumberChunk[1] = {fChunkSlices};
+        sliceNumberPList.setChunk(1, sliceNumberChunk);
+        hsize_t sliceNumberDims[1] = {0};
+        hsize_t sliceNumberMaxDims[1] = {H5S_UNLIMITED};
+        H5::DataSpace sliceNumberSpace(1, sliceNumberDims, sliceNumberMaxDims);
+        fSliceNumberDataSet = group->createDataSet("slice_number", H5::PredType::NATIVE_UINT64, sliceNumberSpace, sliceNumberPList);
+
+        if (! fFrequencies.empty())
+        {
+            hsize_t freqDims[1] = {fFrequencies.size()};
+            H5::DataSpace freqSpace(1, freqDims);
+            H5::DataSet freqDataSet = group->createDataSet("frequency", H5::PredType::NATIVE_DOUBLE, freqSpace);
+            freqDataSet.write(fFrequencies.data(), H5::PredType::NATIVE_DOUBLE);
+        }
+
+        KTDEBUG(publog, "Created chunked datasets in </spectra/" << fName << ">: " << fNComponents << " components; chunks of " << fChunkSlices << " x " << fNParts << " x " << fChunkBins);
+        fDataSetsCreated = true;
+        return true;
+    }
+
+    bool KTHDF5ChunkedSpectrumSet::WriteBlock(const Block& block)
+    {
+        hsize_t nSlices = block.fSliceNumbers.size();
+        if (nSlices == 0) return true;
+
+        try
+        {
+            if (! fDataSetsCreated) CreateDataSets();
+
+            hsize_t newDims[3] = {fNSlicesWritten + nSlices, fNParts, fNBins};
+            hsize_t offset[3] = {fNSlicesWritten, 0, 0};
+            hsize_t count[3] = {nSlices, fNParts, fNBins};
+            H5::DataSpace memSpace(3, count);
+            for (unsigned iComponent = 0; iComponent < fNComponents; ++iComponent)
+            {
+                H5::DataSet& dataSet = fComponentDataSets[iComponent];
+                dataSet.extend(newDims);
+                H5::DataSpace fileSpace = dataSet.getSpace();
+                fileSpace.selectHyperslab(H5S_SELECT_SET, count, offset);
+                dataSet.write(block.fComponents[iComponent].data(), H5::PredType::NATIVE_DOUBLE, memSpace, fileSpace);
+            }
+
+            hsize_t newSliceNumberDims[1] = {fNSlicesWritten + nSlices};
+            fSliceNumberDataSet.extend(newSliceNumberDims);
+            H5::DataSpace sliceNumberFileSpace = fSliceNumberDataSet.getSpace();
+            sliceNumberFileSpace.selectHyperslab(H5S_SELECT_SET, count, offset);
+            H5::DataSpace sliceNumberMemSpace(1, count);
+            fSliceNumberDataSet.write(block.fSliceNumbers.data(), H5::PredType::NATIVE_UINT64, sliceNumberMemSpace, sliceNumberFileSpace);
+        }
+        catch (H5::Exception& e)
+        {
+            KTERROR(publog, "Unable to write spectra to </spectra/" << fName << ">: " << e.getDetailMsg());
+            return false;
+        }
+
+        fNSlicesWritten += nSlices;
+        return true;
+    }
+
+} /* namespace Katydid */
@@ -0,0 +1,113 @@
+/**
+ @file KTHDF5ChunkedSpectrumSet.hh
+ @brief Contains KTHDF5ChunkedSpectrumSet
+ @details Buffers spectra into chunk-sized blocks and appends them to extendible HDF5 datasets
+ @author: N.S. Oblath
+ @date: Oct 17, 2026
+ */
+
+#ifndef KTHDF5CHUNKEDSPECTRUMSET_HH_
+#define KTHDF5CHUNKEDSPECTRUMSET_HH_
+
+#include "KTConcurrentQueue.hh"
+#include "KTMemberVariable.hh"
+
+#include "H5Cpp.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Katydid
+{
+    class KTHDF5Writer;
+
+    /*!
+     @class KTHDF5ChunkedSpectrumSet
+     @author N.S. Oblath
+
+     @brief Buffers spectra into chunk-sized blocks and appends them to extendible HDF5 datasets
+
+     @details
+     A set holds the spectra of one type (e.g. "PS") for all components.  In the file they're stored in the group /spectra/[name]:
+     - "component_[i]": double [slice][part][bin] -- one extendible, chunked dataset per component;
+     - "slice_number": uint64 [slice] -- the slice number of each row;
+     - "frequency": double [bin] -- the bin centers.
+
+     The chunks are [chunk-slices][parts][chunk-bins].  Chunks that are long in time and narrow in frequency are efficient for reading
+     a frequency band over a whole run; chunks that span the full spectrum are efficient for reading whole spectra.
+
+     Slices are filled in memory (GetSliceBuffer() and CommitSlice()) until a block of chunk-slices slices is complete.
+     The block is then handed to the KTHDF5Writer, which writes it (WriteBlock()) either immediately or on its write thread.
+     Since a block covers whole chunks in time, each chunk is written (and compressed) once.
+
+     All HDF5 calls happen in WriteBlock(); the filling functions only touch the in-memory blocks.
+    */
+    class KTHDF5ChunkedSpectrumSet
+    {
+        public:
+            struct Block
+            {
+                /// [component][slice * nParts * nBins + part * nBins + bin]
+                std::vector< std::vector< double > > fComponents;
+                std::vector< uint64_t > fSliceNumbers;
+            };
+            typedef std::shared_ptr< Block > BlockPtr;
+
+        public:
+            KTHDF5ChunkedSpectrumSet(KTHDF5Writer* writer, const std::string& name, unsigned nComponents, unsigned nParts, unsigned nBins, unsigned chunkSlices, unsigned chunkBins, bool useCompression);
+            ~KTHDF5ChunkedSpectrumSet();
+
+            MEMBERVARIABLEREF_NOSET(std::string, Name);
+            MEMBERVARIABLE_NOSET(unsigned, NComponents);
+            MEMBERVARIABLE_NOSET(unsigned, NParts);
+            MEMBERVARIABLE_NOSET(unsigned, NBins);
+            MEMBERVARIABLE_NOSET(unsigned, ChunkSlices);
+            MEMBERVARIABLE_NOSET(unsigned, ChunkBins);
+            MEMBERVARIABLE_NOSET(bool, UseCompression);
+            MEMBERVARIABLEREF(std::vector< double >, Frequencies);
+
+            bool Matches(unsigned nComponents, unsigned nParts, unsigned nBins) const;
+
+            /// Returns the buffer for one component of the next slice: nParts * nBins values, with part i starting at i * nBins
+            double* GetSliceBuffer(unsigned component);
+            /// Completes the slice that has been filled with GetSliceBuffer(); the block is passed to the writer once it's full
+            void CommitSlice(uint64_t sliceNumber);
+            /// Passes the partially filled block (if there is one) to the writer
+            void Flush();
+
+            /// Appends a block to the datasets, creating them if needed; must only be called by the thread that's writing to the file
+            bool WriteBlock(const Block& block);
+            /// Makes a written block available to be filled again
+            void RecycleBlock(BlockPtr block);
+
+        private:
+            bool CreateDataSets();
+            void StartBlock();
+
+            KTHDF5Writer* fWriter;
+
+            BlockPtr fCurrentBlock;
+            KTConcurrentQueue< BlockPtr > fRecycledBlocks;
+
+            // only used by WriteBlock()
+            uint64_t fNSlicesWritten;
+            std::vector< H5::DataSet > fComponentDataSets;
+            H5::DataSet fSliceNumberDataSet;
+            bool fDataSetsCreated;
+    };
+
+    inline bool KTHDF5ChunkedSpectrumSet::Matches(unsigned nComponents, unsigned nParts, unsigned nBins) const
+    {
+        return nComponents == fNComponents && nParts == fNParts && nBins == fNBins;
+    }
+
+    inline double* KTHDF5ChunkedSpectrumSet::GetSliceBuffer(unsigned component)
+    {
+        return fCurrentBlock->fComponents[component].data() + fCurrentBlock->fSliceNumbers.size() * fNParts * fNBins;
+    }
+
+} /* namespace Katydid */
+
+#endif /* KTHDF5CHUNKEDSPECTRUMSET_HH_ */
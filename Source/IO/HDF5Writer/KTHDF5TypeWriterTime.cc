@@ -32,8 +32,6 @@ namespace Katydid {
             KTHDF5TypeWriter(),
             fRawTSliceDSpace(NULL),
             fRealTSliceDSpace(NULL),
-            fRawDataGroup(NULL),
-            fRealDataGroup(NULL),
             fRealTimeBuffer(NULL),
             fRawTimeBuffer(NULL)
      {}
@@ -55,7 +53,8 @@ namespace Katydid {
 
     H5::DataSet* KTHDF5TypeWriterTime::CreateRawTSDSet(const std::string& name)
     {
-        H5::Group* grp = fRawDataGroup;
+        // the writer owns its groups, and deletes them when the file is closed, so they're looked up each time
+        H5::Group* grp = fWriter->AddGroup("/raw_ts");
         H5::DSetCreatPropList plist;
         unsigned default_value = 0;
         plist.setFillValue(H5::PredType::NATIVE_UINT, &default_value);
@@ -65,7 +64,7 @@ namespace Katydid {
 
     H5::DataSet* KTHDF5TypeWriterTime::CreateRealTSDSet(const std::string& name)
     {
-        H5::Group* grp = fRealDataGroup;
+        H5::Group* grp = fWriter->AddGroup("/real_ts");
         H5::DSetCreatPropList plist;
         double default_value = 0.0;
         plist.setFillValue(H5::PredType::NATIVE_DOUBLE, &default_value);
@@ -89,7 +88,6 @@ namespace Katydid {
         {
             hsize_t dims[] = {nComponents, sliceSize};
             fRawTSliceDSpace = new H5::DataSpace(2, dims);
-            fRawDataGroup = fWriter->AddGroup("/raw_ts");
             fRawTimeBuffer = new unsigned(header.GetRawSliceSize());
         }
 
@@ -135,7 +133,6 @@ namespace Katydid {
         {
             hsize_t dims[] = {nComponents, sliceSize};
             fRealTSliceDSpace = new H5::DataSpace(2, dims);
-            fRealDataGroup = fWriter->AddGroup("/real_ts");
             fRealTimeBuffer = new double(header.GetSliceSize());
         }
 
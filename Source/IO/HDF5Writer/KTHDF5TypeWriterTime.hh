@@ -35,8 +35,6 @@ namespace Katydid {
 
             H5::DataSet* CreateRawTSDSet(const std::string &name);
             H5::DataSet* CreateRealTSDSet(const std::string &name);
-            H5::Group* fRawDataGroup;
-            H5::Group* fRealDataGroup;
 
 
             unsigned* fRawTimeBuffer;
@@ -5,6 +5,8 @@
  *      Author: J.N. Kofron
  */
 
+#include <algorithm>
+#include <cmath>
 #include <string>
 #include <sstream>
 
@@ -28,13 +30,67 @@ namespace Katydid {
 
     static Nymph::KTTIRegistrar<KTHDF5TypeWriter, KTHDF5TypeWriterTransform> sH5TWFFTReg;
 
+    namespace
+    {
+        // Fill functions for the chunked output: each writes [part][bin] for one spectrum
+
+        void FillFFTW(const KTFrequencySpectrumFFTW* spec, double* buffer, unsigned nBins)
+        {
+            double* imag = buffer + nBins;
+            for (unsigned iBin = 0; iBin < nBins; ++iBin)
+            {
+                buffer[iBin] = spec->GetReal(iBin);
+                imag[iBin] = spec->GetImag(iBin);
+            }
+            return;
+        }
+
+        void FillPolar(const KTFrequencySpectrumPolar* spec, double* buffer, unsigned nBins)
+        {
+            double* arg = buffer + nBins;
+            for (unsigned iBin = 0; iBin < nBins; ++iBin)
+            {
+                buffer[iBin] = spec->GetAbs(iBin);
+                arg[iBin] = spec->GetArg(iBin);
+            }
+            return;
+        }
+
+        void FillFFTWPower(const KTFrequencySpectrumFFTW* spec, double* buffer, unsigned nBins)
+        {
+            for (unsigned iBin = 0; iBin < nBins; ++iBin)
+            {
+                buffer[iBin] = sqrt(spec->GetReal(iBin)*spec->GetReal(iBin) + spec->GetImag(iBin)*spec->GetImag(iBin));
+            }
+            return;
+        }
+
+        void FillPolarPower(const KTFrequencySpectrumPolar* spec, double* buffer, unsigned nBins)
+        {
+            // same quantity as the unchunked polarPS output
+            for (unsigned iBin = 0; iBin < nBins; ++iBin)
+            {
+                buffer[iBin] = sqrt(spec->GetAbs(iBin)*spec->GetAbs(iBin) + spec->GetArg(iBin)*spec->GetArg(iBin));
+            }
+            return;
+        }
+
+        void FillPowerSpectrum(const KTPowerSpectrum* spec, double* buffer, unsigned nBins)
+        {
+            for (unsigned iBin = 0; iBin < nBins; ++iBin)
+            {
+                buffer[iBin] = (*spec)(iBin);
+            }
+            return;
+        }
+    }
+
     KTHDF5TypeWriterTransform::KTHDF5TypeWriterTransform() :
             KTHDF5TypeWriter(),
             fFFTBuffer(NULL),
             fFFTFreqArrayBuffer(NULL),
             fFFTDataSpace(NULL),
             fFFTFreqArrayDataSpace(NULL),
-            fSpectraGroup(NULL),
             fFFTGroup(NULL),
             fDSet(NULL),
             fDSet_FreqArray(NULL),
@@ -92,7 +148,7 @@ namespace Katydid {
         {
             SetUseCompressionFlag(true);
         }
-        fSpectraGroup = fWriter->AddGroup("/spectra");
+        fWriter->AddGroup("/spectra");
     }
 
     void KTHDF5TypeWriterTransform::PrepareHDF5File()
@@ -166,7 +222,7 @@ namespace Katydid {
 
         KTDEBUG(publog, "Creating Spectrum Dataset in HDF5 file...");
         std::string FreqArray_name ("FreqArray");
-        if (fFFTGroup == NULL)       fFFTGroup = new H5::Group(fSpectraGroup->createGroup("/spectra/spectrum"));
+        if (fFFTGroup == NULL)       fFFTGroup = new H5::Group(fWriter->AddGroup("/spectra")->createGroup("/spectra/spectrum"));
         if (fDSet_FreqArray == NULL) fDSet_FreqArray = CreateDSet(FreqArray_name, fFFTGroup, *fFFTFreqArrayDataSpace);
         if (fDSet == NULL)           fDSet = CreateDSet(fSpectrumName, fFFTGroup, *fFFTDataSpace);
 
@@ -215,6 +271,51 @@ namespace Katydid {
     }
 
 
+    template< class XSpectrumType >
+    void KTHDF5TypeWriterTransform::WriteChunkedSlice(const std::string& name, unsigned nParts, const std::vector< const XSpectrumType* >& spectra, uint64_t sliceNumber, void (*fill)(const XSpectrumType*, double*, unsigned))
+    {
+        unsigned nBins = 0;
+        for (typename std::vector< const XSpectrumType* >::const_iterator it = spectra.begin(); it != spectra.end() && nBins == 0; ++it)
+        {
+            if (*it != NULL) nBins = (*it)->size();
+        }
+        if (nBins == 0)
+        {
+            KTWARN(publog, "No spectra to write for slice " << sliceNumber);
+            return;
+        }
+
+        KTHDF5ChunkedSpectrumSet* set = fWriter->GetChunkedSpectrumSet(name, spectra.size(), nParts, nBins);
+        if (set == NULL) return;
+
+        if (set->GetFrequencies().empty())
+        {
+            const XSpectrumType* spec = *std::find_if(spectra.begin(), spectra.end(), [](const XSpectrumType* s) { return s != NULL; });
+            std::vector< double > freqs(nBins);
+            for (unsigned iBin = 0; iBin < nBins; ++iBin)
+            {
+                freqs[iBin] = spec->GetBinCenter(iBin);
+            }
+            set->SetFrequencies(freqs);
+        }
+
+        for (unsigned iC = 0; iC < spectra.size(); ++iC)
+        {
+            double* buffer = set->GetSliceBuffer(iC);
+            if (spectra[iC] != NULL && spectra[iC]->size() == nBins)
+            {
+                fill(spectra[iC], buffer, nBins);
+            }
+            else
+            {
+                KTWARN(publog, "Spectrum " << iC << " of slice " << sliceNumber << " is missing or has the wrong size; writing zeros");
+                std::fill(buffer, buffer + nParts * nBins, 0.);
+            }
+        }
+        set->CommitSlice(sliceNumber);
+        return;
+    }
+
     void KTHDF5TypeWriterTransform::WriteFrequencySpectrumDataFFTW(Nymph::KTDataPtr data)
     {
         if (!data) return;
@@ -224,6 +325,17 @@ namespace Katydid {
         fSliceNumber = data->Of<KTSliceHeader>().GetSliceNumber();
         KTDEBUG(publog, "Writing Slice " << fSliceNumber);
 
+        if (fWriter->GetUseChunkedSpectra())
+        {
+            std::vector< const KTFrequencySpectrumFFTW* > spectra(fsData.GetNComponents());
+            for (unsigned iC = 0; iC < spectra.size(); ++iC)
+            {
+                spectra[iC] = fsData.GetSpectrumFFTW(iC);
+            }
+            WriteChunkedSlice("complexFS", 2, spectra, fSliceNumber, &FillFFTW);
+            return;
+        }
+
         // Prepare HDF5 for writing
         if ( fWriter->DidParseHeader() )
         {
@@ -281,6 +393,17 @@ namespace Katydid {
         fSliceNumber = data->Of<KTSliceHeader>().GetSliceNumber();
         KTDEBUG(publog, "Writing Slice " << fSliceNumber);
 
+        if (fWriter->GetUseChunkedSpectra())
+        {
+            std::vector< const KTFrequencySpectrumPolar* > spectra(fsData.GetNComponents());
+            for (unsigned iC = 0; iC < spectra.size(); ++iC)
+            {
+                spectra[iC] = fsData.GetSpectrumPolar(iC);
+            }
+            WriteChunkedSlice("polarFS", 2, spectra, fSliceNumber, &FillPolar);
+            return;
+        }
+
         // Prepare HDF5 for writing
         if ( fWriter->DidParseHeader() )
         {
@@ -351,6 +474,17 @@ namespace Katydid {
         fSliceNumber = data->Of<KTSliceHeader>().GetSliceNumber();
         KTDEBUG(publog, "Writing Slice " << fSliceNumber);
 
+        if (fWriter->GetUseChunkedSpectra())
+        {
+            std::vector< const KTFrequencySpectrumPolar* > spectra(fsData.GetNComponents());
+            for (unsigned iC = 0; iC < spectra.size(); ++iC)
+            {
+                spectra[iC] = fsData.GetSpectrumPolar(iC);
+            }
+            WriteChunkedSlice("polarPS", 1, spectra, fSliceNumber, &FillPolarPower);
+            return;
+        }
+
         // Prepare HDF5 for writing
         if ( fWriter->DidParseHeader() )
         {
@@ -408,6 +542,17 @@ namespace Katydid {
         fSliceNumber = data->Of<KTSliceHeader>().GetSliceNumber();
         KTDEBUG(publog, "Writing Slice " << fSliceNumber);
 
+        if (fWriter->GetUseChunkedSpectra())
+        {
+            std::vector< const KTFrequencySpectrumFFTW* > spectra(fsData.GetNComponents());
+            for (unsigned iC = 0; iC < spectra.size(); ++iC)
+            {
+                spectra[iC] = fsData.GetSpectrumFFTW(iC);
+            }
+            WriteChunkedSlice("complexPS", 1, spectra, fSliceNumber, &FillFFTWPower);
+            return;
+        }
+
         // Prepare HDF5 for writing
         if ( fWriter->DidParseHeader() )
         {
@@ -484,6 +629,19 @@ namespace Katydid {
         fSliceNumber = data->Of<KTSliceHeader>().GetSliceNumber();
         KTDEBUG(publog, "Writing Slice " << fSliceNumber);
 
+        if (fWriter->GetUseChunkedSpectra())
+        {
+            std::vector< const KTPowerSpectrum* > spectra(fsData.GetNComponents());
+            for (unsigned iC = 0; iC < spectra.size(); ++iC)
+            {
+                KTPowerSpectrum* spec = fsData.GetSpectrum(iC);
+                if (spec != NULL) spec->ConvertToPowerSpectrum();
+                spectra[iC] = spec;
+            }
+            WriteChunkedSlice("PS", 1, spectra, fSliceNumber, &FillPowerSpectrum);
+            return;
+        }
+
         // Prepare HDF5 for writing
         if ( fWriter->DidParseHeader() )
         {
@@ -541,6 +699,19 @@ namespace Katydid {
         fSliceNumber = data->Of<KTSliceHeader>().GetSliceNumber();
         KTDEBUG(publog, "Writing Slice " << fSliceNumber);
 
+        if (fWriter->GetUseChunkedSpectra())
+        {
+            std::vector< const KTPowerSpectrum* > spectra(fsData.GetNComponents());
+            for (unsigned iC = 0; iC < spectra.size(); ++iC)
+            {
+                KTPowerSpectrum* spec = fsData.GetSpectrum(iC);
+                if (spec != NULL) spec->ConvertToPowerSpectralDensity();
+                spectra[iC] = spec;
+            }
+            WriteChunkedSlice("PSD", 1, spectra, fSliceNumber, &FillPowerSpectrum);
+            return;
+        }
+
         // Prepare HDF5 for writing
         if ( fWriter->DidParseHeader() )
         {
@@ -23,6 +23,14 @@ etc...
 Inputs:
 output-file: full path with name for output file.  Preferred extension is h5.
 use-compression: true or false (default: false).  Uses the built-in hdf5 compression.
+chunked-spectra: true or false (default: false).  Instead of the layout above, each spectrum type is appended to
+    /spectra/<name>/component_<i> ([slice][part][bin]), with the slice numbers in /spectra/<name>/slice_number
+    and the bin centers in /spectra/<name>/frequency.  Spectra are buffered and written a whole chunk at a time.
+    The names are the same as the dataset names above (complexFS, polarFS, polarPS, complexPS, PS, PSD).
+chunk-slices: number of slices in each chunk (default: 64).
+chunk-bins: number of frequency bins in each chunk; 0 for the whole spectrum (default: 0).
+async-write: true or false (default: true).  Write the chunks on a separate thread.
+max-queued-chunks: number of chunks that can wait to be written before processing blocks (default: 8).
 
 Example:
     ...
@@ -56,6 +64,8 @@ Example:
 
 #include "boost/multi_array.hpp"
 
+#include <vector>
+
 namespace Katydid
 {
 
@@ -131,6 +141,10 @@ namespace Katydid
         typedef boost::multi_array<double, 1> freq_buffer;
     	H5::DataSet* CreateDSet(const std::string& name, const H5::Group* grp, const H5::DataSpace& ds);
 
+        /// Copies one slice of spectra into the writer's chunked set for that spectrum type; fill() writes nParts * nBins values for one spectrum
+        template< class XSpectrumType >
+        void WriteChunkedSlice(const std::string& name, unsigned nParts, const std::vector< const XSpectrumType* >& spectra, uint64_t sliceNumber, void (*fill)(const XSpectrumType*, double*, unsigned));
+
     	unsigned fNChannels;
         unsigned fNParts;
         unsigned fNumberOfSlices;
@@ -138,7 +152,6 @@ namespace Katydid
         unsigned fSliceNumber;
         std::string fSpectrumName;
 
-        H5::Group* fSpectraGroup;
     	H5::Group* fFFTGroup;
         H5::DataSet* fDSet;
         H5::DataSet* fDSet_FreqArray;
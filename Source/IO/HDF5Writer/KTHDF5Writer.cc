@@ -29,8 +29,20 @@ namespace Katydid
             fHeaderSlot("header", this, &KTHDF5Writer::WriteEggHeader),
             fFilename("my_file.h5"),
             fUseCompressionFlag(false),
+            fUseChunkedSpectra(false),
+            fChunkSlices(64),
+            fChunkBins(0),
+            fUseWriteThread(true),
+            fMaxQueuedBlocks(8),
             fFile(NULL),
-            fHeaderParsed(false)
+            fHeaderParsed(false),
+            fGroups(),
+            fChunkedSets(),
+            fWriteQueue(),
+            fWriteThread(),
+            fNPendingWrites(0),
+            fPendingMutex(),
+            fPendingDone()
     {
         RegisterSlot("close-file", this, &KTHDF5Writer::CloseFile);
     }
@@ -47,6 +59,11 @@ namespace Katydid
         {
             SetFilename(node->get_value("output-file", fFilename));
             SetUseCompressionFlag(node->get_value("use-compression", fUseCompressionFlag));
+            SetUseChunkedSpectra(node->get_value("chunked-spectra", fUseChunkedSpectra));
+            SetChunkSlices(node->get_value("chunk-slices", fChunkSlices));
+            SetChunkBins(node->get_value("chunk-bins", fChunkBins));
+            SetUseWriteThread(node->get_value("async-write", fUseWriteThread));
+            SetMaxQueuedBlocks(node->get_value("max-queued-chunks", fMaxQueuedBlocks));
         }
 
         // Command-line settings
@@ -57,6 +74,7 @@ namespace Katydid
 
     bool KTHDF5Writer::OpenAndVerifyFile()
     {
+        WaitForPendingWrites();
         if (fFile == NULL) {
             fFile = OpenFile(fFilename);
         }
@@ -92,6 +110,24 @@ namespace Katydid
 
     void KTHDF5Writer::CloseFile()
     {
+        // write out whatever is still buffered before the file goes away
+        for (std::map< std::string, KTHDF5ChunkedSpectrumSet* >::iterator it = fChunkedSets.begin(); it != fChunkedSets.end(); ++it)
+        {
+            it->second->Flush();
+        }
+        StopWriteThread();
+        for (std::map< std::string, KTHDF5ChunkedSpectrumSet* >::iterator it = fChunkedSets.begin(); it != fChunkedSets.end(); ++it)
+        {
+            delete it->second;
+        }
+        fChunkedSets.clear();
+
+        for (std::map< std::string, H5::Group* >::iterator it = fGroups.begin(); it != fGroups.end(); ++it)
+        {
+            delete it->second;
+        }
+        fGroups.clear();
+
         if (fFile != NULL) {
             KTINFO(publog, "HDF5 data written to file <" << fFilename << ">; closing file");
             delete fFile;
@@ -102,6 +138,7 @@ namespace Katydid
 
     H5::Group* KTHDF5Writer::AddGroup(const std::string& groupname)
     {
+        WaitForPendingWrites();
         std::map<std::string, H5::Group*>::iterator it;
         H5::Group* result;
         if ( (it = fGroups.find(groupname)) == fGroups.end() )
@@ -152,6 +189,7 @@ namespace Katydid
     }
 
     void KTHDF5Writer::WriteScalar(std::string name, H5::DataType type, const void* value) {
+        WaitForPendingWrites();
         std::string group_name;
         std::stringstream group_name_builder;
         group_name_builder << "/";
@@ -183,6 +221,103 @@ namespace Katydid
         dset->write(value, type);
     }
 
+    KTHDF5ChunkedSpectrumSet* KTHDF5Writer::GetChunkedSpectrumSet(const std::string& name, unsigned nComponents, unsigned nParts, unsigned nBins)
+    {
+        // Once the file is open, buffering a slice doesn't touch the file, so it doesn't wait for the write thread;
+        // anything that accesses the file directly (OpenAndVerifyFile(), AddGroup(), WriteScalar()) waits instead
+        if (fFile == NULL && ! OpenAndVerifyFile()) return NULL;
+
+        std::map< std::string, KTHDF5ChunkedSpectrumSet* >::iterator it = fChunkedSets.find(name);
+        if (it != fChunkedSets.end())
+        {
+            if (! it->second->Matches(nComponents, nParts, nBins))
+            {
+                KTERROR(publog, "Spectra for <" << name << "> have changed size: " << nComponents << " x " << nParts << " x " << nBins << " (was " <<
+                        it->second->GetNComponents() << " x " << it->second->GetNParts() << " x " << it->second->GetNBins() << ")");
+                return NULL;
+            }
+            return it->second;
+        }
+
+        KTDEBUG(publog, "Creating chunked spectrum set <" << name << ">");
+        KTHDF5ChunkedSpectrumSet* set = new KTHDF5ChunkedSpectrumSet(this, name, nComponents, nParts, nBins, fChunkSlices, fChunkBins, fUseCompressionFlag);
+        fChunkedSets[name] = set;
+        return set;
+    }
+
+    void KTHDF5Writer::QueueBlock(KTHDF5ChunkedSpectrumSet* set, KTHDF5ChunkedSpectrumSet::BlockPtr block)
+    {
+        if (! fUseWriteThread)
+        {
+            set->WriteBlock(*block);
+            set->RecycleBlock(block);
+            return;
+        }
+
+        if (! fWriteThread.joinable()) StartWriteThread();
+
+        std::unique_lock< std::mutex > lock(fPendingMutex);
+        ++fNPendingWrites;
+        lock.unlock();
+
+        WriteRequest request = {set, block};
+        fWriteQueue->Push(request);
+        return;
+    }
+
+    void KTHDF5Writer::WaitForPendingWrites()
+    {
+        if (! fWriteThread.joinable() || std::this_thread::get_id() == fWriteThread.get_id()) return;
+
+        std::unique_lock< std::mutex > lock(fPendingMutex);
+        while (fNPendingWrites != 0)
+        {
+            fPendingDone.wait(lock);
+        }
+        return;
+    }
+
+    void KTHDF5Writer::StartWriteThread()
+    {
+        KTDEBUG(publog, "Starting the HDF5 write thread");
+        fWriteQueue.reset(new KTConcurrentQueue< WriteRequest >(fMaxQueuedBlocks));
+        // the new thread waits for this lock, so that fWriteThread is assigned before it can check its own ID in WaitForPendingWrites()
+        std::unique_lock< std::mutex > lock(fPendingMutex);
+        fWriteThread = std::thread(&KTHDF5Writer::WriteLoop, this);
+        return;
+    }
+
+    void KTHDF5Writer::StopWriteThread()
+    {
+        if (! fWriteThread.joinable()) return;
+
+        fWriteQueue->Close();
+        fWriteThread.join();
+        fWriteQueue.reset();
+        KTDEBUG(publog, "HDF5 write thread has finished");
+        return;
+    }
+
+    void KTHDF5Writer::WriteLoop()
+    {
+        std::unique_lock< std::mutex > startLock(fPendingMutex);
+        startLock.unlock();
+
+        WriteRequest request;
+        while (fWriteQueue->Pop(request))
+        {
+            request.fSet->WriteBlock(*request.fBlock);
+            request.fSet->RecycleBlock(request.fBlock);
+            request.fBlock.reset();
+
+            std::unique_lock< std::mutex > lock(fPendingMutex);
+            --fNPendingWrites;
+            lock.unlock();
+            fPendingDone.notify_all();
+        }
+        return;
+    }
+
     bool KTHDF5Writer::DidParseHeader()
     {
         return fHeaderParsed;
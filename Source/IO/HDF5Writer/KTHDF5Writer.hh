@@ -8,10 +8,17 @@
 #ifndef KTHDF5WRITER_HH_
 #define KTHDF5WRITER_HH_
 
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <set>
+#include <thread>
 
+#include "KTConcurrentQueue.hh"
 #include "KTEggHeader.hh"
+#include "KTHDF5ChunkedSpectrumSet.hh"
 #include "KTWriter.hh"
 #include "KTMemberVariable.hh"
 #include "KTSlot.hh"
@@ -22,6 +29,36 @@ namespace Katydid
     class KTHDF5Writer;
     typedef Nymph::KTDerivedTypeWriter< KTHDF5Writer > KTHDF5TypeWriter;
 
+    /*!
+     @class KTHDF5Writer
+     @author J.N. Kofron, N.S. Oblath
+
+     @brief Writes data to an HDF5 file
+
+     @details
+     By default each spectrum is written to its own dataset.  With "chunked-spectra" enabled, spectra of each type are instead
+     appended to extendible, chunked datasets (see KTHDF5ChunkedSpectrumSet).  The spectra are buffered in memory until a whole
+     block of "chunk-slices" slices is available; full blocks are written either directly or, with "async-write", on a separate
+     write thread so that the processing chain doesn't wait on the file.
+
+     The HDF5 library is not used from more than one thread at a time: before any other access to the file, the writer
+     waits for the write thread to finish the blocks that have been queued.
+
+     Configuration name: "hdf5-writer"
+
+     Available configuration values:
+     - "output-file": string -- output filename
+     - "use-compression": bool -- compress the chunked spectrum datasets
+     - "chunked-spectra": bool -- write spectra to chunked, extendible datasets (default: false)
+     - "chunk-slices": unsigned -- number of slices in each chunk (default: 64)
+     - "chunk-bins": unsigned -- number of frequency bins in each chunk; 0 means the whole spectrum (default: 0)
+     - "async-write": bool -- write full blocks on a separate thread (default: true)
+     - "max-queued-chunks": unsigned -- number of blocks that can wait for the write thread before the processing chain is blocked (default: 8)
+
+     Slots:
+     - "header": void (KTEggHeader*) -- writes the egg header
+     - "close-file": void () -- flushes buffered spectra and closes the file
+    */
     class KTHDF5Writer : public Nymph::KTWriterWithTypists< KTHDF5Writer, KTHDF5TypeWriter >
     {
         public:
@@ -41,8 +78,35 @@ namespace Katydid
             MEMBERVARIABLEREF(std::string, Filename);
             MEMBERVARIABLEREF(bool, UseCompressionFlag);
 
+            MEMBERVARIABLE(bool, UseChunkedSpectra);
+            MEMBERVARIABLE(unsigned, ChunkSlices);
+            MEMBERVARIABLE(unsigned, ChunkBins);
+            MEMBERVARIABLE(bool, UseWriteThread);
+            MEMBERVARIABLE(unsigned, MaxQueuedBlocks);
+
+            /*
+             Opens the file if needed.  Also waits for the write thread to finish what's been queued, since callers access the file directly afterwards.
+            */
             bool OpenAndVerifyFile();
 
+            /*
+             Returns the chunked set for spectra of the given name, creating it if needed.
+             Returns NULL if the file can't be opened, or if the dimensions don't match those of an existing set.
+             Once the file is open, this does not wait for the write thread.
+            */
+            KTHDF5ChunkedSpectrumSet* GetChunkedSpectrumSet(const std::string& name, unsigned nComponents, unsigned nParts, unsigned nBins);
+
+            /*
+             Writes a full block of a chunked set, either immediately or on the write thread.
+            */
+            void QueueBlock(KTHDF5ChunkedSpectrumSet* set, KTHDF5ChunkedSpectrumSet::BlockPtr block);
+
+            /*
+             Blocks until the write thread has written everything that's been queued.
+             Has no effect when called from the write thread itself.
+            */
+            void WaitForPendingWrites();
+
             /*
              Adds a new group to the HDF5 file.  If the group already exists,
              this is a no-op.
@@ -72,6 +136,23 @@ namespace Katydid
             bool fHeaderParsed;
             std::map<std::string, H5::Group*> fGroups;
             void WriteScalar(std::string name, H5::DataType type, const void* value);
+
+            std::map< std::string, KTHDF5ChunkedSpectrumSet* > fChunkedSets;
+
+            struct WriteRequest
+            {
+                KTHDF5ChunkedSpectrumSet* fSet;
+                KTHDF5ChunkedSpectrumSet::BlockPtr fBlock;
+            };
+            void StartWriteThread();
+            void StopWriteThread();
+            void WriteLoop();
+
+            std::unique_ptr< KTConcurrentQueue< WriteRequest > > fWriteQueue;
+            std::thread fWriteThread;
+            unsigned fNPendingWrites;
+            std::mutex fPendingMutex;
+            std::condition_variable fPendingDone;
     };
 
     template<>
@@ -10,6 +10,7 @@
 #include "KTFrequencySpectrumDataPolar.hh"
 #include "KTFrequencySpectrumDataFFTW.hh"
 #include "KTPowerSpectrumData.hh"
+#include "KTSpectrogramData.hh"
 
 //#include "KTLogger.hh"
 
@@ -27,7 +28,8 @@ namespace Katydid
             fFSPolarBundle("FSPolarSpectrogram"),
             fFSFFTWBundle("FSFFTWSpectrogram"),
             fPowerBundle("PowerSpectrogram"),
-            fPSDBundle("PSDSpectrogram")
+            fPSDBundle("PSDSpectrogram"),
+            fSpectrogramBundle("DenseSpectrogram")
     {
     }
 
@@ -44,6 +46,7 @@ namespace Katydid
         OutputASpectrogramSet(fFSFFTWBundle, false);
         OutputASpectrogramSet(fPowerBundle, false);
         OutputASpectrogramSet(fPSDBundle, false);
+        OutputASpectrogramSet(fSpectrogramBundle, false);
 
         return;
     }
@@ -54,6 +57,7 @@ namespace Katydid
         ClearASpectrogramSet(fFSFFTWBundle);
         ClearASpectrogramSet(fPowerBundle);
         ClearASpectrogramSet(fPSDBundle);
+        ClearASpectrogramSet(fSpectrogramBundle);
         return;
     }
 
@@ -63,6 +67,7 @@ namespace Katydid
         fWriter->RegisterSlot("fs-fftw", this, &KTROOTSpectrogramTypeWriterTransform::AddFrequencySpectrumDataFFTW);
         fWriter->RegisterSlot("ps", this, &KTROOTSpectrogramTypeWriterTransform::AddPowerSpectrumData);
         fWriter->RegisterSlot("psd", this, &KTROOTSpectrogramTypeWriterTransform::AddPSDData);
+        fWriter->RegisterSlot("spectrogram", this, &KTROOTSpectrogramTypeWriterTransform::AddSpectrogramData);
         return;
     }
 
@@ -99,4 +104,46 @@ namespace Katydid
         return;
     }
 
+    //*****************
+    // Spectrogram Data
+    //*****************
+
+    void KTROOTSpectrogramTypeWriterTransform::AddSpectrogramData(Nymph::KTDataPtr data)
+    {
+        KTDEBUG(publog_rsw, "Adding spectrogram data");
+        KTSliceHeader& sliceHeader = data->Of< KTSliceHeader >();
+        KTSpectrogramData& sgData = data->Of< KTSpectrogramData >();
+        unsigned nComponents = sgData.GetNComponents();
+        if (nComponents == 0 || sgData.GetSpectrogram(0) == NULL) return;
+
+        // each time bin (row) of the spectrogram is treated like a slice
+        const KTAxisProperties< 1 >& timeAxis = sgData.GetSpectrogram(0)->GetTimeAxis();
+        double sliceLength = timeAxis.GetBinWidth();
+        unsigned nRows = sgData.GetSpectrogram(0)->GetNTimeBins();
+        for (unsigned iRow = 0; iRow < nRows; ++iRow)
+        {
+            double timeInRun = timeAxis.GetBinLowEdge(iRow);
+            bool isNewAcq = iRow == 0 && sliceHeader.GetIsNewAcquisition();
+            if (fWriter->GetMode() != KTROOTSpectrogramWriter::kSequential && (timeInRun + sliceLength < fWriter->GetMinTime() || timeInRun > fWriter->GetMaxTime())) continue;
+
+            int iSpectTimeBin = KTROOTSpectrogramTypeWriter::UpdateSpectrograms(sgData, nComponents, timeInRun, sliceLength, isNewAcq, fSpectrogramBundle);
+            if (iSpectTimeBin <= 0) return;
+
+            for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
+            {
+                const double* row = sgData.GetSpectrogram(iComponent)->GetRowData(iRow);
+                TH2D* spectrogram = fSpectrogramBundle.fSpectrograms[iComponent].fSpectrogram;
+                unsigned iSpectFreqBin = 0;
+                if (iSpectTimeBin > spectrogram->GetNbinsX()) continue;
+                for (unsigned iFreqBin = fSpectrogramBundle.fSpectrograms[iComponent].fFirstFreqBin; iFreqBin <= fSpectrogramBundle.fSpectrograms[iComponent].fLastFreqBin; ++iFreqBin)
+                {
+                    spectrogram->SetBinContent(iSpectTimeBin, iSpectFreqBin + 1, row[iFreqBin]);
+                    ++iSpectFreqBin;
+                }
+            }
+        }
+
+        return;
+    }
+
 } /* namespace Katydid */
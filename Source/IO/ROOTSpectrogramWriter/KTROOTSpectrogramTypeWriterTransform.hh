@@ -30,11 +30,14 @@ namespace Katydid
 
             void AddPSDData(Nymph::KTDataPtr data);
 
+            void AddSpectrogramData(Nymph::KTDataPtr data);
+
         private:
             DataTypeBundle fFSPolarBundle;
             DataTypeBundle fFSFFTWBundle;
             DataTypeBundle fPowerBundle;
             DataTypeBundle fPSDBundle;
+            DataTypeBundle fSpectrogramBundle;
 
         public:
             void OutputSpectrograms();
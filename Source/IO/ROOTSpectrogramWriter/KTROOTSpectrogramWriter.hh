@@ -110,6 +110,7 @@ namespace Katydid
      - "fs-polar": void (Nymph::KTDataPtr) -- Contribute a slice to a FS-polar spectrogram.  Requires KTFrequencySpectrumDataPolar.
      - "ps": void (Nymph::KTDataPtr) -- Contribute a slice to a power spectrogram.  Requires KTPowerSpectrumData.
      - "psd": void (Nymph::KTDataPtr) -- Contribute a slice to a PSD spectrogram.  Requires KTPowerSpectrumData.
+     - "spectrogram": void (Nymph::KTDataPtr) -- Contribute all of the time bins of a dense spectrogram (e.g. stripes with no overlap) to a spectrogram.  Requires KTSliceHeader and KTSpectrogramData.
      - "agg-ps": void (Nymph::KTDataPtr) -- Contribute a slice to a power spectrogram.  Requires KTPowerSpectrumData.
      - "agg-psd": void (Nymph::KTDataPtr) -- Contribute a slice to a PSD spectrogram.  Requires KTPowerSpectrumData.
      - "proc-track": void (Nymph::KTDataPtr) -- Contribute a line representing a track; all lines will be written to the root file together, and can be drawn on top of a spectrogram.  Requires KTProcessedTrackData.
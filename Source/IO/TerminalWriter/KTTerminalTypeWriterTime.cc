@@ -241,6 +241,15 @@ namespace Katydid
         KTPROG(termlog, "\tNumber of slices processed: " << summary->GetNSlicesProcessed());
         KTPROG(termlog, "\tNumber of records processed: " << summary->GetNRecordsProcessed());
         KTPROG(termlog, "\tIntegrated time processed: " << summary->GetIntegratedTime());
+        if (summary->GetReadStallTime() > 0. || summary->GetMeanReadQueueDepth() > 0.)
+        {
+            KTPROG(termlog, "\tTime spent waiting for read-ahead: " << summary->GetReadStallTime() << " s");
+            KTPROG(termlog, "\tMean read-ahead queue depth: " << summary->GetMeanReadQueueDepth() << " records");
+        }
+        if (summary->GetNRecordCacheHits() > 0 || summary->GetNRecordCacheMisses() > 0)
+        {
+            KTPROG(termlog, "\tRecord reads from the reader's cache: " << summary->GetNRecordCacheHits() << "; from the file: " << summary->GetNRecordCacheMisses());
+        }
 
         return;
     }
@@ -35,20 +35,14 @@ namespace Katydid
     
     bool KTAggregatedChannelOptimizer::FindOptimumSum(KTAggregatedFrequencySpectrumDataFFTW& aggData)
     {
-        const KTFrequencySpectrumFFTW* freqSpectrum=aggData.GetSpectrumFFTW(0);
-        // Get the number of frequency bins from the first component of aggData
-        int nFreqBins=freqSpectrum->GetNFrequencyBins();
-        int nGridPoints=aggData.GetNComponents(); // Get number of components
+        // The maximum summed voltage of each grid point is filled in by the aggregator, so the spectra themselves aren't needed
+        int nGridPoints=aggData.GetNGridPoints();
         
-        int maxGridPoint=0.0;
+        int maxGridPoint=0;
         double maxVoltage=0.0;
-        // Loop over each component and find and save the maximum summed absolute voltages and the corresponding frequencies
-        for (unsigned iGridPoint=0; iGridPoint<nGridPoints; ++iGridPoint)
+        // Loop over each grid point and find the one with the maximum summed absolute voltage
+        for (int iGridPoint=0; iGridPoint<nGridPoints; ++iGridPoint)
         {
-            double gridLocationX;
-            double gridLocationY;
-            freqSpectrum=aggData.GetSpectrumFFTW(iGridPoint);
-            aggData.GetGridPoint(iGridPoint,gridLocationX,gridLocationY);
             double maxVoltageFreq=aggData.GetSummedGridVoltage(iGridPoint);
             
             if(maxVoltageFreq>maxVoltage)
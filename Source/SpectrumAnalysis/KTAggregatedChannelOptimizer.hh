@@ -31,6 +31,7 @@ namespace Katydid
      @brief Finds the point that optimizes the aggreagted channels
      
      @details
+     Uses the maximum summed voltage of each grid point, as filled in by KTChannelAggregator, so the summed spectra don't need to be stored.
      
      Slots:
      - "agg-fft": void (Nymph::KTDataPtr) -- Finds the point that optimizes the aggreagted channels; Requires KTAggregatedFrequencySpectrumDataFFTW;Finds the point that optimizes the aggreagted channels ; Emits signal "fft"
@@ -16,6 +16,12 @@
 #include "KTNormalizedFSData.hh"
 #include "KTWignerVilleData.hh"
 
+#include <cmath>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
 using std::string;
 using std::vector;
 
@@ -39,13 +45,14 @@ namespace Katydid
             fDistMin(0.),
             fDistMax(1.),
             fUseBuffer(true),
+            fNThreads(0),
             fTakeValuesPolar(&KTAmplitudeDistributor::TakeValuesToBuffer),
             fTakeValuesFFTW(&KTAmplitudeDistributor::TakeValuesToBuffer),
             fInvDistBinWidth(1.),
             fNFreqBins(1),
             fNComponents(1),
-            fBuffer(),
-            fNBuffered(0),
+            fMagnitudes(),
+            fBuffering(false),
             fNSlicesProcessed(0),
             fDistributionData(Nymph::KTDataPtr()),
             fDistributions(NULL),
@@ -104,6 +111,8 @@ namespace Katydid
             SetDistMax(node->get_value< double >("dist-max"));
         }
 
+        SetNThreads(node->get_value< unsigned >("n-threads", fNThreads));
+
         return true;
     }
 
@@ -114,21 +123,37 @@ namespace Katydid
 
         fNSlicesProcessed = 0;
 
-        fBuffer.clear();
+        if (fMaxBin >= fNFreqBins)
+        {
+            KTWARN(adlog, "Maximum bin (" << fMaxBin << ") is past the end of the spectrum; it will be set to " << fNFreqBins - 1);
+            SetMaxBin(fNFreqBins - 1);
+        }
+        if (fMinBin > fMaxBin)
+        {
+            KTERROR(adlog, "Minimum bin (" << fMinBin << ") is larger than the maximum bin (" << fMaxBin << ")");
+            return false;
+        }
+        if (fUseBuffer && fBufferSize == 0)
+        {
+            KTERROR(adlog, "Buffer use was requested, but the buffer size is 0");
+            return false;
+        }
+
+        fMagnitudes.assign(fNFreqBins, 0.);
+
+        fDistributionData.reset(new Nymph::KTData());
+
+        fDistributions = &(fDistributionData->Of< KTAmplitudeDistribution >());
         if (fUseBuffer)
         {
-            // This command initializes the nested vectors with the correct number of elements
-            // It's assumed that fBufferSize is set before this function is called.
-            fBuffer.resize(fBufferSize);
-            for (unsigned iBuffer = 0; iBuffer < fBufferSize; iBuffer++)
+            // The buffered values are kept in the distributions' storage until the distribution ranges are known
+            if (! fDistributions->InitializeBuffer(fNComponents, fNFreqBins, fDistNBins, fDistMin, fDistMax, fBufferSize))
             {
-                fBuffer[iBuffer].resize(nComponents);
-                for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
-                {
-                    fBuffer[iBuffer][iComponent].resize(fNFreqBins);
-                }
+                KTERROR(adlog, "Unable to initialize the buffer");
+                fDistributions = NULL;
+                return false;
             }
-            fNBuffered = 0;
+            fBuffering = true;
 
             // Set the TakeValues function pointers
             fTakeValuesPolar = &KTAmplitudeDistributor::TakeValuesToBuffer;
@@ -137,21 +162,20 @@ namespace Katydid
         }
         else
         {
+            if (! fDistributions->InitializeNew(fNComponents, fNFreqBins, fDistNBins, fDistMin, fDistMax))
+            {
+                KTERROR(adlog, "Unable to initialize the distributions");
+                fDistributions = NULL;
+                return false;
+            }
+            fBuffering = false;
+
             // Set the TakeValues function pointers
             fTakeValuesPolar = &KTAmplitudeDistributor::TakeValuesToDistributions;
             fTakeValuesFFTW = &KTAmplitudeDistributor::TakeValuesToDistributions;
             KTDEBUG(adlog, "Function pointers set to take values to distributions");
         }
 
-        fDistributionData.reset(new Nymph::KTData());
-
-        fDistributions = &(fDistributionData->Of< KTAmplitudeDistribution >());
-        if (! fUseBuffer)
-        {
-            // In the case that the buffer is being used, fDistributions will be initialized to the correct size later
-            fDistributions->InitializeNew(fNComponents, fNFreqBins, fDistNBins, fDistMin, fDistMax);
-        }
-
         return true;
     }
 
@@ -292,24 +316,18 @@ namespace Katydid
             }
             KTDEBUG(adlog, "Continuing with direct-to-distribution processing");
             fTakeValuesPolar = &KTAmplitudeDistributor::TakeValuesToDistributions;
+            fTakeValuesFFTW = &KTAmplitudeDistributor::TakeValuesToDistributions;
             return TakeValuesToDistributions(spectrum, component);
         }
 
-        for (unsigned iBin = fMinBin; iBin <= fMaxBin; iBin++)
-        {
-            fBuffer[fNSlicesProcessed][component][iBin] = (*spectrum)(iBin).abs();
-        }
-        fNBuffered++;
-        KTDEBUG(adlog, "Buffer now contains " << fNBuffered << " distributions; " << fNSlicesProcessed + 1 << " slices processed");
+        TakeValues(spectrum, component, true);
+        KTDEBUG(adlog, "Buffer now contains " << fNSlicesProcessed + 1 << " slices");
         return true;
     }
 
     bool KTAmplitudeDistributor::TakeValuesToDistributions(const KTFrequencySpectrumPolar* spectrum, unsigned component)
     {
-        for (unsigned iBin = fMinBin; iBin <= fMaxBin; iBin++)
-        {
-            fDistributions->AddToDist(iBin, (*spectrum)(iBin).abs(), component);
-        }
+        TakeValues(spectrum, component, false);
         return true;
     }
 
@@ -326,88 +344,97 @@ namespace Katydid
             }
             KTDEBUG(adlog, "Continuing with direct-to-distribution processing");
             fTakeValuesPolar = &KTAmplitudeDistributor::TakeValuesToDistributions;
+            fTakeValuesFFTW = &KTAmplitudeDistributor::TakeValuesToDistributions;
             return TakeValuesToDistributions(spectrum, component);
         }
 
-        for (unsigned iBin = fMinBin; iBin <= fMaxBin; iBin++)
-        {
-            fBuffer[fNSlicesProcessed][component][iBin] = sqrt((*spectrum)(iBin)[0]*(*spectrum)(iBin)[0] + (*spectrum)(iBin)[1]*(*spectrum)(iBin)[1]);
-        }
-        fNBuffered++;
-        KTDEBUG(adlog, "Buffer now contains " << fNBuffered << " distributions; " << fNSlicesProcessed + 1 << " slices processed");
+        TakeValues(spectrum, component, true);
+        KTDEBUG(adlog, "Buffer now contains " << fNSlicesProcessed + 1 << " slices");
         return true;
     }
 
     bool KTAmplitudeDistributor::TakeValuesToDistributions(const KTFrequencySpectrumFFTW* spectrum, unsigned component)
     {
-        for (unsigned iBin = fMinBin; iBin <= fMaxBin; iBin++)
-        {
-            fDistributions->AddToDist(iBin, sqrt((*spectrum)(iBin)[0]*(*spectrum)(iBin)[0] + (*spectrum)(iBin)[1]*(*spectrum)(iBin)[1]), component);
-        }
+        TakeValues(spectrum, component, false);
         return true;
     }
 
-
-    bool KTAmplitudeDistributor::CreateDistributionsFromBuffer()
+    template< class XSpectrum >
+    void KTAmplitudeDistributor::TakeValues(const XSpectrum* spectrum, unsigned component, bool toBuffer)
     {
-        if (fBuffer.size() == 0)
+        // The frequency range is split into contiguous blocks, one per thread; each thread calculates the magnitudes for its block
+        // and adds them to the buffer or distributions.  Each frequency bin has its own row in the storage, so the threads don't write to the same places.
+        unsigned nBins = fMaxBin - fMinBin + 1;
+#ifdef USE_OPENMP
+        unsigned nThreads = fNThreads > 0 ? fNThreads : omp_get_max_threads();
+#else
+        unsigned nThreads = 1;
+#endif
+        unsigned maxThreads = (nBins + sMinBinsPerThread - 1) / sMinBinsPerThread;
+        if (nThreads > maxThreads) nThreads = maxThreads;
+        unsigned binsPerThread = (nBins + nThreads - 1) / nThreads;
+
+#pragma omp parallel for num_threads(nThreads) schedule(static, 1)
+        for (unsigned iThread = 0; iThread < nThreads; ++iThread)
         {
-            KTERROR(adlog, "Buffer is empty, but buffer use was requested");
-            return false;
+            unsigned firstBin = fMinBin + iThread * binsPerThread;
+            if (firstBin > fMaxBin) continue;
+            unsigned nBlockBins = fMaxBin + 1 - firstBin < binsPerThread ? fMaxBin + 1 - firstBin : binsPerThread;
+
+            double* magnitudes = &fMagnitudes[firstBin];
+            CalculateMagnitudes(spectrum, firstBin, nBlockBins, magnitudes);
+            if (toBuffer)
+            {
+                fDistributions->AddToBuffer(magnitudes, firstBin, nBlockBins, fNSlicesProcessed, component);
+            }
+            else
+            {
+                fDistributions->AddToDists(magnitudes, firstBin, nBlockBins, component);
+            }
         }
+        return;
+    }
 
-        KTDEBUG(adlog, "Initializing NULL distributions: " << fNComponents << " components with " << fNFreqBins << " frequency bins");
-        fDistributions->InitializeNull(fNComponents, fNFreqBins);
-        if (fDistributions->GetNComponents() != fNComponents)
+    void KTAmplitudeDistributor::CalculateMagnitudes(const KTFrequencySpectrumPolar* spectrum, unsigned firstBin, unsigned nBins, double* magnitudes)
+    {
+        const complexpolar< double >* values = spectrum->GetData() + firstBin;
+        for (unsigned iBin = 0; iBin < nBins; ++iBin)
         {
-            KTERROR(adlog, "The distributions data doesn't have the correct number of components: " << fDistributions->GetNComponents());
-            return false;
+            magnitudes[iBin] = values[iBin].abs();
         }
-        if (fDistributions->GetNFreqBins() != fNFreqBins)
+        return;
+    }
+
+    void KTAmplitudeDistributor::CalculateMagnitudes(const KTFrequencySpectrumFFTW* spectrum, unsigned firstBin, unsigned nBins, double* magnitudes)
+    {
+        const fftw_complex* values = spectrum->GetData() + firstBin;
+#pragma omp simd
+        for (unsigned iBin = 0; iBin < nBins; ++iBin)
         {
-            KTERROR(adlog, "The distributions data doesn't have the correct number of frequency bins: " << fDistributions->GetNFreqBins());
-            return false;
+            magnitudes[iBin] = sqrt(values[iBin][0] * values[iBin][0] + values[iBin][1] * values[iBin][1]);
         }
+        return;
+    }
 
-        if (fBuffer.size() > fNSlicesProcessed)
+
+    bool KTAmplitudeDistributor::CreateDistributionsFromBuffer()
+    {
+        unsigned nBuffered = fNSlicesProcessed < fBufferSize ? fNSlicesProcessed : fBufferSize;
+        if (nBuffered == 0)
         {
-            KTDEBUG(adlog, "Buffer is larger than the number of slices processed; resizing to " << fNSlicesProcessed);
-            fBuffer.resize(fNSlicesProcessed);
+            KTERROR(adlog, "Buffer is empty, but buffer use was requested");
+            return false;
         }
 
-        double distMin, distMax, value;
-        //unsigned distBin;
-        for (unsigned iComponent = 0; iComponent < fNComponents; ++iComponent)
+        KTDEBUG(adlog, "Creating distributions from " << nBuffered << " buffered slices: " << fNComponents << " components with " << fNFreqBins << " frequency bins");
+        if (! fDistributions->CreateDistributionsFromBuffer(nBuffered, fMinBin, fMaxBin - fMinBin + 1))
         {
-            for (unsigned iBin = fMinBin; iBin <= fMaxBin; iBin++)
-            {
-                KTWARN(adlog, "0  " << iComponent << "  " << iBin << "  " << fBuffer[0][iComponent][iBin]);
-                distMin = fBuffer[0][iComponent][iBin];
-                distMax = distMin;
-                KTERROR(adlog, distMin << "  " << distMax << "  buffer size: " << fBuffer.size());
-                for (unsigned iSpectrum = 1; iSpectrum < fBuffer.size(); iSpectrum++)
-                {
-                    value = fBuffer[iSpectrum][iComponent][iBin];
-                    if (value < distMin) distMin = value;
-                    else if (value > distMax) distMax = value;
-                    KTERROR(adlog, "   " << distMin << "  " << distMax);
-                }
-                if (! fDistributions->InitializeADistribution(iComponent, iBin, fDistNBins, distMin, distMax))
-                {
-                    KTERROR(adlog, "There was a problem initializing a distribution: component " << iComponent << "; frequency bin " << iBin);
-                    return false;
-                }
-                KTDEBUG(adlog, "Distribution initialized; filling in from buffer");
-                for (unsigned iSpectrum = 1; iSpectrum < fBuffer.size(); iSpectrum++)
-                {
-                    value = fBuffer[iSpectrum][iComponent][iBin];
-                    fDistributions->AddToDist(iBin, value, iComponent);
-                }
-            }
+            KTERROR(adlog, "There was a problem initializing the distributions from the buffer");
+            return false;
         }
 
-        // The condition (fUseBuffer && fBuffer.empty()) implies that if data has been taken, it's been transferred to distributions
-        fBuffer.clear();
+        // The condition (fUseBuffer && ! fBuffering) implies that if data has been taken, it's been transferred to distributions
+        fBuffering = false;
 
         return true;
     }
@@ -415,7 +442,7 @@ namespace Katydid
 
     void KTAmplitudeDistributor::FinishAmpDist()
     {
-        if (fUseBuffer && ! fBuffer.empty())
+        if (fUseBuffer && fBuffering)
         {
             CreateDistributionsFromBuffer();
         }
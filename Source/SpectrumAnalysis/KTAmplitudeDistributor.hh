@@ -52,6 +52,7 @@ namespace Katydid
      - "buffer-size": unsigned -- number of spectra to store initially to determine the range of the distribution (if not using "dist-min/max")
      - "dist-min": double -- minimum of the distribution (if not using "buffer-size")
      - "dist-max": double -- maximum of the distribution (if not using "buffer-size")
+     - "n-threads": unsigned -- number of threads that fill the distributions, each over its own range of frequency bins; 0 (default) uses the OpenMP default; ignored without OpenMP
 
      Slots:
      - Running
@@ -70,11 +71,6 @@ namespace Katydid
 
     class KTAmplitudeDistributor : public Nymph::KTProcessor
     {
-        public:
-            typedef std::vector< double > Spectrum; // indexed over frequency-axis bins
-            typedef std::vector< Spectrum > Spectra; // indexed over component
-            typedef std::vector< Spectra > Buffer; // indexed over slice number
-
         public:
             KTAmplitudeDistributor(const std::string& name = "amplitude-distributor");
             virtual ~KTAmplitudeDistributor();
@@ -108,6 +104,9 @@ namespace Katydid
             double GetDistMax() const;
             void SetDistMax(double max);
 
+            unsigned GetNThreads() const;
+            void SetNThreads(unsigned nThreads);
+
         private:
             double fMinFrequency;
             double fMaxFrequency;
@@ -122,6 +121,8 @@ namespace Katydid
             double fDistMax;
             bool fUseBuffer;
 
+            unsigned fNThreads;
+
         public:
             bool Initialize(unsigned nComponents, unsigned nFreqBins);
 
@@ -146,7 +147,12 @@ namespace Katydid
             bool TakeValuesToBuffer(const KTFrequencySpectrumFFTW* spectrum, unsigned component);
             bool TakeValuesToDistributions(const KTFrequencySpectrumFFTW* spectrum, unsigned component);
 
-            bool CreateDistributionsEmpty();
+            template< class XSpectrum >
+            void TakeValues(const XSpectrum* spectrum, unsigned component, bool toBuffer);
+
+            static void CalculateMagnitudes(const KTFrequencySpectrumPolar* spectrum, unsigned firstBin, unsigned nBins, double* magnitudes);
+            static void CalculateMagnitudes(const KTFrequencySpectrumFFTW* spectrum, unsigned firstBin, unsigned nBins, double* magnitudes);
+
             bool CreateDistributionsFromBuffer();
 
             double fInvDistBinWidth;
@@ -154,8 +160,14 @@ namespace Katydid
             unsigned fNFreqBins;
             unsigned fNComponents;
 
-            Buffer fBuffer;
-            unsigned fNBuffered;
+            /// Scratch space for the magnitudes of the spectrum being added; indexed over frequency-axis bins
+            std::vector< double > fMagnitudes;
+
+            /// True while values are being stored in the buffer (i.e. before the distributions' ranges are set)
+            bool fBuffering;
+
+            /// Smallest range of frequency bins that's worth giving to a thread
+            static const unsigned sMinBinsPerThread = 4096;
 
             unsigned fNSlicesProcessed;
 
@@ -291,5 +303,16 @@ namespace Katydid
         return;
     }
 
+    inline unsigned KTAmplitudeDistributor::GetNThreads() const
+    {
+        return fNThreads;
+    }
+
+    inline void KTAmplitudeDistributor::SetNThreads(unsigned nThreads)
+    {
+        fNThreads = nThreads;
+        return;
+    }
+
 } /* namespace Katydid */
 #endif /* KTAMPLITUDEDISTRIBUTOR_HH_ */
@@ -9,6 +9,9 @@
 
 #include "KTLogger.hh"
 
+#include <algorithm>
+#include <cmath>
+
 namespace Katydid
 {
     KTLOGGER(agglog, "KTChannelAggregator");
@@ -16,6 +19,10 @@ namespace Katydid
     // Register the processor
     KT_REGISTER_PROCESSOR(KTChannelAggregator, "channel-aggregator");
 
+    // std::min takes its arguments by reference, so the block sizes need definitions
+    const unsigned KTChannelAggregator::sGridBlockSize;
+    const unsigned KTChannelAggregator::sBinBlockSize;
+
     KTChannelAggregator::KTChannelAggregator(const std::string& name) :
             KTProcessor(name),
             fSummedFrequencyData("agg-fft", this),
@@ -23,7 +30,16 @@ namespace Katydid
             fActiveRadius(0.0516),
             fNGrid(30),
             fWavelength(0.0115),
-            fIsGridDefined(false)
+            fIsGridDefined(false),
+            fStoreSpectra(true),
+            fSteeringReal(),
+            fSteeringImag(),
+            fSteeringNGrid(0),
+            fSteeringNChannels(0),
+            fSteeringActiveRadius(0.),
+            fSteeringWavelength(0.),
+            fChannelReal(),
+            fChannelImag()
     {
     }
 
@@ -38,19 +54,11 @@ namespace Katydid
             fNGrid = node->get_value< signed int >("grid-size", fNGrid);
             fActiveRadius = node->get_value< double >("active-radius", fActiveRadius);
             fWavelength = node->get_value< double >("wavelength", fWavelength);
+            fStoreSpectra = node->get_value< bool >("store-spectra", fStoreSpectra);
         }
         return true;
     }
 
-    bool KTChannelAggregator::ApplyPhaseShift(double &realVal, double &imagVal, double phase)
-    {
-        double tempRealVal = realVal;
-        double tempImagVal = imagVal;
-        realVal = tempRealVal * cos(phase) - tempImagVal * sin(phase);
-        imagVal = tempRealVal * sin(phase) + tempImagVal * cos(phase);
-        return true;
-    }
-
     double KTChannelAggregator::GetPhaseShift(double xPosition, double yPosition, double wavelength, double channelAngle) const
     {
         // X position based on the angle of the channel
@@ -70,26 +78,118 @@ namespace Katydid
         return true;
     }
 
+    void KTChannelAggregator::BuildSteeringMatrix(unsigned nChannels)
+    {
+        if (fSteeringNGrid == fNGrid && fSteeringNChannels == nChannels && fSteeringActiveRadius == fActiveRadius && fSteeringWavelength == fWavelength) return;
+
+        KTDEBUG(agglog, "Building the steering matrix for " << fNGrid * fNGrid << " grid points and " << nChannels << " channels");
+
+        unsigned nGridPoints = fNGrid * fNGrid;
+        fSteeringReal.resize(nGridPoints * nChannels);
+        fSteeringImag.resize(nGridPoints * nChannels);
+        for (int iGridX = 0; iGridX < fNGrid; ++iGridX)
+        {
+            double gridLocationX = 0;
+            GetGridLocation(iGridX, fNGrid, gridLocationX);
+            for (int iGridY = 0; iGridY < fNGrid; ++iGridY)
+            {
+                double gridLocationY = 0;
+                GetGridLocation(iGridY, fNGrid, gridLocationY);
+                unsigned rowStart = (iGridX * fNGrid + iGridY) * nChannels;
+                for (unsigned iChannel = 0; iChannel < nChannels; ++iChannel)
+                {
+                    // Arbitarily assign 0 to the first channel and progresively add 2pi/N for the rest of the channels in increasing order
+                    double channelAngle = 2 * KTMath::Pi() * iChannel / nChannels;
+                    double phaseShift = GetPhaseShift(gridLocationX, gridLocationY, fWavelength, channelAngle);
+                    fSteeringReal[rowStart + iChannel] = cos(phaseShift);
+                    fSteeringImag[rowStart + iChannel] = sin(phaseShift);
+                }
+            }
+        }
+
+        fSteeringNGrid = fNGrid;
+        fSteeringNChannels = nChannels;
+        fSteeringActiveRadius = fActiveRadius;
+        fSteeringWavelength = fWavelength;
+        return;
+    }
+
+    void KTChannelAggregator::FormBeams(unsigned firstGridPoint, unsigned nGridPoints, unsigned nChannels, unsigned nFreqBins, KTAggregatedFrequencySpectrumDataFFTW& aggData)
+    {
+        // Accumulators for a block of grid points x a block of bins
+        double accReal[sGridBlockSize][sBinBlockSize];
+        double accImag[sGridBlockSize][sBinBlockSize];
+        double maxMagSq[sGridBlockSize] = {0.};
+
+        for (unsigned firstBin = 0; firstBin < nFreqBins; firstBin += sBinBlockSize)
+        {
+            unsigned nBins = std::min(sBinBlockSize, nFreqBins - firstBin);
+            for (unsigned iGrid = 0; iGrid < nGridPoints; ++iGrid)
+            {
+                std::fill(accReal[iGrid], accReal[iGrid] + nBins, 0.);
+                std::fill(accImag[iGrid], accImag[iGrid] + nBins, 0.);
+            }
+
+            // The channels are added in order, so each bin is summed exactly as in a channel-by-channel loop
+            for (unsigned iChannel = 0; iChannel < nChannels; ++iChannel)
+            {
+                const double* chReal = &fChannelReal[iChannel * nFreqBins + firstBin];
+                const double* chImag = &fChannelImag[iChannel * nFreqBins + firstBin];
+                for (unsigned iGrid = 0; iGrid < nGridPoints; ++iGrid)
+                {
+                    double steerReal = fSteeringReal[(firstGridPoint + iGrid) * nChannels + iChannel];
+                    double steerImag = fSteeringImag[(firstGridPoint + iGrid) * nChannels + iChannel];
+                    double* gridReal = accReal[iGrid];
+                    double* gridImag = accImag[iGrid];
+                    for (unsigned iBin = 0; iBin < nBins; ++iBin)
+                    {
+                        gridReal[iBin] += chReal[iBin] * steerReal - chImag[iBin] * steerImag;
+                        gridImag[iBin] += chReal[iBin] * steerImag + chImag[iBin] * steerReal;
+                    }
+                }
+            }
+
+            // Write the spectra and find the maximum magnitudes in the same pass
+            for (unsigned iGrid = 0; iGrid < nGridPoints; ++iGrid)
+            {
+                KTFrequencySpectrumFFTW* spectrum = aggData.GetSpectrumFFTW(firstGridPoint + iGrid);
+                fftw_complex* data = spectrum == NULL ? NULL : spectrum->GetData() + firstBin;
+                for (unsigned iBin = 0; iBin < nBins; ++iBin)
+                {
+                    double magSq = accReal[iGrid][iBin] * accReal[iGrid][iBin] + accImag[iGrid][iBin] * accImag[iGrid][iBin];
+                    if (magSq > maxMagSq[iGrid]) maxMagSq[iGrid] = magSq;
+                    if (data != NULL)
+                    {
+                        data[iBin][0] = accReal[iGrid][iBin];
+                        data[iBin][1] = accImag[iGrid][iBin];
+                    }
+                }
+            }
+        }
+
+        for (unsigned iGrid = 0; iGrid < nGridPoints; ++iGrid)
+        {
+            aggData.SetSummedGridVoltage(firstGridPoint + iGrid, sqrt(maxMagSq[iGrid]));
+        }
+        return;
+    }
+
     bool KTChannelAggregator::SumChannelVoltageWithPhase(KTFrequencySpectrumDataFFTW& fftwData)
     {
         const KTFrequencySpectrumFFTW* freqSpectrum = fftwData.GetSpectrumFFTW(0);
         int nTimeBins = freqSpectrum->GetNTimeBins();
         // Get the number of frequency bins from the first component of fftwData
-        int nFreqBins = freqSpectrum->GetNFrequencyBins();
-        int nComponents = fftwData.GetNComponents(); // Get number of components
-
-        double maxValue = 0.0;
-        double maxGridLocationX = 0.0;
-        double maxGridLocationY = 0.0;
+        unsigned nFreqBins = freqSpectrum->GetNFrequencyBins();
+        unsigned nComponents = fftwData.GetNComponents(); // Get number of components
+        unsigned nGridPoints = fNGrid * fNGrid;
 
         // Assume a square grid. i.e, number of points in X= no of points in Y
-        KTAggregatedFrequencySpectrumDataFFTW& newAggFreqData = fftwData.Of< KTAggregatedFrequencySpectrumDataFFTW >().SetNComponents(fNGrid * fNGrid);
+        KTAggregatedFrequencySpectrumDataFFTW& newAggFreqData = fftwData.Of< KTAggregatedFrequencySpectrumDataFFTW >().SetNComponents(nGridPoints);
 
         // Setting up the active radius of the KTAggregatedFrequencySpectrumDataFFTW object to maintain consistency
         // This doesn't need to be done if there is a way to provide config values to data objects
         newAggFreqData.SetActiveRadius(fActiveRadius);
 
-        int nTotalGridPoints = 0;
         // Loop over the grid points and fill the values
         for (int iGridX = 0; iGridX < fNGrid; ++iGridX)
         {
@@ -101,55 +201,54 @@ namespace Katydid
                 GetGridLocation(iGridY, fNGrid, gridLocationY);
                 // Check to make sure that the grid point is within the active detector volume, skip otherwise
                 //        if((pow(gridLocationX,2)+pow(gridLocationY,2))>pow(fActiveRadius,2)) continue;
-                newAggFreqData.SetGridPoint(nTotalGridPoints, gridLocationX, gridLocationY);
-                ++nTotalGridPoints;
+                newAggFreqData.SetGridPoint(iGridX * fNGrid + iGridY, gridLocationX, gridLocationY);
             }
         }
-        // Loop over all grid points and find the one that gives the highest value
-        for (int iGrid = 0; iGrid < nTotalGridPoints; ++iGrid)
-        { // Loop over the grid points
-            double gridLocationX = 0;
-            double gridLocationY = 0;
-            newAggFreqData.GetGridPoint(iGrid, gridLocationX, gridLocationY);
-            KTFrequencySpectrumFFTW* newFreqSpectrum = new KTFrequencySpectrumFFTW(nFreqBins, freqSpectrum->GetRangeMin(), freqSpectrum->GetRangeMax());
-            // Empty values in the frequency spectrum, not sure if this is needed but there were some issues when this was not done for the power spectrum
-            NullFreqSpectrum(*newFreqSpectrum);
-            for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
-            {
-                // Arbitarily assign 0 to the first channel and progresively add 2pi/N for the rest of the channels in increasing order
-                double channelAngle = 2 * KTMath::Pi() * iComponent / nComponents;
-                double phaseShift = GetPhaseShift(gridLocationX, gridLocationY, fWavelength, channelAngle);
-                // Get the frequency spectrum for that specific component
-                freqSpectrum = fftwData.GetSpectrumFFTW(iComponent);
-                double maxVoltage = 0.0;
-                int maxFrequencyBin = 0;
-                //Loop over the frequency bins
-                for (unsigned iFreqBin = 0; iFreqBin < nFreqBins; ++iFreqBin)
-                {
-                    double realVal = freqSpectrum->GetReal(iFreqBin);
-                    double imagVal = freqSpectrum->GetImag(iFreqBin);
-                    ApplyPhaseShift(realVal, imagVal, phaseShift);
-                    double summedRealVal = realVal + newFreqSpectrum->GetReal(iFreqBin);
-                    double summedImagVal = imagVal + newFreqSpectrum->GetImag(iFreqBin);
-                    (*newFreqSpectrum)(iFreqBin)[0] = summedRealVal;
-                    (*newFreqSpectrum)(iFreqBin)[1] = summedImagVal;
-                } // End of loop over freq bins
-            } // End of loop over all comps
-            newFreqSpectrum->SetNTimeBins(nTimeBins);
-            newAggFreqData.SetSpectrum(newFreqSpectrum, iGrid);
 
-            double maxVoltageFreq = 0.0;
-            //Loop over all the freq bins and get the highest value and save to the aggregated frequency data
+        BuildSteeringMatrix(nComponents);
+
+        // Copy the channel spectra into split real/imaginary arrays
+        fChannelReal.resize(nComponents * nFreqBins);
+        fChannelImag.resize(nComponents * nFreqBins);
+        for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
+        {
+            freqSpectrum = fftwData.GetSpectrumFFTW(iComponent);
+            if (freqSpectrum->GetNFrequencyBins() != nFreqBins)
+            {
+                KTERROR(agglog, "All channels must have the same number of frequency bins; channel " << iComponent << " has " << freqSpectrum->GetNFrequencyBins() << " instead of " << nFreqBins);
+                return false;
+            }
+            double* chReal = &fChannelReal[iComponent * nFreqBins];
+            double* chImag = &fChannelImag[iComponent * nFreqBins];
             for (unsigned iFreqBin = 0; iFreqBin < nFreqBins; ++iFreqBin)
             {
-                if (newFreqSpectrum->GetAbs(iFreqBin) > maxVoltageFreq)
-                {
-                    maxVoltageFreq = newFreqSpectrum->GetAbs(iFreqBin);
-                }
-            } // end of freqeuncy bin loops
-            newAggFreqData.SetSummedGridVoltage(iGrid, maxVoltageFreq);
-        } // End of grid
+                chReal[iFreqBin] = freqSpectrum->GetReal(iFreqBin);
+                chImag[iFreqBin] = freqSpectrum->GetImag(iFreqBin);
+            }
+        }
+
+        // The spectra are created up front; every bin is filled by FormBeams
+        freqSpectrum = fftwData.GetSpectrumFFTW(0);
+        for (unsigned iGrid = 0; iGrid < nGridPoints; ++iGrid)
+        {
+            KTFrequencySpectrumFFTW* newFreqSpectrum = NULL;
+            if (fStoreSpectra)
+            {
+                newFreqSpectrum = KTFrequencySpectrumFFTW::Acquire(nFreqBins, freqSpectrum->GetRangeMin(), freqSpectrum->GetRangeMax());
+                newFreqSpectrum->SetNTimeBins(nTimeBins);
+            }
+            newAggFreqData.SetSpectrum(newFreqSpectrum, iGrid);
+        }
+
+        // Form the spectra for blocks of grid points
+        int nGridBlocks = (nGridPoints + sGridBlockSize - 1) / sGridBlockSize;
+#pragma omp parallel for schedule(static)
+        for (int iBlock = 0; iBlock < nGridBlocks; ++iBlock)
+        {
+            unsigned firstGridPoint = iBlock * sGridBlockSize;
+            FormBeams(firstGridPoint, std::min(sGridBlockSize, nGridPoints - firstGridPoint), nComponents, nFreqBins, newAggFreqData);
+        }
+
         return true;
     }
 }
-
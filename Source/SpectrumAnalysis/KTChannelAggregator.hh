@@ -21,6 +21,8 @@
 
 #include "KTMath.hh"
 
+#include <vector>
+
 namespace Katydid
 {
 
@@ -34,7 +36,15 @@ namespace Katydid
      @brief Multiple channel summation for Phase-III and IV
      
      @details
-     More details to come.
+     The channel spectra are summed with a phase shift for each point on a square grid (beamforming).
+     The phase factors exp(i*phase) for every (grid point, channel) pair form a steering matrix, which is computed once
+     and reused until the grid, the active radius, the wavelength or the number of channels changes.
+     The spectra for all of the grid points are then one complex matrix product, (grid points x channels) x (channels x bins).
+     The product is blocked over grid points and frequency bins, with the channel spectra in split real/imaginary arrays
+     so that the innermost loop over bins vectorizes; the blocks of grid points are formed in parallel when OpenMP is enabled
+     (Katydid_USE_OPENMP), and in a single thread otherwise.
+     The maximum magnitude for each grid point is found while its spectrum is written, and is stored in the aggregated data
+     (see KTAggregatedFrequencySpectrumDataFFTW::GetSummedGridVoltage), which is all that KTAggregatedChannelOptimizer needs.
      
      Configuration name: "channel-aggregator"
      
@@ -42,6 +52,10 @@ namespace Katydid
      - "active-radius": double -- The active radius of the detection volume
      - "grid-size": signed int -- Size of the grid; If square grid is considered, the number of points in the grid is the square of grid-size
      - "wavelength": double -- Wavelength of the cyclotron motion
+     - "store-spectra": bool -- If true (default), the summed spectrum for each grid point is stored; if false, only the maximum magnitude for each grid point is stored,
+                                and the spectra in the aggregated data are NULL.  KTAggregatedChannelOptimizer and the grid histograms (KT2ROOT::CreateGridHistogram)
+                                only use the maxima.  KTConvertToPower's aggregated slots ("aggfs-fftw-to-ps" and "aggfs-fftw-to-psd") need the spectra, and fail without them;
+                                the ROOT writers skip the missing spectra.
  
      Slots:
      - "fft": void (Nymph::KTDataPtr) -- Adds channels voltages using FFTW-phase information for appropriate phase addition; Requires KTFrequencySpectrumDataFFTW; Adds summation of the channel results; Emits signal "fft"
@@ -71,10 +85,34 @@ namespace Katydid
 
             //For exception handling to make sure the grid is defined before the spectra are assigned.
             MEMBERVARIABLE(bool, IsGridDefined);
+
+            // If false, only the maximum summed magnitude is kept for each grid point
+            MEMBERVARIABLE(bool, StoreSpectra);
         
             bool SumChannelVoltageWithPhase(KTFrequencySpectrumDataFFTW& fftwData);
 
         private:
+            /// Fills the steering matrix for the current grid, active radius and wavelength, if it isn't already up to date
+            void BuildSteeringMatrix(unsigned nChannels);
+
+            /// Forms the summed spectra for grid points [firstGridPoint, firstGridPoint + nGridPoints), up to sGridBlockSize of them
+            void FormBeams(unsigned firstGridPoint, unsigned nGridPoints, unsigned nChannels, unsigned nFreqBins, KTAggregatedFrequencySpectrumDataFFTW& aggData);
+
+            static const unsigned sGridBlockSize = 4;
+            static const unsigned sBinBlockSize = 256;
+
+            /// Steering matrix, exp(i*phase) for each grid point (rows) and channel (columns)
+            std::vector< double > fSteeringReal;
+            std::vector< double > fSteeringImag;
+            /// Configuration that the steering matrix was built for
+            int fSteeringNGrid;
+            unsigned fSteeringNChannels;
+            double fSteeringActiveRadius;
+            double fSteeringWavelength;
+
+            /// Channel spectra in split real/imaginary arrays, one row of bins per channel
+            std::vector< double > fChannelReal;
+            std::vector< double > fChannelImag;
 
             /// Returns the phase shift based on a given point, angle of the channel and the wavelength
             double GetPhaseShift(double xPosition, double yPosition, double wavelength, double channelAngle) const;
@@ -84,17 +122,9 @@ namespace Katydid
              */
             bool GetGridLocation(int gridNumber, int gridSize, double &gridLocation);
 
-            /// Apply shift phase to the supplied points based on the phase provided
-            bool ApplyPhaseShift(double &realVal, double &imagVal, double phase);
-
             /// Convert frquency to wavlength
             double ConvertFrequencyToWavelength(double frequency);
 
-        private:
-            //PTS: This needs fixing, currently just setting each element to 0. But why does it have to be done to begin with.
-            // Perhaps there is some function in the utilities to do this ?
-            bool NullFreqSpectrum(KTFrequencySpectrumFFTW &freqSpectrum);
-
             //***************
             // Signals
             //***************
@@ -109,15 +139,6 @@ namespace Katydid
         private:
             Nymph::KTSlotDataOneType< KTFrequencySpectrumDataFFTW > fPhaseChFrequencySumSlot;
     };
-
-    inline bool KTChannelAggregator::NullFreqSpectrum(KTFrequencySpectrumFFTW &freqSpectrum)
-    {
-        for (unsigned i = 0; i < freqSpectrum.size(); ++i)
-        {
-            freqSpectrum.SetRect(i, 0.0, 0.0);
-        }
-        return true;
-    }
 }
 
 #endif  /* KTCHANNELAGGREGATOR_HH_  */
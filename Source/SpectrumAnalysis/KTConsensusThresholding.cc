@@ -9,6 +9,11 @@
 
 #include "KTKDTreeData.hh"
 #include "KTLogger.hh"
+#include "KTParallelQuery.hh"
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
 
 using std::string;
 
@@ -24,6 +29,7 @@ namespace Katydid
             fMembershipRadius(1.0),
             fMinNumberVotes(1),
             fRemoveNoiseFlag(false),
+            fNThreads(0),
             fFindDeltasPtr(&KTConsensusThresholding::FindDeltasNeighborsInRadius),
             fKDTreeSignal("kd-tree-out", this),
             fKDTreeSlot("kd-tree-in", this, &KTConsensusThresholding::ConsensusVote, &fKDTreeSignal)
@@ -41,6 +47,7 @@ namespace Katydid
         SetMembershipRadius(node->get_value("membership-radius", GetMembershipRadius()));
         SetMinNumberVotes(node->get_value("min-number-votes", GetMinNumberVotes()));
         SetRemoveNoiseFlag(node->get_value("remove-noise", GetRemoveNoiseFlag()));
+        SetNThreads(node->get_value("n-threads", GetNThreads()));
 
         if (node->has("slope-algorithm"))
         {
@@ -95,71 +102,92 @@ namespace Katydid
     bool KTConsensusThresholding::ConsensusVoteComponent(const KTTreeIndex< double >* kdTree, const KTKDTreeData::SetOfPoints& setOfPoints, std::vector< size_t >& noiseIndices)
     {
         unsigned nPoints = kdTree->size();
-        noiseIndices.clear();
+
+        // Each thread collects its noise points in its own buffer; the points have very different numbers of votes,
+        // so they're handed out dynamically, and the merged buffers are sorted to restore the point order.
+        unsigned nThreads = KTParallelQuery::NThreads(fNThreads);
+        std::vector< std::vector< size_t > > threadNoise(nThreads);
+
+#pragma omp parallel num_threads(nThreads)
+        {
+#ifdef USE_OPENMP
+            std::vector< size_t >& noise = threadNoise[omp_get_thread_num()];
+#else
+            std::vector< size_t >& noise = threadNoise[0];
+#endif
+#pragma omp for schedule(dynamic, 64)
+            for (unsigned iPoint = 0; iPoint < nPoints; ++iPoint)
+            {
+                if (CountVotes(kdTree, setOfPoints, iPoint) < fMinNumberVotes)
+                {
+                    noise.push_back(iPoint);
+                }
+            }
+        }
+
+        KTParallelQuery::MergeIndices(threadNoise, noiseIndices);
+        return true;
+    }
+
+    unsigned KTConsensusThresholding::CountVotes(const KTTreeIndex< double >* kdTree, const KTKDTreeData::SetOfPoints& setOfPoints, unsigned pid)
+    {
+        KTDEBUG(ctlog, "checking point " << pid << "; coords: (" << setOfPoints[pid].fCoords[0] << ", " << setOfPoints[pid].fCoords[1] << ")");
         double timeDelta, frequencyDelta;
-        for (unsigned iPoint = 0; iPoint < nPoints; ++iPoint)
+        //FindDeltasFirstNeighbor(kdTree, setOfPoints, pid, timeDelta, frequencyDelta);
+        (this->*fFindDeltasPtr)(kdTree, setOfPoints, pid, timeDelta, frequencyDelta);
+
+        unsigned voteCount = 0;
+        if (! (timeDelta == 0))
         {
-            KTDEBUG(ctlog, "checking point (" << iPoint << "/" << nPoints << "); coords: (" << setOfPoints[iPoint].fCoords[0] << ", " << setOfPoints[iPoint].fCoords[1] << ")");
-            //FindDeltasFirstNeighbor(kdTree, setOfPoints, iPoint, timeDelta, frequencyDelta);
-            (this->*fFindDeltasPtr)(kdTree, setOfPoints, iPoint, timeDelta, frequencyDelta);
+            //double slope = frequencyDelta / timeDelta;
+            //double intercept = setOfPoints[pid].fCoords[1] - slope * setOfPoints[pid].fCoords[0];
 
-            unsigned voteCount = 0;
-            if (! (timeDelta == 0))
+            bool closeEnough = true;
+            double test_pt[2];
+            std::vector< std::pair< size_t, double > > indicesDist;
+            double k = 1.0;
+            while (closeEnough)
             {
-                //double slope = frequencyDelta / timeDelta;
-                //double intercept = setOfPoints[iPoint].fCoords[1] - slope * setOfPoints[iPoint].fCoords[0];
-
-                bool closeEnough = true;
-                double test_pt[2];
-                std::vector< std::pair< size_t, double > > indicesDist;
-                double k = 1.0;
-                while (closeEnough)
+                test_pt[0] = setOfPoints[pid].fCoords[0] + k * timeDelta;
+                test_pt[1] = setOfPoints[pid].fCoords[1] + k * frequencyDelta;
+                KTDEBUG(ctlog, "x = "<< test_pt[0] << " = " << setOfPoints[pid].fCoords[0] << " + " << k << " * " << timeDelta <<"\t" << "y = "<< test_pt[1] << " = " << setOfPoints[pid].fCoords[1] << " + " << k << " * " << frequencyDelta );
+
+                kdTree->RadiusSearch(test_pt, fMembershipRadius, indicesDist, nanoflann::SearchParams(32, 0, true));
+                KTDEBUG(ctlog, "Number of points in radius search: " << indicesDist.size());
+                if (indicesDist.size() > 0)
                 {
-                    test_pt[0] = setOfPoints[iPoint].fCoords[0] + k * timeDelta;
-                    test_pt[1] = setOfPoints[iPoint].fCoords[1] + k * frequencyDelta;
-                    KTDEBUG(ctlog, "x = "<< test_pt[0] << " = " << setOfPoints[iPoint].fCoords[0] << " + " << k << " * " << timeDelta <<"\t" << "y = "<< test_pt[1] << " = " << setOfPoints[iPoint].fCoords[1] << " + " << k << " * " << frequencyDelta );
-
-                    kdTree->RadiusSearch(test_pt, fMembershipRadius, indicesDist, nanoflann::SearchParams(32, 0, true));
-                    KTDEBUG(ctlog, "Number of points in radius search: " << indicesDist.size());
-                    if (indicesDist.size() > 0)
-                    {
-                        k += 1.0;
-                        voteCount += 1;
-                    }
-                    else
-                    {
-                        closeEnough = false;
-                    }
+                    k += 1.0;
+                    voteCount += 1;
                 }
-                closeEnough = true;
-                KTDEBUG(ctlog, "Changing direction");
-
-                k = -1.0;
-                while (closeEnough)
+                else
                 {
-                    test_pt[0] = setOfPoints[iPoint].fCoords[0] + k * timeDelta;
-                    test_pt[1] = setOfPoints[iPoint].fCoords[1] + k * frequencyDelta;
-                    KTDEBUG(ctlog, "x = "<< test_pt[0] << " = " << setOfPoints[iPoint].fCoords[0] << " + " << k << " * " << timeDelta <<"\t" << "y = "<< test_pt[1] << " = " << setOfPoints[iPoint].fCoords[1] << " + " << k << " * " << frequencyDelta );
-
-                    kdTree->RadiusSearch(test_pt, fMembershipRadius, indicesDist, nanoflann::SearchParams(32, 0, true));
-                    KTDEBUG(ctlog, "Number of points in radius search: " << indicesDist.size());
-                    if (indicesDist.size() > 0)
-                    {
-                        k -= 1.0;
-                        voteCount += 1;
-                    }
-                    else
-                    {
-                        closeEnough = false;
-                    }
+                    closeEnough = false;
                 }
             }
-            if (voteCount < fMinNumberVotes)
+            closeEnough = true;
+            KTDEBUG(ctlog, "Changing direction");
+
+            k = -1.0;
+            while (closeEnough)
             {
-                noiseIndices.push_back(iPoint);
+                test_pt[0] = setOfPoints[pid].fCoords[0] + k * timeDelta;
+                test_pt[1] = setOfPoints[pid].fCoords[1] + k * frequencyDelta;
+                KTDEBUG(ctlog, "x = "<< test_pt[0] << " = " << setOfPoints[pid].fCoords[0] << " + " << k << " * " << timeDelta <<"\t" << "y = "<< test_pt[1] << " = " << setOfPoints[pid].fCoords[1] << " + " << k << " * " << frequencyDelta );
+
+                kdTree->RadiusSearch(test_pt, fMembershipRadius, indicesDist, nanoflann::SearchParams(32, 0, true));
+                KTDEBUG(ctlog, "Number of points in radius search: " << indicesDist.size());
+                if (indicesDist.size() > 0)
+                {
+                    k -= 1.0;
+                    voteCount += 1;
+                }
+                else
+                {
+                    closeEnough = false;
+                }
             }
         }
-        return true;
+        return voteCount;
     }
 
     void KTConsensusThresholding::FindDeltasNearestNeighbor(const KTTreeIndex< double >* kdTree, const KTKDTreeData::SetOfPoints& setOfPoints, unsigned pid, double& deltaTime, double& deltaFreq)
@@ -27,7 +27,10 @@ namespace Katydid
      @brief Filters sparse-waterfall data with the Consensus Thresholding algorithm
 
      @details
- 
+     The votes for each point only read the k-d tree, so the points are processed in parallel when OpenMP is enabled.
+     Each thread collects its noise points in its own buffer, and the buffers are merged in point order,
+     so the result doesn't depend on the number of threads.
+
      Configuration name: "consensus-thresholding"
 
      Available configuration values:
@@ -35,6 +38,7 @@ namespace Katydid
      - "min-number-votes": unsigned -- Minimum number of votes to keep a point
      - "remove-noise": bool -- Flag that determines whether noise points are removed (true) or flagged (false; default)
      - "slope-algorithm": string -- Method used to find the slope around each point: "nearest-neighbor" or "radius" (default)
+     - "n-threads": unsigned -- Number of threads used for the neighbor queries; 0 (default) uses the OpenMP default; ignored without OpenMP
 
      Slots:
      - "kd-tree-in": void (Nymph::KTDataPtr) -- Performs the CT algorithm on the data in a k-d tree; Requires KTKDTreeData; existing data is modified
@@ -54,6 +58,7 @@ namespace Katydid
             MEMBERVARIABLE(double, MembershipRadius);
             MEMBERVARIABLE(unsigned, MinNumberVotes);
             MEMBERVARIABLE(bool, RemoveNoiseFlag);
+            MEMBERVARIABLE(unsigned, NThreads);
 
         public:
             bool ConsensusVote(KTKDTreeData& kdTreeData);
@@ -67,6 +72,8 @@ namespace Katydid
             void FindDeltasNearestNeighbor(const KTTreeIndex< double >* kdTree, const KTKDTreeData::SetOfPoints& setOfPoints, unsigned pid, double& deltaTime, double& deltaFreq);
             void FindDeltasNeighborsInRadius(const KTTreeIndex< double >* kdTree, const KTKDTreeData::SetOfPoints& setOfPoints, unsigned pid, double& deltaTime, double& deltaFreq);
 
+            unsigned CountVotes(const KTTreeIndex< double >* kdTree, const KTKDTreeData::SetOfPoints& setOfPoints, unsigned pid);
+
             //***************
             // Signals
             //***************
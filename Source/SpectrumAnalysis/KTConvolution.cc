@@ -17,6 +17,8 @@
 #include "param.hh"
 #include "KTConfigurator.hh"
 
+#include <algorithm>
+
 using std::string;
 using std::vector;
 
@@ -36,33 +38,8 @@ namespace Katydid
             fRegularSize(0),
             fShortSize(0),
             fTransformFlagMap(),
-            fComplexToRealPlan(),
-            fRealToComplexPlan(),
-            fC2CForwardPlan(),
-            fC2CReversePlan(),
-            fComplexToRealPlanShort(),
-            fRealToComplexPlanShort(),
-            fC2CForwardPlanShort(),
-            fC2CReversePlanShort(),
-            fInputArrayReal(NULL),
-            fOutputArrayReal(NULL),
-            fInputArrayComplex(NULL),
-            fOutputArrayComplex(NULL),
-            fTransformedInputArray(NULL),
-            fTransformedOutputArray(NULL),
-            fTransformedInputArrayFromReal(NULL),
-            fTransformedOutputArrayFromReal(NULL),
-            fTransformedKernelXAsReal(NULL),
-            fTransformedKernelXAsComplex(NULL),
-            fGeneralTransformedInputArray(NULL),
-            fGeneralTransformedOutputArray(NULL),
-            fGeneralTransformedKernelArray(NULL),
-            nBinLimitRegular(0),
-            nBinLimitShort(0),
-            fGeneralForwardPlan(),
-            fGeneralReversePlan(),
-            fGeneralForwardPlanShort(),
-            fGeneralReversePlanShort(),
+            fBlockTransforms(),
+            fBlockBuffers(),
             fTransformFlagUnsigned(FFTW_ESTIMATE),
             fKernelSize(0),
             fInitialized(false),
@@ -124,147 +101,99 @@ namespace Katydid
         return true;
     }
 
-    void KTConvolution1D::AllocateArrays( int nSizeRegular, int nSizeShort )
+    const KTConvolution1D::BlockTransform& KTConvolution1D::GetBlockTransform( int size )
     {
-        KTDEBUG(sdlog, "DFT initialization started");
-        KTDEBUG(sdlog, "Regular size = " << nSizeRegular);
-        KTDEBUG(sdlog, "Short size = " << nSizeShort);
+        BlockTransformMap::const_iterator it = fBlockTransforms.find( size );
+        if( it != fBlockTransforms.end() ) return it->second;
 
-        if( nSizeShort > nSizeRegular )
-        {
-            KTWARN(sdlog, "Short size is larger than regular size; something weird happened. Aborting DFT initialization");
-            return;
-        }
+        KTDEBUG(sdlog, "Creating DFT plans and kernel transform for block size " << size);
 
-        if( fInitialized )
-        {
-            KTDEBUG(sdlog, "Already initialized! Freeing arrays first");
-            FreeArrays();
-        }
+        BlockTransform& transform = fBlockTransforms[size];
+        transform.fSize = size;
 
-        // Input/Output arrays
-        fInputArrayReal = (double*) fftw_malloc( sizeof( double ) * nSizeRegular );
-        fOutputArrayReal = (double*) fftw_malloc( sizeof( double ) * nSizeRegular );
-        fInputArrayComplex = (fftw_complex*) fftw_malloc( sizeof( fftw_complex ) * nSizeRegular );
-        fOutputArrayComplex = (fftw_complex*) fftw_malloc( sizeof( fftw_complex ) * nSizeRegular );
-
-        // Intermediate (fourier space) arrays
-        fTransformedInputArray = (fftw_complex*) fftw_malloc( sizeof( fftw_complex ) * nSizeRegular );
-        fTransformedOutputArray = (fftw_complex*) fftw_malloc( sizeof( fftw_complex ) * nSizeRegular );
-        fTransformedInputArrayFromReal = (fftw_complex*) fftw_malloc( sizeof( fftw_complex ) * (nSizeRegular/2 + 1) );
-        fTransformedOutputArrayFromReal = (fftw_complex*) fftw_malloc( sizeof( fftw_complex ) * (nSizeRegular/2 + 1) );
-
-        // DFT plans
-        fRealToComplexPlan = fftw_plan_dft_r2c_1d( nSizeRegular, fInputArrayReal, fTransformedInputArrayFromReal, fTransformFlagUnsigned );
-        fComplexToRealPlan = fftw_plan_dft_c2r_1d( nSizeRegular, fTransformedOutputArrayFromReal, fOutputArrayReal, fTransformFlagUnsigned );
-        fC2CForwardPlan = fftw_plan_dft_1d( nSizeRegular, fInputArrayComplex, fTransformedInputArray, FFTW_FORWARD, fTransformFlagUnsigned );
-        fC2CReversePlan = fftw_plan_dft_1d( nSizeRegular, fTransformedOutputArray, fOutputArrayComplex, FFTW_BACKWARD, fTransformFlagUnsigned );
-
-        fRealToComplexPlanShort = fftw_plan_dft_r2c_1d( nSizeShort, fInputArrayReal, fTransformedInputArrayFromReal, fTransformFlagUnsigned );
-        fComplexToRealPlanShort = fftw_plan_dft_c2r_1d( nSizeShort, fTransformedOutputArrayFromReal, fOutputArrayReal, fTransformFlagUnsigned );
-        fC2CForwardPlanShort = fftw_plan_dft_1d( nSizeShort, fInputArrayComplex, fTransformedInputArray, FFTW_FORWARD, fTransformFlagUnsigned );
-        fC2CReversePlanShort = fftw_plan_dft_1d( nSizeShort, fTransformedOutputArray, fOutputArrayComplex, FFTW_BACKWARD, fTransformFlagUnsigned );
-
-        // All the same for short size
-        // But we can skip this if the size is chosen right
-
-        if( nSizeShort == fKernelSize - 1 )
-        {
-            KTINFO(sdlog, "Input blocks are divided evenly! I will only initialize one group of FFTW plans");
+        // The plans are made with these arrays, and executed on the per-thread buffers, which have the same alignment since they also come from fftw_malloc
+        double* inputReal = (double*) fftw_malloc( sizeof( double ) * size );
+        double* outputReal = (double*) fftw_malloc( sizeof( double ) * size );
+        fftw_complex* inputComplex = (fftw_complex*) fftw_malloc( sizeof( fftw_complex ) * size );
+        fftw_complex* outputComplex = (fftw_complex*) fftw_malloc( sizeof( fftw_complex ) * size );
+        fftw_complex* transformedInput = (fftw_complex*) fftw_malloc( sizeof( fftw_complex ) * size );
+        fftw_complex* transformedOutput = (fftw_complex*) fftw_malloc( sizeof( fftw_complex ) * size );
 
-            fRegularSize = nSizeRegular;
-            fShortSize = nSizeShort;
-            fInitialized = true;
+        transform.fRealToComplexPlan = fftw_plan_dft_r2c_1d( size, inputReal, transformedInput, fTransformFlagUnsigned );
+        transform.fComplexToRealPlan = fftw_plan_dft_c2r_1d( size, transformedOutput, outputReal, fTransformFlagUnsigned );
+        transform.fC2CForwardPlan = fftw_plan_dft_1d( size, inputComplex, transformedInput, FFTW_FORWARD, fTransformFlagUnsigned );
+        transform.fC2CReversePlan = fftw_plan_dft_1d( size, transformedOutput, outputComplex, FFTW_BACKWARD, fTransformFlagUnsigned );
 
-            return;
+        // Transform the kernel, zero-padded to this block size
+        int nKernelBins = std::min( size, (int)kernelX.size() );
+        for( int iBin = 0; iBin < size; ++iBin )
+        {
+            inputReal[iBin] = iBin < nKernelBins ? kernelX[iBin] : 0.;
+            inputComplex[iBin][0] = inputReal[iBin];
+            inputComplex[iBin][1] = 0.;
         }
 
-        // Store these guys
-        fRegularSize = nSizeRegular;
-        fShortSize = nSizeShort;
+        transform.fKernelAsReal = (fftw_complex*) fftw_malloc( sizeof( fftw_complex ) * (size/2 + 1) );
+        transform.fKernelAsComplex = (fftw_complex*) fftw_malloc( sizeof( fftw_complex ) * size );
+        fftw_execute_dft_r2c( transform.fRealToComplexPlan, inputReal, transform.fKernelAsReal );
+        fftw_execute_dft( transform.fC2CForwardPlan, inputComplex, transform.fKernelAsComplex );
 
-        // Make sure we don't come back here unless something weird happens
-        fInitialized = true;
+        fftw_free( inputReal );
+        fftw_free( outputReal );
+        fftw_free( inputComplex );
+        fftw_free( outputComplex );
+        fftw_free( transformedInput );
+        fftw_free( transformedOutput );
 
-        return;
-    }  
+        return transform;
+    }
 
-    void KTConvolution1D::FreeArrays()
+    void KTConvolution1D::AllocateBuffers( unsigned nThreads, int size )
     {
-        if( fInputArrayReal != nullptr )
-        {
-            fftw_free( fInputArrayReal );
-            fInputArrayReal = nullptr;
-        }
-        if( fOutputArrayReal != nullptr )
-        {
-            fftw_free( fOutputArrayReal );
-            fOutputArrayReal = nullptr;
-        }
-        if( fInputArrayComplex != nullptr )
-        {
-            fftw_free( fInputArrayComplex );
-            fInputArrayComplex = nullptr;
-        }
-        if( fOutputArrayComplex != nullptr )
-        {
-            fftw_free( fOutputArrayComplex );
-            fOutputArrayComplex = nullptr;
-        }
+        KTDEBUG(sdlog, "Allocating buffers of size " << size << " for " << nThreads << " thread(s)");
 
-        if( fTransformedInputArray != nullptr )
+        for( unsigned iThread = 0; iThread < fBlockBuffers.size(); ++iThread )
         {
-            fftw_free( fTransformedInputArray );
-            fTransformedInputArray = nullptr;
+            BlockBuffers& buffers = fBlockBuffers[iThread];
+            fftw_free( buffers.fInputArrayReal );
+            fftw_free( buffers.fOutputArrayReal );
+            fftw_free( buffers.fInputArrayComplex );
+            fftw_free( buffers.fOutputArrayComplex );
+            fftw_free( buffers.fTransformedInputArray );
+            fftw_free( buffers.fTransformedOutputArray );
         }
 
-        if( fTransformedOutputArray != nullptr )
+        fBlockBuffers.resize( nThreads );
+        for( unsigned iThread = 0; iThread < nThreads; ++iThread )
         {
-            fftw_free( fTransformedOutputArray );
-            fTransformedOutputArray = nullptr;
+            BlockBuffers& buffers = fBlockBuffers[iThread];
+            buffers.fSize = size;
+            buffers.fInputArrayReal = (double*) fftw_malloc( sizeof( double ) * size );
+            buffers.fOutputArrayReal = (double*) fftw_malloc( sizeof( double ) * size );
+            buffers.fInputArrayComplex = (fftw_complex*) fftw_malloc( sizeof( fftw_complex ) * size );
+            buffers.fOutputArrayComplex = (fftw_complex*) fftw_malloc( sizeof( fftw_complex ) * size );
+            // complex-to-complex transforms need all size bins; real-to-complex transforms use the first size/2 + 1
+            buffers.fTransformedInputArray = (fftw_complex*) fftw_malloc( sizeof( fftw_complex ) * size );
+            buffers.fTransformedOutputArray = (fftw_complex*) fftw_malloc( sizeof( fftw_complex ) * size );
         }
 
-        if( fRealToComplexPlan != nullptr )
-        {
-            fftw_destroy_plan( fRealToComplexPlan );
-            fRealToComplexPlan = nullptr;
-        }
-        if( fComplexToRealPlan != nullptr )
-        {
-            fftw_destroy_plan( fComplexToRealPlan );
-            fComplexToRealPlan = nullptr;
-        }
-        if( fC2CForwardPlan != nullptr )
-        {
-            fftw_destroy_plan( fC2CForwardPlan );
-            fC2CForwardPlan = nullptr;
-        }
-        if( fC2CReversePlan != nullptr )
-        {
-            fftw_destroy_plan( fC2CReversePlan );
-            fC2CReversePlan = nullptr;
-        }
+        return;
+    }
 
-        if( fRealToComplexPlanShort != nullptr )
-        {
-            fftw_destroy_plan( fRealToComplexPlanShort );
-            fRealToComplexPlanShort = nullptr;
-        }
-        if( fComplexToRealPlanShort != nullptr )
-        {
-            fftw_destroy_plan( fComplexToRealPlanShort );
-            fComplexToRealPlanShort = nullptr;
-        }
-        if( fC2CForwardPlanShort != nullptr )
-        {
-            fftw_destroy_plan( fC2CForwardPlanShort );
-            fC2CForwardPlanShort = nullptr;
-        }
-        if( fC2CReversePlanShort != nullptr )
+    void KTConvolution1D::FreeArrays()
+    {
+        AllocateBuffers( 0, 0 );
+
+        for( BlockTransformMap::iterator it = fBlockTransforms.begin(); it != fBlockTransforms.end(); ++it )
         {
-            fftw_destroy_plan( fC2CReversePlanShort );
-            fC2CReversePlanShort = nullptr;
+            fftw_destroy_plan( it->second.fRealToComplexPlan );
+            fftw_destroy_plan( it->second.fComplexToRealPlan );
+            fftw_destroy_plan( it->second.fC2CForwardPlan );
+            fftw_destroy_plan( it->second.fC2CReversePlan );
+            fftw_free( it->second.fKernelAsReal );
+            fftw_free( it->second.fKernelAsComplex );
         }
+        fBlockTransforms.clear();
 
         fInitialized = false;
 
@@ -297,7 +226,10 @@ namespace Katydid
 
         // Fill kernel vector
         // Also calculate the norm in case we need that
+        // Any transforms of a previous kernel are no longer valid
 
+        FreeArrays();
+        kernelX.clear();
         double norm = 0.;
         for( int iValue = 0; iValue < fKernelSize; ++iValue )
         {
@@ -369,60 +301,6 @@ namespace Katydid
         return CoreConvolve1D( static_cast< KTFrequencySpectrumDataPolarCore& >(data), newData );
     }
 
-    template< class XSpectraType >
-    bool KTConvolution1D::SetUpGeneralVars()
-    {
-        return false;
-    }
-
-    template<>
-    bool KTConvolution1D::SetUpGeneralVars< KTPowerSpectrum* >()
-    {
-        fGeneralTransformedInputArray = fTransformedInputArrayFromReal;
-        fGeneralTransformedOutputArray = fTransformedOutputArrayFromReal;
-        fGeneralTransformedKernelArray = fTransformedKernelXAsReal;
-        fGeneralForwardPlan = fRealToComplexPlan;
-        fGeneralForwardPlanShort = fRealToComplexPlanShort;
-        fGeneralReversePlan = fComplexToRealPlan;
-        fGeneralReversePlanShort = fComplexToRealPlanShort;
-        nBinLimitRegular = fRegularSize/2 + 1;
-        nBinLimitShort = fShortSize/2 + 1;
-
-        return true;
-    }
-
-    template<>
-    bool KTConvolution1D::SetUpGeneralVars< KTFrequencySpectrumFFTW* >()
-    {
-        fGeneralTransformedInputArray = fTransformedInputArray;
-        fGeneralTransformedOutputArray = fTransformedOutputArray;
-        fGeneralTransformedKernelArray = fTransformedKernelXAsComplex;
-        fGeneralForwardPlan = fC2CForwardPlan;
-        fGeneralForwardPlanShort = fC2CForwardPlanShort;
-        fGeneralReversePlan = fC2CReversePlan;
-        fGeneralReversePlanShort = fC2CReversePlanShort;
-        nBinLimitRegular = fRegularSize;
-        nBinLimitShort = fShortSize;
-
-        return true;
-    }
-
-    template<>
-    bool KTConvolution1D::SetUpGeneralVars< KTFrequencySpectrumPolar* >()
-    {
-        fGeneralTransformedInputArray = fTransformedInputArray;
-        fGeneralTransformedOutputArray = fTransformedOutputArray;
-        fGeneralTransformedKernelArray = fTransformedKernelXAsComplex;
-        fGeneralForwardPlan = fC2CForwardPlan;
-        fGeneralForwardPlanShort = fC2CForwardPlanShort;
-        fGeneralReversePlan = fC2CReversePlan;
-        fGeneralReversePlanShort = fC2CReversePlanShort;
-        nBinLimitRegular = fRegularSize;
-        nBinLimitShort = fShortSize;
-
-        return true;
-    }
-
     void KTConvolution1D::ConjugateAndReverse( KTPowerSpectrum& spectrum )
     {
         double temp;
@@ -469,69 +347,112 @@ namespace Katydid
         return;
     }
 
-    void KTConvolution1D::SetInputArray( int position, int nBin, const KTPowerSpectrum* initialSpectrum )
+    void KTConvolution1D::SetInputArray( int position, int nBin, const KTPowerSpectrum* initialSpectrum, BlockBuffers& buffers )
     {
 
-        if( position < 0 ) { fInputArrayReal[nBin] = 0.0; }
-        else { fInputArrayReal[nBin] = (*initialSpectrum)(position); }
+        if( position < 0 ) { buffers.fInputArrayReal[nBin] = 0.0; }
+        else { buffers.fInputArrayReal[nBin] = (*initialSpectrum)(position); }
 
         return;
     }
 
-    void KTConvolution1D::SetInputArray( int position, int nBin, const KTFrequencySpectrumFFTW* initialSpectrum )
+    void KTConvolution1D::SetInputArray( int position, int nBin, const KTFrequencySpectrumFFTW* initialSpectrum, BlockBuffers& buffers )
     {
         if( position < 0 )
         {
-            fInputArrayComplex[nBin][0] = 0.0;
-            fInputArrayComplex[nBin][1] = 0.0;
+            buffers.fInputArrayComplex[nBin][0] = 0.0;
+            buffers.fInputArrayComplex[nBin][1] = 0.0;
         }
         else
         {
-            fInputArrayComplex[nBin][0] = (*initialSpectrum)(position)[0];
-            fInputArrayComplex[nBin][1] = (*initialSpectrum)(position)[1];
+            buffers.fInputArrayComplex[nBin][0] = (*initialSpectrum)(position)[0];
+            buffers.fInputArrayComplex[nBin][1] = (*initialSpectrum)(position)[1];
         }
 
         return;
     }
 
-    void KTConvolution1D::SetInputArray( int position, int nBin, const KTFrequencySpectrumPolar* initialSpectrum )
+    void KTConvolution1D::SetInputArray( int position, int nBin, const KTFrequencySpectrumPolar* initialSpectrum, BlockBuffers& buffers )
     {
         if( position < 0 )
         {
-            fInputArrayComplex[nBin][0] = 0.0;
-            fInputArrayComplex[nBin][1] = 0.0;
+            buffers.fInputArrayComplex[nBin][0] = 0.0;
+            buffers.fInputArrayComplex[nBin][1] = 0.0;
         }
         else
         {
-            fInputArrayComplex[nBin][0] = initialSpectrum->GetReal(position);
-            fInputArrayComplex[nBin][1] = initialSpectrum->GetImag(position);
+            buffers.fInputArrayComplex[nBin][0] = initialSpectrum->GetReal(position);
+            buffers.fInputArrayComplex[nBin][1] = initialSpectrum->GetImag(position);
         }
 
         return;
     }
 
-    void KTConvolution1D::SetOutputArray( int position, int nBin, KTPowerSpectrum& transformedPS, double norm )
+    void KTConvolution1D::SetOutputArray( int position, int nBin, KTPowerSpectrum& transformedPS, double norm, const BlockBuffers& buffers )
     {
-        transformedPS(position) = fOutputArrayReal[nBin] / (double)norm;
+        transformedPS(position) = buffers.fOutputArrayReal[nBin] / (double)norm;
 
         return;
     }
 
-    void KTConvolution1D::SetOutputArray( int position, int nBin, KTFrequencySpectrumFFTW& transformedFSFFTW, double norm )
+    void KTConvolution1D::SetOutputArray( int position, int nBin, KTFrequencySpectrumFFTW& transformedFSFFTW, double norm, const BlockBuffers& buffers )
     {
-        transformedFSFFTW(position)[0] = fOutputArrayComplex[nBin][0] / (double)norm;
-        transformedFSFFTW(position)[1] = fOutputArrayComplex[nBin][1] / (double)norm;
+        transformedFSFFTW(position)[0] = buffers.fOutputArrayComplex[nBin][0] / (double)norm;
+        transformedFSFFTW(position)[1] = buffers.fOutputArrayComplex[nBin][1] / (double)norm;
 
         return;
     }
 
-    void KTConvolution1D::SetOutputArray( int position, int nBin, KTFrequencySpectrumPolar& transformedFSPolar, double norm )
+    void KTConvolution1D::SetOutputArray( int position, int nBin, KTFrequencySpectrumPolar& transformedFSPolar, double norm, const BlockBuffers& buffers )
     {
-        transformedFSPolar.SetRect( position, fOutputArrayComplex[nBin][0] / (double)norm, fOutputArrayComplex[nBin][1] / (double)norm );
+        transformedFSPolar.SetRect( position, buffers.fOutputArrayComplex[nBin][0] / (double)norm, buffers.fOutputArrayComplex[nBin][1] / (double)norm );
 
         return;
     }
 
+    void KTConvolution1D::TransformBlock( const BlockTransform& transform, BlockBuffers& buffers, const KTPowerSpectrum* )
+    {
+        fftw_execute_dft_r2c( transform.fRealToComplexPlan, buffers.fInputArrayReal, buffers.fTransformedInputArray );
+
+        const fftw_complex* input = buffers.fTransformedInputArray;
+        const fftw_complex* kernel = transform.fKernelAsReal;
+        fftw_complex* output = buffers.fTransformedOutputArray;
+        int nBinLimit = transform.fSize/2 + 1;
+        for( int nBin = 0; nBin < nBinLimit; ++nBin )
+        {
+            output[nBin][0] = input[nBin][0] * kernel[nBin][0] - input[nBin][1] * kernel[nBin][1];
+            output[nBin][1] = input[nBin][0] * kernel[nBin][1] + input[nBin][1] * kernel[nBin][0];
+        }
+
+        fftw_execute_dft_c2r( transform.fComplexToRealPlan, buffers.fTransformedOutputArray, buffers.fOutputArrayReal );
+        return;
+    }
+
+    void KTConvolution1D::TransformBlock( const BlockTransform& transform, BlockBuffers& buffers, const KTFrequencySpectrumFFTW* )
+    {
+        fftw_execute_dft( transform.fC2CForwardPlan, buffers.fInputArrayComplex, buffers.fTransformedInputArray );
+
+        const fftw_complex* input = buffers.fTransformedInputArray;
+        const fftw_complex* kernel = transform.fKernelAsComplex;
+        fftw_complex* output = buffers.fTransformedOutputArray;
+        int nBinLimit = transform.fSize;
+        for( int nBin = 0; nBin < nBinLimit; ++nBin )
+        {
+            output[nBin][0] = input[nBin][0] * kernel[nBin][0] - input[nBin][1] * kernel[nBin][1];
+            output[nBin][1] = input[nBin][0] * kernel[nBin][1] + input[nBin][1] * kernel[nBin][0];
+        }
+
+        fftw_execute_dft( transform.fC2CReversePlan, buffers.fTransformedOutputArray, buffers.fOutputArrayComplex );
+        return;
+    }
+
+    void KTConvolution1D::TransformBlock( const BlockTransform& transform, BlockBuffers& buffers, const KTFrequencySpectrumPolar* )
+    {
+        // polar spectra are copied into the same complex arrays as FFTW spectra
+        TransformBlock( transform, buffers, (const KTFrequencySpectrumFFTW*)nullptr );
+        return;
+    }
+
     void KTConvolution1D::SetupInternalMaps()
     {
         KTDEBUG(sdlog, "Setting up internal maps");
@@ -560,43 +481,38 @@ namespace Katydid
 
     void KTConvolution1D::Initialize( int nBinsTotal, int block, int step, int overlap )
     {
-        KTINFO(sdlog, "DFTs are not yet initialized; doing so now");
+        // The regular blocks cover the first (nBinsTotal / step) * step output bins;
+        // if there are any left over, a short block covers them and the overlap before them
+        fRegularSize = block;
+        fShortSize = nBinsTotal % step == 0 ? 0 : nBinsTotal % step + overlap;
 
-        // Slightly obnoxious conditionals to determine the sizes
-        // Ordinary block is given, but the shorter block at the end is harder
-        // Maybe there is a simpler way to determine this, I'm not sure
+        if( ! fInitialized )
+        {
+            KTINFO(sdlog, "DFTs are not yet initialized; doing so now");
+        }
 
-        if( (nBinsTotal + overlap) % step >= overlap )
+        GetBlockTransform( block );
+        if( fShortSize > 0 )
         {
-            AllocateArrays( block, (nBinsTotal + overlap) % step );
+            GetBlockTransform( (int)fShortSize );
         }
         else
         {
-            AllocateArrays( block, ((nBinsTotal + overlap) % step) + step );
+            KTDEBUG(sdlog, "Input blocks are divided evenly; no short block is needed");
         }
 
-        // Also transform the kernel, we only need to do this once
-        KTDEBUG(sdlog, "Transforming kernel");
-
-        for( int iBin = 0; iBin < block; ++iBin )
+#ifdef USE_OPENMP
+        unsigned nThreads = omp_get_max_threads();
+#else
+        unsigned nThreads = 1;
+#endif
+        if( fBlockBuffers.size() < nThreads || fBlockBuffers[0].fSize < block )
         {
-            fInputArrayReal[iBin] = kernelX[iBin];
-            fInputArrayComplex[iBin][0] = kernelX[iBin];
-            fInputArrayComplex[iBin][1] = 0.;
+            AllocateBuffers( nThreads, block );
         }
 
-        fftw_execute( fRealToComplexPlan );
-        fftw_execute( fC2CForwardPlan );
-        
-        fTransformedKernelXAsReal = new fftw_complex[block];
-        fTransformedKernelXAsComplex = new fftw_complex[block];
-        for( int iBin = 0; iBin < block; ++iBin )
-        {
-            fTransformedKernelXAsReal[iBin][0] = fTransformedInputArrayFromReal[iBin][0];
-            fTransformedKernelXAsReal[iBin][1] = fTransformedInputArrayFromReal[iBin][1];
-            fTransformedKernelXAsComplex[iBin][0] = fTransformedInputArray[iBin][0];
-            fTransformedKernelXAsComplex[iBin][1] = fTransformedInputArray[iBin][1];
-        }
+        fInitialized = true;
+        return;
     }
 
 
@@ -24,6 +24,10 @@
 #include <map>
 #include <iostream>
 
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
 namespace Katydid
 {
     
@@ -52,6 +56,15 @@ namespace Katydid
      Uses the overlap-save method to efficiently calculate the convolution. The input is broken up into blocks of size N, where
      N can be specified at runtime or determined automatically. N must be larger than the size of the kernel, and a power of 2 is recommended
      to maximize the FFT efficiency.
+
+     Each block is independent of the others, so the blocks are convolved in parallel when OpenMP is enabled
+     (Katydid_USE_OPENMP); otherwise they're convolved one after another in a single thread.
+     The FFTW plans are shared by all threads and executed with the new-array functions (fftw_execute_dft etc.) on buffers
+     owned by each thread. The plans and the transform of the kernel are made once per block size and cached;
+     the last block of a spectrum is usually shorter than the others, and it has its own plans and kernel transform.
+
+     ConvolveBatch() convolves several spectra (e.g. all of the components of a data object, or a stripe of spectra)
+     in one parallel pass over all of their blocks.
   
      Configuration name: "convolution"
 
@@ -96,6 +109,30 @@ namespace Katydid
 
             void SetTransformFlag(const std::string& flag);
 
+        private:
+            /// FFTW plans and kernel transform for one block size
+            struct BlockTransform
+            {
+                int fSize;
+                fftw_plan fRealToComplexPlan;
+                fftw_plan fComplexToRealPlan;
+                fftw_plan fC2CForwardPlan;
+                fftw_plan fC2CReversePlan;
+                fftw_complex* fKernelAsReal; // fSize/2 + 1 bins
+                fftw_complex* fKernelAsComplex; // fSize bins
+            };
+
+            /// Working arrays for one thread; large enough for the regular block size
+            struct BlockBuffers
+            {
+                int fSize;
+                double* fInputArrayReal;
+                double* fOutputArrayReal;
+                fftw_complex* fInputArrayComplex;
+                fftw_complex* fOutputArrayComplex;
+                fftw_complex* fTransformedInputArray;
+                fftw_complex* fTransformedOutputArray;
+            };
 
         private:
 
@@ -103,39 +140,11 @@ namespace Katydid
 
             typedef std::map< std::string, unsigned > TransformFlagMap;
             TransformFlagMap fTransformFlagMap;
-            
-            fftw_plan fComplexToRealPlan;
-            fftw_plan fRealToComplexPlan;
-            fftw_plan fC2CForwardPlan;
-            fftw_plan fC2CReversePlan;
-
-            fftw_plan fComplexToRealPlanShort;
-            fftw_plan fRealToComplexPlanShort;
-            fftw_plan fC2CForwardPlanShort;
-            fftw_plan fC2CReversePlanShort;
-
-            double *fInputArrayReal;
-            double *fOutputArrayReal;
-            fftw_complex *fInputArrayComplex;
-            fftw_complex *fOutputArrayComplex;
-
-            fftw_complex *fTransformedInputArray;
-            fftw_complex *fTransformedOutputArray;
-            fftw_complex *fTransformedInputArrayFromReal;
-            fftw_complex *fTransformedOutputArrayFromReal;
-
-            fftw_complex *fTransformedKernelXAsReal;
-            fftw_complex *fTransformedKernelXAsComplex;
-
-            fftw_complex* fGeneralTransformedInputArray;
-            fftw_complex* fGeneralTransformedOutputArray;
-            fftw_complex* fGeneralTransformedKernelArray;
-            int nBinLimitRegular;
-            int nBinLimitShort;
-            fftw_plan fGeneralForwardPlan;
-            fftw_plan fGeneralReversePlan;
-            fftw_plan fGeneralForwardPlanShort;
-            fftw_plan fGeneralReversePlanShort;
+
+            typedef std::map< int, BlockTransform > BlockTransformMap;
+            BlockTransformMap fBlockTransforms;
+
+            std::vector< BlockBuffers > fBlockBuffers;
 
             unsigned fTransformFlagUnsigned;
             int fKernelSize;
@@ -156,30 +165,43 @@ namespace Katydid
             const KTFrequencySpectrumFFTW* GetSpectrum( KTFrequencySpectrumDataFFTWCore& data, unsigned iComponent );
             const KTFrequencySpectrumPolar* GetSpectrum( KTFrequencySpectrumDataPolarCore& data, unsigned iComponent );
 
+            /// Convolves one spectrum; returns a new spectrum owned by the caller
             template< class XSpectraType >
             XSpectraType* DoConvolution( const XSpectraType* initialSpectrum, const int block, const int step, const int overlap );
 
+            /// Convolves several spectra with the same number of bins in one parallel pass; the new spectra are owned by the caller
             template< class XSpectraType >
-            bool SetUpGeneralVars();
+            bool ConvolveBatch( const std::vector< const XSpectraType* >& initialSpectra, std::vector< XSpectraType* >& transformedSpectra, const int block, const int step, const int overlap );
 
             void ConjugateAndReverse( KTPowerSpectrum& spectrum );
             void ConjugateAndReverse( KTFrequencySpectrumFFTW& spectrum );
             void ConjugateAndReverse( KTFrequencySpectrumPolar& spectrum );
 
-            void SetInputArray( int position, int nBin, const KTPowerSpectrum* initialSpectrum );
-            void SetInputArray( int position, int nBin, const KTFrequencySpectrumFFTW* initialSpectrum );
-            void SetInputArray( int position, int nBin, const KTFrequencySpectrumPolar* initialSpectrum );
+            void SetInputArray( int position, int nBin, const KTPowerSpectrum* initialSpectrum, BlockBuffers& buffers );
+            void SetInputArray( int position, int nBin, const KTFrequencySpectrumFFTW* initialSpectrum, BlockBuffers& buffers );
+            void SetInputArray( int position, int nBin, const KTFrequencySpectrumPolar* initialSpectrum, BlockBuffers& buffers );
+
+            void SetOutputArray( int position, int nBin, KTPowerSpectrum& transformedPS, double norm, const BlockBuffers& buffers );
+            void SetOutputArray( int position, int nBin, KTFrequencySpectrumFFTW& transformedFSFFTW, double norm, const BlockBuffers& buffers );
+            void SetOutputArray( int position, int nBin, KTFrequencySpectrumPolar& transformedFSPolar, double norm, const BlockBuffers& buffers );
 
-            void SetOutputArray( int position, int nBin, KTPowerSpectrum& transformedPS, double norm );
-            void SetOutputArray( int position, int nBin, KTFrequencySpectrumFFTW& transformedFSFFTW, double norm );
-            void SetOutputArray( int position, int nBin, KTFrequencySpectrumPolar& transformedFSPolar, double norm );
+            /// Transforms the input block in buffers, multiplies by the kernel, and transforms back
+            void TransformBlock( const BlockTransform& transform, BlockBuffers& buffers, const KTPowerSpectrum* );
+            void TransformBlock( const BlockTransform& transform, BlockBuffers& buffers, const KTFrequencySpectrumFFTW* );
+            void TransformBlock( const BlockTransform& transform, BlockBuffers& buffers, const KTFrequencySpectrumPolar* );
+
+            /// Convolves the block of initialSpectrum that starts at position start (which is negative for the first block)
+            template< class XSpectraType >
+            void ConvolveBlock( const XSpectraType* initialSpectrum, XSpectraType& transformedSpectrum, int start, int overlap, const BlockTransform& transform, BlockBuffers& buffers );
 
             void SetupInternalMaps();
 
             bool FinishSetup();
+            /// Makes the plans and kernel transforms for the regular and short blocks of a spectrum with nBinsTotal bins, and the per-thread buffers
             void Initialize( int nBinsTotal, int block, int step, int overlap );
 
-            void AllocateArrays( int nSizeRegular, int nSizeShort );
+            const BlockTransform& GetBlockTransform( int size );
+            void AllocateBuffers( unsigned nThreads, int size );
             void FreeArrays();
 
             //***************
@@ -218,33 +240,23 @@ namespace Katydid
         KTINFO(convlog_hh, "Overlap: " << overlap);
         KTINFO(convlog_hh, "Step size: " << step);
 
-        int nBinsTotal = GetSpectrum( data, 0 )->GetNFrequencyBins();
-        KTINFO(convlog_hh, "nBinsTotal = " << nBinsTotal);
+        // All of the components are convolved together
+        std::vector< const typename XSpectrumDataCore::spectrum_type* > initialSpectra( data.GetNComponents() );
+        for( unsigned iComponent = 0; iComponent < data.GetNComponents(); ++iComponent )
+        {
+            initialSpectra[iComponent] = GetSpectrum( data, iComponent );
+        }
 
-        // Now that nBinsTotal is determined, we can initialize the DFTs
-        // The following conditional should only be true on the first slice
-        if( ! fInitialized )
+        std::vector< typename XSpectrumDataCore::spectrum_type* > transformedSpectra;
+        if( ! ConvolveBatch( initialSpectra, transformedSpectra, block, step, overlap ) )
         {
-            Initialize( nBinsTotal, block, step, overlap );
+            KTERROR( convlog_hh, "Convolution was unsuccessful. Aborting." );
+            return false;
         }
 
-        // First loop over components
         for( unsigned iComponent = 0; iComponent < data.GetNComponents(); ++iComponent )
         {
-            KTINFO(convlog_hh, "Starting component: " << iComponent);
-
-            // Get power spectrum and initialize convolved spectrum for this component
-            typename XSpectrumDataCore::spectrum_type* transformedSpectrum = DoConvolution( GetSpectrum( data, iComponent ), block, step, overlap );
-
-            if( transformedSpectrum == nullptr )
-            {
-                KTERROR( convlog_hh, "Convolution was unsuccessful. Aborting." );
-                return false;
-            }
-
-            // Set power spectrum
-            newData.SetSpectrum( transformedSpectrum, iComponent );
-            KTDEBUG(convlog_hh, "Filled new spectrum");
+            newData.SetSpectrum( transformedSpectra[iComponent], iComponent );
         }
 
         KTINFO(convlog_hh, "All components finished successfully!");
@@ -253,117 +265,103 @@ namespace Katydid
     }
 
     template< class XSpectraType >
-    XSpectraType* KTConvolution1D::DoConvolution( const XSpectraType* myInitialSpectrum, const int block, const int step, const int overlap )
+    XSpectraType* KTConvolution1D::DoConvolution( const XSpectraType* initialSpectrum, const int block, const int step, const int overlap )
     {
-        int nBinsTotal = myInitialSpectrum->GetNFrequencyBins();
-
-        // non-const version
-        XSpectraType* initialSpectrum = new XSpectraType( *myInitialSpectrum );
-
-        // If we're doing cross-correlation, first we need to conjugate and reverse the input spectrum
-        if( fTransformType == "cross-correlation" )
+        std::vector< const XSpectraType* > initialSpectra( 1, initialSpectrum );
+        std::vector< XSpectraType* > transformedSpectra;
+        if( ! ConvolveBatch( initialSpectra, transformedSpectra, block, step, overlap ) )
         {
-            ConjugateAndReverse( *initialSpectrum );
+            return nullptr;
         }
+        return transformedSpectra[0];
+    }
 
-        XSpectraType* transformedSpectrum = new XSpectraType( nBinsTotal, initialSpectrum->GetRangeMin(), initialSpectrum->GetRangeMax() );
-
-        if( ! SetUpGeneralVars< XSpectraType* >() )
-        {
-            KTERROR(convlog_hh, "Spectrum type unknown. Returning blank spectrum");
-            return transformedSpectrum;
-        }
+    template< class XSpectraType >
+    bool KTConvolution1D::ConvolveBatch( const std::vector< const XSpectraType* >& myInitialSpectra, std::vector< XSpectraType* >& transformedSpectra, const int block, const int step, const int overlap )
+    {
+        transformedSpectra.clear();
+        if( myInitialSpectra.empty() ) return true;
 
-        // Loop over block numbers
-        int blockNumber = 0;
-        int position = 0;
-        while( (blockNumber+1) * step <= nBinsTotal )
+        int nBinsTotal = myInitialSpectra[0]->GetNFrequencyBins();
+        KTDEBUG(convlog_hh, "nBinsTotal = " << nBinsTotal);
+        for( unsigned iSpectrum = 1; iSpectrum < myInitialSpectra.size(); ++iSpectrum )
         {
-            KTDEBUG(convlog_hh, "Block number: " << blockNumber);
-            KTDEBUG(convlog_hh, "Starting position: " << blockNumber * step - overlap);
-            KTDEBUG(convlog_hh, "nBinsTotal: " << nBinsTotal);
-
-            // Fill input array
-            for( int nBin = 0; nBin < block; ++nBin )
+            if( (int)myInitialSpectra[iSpectrum]->GetNFrequencyBins() != nBinsTotal )
             {
-                position = nBin + blockNumber * step - overlap;
-                SetInputArray( position, nBin, initialSpectrum );
+                KTERROR(convlog_hh, "All of the spectra in a batch must have the same size; spectrum " << iSpectrum << " has " << myInitialSpectra[iSpectrum]->GetNFrequencyBins() << " bins, instead of " << nBinsTotal);
+                return false;
             }
+        }
 
-            // FFT of input block
-            KTDEBUG(convlog_hh, "Performing DFT");
-            fftw_execute( fGeneralForwardPlan );
-
-            // Bin multiplication in fourier space
-            KTDEBUG(convlog_hh, "Multiplying arrays in fourier space");
-
-            for( int nBin = 0; nBin < nBinLimitRegular; ++nBin )
-            {
-                fGeneralTransformedOutputArray[nBin][0] = fGeneralTransformedInputArray[nBin][0] * fGeneralTransformedKernelArray[nBin][0] - fGeneralTransformedInputArray[nBin][1] * fGeneralTransformedKernelArray[nBin][1];
-                fGeneralTransformedOutputArray[nBin][1] = fGeneralTransformedInputArray[nBin][0] * fGeneralTransformedKernelArray[nBin][1] + fGeneralTransformedInputArray[nBin][1] * fGeneralTransformedKernelArray[nBin][0];
-            }
+        // Plans and kernel transforms are made (and cached) before the blocks are handed out to threads
+        Initialize( nBinsTotal, block, step, overlap );
+        const BlockTransform& regularTransform = GetBlockTransform( block );
+        const BlockTransform* shortTransform = fShortSize > 0 ? &GetBlockTransform( (int)fShortSize ) : nullptr;
 
-            // Reverse FFT of output block
-            KTDEBUG(convlog_hh, "Performing reverse DFT");
-            fftw_execute( fGeneralReversePlan );
+        // Regular blocks, plus the short block at the end if the blocks don't divide the spectrum evenly
+        int nRegularBlocks = nBinsTotal / step;
+        int nBlocks = nRegularBlocks + (shortTransform == nullptr ? 0 : 1);
+        KTDEBUG(convlog_hh, "Convolving " << myInitialSpectra.size() << " spectra in " << nBlocks << " blocks each");
 
-            // Loop over bins in the output block and fill the convolved spectrum
-            for( int nBin = overlap; nBin < block; ++nBin )
+        std::vector< const XSpectraType* > initialSpectra( myInitialSpectra );
+        std::vector< XSpectraType* > reversedSpectra;
+        for( unsigned iSpectrum = 0; iSpectrum < myInitialSpectra.size(); ++iSpectrum )
+        {
+            // If we're doing cross-correlation, first we need to conjugate and reverse the input spectrum
+            if( fTransformType == "cross-correlation" )
             {
-                SetOutputArray( nBin - overlap + blockNumber * step, nBin, *transformedSpectrum, block );
+                XSpectraType* reversed = new XSpectraType( *myInitialSpectra[iSpectrum] );
+                ConjugateAndReverse( *reversed );
+                reversedSpectra.push_back( reversed );
+                initialSpectra[iSpectrum] = reversed;
             }
-
-            // Increment block number
-            ++blockNumber;
+            transformedSpectra.push_back( new XSpectraType( nBinsTotal, initialSpectra[iSpectrum]->GetRangeMin(), initialSpectra[iSpectrum]->GetRangeMax() ) );
         }
 
-        if( blockNumber * step == nBinsTotal )
+        int nTasks = nBlocks * (int)initialSpectra.size();
+#pragma omp parallel
         {
-            KTINFO(convlog_hh, "Reached end of input data");
-            return transformedSpectrum;
+#ifdef USE_OPENMP
+            BlockBuffers& buffers = fBlockBuffers[omp_get_thread_num()];
+#else
+            BlockBuffers& buffers = fBlockBuffers[0];
+#endif
+#pragma omp for schedule(static)
+            for( int iTask = 0; iTask < nTasks; ++iTask )
+            {
+                int iSpectrum = iTask / nBlocks;
+                int iBlock = iTask % nBlocks;
+                const BlockTransform& transform = iBlock < nRegularBlocks ? regularTransform : *shortTransform;
+                ConvolveBlock( initialSpectra[iSpectrum], *transformedSpectra[iSpectrum], iBlock * step - overlap, overlap, transform, buffers );
+            }
         }
 
-        KTINFO(convlog_hh, "Reached final block");
-        KTINFO(convlog_hh, "Starting position: " << blockNumber * step - overlap);
-
-        // Same procedure as above, this time with a shorter final block
-
-#ifndef NDEBUG
-        int lastNBin = 0;
-#endif
-        for( int nBin = 0; position+1 < nBinsTotal; ++nBin )
+        for( unsigned iSpectrum = 0; iSpectrum < reversedSpectra.size(); ++iSpectrum )
         {
-            position = nBin + blockNumber * step - overlap;
-            SetInputArray( position, nBin, initialSpectrum );
-#ifndef NDEBUG
-            lastNBin = nBin;
-#endif
+            delete reversedSpectra[iSpectrum];
         }
 
-        KTDEBUG(convlog_hh, "Short array length = " << lastNBin);
-        KTDEBUG(convlog_hh, "Initialized short array length = " << fShortSize);
-
-        // FFT of input block
-        fftw_execute( fGeneralForwardPlanShort );
+        return true;
+    }
 
-        for( int nBin = 0; nBin < nBinLimitShort; ++nBin )
+    template< class XSpectraType >
+    void KTConvolution1D::ConvolveBlock( const XSpectraType* initialSpectrum, XSpectraType& transformedSpectrum, int start, int overlap, const BlockTransform& transform, BlockBuffers& buffers )
+    {
+        // Fill input array
+        for( int nBin = 0; nBin < transform.fSize; ++nBin )
         {
-            fGeneralTransformedOutputArray[nBin][0] = fGeneralTransformedInputArray[nBin][0] * fGeneralTransformedKernelArray[nBin][0] - fGeneralTransformedInputArray[nBin][1] * fGeneralTransformedKernelArray[nBin][1];
-            fGeneralTransformedOutputArray[nBin][1] = fGeneralTransformedInputArray[nBin][0] * fGeneralTransformedKernelArray[nBin][1] + fGeneralTransformedInputArray[nBin][1] * fGeneralTransformedKernelArray[nBin][0];
+            SetInputArray( start + nBin, nBin, initialSpectrum, buffers );
         }
 
-        // Reverse FFT of output block
-        fftw_execute( fGeneralReversePlanShort );
+        // FFT, bin multiplication in fourier space, and reverse FFT
+        TransformBlock( transform, buffers, initialSpectrum );
 
         // Loop over bins in the output block and fill the convolved spectrum
-        for( int nBin = overlap; nBin < fShortSize; ++nBin )
+        for( int nBin = overlap; nBin < transform.fSize; ++nBin )
         {
-            SetOutputArray( nBin - overlap + blockNumber * step, nBin, *transformedSpectrum, fShortSize );
+            SetOutputArray( start + nBin, nBin, transformedSpectrum, transform.fSize, buffers );
         }
-
-        KTINFO(convlog_hh, "Component finished!");
-
-        return transformedSpectrum;
+        return;
     }
 
     inline const KTPowerSpectrum* KTConvolution1D::GetSpectrum( KTPowerSpectrumDataCore& data, unsigned iComponent )
@@ -225,7 +225,7 @@ namespace Katydid
         unsigned nComponents = fTreeData.GetNComponents();
         for (unsigned iComponent = 0; iComponent != nComponents; ++iComponent)
         {
-            fTreeData.BuildIndex(fDistanceMethod, fMaxLeafSize, iComponent);
+            fTreeData.UpdateIndex(fDistanceMethod, fMaxLeafSize, iComponent);
         }
 
         // yet another exception to the separation of normal function and signals/slots; sorry
@@ -248,19 +248,18 @@ namespace Katydid
         {
             KTDEBUG(kdlog, "ClearTree(true)");
 
-            // clear data up to the
+            // clear data up to the first slice kept; the points are in slice order, so they're all at the front,
+            // and the index drops them without being rebuilt
             unsigned nComponents = fTreeData.GetNComponents();
             for (unsigned iComponent = 0; iComponent != nComponents; ++iComponent)
             {
-                fTreeData.ClearIndex(iComponent);
-                KTKDTreeData::SetOfPoints& points = fTreeData.GetSetOfPoints(iComponent);
-                KTKDTreeData::SetOfPoints::iterator startErase = points.begin();
-                KTKDTreeData::SetOfPoints::iterator endErase = startErase;
-                while (endErase != points.end() && endErase->fSliceNumber < firstSliceKept)
+                const KTKDTreeData::SetOfPoints& points = fTreeData.GetSetOfPoints(iComponent);
+                size_t nErase = 0;
+                while (nErase != points.size() && points[nErase].fSliceNumber < firstSliceKept)
                 {
-                    ++endErase;
+                    ++nErase;
                 }
-                points.erase(startErase, endErase);
+                fTreeData.RemoveLeadingPoints(nErase, iComponent);
             }
         }
         else
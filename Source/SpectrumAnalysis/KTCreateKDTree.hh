@@ -33,7 +33,11 @@ namespace Katydid
      @brief Creates a KD-Tree
 
      @details
- 
+     Points are collected in windows of "window-size" slices, with the last "window-overlap" slices of each window kept for the next one.
+     The index is updated incrementally as the window slides (see KTTreeIndexForest): points added since the last tree are indexed
+     on their own and merged with the existing blocks, and points that leave the window are dropped from the front without rebuilding.
+     Downstream processors therefore query an index that is always current.
+
      Notes on setting the time and frequency radius:
      These can be set by the egg header using the "header" slot if they haven't been set already.
      To accomplish this, each of those variables has an extra boolean flag that indicates whether it's been set with the corresponding Set function in the life of the class.
@@ -55,7 +59,7 @@ namespace Katydid
      - "disc-1d": void (Nymph::KTDataPtr) -- Adds points to the K-D Tree; Requires KTDiscriminatedPoints1DData and KTSliceHeader
      - "swfc-and-track": void (Nymph::KTDataPtr) -- Adds points to the K-D Tree only if the track is not cut; Requires KTSparseWaterfallCandidateData and KTProcessedTrackData
      - "swfc": void (Nymph::KTDataPtr) -- Adds points to the K-D Tree; Requires KTSparseWaterfallCandidateData
-     - "make-tree": void () -- Creates a tree with the existing set of points; Creates data with KTKDTreeData; Emits signal kd-tree
+     - "make-tree": void () -- Updates the tree with the existing set of points; Creates data with KTKDTreeData; Emits signal kd-tree
      - "done": void () -- same as "make-tree"; Emits signal kd-tree then signal done
 
      Signals:
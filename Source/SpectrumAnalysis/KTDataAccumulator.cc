@@ -7,6 +7,8 @@
 
 #include "KTDataAccumulator.hh"
 
+#include <cmath>
+
 using std::map;
 using std::string;
 
@@ -16,8 +18,72 @@ namespace Katydid
 
     KT_REGISTER_PROCESSOR(KTDataAccumulator, "data-accumulator");
 
+    namespace
+    {
+        // Running-statistics kernels
+        // These work directly on the contiguous data arrays; complex values are stored as interleaved (real, imaginary) pairs.
+        // With frac = 1/n they're Welford's algorithm; with a fixed frac they're an exponentially-weighted mean and variance.
+        // Wide arrays are split into blocks across threads.
+
+        void UpdateMean(double* mean, const double* data, unsigned size, double frac, bool parallel)
+        {
+            #pragma omp parallel for schedule(static) if (parallel)
+            for (int iValue = 0; iValue < (int)size; ++iValue)
+            {
+                mean[iValue] += frac * (data[iValue] - mean[iValue]);
+            }
+            return;
+        }
+
+        void UpdateMeanAndVariance(double* mean, double* variance, const double* data, unsigned size, double frac, bool parallel)
+        {
+            double keepFrac = 1. - frac;
+            #pragma omp parallel for schedule(static) if (parallel)
+            for (int iBin = 0; iBin < (int)size; ++iBin)
+            {
+                double delta = data[iBin] - mean[iBin];
+                mean[iBin] += frac * delta;
+                variance[iBin] = keepFrac * (variance[iBin] + frac * delta * delta);
+            }
+            return;
+        }
+
+        void UpdateComplexMeanAndVariance(double* mean, double* variance, const double* data, unsigned size, double frac, bool parallel)
+        {
+            double keepFrac = 1. - frac;
+            #pragma omp parallel for schedule(static) if (parallel)
+            for (int iBin = 0; iBin < (int)size; ++iBin)
+            {
+                double deltaReal = data[2*iBin] - mean[2*iBin];
+                double deltaImag = data[2*iBin+1] - mean[2*iBin+1];
+                mean[2*iBin] += frac * deltaReal;
+                mean[2*iBin+1] += frac * deltaImag;
+                variance[iBin] = keepFrac * (variance[iBin] + frac * (deltaReal * deltaReal + deltaImag * deltaImag));
+            }
+            return;
+        }
+
+        // The mean of polar data is kept in rectangular form (rectMean), and the polar mean is updated from it
+        void UpdatePolarMeanAndVariance(complexpolar< double >* mean, double* rectMean, double* variance, const complexpolar< double >* data, unsigned size, double frac, bool parallel)
+        {
+            double keepFrac = 1. - frac;
+            #pragma omp parallel for schedule(static) if (parallel)
+            for (int iBin = 0; iBin < (int)size; ++iBin)
+            {
+                double deltaReal = data[iBin].abs() * std::cos(data[iBin].arg()) - rectMean[2*iBin];
+                double deltaImag = data[iBin].abs() * std::sin(data[iBin].arg()) - rectMean[2*iBin+1];
+                rectMean[2*iBin] += frac * deltaReal;
+                rectMean[2*iBin+1] += frac * deltaImag;
+                mean[iBin].set_rect(rectMean[2*iBin], rectMean[2*iBin+1]);
+                variance[iBin] = keepFrac * (variance[iBin] + frac * (deltaReal * deltaReal + deltaImag * deltaImag));
+            }
+            return;
+        }
+    }
+
     KTDataAccumulator::KTDataAccumulator(const std::string& name) :
             KTProcessor(name),
+            fParallelMinBins(32768),
             fAccumulatorSize(10),
             fAveragingFrac(0.1),
             fSignalInterval(1),
@@ -84,6 +150,7 @@ namespace Katydid
 
         SetAccumulatorSize(node->get_value<unsigned>("number-to-average", fAccumulatorSize));
         SetSignalInterval(node->get_value<unsigned>("signal-interval", fSignalInterval));
+        SetParallelMinBins(node->get_value<unsigned>("parallel-min-bins", fParallelMinBins));
 
         return true;
     }
@@ -111,10 +178,10 @@ namespace Katydid
 
     bool KTDataAccumulator::AddData(KTFrequencySpectrumDataPolar& data)
     {
-        Accumulator& accDataStruct = GetOrCreateAccumulator< KTFrequencySpectrumDataPolar >();
+        AccumulatorType< KTFrequencySpectrumDataPolar >& accDataStruct = static_cast< AccumulatorType< KTFrequencySpectrumDataPolar >& >(GetOrCreateAccumulator< KTFrequencySpectrumDataPolar >());
         KTFrequencySpectrumDataPolar& accData = accDataStruct.fData->Of<KTFrequencySpectrumDataPolar>();
         KTFrequencySpectrumVarianceDataPolar& devData = accDataStruct.fData->Of<KTFrequencySpectrumVarianceDataPolar>();
-        return CoreAddData(data, accDataStruct, accData, devData);
+        return CoreAddData(data, accDataStruct, accData, devData, accDataStruct.fRectMean);
     }
 
     bool KTDataAccumulator::AddData(KTFrequencySpectrumDataFFTW& data)
@@ -135,10 +202,10 @@ namespace Katydid
 
     bool KTDataAccumulator::AddData(KTConvolvedFrequencySpectrumDataPolar& data)
     {
-        Accumulator& accDataStruct = GetOrCreateAccumulator< KTConvolvedFrequencySpectrumDataPolar >();
+        AccumulatorType< KTConvolvedFrequencySpectrumDataPolar >& accDataStruct = static_cast< AccumulatorType< KTConvolvedFrequencySpectrumDataPolar >& >(GetOrCreateAccumulator< KTConvolvedFrequencySpectrumDataPolar >());
         KTConvolvedFrequencySpectrumDataPolar& accData = accDataStruct.fData->Of<KTConvolvedFrequencySpectrumDataPolar>();
         KTConvolvedFrequencySpectrumVarianceDataPolar& devData = accDataStruct.fData->Of<KTConvolvedFrequencySpectrumVarianceDataPolar>();
-        return CoreAddData(data, accDataStruct, accData, devData);
+        return CoreAddData(data, accDataStruct, accData, devData, accDataStruct.fRectMean);
     }
 
     bool KTDataAccumulator::AddData(KTConvolvedFrequencySpectrumDataFFTW& data)
@@ -159,13 +226,6 @@ namespace Katydid
 
     bool KTDataAccumulator::CoreAddTSDataReal(KTTimeSeriesData& data, Accumulator& accDataStruct, KTTimeSeriesData& accData)
     {
-        double remainingFrac = 1.;
-        if (fAccumulatorSize != 0 && accDataStruct.GetSliceNumber() >= fAccumulatorSize)
-        {
-            remainingFrac -= fAveragingFrac;
-        }
-        //KTDEBUG(avlog, "averaging frac: " << fAveragingFrac << "    remaining frac: " << remainingFrac);
-
         unsigned nComponents = data.GetNComponents();
 
         if (accDataStruct.GetSliceNumber() == 0)
@@ -180,6 +240,7 @@ namespace Katydid
         }
 
         accDataStruct.BumpSliceNumber();
+        double frac = GetUpdateFraction(accDataStruct.GetSliceNumber());
 
         if (nComponents != accData.GetNComponents())
         {
@@ -198,12 +259,7 @@ namespace Katydid
         {
             KTTimeSeriesReal* newTS = static_cast< KTTimeSeriesReal* >(data.GetTimeSeries(iComponent));
             KTTimeSeriesReal* avTS = static_cast< KTTimeSeriesReal* >(accData.GetTimeSeries(iComponent));
-            for (unsigned iBin = 0; iBin < arraySize; ++iBin)
-            {
-                //KTDEBUG(avlog, (*avTS)(iBin) << "  " << (*newTS)(iBin) << "  " << remainingFrac << "  " << fAveragingFrac);
-                (*avTS)(iBin) = (*avTS)(iBin) * remainingFrac + (*newTS)(iBin) * fAveragingFrac;
-                //KTDEBUG(avlog, (*avTS)(iBin));
-            }
+            UpdateMean(avTS->GetData(), newTS->GetData(), arraySize, frac, arraySize >= fParallelMinBins);
         }
 
         return true;
@@ -211,12 +267,6 @@ namespace Katydid
 
     bool KTDataAccumulator::CoreAddTSDataFFTW(KTTimeSeriesData& data, Accumulator& accDataStruct, KTTimeSeriesData& accData)
     {
-        double remainingFrac = 1.;
-        if (fAccumulatorSize != 0 && accDataStruct.GetSliceNumber() >= fAccumulatorSize)
-        {
-            remainingFrac -= fAveragingFrac;
-        }
-
         unsigned nComponents = data.GetNComponents();
 
         if (accDataStruct.GetSliceNumber() == 0)
@@ -231,6 +281,7 @@ namespace Katydid
         }
 
         accDataStruct.BumpSliceNumber();
+        double frac = GetUpdateFraction(accDataStruct.GetSliceNumber());
 
         if (nComponents != accData.GetNComponents())
         {
@@ -249,11 +300,7 @@ namespace Katydid
         {
             KTTimeSeriesFFTW* newTS = static_cast< KTTimeSeriesFFTW* >(data.GetTimeSeries(iComponent));
             KTTimeSeriesFFTW* avTS = static_cast< KTTimeSeriesFFTW* >(accData.GetTimeSeries(iComponent));
-            for (unsigned iBin = 0; iBin < arraySize; ++iBin)
-            {
-                (*avTS)(iBin)[0] = (*avTS)(iBin)[0] * remainingFrac + (*newTS)(iBin)[0] * fAveragingFrac;
-                (*avTS)(iBin)[1] = (*avTS)(iBin)[1] * remainingFrac + (*newTS)(iBin)[1] * fAveragingFrac;
-            }
+            UpdateMean(reinterpret_cast< double* >(avTS->GetData()), reinterpret_cast< const double* >(newTS->GetData()), 2 * arraySize, frac, arraySize >= fParallelMinBins);
         }
 
         return true;
@@ -261,12 +308,6 @@ namespace Katydid
 
     bool KTDataAccumulator::CoreAddData(KTTimeSeriesDistData& data, Accumulator& accDataStruct, KTTimeSeriesDistData& accData)
     {
-        double remainingFrac = 1.;
-        if (fAccumulatorSize != 0 && accDataStruct.GetSliceNumber() >= fAccumulatorSize)
-        {
-            remainingFrac -= fAveragingFrac;
-        }
-
         unsigned nComponents = data.GetNComponents();
 
         if (accDataStruct.GetSliceNumber() == 0)
@@ -282,6 +323,7 @@ namespace Katydid
         }
 
         accDataStruct.BumpSliceNumber();
+        double frac = GetUpdateFraction(accDataStruct.GetSliceNumber());
 
         if (nComponents != accData.GetNComponents())
         {
@@ -299,32 +341,25 @@ namespace Katydid
         {
             KTTimeSeriesDist* newSpect = data.GetTimeSeriesDist(iComponent);
             KTTimeSeriesDist* avSpect = accData.GetTimeSeriesDist(iComponent);
-            for (unsigned iBin = 0; iBin < arraySize; ++iBin)
-            {
-                (*avSpect)(iBin) = (*avSpect)(iBin) * remainingFrac + (*newSpect)(iBin) * fAveragingFrac;
-            }
+            UpdateMean(avSpect->GetData(), newSpect->GetData(), arraySize, frac, arraySize >= fParallelMinBins);
         }
 
         return true;
     }
 
-    bool KTDataAccumulator::CoreAddData(KTFrequencySpectrumDataPolarCore& data, Accumulator& accDataStruct, KTFrequencySpectrumDataPolarCore& accData, KTFrequencySpectrumVarianceDataCore& devData)
+    bool KTDataAccumulator::CoreAddData(KTFrequencySpectrumDataPolarCore& data, Accumulator& accDataStruct, KTFrequencySpectrumDataPolarCore& accData, KTFrequencySpectrumVarianceDataCore& devData, std::vector< std::vector< double > >& rectMean)
     {
-        double remainingFrac = 1.;
-        if (fAccumulatorSize != 0 && accDataStruct.GetSliceNumber() >= fAccumulatorSize)
-        {
-            remainingFrac -= fAveragingFrac;
-        }
-
         unsigned nComponents = data.GetNComponents();
 
         if (accDataStruct.GetSliceNumber() == 0)
         {
             accData.SetNComponents(nComponents);
             devData.SetNComponents(nComponents);
+            rectMean.resize(nComponents);
             for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
             {
                 KTFrequencySpectrumPolar* dataFS = data.GetSpectrumPolar(iComponent);
+                rectMean[iComponent].assign(2 * dataFS->size(), 0.);
 
                 KTFrequencySpectrumPolar* newFS = new KTFrequencySpectrumPolar(dataFS->size(), dataFS->GetRangeMin(), dataFS->GetRangeMax());
                 KTFrequencySpectrumVariance* newVarFS = new KTFrequencySpectrumVariance(dataFS->size(), dataFS->GetRangeMin(), dataFS->GetRangeMax());
@@ -339,6 +374,7 @@ namespace Katydid
         }
 
         accDataStruct.BumpSliceNumber();
+        double frac = GetUpdateFraction(accDataStruct.GetSliceNumber());
 
         if (nComponents != accData.GetNComponents())
         {
@@ -368,11 +404,7 @@ namespace Katydid
             KTFrequencySpectrumPolar* newSpect = data.GetSpectrumPolar(iComponent);
             KTFrequencySpectrumPolar* avSpect = accData.GetSpectrumPolar(iComponent);
             KTFrequencySpectrumVariance* varSpect = devData.GetSpectrum(iComponent);
-            for (unsigned iBin = 0; iBin < arraySize; ++iBin)
-            {
-                (*avSpect)(iBin) = (*avSpect)(iBin) * remainingFrac + (*newSpect)(iBin) * fAveragingFrac;
-                (*varSpect)(iBin) = (*varSpect)(iBin) * remainingFrac + (*newSpect)(iBin).abs() * (*newSpect)(iBin).abs() * fAveragingFrac;
-            }
+            UpdatePolarMeanAndVariance(avSpect->GetData(), &rectMean[iComponent][0], varSpect->GetData(), newSpect->GetData(), arraySize, frac, arraySize >= fParallelMinBins);
         }
 
         return true;
@@ -380,12 +412,6 @@ namespace Katydid
 
     bool KTDataAccumulator::CoreAddData(KTFrequencySpectrumDataFFTWCore& data, Accumulator& accDataStruct, KTFrequencySpectrumDataFFTWCore& accData, KTFrequencySpectrumVarianceDataCore& devData)
     {
-        double remainingFrac = 1.;
-        if (fAccumulatorSize != 0 && accDataStruct.GetSliceNumber() >= fAccumulatorSize)
-        {
-            remainingFrac -= fAveragingFrac;
-        }
-
         unsigned nComponents = data.GetNComponents();
 
         if (accDataStruct.GetSliceNumber() == 0)
@@ -409,6 +435,7 @@ namespace Katydid
         }
 
         accDataStruct.BumpSliceNumber();
+        double frac = GetUpdateFraction(accDataStruct.GetSliceNumber());
 
         if (nComponents != accData.GetNComponents())
         {
@@ -438,13 +465,7 @@ namespace Katydid
             KTFrequencySpectrumFFTW* newSpect = data.GetSpectrumFFTW(iComponent);
             KTFrequencySpectrumFFTW* avSpect = accData.GetSpectrumFFTW(iComponent);
             KTFrequencySpectrumVariance* varSpect = devData.GetSpectrum(iComponent);
-            for (unsigned iBin = 0; iBin < arraySize; ++iBin)
-            {
-                (*avSpect)(iBin)[0] = (*avSpect)(iBin)[0] * remainingFrac + (*newSpect)(iBin)[0] * fAveragingFrac;
-                (*avSpect)(iBin)[1] = (*avSpect)(iBin)[1] * remainingFrac + (*newSpect)(iBin)[1] * fAveragingFrac;
-
-                (*varSpect)(iBin) = (*varSpect)(iBin) * remainingFrac + ((*newSpect)(iBin)[0] * (*newSpect)(iBin)[0] + (*newSpect)(iBin)[1] * (*newSpect)(iBin)[1]) * fAveragingFrac;
-            }
+            UpdateComplexMeanAndVariance(reinterpret_cast< double* >(avSpect->GetData()), varSpect->GetData(), reinterpret_cast< const double* >(newSpect->GetData()), arraySize, frac, arraySize >= fParallelMinBins);
         }
 
         return true;
@@ -452,13 +473,6 @@ namespace Katydid
 
     bool KTDataAccumulator::CoreAddData(KTPowerSpectrumDataCore& data, Accumulator& accDataStruct, KTPowerSpectrumDataCore& accData, KTFrequencySpectrumVarianceDataCore& devData)
     {
-        double remainingFrac = 1.;
-        if (fAccumulatorSize != 0 && accDataStruct.GetSliceNumber() >= fAccumulatorSize)
-        {
-            remainingFrac -= fAveragingFrac;
-        }
-        KTDEBUG(avlog, "Accumulating a power spectrum; remainingFrac = " << remainingFrac << "   fAveragingFrac = " << fAveragingFrac);
-
         unsigned nComponents = data.GetNComponents();
 
         if (accDataStruct.GetSliceNumber() == 0)
@@ -482,6 +496,7 @@ namespace Katydid
         }
 
         accDataStruct.BumpSliceNumber();
+        double frac = GetUpdateFraction(accDataStruct.GetSliceNumber());
 
         if (nComponents != accData.GetNComponents())
         {
@@ -512,169 +527,11 @@ namespace Katydid
             KTPowerSpectrum* avSpect = accData.GetSpectrum(iComponent);
             KTFrequencySpectrumVariance* varSpect = devData.GetSpectrum(iComponent);
             avSpect->SetMode(newSpect->GetMode());
-            double avCache = 0.;
-            for (unsigned iBin = 0; iBin < arraySize; ++iBin)
-            {
-                avCache = (*avSpect)(iBin);
-                (*avSpect)(iBin) = avCache * remainingFrac + (*newSpect)(iBin) * fAveragingFrac;
-                (*varSpect)(iBin) = (*varSpect)(iBin) * remainingFrac + (*newSpect)(iBin) * (*newSpect)(iBin) * fAveragingFrac;
-            }
+            UpdateMeanAndVariance(avSpect->GetData(), varSpect->GetData(), newSpect->GetData(), arraySize, frac, arraySize >= fParallelMinBins);
         }
 
         return true;
     }
 
 
-    bool KTDataAccumulator::AccumulatorType< KTTimeSeriesData >::Finalize()
-    {
-        double scale = fAccumulatorSize == 0 ? 1. / (double)(fSliceHeader.GetSliceNumber()) : 1.;
-        KTDEBUG(avlog, "Scaling time series by " << scale);
-        unsigned nComponents = fDataType.GetNComponents();
-        for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
-        {
-            KTTimeSeries* avSpect = fDataType.GetTimeSeries(iComponent);
-            avSpect->Scale(scale);
-        }
-        return true;
-    }
-
-    bool KTDataAccumulator::AccumulatorType< KTTimeSeriesDistData >::Finalize()
-    {
-        double scale = fAccumulatorSize == 0 ? 1. / (double)(fSliceHeader.GetSliceNumber()) : 1.;
-        KTDEBUG(avlog, "Scaling time series dist by " << scale);
-        unsigned nComponents = fDataType.GetNComponents();
-        for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
-        {
-            KTTimeSeriesDist* avSpect = fDataType.GetTimeSeriesDist(iComponent);
-            avSpect->Scale(scale);
-        }
-        return true;
-    }
-
-    bool KTDataAccumulator::AccumulatorType< KTFrequencySpectrumDataPolar >::Finalize()
-    {
-        double scale = fAccumulatorSize == 0 ? 1. / (double)(fSliceHeader.GetSliceNumber()) : 1.;
-        KTDEBUG(avlog, "Scaling freq spect polar by " << scale);
-        unsigned nComponents = fDataType.GetNComponents();
-        for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
-        {
-            KTFrequencySpectrumPolar* avSpect = fDataType.GetSpectrumPolar(iComponent);
-            KTFrequencySpectrumVariance* varSpect = fVarDataType.GetSpectrum(iComponent);
-
-            avSpect->Scale(scale);
-            varSpect->Scale(scale);
-            unsigned nBins = varSpect->GetNFrequencyBins();
-            for (unsigned iBin = 0; iBin < nBins; ++iBin)
-            {
-                (*varSpect)(iBin) = (*varSpect)(iBin) - (*avSpect)(iBin).abs() * (*avSpect)(iBin).abs();
-            }
-        }
-        return true;
-    }
-
-    bool KTDataAccumulator::AccumulatorType< KTFrequencySpectrumDataFFTW >::Finalize()
-    {
-        double scale = fAccumulatorSize == 0 ? 1. / (double)(fSliceHeader.GetSliceNumber()) : 1.;
-        KTDEBUG(avlog, "Scaling freq spect fftw by " << scale);
-        unsigned nComponents = fDataType.GetNComponents();
-        for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
-        {
-            KTFrequencySpectrumFFTW* avSpect = fDataType.GetSpectrumFFTW(iComponent);
-            KTFrequencySpectrumVariance* varSpect = fVarDataType.GetSpectrum(iComponent);
-
-            avSpect->Scale(scale);
-            varSpect->Scale(scale);
-            unsigned nBins = varSpect->GetNFrequencyBins();
-            for (unsigned iBin = 0; iBin < nBins; ++iBin)
-            {
-                (*varSpect)(iBin) = (*varSpect)(iBin) - (*avSpect)(iBin)[0] * (*avSpect)(iBin)[0] - (*avSpect)(iBin)[1] * (*avSpect)(iBin)[1];
-            }
-        }
-        return true;
-    }
-
-    bool KTDataAccumulator::AccumulatorType< KTPowerSpectrumData >::Finalize()
-    {
-        double scale = fAccumulatorSize == 0 ? 1. / (double)(fSliceHeader.GetSliceNumber()) : 1.;
-        KTDEBUG(avlog, "Scaling power spect by " << scale);
-        unsigned nComponents = fDataType.GetNComponents();
-        for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
-        {
-            KTPowerSpectrum* avSpect = fDataType.GetSpectrum(iComponent);
-            KTFrequencySpectrumVariance* varSpect = fVarDataType.GetSpectrum(iComponent);
-
-            avSpect->Scale(scale);
-            varSpect->Scale(scale);
-            unsigned nBins = varSpect->GetNFrequencyBins();
-            for (unsigned iBin = 0; iBin < nBins; ++iBin)
-            {
-                (*varSpect)(iBin) = (*varSpect)(iBin) - (*avSpect)(iBin) * (*avSpect)(iBin);
-            }
-        }
-        return true;
-    }
-
-    bool KTDataAccumulator::AccumulatorType< KTConvolvedFrequencySpectrumDataPolar >::Finalize()
-    {
-        double scale = fAccumulatorSize == 0 ? 1. / (double)(fSliceHeader.GetSliceNumber()) : 1.;
-        KTDEBUG(avlog, "Scaling conv freq spect polar by " << scale);
-        unsigned nComponents = fDataType.GetNComponents();
-        for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
-        {
-            KTFrequencySpectrumPolar* avSpect = fDataType.GetSpectrumPolar(iComponent);
-            KTFrequencySpectrumVariance* varSpect = fVarDataType.GetSpectrum(iComponent);
-
-            avSpect->Scale(scale);
-            varSpect->Scale(scale);
-            unsigned nBins = varSpect->GetNFrequencyBins();
-            for (unsigned iBin = 0; iBin < nBins; ++iBin)
-            {
-                (*varSpect)(iBin) = (*varSpect)(iBin) - (*avSpect)(iBin).abs() * (*avSpect)(iBin).abs();
-            }
-        }
-        return true;
-    }
-
-    bool KTDataAccumulator::AccumulatorType< KTConvolvedFrequencySpectrumDataFFTW >::Finalize()
-    {
-        double scale = fAccumulatorSize == 0 ? 1. / (double)(fSliceHeader.GetSliceNumber()) : 1.;
-        KTDEBUG(avlog, "Scaling conv freq spect fftw by " << scale);
-        unsigned nComponents = fDataType.GetNComponents();
-        for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
-        {
-            KTFrequencySpectrumFFTW* avSpect = fDataType.GetSpectrumFFTW(iComponent);
-            KTFrequencySpectrumVariance* varSpect = fVarDataType.GetSpectrum(iComponent);
-
-            avSpect->Scale(scale);
-            varSpect->Scale(scale);
-            unsigned nBins = varSpect->GetNFrequencyBins();
-            for (unsigned iBin = 0; iBin < nBins; ++iBin)
-            {
-                (*varSpect)(iBin) = (*varSpect)(iBin) - (*avSpect)(iBin)[0] * (*avSpect)(iBin)[0] - (*avSpect)(iBin)[1] * (*avSpect)(iBin)[1];
-            }
-        }
-        return true;
-    }
-
-    bool KTDataAccumulator::AccumulatorType< KTConvolvedPowerSpectrumData >::Finalize()
-    {
-        double scale = fAccumulatorSize == 0 ? 1. / (double)(fSliceHeader.GetSliceNumber()) : 1.;
-        KTDEBUG(avlog, "Scaling conv power spect by " << scale);
-        unsigned nComponents = fDataType.GetNComponents();
-        for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
-        {
-            KTPowerSpectrum* avSpect = fDataType.GetSpectrum(iComponent);
-            KTFrequencySpectrumVariance* varSpect = fVarDataType.GetSpectrum(iComponent);
-
-            avSpect->Scale(scale);
-            varSpect->Scale(scale);
-            unsigned nBins = varSpect->GetNFrequencyBins();
-            for (unsigned iBin = 0; iBin < nBins; ++iBin)
-            {
-                (*varSpect)(iBin) = (*varSpect)(iBin) - (*avSpect)(iBin) * (*avSpect)(iBin);
-            }
-        }
-        return true;
-    }
-
 } /* namespace Katydid */
@@ -30,6 +30,7 @@
 
 #include <map>
 #include <typeinfo>
+#include <vector>
 
 namespace Katydid
 {
@@ -43,54 +44,53 @@ namespace Katydid
      @brief Averages data objects
 
      @details
-     The data accumulator running average of the data from a series of slices.
+     The data accumulator keeps a running average of the data from a series of slices.
      The size of the accumulator is the number of slices that are averaged together (configuration parameter "number-to-average").
-     If the accumulator size is 0, the data from all of the slices received will be summed together, and averaged at the end.
+     If the accumulator size is 0, all of the slices received are averaged together.
 
      For slice i, the data received by the accumulator is D_i, and the average A_i is:
-       A_i = A_(i-1) * (S-1)/S + D_i / S
-     where S is the size of the accumulator.
-     
-     Note that this method of calculating A_i gives an effective average of S slices:  
-     At slice i, the amount removed from the previous sum is (1 / S) * A_(i-1) instead of (1 / S) * D_(i-N).
-     The effective average will be closest to the true average for large N.
+       A_i = A_(i-1) + (D_i - A_(i-1)) * f_i
+     where f_i = 1/i for the first S slices, and f_i = 1/S afterwards (S is the size of the accumulator; for S = 0, f_i = 1/i always).
+     For the spectra, the variance V_i is updated in the same pass:
+       V_i = (1 - f_i) * (V_(i-1) + f_i * |D_i - A_(i-1)|^2)
+
+     Until the accumulator is full, this is Welford's algorithm, so A_i and V_i are the exact mean and variance of the slices so far.
+     After that, A_i and V_i are exponentially-weighted moving averages with an effective length of S slices, which need no more memory than the average itself.
+     For complex data the mean is of the complex values, and the variance is of their difference from the mean, E|D - A|^2.
+
+     The updates work directly on the contiguous data arrays; arrays with at least "parallel-min-bins" bins are split into blocks across threads (if built with OpenMP).
      
      The signal interval is how often the output signal will be emitted.  
      If the signal interval is 0, there will be no slice signals.
 
-     When the size of the accumulator is not specified, and during accumulation,
-     the accumulating data object will contain the sum of the accumulated data
-     and, where applicable, the variance-accumulating data object will contain the sum of the squares
-     of the accumulated data.  This means that when the mid-accumulation signals are emitted, if you
-     want to get the mean of the data, divide by the number of slices accumulated, and if you want the
-     variance, subtract the square of the mean and divide by the number of slices accumulated.
-
-     Prior to emitting the "finished" signals, the means and variances are properly calculated.
+     The accumulating data object always contains the current mean, and, where applicable, the variance-accumulating data object
+     contains the current variance, so the mid-accumulation and "finished" signals can be used in the same way.
 
      Configuration name: "data-accumulator"
 
      Available configuration options:
-     - "number-to-average": unsigned -- Number of slices to average; 0 will sum all slices together, and average at the end
+     - "number-to-average": unsigned -- Size of the accumulator, S: the first S slices are averaged exactly, and later slices are added to an exponentially-weighted moving average of effective length S; 0 averages all slices exactly
      - "signal-interval": unsigned -- Number of slices between signaling; set to 0 to stop slice signals
+     - "parallel-min-bins": unsigned -- Minimum number of bins for an array to be updated with multiple threads (default: 32768)
 
      Slots:
-     - "ts": void (Nymph::KTDataPtr) -- add to the ts sum; Requires KTTimeSeriesData; Emits signal "ts"
-     - "ts-dist": void (Nymph::KTDataPtr) -- add to the ts-dist sum; Requires KTTimeSeriesDistData; Emits signal "ts-dist"
-     - "fs-polar": void (Nymph::KTDataPtr) -- add to the fs-polar sum; Requires KTFrequencySpectrumPolar; Emits signal "fs-polar"
-     - "fs-fftw": void (Nymph::KTDataPtr) -- add to the fs-fftw sum; Requires KTFrequencySpectrumFFTW; Emits signal "fs-fftw"
-     - "ps": void (Nymph::KTDataPtr) -- add to the ps sum (PS or PSD); Requires KTPowerSpectrumData; Emits signal "ps"
-     - "conv-fs-polar": void (Nymph::KTDataPtr) -- add to the fs-polar sum; Requires KTConvolvedFrequencySpectrumDataPolar; Emits signal "conv-fs-polar"
-     - "conv-fs-fftw": void (Nymph::KTDataPtr) -- add to the fs-fftw sum; Requires KTConvolvedFrequencySpectrumDataFFTW; Emits signal "conv-fs-fftw"
-     - "conv-ps": void (Nymph::KTDataPtr) -- add to the ps sum (PS or PSD); Requires KTConvolvedPowerSpectrumData; Emits signal "conv-ps"
+     - "ts": void (Nymph::KTDataPtr) -- add to the ts average; Requires KTTimeSeriesData; Emits signal "ts"
+     - "ts-dist": void (Nymph::KTDataPtr) -- add to the ts-dist average; Requires KTTimeSeriesDistData; Emits signal "ts-dist"
+     - "fs-polar": void (Nymph::KTDataPtr) -- add to the fs-polar average; Requires KTFrequencySpectrumPolar; Emits signal "fs-polar"
+     - "fs-fftw": void (Nymph::KTDataPtr) -- add to the fs-fftw average; Requires KTFrequencySpectrumFFTW; Emits signal "fs-fftw"
+     - "ps": void (Nymph::KTDataPtr) -- add to the ps average (PS or PSD); Requires KTPowerSpectrumData; Emits signal "ps"
+     - "conv-fs-polar": void (Nymph::KTDataPtr) -- add to the fs-polar average; Requires KTConvolvedFrequencySpectrumDataPolar; Emits signal "conv-fs-polar"
+     - "conv-fs-fftw": void (Nymph::KTDataPtr) -- add to the fs-fftw average; Requires KTConvolvedFrequencySpectrumDataFFTW; Emits signal "conv-fs-fftw"
+     - "conv-ps": void (Nymph::KTDataPtr) -- add to the ps average (PS or PSD); Requires KTConvolvedPowerSpectrumData; Emits signal "conv-ps"
 
      Signals:
 
-     - "ts": void (Nymph::KTDataPtr) -- emitted when the ts sum is updated; guarantees KTTimeSeriesData
-     - "ts-dist": void (Nymph::KTDataPtr) -- emitted when the ts-dist sum is updated; guarantees KTTimeSeriesDistData
-     - "fs-polar": void (Nymph::KTDataPtr) -- emitted when the fs-polar sum is updated; guarantees KTFrequencySpectrumDataPolar
-     - "fs-fftw": void (Nymph::KTDataPtr) -- emitted when the fs-fftw sum is updated; guarantees KTFrequencySpectrumDataFFTW
-     - "conv-ps": void (Nymph::KTDataPtr) -- emitted when the conv-ps sum is updated; guarantees KTConvolvedPowerSpectrumData
-     - "ps": void (Nymph::KTDataPtr) -- emitted when the ps sum is updated; guarantees KTPowerSpectrumData
+     - "ts": void (Nymph::KTDataPtr) -- emitted when the ts average is updated; guarantees KTTimeSeriesData
+     - "ts-dist": void (Nymph::KTDataPtr) -- emitted when the ts-dist average is updated; guarantees KTTimeSeriesDistData
+     - "fs-polar": void (Nymph::KTDataPtr) -- emitted when the fs-polar average is updated; guarantees KTFrequencySpectrumDataPolar
+     - "fs-fftw": void (Nymph::KTDataPtr) -- emitted when the fs-fftw average is updated; guarantees KTFrequencySpectrumDataFFTW
+     - "conv-ps": void (Nymph::KTDataPtr) -- emitted when the conv-ps average is updated; guarantees KTConvolvedPowerSpectrumData
+     - "ps": void (Nymph::KTDataPtr) -- emitted when the ps average is updated; guarantees KTPowerSpectrumData
 
      - "ts-finished": void (Nymph::KTDataPtr) -- emitted when the <finish> slot is called; guarantees KTTimeSeriesData
      - "ts-dist-finished": void (Nymph::KTDataPtr) -- emitted when the last data is received; guarantees KTTimeSeriesDistData
@@ -135,7 +135,8 @@ namespace Katydid
                     return;
                 }
 
-                virtual bool Finalize() = 0;
+                /// The mean and variance are always up to date, so there's nothing left to do at the end
+                virtual bool Finalize() { return true; }
             };
 
             template< class XDataType >
@@ -145,8 +146,6 @@ namespace Katydid
 
                 AccumulatorType() : Accumulator(), fDataType(fData->Of<XDataType>()) {}
                 virtual ~AccumulatorType() {}
-
-                virtual bool Finalize() {}
             };
 
             typedef std::map< const std::type_info*, Accumulator* > AccumulatorMap;
@@ -180,7 +179,12 @@ namespace Katydid
             unsigned GetSignalInterval() const;
             void SetSignalInterval(unsigned interval);
 
+            MEMBERVARIABLE(unsigned, ParallelMinBins);
+
         private:
+            /// Fraction of the new data that goes into the average of nSlices slices
+            double GetUpdateFraction(unsigned nSlices) const;
+
             unsigned fAccumulatorSize;
             double fAveragingFrac;
             unsigned fSignalInterval;
@@ -210,7 +214,7 @@ namespace Katydid
 
             bool CoreAddData(KTTimeSeriesDistData& data, Accumulator& accDataStruct, KTTimeSeriesDistData& accData);
 
-            bool CoreAddData(KTFrequencySpectrumDataPolarCore& data, Accumulator& accDataStruct, KTFrequencySpectrumDataPolarCore& accData, KTFrequencySpectrumVarianceDataCore& devData);
+            bool CoreAddData(KTFrequencySpectrumDataPolarCore& data, Accumulator& accDataStruct, KTFrequencySpectrumDataPolarCore& accData, KTFrequencySpectrumVarianceDataCore& devData, std::vector< std::vector< double > >& rectMean);
             bool CoreAddData(KTFrequencySpectrumDataFFTWCore& data, Accumulator& accDataStruct, KTFrequencySpectrumDataFFTWCore& accData, KTFrequencySpectrumVarianceDataCore& devData);
 
             bool CoreAddData(KTPowerSpectrumDataCore& data, Accumulator& accDataStruct, KTPowerSpectrumDataCore& accData, KTFrequencySpectrumVarianceDataCore& devData);
@@ -261,8 +265,6 @@ namespace Katydid
 
         AccumulatorType() : Accumulator(), fDataType(fData->Of<KTTimeSeriesData>()) {}
         virtual ~AccumulatorType() {}
-
-        virtual bool Finalize();
     };
 
     template<>
@@ -272,8 +274,6 @@ namespace Katydid
 
         AccumulatorType() : Accumulator(), fDataType(fData->Of<KTTimeSeriesDistData>()) {}
         virtual ~AccumulatorType() {}
-
-        virtual bool Finalize();
     };
 
     template<>
@@ -281,11 +281,11 @@ namespace Katydid
     {
             KTFrequencySpectrumDataPolar& fDataType;
             KTFrequencySpectrumVarianceDataPolar& fVarDataType;
+            /// Mean in rectangular form (interleaved real and imaginary parts) for each component
+            std::vector< std::vector< double > > fRectMean;
 
-            AccumulatorType() : Accumulator(), fDataType(fData->Of<KTFrequencySpectrumDataPolar>()), fVarDataType(fData->Of<KTFrequencySpectrumVarianceDataPolar>()) {}
+            AccumulatorType() : Accumulator(), fDataType(fData->Of<KTFrequencySpectrumDataPolar>()), fVarDataType(fData->Of<KTFrequencySpectrumVarianceDataPolar>()), fRectMean() {}
             virtual ~AccumulatorType() {}
-
-            virtual bool Finalize();
     };
 
     template<>
@@ -296,8 +296,6 @@ namespace Katydid
 
             AccumulatorType() : Accumulator(), fDataType(fData->Of<KTFrequencySpectrumDataFFTW>()), fVarDataType(fData->Of<KTFrequencySpectrumVarianceDataFFTW>()) {}
             virtual ~AccumulatorType() {}
-
-            virtual bool Finalize();
     };
 
     template<>
@@ -308,8 +306,6 @@ namespace Katydid
 
             AccumulatorType() : Accumulator(), fDataType(fData->Of<KTPowerSpectrumData>()), fVarDataType(fData->Of<KTPowerSpectrumVarianceData>()) {}
             virtual ~AccumulatorType() {}
-
-            virtual bool Finalize();
     };
 
     template<>
@@ -317,11 +313,11 @@ namespace Katydid
     {
             KTConvolvedFrequencySpectrumDataPolar& fDataType;
             KTConvolvedFrequencySpectrumVarianceDataPolar& fVarDataType;
+            /// Mean in rectangular form (interleaved real and imaginary parts) for each component
+            std::vector< std::vector< double > > fRectMean;
 
-            AccumulatorType() : Accumulator(), fDataType(fData->Of<KTConvolvedFrequencySpectrumDataPolar>()), fVarDataType(fData->Of<KTConvolvedFrequencySpectrumVarianceDataPolar>()) {}
+            AccumulatorType() : Accumulator(), fDataType(fData->Of<KTConvolvedFrequencySpectrumDataPolar>()), fVarDataType(fData->Of<KTConvolvedFrequencySpectrumVarianceDataPolar>()), fRectMean() {}
             virtual ~AccumulatorType() {}
-
-            virtual bool Finalize();
     };
 
     template<>
@@ -332,8 +328,6 @@ namespace Katydid
 
             AccumulatorType() : Accumulator(), fDataType(fData->Of<KTConvolvedFrequencySpectrumDataFFTW>()), fVarDataType(fData->Of<KTConvolvedFrequencySpectrumVarianceDataFFTW>()) {}
             virtual ~AccumulatorType() {}
-
-            virtual bool Finalize();
     };
 
     template<>
@@ -344,8 +338,6 @@ namespace Katydid
 
             AccumulatorType() : Accumulator(), fDataType(fData->Of<KTConvolvedPowerSpectrumData>()), fVarDataType(fData->Of<KTConvolvedPowerSpectrumVarianceData>()) {}
             virtual ~AccumulatorType() {}
-
-            virtual bool Finalize();
     };
 
 
@@ -384,6 +376,12 @@ namespace Katydid
         return;
     }
 
+    inline double KTDataAccumulator::GetUpdateFraction(unsigned nSlices) const
+    {
+        if (fAccumulatorSize == 0 || nSlices < fAccumulatorSize) return 1. / (double)nSlices;
+        return fAveragingFrac;
+    }
+
     inline const KTDataAccumulator::AccumulatorMap& KTDataAccumulator::GetAccumulators() const
     {
         return fDataMap;
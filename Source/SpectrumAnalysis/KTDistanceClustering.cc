@@ -72,7 +72,7 @@ namespace Katydid
 
         for (unsigned iComponent=0; iComponent<nComponents; ++iComponent)
         {
-            const OriginalPoints points = data.GetSetOfPoints(iComponent);
+            const OriginalPoints& points = data.GetSetOfPoints(iComponent);
 
             double threshold = 0.;
             if (! points.empty())
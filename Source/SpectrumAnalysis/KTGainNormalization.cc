@@ -11,11 +11,14 @@
 #include "KTFrequencySpectrumDataFFTW.hh"
 #include "KTFrequencySpectrumFFTW.hh"
 #include "KTFrequencySpectrumPolar.hh"
-#include "KTNormalizedFSData.hh"
+#include "KTGainVariationTable.hh"
 #include "KTNormalizedFSData.hh"
 #include "KTPowerSpectrum.hh"
 #include "KTPowerSpectrumData.hh"
 
+#include <algorithm>
+#include <cmath>
+
 #ifdef USE_OPENMP
 #include <omp.h>
 #endif
@@ -37,6 +40,8 @@ namespace Katydid
             fMaxBin(1),
             fCalculateMinBin(true),
             fCalculateMaxBin(true),
+            fTables(),
+            fTableSources(),
             fGVData(),
             fMagnitudeCache(),
             fMeanGV(0.),
@@ -123,7 +128,7 @@ namespace Katydid
         double normalizedMean = 0., normalizedVariance = 0.;
         for (unsigned iComponent=0; iComponent<nComponents; ++iComponent)
         {
-            KTFrequencySpectrumPolar* newSpectrum = Normalize(fsData.GetSpectrumPolar(iComponent), gvData.GetSpline(iComponent), gvData.GetVarianceSpline(iComponent), normalizedMean, normalizedVariance);
+            KTFrequencySpectrumPolar* newSpectrum = Normalize(fsData.GetSpectrumPolar(iComponent), gvData, iComponent, normalizedMean, normalizedVariance);
             if (newSpectrum == NULL)
             {
                 KTERROR(gnlog, "Normalization of spectrum " << iComponent << " failed for some reason. Continuing processing.");
@@ -153,7 +158,7 @@ namespace Katydid
         double normalizedMean = 0., normalizedVariance = 0.;
         for (unsigned iComponent=0; iComponent<nComponents; ++iComponent)
         {
-            KTFrequencySpectrumFFTW* newSpectrum = Normalize(fsData.GetSpectrumFFTW(iComponent), gvData.GetSpline(iComponent), gvData.GetVarianceSpline(iComponent), normalizedMean, normalizedVariance);
+            KTFrequencySpectrumFFTW* newSpectrum = Normalize(fsData.GetSpectrumFFTW(iComponent), gvData, iComponent, normalizedMean, normalizedVariance);
             if (newSpectrum == NULL)
             {
                 KTERROR(gnlog, "Normalization of spectrum " << iComponent << " failed for some reason. Continuing processing.");
@@ -183,7 +188,7 @@ namespace Katydid
         double normalizedMean = 0., normalizedVariance = 0.;
         for (unsigned iComponent=0; iComponent<nComponents; ++iComponent)
         {
-            KTPowerSpectrum* newSpectrum = Normalize(psData.GetSpectrum(iComponent), gvData.GetSpline(iComponent), gvData.GetVarianceSpline(iComponent), normalizedMean, normalizedVariance);
+            KTPowerSpectrum* newSpectrum = Normalize(psData.GetSpectrum(iComponent), gvData, iComponent, normalizedMean, normalizedVariance);
             if (newSpectrum == NULL)
             {
                 KTERROR(gnlog, "Normalization of spectrum " << iComponent << " failed for some reason. Continuing processing.");
@@ -199,21 +204,13 @@ namespace Katydid
         return true;
     }
 
-    KTFrequencySpectrumPolar* KTGainNormalization::Normalize(const KTFrequencySpectrumPolar* frequencySpectrum, const KTSpline* spline, const KTSpline* varSpline, double& normalizedMean, double& normalizedVariance)
+    KTFrequencySpectrumPolar* KTGainNormalization::Normalize(const KTFrequencySpectrumPolar* frequencySpectrum, const KTGainVariationData& gvData, unsigned component, double& normalizedMean, double& normalizedVariance)
     {
-        if (fCalculateMinBin) SetMinBin(frequencySpectrum->FindBin(fMinFrequency));
-        if (fCalculateMaxBin) SetMaxBin(frequencySpectrum->FindBin(fMaxFrequency));
-
-        unsigned nBins = fMaxBin - fMinBin + 1;
-        double freqMin = frequencySpectrum->GetBinLowEdge(fMinBin);
-        double freqMax = frequencySpectrum->GetBinLowEdge(fMaxBin) + frequencySpectrum->GetBinWidth();
-
-        std::shared_ptr< KTSpline::Implementation > splineImp = spline->Implement(nBins, freqMin, freqMax);
-        std::shared_ptr< KTSpline::Implementation > varSplineImp = varSpline->Implement(nBins, freqMin, freqMax);
+        std::shared_ptr< const KTGainVariationTable > table = GetTable(frequencySpectrum, gvData, component);
+        if (! table) return NULL;
 
-        // Average of each spline
-        normalizedMean = splineImp->GetMean();
-        normalizedVariance = varSplineImp->GetMean();
+        normalizedMean = table->GetNormalizedMean();
+        normalizedVariance = table->GetNormalizedVariance();
         KTDEBUG(gnlog, "Normalized mean and variance: " << normalizedMean << "  " << normalizedVariance);
 
         unsigned nSpectrumBins = frequencySpectrum->size();
@@ -224,47 +221,35 @@ namespace Katydid
         KTFrequencySpectrumPolar* newSpectrum = new KTFrequencySpectrumPolar(nSpectrumBins, freqSpectrumMin, freqSpectrumMax);
         newSpectrum->SetNTimeBins(frequencySpectrum->GetNTimeBins());
 
+        const complexpolar< double >* input = frequencySpectrum->GetData();
+        complexpolar< double >* output = newSpectrum->GetData();
+
         // First directly copy data that's outside the scaling range
-        unsigned iBin;
-#pragma omp parallel default(shared)
+        std::copy(input, input + fMinBin, output);
+        std::copy(input + fMaxBin + 1, input + nSpectrumBins, output + fMaxBin + 1);
+
+        // Then scale the magnitudes within the scaling range
+        const double* scale = table->GetNormScale();
+        const double* offset = table->GetNormOffset();
+        input += fMinBin;
+        output += fMinBin;
+        unsigned nBins = table->GetNBins();
+#pragma omp parallel for
+        for (unsigned iBin = 0; iBin < nBins; ++iBin)
         {
-#pragma omp for private(iBin)
-            for (iBin=0; iBin < fMinBin; ++iBin)
-            {
-                (*newSpectrum)(iBin).set_polar((*frequencySpectrum)(iBin).abs(), (*frequencySpectrum)(iBin).arg());
-            }
-#pragma omp for private(iBin)
-            for (iBin=fMaxBin+1; iBin < nSpectrumBins; ++iBin)
-            {
-                (*newSpectrum)(iBin).set_polar((*frequencySpectrum)(iBin).abs(), (*frequencySpectrum)(iBin).arg());
-            }
-
-            // Then scale the bins within the scaling range
-#pragma omp for private(iBin)
-            for (iBin=fMinBin; iBin < fMaxBin+1; ++iBin)
-            {
-                (*newSpectrum)(iBin).set_polar(normalizedMean + ((*frequencySpectrum)(iBin).abs() - (*splineImp)(iBin - fMinBin)) * sqrt(normalizedVariance / (*varSplineImp)(iBin - fMinBin)), (*frequencySpectrum)(iBin).arg());
-            }
+            output[iBin].set_polar(input[iBin].abs() * scale[iBin] + offset[iBin], input[iBin].arg());
         }
 
         return newSpectrum;
     }
 
-    KTFrequencySpectrumFFTW* KTGainNormalization::Normalize(const KTFrequencySpectrumFFTW* frequencySpectrum, const KTSpline* spline, const KTSpline* varSpline, double& normalizedMean, double& normalizedVariance)
+    KTFrequencySpectrumFFTW* KTGainNormalization::Normalize(const KTFrequencySpectrumFFTW* frequencySpectrum, const KTGainVariationData& gvData, unsigned component, double& normalizedMean, double& normalizedVariance)
     {
-        if (fCalculateMinBin) SetMinBin(frequencySpectrum->FindBin(fMinFrequency));
-        if (fCalculateMaxBin) SetMaxBin(frequencySpectrum->FindBin(fMaxFrequency));
-
-        unsigned nBins = fMaxBin - fMinBin + 1;
-        double freqMin = frequencySpectrum->GetBinLowEdge(fMinBin);
-        double freqMax = frequencySpectrum->GetBinLowEdge(fMaxBin) + frequencySpectrum->GetBinWidth();
+        std::shared_ptr< const KTGainVariationTable > table = GetTable(frequencySpectrum, gvData, component);
+        if (! table) return NULL;
 
-        std::shared_ptr< KTSpline::Implementation > splineImp = spline->Implement(nBins, freqMin, freqMax);
-        std::shared_ptr< KTSpline::Implementation > varSplineImp = varSpline->Implement(nBins, freqMin, freqMax);
-
-        // Average of each spline
-        normalizedMean = splineImp->GetMean();
-        normalizedVariance = varSplineImp->GetMean();
+        normalizedMean = table->GetNormalizedMean();
+        normalizedVariance = table->GetNormalizedVariance();
 
         unsigned nSpectrumBins = frequencySpectrum->size();
         double freqSpectrumMin = frequencySpectrum->GetRangeMin();
@@ -274,56 +259,51 @@ namespace Katydid
         KTFrequencySpectrumFFTW* newSpectrum = new KTFrequencySpectrumFFTW(nSpectrumBins, freqSpectrumMin, freqSpectrumMax);
         newSpectrum->SetNTimeBins(frequencySpectrum->GetNTimeBins());
 
-        //KTDEBUG(gnlog, "array range: 0 - " << frequencySpectrum->size());
-        //KTDEBUG(gnlog, "new array range: 0 - " << newSpectrum->size());
+        // interleaved real and imaginary parts
+        const double* input = reinterpret_cast< const double* >(frequencySpectrum->GetData());
+        double* output = reinterpret_cast< double* >(newSpectrum->GetData());
 
         // First directly copy data that's outside the scaling range
-        unsigned iBin;
-#pragma omp parallel default(shared)
+        std::copy(input, input + 2 * fMinBin, output);
+        std::copy(input + 2 * (fMaxBin + 1), input + 2 * nSpectrumBins, output + 2 * (fMaxBin + 1));
+
+        // Then scale the magnitudes within the scaling range; the phase is kept by scaling both parts by the same factor
+        const double* scale = table->GetNormScale();
+        const double* offset = table->GetNormOffset();
+        input += 2 * fMinBin;
+        output += 2 * fMinBin;
+        unsigned nBins = table->GetNBins();
+#pragma omp parallel for
+        for (unsigned iBin = 0; iBin < nBins; ++iBin)
         {
-#pragma omp for private(iBin)
-            for (iBin=0; iBin < fMinBin; ++iBin)
+            double real = input[2*iBin];
+            double imag = input[2*iBin+1];
+            double magnitude = sqrt(real * real + imag * imag);
+            double newMagnitude = magnitude * scale[iBin] + offset[iBin];
+            if (magnitude > 0.)
             {
-                (*newSpectrum)(iBin)[0] = (*frequencySpectrum)(iBin)[0];
-                (*newSpectrum)(iBin)[1] = (*frequencySpectrum)(iBin)[1];
+                double factor = newMagnitude / magnitude;
+                output[2*iBin] = real * factor;
+                output[2*iBin+1] = imag * factor;
             }
-#pragma omp for private(iBin)
-            for (iBin=fMaxBin+1; iBin < nSpectrumBins; ++iBin)
+            else
             {
-                (*newSpectrum)(iBin)[0] = (*frequencySpectrum)(iBin)[0];
-                (*newSpectrum)(iBin)[1] = (*frequencySpectrum)(iBin)[1];
-            }
-
-            // Then scale the bins within the scaling range
-            complexpolar<double> value;
-#pragma omp for private(iBin)
-            for (iBin=fMinBin; iBin < fMaxBin+1; ++iBin)
-            {
-                value.set_rect((*frequencySpectrum)(iBin)[0], (*frequencySpectrum)(iBin)[1]);
-                value.set_polar(normalizedMean + (value.abs() - (*splineImp)(iBin - fMinBin)) * sqrt(normalizedVariance / (*varSplineImp)(iBin - fMinBin)), value.arg());
-                (*newSpectrum)(iBin)[0] = real(value);
-                (*newSpectrum)(iBin)[1] = imag(value);
+                // the phase of a zero is taken to be 0
+                output[2*iBin] = newMagnitude;
+                output[2*iBin+1] = 0.;
             }
         }
 
         return newSpectrum;
     }
 
-    KTPowerSpectrum* KTGainNormalization::Normalize(const KTPowerSpectrum* powerSpectrum, const KTSpline* spline, const KTSpline* varSpline, double& normalizedMean, double& normalizedVariance)
+    KTPowerSpectrum* KTGainNormalization::Normalize(const KTPowerSpectrum* powerSpectrum, const KTGainVariationData& gvData, unsigned component, double& normalizedMean, double& normalizedVariance)
     {
-        if (fCalculateMinBin) SetMinBin(powerSpectrum->FindBin(fMinFrequency));
-        if (fCalculateMaxBin) SetMaxBin(powerSpectrum->FindBin(fMaxFrequency));
-
-        unsigned nBins = fMaxBin - fMinBin + 1;
-        double freqMin = powerSpectrum->GetBinLowEdge(fMinBin);
-        double freqMax = powerSpectrum->GetBinLowEdge(fMaxBin) + powerSpectrum->GetBinWidth();
+        std::shared_ptr< const KTGainVariationTable > table = GetTable(powerSpectrum, gvData, component);
+        if (! table) return NULL;
 
-        std::shared_ptr< KTSpline::Implementation > splineImp = spline->Implement(nBins, freqMin, freqMax);
-        std::shared_ptr< KTSpline::Implementation > varSplineImp = varSpline->Implement(nBins, freqMin, freqMax);
-
-        // Average of each spline
-        normalizedMean = splineImp->GetMean();
-        normalizedVariance = varSplineImp->GetMean();
+        normalizedMean = table->GetNormalizedMean();
+        normalizedVariance = table->GetNormalizedVariance();
 
         unsigned nSpectrumBins = powerSpectrum->size();
         double freqSpectrumMin = powerSpectrum->GetRangeMin();
@@ -333,30 +313,74 @@ namespace Katydid
         KTPowerSpectrum* newSpectrum = new KTPowerSpectrum(nSpectrumBins, freqSpectrumMin, freqSpectrumMax);
         newSpectrum->OverrideMode(KTPowerSpectrum::kPower);
 
+        const double* input = powerSpectrum->GetData();
+        double* output = newSpectrum->GetData();
+
         // First directly copy data that's outside the scaling range
-        unsigned iBin;
-#pragma omp parallel default(shared)
+        std::copy(input, input + fMinBin, output);
+        std::copy(input + fMaxBin + 1, input + nSpectrumBins, output + fMaxBin + 1);
+
+        // Then scale the bins within the scaling range
+        const double* scale = table->GetNormScale();
+        const double* offset = table->GetNormOffset();
+        input += fMinBin;
+        output += fMinBin;
+        unsigned nBins = table->GetNBins();
+#pragma omp parallel for
+        for (unsigned iBin = 0; iBin < nBins; ++iBin)
         {
-#pragma omp for private(iBin)
-            for (iBin=0; iBin < fMinBin; ++iBin)
-            {
-                (*newSpectrum)(iBin) = (*powerSpectrum)(iBin);
-            }
-#pragma omp for private(iBin)
-            for (iBin=fMaxBin+1; iBin < nSpectrumBins; ++iBin)
+            output[iBin] = input[iBin] * scale[iBin] + offset[iBin];
+        }
+
+        return newSpectrum;
+    }
+
+    template< class XSpectrumType >
+    std::shared_ptr< const KTGainVariationTable > KTGainNormalization::GetTable(const XSpectrumType* spectrum, const KTGainVariationData& gvData, unsigned component)
+    {
+        if (spectrum == NULL)
+        {
+            KTERROR(gnlog, "Spectrum pointer (component " << component << ") is NULL!");
+            return std::shared_ptr< const KTGainVariationTable >();
+        }
+        if (component >= gvData.GetNComponents())
+        {
+            KTERROR(gnlog, "There is no gain variation for component " << component);
+            return std::shared_ptr< const KTGainVariationTable >();
+        }
+
+        if (fCalculateMinBin) SetMinBin(spectrum->FindBin(fMinFrequency));
+        if (fCalculateMaxBin) SetMaxBin(spectrum->FindBin(fMaxFrequency));
+
+        unsigned nBins = fMaxBin - fMinBin + 1;
+        double freqMin = spectrum->GetBinLowEdge(fMinBin);
+        double freqMax = spectrum->GetBinLowEdge(fMaxBin) + spectrum->GetBinWidth();
+
+        std::shared_ptr< const KTGainVariationTable > table = gvData.GetTable(component);
+        if (! table || ! table->Matches(nBins, freqMin, freqMax))
+        {
+            // Use this processor's own table for the range.  It's kept as long as the data's table is the same one, since the data
+            // builds a new table whenever its splines change; without a data table there's no way to tell, so it's rebuilt each time.
+            if (component >= fTables.size())
             {
-                (*newSpectrum)(iBin) = (*powerSpectrum)(iBin);
+                fTables.resize(component + 1);
+                fTableSources.resize(component + 1);
             }
-
-            // Then scale the bins within the scaling range
-#pragma omp for private(iBin)
-            for (iBin=fMinBin; iBin < fMaxBin+1; ++iBin)
+            if (! table || table != fTableSources[component] || ! fTables[component] || ! fTables[component]->Matches(nBins, freqMin, freqMax))
             {
-                (*newSpectrum)(iBin) = normalizedMean + ((*powerSpectrum)(iBin) - (*splineImp)(iBin - fMinBin)) * sqrt(normalizedVariance / (*varSplineImp)(iBin - fMinBin));
+                const KTSpline* spline = gvData.GetSpline(component);
+                fTables[component].reset();
+                if (spline != NULL) fTables[component] = std::make_shared< const KTGainVariationTable >(spline, gvData.GetVarianceSpline(component), nBins, freqMin, freqMax);
+                fTableSources[component] = table;
             }
+            table = fTables[component];
         }
-
-        return newSpectrum;
+        if (! table || ! table->HasVariance())
+        {
+            KTERROR(gnlog, "Gain variation spline or variance spline (component " << component << ") is missing");
+            return std::shared_ptr< const KTGainVariationTable >();
+        }
+        return table;
     }
 
 } /* namespace Katydid */
@@ -14,6 +14,8 @@
 #include "KTGainVariationData.hh"
 #include "KTSlot.hh"
 
+#include <memory>
+
 namespace Katydid
 {
     
@@ -23,7 +25,6 @@ namespace Katydid
     class KTFrequencySpectrumPolar;
     class KTPowerSpectrum;
     class KTPowerSpectrumData;
-    class KTSpline;
  
 
    /*!
@@ -43,6 +44,10 @@ namespace Katydid
      \f]
      where \f$x\f$ is the unnormalized bin value, \f$\mu\f$ is the background mean at that bin, \f$\sigma^2\f$ is the background variance at
      that bin, \f$\langle\mu\rangle\f$ is the mean of the background mean, and \f$\langle\sigma^2\rangle\f$ is the mean of the background variance.
+
+     The splines are only evaluated when the gain variation or the normalization range changes: the per-bin scale and offset are
+     taken from the table of the gain variation data (see KTGainVariationData::SetTableBinning()) if it covers the normalization range;
+     otherwise the processor builds and keeps its own table for that range.  Normalizing a spectrum is then a multiply-add per bin.
  
      Configuration name: "gain-normalization"
 
@@ -106,11 +111,20 @@ namespace Katydid
             bool Normalize(KTFrequencySpectrumDataFFTW& fsData, KTGainVariationData& gvData);
             bool Normalize(KTPowerSpectrumData& psData, KTGainVariationData& gvdata);
 
-            KTFrequencySpectrumPolar* Normalize(const KTFrequencySpectrumPolar* frequencySpectrum, const KTSpline* spline, const KTSpline* varSpline, double& normalizedMean, double& normalizedVariance);
-            KTFrequencySpectrumFFTW* Normalize(const KTFrequencySpectrumFFTW* frequencySpectrum, const KTSpline* spline, const KTSpline* varSpline, double& normalizedMean, double& normalizedVariance);
-            KTPowerSpectrum* Normalize(const KTPowerSpectrum* powerSpectrum, const KTSpline* spline, const KTSpline* varSpline, double& normalizedMean, double& normalizedVariance);
+            KTFrequencySpectrumPolar* Normalize(const KTFrequencySpectrumPolar* frequencySpectrum, const KTGainVariationData& gvData, unsigned component, double& normalizedMean, double& normalizedVariance);
+            KTFrequencySpectrumFFTW* Normalize(const KTFrequencySpectrumFFTW* frequencySpectrum, const KTGainVariationData& gvData, unsigned component, double& normalizedMean, double& normalizedVariance);
+            KTPowerSpectrum* Normalize(const KTPowerSpectrum* powerSpectrum, const KTGainVariationData& gvData, unsigned component, double& normalizedMean, double& normalizedVariance);
 
         private:
+            /// Returns the gain-variation table for the normalization range of the spectrum, or an empty pointer if the splines are missing
+            template< class XSpectrumType >
+            std::shared_ptr< const KTGainVariationTable > GetTable(const XSpectrumType* spectrum, const KTGainVariationData& gvData, unsigned component);
+
+            /// Tables for normalization ranges that the gain variation data has no table for, one per component,
+            /// and the data's table at the time each was built (a new data table means that the splines may have changed)
+            std::vector< std::shared_ptr< const KTGainVariationTable > > fTables;
+            std::vector< std::shared_ptr< const KTGainVariationTable > > fTableSources;
+
             KTGainVariationData fGVData;
             std::vector< double > fMagnitudeCache;
             double fMeanGV;
@@ -406,6 +406,8 @@ namespace Katydid
             delete [] yVals;
 
             newData.SetSpline(spline, iComponent);
+            // Build the table for the fitted range, which is the range the consumers of the gain variation normally use
+            newData.SetTableBinning(nTotalBins, spectrum->GetBinLowEdge(fMinBin), spectrum->GetBinLowEdge(fMaxBin) + spectrum->GetBinWidth(), iComponent);
         }
         KTINFO(gvlog, "Completed gain variation calculation for " << nComponents);
 
@@ -492,6 +494,8 @@ namespace Katydid
             delete [] yVals;
 
             newData.SetSpline(spline, iComponent);
+            // Build the table for the fitted range, which is the range the consumers of the gain variation normally use
+            newData.SetTableBinning(nTotalBins, spectrum->GetBinLowEdge(fMinBin), spectrum->GetBinLowEdge(fMaxBin) + spectrum->GetBinWidth(), iComponent);
         }
         KTINFO(gvlog, "Completed gain variation calculation for " << nComponents);
 
@@ -577,6 +581,8 @@ namespace Katydid
             delete [] yVals;
 
             newData.SetSpline(spline, iComponent);
+            // Build the table for the fitted range, which is the range the consumers of the gain variation normally use
+            newData.SetTableBinning(nTotalBins, spectrum->GetBinLowEdge(fMinBin), spectrum->GetBinLowEdge(fMaxBin) + spectrum->GetBinWidth(), iComponent);
         }
         KTINFO(gvlog, "Completed gain variation calculation for " << nComponents);
 
@@ -14,10 +14,12 @@
 #include "KTSparseWaterfallCandidateData.hh"
 #include "KTDiscriminatedPoint.hh"
 
+#include <algorithm>
 #include <cmath>
 
-
-
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
 
 using std::string;
 using std::vector;
@@ -32,12 +34,14 @@ namespace Katydid
             KTProcessor(name),
             fNThetaPoints(1),
             fNRPoints(1),
+            fMinValue(0.),
             fCosTheta(0),
             fSinTheta(0),
             fHTSignal("hough", this),
             fSWFCandSlot("swf-cand", this, &KTHoughTransform::TransformData, &fHTSignal),
             fWFCandSlot("wf-cand", this, &KTHoughTransform::TransformData, &fHTSignal),
-            fDiscPts2DSlot("disc", this, &KTHoughTransform::TransformData, &fHTSignal)
+            fDiscPts2DSlot("disc", this, &KTHoughTransform::TransformData, &fHTSignal),
+            fSpectrogramSlot("spectrogram", this, &KTHoughTransform::TransformData, &fHTSignal)
     {
     }
 
@@ -49,6 +53,7 @@ namespace Katydid
     {
         SetNThetaPoints(node->get_value< unsigned >("n-theta-points", fNThetaPoints));
         SetNRPoints(node->get_value< unsigned >("n-r-points", fNRPoints));
+        SetMinValue(node->get_value< double >("min-value", fMinValue));
 
         return true;
     }
@@ -77,53 +82,20 @@ namespace Katydid
     {
         KTINFO(htlog, "Number of time/frequency points: " << points.size());
 
-        double maxR = KTMath::Sqrt2();
         double timeScaling = 1. / timeLength;
         double freqScaling = 1. / freqWidth;
 
-        KTPhysicalArray< 2, double >* newTransform = new KTPhysicalArray< 2, double >(fNThetaPoints, 0., KTMath::Pi(), fNRPoints, -maxR, maxR);
-        for (unsigned iTheta = 0; iTheta < fNThetaPoints; ++iTheta)
-        {
-            for (unsigned iRadius = 0; iRadius < fNRPoints; ++iRadius)
-            {
-                (*newTransform)(iTheta, iRadius) = 0.;
-            }
-        }
-
-        double deltaTheta = KTMath::Pi() / (double)fNThetaPoints;
-
-        // initial loop over theta bins to create the KTPhysicalArrays and to cache cosTheta and sinTheta values
-        if (fCosTheta.size() != fNThetaPoints || fSinTheta.size() != fNThetaPoints)
-        {
-            fCosTheta.resize(fNThetaPoints);
-            fSinTheta.resize(fNThetaPoints);
-            double theta = newTransform->GetBinCenter(0, 0);
-            for (unsigned iTheta = 0; iTheta < fNThetaPoints; ++iTheta)
-            {
-                fCosTheta[iTheta] = cos(theta);
-                fSinTheta[iTheta] = sin(theta);
-                theta += deltaTheta;
-            }
-        }
-
-        double timeVal, freqVal, value, radius;
-        unsigned iRadius;
-        for (SWFPoints::const_iterator pIt = points.begin(); pIt != points.end(); ++pIt)
+        PointVotes votes(points.size());
+        PointVotes::iterator vIt = votes.begin();
+        for (SWFPoints::const_iterator pIt = points.begin(); pIt != points.end(); ++pIt, ++vIt)
         {
-            timeVal = (pIt->fTimeInRunC - minTime) * timeScaling;
-            freqVal = (pIt->fFrequency - minFreq) * freqScaling;
-            value = pIt->fAmplitude;
-
-            for (unsigned iTheta = 0; iTheta < fNThetaPoints; ++iTheta)
-            {
-                radius = timeVal * fCosTheta[iTheta] + freqVal * fSinTheta[iTheta];
-
-                iRadius = newTransform->FindBin(2, radius);
-
-                (*newTransform)(iTheta, iRadius) = (*newTransform)(iTheta, iRadius) + value;
-            }
+            vIt->fX = (pIt->fTimeInRunC - minTime) * timeScaling;
+            vIt->fY = (pIt->fFrequency - minFreq) * freqScaling;
+            vIt->fValue = pIt->fAmplitude;
         }
 
+        KTPhysicalArray< 2, double >* newTransform = CreateTransform(KTMath::Sqrt2());
+        AccumulateVotes(votes, *newTransform);
         return newTransform;
     }
 
@@ -155,71 +127,79 @@ namespace Katydid
         //KTINFO(htlog, "time info: " << nTimeBins << "  " << powerSpectrum->GetRangeMin(0) << "  " << powerSpectrum->GetRangeMax(0) << "  " << powerSpectrum->GetBinWidth(0));
         //KTINFO(htlog, "freq info: " << nFreqBins << "  " << powerSpectrum->GetRangeMin(1) << "  " << powerSpectrum->GetRangeMax(1) << "  " << powerSpectrum->GetBinWidth(1));
 
-        double maxR = sqrt(double(nTimeBins*nTimeBins + nFreqBins*nFreqBins));
-
-        KTPhysicalArray< 2, double >* newTransform = new KTPhysicalArray< 2, double >(fNThetaPoints, 0., KTMath::Pi(), fNRPoints, -maxR, maxR);
-        for (unsigned iTheta = 0; iTheta < fNThetaPoints; ++iTheta)
+        // only the cells above the minimum value vote
+        BinVotes votes;
+        BinVote vote;
+        for (vote.fXBin = 0; vote.fXBin < nTimeBins; ++vote.fXBin)
         {
-            for (unsigned iRadius = 0; iRadius < fNRPoints; ++iRadius)
+            for (vote.fYBin = 0; vote.fYBin < nFreqBins; ++vote.fYBin)
             {
-                (*newTransform)(iTheta, iRadius) = 0.;
+                vote.fValue = powerSpectrum->GetAbs(vote.fXBin, vote.fYBin);
+                if (vote.fValue <= fMinValue) continue;
+                votes.push_back(vote);
             }
         }
+        KTDEBUG(htlog, votes.size() << " of " << nTimeBins * nFreqBins << " cells are above the minimum value");
+
+        KTPhysicalArray< 2, double >* newTransform = CreateTransform(sqrt(double(nTimeBins*nTimeBins + nFreqBins*nFreqBins)));
+        AccumulateVotes(votes, *newTransform);
+        return newTransform;
+    }
 
-        double deltaTheta = KTMath::Pi() / (double)fNThetaPoints;
 
-        // initial loop over theta bins to create the KTPhysicalArrays and to cache cosTheta and sinTheta values
-        if (fCosTheta.size() != fNThetaPoints || fSinTheta.size() != fNThetaPoints)
-        {
-            fCosTheta.resize(fNThetaPoints);
-            fSinTheta.resize(fNThetaPoints);
-            double theta = newTransform->GetBinCenter(0, 0);
-            for (unsigned iTheta = 0; iTheta < fNThetaPoints; iTheta++)
-            {
-                fCosTheta[iTheta] = cos(theta);
-                fSinTheta[iTheta] = sin(theta);
-                theta += deltaTheta;
-            }
-        }
+    bool KTHoughTransform::TransformData(KTDiscriminatedPoints2DData& data)
+    {
+        unsigned nComponents = data.GetNComponents();
+        KTHoughData& newData = data.Of< KTHoughData >().SetNComponents(nComponents);
 
-        double timeVal, freqVal, value, radius;
-        unsigned iRadius;
-        for (unsigned iTime = 0; iTime < nTimeBins; iTime++)
+        for (unsigned iComponent=0; iComponent<nComponents; ++iComponent)
         {
-            timeVal = double(iTime);
+            const KTDiscriminatedPoints2DData::SetOfPoints& inputPoints = data.GetSetOfPoints(iComponent);
 
-            for (unsigned iFreq = 0; iFreq < nFreqBins; iFreq++)
+            KTPhysicalArray< 2, double >* newTransform = TransformSetOfPoints(inputPoints, data.GetNBinsX(), data.GetNBinsY());
+            if (newTransform == NULL)
             {
-                value = powerSpectrum->GetAbs(iTime, iFreq);
-                //if (value < 1.e-4) continue; // HARD CODED THRESHOLD
-
-                freqVal = double(iFreq);
+                KTERROR(htlog, "Something went wrong in transform " << iComponent);
+                return false;
+            }
+            else
+            {
+                newData.SetTransform(newTransform, 0., 1., 0., 1., iComponent);
+            }
+        }
+        KTINFO(htlog, "Completed hough transform for " << nComponents << " components");
 
-                for (unsigned iTheta = 0; iTheta < fNThetaPoints; iTheta++)
-                {
-                    radius = timeVal * fCosTheta[iTheta] + freqVal * fSinTheta[iTheta];
+        return true;
+    }
 
-                    iRadius = newTransform->FindBin(2, radius);
+    KTPhysicalArray< 2, double >* KTHoughTransform::TransformSetOfPoints(const SetOfPoints& points, unsigned nTimeBins, unsigned nFreqBins)
+    {
+        KTINFO(htlog, "Number of time/frequency points: " << points.size());
 
-                    (*newTransform)(iTheta, iRadius) = (*newTransform)(iTheta, iRadius) + value;
-                }
-            }
+        BinVotes votes(points.size());
+        BinVotes::iterator vIt = votes.begin();
+        for (SetOfPoints::const_iterator pIt = points.begin(); pIt != points.end(); ++pIt, ++vIt)
+        {
+            vIt->fXBin = pIt->first.first;
+            vIt->fYBin = pIt->first.second;
+            vIt->fValue = pIt->second.fAbscissa;
         }
 
+        KTPhysicalArray< 2, double >* newTransform = CreateTransform(sqrt(double(nTimeBins*nTimeBins + nFreqBins*nFreqBins)));
+        AccumulateVotes(votes, *newTransform);
         return newTransform;
     }
 
-
-    bool KTHoughTransform::TransformData(KTDiscriminatedPoints2DData& data)
+    bool KTHoughTransform::TransformData(KTSpectrogramData& data)
     {
         unsigned nComponents = data.GetNComponents();
         KTHoughData& newData = data.Of< KTHoughData >().SetNComponents(nComponents);
 
         for (unsigned iComponent=0; iComponent<nComponents; ++iComponent)
         {
-            const KTDiscriminatedPoints2DData::SetOfPoints inputPoints = data.GetSetOfPoints(iComponent);
+            const KTSpectrogram* spectrogram = data.GetSpectrogram(iComponent);
 
-            KTPhysicalArray< 2, double >* newTransform = TransformSetOfPoints(inputPoints, data.GetNBinsX(), data.GetNBinsY());
+            KTPhysicalArray< 2, double >* newTransform = TransformSpectrum(spectrogram);
             if (newTransform == NULL)
             {
                 KTERROR(htlog, "Something went wrong in transform " << iComponent);
@@ -227,7 +207,7 @@ namespace Katydid
             }
             else
             {
-                newData.SetTransform(newTransform, 0., 1., 0., 1., iComponent);
+                newData.SetTransform(newTransform, spectrogram->GetTimeAxis().GetRangeMin(), spectrogram->GetTimeBinWidth(), spectrogram->GetAxis().GetRangeMin(), spectrogram->GetFrequencyBinWidth(), iComponent);
             }
         }
         KTINFO(htlog, "Completed hough transform for " << nComponents << " components");
@@ -235,56 +215,164 @@ namespace Katydid
         return true;
     }
 
-    KTPhysicalArray< 2, double >* KTHoughTransform::TransformSetOfPoints(const SetOfPoints& points, unsigned nTimeBins, unsigned nFreqBins)
+    KTPhysicalArray< 2, double >* KTHoughTransform::TransformSpectrum(const KTSpectrogram* spectrogram)
     {
-        KTINFO(htlog, "Number of time/frequency points: " << points.size());
+        unsigned nTimeBins = spectrogram->GetNTimeBins();
+        unsigned nFreqBins = spectrogram->GetNFrequencyBins();
 
-        double maxR = sqrt(double(nTimeBins*nTimeBins + nFreqBins*nFreqBins));
-
-        KTPhysicalArray< 2, double >* newTransform = new KTPhysicalArray< 2, double >(fNThetaPoints, 0., KTMath::Pi(), fNRPoints, -maxR, maxR);
-        for (unsigned iTheta = 0; iTheta < fNThetaPoints; ++iTheta)
+        // only the cells above the minimum value vote; the rows are read straight from the spectrogram's storage
+        BinVotes votes;
+        BinVote vote;
+        for (vote.fXBin = 0; vote.fXBin < nTimeBins; ++vote.fXBin)
         {
-            for (unsigned iRadius = 0; iRadius < fNRPoints; ++iRadius)
+            const double* row = spectrogram->GetRowData(vote.fXBin);
+            for (vote.fYBin = 0; vote.fYBin < nFreqBins; ++vote.fYBin)
             {
-                (*newTransform)(iTheta, iRadius) = 0.;
+                vote.fValue = row[vote.fYBin];
+                if (vote.fValue <= fMinValue) continue;
+                votes.push_back(vote);
             }
         }
+        KTDEBUG(htlog, votes.size() << " of " << nTimeBins * nFreqBins << " cells are above the minimum value");
 
-        double deltaTheta = KTMath::Pi() / (double)fNThetaPoints;
+        KTPhysicalArray< 2, double >* newTransform = CreateTransform(sqrt(double(nTimeBins*nTimeBins + nFreqBins*nFreqBins)));
+        AccumulateVotes(votes, *newTransform);
+        return newTransform;
+    }
 
-        // initial loop over theta bins to create the KTPhysicalArrays and to cache cosTheta and sinTheta values
+    KTPhysicalArray< 2, double >* KTHoughTransform::CreateTransform(double maxR)
+    {
+        KTPhysicalArray< 2, double >* newTransform = new KTPhysicalArray< 2, double >(0., fNThetaPoints, 0., KTMath::Pi(), fNRPoints, -maxR, maxR);
+
+        // cache cosTheta and sinTheta values
         if (fCosTheta.size() != fNThetaPoints || fSinTheta.size() != fNThetaPoints)
         {
             fCosTheta.resize(fNThetaPoints);
             fSinTheta.resize(fNThetaPoints);
-            double theta = newTransform->GetBinCenter(0, 0);
-            for (unsigned iTheta = 0; iTheta < fNThetaPoints; iTheta++)
+            for (unsigned iTheta = 0; iTheta < fNThetaPoints; ++iTheta)
             {
+                double theta = newTransform->GetBinCenter(1, iTheta);
                 fCosTheta[iTheta] = cos(theta);
                 fSinTheta[iTheta] = sin(theta);
-                theta += deltaTheta;
             }
         }
 
-        double timeVal, freqVal, value, radius;
-        unsigned iRadius;
-        for (SetOfPoints::const_iterator pIt = points.begin(); pIt != points.end(); pIt++)
+        return newTransform;
+    }
+
+    unsigned KTHoughTransform::GetThetaTileSize() const
+    {
+        // a tile of theta rows should fit in the L1 cache, but there should be enough tiles to go around the threads
+        const unsigned tileBytes = 32768;
+        const unsigned maxTileSize = 16;
+        unsigned tileSize = std::min(maxTileSize, unsigned(tileBytes / (sizeof(double) * fNRPoints)));
+#ifdef USE_OPENMP
+        unsigned nThreads = omp_get_max_threads();
+        tileSize = std::min(tileSize, (fNThetaPoints + nThreads - 1) / nThreads);
+#endif
+        return std::max(1u, tileSize);
+    }
+
+    void KTHoughTransform::AccumulateVotes(const BinVotes& votes, KTPhysicalArray< 2, double >& transform)
+    {
+        // the radius tables are sized by the largest bins that vote
+        unsigned nXBins = 0, nYBins = 0;
+        for (BinVotes::const_iterator vIt = votes.begin(); vIt != votes.end(); ++vIt)
         {
-            timeVal = pIt->first.first;
-            freqVal = pIt->first.second;
-            value = pIt->second.fAbscissa;
+            nXBins = std::max(nXBins, vIt->fXBin + 1);
+            nYBins = std::max(nYBins, vIt->fYBin + 1);
+        }
 
-            for (unsigned iTheta = 0; iTheta < fNThetaPoints; iTheta++)
+        // building the tables only pays off if there are more votes than table entries
+        if (votes.size() <= nXBins + nYBins)
+        {
+            PointVotes pointVotes(votes.size());
+            for (unsigned iVote = 0; iVote < votes.size(); ++iVote)
+            {
+                pointVotes[iVote].fX = double(votes[iVote].fXBin);
+                pointVotes[iVote].fY = double(votes[iVote].fYBin);
+                pointVotes[iVote].fValue = votes[iVote].fValue;
+            }
+            AccumulateVotes(pointVotes, transform);
+            return;
+        }
+
+        const RadiusAxis rAxis(transform);
+        const unsigned tileSize = GetThetaTileSize();
+        const unsigned nTiles = (fNThetaPoints + tileSize - 1) / tileSize;
+        double* accumulator = &transform.GetData().data()[0];
+
+#pragma omp parallel
+        {
+            // radius contribution of each bin; the thetas of a tile are next to each other
+            vector< double > xRadius(nXBins * tileSize);
+            vector< double > yRadius(nYBins * tileSize);
+
+#pragma omp for schedule(static)
+            for (unsigned iTile = 0; iTile < nTiles; ++iTile)
             {
-                radius = timeVal * fCosTheta[iTheta] + freqVal * fSinTheta[iTheta];
+                unsigned firstTheta = iTile * tileSize;
+                unsigned nThetaInTile = std::min(tileSize, fNThetaPoints - firstTheta);
 
-                iRadius = newTransform->FindBin(2, radius);
+                for (unsigned iX = 0; iX < nXBins; ++iX)
+                {
+                    for (unsigned iTheta = 0; iTheta < nThetaInTile; ++iTheta)
+                    {
+                        xRadius[iX * tileSize + iTheta] = double(iX) * fCosTheta[firstTheta + iTheta];
+                    }
+                }
+                for (unsigned iY = 0; iY < nYBins; ++iY)
+                {
+                    for (unsigned iTheta = 0; iTheta < nThetaInTile; ++iTheta)
+                    {
+                        yRadius[iY * tileSize + iTheta] = double(iY) * fSinTheta[firstTheta + iTheta];
+                    }
+                }
 
-                (*newTransform)(iTheta, iRadius) = (*newTransform)(iTheta, iRadius) + value;
+                double* tile = accumulator + size_t(firstTheta) * rAxis.fNBins;
+                for (BinVotes::const_iterator vIt = votes.begin(); vIt != votes.end(); ++vIt)
+                {
+                    const double* xRow = &xRadius[vIt->fXBin * tileSize];
+                    const double* yRow = &yRadius[vIt->fYBin * tileSize];
+                    double* row = tile;
+                    for (unsigned iTheta = 0; iTheta < nThetaInTile; ++iTheta, row += rAxis.fNBins)
+                    {
+                        row[rAxis.FindBin(xRow[iTheta] + yRow[iTheta])] += vIt->fValue;
+                    }
+                }
             }
         }
 
-        return newTransform;
+        return;
+    }
+
+    void KTHoughTransform::AccumulateVotes(const PointVotes& votes, KTPhysicalArray< 2, double >& transform)
+    {
+        const RadiusAxis rAxis(transform);
+        const unsigned tileSize = GetThetaTileSize();
+        const unsigned nTiles = (fNThetaPoints + tileSize - 1) / tileSize;
+        double* accumulator = &transform.GetData().data()[0];
+
+#pragma omp parallel for schedule(static)
+        for (unsigned iTile = 0; iTile < nTiles; ++iTile)
+        {
+            unsigned firstTheta = iTile * tileSize;
+            unsigned nThetaInTile = std::min(tileSize, fNThetaPoints - firstTheta);
+            const double* cosTheta = &fCosTheta[firstTheta];
+            const double* sinTheta = &fSinTheta[firstTheta];
+
+            double* tile = accumulator + size_t(firstTheta) * rAxis.fNBins;
+            for (PointVotes::const_iterator vIt = votes.begin(); vIt != votes.end(); ++vIt)
+            {
+                double* row = tile;
+                for (unsigned iTheta = 0; iTheta < nThetaInTile; ++iTheta, row += rAxis.fNBins)
+                {
+                    row[rAxis.FindBin(vIt->fX * cosTheta[iTheta] + vIt->fY * sinTheta[iTheta])] += vIt->fValue;
+                }
+            }
+        }
+
+        return;
     }
 
 /*
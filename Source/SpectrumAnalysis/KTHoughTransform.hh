@@ -16,9 +16,11 @@
 #include "KTPhysicalArray.hh"
 #include "KTSlot.hh"
 #include "KTSparseWaterfallCandidateData.hh"
+#include "KTSpectrogramData.hh"
 #include "KTWaterfallCandidateData.hh"
 #include "KTMemberVariable.hh"
 
+#include <cmath>
 #include <vector>
 
 namespace Katydid
@@ -36,16 +38,29 @@ namespace Katydid
      Given the (r, theta) parameterization, the slope-intercept equation can be written as:
      y = (-cos(theta)/sin(theta)) * x + r / sin(theta)
 
+     Voting:
+     Every input (waterfall candidate spectrum, sparse candidate points, or 2D discriminated points) is first turned into a list
+     of votes, so that spectrum cells at or below "min-value" are skipped before any theta is visited.
+     The accumulator is a contiguous (theta, r) array; it's split into tiles of consecutive theta rows that fit in the L1 cache,
+     and the tiles are divided among the OpenMP threads, so each thread only writes to its own rows
+     (without OpenMP, i.e. if Katydid_USE_OPENMP is off, all of the tiles are done in one thread).
+     For votes at integer (bin) coordinates, each tile precomputes the radius contribution of every x and y bin,
+     so a vote costs one addition per theta.
+     Within each (theta, r) cell the votes are added in the same order as a serial loop over the points, so the result doesn't
+     depend on the number of threads.
+
      Configuration name: "hough-transform"
 
      Available configuration values:
      - "n-theta-points": unsigned int -- number of points used to divide up the theta axis
      - "n-r-points: unsigned int -- number of points used to divide up the radius axis
+     - "min-value": double -- spectrum cells with values at or below this are not transformed (waterfall candidates and spectrograms only); default is 0
 
      Slots:
      - "swf-cand": void (Nymph::KTDataPtr) -- Performs a Hough Transform on sparse waterfall candidate data; Requires KTSparseWaterfallCandidateData; Adds KTHoughData
      - "wf-cand": void (Nymph::KTDataPtr) -- Performs a Hough Transform on waterfall candidate data; Requires KTWaterfallCandidateData; Adds KTHoughData
      - "disc": void (Nymph::KTDataPtr) -- Performs a Hough Transform on discriminated (2D) points; Requires KTDiscriminatedPoints2DData; Adds KTHoughData
+     - "spectrogram": void (Nymph::KTDataPtr) -- Performs a Hough Transform on each component of a dense spectrogram; Requires KTSpectrogramData; Adds KTHoughData
 
      Signals:
      - "hough": void (Nymph::KTDataPtr) Emitted upon performance of a transform; Guarantees KTHoughData
@@ -57,6 +72,24 @@ namespace Katydid
             typedef KTDiscriminatedPoints2DData::SetOfPoints SetOfPoints;
             typedef KTDiscriminatedPoints SWFPoints;
 
+            /// A vote at integer (bin) coordinates
+            struct BinVote
+            {
+                unsigned fXBin;
+                unsigned fYBin;
+                double fValue;
+            };
+            typedef std::vector< BinVote > BinVotes;
+
+            /// A vote at real-valued coordinates
+            struct PointVote
+            {
+                double fX;
+                double fY;
+                double fValue;
+            };
+            typedef std::vector< PointVote > PointVotes;
+
         public:
             KTHoughTransform(const std::string& name = "hough-transform");
             virtual ~KTHoughTransform();
@@ -71,12 +104,37 @@ namespace Katydid
 
             bool TransformData(KTDiscriminatedPoints2DData& data);
             KTPhysicalArray< 2, double >* TransformSetOfPoints(const SetOfPoints& points, unsigned nTimeBins, unsigned nFreqBins);
+
+            bool TransformData(KTSpectrogramData& data);
+            KTPhysicalArray< 2, double >* TransformSpectrum(const KTSpectrogram* spectrogram);
         
         MEMBERVARIABLE(unsigned, NThetaPoints);
         MEMBERVARIABLE(unsigned, NRPoints);
+        MEMBERVARIABLE(double, MinValue);
 
+        public:
+            /// Adds the votes to a (theta, r) transform with fNThetaPoints x fNRPoints bins
+            void AccumulateVotes(const BinVotes& votes, KTPhysicalArray< 2, double >& transform);
+            void AccumulateVotes(const PointVotes& votes, KTPhysicalArray< 2, double >& transform);
 
         private:
+            KTPhysicalArray< 2, double >* CreateTransform(double maxR);
+            unsigned GetThetaTileSize() const;
+
+            /// Same binning as KTAxisProperties::FindBin for the radius axis
+            struct RadiusAxis
+            {
+                double fMin;
+                double fMax;
+                double fBinWidth;
+                unsigned fNBins;
+                RadiusAxis(const KTPhysicalArray< 2, double >& transform) : fMin(transform.GetRangeMin(2)), fMax(transform.GetRangeMax(2)), fBinWidth(transform.GetBinWidth(2)), fNBins(transform.GetData().size2()) {}
+                inline unsigned FindBin(double radius) const
+                {
+                    return radius < fMin ? 0 : radius >= fMax ? fNBins - 1 : unsigned(floor((radius - fMin) / fBinWidth));
+                }
+            };
+
             //KTPhysicalArray< 1, KTFrequencySpectrumPolar* >* RemoveNegativeFrequencies(const KTPhysicalArray< 1, KTFrequencySpectrumFFTW* >* inputSpectrum);
 
             std::vector< double > fCosTheta;
@@ -97,6 +155,7 @@ namespace Katydid
              Nymph::KTSlotDataOneType< KTSparseWaterfallCandidateData > fSWFCandSlot;
              Nymph::KTSlotDataOneType< KTWaterfallCandidateData > fWFCandSlot;
              Nymph::KTSlotDataOneType< KTDiscriminatedPoints2DData > fDiscPts2DSlot;
+             Nymph::KTSlotDataOneType< KTSpectrogramData > fSpectrogramSlot;
 
     };
 
@@ -9,6 +9,11 @@
 
 #include "KTKDTreeData.hh"
 #include "KTLogger.hh"
+#include "KTParallelQuery.hh"
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
 
 using std::string;
 
@@ -25,6 +30,7 @@ namespace Katydid
             fRadius(1.0),
             fMinInRadius(1),
             fRemoveNoiseFlag(false),
+            fNThreads(0),
             fKDTreeSignal("kd-tree-out", this),
             fKDTreeNNSlot("kdt-nn", this, &KTNNFilter::FilterByNNDist, &fKDTreeSignal),
             fKDTreeRadiusSlot("kdt-rad", this, &KTNNFilter::FilterByMinInRadius, &fKDTreeSignal)
@@ -43,6 +49,7 @@ namespace Katydid
         SetRadius(node->get_value("radius", GetRadius()));
         SetMinInRadius(node->get_value("min-in-radius", GetMinInRadius()));
         SetRemoveNoiseFlag(node->get_value("remove-noise", GetRemoveNoiseFlag()));
+        SetNThreads(node->get_value("n-threads", GetNThreads()));
 
         return true;
     }
@@ -107,35 +114,60 @@ namespace Katydid
     {
         double maxDistSq = fMaxDist * fMaxDist;
         unsigned nPoints = kdTree->size();
-        noiseIndices.clear();
-        double timeDelta, frequencyDelta;
-        for (unsigned iPoint = 0; iPoint < nPoints; ++iPoint)
+        unsigned nThreads = KTParallelQuery::NThreads(fNThreads);
+        std::vector< std::vector< size_t > > threadNoise(nThreads);
+
+#pragma omp parallel num_threads(nThreads)
         {
-            KTTreeIndex< double >::Neighbors ne = kdTree->NearestNeighborsByNumber(iPoint, 2);
-            timeDelta = setOfPoints[ne[1]].fCoords[0] - setOfPoints[iPoint].fCoords[0];
-            frequencyDelta = setOfPoints[ne[1]].fCoords[1] - setOfPoints[iPoint].fCoords[1];
-            if (timeDelta*timeDelta + frequencyDelta*frequencyDelta > maxDistSq)
+#ifdef USE_OPENMP
+            std::vector< size_t >& noise = threadNoise[omp_get_thread_num()];
+#else
+            std::vector< size_t >& noise = threadNoise[0];
+#endif
+            double timeDelta, frequencyDelta;
+#pragma omp for schedule(dynamic, 256)
+            for (unsigned iPoint = 0; iPoint < nPoints; ++iPoint)
             {
-                noiseIndices.push_back(iPoint);
+                KTTreeIndex< double >::Neighbors ne = kdTree->NearestNeighborsByNumber(iPoint, 2);
+                timeDelta = setOfPoints[ne[1]].fCoords[0] - setOfPoints[iPoint].fCoords[0];
+                frequencyDelta = setOfPoints[ne[1]].fCoords[1] - setOfPoints[iPoint].fCoords[1];
+                if (timeDelta*timeDelta + frequencyDelta*frequencyDelta > maxDistSq)
+                {
+                    noise.push_back(iPoint);
+                }
             }
         }
+
+        KTParallelQuery::MergeIndices(threadNoise, noiseIndices);
         return true;
     }
 
     bool KTNNFilter::FilterByMinInRadius(const KTTreeIndex< double >* kdTree, const KTKDTreeData::SetOfPoints& setOfPoints, std::vector< size_t >& noiseIndices)
     {   
         unsigned nPoints = kdTree->size();
-        noiseIndices.clear();
-        double timeDelta, frequencyDelta;
         unsigned nPtsInRadiusThreshold = fMinInRadius + 1; // since the neighbors returned by the k-d tree search function always includes the point itself
-        for (unsigned iPoint = 0; iPoint < nPoints; ++iPoint)
+        unsigned nThreads = KTParallelQuery::NThreads(fNThreads);
+        std::vector< std::vector< size_t > > threadNoise(nThreads);
+
+#pragma omp parallel num_threads(nThreads)
         {
-            KTTreeIndex< double >::Neighbors ne = kdTree->NearestNeighborsByRadius(iPoint, fRadius);
-            if (ne.size() < nPtsInRadiusThreshold)
+#ifdef USE_OPENMP
+            std::vector< size_t >& noise = threadNoise[omp_get_thread_num()];
+#else
+            std::vector< size_t >& noise = threadNoise[0];
+#endif
+#pragma omp for schedule(dynamic, 256)
+            for (unsigned iPoint = 0; iPoint < nPoints; ++iPoint)
             {
-                noiseIndices.push_back(iPoint);
+                KTTreeIndex< double >::Neighbors ne = kdTree->NearestNeighborsByRadius(iPoint, fRadius);
+                if (ne.size() < nPtsInRadiusThreshold)
+                {
+                    noise.push_back(iPoint);
+                }
             }
         }
+
+        KTParallelQuery::MergeIndices(threadNoise, noiseIndices);
         return true;
     }
 
@@ -31,7 +31,11 @@ namespace Katydid
      There are two filtering options:
      1) Filter points by maximum nearest-neighbor distance.  If a point's nearest neighbor is farther than fMaxDist, then it is flagged/removed as noise.
      2) Filter points by minimum within a radius. If a point has too few neighbors within fRadius, then it is flagged/removed as noise.
- 
+
+     The neighbor queries only read the k-d tree, so the points are processed in parallel when OpenMP is enabled.
+     Each thread collects its noise points in its own buffer, and the buffers are merged in point order,
+     so the result doesn't depend on the number of threads.
+
      Configuration name: "nn-filter"
 
      Available configuration values:
@@ -39,6 +43,7 @@ namespace Katydid
      - "radius": double -- Radius used to count neighbors for filtering option (2).
      - "min-in-radius": unsigned -- Minimum number of neighbors required for filtering option (2).
      - "remove-noise": bool -- Flag that determines whether noise points are removed (true) or flagged (false; default)
+     - "n-threads": unsigned -- Number of threads used for the neighbor queries; 0 (default) uses the OpenMP default; ignored without OpenMP
 
      Slots:
      - "kdt-nn": void (Nymph::KTDataPtr) -- Filters k-d tree data based on the maximum nearest-neighbor distance; Requires KTKDTreeData; existing data is modified
@@ -60,6 +65,7 @@ namespace Katydid
             MEMBERVARIABLE(double, Radius);
             MEMBERVARIABLE(unsigned, MinInRadius);
             MEMBERVARIABLE(bool, RemoveNoiseFlag);
+            MEMBERVARIABLE(unsigned, NThreads);
 
         public:
             bool FilterByNNDist(KTKDTreeData& kdTreeData);
@@ -68,8 +74,6 @@ namespace Katydid
             bool FilterByNNDist(const KTTreeIndex< double >* kdTree, const KTKDTreeData::SetOfPoints& setOfPoints, std::vector< size_t >& noisePoints);
             bool FilterByMinInRadius(const KTTreeIndex< double >* kdTree, const KTKDTreeData::SetOfPoints& setOfPoints, std::vector< size_t >& noisePoints);
 
-        private:
-
             //***************
             // Signals
             //***************
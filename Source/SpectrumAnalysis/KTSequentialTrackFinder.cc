@@ -20,8 +20,10 @@
 #include "KTDiscriminatedPoints1DData.hh"
 
 
-#include <numeric>
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <numeric>
 
 using std::vector;
 
@@ -66,6 +68,12 @@ namespace Katydid
                     fCalculateMinBin(true),
                     fCalculateMaxBin(true),
                     fActiveLines(),
+                    fLineFrequencyIndex(),
+                    fLineEndTimeIndex(),
+                    fExpiredLines(),
+                    fNextLineNumber(0),
+                    fIndexTimeInAcq(0.),
+                    fMaxAbsLineSlope(0.),
                     fNLines(0),
                     fApplyTotalPowerCut(false),
                     fApplyAveragePowerCut(false),
@@ -320,14 +328,13 @@ namespace Katydid
             // this set will collect the discriminated points sorted by power
             STFDiscriminatedPowerSortedPoints points;
 
+            // the points are sorted by bin, so the points in [fMinBin, fMaxBin] are found with a range lookup
             const KTDiscriminatedPoints1DData::SetOfPoints&  incomingPts = discrimPoints.GetSetOfPoints(iComponent);
-            for (KTDiscriminatedPoints1DData::SetOfPoints::const_iterator pIt = incomingPts.begin(); pIt != incomingPts.end(); ++pIt)
+            KTDiscriminatedPoints1DData::SetOfPoints::const_range inRange = incomingPts.GetRange(fMinBin, fMaxBin + 1);
+            for (KTDiscriminatedPoints1DData::SetOfPoints::const_iterator pIt = inRange.first; pIt != inRange.second; ++pIt)
             {
-                if ( pIt->first >= fMinBin and pIt->first <= fMaxBin )
-                {
-                    //KTINFO(stflog, "discriminated point: bin = " <<pIt->first<< ", frequency = "<<pIt->second.fAbscissa<< ", amplitude = "<<pIt->second.fOrdinate <<", threshold = "<<pIt->second.fThreshold);
-                    points.emplace(pIt, newTimeInRunC, newTimeInAcq);
-                }
+                //KTINFO(stflog, "discriminated point: bin = " <<pIt->first<< ", frequency = "<<pIt->second.fAbscissa<< ", amplitude = "<<pIt->second.fOrdinate <<", threshold = "<<pIt->second.fThreshold);
+                points.emplace(pIt, newTimeInRunC, newTimeInAcq);
             }
 
             // sort points by power
@@ -419,8 +426,12 @@ namespace Katydid
     {
         KTDEBUG(stflog, "Time and Frequency tolerances are "<<fTimeGapTolerance<<" "<<fFrequencyAcceptance);
 
+        if (points.empty()) return true;
+
+        // all of the points are from the same slice, so the lines' frequencies are extrapolated to the time of that slice
+        IndexLineFrequencies(points.rbegin()->fTimeInAcq);
+
         double newFreq = 0.0;
-        bool match;
 
         //loop in reverse order (by power)
         for(STFDiscriminatedPowerSortedPoints::reverse_iterator pointIt = points.rbegin(); pointIt != points.rend(); ++pointIt)
@@ -450,79 +461,7 @@ namespace Katydid
             }
             else
             {
-                match = false;
-
-                // loop over active lines, in order of earliest start time
-                // dont need to sort them because they are already sorted by the slice of the line's start point
-
-                //KTDEBUG(stflog, "Currently there are N active Lines "<<fActiveLines.size());
-
-                std::vector< KTSequentialLineData >::iterator lineIt = fActiveLines.begin();
-                while( lineIt != fActiveLines.end())
-                {
-                    // Check whether line should still be active. If not then check whether the line is a valid new track candidate.
-                    if (lineIt->GetEndTimeInRunC() <pointIt->fTimeInRunC-fTimeGapTolerance)
-                    {
-                        if (lineIt->GetNPoints() >= fMinPoints)
-                        {
-                            lineIt->LineSNRTrimming(fTrimmingThreshold, fMinPoints);
-
-                            if (lineIt->GetNPoints() >= fMinPoints and lineIt->GetSlope() >= fMinSlope)
-                            {
-                                KTINFO(stflog, "Found track candidate");
-                                (this->*fCalcSlope)(*lineIt);
-                                this->EmitPreCandidate(*lineIt);
-                            }
-                        }
-                        // in any case, this line should be removed from the vector with active lines
-                        lineIt = fActiveLines.erase(lineIt);
-                    }
-                    else
-                    {
-                        // Under these conditions a point will be added to a line
-                        bool timeCondition = tempPoint.fTimeInRunC > lineIt->GetEndTimeInRunC();
-                        bool anyPointCondition = std::abs(tempPoint.fFrequency - (lineIt->GetEndFrequency() + lineIt->GetSlope()*(pointIt->fTimeInAcq - lineIt->GetEndTimeInAcq()))) < fFrequencyAcceptance;
-                        bool secondPointCondition = std::abs(tempPoint.fFrequency - (lineIt->GetEndFrequency() + lineIt->GetSlope()*(pointIt->fTimeInAcq - lineIt->GetEndTimeInAcq()))) < fInitialFrequencyAcceptance;
-
-                        // if point matches this line: insert
-                        if (timeCondition and anyPointCondition)
-                        {
-                            lineIt->AddPoint(tempPoint);
-                            (this->*fCalcSlope)(*lineIt);
-                            match = true;
-                            break;
-                        }
-                        // if this line consists of only one point so far, try again with different radius
-                        else if (lineIt->GetNPoints() == 1 and timeCondition and secondPointCondition)
-                        {
-                            KTDEBUG(stflog, "Trying initial-frequency-acceptance "<<fInitialFrequencyAcceptance);
-                            lineIt->AddPoint(tempPoint);
-                            (this->*fCalcSlope)(*lineIt);
-                            match = true;
-                            break;
-                        }
-                        // if not try next line
-                        else
-                        {
-                            ++lineIt;
-                        }
-                    }
-                }//end of while loop. all existing lines were compared
-
-                // if point was not picked up
-                if (match == false)
-                {
-                    //KTDEBUG(stflog, "Starting new line");
-
-                    KTSequentialLineData newLine;
-                    newLine.SetSlope( fInitialSlope );
-                    newLine.SetAcquisitionID( acqID );
-                    newLine.SetComponent( component );
-                    newLine.AddPoint(tempPoint);
-                    (this->*fCalcSlope)(newLine);
-                    fActiveLines.push_back(newLine);
-                    match = true;
-                }
+                this->AddPointToLines(tempPoint, acqID, component);
             }
         }
         return true;
@@ -532,8 +471,12 @@ namespace Katydid
     {
         KTDEBUG(stflog, "Adding " << points.size() << " points to lines; Time and Frequency tolerances are " << fTimeGapTolerance<< "s and " << fFrequencyAcceptance << "Hz");
 
+        if (points.empty()) return true;
+
+        // the points are from the same slice (or nearly so), so the lines' frequencies are extrapolated to the time of the highest-power point, which is visited first
+        IndexLineFrequencies(points.rbegin()->fTimeInAcq);
+
         double newFreq = 0.0;
-        bool match;
 
         //loop in reverse order (by power)
         for (STFDiscriminatedPowerSortedPoints::reverse_iterator pointIt = points.rbegin(); pointIt != points.rend(); ++pointIt)
@@ -555,97 +498,157 @@ namespace Katydid
             }
             else
             {
-                match = false;
+                this->AddPointToLines(*pointIt, acqID, component);
+            }
+        }
+        return true;
+    }
+
+    void KTSequentialTrackFinder::AddPointToLines(const STFDiscriminatedPoint& point, uint64_t acqID, unsigned component)
+    {
+        // Lines that ended before this time are no longer active
+        double expirationTime = point.fTimeInRunC - fTimeGapTolerance;
+
+        // Find the earliest-created active line that accepts the point.
+        // Only lines with extrapolated frequencies within the acceptance of the point are checked;
+        // the margin covers the extrapolation from the index time to the time of the point, and rounding.
+        double acceptance = std::max(fFrequencyAcceptance, fInitialFrequencyAcceptance);
+        double margin = fMaxAbsLineSlope * std::abs(point.fTimeInAcq - fIndexTimeInAcq) + 1.e-9 * (std::abs(point.fFrequency) + acceptance);
+        LineIndex::const_iterator candEnd = fLineFrequencyIndex.upper_bound(std::make_pair(point.fFrequency + acceptance + margin, std::numeric_limits< unsigned >::max()));
+        LineIndex::const_iterator candIt = fLineFrequencyIndex.lower_bound(std::make_pair(point.fFrequency - acceptance - margin, 0u));
+
+        ActiveLines::iterator matchIt = fActiveLines.end();
+        for (; candIt != candEnd; ++candIt)
+        {
+            if (matchIt != fActiveLines.end() and candIt->second > matchIt->first) continue;
 
-                // loop over active lines, in order of earliest start time
-                // dont need to sort them because they are already sorted by the slice of the line's start point
+            ActiveLines::iterator lineIt = fActiveLines.find(candIt->second);
+            const KTSequentialLineData& line = lineIt->second.fLine;
 
-                //KTWARN(stflog, "Currently there are " << fActiveLines.size() << " active Lines ");
+            // expired lines are retired before a point can be added to them
+            if (line.GetEndTimeInRunC() < expirationTime) continue;
 
-                std::vector< KTSequentialLineData >::iterator lineIt = fActiveLines.begin();
-                while( lineIt != fActiveLines.end())
-                {
-                    // Check whether line should still be active. If not then check whether the line is a valid new track candidate.
-                    if (lineIt->GetEndTimeInRunC() < pointIt->fTimeInRunC - fTimeGapTolerance)
-                    {
-                        //KTWARN(stflog, "Gap between end of a line and the current time-in-run (" << pointIt->fTimeInRunC - lineIt->GetEndTimeInRunC()  << ") is larger than the gap tolerance; evaluating line");
-                        if (lineIt->GetNPoints() >= fMinPoints)
-                        {
-                            //KTWARN(stflog, "    line had more than the minimum number of points (" << lineIt->GetNPoints() << ")");
-                            lineIt->LineSNRTrimming(fTrimmingThreshold, fMinPoints);
-
-                            if (lineIt->GetNPoints() >= fMinPoints and lineIt->GetSlope() >= fMinSlope)
-                            {
-                                KTDEBUG(stflog, "Found line candidate");
-                                (this->*fCalcSlope)(*lineIt);
-                                this->EmitPreCandidate(*lineIt);
-                            }
-                            //else
-                            //{
-                            //    KTWARN(stflog, "    line cut after SNR trimming");
-                            //    KTWARN(stflog, "    npoints: " << lineIt->GetNPoints() << "; slope: " << lineIt->GetSlope());
-                           // }
-                        }
-                        //else
-                        //{
-                        //    KTWARN(stflog, "    line was cut because it didn't have enough points (" << lineIt->GetNPoints() << ")");
-                        //}
-                        // in any case, this line should be removed from the vector with active lines
-                        lineIt = fActiveLines.erase(lineIt);
-                    }
-                    else
-                    {
-                        // Under these conditions a point will be added to a line
-                        bool timeCondition = pointIt->fTimeInRunC > lineIt->GetEndTimeInRunC();
-                        //KTWARN(stflog, "time condition: " << timeCondition << " = " << pointIt->fTimeInRunC << " > " << lineIt->GetEndTimeInRunC() );
-                        bool anyPointCondition = std::abs(pointIt->fFrequency - (lineIt->GetEndFrequency() + lineIt->GetSlope()*(pointIt->fTimeInAcq - lineIt->GetEndTimeInAcq()))) < fFrequencyAcceptance;
-                        //KTWARN(stflog, "any point condition: " << anyPointCondition << " = | " << pointIt->fFrequency << " - ( " << lineIt->GetEndFrequency() << " + " << lineIt->GetSlope() << " * ( " << pointIt->fTimeInAcq << " - " << lineIt->GetEndTimeInAcq() << " ))| < " << fFrequencyAcceptance);
-                        bool secondPointCondition = std::abs(pointIt->fFrequency - (lineIt->GetEndFrequency() + lineIt->GetSlope()*(pointIt->fTimeInAcq - lineIt->GetEndTimeInAcq()))) < fInitialFrequencyAcceptance;
-                        //KTWARN(stflog, "second point condition: " << secondPointCondition << " = |" << pointIt->fFrequency << " - ( " << lineIt->GetEndFrequency() << " + " << lineIt->GetSlope() << " * ( " << pointIt->fTimeInAcq << " - " << lineIt->GetEndTimeInAcq() << " ))| < " << fInitialFrequencyAcceptance);
-
-                        // if point matches this line: insert
-                        if (timeCondition and anyPointCondition)
-                        {
-                            KTDEBUG(stflog, "Matching conditions fulfilled");
-                            lineIt->AddPoint(*pointIt);
-                            (this->*fCalcSlope)(*lineIt);
-                            match = true;
-                            break;
-                        }
-                        // if this line consists of only one point so far, try again with different radius
-                        else if (lineIt->GetNPoints() == 1 and timeCondition and secondPointCondition)
-                        {
-                            KTDEBUG(stflog, "Trying initial-frequency-acceptance "<<fInitialFrequencyAcceptance);
-                            lineIt->AddPoint(*pointIt);
-                            (this->*fCalcSlope)(*lineIt);
-                            match = true;
-                            break;
-                        }
-                        // if not try next line
-                        else
-                        {
-                            ++lineIt;
-                        }
-                    }
-                }//end of while loop. all existing lines were compared
-
-                // if point was not picked up
-                if (match == false)
+            // Under these conditions a point will be added to a line
+            bool timeCondition = point.fTimeInRunC > line.GetEndTimeInRunC();
+            double frequencyDistance = std::abs(point.fFrequency - (line.GetEndFrequency() + line.GetSlope()*(point.fTimeInAcq - line.GetEndTimeInAcq())));
+            bool anyPointCondition = frequencyDistance < fFrequencyAcceptance;
+            // if this line consists of only one point so far, the initial frequency acceptance is used as well
+            bool secondPointCondition = line.GetNPoints() == 1 and frequencyDistance < fInitialFrequencyAcceptance;
+
+            if (timeCondition and (anyPointCondition or secondPointCondition))
+            {
+                matchIt = lineIt;
+            }
+        }
+
+        // Lines that have ended before the expiration time are moved from the end-time index to the set of expired lines
+        LineIndex::iterator endIt = fLineEndTimeIndex.begin();
+        for (; endIt != fLineEndTimeIndex.end() and endIt->first < expirationTime; ++endIt)
+        {
+            fExpiredLines.insert(endIt->second);
+        }
+        fLineEndTimeIndex.erase(fLineEndTimeIndex.begin(), endIt);
+
+        // Retire the expired lines that were created before the matching line (or all of them if there's no match), in order of creation.
+        // Check whether each one is a valid new track candidate.
+        unsigned matchNumber = matchIt == fActiveLines.end() ? std::numeric_limits< unsigned >::max() : matchIt->first;
+        std::set< unsigned >::iterator expIt = fExpiredLines.begin();
+        while (expIt != fExpiredLines.end() and *expIt < matchNumber)
+        {
+            ActiveLines::iterator lineIt = fActiveLines.find(*expIt);
+            KTSequentialLineData& line = lineIt->second.fLine;
+            // points are not always in time order, so this line may not have expired relative to this point
+            if (line.GetEndTimeInRunC() >= expirationTime)
+            {
+                ++expIt;
+                continue;
+            }
+
+            if (line.GetNPoints() >= fMinPoints)
+            {
+                line.LineSNRTrimming(fTrimmingThreshold, fMinPoints);
+
+                if (line.GetNPoints() >= fMinPoints and line.GetSlope() >= fMinSlope)
                 {
-                    //KTWARN(stflog, "Starting new line");
-
-                    KTSequentialLineData newLine;
-                    newLine.SetSlope( fInitialSlope );
-                    newLine.SetAcquisitionID( acqID );
-                    newLine.SetComponent( component );
-                    newLine.AddPoint(*pointIt);
-                    (this->*fCalcSlope)(newLine);
-                    fActiveLines.push_back(newLine);
-                    match = true;
+                    KTDEBUG(stflog, "Found line candidate");
+                    (this->*fCalcSlope)(line);
+                    this->EmitPreCandidate(line);
                 }
             }
+            // in any case, this line should be removed from the active lines
+            if (std::isfinite(lineIt->second.fIndexFrequency))
+            {
+                fLineFrequencyIndex.erase(std::make_pair(lineIt->second.fIndexFrequency, lineIt->first));
+            }
+            fActiveLines.erase(lineIt);
+            expIt = fExpiredLines.erase(expIt);
         }
-        return true;
+
+        if (matchIt != fActiveLines.end())
+        {
+            KTDEBUG(stflog, "Matching conditions fulfilled");
+            UnindexLine(matchIt);
+            matchIt->second.fLine.AddPoint(point);
+            (this->*fCalcSlope)(matchIt->second.fLine);
+            IndexLine(matchIt);
+        }
+        else
+        {
+            // if point was not picked up, start a new line
+            ActiveLines::iterator newIt = fActiveLines.insert(fActiveLines.end(), std::make_pair(fNextLineNumber++, ActiveLine()));
+            KTSequentialLineData& newLine = newIt->second.fLine;
+            newLine.SetSlope( fInitialSlope );
+            newLine.SetAcquisitionID( acqID );
+            newLine.SetComponent( component );
+            newLine.AddPoint(point);
+            (this->*fCalcSlope)(newLine);
+            IndexLine(newIt);
+        }
+        return;
+    }
+
+    void KTSequentialTrackFinder::IndexLineFrequencies(double timeInAcq)
+    {
+        fIndexTimeInAcq = timeInAcq;
+        fLineFrequencyIndex.clear();
+        fMaxAbsLineSlope = 0.;
+        for (ActiveLines::iterator lineIt = fActiveLines.begin(); lineIt != fActiveLines.end(); ++lineIt)
+        {
+            const KTSequentialLineData& line = lineIt->second.fLine;
+            lineIt->second.fIndexFrequency = line.GetEndFrequency() + line.GetSlope()*(fIndexTimeInAcq - line.GetEndTimeInAcq());
+            // lines with non-finite frequencies can't accept points, and would break the ordering of the index
+            if (std::isfinite(lineIt->second.fIndexFrequency))
+            {
+                fLineFrequencyIndex.insert(fLineFrequencyIndex.end(), std::make_pair(lineIt->second.fIndexFrequency, lineIt->first));
+                fMaxAbsLineSlope = std::max(fMaxAbsLineSlope, std::abs(line.GetSlope()));
+            }
+        }
+        return;
+    }
+
+    void KTSequentialTrackFinder::IndexLine(ActiveLines::iterator lineIt)
+    {
+        const KTSequentialLineData& line = lineIt->second.fLine;
+        lineIt->second.fIndexFrequency = line.GetEndFrequency() + line.GetSlope()*(fIndexTimeInAcq - line.GetEndTimeInAcq());
+        if (std::isfinite(lineIt->second.fIndexFrequency))
+        {
+            fLineFrequencyIndex.insert(std::make_pair(lineIt->second.fIndexFrequency, lineIt->first));
+            fMaxAbsLineSlope = std::max(fMaxAbsLineSlope, std::abs(line.GetSlope()));
+        }
+        lineIt->second.fIndexEndTime = line.GetEndTimeInRunC();
+        fLineEndTimeIndex.insert(std::make_pair(lineIt->second.fIndexEndTime, lineIt->first));
+        return;
+    }
+
+    void KTSequentialTrackFinder::UnindexLine(ActiveLines::iterator lineIt)
+    {
+        if (std::isfinite(lineIt->second.fIndexFrequency))
+        {
+            fLineFrequencyIndex.erase(std::make_pair(lineIt->second.fIndexFrequency, lineIt->first));
+        }
+        fLineEndTimeIndex.erase(std::make_pair(lineIt->second.fIndexEndTime, lineIt->first));
+        fExpiredLines.erase(lineIt->first);
+        return;
     }
 
 
@@ -848,20 +851,25 @@ namespace Katydid
     {
         KTINFO(stflog, "Got egg-done signal. Checking remaining line candidates");
 
-        std::vector< KTSequentialLineData >::iterator lineIt = fActiveLines.begin();
+        // lines are checked in order of creation
+        ActiveLines::iterator lineIt = fActiveLines.begin();
         while( lineIt != fActiveLines.end())
         {
-            if (lineIt->GetNPoints() >= fMinPoints)
+            KTSequentialLineData& line = lineIt->second.fLine;
+            if (line.GetNPoints() >= fMinPoints)
             {
-                lineIt->LineSNRTrimming(fTrimmingThreshold, fMinPoints);
+                line.LineSNRTrimming(fTrimmingThreshold, fMinPoints);
 
-                if (lineIt->GetNPoints() >= fMinPoints and lineIt->GetSlope() > fMinSlope)
+                if (line.GetNPoints() >= fMinPoints and line.GetSlope() > fMinSlope)
                 {
-                    this->EmitPreCandidate(*lineIt);
+                    this->EmitPreCandidate(line);
                 }
             }
             lineIt = fActiveLines.erase(lineIt);
         }
+        fLineFrequencyIndex.clear();
+        fLineEndTimeIndex.clear();
+        fExpiredLines.clear();
         KTDEBUG(stflog, "Now there should be no lines left over " << fActiveLines.empty());
     }
 
@@ -14,11 +14,14 @@
 #include "KTDiscriminatedPoints1DData.hh"
 #include "KTDiscriminatedPoint.hh"
 #include "KTKDTreeData.hh"
+#include "KTSequentialLineData.hh"
 
 #include "KTMemberVariable.hh"
 #include "KTSlot.hh"
 
+#include <map>
 #include <set>
+#include <utility>
 
 
 namespace Katydid
@@ -26,7 +29,6 @@ namespace Katydid
     class KTEggHeader;
     class KTPowerSpectrum;
     class KTPowerSpectrumData;
-    class KTSequentialLineData;
     class KTSliceHeader;
 
     /*!
@@ -71,6 +73,14 @@ namespace Katydid
      - "total-residual-threshold": threshold for apply-total-residual-cut
      - "average-residual-threshold": threshold for apply-average-residual
 
+     Active lines:
+     The lines that can still accept points are kept in a table ordered by creation, along with two indices:
+     one by the line frequency extrapolated to the time of the current slice, and one by the line end time.
+     Each point is only compared to the lines whose extrapolated frequency is within the frequency acceptance of the point,
+     and lines move from the end-time index to a set of expired lines as time advances, rather than being found by scanning all of the lines.
+     The first-created matching line gets the point, and lines are retired in the same order as a linear scan would retire them,
+     so the candidates (including their IDs) are the same as those of a linear scan over all active lines.
+
      Slope method:
      The slope-method controls which method is used for updating the line slope when a new point is added to the line.
      There are 3 available options:
@@ -194,8 +204,36 @@ namespace Katydid
 
             const std::set< Nymph::KTDataPtr >& GetCandidates() const;
 
+            unsigned GetNActiveLines() const;
+
         private:
-            std::vector< KTSequentialLineData > fActiveLines;
+            /// Adds a point to the first-created active line that accepts it, or starts a new line; expired lines are retired along the way
+            void AddPointToLines(const STFDiscriminatedPoint& point, uint64_t acqID, unsigned component);
+
+            struct ActiveLine
+            {
+                KTSequentialLineData fLine;
+                double fIndexFrequency; // line frequency extrapolated to fIndexTimeInAcq; key in fLineFrequencyIndex
+                double fIndexEndTime; // line end time in run; key in fLineEndTimeIndex
+            };
+            /// Active lines keyed by line number, which increases in order of creation
+            typedef std::map< unsigned, ActiveLine > ActiveLines;
+            /// Index of lines: (key, line number)
+            typedef std::set< std::pair< double, unsigned > > LineIndex;
+
+            /// Rebuilds the frequency index with the lines' frequencies extrapolated to the given time
+            void IndexLineFrequencies(double timeInAcq);
+            void IndexLine(ActiveLines::iterator lineIt);
+            void UnindexLine(ActiveLines::iterator lineIt);
+
+            ActiveLines fActiveLines;
+            LineIndex fLineFrequencyIndex;
+            LineIndex fLineEndTimeIndex; // lines that have not yet expired
+            std::set< unsigned > fExpiredLines; // expired lines waiting to be retired
+            unsigned fNextLineNumber;
+            double fIndexTimeInAcq;
+            double fMaxAbsLineSlope; // largest slope magnitude of the lines in the frequency index
+
             std::set< Nymph::KTDataPtr > fCandidates;
 
 
@@ -225,5 +263,10 @@ namespace Katydid
         return fCandidates;
     }
 
+    inline unsigned KTSequentialTrackFinder::GetNActiveLines() const
+    {
+        return unsigned(fActiveLines.size());
+    }
+
 } /* namespace Katydid */
 #endif /* KTSEQUENTIALTRACKFinder_HH_ */
@@ -13,6 +13,7 @@
 #include "KTMultiFSDataPolar.hh"
 #include "KTMultiPSData.hh"
 #include "KTPowerSpectrum.hh"
+#include "KTSpectrogramData.hh"
 
 #include "param.hh"
 
@@ -34,9 +35,11 @@ namespace Katydid
             fStripeFSFFTWSignal("str-fs-fftw", this),
             fStripeFSPolarSignal("str-fs-polar", this),
             fStripePSSignal("str-ps", this),
+            fStripeSpectrogramSignal("str-spectrogram", this),
             fAddFSFFTWSlot("fs-fftw", this, &KTSpectrogramStriper::AddData),
             fAddFSPolarSlot("fs-polar", this, &KTSpectrogramStriper::AddData),
-            fAddPSSlot("ps", this, &KTSpectrogramStriper::AddData)
+            fAddPSSlot("ps", this, &KTSpectrogramStriper::AddData),
+            fAddPSSpectrogramSlot("ps-spectrogram", this, &KTSpectrogramStriper::AddSpectrogramData)
     {
     }
 
@@ -99,13 +102,94 @@ namespace Katydid
         return CoreAddData(header, static_cast< KTPowerSpectrumDataCore& >(data), accDataStruct, accData);
     }
 
+    bool KTSpectrogramStriper::AddSpectrogramData(KTSliceHeader& header, KTPowerSpectrumData& data)
+    {
+        StripeAccumulator& accDataStruct = GetOrCreateAccumulator< KTSpectrogramData >();
+        KTSpectrogramDataCore& accData = accDataStruct.fDataPtr->Of< KTSpectrogramData >();
+
+        unsigned nComponents = data.GetNComponents();
+
+        if (accData.GetNComponents() == 0) // this is the first time through this function
+        {
+            KTDEBUG(sslog, "This is the first time through AddSpectrogramData");
+            accDataStruct.fSliceHeader.CopySliceHeaderOnly(header);
+            accData.SetNComponents(nComponents);
+            for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
+            {
+                const KTPowerSpectrum* dataPS = data.GetSpectrum(iComponent);
+                KTSpectrogram* newSpectrogram = new KTSpectrogram(fStripeSize, header.GetTimeInRun(), header.GetTimeInRun() + fStripeSize * header.GetSliceLength(),
+                        dataPS->size(), dataPS->GetRangeMin(), dataPS->GetRangeMax());
+                *newSpectrogram = 0.;
+                newSpectrogram->OverrideMode(dataPS->GetMode());
+                accData.SetSpectrogram(newSpectrogram, iComponent);
+            }
+        }
+        else if (header.GetIsNewAcquisition()) // this starts a new acquisition, so it should start a new stripe, ignoring the overlap
+        {
+            KTDEBUG(sslog, "This is a new acquisition; will emit signal if there's a partially-filled stripe");
+
+            // emit signal for the current stripe if there is an existing partially-filled stripe
+            if (accDataStruct.fNextBin != fStripeOverlap || (accDataStruct.fFirstAccumulation && accDataStruct.fNextBin == fStripeOverlap)) fStripeSpectrogramSignal(accDataStruct.fDataPtr);
+
+            for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
+            {
+                KTSpectrogram* spectrogram = accData.GetSpectrogram(iComponent);
+                *spectrogram = 0.;
+                spectrogram->GetTimeAxis().SetRange(header.GetTimeInRun(), header.GetTimeInRun() + fStripeSize * header.GetSliceLength());
+            }
+
+            accDataStruct.fSliceHeader.CopySliceHeaderOnly(header);
+            accDataStruct.fNextBin = 0;
+            accDataStruct.fFirstAccumulation = true;
+        }
+        else if (accDataStruct.fNextBin == fStripeOverlap  && ! accDataStruct.fFirstAccumulation) // this isn't the first time through, but we have a fresh stripe, so we move the overlap region to the start
+        {
+            accDataStruct.fSliceHeader.CopySliceHeaderOnly(header);
+            KTDEBUG(sslog, "Moving the overlap region");
+            for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
+            {
+                // also zeroes all of the rows after the overlap
+                accData.GetSpectrogram(iComponent)->ShiftRows(fStripeSize - fStripeOverlap);
+            }
+        }
+
+        if (nComponents != accData.GetNComponents())
+        {
+            KTERROR(sslog, "Numbers of components in the stripe and in the new data do not match");
+            return false;
+        }
+
+        for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
+        {
+            if (! accData.GetSpectrogram(iComponent)->SetRow(accDataStruct.fNextBin, *data.GetSpectrum(iComponent)))
+            {
+                KTERROR(sslog, "Sizes of arrays in the stripe and in the new data do not match");
+                return false;
+            }
+        }
+
+        accDataStruct.fNextBin += 1;
+        if (accDataStruct.fNextBin == fStripeSize)
+        {
+            // emit the signal for this stripe
+            KTDEBUG(sslog, "Finished a dense stripe; emitting signal");
+            fStripeSpectrogramSignal(accDataStruct.fDataPtr);
+            accDataStruct.fNextBin = fStripeOverlap;
+            accDataStruct.fFirstAccumulation = false;
+        }
+
+        return true;
+    }
+
     bool KTSpectrogramStriper::OutputStripes()
     {
         KTINFO(sslog, "Outputting all histograms");
         for (AccumulatorMapIt accIt = fDataMap.begin(); accIt != fDataMap.end(); ++accIt)
         {
             KTDEBUG(sslog, "Checking <" << accIt->first->name() << "> for final outputting");
-            if (accIt->second.fNextBin != fStripeOverlap) fStripeFSFFTWSignal(accIt->second.fDataPtr);
+            if (accIt->second.fNextBin == fStripeOverlap) continue;
+            if (accIt->first == &typeid(KTSpectrogramData)) fStripeSpectrogramSignal(accIt->second.fDataPtr);
+            else fStripeFSFFTWSignal(accIt->second.fDataPtr);
         }
         return true;
     }
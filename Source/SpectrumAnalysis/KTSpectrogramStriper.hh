@@ -53,11 +53,17 @@ namespace Katydid
      - "fs-fftw": void (KTDataPtr) -- Adds an FS-FFTW spectrum to the current (or a new) stripe; Requires KTSliceHeader and KTFrequencySpectrumDataFFTW
      - "fs-polar": void (KTDataPtr) -- Adds an FS-Polar spectrum to the current (or a new) stripe; Requires KTSliceHeader and KTFrequencySpectrumDataPolar
      - "ps: void (KTDataPtr) -- Adds a power spectrum to the current (or a new) stripe; Requires KTSliceHeader and KTPowerSpectrumData
+     - "ps-spectrogram": void (KTDataPtr) -- Adds a power spectrum to the current (or a new) dense stripe; Requires KTSliceHeader and KTPowerSpectrumData
 
      Signals:
      - "str-fs-fftw": void (KTDataPtr) -- Emitted upon completion of an FS-FFTW stripe, either after collecting the requisite number of spectra, when a new acquisition is starting, or when a file is done (when the "done" slot is used); Guarantees KTMultiFSDataFFTW.
      - "str-fs-polar": void (KTDataPtr) -- Emitted upon completion of an FS-Polar stripe, either after collecting the requisite number of spectra, when a new acquisition is starting, or when a file is done (when the "done" slot is used); Guarantees KTMultiFSDataPolar.
      - "str-ps": void (KTDataPtr) -- Emitted upon completion of a PS stripe, either after collecting the requisite number of spectra, when a new acquisition is starting, or when a file is done (when the "done" slot is used); Guarantees KTMultiPSData.
+     - "str-spectrogram": void (KTDataPtr) -- Emitted upon completion of a dense PS stripe, under the same conditions as the other stripes; Guarantees KTSliceHeader and KTSpectrogramData.
+
+     Dense stripes:
+     The "ps-spectrogram" slot builds each stripe as a KTSpectrogram, with all of the spectra in one contiguous block.
+     Incoming spectra are copied in one row at a time, and the overlap region is moved to the start of the block for the next stripe.
     */
     class KTSpectrogramStriper : public Nymph::KTProcessor
     {
@@ -113,6 +119,7 @@ namespace Katydid
             bool AddData(KTSliceHeader& header, KTFrequencySpectrumDataFFTW& data);
             bool AddData(KTSliceHeader& header, KTFrequencySpectrumDataPolar& data);
             bool AddData(KTSliceHeader& header, KTPowerSpectrumData& data);
+            bool AddSpectrogramData(KTSliceHeader& header, KTPowerSpectrumData& data);
 
             bool OutputStripes();
 
@@ -155,6 +162,7 @@ namespace Katydid
             Nymph::KTSignalData fStripeFSFFTWSignal;
             Nymph::KTSignalData fStripeFSPolarSignal;
             Nymph::KTSignalData fStripePSSignal;
+            Nymph::KTSignalData fStripeSpectrogramSignal;
 
             //***************
             // Slots
@@ -164,6 +172,7 @@ namespace Katydid
             Nymph::KTSlotDataTwoTypes< KTSliceHeader, KTFrequencySpectrumDataFFTW > fAddFSFFTWSlot;
             Nymph::KTSlotDataTwoTypes< KTSliceHeader, KTFrequencySpectrumDataPolar > fAddFSPolarSlot;
             Nymph::KTSlotDataTwoTypes< KTSliceHeader, KTPowerSpectrumData > fAddPSSlot;
+            Nymph::KTSlotDataTwoTypes< KTSliceHeader, KTPowerSpectrumData > fAddPSSpectrogramSlot;
 
     };
 
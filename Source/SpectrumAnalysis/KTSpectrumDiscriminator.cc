@@ -196,8 +196,8 @@ namespace Katydid
         unsigned nBins = fMaxBin - fMinBin + 1;
         double norm = 1. / double(nBins);
 
-        // Temporary storage for magnitude values
-        vector< double > magnitude(data.GetSpectrumFFTW(0)->size());
+        // Magnitudes of bins [fMinBin, fMaxBin]
+        vector< double > magnitude(nBins);
 
         for (unsigned iComponent=0; iComponent<nComponents; ++iComponent)
         {
@@ -207,9 +207,11 @@ namespace Katydid
                 KTERROR(sdlog, "Frequency spectrum pointer (component " << iComponent << ") is NULL!");
                 return false;
             }
-            if (spectrum->size() != magnitude.size())
+
+#pragma omp parallel for
+            for (unsigned iBin=fMinBin; iBin<=fMaxBin; ++iBin)
             {
-                magnitude.resize(spectrum->size());
+                magnitude[iBin - fMinBin] = sqrt((*spectrum)(iBin)[0] * (*spectrum)(iBin)[0] + (*spectrum)(iBin)[1] * (*spectrum)(iBin)[1]);
             }
 
             double mean = 0., variance = 0.;
@@ -220,51 +222,13 @@ namespace Katydid
             }
             else
             {
-#pragma omp parallel for reduction(+:mean)
-                for (unsigned iBin=fMinBin; iBin<=fMaxBin; ++iBin)
-                {
-                    magnitude[iBin] = sqrt((*spectrum)(iBin)[0] * (*spectrum)(iBin)[0] + (*spectrum)(iBin)[1] * (*spectrum)(iBin)[1]);
-                    mean += magnitude[iBin];
-                    variance += magnitude[iBin] * magnitude[iBin];
-                }
-                mean *= norm;
-                variance = variance*norm  - mean*mean;
+                CalculateMeanAndVariance(magnitude.data(), nBins, norm, mean, variance);
             }
 
-            double threshold = 0.;
-            if (fThresholdMode == eSNR_Amplitude)
-            {
-                // SNR = P_signal / P_noise = (A_signal / A_noise)^2, A_noise = mean
-                threshold = sqrt(fSNRThreshold) * mean;
-                KTDEBUG(sdlog, "Discriminator threshold for channel " << iComponent << " set at <" << threshold << "> (SNR mode)");
-            }
-            else if (fThresholdMode == eSNR_Power)
-            {
-                // SNR = P_signal / P_noise, P_noise = mean
-                threshold = fSNRThreshold * mean;
-                KTDEBUG(sdlog, "Discriminator threshold for channel " << iComponent << " set at <" << threshold << "> (SNR mode)");
-            }
-            else if (fThresholdMode == eSigma)
-            {
-                threshold = mean + fSigmaThreshold * sqrt(variance);
-                KTDEBUG(sdlog, "Discriminator threshold for channel " << iComponent << " set at <" << threshold << "> (Sigma mode; mean = " << mean << "; variance = " << variance << ")");
-            }
+            double threshold = CalculateThreshold(mean, variance, iComponent);
 
             // loop over bins, checking against the threshold
-#pragma omp parallel for private(value)
-            for (unsigned iBin=fMinBin; iBin<=fMaxBin; ++iBin)
-            {
-                double value = magnitude[iBin];
-                //if (value >= threshold) newData.AddPoint(iBin, KTDiscriminatedPoints1DData::Point(binWidth * ((double)iBin + 0.5), value, threshold), iComponent);
-                if (value >= threshold)
-                {
-                    double neighborhoodAmplitude = 0.;
-                    this->SumAdjacentBinAmplitude(spectrum, neighborhoodAmplitude, iBin);
-                    neighborhoodAmplitude = neighborhoodAmplitude - (2* fNeighborhoodRadius ) * mean;
-
-                    newData.AddPoint(iBin, KTDiscriminatedPoints1DData::Point(binWidth * ((double)iBin), value, threshold, mean, variance, neighborhoodAmplitude), iComponent);
-                }
-            }
+            CollectPoints(spectrum, magnitude.data(), threshold, mean, variance, binWidth, newData, iComponent);
             KTDEBUG(sdlog, "Component " << iComponent << " has " << newData.GetSetOfPoints(iComponent).size() << " points above threshold");
 
         }
@@ -296,6 +260,9 @@ namespace Katydid
         unsigned nBins = fMaxBin - fMinBin + 1;
         double norm = 1. / (double)nBins;
 
+        // Magnitudes of bins [fMinBin, fMaxBin]
+        vector< double > magnitude(nBins);
+
         for (unsigned iComponent=0; iComponent<nComponents; ++iComponent)
         {
             const KTFrequencySpectrumPolar* spectrum = data.GetSpectrumPolar(iComponent);
@@ -305,6 +272,12 @@ namespace Katydid
                 return false;
             }
 
+#pragma omp parallel for
+            for (unsigned iBin=fMinBin; iBin<=fMaxBin; ++iBin)
+            {
+                magnitude[iBin - fMinBin] = (*spectrum)(iBin).abs();
+            }
+
             double mean = 0., variance = 0.;
             if (! pcData.empty())
             {
@@ -313,54 +286,14 @@ namespace Katydid
             }
             else
             {
-                for (unsigned iBin=fMinBin; iBin<=fMaxBin; ++iBin)
-                {
-                    mean += (*spectrum)(iBin).abs();
-                    variance += (*spectrum)(iBin).abs() * (*spectrum)(iBin).abs();
-                }
-                mean *= norm;
-                variance = variance*norm - mean*mean;
+                CalculateMeanAndVariance(magnitude.data(), nBins, norm, mean, variance);
             }
 
-            double threshold = 0.;
-            if (fThresholdMode == eSNR_Amplitude)
-            {
-                // SNR = P_signal / P_noise = (A_signal / A_noise)^2, A_noise = mean
-                threshold = sqrt(fSNRThreshold) * mean;
-                KTDEBUG(sdlog, "Discriminator threshold for channel " << iComponent << " set at <" << threshold << "> (SNR mode)");
-            }
-            else if (fThresholdMode == eSNR_Power)
-            {
-                // SNR = P_signal / P_noise, P_noise = mean
-                threshold = fSNRThreshold * mean;
-                KTDEBUG(sdlog, "Discriminator threshold for channel " << iComponent << " set at <" << threshold << "> (SNR mode)");
-            }
-            else if (fThresholdMode == eSigma)
-            {
-                threshold = mean + fSigmaThreshold * sqrt(variance);
-                KTDEBUG(sdlog, "Discriminator threshold for channel " << iComponent << " set at <" << threshold << "> (Sigma mode; mean = " << mean << "; variance = " << variance << ")");
-            }
+            double threshold = CalculateThreshold(mean, variance, iComponent);
 
             // loop over bins, checking against the threshold
-
-            //std::stringstream printer;
-            for (unsigned iBin=fMinBin; iBin<=fMaxBin; ++iBin)
-            {
-                double value = (*spectrum)(iBin).abs();
-                if (value >= threshold)
-                {
-                    //printer << "   " << iBin << " -- " << value;
-                    //newData.AddPoint(iBin, KTDiscriminatedPoints1DData::Point(binWidth * ((double)iBin + 0.5), value, threshold), iComponent);
-                    double neighborhoodAmplitude = 0.;
-                    this->SumAdjacentBinAmplitude(spectrum, neighborhoodAmplitude, iBin);
-                    neighborhoodAmplitude = neighborhoodAmplitude - (2* fNeighborhoodRadius ) * mean;
-
-                    newData.AddPoint(iBin, KTDiscriminatedPoints1DData::Point(binWidth * ((double)iBin), value, threshold, mean, variance, neighborhoodAmplitude), iComponent);
-                }
-            }
-
+            CollectPoints(spectrum, magnitude.data(), threshold, mean, variance, binWidth, newData, iComponent);
             KTDEBUG(sdlog, "Component " << iComponent << " has " << newData.GetSetOfPoints(iComponent).size() << " points above threshold");
-            //KTDEBUG(sdlog, printer.str());
         }
         KTINFO(sdlog, "Completed discrimination on " << nComponents << " components");
 
@@ -399,6 +332,9 @@ namespace Katydid
                 return false;
             }
 
+            // the power values are used in place
+            const double* values = &(*spectrum)(fMinBin);
+
             double mean = 0., variance = 0.;
             if (! pcData.empty())
             {
@@ -407,56 +343,98 @@ namespace Katydid
             }
             else
             {
-#pragma omp parallel for reduction(+:mean)
-                for (unsigned iBin=fMinBin; iBin<=fMaxBin; ++iBin)
-                {
-                    mean += (*spectrum)(iBin);
-                    variance += (*spectrum)(iBin) * (*spectrum)(iBin);
-                }
-                mean *= norm;
-                variance = variance*norm - mean*mean;
+                CalculateMeanAndVariance(values, nBins, norm, mean, variance);
             }
 
-            double threshold = 0.;
-            if (fThresholdMode == eSNR_Amplitude)
-            {
-                // SNR = P_signal / P_noise = (A_signal / A_noise)^2, A_noise = mean
-                threshold = sqrt(fSNRThreshold) * mean;
-                KTDEBUG(sdlog, "Discriminator threshold for channel " << iComponent << " set at <" << threshold << "> (SNR mode)");
-            }
-            else if (fThresholdMode == eSNR_Power)
-            {
-                // SNR = P_signal / P_noise, P_noise = mean
-                threshold = fSNRThreshold * mean;
-                KTDEBUG(sdlog, "Discriminator threshold for channel " << iComponent << " set at <" << threshold << "> (SNR mode)");
-            }
-            else if (fThresholdMode == eSigma)
-            {
-                threshold = mean + fSigmaThreshold * sqrt(variance);
-                KTDEBUG(sdlog, "Discriminator threshold for channel " << iComponent << " set at <" << threshold << "> (Sigma mode; mean = " << mean << "; variance = " << variance << ")");
-            }
+            double threshold = CalculateThreshold(mean, variance, iComponent);
 
             // loop over bins, checking against the threshold
+            CollectPoints(spectrum, values, threshold, mean, variance, binWidth, newData, iComponent);
+            KTDEBUG(sdlog, "Component " << iComponent << " has " << newData.GetSetOfPoints(iComponent).size() << " points above threshold");
+
+        }
+        KTINFO(sdlog, "Completed discrimination on " << nComponents << " components");
+
+        return true;
+    }
+
+    void KTSpectrumDiscriminator::CalculateMeanAndVariance(const double* values, unsigned nValues, double norm, double& mean, double& variance) const
+    {
+        // one pass over the values; the sums are reduced across threads (and SIMD lanes), so the values can differ in the last bits from a serial sum
+        double sum = 0., sumSq = 0.;
+#pragma omp parallel for simd reduction(+:sum, sumSq)
+        for (unsigned iValue = 0; iValue < nValues; ++iValue)
+        {
+            sum += values[iValue];
+            sumSq += values[iValue] * values[iValue];
+        }
+        mean = sum * norm;
+        variance = sumSq * norm - mean * mean;
+        return;
+    }
 
-#pragma omp parallel for private(value)
+    double KTSpectrumDiscriminator::CalculateThreshold(double mean, double variance, unsigned component) const
+    {
+        double threshold = 0.;
+        if (fThresholdMode == eSNR_Amplitude)
+        {
+            // SNR = P_signal / P_noise = (A_signal / A_noise)^2, A_noise = mean
+            threshold = sqrt(fSNRThreshold) * mean;
+            KTDEBUG(sdlog, "Discriminator threshold for channel " << component << " set at <" << threshold << "> (SNR mode)");
+        }
+        else if (fThresholdMode == eSNR_Power)
+        {
+            // SNR = P_signal / P_noise, P_noise = mean
+            threshold = fSNRThreshold * mean;
+            KTDEBUG(sdlog, "Discriminator threshold for channel " << component << " set at <" << threshold << "> (SNR mode)");
+        }
+        else if (fThresholdMode == eSigma)
+        {
+            threshold = mean + fSigmaThreshold * sqrt(variance);
+            KTDEBUG(sdlog, "Discriminator threshold for channel " << component << " set at <" << threshold << "> (Sigma mode; mean = " << mean << "; variance = " << variance << ")");
+        }
+        return threshold;
+    }
+
+    template< class XSpectrumType >
+    void KTSpectrumDiscriminator::CollectPoints(const XSpectrumType* spectrum, const double* values, double threshold, double mean, double variance, double binWidth, KTDiscriminatedPoints1DData& newData, unsigned component)
+    {
+        // Each thread collects its points in its own buffer.
+        // With static scheduling each thread gets one contiguous block of bins, assigned in thread order,
+        // so adding the buffers in thread order adds the points in bin order.
+#ifdef USE_OPENMP
+        vector< KTDiscriminatedPoints1DData::PointBuffer > threadPoints(omp_get_max_threads());
+#else
+        vector< KTDiscriminatedPoints1DData::PointBuffer > threadPoints(1);
+#endif
+
+#pragma omp parallel
+        {
+#ifdef USE_OPENMP
+            KTDiscriminatedPoints1DData::PointBuffer& points = threadPoints[omp_get_thread_num()];
+#else
+            KTDiscriminatedPoints1DData::PointBuffer& points = threadPoints[0];
+#endif
+#pragma omp for schedule(static)
             for (unsigned iBin=fMinBin; iBin<=fMaxBin; ++iBin)
             {
-                double value = (*spectrum)(iBin);
+                double value = values[iBin - fMinBin];
                 if (value >= threshold)
                 {
                     double neighborhoodAmplitude = 0.;
                     this->SumAdjacentBinAmplitude(spectrum, neighborhoodAmplitude, iBin);
                     neighborhoodAmplitude = neighborhoodAmplitude - (2* fNeighborhoodRadius ) * mean;
 
-                    newData.AddPoint(iBin, KTDiscriminatedPoints1DData::Point(binWidth * ((double)iBin), value, threshold, mean, variance, neighborhoodAmplitude), iComponent);
+                    points.push_back(std::make_pair(iBin, KTDiscriminatedPoints1DData::Point(binWidth * ((double)iBin), value, threshold, mean, variance, neighborhoodAmplitude)));
                 }
             }
-            KTDEBUG(sdlog, "Component " << iComponent << " has " << newData.GetSetOfPoints(iComponent).size() << " points above threshold");
-
         }
-        KTINFO(sdlog, "Completed discrimination on " << nComponents << " components");
 
-        return true;
+        for (unsigned iThread = 0; iThread < threadPoints.size(); ++iThread)
+        {
+            newData.AddPoints(threadPoints[iThread], component);
+        }
+        return;
     }
 
     void KTSpectrumDiscriminator::SumAdjacentBinAmplitude(const KTPowerSpectrum* spectrum, double& neighborhoodAmplitude, const unsigned& iBin)
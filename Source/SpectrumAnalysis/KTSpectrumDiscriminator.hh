@@ -13,6 +13,8 @@
 
 #include "KTSlot.hh"
 
+#include <vector>
+
 
 namespace Katydid
 {
@@ -44,6 +46,10 @@ namespace Katydid
      The threshold can be specified as a power or amplitude SNR, or as a number of standard deviations (sigma).
 
      Abscissa values in the output are the bin centers of the frequency axis.
+
+     When built with OpenMP (Katydid_USE_OPENMP), the bins are checked in parallel; otherwise they're checked in a single thread.
+     Each thread collects its points in its own buffer, and the buffers are merged in bin order,
+     so the points are always stored in bin order regardless of the number of threads.
   
      Configuration name: "spectrum-discriminator"
 
@@ -128,6 +134,13 @@ namespace Katydid
             bool CoreDiscriminate(KTFrequencySpectrumDataFFTWCore& data, KTDiscriminatedPoints1DData& newData, std::vector< PerComponentInfo > pcData);
             bool CoreDiscriminate(KTPowerSpectrumDataCore& data, KTDiscriminatedPoints1DData& newData, std::vector< PerComponentInfo > pcData);
 
+            /// Calculates the mean and variance of the values in a single pass; norm is applied to the sums
+            void CalculateMeanAndVariance(const double* values, unsigned nValues, double norm, double& mean, double& variance) const;
+            double CalculateThreshold(double mean, double variance, unsigned component) const;
+            /// Checks the values of bins [fMinBin, fMaxBin] (values[0] is bin fMinBin) against the threshold, and adds the points above threshold to newData in bin order
+            template< class XSpectrumType >
+            void CollectPoints(const XSpectrumType* spectrum, const double* values, double threshold, double mean, double variance, double binWidth, KTDiscriminatedPoints1DData& newData, unsigned component);
+
             void SumAdjacentBinAmplitude(const KTPowerSpectrum* spectrum, double& neighborhoodAmplitude, const unsigned& iBin);
             void SumAdjacentBinAmplitude(const KTFrequencySpectrumFFTW* spectrum, double& neighborhoodAmplitude, const unsigned& iBin);
             void SumAdjacentBinAmplitude(const KTFrequencySpectrumPolar* spectrum, double& neighborhoodAmplitude, const unsigned& iBin);
@@ -16,10 +16,10 @@
 #include "KTFrequencySpectrumDataFFTW.hh"
 #include "KTFrequencySpectrumFFTW.hh"
 #include "KTGainVariationData.hh"
+#include "KTGainVariationTable.hh"
 #include "KTNormalizedFSData.hh"
 #include "KTPowerSpectrumData.hh"
 #include "KTSpectrumCollectionData.hh"
-#include "KTSpline.hh"
 #include "KTWignerVilleData.hh"
 
 #include <cmath>
@@ -53,6 +53,8 @@ namespace Katydid
             fCalculateMinBin(true),
             fCalculateMaxBin(true),
             fNormalize(false),
+            fTables(),
+            fTableSources(),
             fMagnitudeCache(),
             fDiscrim1DSignal("disc-1d", this),
             fDiscrim2DSignal("disc-2d", this),
@@ -129,7 +131,7 @@ namespace Katydid
         return true;
     }
 
-    bool KTVariableSpectrumDiscriminator::CheckGVData()
+    bool KTVariableSpectrumDiscriminator::CheckGVData() const
     {
         if( fGVData.GetSpline() == nullptr )
         {
@@ -271,7 +273,7 @@ namespace Katydid
             newDataSlice.SetNComponents( sliceNumber + 1 );
 
             // Discriminate the 1D spectrum
-            if (! DiscriminateSpectrum(*it, gvData.GetSpline(0), gvData.GetVarianceSpline(0), newDataSlice, sliceNumber))
+            if (! DiscriminateSpectrum(*it, gvData, newDataSlice, sliceNumber, 0))
             {
                 KTERROR(sdlog, "Discrimination on spectrogram (slice " << sliceNumber << ") failed");
                 return false;
@@ -312,7 +314,7 @@ namespace Katydid
 
         for (unsigned iComponent=0; iComponent<nComponents; ++iComponent)
         {
-            if (! DiscriminateSpectrum(data.GetSpectrumPolar(iComponent), gvData.GetSpline(iComponent), gvData.GetVarianceSpline(iComponent), newData, iComponent))
+            if (! DiscriminateSpectrum(data.GetSpectrumPolar(iComponent), gvData, newData, iComponent, iComponent))
             {
                 KTERROR(sdlog, "Discrimination on spectrum (component " << iComponent << ") failed");
                 return false;
@@ -346,7 +348,7 @@ namespace Katydid
 
         for (unsigned iComponent=0; iComponent<nComponents; ++iComponent)
         {
-            if (! DiscriminateSpectrum(data.GetSpectrumFFTW(iComponent), gvData.GetSpline(iComponent), gvData.GetVarianceSpline(iComponent), newData, iComponent))
+            if (! DiscriminateSpectrum(data.GetSpectrumFFTW(iComponent), gvData, newData, iComponent, iComponent))
             {
                 KTERROR(sdlog, "Discrimination on spectrum (component " << iComponent << ") failed");
                 return false;
@@ -378,7 +380,7 @@ namespace Katydid
 
         for (unsigned iComponent=0; iComponent<nComponents; ++iComponent)
         {
-            if (! DiscriminateSpectrum(data.GetSpectrum(iComponent), gvData.GetSpline(iComponent), gvData.GetVarianceSpline(iComponent), newData, iComponent))
+            if (! DiscriminateSpectrum(data.GetSpectrum(iComponent), gvData, newData, iComponent, iComponent))
             {
                 KTERROR(sdlog, "Discrimination on spectrum (component " << iComponent << ") failed");
                 return false;
@@ -390,7 +392,7 @@ namespace Katydid
         return true;
     }
 
-    bool KTVariableSpectrumDiscriminator::DiscriminateSpectrum(const KTFrequencySpectrumPolar* spectrum, const KTSpline* spline, const KTSpline* varSpline, KTDiscriminatedPoints1DData& newData, unsigned component)
+    bool KTVariableSpectrumDiscriminator::DiscriminateSpectrum(const KTFrequencySpectrumPolar* spectrum, const KTGainVariationData& gvData, KTDiscriminatedPoints1DData& newData, unsigned component, unsigned gvComponent)
     {
         if (spectrum == NULL)
         {
@@ -398,103 +400,25 @@ namespace Katydid
             return false;
         }
 
-        unsigned nBins = fMaxBin - fMinBin + 1;
-        double binWidth = spectrum->GetBinWidth();
-        double freqMin = spectrum->GetBinLowEdge(fMinBin);
-        double freqMax = spectrum->GetBinLowEdge(fMaxBin) + spectrum->GetBinWidth();
-        std::shared_ptr< KTSpline::Implementation > splineImp = spline->Implement(nBins, freqMin, freqMax);
-        std::shared_ptr< KTSpline::Implementation > varSplineImp = varSpline->Implement(nBins, freqMin, freqMax);
+        std::shared_ptr< const KTGainVariationTable > table = GetTable(spectrum, gvData, gvComponent);
+        if (! table) return false;
 
-        // Average of each spline
-        double normalizedValue = splineImp->GetMean();
-        double normalizedVariance = varSplineImp->GetMean();
+        unsigned nBins = fMaxBin - fMinBin + 1;
 
-        //************
-        // SNR mode
-        //************
-        if (fThresholdMode == eSNR_Amplitude || fThresholdMode == eSNR_Power)
+        // Magnitudes of bins [fMinBin, fMaxBin]
+        vector< double > magnitude(nBins);
+#pragma omp parallel for
+        for (unsigned iBin=fMinBin; iBin<=fMaxBin; ++iBin)
         {
-            double thresholdMult = 0.;
-            if (fThresholdMode == eSNR_Amplitude)
-            {
-                // SNR = P_signal / P_noise = (A_signal / A_noise)^2, A_noise = mean
-                thresholdMult = sqrt(fSNRThreshold);
-                KTDEBUG(sdlog, "Discriminator threshold multiplier for component " << component << " set at <" << thresholdMult << "> (SNR-amplitude mode)");
-            }
-            else
-            {
-                // SNR = P_signal / P_noise, P_noise = mean
-                thresholdMult = fSNRThreshold;
-                KTDEBUG(sdlog, "Discriminator threshold multiplier for component " << component << " set at <" << thresholdMult << "> (SNR-power mode)");
-            }
-
-            // loop over bins, checking against the threshold
-#pragma omp parallel for private(value)
-            for (unsigned iBin=fMinBin; iBin<=fMaxBin; ++iBin)
-            {
-                double value = (*spectrum)(iBin).abs();
-                double threshold = thresholdMult * (*splineImp)(iBin - fMinBin);
-                double mean = (*splineImp)(iBin - fMinBin);
-                double variance = (*varSplineImp)(iBin - fMinBin);
-                if (value >= threshold)
-                {
-                    double neighborhoodAmplitude = 0.;
-                    this->SumAdjacentBinAmplitude(spectrum, neighborhoodAmplitude, iBin);
-
-                    if( fNormalize )
-                    {
-                        value = normalizedValue + (value - mean) * sqrt( normalizedVariance / variance );
-                        neighborhoodAmplitude = normalizedValue + ( neighborhoodAmplitude - ( 2 * fNeighborhoodRadius+1 ) * mean ) * sqrt( normalizedVariance / variance );
-                        mean = normalizedValue;
-                        variance = normalizedVariance;
-                    }
-                    else
-                    {
-                        neighborhoodAmplitude = neighborhoodAmplitude - ( 2 * fNeighborhoodRadius ) * mean;
-                    }
-
-                    newData.AddPoint(iBin, KTDiscriminatedPoints1DData::Point(binWidth * ((double)iBin), value, threshold, mean, variance, neighborhoodAmplitude), component);
-                }
-            }
+            magnitude[iBin - fMinBin] = (*spectrum)(iBin).abs();
         }
-        //**************
-        // Sigma mode
-        //**************
-        else if (fThresholdMode == eSigma)
-        {
-#pragma omp parallel for private(value)
-            for (unsigned iBin=fMinBin; iBin<=fMaxBin; ++iBin)
-            {
-                double mean = (*splineImp)(iBin - fMinBin);
-                double variance = (*varSplineImp)(iBin - fMinBin);
-                double threshold = mean + fSigmaThreshold * sqrt( variance );
-                double value = (*spectrum)(iBin).abs();
-
-                if (value >= threshold)
-                {
-                    double neighborhoodAmplitude = 0.;
-                    this->SumAdjacentBinAmplitude(spectrum, neighborhoodAmplitude, iBin);
-                    if( fNormalize )
-                    {
-                        value = normalizedValue + (value - mean) * sqrt( normalizedVariance / variance );
-                        neighborhoodAmplitude = normalizedValue + ( neighborhoodAmplitude - ( 2 * fNeighborhoodRadius+1 ) * mean ) * sqrt( normalizedVariance / variance );
-                        mean = normalizedValue;
-                        variance = normalizedVariance;
-                    }
-                    else
-                    {
-                        neighborhoodAmplitude = neighborhoodAmplitude - ( 2 * fNeighborhoodRadius ) * mean;
-                    }
 
-                    newData.AddPoint(iBin, KTDiscriminatedPoints1DData::Point(binWidth * ((double)iBin), value, threshold, mean, variance, neighborhoodAmplitude), component);
-                }
-            }
-        }
+        CollectPoints(spectrum, magnitude.data(), *table, newData, component);
 
         return true;
     }
 
-    bool KTVariableSpectrumDiscriminator::DiscriminateSpectrum(const KTFrequencySpectrumFFTW* spectrum, const KTSpline* spline, const KTSpline* varSpline, KTDiscriminatedPoints1DData& newData, unsigned component)
+    bool KTVariableSpectrumDiscriminator::DiscriminateSpectrum(const KTFrequencySpectrumFFTW* spectrum, const KTGainVariationData& gvData, KTDiscriminatedPoints1DData& newData, unsigned component, unsigned gvComponent)
     {
         if (spectrum == NULL)
         {
@@ -502,102 +426,25 @@ namespace Katydid
             return false;
         }
 
-        unsigned nBins = fMaxBin - fMinBin + 1;
-        double binWidth = spectrum->GetBinWidth();
-        double freqMin = spectrum->GetBinLowEdge(fMinBin);
-        double freqMax = spectrum->GetBinLowEdge(fMaxBin) + binWidth;
-        std::shared_ptr< KTSpline::Implementation > splineImp = spline->Implement(nBins, freqMin, freqMax);
-        std::shared_ptr< KTSpline::Implementation > varSplineImp = varSpline->Implement(nBins, freqMin, freqMax);
+        std::shared_ptr< const KTGainVariationTable > table = GetTable(spectrum, gvData, gvComponent);
+        if (! table) return false;
 
-        // Average of each spline
-        double normalizedValue = splineImp->GetMean();
-        double normalizedVariance = varSplineImp->GetMean();
+        unsigned nBins = fMaxBin - fMinBin + 1;
 
-        //************
-        // SNR mode
-        //************
-        if (fThresholdMode == eSNR_Amplitude || fThresholdMode == eSNR_Power)
+        // Magnitudes of bins [fMinBin, fMaxBin]
+        vector< double > magnitude(nBins);
+#pragma omp parallel for
+        for (unsigned iBin=fMinBin; iBin<=fMaxBin; ++iBin)
         {
-            double thresholdMult = 0.;
-            if (fThresholdMode == eSNR_Amplitude)
-            {
-                // SNR = P_signal / P_noise = (A_signal / A_noise)^2, A_noise = mean
-                thresholdMult = sqrt(fSNRThreshold);
-                KTDEBUG(sdlog, "Discriminator threshold multiplier for component " << component << " set at <" << thresholdMult << "> (SNR-amplitude mode)");
-            }
-            else
-            {
-                // SNR = P_signal / P_noise, P_noise = mean
-                thresholdMult = fSNRThreshold;
-                KTDEBUG(sdlog, "Discriminator threshold multiplier for component " << component << " set at <" << thresholdMult << "> (SNR-power mode)");
-            }
-
-            // loop over bins, checking against the threshold
-#pragma omp parallel for private(value)
-            for (unsigned iBin=fMinBin; iBin<=fMaxBin; ++iBin)
-            {
-                double value = sqrt((*spectrum)(iBin)[0] * (*spectrum)(iBin)[0] + (*spectrum)(iBin)[1] * (*spectrum)(iBin)[1]);
-                double threshold = thresholdMult * (*splineImp)(iBin - fMinBin);
-                double mean = (*splineImp)(iBin - fMinBin);
-                double variance = (*varSplineImp)(iBin - fMinBin);
-
-                if (value >= threshold)
-                {
-                    double neighborhoodAmplitude = 0.;
-                    this->SumAdjacentBinAmplitude(spectrum, neighborhoodAmplitude, iBin);
-                    if( fNormalize )
-                    {
-                        value = normalizedValue + (value - mean) * sqrt( normalizedVariance / variance );
-                        neighborhoodAmplitude = normalizedValue + ( neighborhoodAmplitude - ( 2 * fNeighborhoodRadius+1 ) * mean ) * sqrt( normalizedVariance / variance );
-                        mean = normalizedValue;
-                        variance = normalizedVariance;
-                    }
-                    else
-                    {
-                        neighborhoodAmplitude = neighborhoodAmplitude - ( 2 * fNeighborhoodRadius ) * mean;
-                    }
-
-                    newData.AddPoint(iBin, KTDiscriminatedPoints1DData::Point(binWidth * ((double)iBin), value, threshold, mean, variance, neighborhoodAmplitude), component);
-                }
-            }
+            magnitude[iBin - fMinBin] = sqrt((*spectrum)(iBin)[0] * (*spectrum)(iBin)[0] + (*spectrum)(iBin)[1] * (*spectrum)(iBin)[1]);
         }
-        //**************
-        // Sigma mode
-        //**************
-        else if (fThresholdMode == eSigma)
-        {
-#pragma omp parallel for private(value)
-            for (unsigned iBin=fMinBin; iBin<=fMaxBin; ++iBin)
-            {
-                double mean = (*splineImp)(iBin - fMinBin);
-                double variance = (*varSplineImp)(iBin - fMinBin);
-                double threshold = mean + fSigmaThreshold * sqrt( variance );
-                double value = sqrt((*spectrum)(iBin)[0] * (*spectrum)(iBin)[0] + (*spectrum)(iBin)[1] * (*spectrum)(iBin)[1]);
-                if (value >= threshold)
-                {
-                    double neighborhoodAmplitude = 0.;
-                    this->SumAdjacentBinAmplitude(spectrum, neighborhoodAmplitude, iBin);
-                    if( fNormalize )
-                    {
-                        value = normalizedValue + (value - mean) * sqrt( normalizedVariance / variance );
-                        neighborhoodAmplitude = normalizedValue + ( neighborhoodAmplitude - ( 2 * fNeighborhoodRadius+1 ) * mean ) * sqrt( normalizedVariance / variance );
-                        mean = normalizedValue;
-                        variance = normalizedVariance;
-                    }
-                    else
-                    {
-                        neighborhoodAmplitude = neighborhoodAmplitude - ( 2 * fNeighborhoodRadius ) * mean;
-                    }
 
-                    newData.AddPoint(iBin, KTDiscriminatedPoints1DData::Point(binWidth * ((double)iBin), value, threshold, mean, variance, neighborhoodAmplitude), component);
-                }
-            }
-        }
+        CollectPoints(spectrum, magnitude.data(), *table, newData, component);
 
         return true;
     }
 
-    bool KTVariableSpectrumDiscriminator::DiscriminateSpectrum(const KTPowerSpectrum* spectrum, const KTSpline* spline, const KTSpline* varSpline, KTDiscriminatedPoints1DData& newData, unsigned component)
+    bool KTVariableSpectrumDiscriminator::DiscriminateSpectrum(const KTPowerSpectrum* spectrum, const KTGainVariationData& gvData, KTDiscriminatedPoints1DData& newData, unsigned component, unsigned gvComponent)
     {
         if (spectrum == NULL)
         {
@@ -605,85 +452,121 @@ namespace Katydid
             return false;
         }
 
+        std::shared_ptr< const KTGainVariationTable > table = GetTable(spectrum, gvData, gvComponent);
+        if (! table) return false;
+
+        // the power values are used in place
+        CollectPoints(spectrum, &(*spectrum)(fMinBin), *table, newData, component);
+
+        return true;
+    }
+
+    template< class XSpectrumType >
+    std::shared_ptr< const KTGainVariationTable > KTVariableSpectrumDiscriminator::GetTable(const XSpectrumType* spectrum, const KTGainVariationData& gvData, unsigned gvComponent)
+    {
+        if (gvComponent >= gvData.GetNComponents())
+        {
+            KTERROR(sdlog, "There is no gain variation for component " << gvComponent);
+            return std::shared_ptr< const KTGainVariationTable >();
+        }
+
         unsigned nBins = fMaxBin - fMinBin + 1;
-        double binWidth = spectrum->GetBinWidth();
         double freqMin = spectrum->GetBinLowEdge(fMinBin);
         double freqMax = spectrum->GetBinLowEdge(fMaxBin) + spectrum->GetBinWidth();
-        std::shared_ptr< KTSpline::Implementation > splineImp = spline->Implement(nBins, freqMin, freqMax);
-        std::shared_ptr< KTSpline::Implementation > varSplineImp = varSpline->Implement(nBins, freqMin, freqMax);
-
-        // Average of each spline
-        double normalizedValue = splineImp->GetMean();
-        double normalizedVariance = varSplineImp->GetMean();
-
-        //************
-        // SNR mode
-        //************
-        if (fThresholdMode == eSNR_Amplitude || fThresholdMode == eSNR_Power)
+        std::shared_ptr< const KTGainVariationTable > table = gvData.GetTable(gvComponent);
+        if (! table || ! table->Matches(nBins, freqMin, freqMax))
         {
-            double thresholdMult = 0.;
-            if (fThresholdMode == eSNR_Amplitude)
+            // Use this processor's own table for the range.  It's kept as long as the data's table is the same one, since the data
+            // builds a new table whenever its splines change; without a data table there's no way to tell, so it's rebuilt each time.
+            if (gvComponent >= fTables.size())
             {
-                // SNR = P_signal / P_noise = (A_signal / A_noise)^2, A_noise = mean
-                thresholdMult = sqrt(fSNRThreshold);
-                KTDEBUG(sdlog, "Discriminator threshold multiplier for component " << component << " set at <" << thresholdMult << "> (SNR-amplitude mode)");
+                fTables.resize(gvComponent + 1);
+                fTableSources.resize(gvComponent + 1);
             }
-            else
+            if (! table || table != fTableSources[gvComponent] || ! fTables[gvComponent] || ! fTables[gvComponent]->Matches(nBins, freqMin, freqMax))
             {
-                // SNR = P_signal / P_noise, P_noise = mean
-                thresholdMult = fSNRThreshold;
-                KTDEBUG(sdlog, "Discriminator threshold multiplier for component " << component << " set at <" << thresholdMult << "> (SNR-power mode)");
+                const KTSpline* spline = gvData.GetSpline(gvComponent);
+                fTables[gvComponent].reset();
+                if (spline != NULL) fTables[gvComponent] = std::make_shared< const KTGainVariationTable >(spline, gvData.GetVarianceSpline(gvComponent), nBins, freqMin, freqMax);
+                fTableSources[gvComponent] = table;
             }
+            table = fTables[gvComponent];
+        }
+        if (! table)
+        {
+            KTERROR(sdlog, "Gain variation spline (component " << gvComponent << ") is missing");
+        }
+        else if ((fThresholdMode == eSigma || fNormalize) && ! table->HasVariance())
+        {
+            KTERROR(sdlog, "Gain variation variance spline (component " << gvComponent << ") is missing; it's required for sigma thresholds and normalization");
+            table.reset();
+        }
+        return table;
+    }
 
-            // loop over bins, checking against the threshold
-#pragma omp parallel for private(value)
-            for (unsigned iBin=fMinBin; iBin<=fMaxBin; ++iBin)
-            {
-                double value = (*spectrum)(iBin);
-                double mean = (*splineImp)(iBin - fMinBin);
-                double threshold = thresholdMult * mean;
-                double variance = (*varSplineImp)(iBin - fMinBin);
-                if (value >= threshold)
-                {
-                    double neighborhoodAmplitude = 0.;
-                    this->SumAdjacentBinAmplitude(spectrum, neighborhoodAmplitude, iBin);
-                    if( fNormalize )
-                    {
-                        value = normalizedValue + (value - mean) * sqrt( normalizedVariance / variance );
-                        neighborhoodAmplitude = normalizedValue + ( neighborhoodAmplitude - ( 2 * fNeighborhoodRadius+1 ) * mean ) * sqrt( normalizedVariance / variance );
-                        mean = normalizedValue;
-                        variance = normalizedVariance;
-                    }
-                    else
-                    {
-                        neighborhoodAmplitude = neighborhoodAmplitude - ( 2 * fNeighborhoodRadius ) * mean;
-                    }
+    template< class XSpectrumType >
+    void KTVariableSpectrumDiscriminator::CollectPoints(const XSpectrumType* spectrum, const double* values, const KTGainVariationTable& table, KTDiscriminatedPoints1DData& newData, unsigned component)
+    {
+        // Average of each spline
+        double normalizedValue = table.GetNormalizedMean();
+        double normalizedVariance = table.GetNormalizedVariance();
 
-                    newData.AddPoint(iBin, KTDiscriminatedPoints1DData::Point(binWidth * ((double)iBin), value, threshold, mean, variance, neighborhoodAmplitude), component);
-                }
-            }
+        // Per-bin background; element 0 is bin fMinBin
+        const double* means = table.GetMean();
+        const double* variances = table.GetVariance();
+        const double* sigmas = table.GetSigma();
+        const double* normScales = table.GetNormScale();
+        bool hasVariance = table.HasVariance();
+
+        bool snrMode = fThresholdMode == eSNR_Amplitude || fThresholdMode == eSNR_Power;
+        double thresholdMult = 0.;
+        if (fThresholdMode == eSNR_Amplitude)
+        {
+            // SNR = P_signal / P_noise = (A_signal / A_noise)^2, A_noise = mean
+            thresholdMult = sqrt(fSNRThreshold);
+            KTDEBUG(sdlog, "Discriminator threshold multiplier for component " << component << " set at <" << thresholdMult << "> (SNR-amplitude mode)");
         }
+        else if (fThresholdMode == eSNR_Power)
+        {
+            // SNR = P_signal / P_noise, P_noise = mean
+            thresholdMult = fSNRThreshold;
+            KTDEBUG(sdlog, "Discriminator threshold multiplier for component " << component << " set at <" << thresholdMult << "> (SNR-power mode)");
+        }
+
+        // Each thread collects its points in its own buffer.
+        // With static scheduling each thread gets one contiguous block of bins, assigned in thread order,
+        // so adding the buffers in thread order adds the points in bin order.
+#ifdef USE_OPENMP
+        vector< KTDiscriminatedPoints1DData::PointBuffer > threadPoints(omp_get_max_threads());
+#else
+        vector< KTDiscriminatedPoints1DData::PointBuffer > threadPoints(1);
+#endif
+        double binWidth = spectrum->GetBinWidth();
 
-        //**************
-        // Sigma mode
-        //**************
-        else if (fThresholdMode == eSigma)
+#pragma omp parallel
         {
-#pragma omp parallel for private(value)
+#ifdef USE_OPENMP
+            KTDiscriminatedPoints1DData::PointBuffer& points = threadPoints[omp_get_thread_num()];
+#else
+            KTDiscriminatedPoints1DData::PointBuffer& points = threadPoints[0];
+#endif
+#pragma omp for schedule(static)
             for (unsigned iBin=fMinBin; iBin<=fMaxBin; ++iBin)
             {
-                double mean = (*splineImp)(iBin - fMinBin);
-                double variance = (*varSplineImp)(iBin - fMinBin);
-                double threshold = mean + fSigmaThreshold * sqrt( variance );
-                double value = (*spectrum)(iBin);
+                unsigned iTableBin = iBin - fMinBin;
+                double value = values[iTableBin];
+                double mean = means[iTableBin];
+                double threshold = snrMode ? thresholdMult * mean : mean + fSigmaThreshold * sigmas[iTableBin];
+
                 if (value >= threshold)
                 {
+                    double variance = hasVariance ? variances[iTableBin] : 0.;
                     double neighborhoodAmplitude = 0.;
                     this->SumAdjacentBinAmplitude(spectrum, neighborhoodAmplitude, iBin);
                     if( fNormalize )
                     {
-                        value = normalizedValue + (value - mean) * sqrt( normalizedVariance / variance );
-                        neighborhoodAmplitude = normalizedValue + ( neighborhoodAmplitude - ( 2 * fNeighborhoodRadius+1 ) * mean ) * sqrt( normalizedVariance / variance );
+                        value = normalizedValue + (value - mean) * normScales[iTableBin];
+                        neighborhoodAmplitude = normalizedValue + ( neighborhoodAmplitude - ( 2 * fNeighborhoodRadius+1 ) * mean ) * normScales[iTableBin];
                         mean = normalizedValue;
                         variance = normalizedVariance;
                     }
@@ -692,13 +575,16 @@ namespace Katydid
                         neighborhoodAmplitude = neighborhoodAmplitude - ( 2 * fNeighborhoodRadius ) * mean;
                     }
 
-                    newData.AddPoint(iBin, KTDiscriminatedPoints1DData::Point(binWidth * ((double)iBin), value, threshold, mean, variance, neighborhoodAmplitude), component);
+                    points.push_back(std::make_pair(iBin, KTDiscriminatedPoints1DData::Point(binWidth * ((double)iBin), value, threshold, mean, variance, neighborhoodAmplitude)));
                 }
             }
         }
 
-        return true;
-
+        for (unsigned iThread = 0; iThread < threadPoints.size(); ++iThread)
+        {
+            newData.AddPoints(threadPoints[iThread], component);
+        }
+        return;
     }
 
     void KTVariableSpectrumDiscriminator::SumAdjacentBinAmplitude(const KTPowerSpectrum* spectrum, double& neighborhoodAmplitude, const unsigned& iBin)
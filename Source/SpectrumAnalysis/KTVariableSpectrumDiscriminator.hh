@@ -14,6 +14,7 @@
 
 #include "KTSlot.hh"
 
+#include <memory>
 #include <vector>
 
 
@@ -38,7 +39,6 @@ namespace Katydid
     class KTPowerSpectrumData;
     class KTPowerSpectrumDataCore;
     class KTPSCollectionData;
-    class KTSpline;
     class KTWignerVilleData;
 
 
@@ -50,6 +50,8 @@ namespace Katydid
 
      @details
      The threshold used for a given bin is calculated based on the input gain variation data.
+     The splines are evaluated once per bin range: the table of the gain variation data is used if it covers the range
+     (see KTGainVariationData::SetTableBinning()), and otherwise the processor builds and keeps its own, so the per-spectrum work is only the comparison.
      This processor can be used in two modes (simultaneously, if desired):
      1. Input data contains both the values to be thresholded, plus the gain variation data to use to form the threshold;
      2. Gain variation data is received ahead of time and applied to all input data.
@@ -57,6 +59,9 @@ namespace Katydid
      For (2), set the gain variation data with SetPreCalcGainVar (slot "gv"), and the Discriminate functions with one argument (slots with "-pre").
 
      Abscissa values in the output data are the bin centers on the frequency axis.
+
+     When built with OpenMP, the bins are checked in parallel; each thread collects its points in its own buffer,
+     and the buffers are merged in bin order.
   
      Configuration name: "variable-spectrum-discriminator"
 
@@ -136,7 +141,7 @@ namespace Katydid
             MEMBERVARIABLE(int, NeighborhoodRadius);
 
         public:
-            bool CheckGVData();
+            bool CheckGVData() const;
             bool SetPreCalcGainVar(KTGainVariationData& gvData);
 
             bool Discriminate(KTConvolvedPowerSpectrumData& data);
@@ -153,15 +158,28 @@ namespace Katydid
             bool Discriminate(KTPowerSpectrumData& data, KTGainVariationData& gvData);
             bool Discriminate(KTPSCollectionData& data, KTGainVariationData& gvData);
 
-            bool DiscriminateSpectrum(const KTFrequencySpectrumPolar* spectrum, const KTSpline* spline, const KTSpline* varSpline, KTDiscriminatedPoints1DData& newData, unsigned component=0);
-            bool DiscriminateSpectrum(const KTFrequencySpectrumFFTW* spectrum, const KTSpline* spline, const KTSpline* varSpline, KTDiscriminatedPoints1DData& newData, unsigned component=0);
-            bool DiscriminateSpectrum(const KTPowerSpectrum* spectrum, const KTSpline* spline, const KTSpline* varSpline, KTDiscriminatedPoints1DData& newData, unsigned component=0);
+            bool DiscriminateSpectrum(const KTFrequencySpectrumPolar* spectrum, const KTGainVariationData& gvData, KTDiscriminatedPoints1DData& newData, unsigned component=0, unsigned gvComponent=0);
+            bool DiscriminateSpectrum(const KTFrequencySpectrumFFTW* spectrum, const KTGainVariationData& gvData, KTDiscriminatedPoints1DData& newData, unsigned component=0, unsigned gvComponent=0);
+            bool DiscriminateSpectrum(const KTPowerSpectrum* spectrum, const KTGainVariationData& gvData, KTDiscriminatedPoints1DData& newData, unsigned component=0, unsigned gvComponent=0);
 
         private:
             bool CoreDiscriminate(KTFrequencySpectrumDataPolarCore& data, KTGainVariationData& gvData, KTDiscriminatedPoints1DData& newData);
             bool CoreDiscriminate(KTFrequencySpectrumDataFFTWCore& data, KTGainVariationData& gvData, KTDiscriminatedPoints1DData& newData);
             bool CoreDiscriminate(KTPowerSpectrumDataCore& data, KTGainVariationData& gvData, KTDiscriminatedPoints1DData& newData);
 
+            /// Returns the gain-variation table for bins [fMinBin, fMaxBin] of the spectrum; returns an empty pointer if the splines needed for the threshold mode are missing
+            template< class XSpectrumType >
+            std::shared_ptr< const KTGainVariationTable > GetTable(const XSpectrumType* spectrum, const KTGainVariationData& gvData, unsigned gvComponent);
+
+            /// Tables for bin ranges that the gain variation data has no table for, one per gain-variation component,
+            /// and the data's table at the time each was built (a new data table means that the splines may have changed)
+            std::vector< std::shared_ptr< const KTGainVariationTable > > fTables;
+            std::vector< std::shared_ptr< const KTGainVariationTable > > fTableSources;
+
+            /// Checks the values of bins [fMinBin, fMaxBin] (values[0] is bin fMinBin) against the thresholds from the gain-variation table, and adds the points above threshold to newData in bin order
+            template< class XSpectrumType >
+            void CollectPoints(const XSpectrumType* spectrum, const double* values, const KTGainVariationTable& table, KTDiscriminatedPoints1DData& newData, unsigned component);
+
             void SumAdjacentBinAmplitude(const KTPowerSpectrum* spectrum, double& neighborhoodAmplitude, const unsigned& iBin);
             void SumAdjacentBinAmplitude(const KTFrequencySpectrumFFTW* spectrum, double& neighborhoodAmplitude, const unsigned& iBin);
             void SumAdjacentBinAmplitude(const KTFrequencySpectrumPolar* spectrum, double& neighborhoodAmplitude, const unsigned& iBin);
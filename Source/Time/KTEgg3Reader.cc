@@ -22,6 +22,8 @@
 
 #include "scarab_version.hh"
 
+#include <chrono>
+
 using namespace monarch3;
 
 using std::map;
@@ -40,6 +42,8 @@ namespace Katydid
             fStride(0),
             fStartTime(0.),
             fStartRecord(0),
+            fPrefetchRecords(0),
+            fZeroCopySlices(false),
             //fHatchNextSlicePtr(NULL),
             fFilenames(),
             fCurrentFileIt(),
@@ -50,6 +54,21 @@ namespace Katydid
             fHeader(fHeaderPtr->Of< KTEggHeader >()),
             fMasterSliceHeader(),
             fReadState(),
+            fRecord(),
+            fPrefetchQueue(),
+            fRecycledRecords(),
+            fPrefetchThread(),
+            fRecordHistory(),
+            fHistoryPos(-1),
+            fMaxHistory(2),
+            fUseRecordHistory(false),
+            fPrefetchFailed(false),
+            fPrefetchInNextFile(false),
+            fNPrefetchPops(0),
+            fSummedQueueDepth(0),
+            fReadStallTime(0.),
+            fNRecordCacheHits(0),
+            fNRecordCacheMisses(0),
             fGetTimeInRun(&KTEgg3Reader::GetTimeInRunFromMonarch),
             fT0Offset(0),
             fAcqTimeInRun(0),
@@ -68,6 +87,7 @@ namespace Katydid
 
     KTEgg3Reader::~KTEgg3Reader()
     {
+        StopPrefetching();
         if (fMonarch != NULL)
         {
             delete fMonarch;
@@ -80,6 +100,8 @@ namespace Katydid
         SetStride(eggProc.GetStride());
         SetStartTime(eggProc.GetStartTime());
         SetStartRecord(eggProc.GetStartRecord());
+        SetPrefetchRecords(eggProc.GetPrefetchRecords());
+        SetZeroCopySlices(eggProc.GetZeroCopySlices());
         return true;
     }
 
@@ -87,6 +109,8 @@ namespace Katydid
     {
         if (fStride == 0) fStride = fSliceSize;
 
+        StopPrefetching();
+
         if (fMonarch != NULL)
         {
             delete fMonarch;
@@ -209,6 +233,22 @@ namespace Katydid
 
         fSliceNumber = 0;
 
+        // the next slice can reach back over the records that overlap with the last one (with some margin for the start offset in the record)
+        unsigned overlap = fStride < fSliceSize ? fSliceSize - fStride : 0;
+        fMaxHistory = overlap / fRecordSize + 2;
+        // without prefetching, the records are only held if overlapping slices will step back to them
+        fUseRecordHistory = fPrefetchRecords != 0 || overlap != 0;
+        fRecycledRecords.reset(new KTConcurrentQueue< PrefetchedRecordPtr >());
+        fNPrefetchPops = 0;
+        fSummedQueueDepth = 0;
+        fReadStallTime = 0.;
+        fNRecordCacheHits = 0;
+        fNRecordCacheMisses = 0;
+        if (fUseRecordHistory)
+        {
+            KTDEBUG(eggreadlog, "Holding up to " << fMaxHistory + 1 << " records for overlapping slices");
+        }
+
         // set a few values in the master slice header that don't change with each slice
         fMasterSliceHeader.SetSampleRate(fHeader.GetAcquisitionRate());
         fMasterSliceHeader.SetRawSliceSize(fSliceSize);
@@ -223,7 +263,8 @@ namespace Katydid
 
     inline Nymph::KTDataPtr KTEgg3Reader::HatchNextSlice()
     {
-        if (fMonarch == NULL)
+        // once prefetching has started, the file belongs to the prefetch thread
+        if (! fPrefetchThread.joinable() && fMonarch == NULL)
         {
             KTERROR(eggreadlog, "Monarch file has not been opened");
             return Nymph::KTDataPtr();
@@ -234,12 +275,6 @@ namespace Katydid
             return Nymph::KTDataPtr();
         }
 
-        // Get the number of channels, record size and the number of bytes per sample from the stream
-        unsigned nChannels = fM3Stream->GetNChannels();
-        unsigned recordSize = fM3Stream->GetChannelRecordSize();
-        unsigned sampleSize = fM3Stream->GetSampleSize();
-        unsigned nBytesInSample = fM3Stream->GetDataTypeSize() * sampleSize;
-
         // the read position in the current record (initialize to 0 for now; will be set correctly below)
         unsigned readPos = 0;
 
@@ -266,7 +301,7 @@ namespace Katydid
 
                 // if we're at the beginning of the run, load the first record
                 // second argument specifies that monarch should not go to the first record if it's a new acquisition
-                if (! fM3Stream->ReadRecord(startingRecordShift, false))
+                if (! ReadRecord(startingRecordShift, false))
                 {
                     KTERROR(eggreadlog, "There's nothing in the file or the requested start is beyond the end of the (first) file");
                     return Nymph::KTDataPtr();
@@ -274,12 +309,12 @@ namespace Katydid
                 ++fRecordsProcessed;
 
                 // set the time offset for the run based on the first channel
-                fT0Offset = fM3Stream->GetAcqFirstRecordTime();
+                fT0Offset = fRecord.fAcqFirstRecordTime;
                 KTDEBUG(eggreadlog, "Time offset of the first slice: " << fT0Offset << " ns");
 
                 // set fStartOFLastSliceRecord properly, considering that the first record in the file might not be record 0
                 // this has to be done after the first record is read, because Monarch only knows what the first record number is after accessing the records
-                fReadState.fStartOfLastSliceRecord += fM3Stream->GetFirstRecordInFile();
+                fReadState.fStartOfLastSliceRecord += fRecord.fFirstRecordInFile;
                 KTDEBUG(eggreadlog, "File starts with record " << fReadState.fStartOfLastSliceRecord);
 
                 // the current record is the one we just loaded
@@ -288,7 +323,7 @@ namespace Katydid
                 // at this point, fReadState.fStartOfLastSliceRecord and fReadState.fStartOfLastSliceReadPtr are where they need to be
                 // for the slice that will follow this one.
                 // but we need to set fReadState.fStartOfSliceAcquisitionId
-                fReadState.fStartOfSliceAcquisitionId = fM3Stream->GetAcquisitionId();
+                fReadState.fStartOfSliceAcquisitionId = fRecord.fAcquisitionId;
 
                 fAcqTimeInRun = GetTimeInRun();
 
@@ -307,9 +342,9 @@ namespace Katydid
                 readPos = fReadState.fStartOfLastSliceReadPtr + fStride;
 
                 // check whether we have to advance to a new record
-                while (readPos >= recordSize)
+                while (readPos >= fRecord.fRecordSize)
                 {
-                    readPos -= recordSize;
+                    readPos -= fRecord.fRecordSize;
                     ++recordShift;
                 }
                 KTDEBUG(eggreadlog, "Preparing to read next slice; Record shift: " << recordShift << "; Read position (in record): " << readPos);
@@ -319,7 +354,7 @@ namespace Katydid
                 if( recordShift != 0 )
                 {
                     bool inNewFile = false; // use this in addition to checking for an acquisition ID change below since the ID won't change if the entire file just finished has one acquisition
-                    if (! fM3Stream->ReadRecord(recordShift - 1))  // 1 is subtracted since ReadRecord(0) goes to the next record
+                    if (! ReadRecord(recordShift - 1))  // 1 is subtracted since ReadRecord(0) goes to the next record
                     {
                         // we've reached the end of the file
                         if (! LoadNextFile())
@@ -327,7 +362,7 @@ namespace Katydid
                             KTINFO(eggreadlog, "End of egg file reached after reading new records");
                             return Nymph::KTDataPtr();
                         }
-                        if (! fM3Stream->ReadRecord())
+                        if (! ReadRecord())
                         {
                             KTERROR(eggreadlog, "There's nothing in the file or the requested start is beyond the end of the file");
                             return Nymph::KTDataPtr();
@@ -337,11 +372,11 @@ namespace Katydid
                     ++fRecordsProcessed;
 
                     // set the current record according to what's now loaded
-                    fReadState.fCurrentRecord = fM3Stream->GetAcqFirstRecordId() + fM3Stream->GetRecordCountInAcq();
+                    fReadState.fCurrentRecord = fRecord.fAcqFirstRecordId + fRecord.fRecordCountInAcq;
                     // check if we're in a new acquisition
-                    if (fReadState.fStartOfSliceAcquisitionId != fM3Stream->GetAcquisitionId() || inNewFile)
+                    if (fReadState.fStartOfSliceAcquisitionId != fRecord.fAcquisitionId || inNewFile)
                     {
-                        KTDEBUG(eggreadlog, "Starting slice in a new acquisition: " << fM3Stream->GetAcquisitionId() << "; is a new file? " << inNewFile << "; Starting at record << " << fReadState.fCurrentRecord);
+                        KTDEBUG(eggreadlog, "Starting slice in a new acquisition: " << fRecord.fAcquisitionId << "; is a new file? " << inNewFile << "; Starting at record << " << fReadState.fCurrentRecord);
                         isNewAcquisition = true;
                         // then we need to start reading at the start of this record
                         readPos = 0;
@@ -356,11 +391,17 @@ namespace Katydid
                 fReadState.fStartOfLastSliceRecord = fReadState.fCurrentRecord;
                 fReadState.fStartOfLastSliceReadPtr = readPos;
                 // also set fStartOfSliceAcquisitionId
-                fReadState.fStartOfSliceAcquisitionId = fM3Stream->GetAcquisitionId();
+                fReadState.fStartOfSliceAcquisitionId = fRecord.fAcquisitionId;
 
                 ++fSliceNumber;
             }
 
+            // Get the number of channels, record size and the number of bytes per sample from the record
+            unsigned nChannels = fRecord.fNChannels;
+            unsigned recordSize = fRecord.fRecordSize;
+            unsigned sampleSize = fRecord.fSampleSize;
+            unsigned nBytesInSample = fRecord.fDataTypeSize * sampleSize;
+
             // at this point, the stream is ready for data to be copied from it, and fReadState is up-to-date
 
             // create the new data object
@@ -376,20 +417,36 @@ namespace Katydid
             sliceHeader.SetStartRecordNumber(fReadState.fCurrentRecord);
             sliceHeader.SetStartSampleNumber(readPos);
 
-            // create the raw time series objects that will contain the new copies of slices
+            // if the slice lies entirely within the current record, and that record is held by the reader (i.e. it's in the record history),
+            // the slices can be views of the record instead of copies; the views keep the record alive until they're deleted
+            bool sliceIsView = fZeroCopySlices && fHistoryPos >= 0 && readPos + fSliceSize <= recordSize;
+
+            // create the raw time series objects that will contain the new copies of slices (or views of the record)
             // and set some channel-specific slice header info
             vector< KTRawTimeSeries* > newSlices(nChannels);
             for (unsigned iChan = 0; iChan < nChannels; ++iChan)
             {
                 // nBins = fSliceSize * sampleSize to allow for real and complex samples
-                newSlices[iChan] = new KTRawTimeSeries(fM3Stream->GetDataTypeSize(),
-                        ConvertMonarch3DataFormat(fM3StreamHeader->GetDataFormat()),
-                        fSliceSize * sampleSize, 0., double(fSliceSize) * sliceHeader.GetBinWidth());
+                if (sliceIsView)
+                {
+                    const PrefetchedRecordPtr& record = fRecordHistory[fHistoryPos];
+                    newSlices[iChan] = new KTRawTimeSeries(record,
+                            record->fChannelData[iChan].data() + readPos * nBytesInSample,
+                            fRecord.fDataTypeSize, ConvertMonarch3DataFormat(fRecord.fDataFormat),
+                            fSliceSize * sampleSize, 0., double(fSliceSize) * sliceHeader.GetBinWidth());
+                }
+                else
+                {
+                    // every sample of the slice is copied below, so a recycled time series can be used
+                    newSlices[iChan] = KTRawTimeSeries::Acquire(fRecord.fDataTypeSize,
+                            ConvertMonarch3DataFormat(fRecord.fDataFormat),
+                            fSliceSize * sampleSize, 0., double(fSliceSize) * sliceHeader.GetBinWidth());
+                }
                 newSlices[iChan]->SetSampleSize(sampleSize);
 
-                sliceHeader.SetAcquisitionID(fM3Stream->GetAcquisitionId(), iChan);
-                sliceHeader.SetRecordID(fM3Stream->GetChannelRecord( iChan )->GetRecordId(), iChan);
-                sliceHeader.SetTimeStamp(fM3Stream->GetChannelRecord( iChan )->GetTime(), iChan);
+                sliceHeader.SetAcquisitionID(fRecord.fAcquisitionId, iChan);
+                sliceHeader.SetRecordID(fRecord.fRecordIds[iChan], iChan);
+                sliceHeader.SetTimeStamp(fRecord.fTimeStamps[iChan], iChan);
                 sliceHeader.SetRawDataFormatType(fHeader.GetChannelHeader( iChan )->GetDataFormat(), iChan);
             }
 
@@ -433,12 +490,15 @@ namespace Katydid
                 unsigned readPosBytes = readPos * nBytesInSample;
 
                 // copy the samples from this record for each channel
-                KTDEBUG(eggreadlog, "Copying data to slice; " << bytesToCopy << " bytes in " << samplesToCopyFromThisRecord << " samples");
-                for( unsigned iChan = 0; iChan < nChannels; ++iChan )
+                if( ! sliceIsView )
                 {
-                    memcpy( newSlices[iChan]->GetStorage() + writePosBytes,
-                            fM3Stream->GetChannelRecord( iChan )->GetData() + readPosBytes,
-                            bytesToCopy );
+                    KTDEBUG(eggreadlog, "Copying data to slice; " << bytesToCopy << " bytes in " << samplesToCopyFromThisRecord << " samples");
+                    for( unsigned iChan = 0; iChan < nChannels; ++iChan )
+                    {
+                        memcpy( newSlices[iChan]->GetStorage() + writePosBytes,
+                                fRecord.fData[iChan] + readPosBytes,
+                                bytesToCopy );
+                    }
                 }
 
                 //*** DEBUG ***//
@@ -457,22 +517,23 @@ namespace Katydid
                 */
                 //*** DEBUG ***//
 
-                // update samplesRemainingToCopy
+                // update samplesRemainingToCopy and the write position
                 samplesRemainingToCopy -= samplesToCopyFromThisRecord;
+                writePos += samplesToCopyFromThisRecord;
 
                 // check if there's still more to do
                 if( samplesRemainingToCopy > 0 )
                 {
                     bool inNewFile = false; // use this in addition to checking for an acquisition ID change below since the ID won't change if the entire file just finished has one acquisition
                     // move to the next record
-                    if (! fM3Stream->ReadRecord())
+                    if (! ReadRecord())
                     {
                         if (! LoadNextFile())
                         {
                             KTINFO(eggreadlog, "End of file reached in the middle of reading out a slice");
                             return Nymph::KTDataPtr();
                         }
-                        if (! fM3Stream->ReadRecord())
+                        if (! ReadRecord())
                         {
                             KTERROR(eggreadlog, "There's nothing in the file or the requested start is beyond the end of the file");
                             return Nymph::KTDataPtr();
@@ -480,12 +541,12 @@ namespace Katydid
                         inNewFile = true;
                     }
                     ++fRecordsProcessed;
-                    fReadState.fCurrentRecord = fM3Stream->GetAcqFirstRecordId() + fM3Stream->GetRecordCountInAcq();
+                    fReadState.fCurrentRecord = fRecord.fAcqFirstRecordId + fRecord.fRecordCountInAcq;
 
                     readPos = 0; // reset the read position, which is now at the beginning of the new record
 
                     // check if we've moved to a new acquisition
-                    if (fReadState.fStartOfSliceAcquisitionId != fM3Stream->GetAcquisitionId() || inNewFile)
+                    if (fReadState.fStartOfSliceAcquisitionId != fRecord.fAcquisitionId || inNewFile)
                     {
                         KTDEBUG(eggreadlog, "New acquisition reached; starting slice again\n" <<
                                 "\tUnused samples: " << writePos + samplesToCopyFromThisRecord);
@@ -497,7 +558,7 @@ namespace Katydid
                         fReadState.fStartOfLastSliceRecord = fReadState.fCurrentRecord;
                         fReadState.fStartOfLastSliceReadPtr = readPos;
                         // also reset fStartOfSliceAcquisitionId
-                        fReadState.fStartOfSliceAcquisitionId = fM3Stream->GetAcquisitionId();
+                        fReadState.fStartOfSliceAcquisitionId = fRecord.fAcquisitionId;
 
                         // reset slice data
                         sliceHeader.SetIsNewAcquisition(true);
@@ -505,9 +566,9 @@ namespace Katydid
                         sliceHeader.SetStartSampleNumber(readPos);
                         for (unsigned iChan = 0; iChan < nChannels; ++iChan)
                         {
-                            sliceHeader.SetAcquisitionID(fM3Stream->GetAcquisitionId(), iChan);
-                            sliceHeader.SetRecordID(fM3Stream->GetChannelRecord( iChan )->GetRecordId(), iChan);
-                            sliceHeader.SetTimeStamp(fM3Stream->GetChannelRecord( iChan )->GetTime(), iChan);
+                            sliceHeader.SetAcquisitionID(fRecord.fAcquisitionId, iChan);
+                            sliceHeader.SetRecordID(fRecord.fRecordIds[iChan], iChan);
+                            sliceHeader.SetTimeStamp(fRecord.fTimeStamps[iChan], iChan);
                         }
                         sliceHeader.SetTimeInRun(GetTimeInRun());
                         fAcqTimeInRun = sliceHeader.GetTimeInRun();
@@ -544,6 +605,43 @@ namespace Katydid
     }
 
     bool KTEgg3Reader::LoadNextFile()
+    {
+        // records from the last file can't be used for slices in this file
+        RecycleHistory(fRecordHistory.size());
+        fHistoryPos = -1;
+
+        if (fPrefetchRecords != 0)
+        {
+            // the prefetch thread opens the files itself; it has either moved on to the next file already, or stopped
+            if (fPrefetchFailed)
+            {
+                KTERROR(eggreadlog, "Reading stopped because of an error while prefetching records");
+                return false;
+            }
+            if (! fPrefetchInNextFile)
+            {
+                KTINFO(eggreadlog, "There are no more files to read");
+                return false;
+            }
+            fPrefetchInNextFile = false;
+        }
+        else if (! OpenNextFile())
+        {
+            return false;
+        }
+
+        // start the read state at the beginning of the file; the caller reads the first record and carries on with the current slice,
+        // so this isn't the start of the run (which would make the next slice skip ahead to the second record)
+        fReadState.fStatus = MonarchReadState::kContinueReading;
+        fReadState.fStartOfLastSliceRecord = 0;
+        fReadState.fStartOfLastSliceReadPtr = 0;
+        fReadState.fStartOfSliceAcquisitionId = 0;
+        fReadState.fCurrentRecord = 0;
+
+        return true;
+    }
+
+    bool KTEgg3Reader::OpenNextFile()
     {
         KTDEBUG(eggreadlog, "Attempting to load next file");
 
@@ -556,7 +654,7 @@ namespace Katydid
         }
 
         // close the last file
-        if (! CloseEgg())
+        if (! CloseFile())
         {
             return false;
         }
@@ -593,19 +691,20 @@ namespace Katydid
         fM3Stream = fMonarch->GetStream(streamNum);
         fM3StreamHeader = &(fMonarch->GetHeader()->GetStreamHeaders()[streamNum]);
 
-        // by default, start the read state at the beginning of the file
-        fReadState.fStatus = MonarchReadState::kAtStartOfRun;
-        fReadState.fStartOfLastSliceRecord = 0;
-        fReadState.fStartOfLastSliceReadPtr = 0;
-        fReadState.fStartOfSliceAcquisitionId = 0;
-        fReadState.fCurrentRecord = 0;
-
         return true;
     }
 
 
     bool KTEgg3Reader::CloseEgg()
     {
+        StopPrefetching();
+        return CloseFile();
+    }
+
+    bool KTEgg3Reader::CloseFile()
+    {
+        if (fMonarch == NULL) return true;
+
         try
         {
             fMonarch->FinishReading();
@@ -620,6 +719,268 @@ namespace Katydid
     }
 
 
+    bool KTEgg3Reader::ReadRecord(int offset, bool ifNewAcqStartAtFirstRec)
+    {
+        if (fPrefetchRecords == 0)
+        {
+            if (fUseRecordHistory) return ReadRecordWithHistory(offset, ifNewAcqStartAtFirstRec);
+
+            if (! fM3Stream->ReadRecord(offset, ifNewAcqStartAtFirstRec)) return false;
+            FillRecordInfo(fRecord);
+            for (unsigned iChan = 0; iChan < fRecord.fNChannels; ++iChan)
+            {
+                fRecord.fData[iChan] = fM3Stream->GetChannelRecord( iChan )->GetData();
+            }
+            return true;
+        }
+
+        // the first read is done by the prefetch thread, since it owns the files from then on
+        if (! fPrefetchThread.joinable())
+        {
+            StartPrefetching(offset, ifNewAcqStartAtFirstRec);
+            offset = 0;
+        }
+
+        int target = fHistoryPos + 1 + offset;
+        if (target < 0)
+        {
+            KTERROR(eggreadlog, "Requested record (" << -target << " records before the oldest held record) is no longer available; consider increasing the record history");
+            return false;
+        }
+
+        bool isInHistory = target < (int)fRecordHistory.size();
+
+        // if necessary, pull records from the prefetch queue until we reach the target
+        while (target >= (int)fRecordHistory.size())
+        {
+            PrefetchedRecordPtr nextRecord;
+            if (! PopPrefetchedRecord(nextRecord))
+            {
+                // the prefetch thread has stopped: end of the last file
+                fPrefetchInNextFile = false;
+                return false;
+            }
+            if (! nextRecord)
+            {
+                // end of the current file; the prefetch thread has opened the next one
+                fPrefetchInNextFile = true;
+                return false;
+            }
+            fRecordHistory.push_back(nextRecord);
+
+            // emulate the monarch behavior of stopping at the first record of a new acquisition
+            if (ifNewAcqStartAtFirstRec && fHistoryPos >= 0 &&
+                    nextRecord->fInfo.fAcquisitionId != fRecordHistory[fHistoryPos]->fInfo.fAcquisitionId)
+            {
+                target = fRecordHistory.size() - 1;
+            }
+        }
+
+        if (isInHistory) ++fNRecordCacheHits;
+        else ++fNRecordCacheMisses;
+
+        fHistoryPos = target;
+        fRecord = fRecordHistory[fHistoryPos]->fInfo;
+        TrimHistory();
+
+        return true;
+    }
+
+    bool KTEgg3Reader::ReadRecordWithHistory(int offset, bool ifNewAcqStartAtFirstRec)
+    {
+        // records that are still held are taken from memory instead of being read from the file again
+        int target = fHistoryPos + 1 + offset;
+        if (target >= 0 && target < (int)fRecordHistory.size())
+        {
+            ++fNRecordCacheHits;
+            fHistoryPos = target;
+            fRecord = fRecordHistory[fHistoryPos]->fInfo;
+            return true;
+        }
+
+        // the stream is positioned at the newest record in the history
+        int streamOffset = fRecordHistory.empty() ? offset : target - (int)fRecordHistory.size();
+        if (! fM3Stream->ReadRecord(streamOffset, ifNewAcqStartAtFirstRec)) return false;
+        ++fNRecordCacheMisses;
+
+        // the history has to be a continuous run of records; anything else starts it over
+        if (streamOffset != 0) RecycleHistory(fRecordHistory.size());
+
+        PrefetchedRecordPtr record;
+        if (! fRecycledRecords->TryPop(record))
+        {
+            record.reset(new PrefetchedRecord());
+        }
+        CopyCurrentRecord(*record);
+        fRecordHistory.push_back(record);
+
+        fHistoryPos = fRecordHistory.size() - 1;
+        fRecord = record->fInfo;
+        TrimHistory();
+
+        return true;
+    }
+
+    void KTEgg3Reader::TrimHistory()
+    {
+        // let go of records that are too old to be needed again
+        if (fHistoryPos > (int)fMaxHistory)
+        {
+            unsigned nToRecycle = fHistoryPos - fMaxHistory;
+            RecycleHistory(nToRecycle);
+            fHistoryPos -= nToRecycle;
+        }
+        return;
+    }
+
+    void KTEgg3Reader::FillRecordInfo(RecordInfo& info) const
+    {
+        info.fNChannels = fM3Stream->GetNChannels();
+        info.fRecordSize = fM3Stream->GetChannelRecordSize();
+        info.fSampleSize = fM3Stream->GetSampleSize();
+        info.fDataTypeSize = fM3Stream->GetDataTypeSize();
+        info.fDataFormat = fM3StreamHeader->GetDataFormat();
+        info.fAcquisitionId = fM3Stream->GetAcquisitionId();
+        info.fAcqFirstRecordId = fM3Stream->GetAcqFirstRecordId();
+        info.fRecordCountInAcq = fM3Stream->GetRecordCountInAcq();
+        info.fAcqFirstRecordTime = fM3Stream->GetAcqFirstRecordTime();
+        info.fFirstRecordInFile = fM3Stream->GetFirstRecordInFile();
+        info.fRecordIds.resize(info.fNChannels);
+        info.fTimeStamps.resize(info.fNChannels);
+        info.fData.resize(info.fNChannels);
+        for (unsigned iChan = 0; iChan < info.fNChannels; ++iChan)
+        {
+            info.fRecordIds[iChan] = fM3Stream->GetChannelRecord( iChan )->GetRecordId();
+            info.fTimeStamps[iChan] = fM3Stream->GetChannelRecord( iChan )->GetTime();
+        }
+        return;
+    }
+
+    void KTEgg3Reader::CopyCurrentRecord(PrefetchedRecord& record) const
+    {
+        FillRecordInfo(record.fInfo);
+        unsigned nBytesInRecord = record.fInfo.fRecordSize * record.fInfo.fSampleSize * record.fInfo.fDataTypeSize;
+        record.fChannelData.resize(record.fInfo.fNChannels);
+        for (unsigned iChan = 0; iChan < record.fInfo.fNChannels; ++iChan)
+        {
+            record.fChannelData[iChan].resize(nBytesInRecord);
+            memcpy(record.fChannelData[iChan].data(), fM3Stream->GetChannelRecord( iChan )->GetData(), nBytesInRecord);
+            record.fInfo.fData[iChan] = record.fChannelData[iChan].data();
+        }
+        return;
+    }
+
+
+    void KTEgg3Reader::StartPrefetching(int firstOffset, bool ifNewAcqStartAtFirstRec)
+    {
+        KTINFO(eggreadlog, "Starting to prefetch up to " << fPrefetchRecords << " records");
+        fPrefetchQueue.reset(new KTConcurrentQueue< PrefetchedRecordPtr >(fPrefetchRecords));
+        fPrefetchFailed = false;
+        fPrefetchInNextFile = false;
+        fPrefetchThread = std::thread(&KTEgg3Reader::PrefetchLoop, this, firstOffset, ifNewAcqStartAtFirstRec);
+        return;
+    }
+
+    void KTEgg3Reader::StopPrefetching()
+    {
+        if (fPrefetchThread.joinable())
+        {
+            // closing the queue makes the prefetch thread's next push fail, so it will stop
+            fPrefetchQueue->Close();
+            fPrefetchThread.join();
+            KTDEBUG(eggreadlog, "Prefetch thread has stopped");
+        }
+        fRecordHistory.clear();
+        fHistoryPos = -1;
+        return;
+    }
+
+    void KTEgg3Reader::PrefetchLoop(int firstOffset, bool ifNewAcqStartAtFirstRec)
+    {
+        // From here on, this thread owns the files: at the end of each file it opens the next one, and puts an empty record
+        // in the queue to mark the boundary, so the reading thread never waits for a file to be opened
+        bool isFirstRead = true;
+        while (true)
+        {
+            bool haveRecord = false;
+            try
+            {
+                if (isFirstRead) haveRecord = fM3Stream->ReadRecord(firstOffset, ifNewAcqStartAtFirstRec);
+                else haveRecord = fM3Stream->ReadRecord();
+            }
+            catch (M3Exception& e)
+            {
+                KTERROR(eggreadlog, "Error while prefetching a record: " << e.what());
+                fPrefetchFailed = true;
+                break;
+            }
+            isFirstRead = false;
+
+            // end of the file (or the requested start is beyond it, which the slice assembly reports)
+            if (! haveRecord)
+            {
+                if (! OpenNextFile())
+                {
+                    // either there are no more files, or the next one couldn't be opened
+                    if (fCurrentFileIt != fFilenames.end()) fPrefetchFailed = true;
+                    break;
+                }
+                if (! fPrefetchQueue->Push(PrefetchedRecordPtr())) break;
+                continue;
+            }
+
+            // reuse a record buffer if one is available
+            PrefetchedRecordPtr record;
+            if (! fRecycledRecords->TryPop(record))
+            {
+                record.reset(new PrefetchedRecord());
+            }
+
+            CopyCurrentRecord(*record);
+
+            if (! fPrefetchQueue->Push(record)) break;
+        }
+
+        // lets the reading side know that there's nothing more coming
+        fPrefetchQueue->Close();
+        return;
+    }
+
+    bool KTEgg3Reader::PopPrefetchedRecord(PrefetchedRecordPtr& record)
+    {
+        bool popped = false;
+        unsigned queueDepth = fPrefetchQueue->Size();
+        fSummedQueueDepth += queueDepth;
+        ++fNPrefetchPops;
+        if (queueDepth == 0)
+        {
+            // the reader is ahead of the prefetch thread, so the time spent waiting is time we're I/O-bound
+            std::chrono::steady_clock::time_point stallStart = std::chrono::steady_clock::now();
+            popped = fPrefetchQueue->Pop(record);
+            fReadStallTime += std::chrono::duration< double >(std::chrono::steady_clock::now() - stallStart).count();
+        }
+        else
+        {
+            popped = fPrefetchQueue->Pop(record);
+        }
+        return popped;
+    }
+
+    void KTEgg3Reader::RecycleHistory(unsigned nRecords)
+    {
+        for (unsigned iRecord = 0; iRecord < nRecords && ! fRecordHistory.empty(); ++iRecord)
+        {
+            // records still referenced by zero-copy slices can't be reused; they're freed when the last slice lets go of them
+            if (fRecordHistory.front().use_count() == 1 && fRecycledRecords)
+            {
+                fRecycledRecords->Push(fRecordHistory.front());
+            }
+            fRecordHistory.pop_front();
+        }
+        return;
+    }
+
+
     void KTEgg3Reader::CopyHeader(const M3Header* monarchHeader)
     {
         fHeader.SetFilename(monarchHeader->GetFilename());
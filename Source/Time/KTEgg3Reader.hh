@@ -9,14 +9,19 @@
 #ifndef KTEGG3READER_HH_
 #define KTEGG3READER_HH_
 
+#include "KTConcurrentQueue.hh"
 #include "KTEggReader.hh"
 #include "KTSliceHeader.hh"
 
 #include "M3Stream.hh"
 #include "M3Types.hh"
 
+#include <atomic>
+#include <deque>
 #include <map>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #ifndef SEC_PER_NSEC
@@ -36,6 +41,18 @@ namespace Katydid
     // NOTE: the first version of this KTEgg3Reader operates in much the same way as KTEgg2Reader, and does not take advantage of
     // the flexibility of the full egg3 file format.  In particular, it only uses the channels in stream0 (though it uses as
     // many channels as exist in that stream).
+    //
+    // Prefetching: if the egg processor's "prefetch-records" is non-zero, a background thread takes over the files after the
+    // first read, and reads their records into a queue that holds up to that many records.  At the end of each file the thread
+    // opens the next one itself and queues an empty record to mark the boundary, so the files are only ever used by that thread,
+    // and the reading thread doesn't wait for a file to be opened.
+    // Slice assembly then only copies from memory.  The most recent records are kept so that overlapping slices can step back.
+    // The time spent waiting on an empty queue and the average queue depth are reported in the processing summary.
+    //
+    // Record history: without prefetching, if the stride is smaller than the slice size, the reader also keeps copies of the most
+    // recent records (enough to cover the overlap between slices), so that stepping back for the next slice doesn't read and decode
+    // the same records from the file again.  The number of records taken from the history (hits) and from the file or prefetch
+    // queue (misses) are reported in the processing summary.
     class KTEgg3Reader : public KTEggReader
     {
         protected:
@@ -63,6 +80,32 @@ namespace Katydid
                 Status fStatus;
             };
 
+            /// Everything that slice assembly needs from the record currently being read
+            struct RecordInfo
+            {
+                unsigned fNChannels;
+                unsigned fRecordSize;
+                unsigned fSampleSize;
+                unsigned fDataTypeSize;
+                uint32_t fDataFormat;
+                monarch3::AcquisitionIdType fAcquisitionId;
+                uint64_t fAcqFirstRecordId;
+                uint64_t fRecordCountInAcq;
+                monarch3::TimeType fAcqFirstRecordTime;
+                uint64_t fFirstRecordInFile;
+                std::vector< monarch3::RecordIdType > fRecordIds;
+                std::vector< monarch3::TimeType > fTimeStamps;
+                std::vector< const monarch3::byte_type* > fData;
+            };
+
+            /// Record that has been copied out of the file, either by the prefetch thread or for the record history
+            struct PrefetchedRecord
+            {
+                RecordInfo fInfo;
+                std::vector< std::vector< monarch3::byte_type > > fChannelData;
+            };
+            typedef std::shared_ptr< PrefetchedRecord > PrefetchedRecordPtr;
+
         public:
             KTEgg3Reader();
             virtual ~KTEgg3Reader();
@@ -80,11 +123,19 @@ namespace Katydid
             unsigned GetStartRecord() const;
             void SetStartRecord(unsigned rec);
 
+            unsigned GetPrefetchRecords() const;
+            void SetPrefetchRecords(unsigned nRecords);
+
+            bool GetZeroCopySlices() const;
+            void SetZeroCopySlices(bool flag);
+
         protected:
             unsigned fSliceSize;
             unsigned fStride;
             double fStartTime;
             unsigned fStartRecord;
+            unsigned fPrefetchRecords;
+            bool fZeroCopySlices;
 
         public:
             bool Configure(const KTEggProcessor& eggProc);
@@ -102,7 +153,31 @@ namespace Katydid
             /// Copy header information from the M3Header object
             void CopyHeader(const monarch3::M3Header* monarchHeader);
 
+            /// Opens the next file and resets the read state; in prefetch mode the prefetch thread has already opened it
             bool LoadNextFile();
+            /// Opens the next file in the list
+            bool OpenNextFile();
+            /// Closes the current file
+            bool CloseFile();
+
+            /// Moves to another record, with the same meaning of the arguments as M3Stream::ReadRecord(), and updates fRecord
+            bool ReadRecord(int offset = 0, bool ifNewAcqStartAtFirstRec = true);
+            /// Same as ReadRecord(), for reading directly from the file while keeping the record history
+            bool ReadRecordWithHistory(int offset, bool ifNewAcqStartAtFirstRec);
+            /// Recycles the records in the history that are too old to be needed again
+            void TrimHistory();
+            /// Fills the metadata for the record that's currently loaded in the stream
+            void FillRecordInfo(RecordInfo& info) const;
+            /// Copies the metadata and data of the record that's currently loaded in the stream
+            void CopyCurrentRecord(PrefetchedRecord& record) const;
+
+            void StartPrefetching(int firstOffset, bool ifNewAcqStartAtFirstRec);
+            void StopPrefetching();
+            void PrefetchLoop(int firstOffset, bool ifNewAcqStartAtFirstRec);
+            /// Returns false once the prefetch thread has stopped; an empty record marks the end of a file
+            bool PopPrefetchedRecord(PrefetchedRecordPtr& record);
+            /// Returns the oldest records in the history to the prefetch thread for reuse
+            void RecycleHistory(unsigned nRecords);
 
             //Nymph::KTDataPtr (KTEgg3Reader::*fHatchNextSlicePtr)();
             //Nymph::KTDataPtr HatchNextSliceRealUnsigned();
@@ -122,6 +197,24 @@ namespace Katydid
 
             MonarchReadState fReadState;
 
+            RecordInfo fRecord;
+
+            std::unique_ptr< KTConcurrentQueue< PrefetchedRecordPtr > > fPrefetchQueue;
+            std::unique_ptr< KTConcurrentQueue< PrefetchedRecordPtr > > fRecycledRecords;
+            std::thread fPrefetchThread;
+            std::deque< PrefetchedRecordPtr > fRecordHistory;
+            int fHistoryPos;
+            unsigned fMaxHistory;
+            bool fUseRecordHistory; /// whether records are kept without prefetching
+            std::atomic< bool > fPrefetchFailed; /// set by the prefetch thread if reading the file failed (as opposed to reaching its end)
+            bool fPrefetchInNextFile; /// set when the end of a file was reached and the prefetch thread has moved on to the next one
+
+            uint64_t fNPrefetchPops;
+            uint64_t fSummedQueueDepth;
+            double fReadStallTime;
+            uint64_t fNRecordCacheHits;
+            uint64_t fNRecordCacheMisses;
+
         public:
             double GetSampleRateUnitsInHz() const;
 
@@ -144,6 +237,16 @@ namespace Katydid
 
             const MonarchReadState& GetReadState() const;
 
+            /// Returns the time spent waiting for the prefetch thread, in seconds
+            virtual double GetReadStallTime() const;
+            /// Returns the average number of prefetched records that were waiting when a record was needed
+            virtual double GetMeanReadQueueDepth() const;
+
+            /// Returns the number of record reads that were served from the record history
+            virtual uint64_t GetNRecordCacheHits() const;
+            /// Returns the number of record reads that needed a new record from the file (or the prefetch queue)
+            virtual uint64_t GetNRecordCacheMisses() const;
+
             /// Returns the time since the run started in seconds of the current acquisition
             double GetAcqTimeInRun() const;
 
@@ -213,6 +316,28 @@ namespace Katydid
         return;
     }
 
+    inline unsigned KTEgg3Reader::GetPrefetchRecords() const
+    {
+        return fPrefetchRecords;
+    }
+
+    inline void KTEgg3Reader::SetPrefetchRecords(unsigned nRecords)
+    {
+        fPrefetchRecords = nRecords;
+        return;
+    }
+
+    inline bool KTEgg3Reader::GetZeroCopySlices() const
+    {
+        return fZeroCopySlices;
+    }
+
+    inline void KTEgg3Reader::SetZeroCopySlices(bool flag)
+    {
+        fZeroCopySlices = flag;
+        return;
+    }
+
     inline double KTEgg3Reader::GetSampleRateUnitsInHz() const
     {
         return fSampleRateUnitsInHz;
@@ -234,7 +359,7 @@ namespace Katydid
 
     inline double KTEgg3Reader::GetTimeInRunFromMonarch() const
     {
-        return double(fM3Stream->GetChannelRecord(0)->GetTime()) * SEC_PER_NSEC + fBinWidth * double(fReadState.fStartOfLastSliceReadPtr);
+        return double(fRecord.fTimeStamps[0]) * SEC_PER_NSEC + fBinWidth * double(fReadState.fStartOfLastSliceReadPtr);
     }
 
     inline double KTEgg3Reader::GetTimeInRunManually() const
@@ -267,6 +392,27 @@ namespace Katydid
         return fAcqTimeInRun;
     }
 
+    inline double KTEgg3Reader::GetReadStallTime() const
+    {
+        return fReadStallTime;
+    }
+
+    inline double KTEgg3Reader::GetMeanReadQueueDepth() const
+    {
+        if (fNPrefetchPops == 0) return 0.;
+        return double(fSummedQueueDepth) / double(fNPrefetchPops);
+    }
+
+    inline uint64_t KTEgg3Reader::GetNRecordCacheHits() const
+    {
+        return fNRecordCacheHits;
+    }
+
+    inline uint64_t KTEgg3Reader::GetNRecordCacheMisses() const
+    {
+        return fNRecordCacheMisses;
+    }
+
 
 
 } /* namespace Katydid */
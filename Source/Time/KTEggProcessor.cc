@@ -13,11 +13,22 @@
 #include "KTData.hh"
 #include "KTEggHeader.hh"
 #include "KTEggReader.hh"
+#include "KTFrequencySpectrumFFTW.hh"
+#include "KTObjectPool.hh"
+#include "KTPowerSpectrum.hh"
 #include "KTProcSummary.hh"
+#include "KTRawTimeSeries.hh"
 #include "KTRawTimeSeriesData.hh"
+#include "KTTimeSeriesComplexFloat.hh"
 #include "KTTimeSeriesData.hh"
+#include "KTTimeSeriesFFTW.hh"
+#include "KTTimeSeriesReal.hh"
+#include "KTTimeSeriesRealFloat.hh"
 #include "KTSliceHeader.hh"
 
+#include <sstream>
+#include <thread>
+
 using std::string;
 
 
@@ -41,8 +52,13 @@ namespace Katydid
             fStride(1024),
             fStartTime(0.),
             fStartRecord(0),
+            fPrefetchRecords(0),
+            fZeroCopySlices(false),
             fDAC(new KTDAC()),
             fNormalizeVoltages(true),
+            fNWorkerThreads(0),
+            fMaxSlicesInFlight(0),
+            fWorkerChains(),
             fHeaderSignal("header", this),
             fRawDataSignal("raw-ts", this),
             fDataSignal("ts", this),
@@ -53,6 +69,7 @@ namespace Katydid
 
     KTEggProcessor::~KTEggProcessor()
     {
+        ClearWorkerChains();
         delete fDAC;
     }
 
@@ -104,6 +121,15 @@ namespace Katydid
             // specify the time in the run to start
             fStartTime = node->get_value< double >("start-time", fStartTime);
             fStartRecord = node->get_value< unsigned >("start-record", fStartRecord);
+            // read-ahead of records
+            fPrefetchRecords = node->get_value< unsigned >("prefetch-records", fPrefetchRecords);
+            fZeroCopySlices = node->get_value< bool >("zero-copy-slices", fZeroCopySlices);
+
+            // recycling of time series and spectra
+            if (node->has("object-pool-capacity"))
+            {
+                SetObjectPoolCapacity(node->get_value< unsigned >("object-pool-capacity"));
+            }
 
             if (fSliceSize == 0)
             {
@@ -119,6 +145,18 @@ namespace Katydid
 
             // whether or not to normalize voltage values, and what the normalization is
             SetNormalizeVoltages(node->get_value< bool >("normalize-voltages", fNormalizeVoltages));
+
+            // parallel processing
+            SetNWorkerThreads(node->get_value< unsigned >("n-worker-threads", fNWorkerThreads));
+            SetMaxSlicesInFlight(node->get_value< unsigned >("max-slices-in-flight", fMaxSlicesInFlight));
+            if (fNWorkerThreads > 0 && node->has("worker-chain"))
+            {
+                if (! BuildWorkerChains(node->node_at("worker-chain")))
+                {
+                    KTERROR(egglog, "Unable to build the worker chains");
+                    return false;
+                }
+            }
         }
 
         // Command-line settings
@@ -172,22 +210,38 @@ namespace Katydid
         }
 
         fHeaderSignal(headerPtr);
+        for (std::vector< WorkerChain >::iterator chainIt = fWorkerChains.begin(); chainIt != fWorkerChains.end(); ++chainIt)
+        {
+            (*chainIt->fHeaderSignal)(headerPtr);
+        }
         KTINFO(egglog, "The egg file has been opened successfully and the header was parsed and processed;");
         KTPROG(egglog, "Proceeding with slice processing");
 
-        if (fNSlices == 0) UnlimitedLoop(reader);
+        if (fNWorkerThreads > 0) ParallelLoop(reader);
+        else if (fNSlices == 0) UnlimitedLoop(reader);
         else LimitedLoop(reader);
 
+        for (std::vector< WorkerChain >::iterator chainIt = fWorkerChains.begin(); chainIt != fWorkerChains.end(); ++chainIt)
+        {
+            (*chainIt->fEggDoneSignal)();
+        }
         fEggDoneSignal();
 
         KTProcSummary* summary = new KTProcSummary();
         summary->SetNSlicesProcessed(reader->GetNSlicesProcessed());
         summary->SetNRecordsProcessed(reader->GetNRecordsProcessed());
         summary->SetIntegratedTime(reader->GetIntegratedTime());
+        summary->SetReadStallTime(reader->GetReadStallTime());
+        summary->SetMeanReadQueueDepth(reader->GetMeanReadQueueDepth());
+        summary->SetNRecordCacheHits(reader->GetNRecordCacheHits());
+        summary->SetNRecordCacheMisses(reader->GetNRecordCacheMisses());
         KTDEBUG(egglog, "Summary of processing:\n" <<
                 "\tSlices processed: " << summary->GetNSlicesProcessed() << '\n' <<
                 "\tRecords processed: " << summary->GetNRecordsProcessed() << '\n' <<
-                "\tIntegrated time: " << summary->GetIntegratedTime() << " s");
+                "\tIntegrated time: " << summary->GetIntegratedTime() << " s\n" <<
+                "\tTime waiting for read-ahead: " << summary->GetReadStallTime() << " s\n" <<
+                "\tMean read-ahead queue depth: " << summary->GetMeanReadQueueDepth() << '\n' <<
+                "\tRecord cache hits/misses: " << summary->GetNRecordCacheHits() << " / " << summary->GetNRecordCacheMisses());
         if(fNSlices != 0 && summary->GetNSlicesProcessed() != fNSlices)
         {
             KTWARN(egglog, "Could not process the requested number of slices because there was not enough data in the file(s):\n" <<
@@ -301,6 +355,367 @@ namespace Katydid
         return;
     }
 
+    void KTEggProcessor::ParallelLoop(KTEggReader* reader)
+    {
+        unsigned maxInFlight = fMaxSlicesInFlight > 0 ? fMaxSlicesInFlight : 2 * fNWorkerThreads;
+        if (maxInFlight < 2)
+        {
+            KTWARN(egglog, "At least 2 slices must be allowed in flight (the next slice is hatched before the current one is handed off); using 2");
+            maxInFlight = 2;
+        }
+        KTINFO(egglog, "Processing slices with " << fNWorkerThreads << " worker threads and up to " << maxInFlight << " slices in flight");
+
+        // the DAC initializes itself lazily; make sure that's done before the workers share it
+        if (fNormalizeVoltages && ! fDAC->Initialize())
+        {
+            KTERROR(egglog, "Unable to initialize the DAC");
+            return;
+        }
+
+        KTConcurrentQueue< SliceJob > jobs(maxInFlight);
+        ReorderBuffer done;
+
+        std::vector< std::thread > workers;
+        for (unsigned iWorker = 0; iWorker < fNWorkerThreads; ++iWorker)
+        {
+            workers.push_back(std::thread(&KTEggProcessor::WorkerLoop, this, iWorker, &jobs, &done));
+        }
+
+        unsigned iSlice = 0, iNextToEmit = 0, iProgress = 0;
+        try
+        {
+            Nymph::KTDataPtr data, nextData;
+            bool sliceIsValid = HatchNextSlice(reader, data);
+            if (! sliceIsValid)
+            {
+                KTERROR(egglog, "Unable to hatch first slice of data.");
+            }
+            while (sliceIsValid)
+            {
+                KTINFO(egglog, "Hatching slice " << iSlice);
+
+                // keep the number of slices in flight bounded: the ones handed to the workers and not yet emitted,
+                // this one, and the next one; emitting from here also keeps the reorder buffer small
+                bool ok = true;
+                while (ok && iSlice - iNextToEmit + 2 > maxInFlight)
+                {
+                    ok = EmitInOrder(done, iNextToEmit, iProgress, true);
+                }
+                if (! ok) break;
+
+                // look ahead by one slice so that the last-data flag is set before the slice leaves this thread
+                bool nextSliceIsValid = (fNSlices == 0 || iSlice + 1 < fNSlices) && HatchNextSlice(reader, nextData);
+                if (! nextSliceIsValid)
+                {
+                    data->Of< Nymph::KTData >().SetLastData(true);
+                }
+
+                SliceJob job;
+                job.fSequence = iSlice;
+                job.fData = data;
+                jobs.Push(job);
+                ++iSlice;
+
+                if (! EmitInOrder(done, iNextToEmit, iProgress, false)) break;
+
+                sliceIsValid = nextSliceIsValid;
+                data = nextData;
+            }
+
+            // no more slices; let the workers finish what's queued, and emit the rest
+            jobs.Close();
+            while (iNextToEmit < iSlice && EmitInOrder(done, iNextToEmit, iProgress, true));
+        }
+        catch (...)
+        {
+            // the slots of the ordered signals failed; stop the workers
+            std::unique_lock< std::mutex > lock(done.fMutex);
+            if (! done.fError) done.fError = std::current_exception();
+        }
+
+        jobs.Close();
+        for (std::vector< std::thread >::iterator workerIt = workers.begin(); workerIt != workers.end(); ++workerIt)
+        {
+            workerIt->join();
+        }
+
+        if (done.fError)
+        {
+            KTERROR(egglog, "Slice processing stopped after " << iNextToEmit << " slices were emitted because a slice could not be processed");
+            std::rethrow_exception(done.fError);
+        }
+
+        if (fNSlices != 0 && iSlice >= fNSlices)
+        {
+            KTPROG(egglog, iSlice << "/" << fNSlices << " slices hatched; slice processing is complete");
+        }
+        return;
+    }
+
+    void KTEggProcessor::WorkerLoop(unsigned iWorker, KTConcurrentQueue< SliceJob >* jobs, ReorderBuffer* done)
+    {
+        WorkerChain* chain = iWorker < fWorkerChains.size() ? &fWorkerChains[iWorker] : NULL;
+
+        SliceJob job;
+        while (jobs->Pop(job))
+        {
+            std::unique_lock< std::mutex > lock(done->fMutex);
+            if (done->fError)
+            {
+                // something has failed; keep draining the queue so that the calling thread isn't blocked
+                continue;
+            }
+            lock.unlock();
+
+            KTDEBUG(egglog, "Worker " << iWorker << " is processing slice " << job.fSequence);
+            try
+            {
+                if (job.fData->Has< KTRawTimeSeriesData >())
+                {
+                    if (chain != NULL) (*chain->fRawDataSignal)(job.fData);
+                    // the DAC was initialized before the workers started, so from here on it's only read from
+                    NormalizeData(job.fData);
+                }
+                if (chain != NULL && job.fData->Has< KTTimeSeriesData >())
+                {
+                    (*chain->fDataSignal)(job.fData);
+                }
+            }
+            catch (...)
+            {
+                KTERROR(egglog, "Worker " << iWorker << " failed to process slice " << job.fSequence);
+                lock.lock();
+                if (! done->fError) done->fError = std::current_exception();
+                lock.unlock();
+                done->fCondition.notify_all();
+                continue;
+            }
+
+            lock.lock();
+            done->fSlices[job.fSequence] = job.fData;
+            lock.unlock();
+            done->fCondition.notify_all();
+        }
+        return;
+    }
+
+    bool KTEggProcessor::EmitInOrder(ReorderBuffer& done, unsigned& nextSlice, unsigned& iProgress, bool waitForNext)
+    {
+        std::unique_lock< std::mutex > lock(done.fMutex);
+        if (waitForNext)
+        {
+            while (! done.fError && done.fSlices.find(nextSlice) == done.fSlices.end())
+            {
+                done.fCondition.wait(lock);
+            }
+        }
+        if (done.fError) return false;
+
+        std::map< unsigned, Nymph::KTDataPtr >::iterator sliceIt = done.fSlices.find(nextSlice);
+        while (sliceIt != done.fSlices.end())
+        {
+            Nymph::KTDataPtr data = sliceIt->second;
+            done.fSlices.erase(sliceIt);
+            // the signals may take a while, so don't hold up the workers
+            lock.unlock();
+
+            if (data->Has< KTRawTimeSeriesData >())
+            {
+                KTDEBUG(egglog, "Raw time series data is present.");
+                fRawDataSignal(data);
+            }
+            if (data->Has< KTTimeSeriesData >())
+            {
+                KTDEBUG(egglog, "Normalized time series data is present.");
+                fDataSignal(data);
+            }
+            else
+            {
+                KTWARN(egglog, "No time-series data present in slice");
+            }
+
+            ++nextSlice;
+            ++iProgress;
+            if (iProgress == fProgressReportInterval)
+            {
+                iProgress = 0;
+                KTPROG(egglog, nextSlice << " slices processed");
+            }
+
+            lock.lock();
+            if (done.fError) return false;
+            sliceIt = done.fSlices.find(nextSlice);
+        }
+        return true;
+    }
+
+    void KTEggProcessor::SetObjectPoolCapacity(unsigned capacity)
+    {
+        KTObjectPool< KTRawTimeSeries, KTRawTimeSeries::PoolKey >::GetInstance().SetCapacity(capacity);
+        KTObjectPool< KTTimeSeriesReal >::GetInstance().SetCapacity(capacity);
+        KTObjectPool< KTTimeSeriesFFTW >::GetInstance().SetCapacity(capacity);
+        KTObjectPool< KTTimeSeriesRealFloat >::GetInstance().SetCapacity(capacity);
+        KTObjectPool< KTTimeSeriesComplexFloat >::GetInstance().SetCapacity(capacity);
+        KTObjectPool< KTFrequencySpectrumFFTW >::GetInstance().SetCapacity(capacity);
+        KTObjectPool< KTPowerSpectrum >::GetInstance().SetCapacity(capacity);
+        KTINFO(egglog, "Object pool capacity set to " << capacity);
+        return;
+    }
+
+    bool KTEggProcessor::BuildWorkerChains(const scarab::param_node* chainNode)
+    {
+        if (! fWorkerChains.empty())
+        {
+            // the worker signals are registered with this processor, so they can't be rebuilt
+            KTWARN(egglog, "Worker chains have already been built; ignoring the new worker-chain configuration");
+            return true;
+        }
+
+        fWorkerChains.resize(fNWorkerThreads);
+        for (unsigned iWorker = 0; iWorker < fNWorkerThreads; ++iWorker)
+        {
+            if (! BuildWorkerChain(chainNode, iWorker, fWorkerChains[iWorker]))
+            {
+                KTERROR(egglog, "Failed to build the chain for worker " << iWorker);
+                return false;
+            }
+        }
+        KTINFO(egglog, "Built " << fWorkerChains.size() << " worker chains with " << fWorkerChains[0].fProcessors.size() << " processors each");
+        return true;
+    }
+
+    bool KTEggProcessor::BuildWorkerChain(const scarab::param_node* chainNode, unsigned iWorker, WorkerChain& chain)
+    {
+        std::stringstream workerName;
+        workerName << "worker-" << iWorker;
+        chain.fHeaderSignal = new Nymph::KTSignalData(workerName.str() + "-header", this);
+        chain.fRawDataSignal = new Nymph::KTSignalData(workerName.str() + "-raw-ts", this);
+        chain.fDataSignal = new Nymph::KTSignalData(workerName.str() + "-ts", this);
+        chain.fEggDoneSignal = new Nymph::KTSignalOneArg< void >(workerName.str() + "-egg-done", this);
+
+        // create and configure this worker's processors
+        std::map< string, Nymph::KTProcessor* > procMap;
+        const scarab::param_array* procArray = chainNode->array_at("processors");
+        if (procArray == NULL)
+        {
+            KTERROR(egglog, "No processors were specified for the worker chain");
+            return false;
+        }
+        for (scarab::param_array::const_iterator procIt = procArray->begin(); procIt != procArray->end(); ++procIt)
+        {
+            const scarab::param_node& procNode = (*procIt)->as_node();
+            string procType = procNode.get_value("type", "");
+            string procName = procNode.get_value("name", procType);
+            if (procType.empty())
+            {
+                KTERROR(egglog, "Worker-chain processor is missing its type");
+                return false;
+            }
+            if (procName == "worker" || procMap.find(procName) != procMap.end())
+            {
+                KTERROR(egglog, "Worker-chain processor name <" << procName << "> is reserved or already in use");
+                return false;
+            }
+
+            Nymph::KTProcessor* newProc = scarab::factory< Nymph::KTProcessor, const std::string& >::get_instance()->create(procType, procName + "-" + workerName.str());
+            if (newProc == NULL)
+            {
+                KTERROR(egglog, "Unable to create worker-chain processor of type <" << procType << ">");
+                return false;
+            }
+            chain.fProcessors.push_back(newProc);
+            procMap[procName] = newProc;
+
+            if (chainNode->has(procName))
+            {
+                if (! newProc->Configure(chainNode->node_at(procName)))
+                {
+                    KTERROR(egglog, "Unable to configure worker-chain processor <" << procName << ">");
+                    return false;
+                }
+            }
+            else
+            {
+                KTWARN(egglog, "No configuration was found for worker-chain processor <" << procName << ">");
+            }
+        }
+
+        // connect the worker's signals and processors
+        const scarab::param_array* connArray = chainNode->array_at("connections");
+        if (connArray == NULL)
+        {
+            KTWARN(egglog, "No connections were specified for the worker chain");
+            return true;
+        }
+        for (scarab::param_array::const_iterator connIt = connArray->begin(); connIt != connArray->end(); ++connIt)
+        {
+            const scarab::param_node& connNode = (*connIt)->as_node();
+            string signalConn = connNode.get_value("signal", "");
+            string slotConn = connNode.get_value("slot", "");
+            size_t signalColon = signalConn.find(':');
+            size_t slotColon = slotConn.find(':');
+            if (signalColon == string::npos || slotColon == string::npos)
+            {
+                KTERROR(egglog, "Worker-chain connections must be of the form \"processor:signal\" --> \"processor:slot\"; found <" << signalConn << "> --> <" << slotConn << ">");
+                return false;
+            }
+            string signalProcName = signalConn.substr(0, signalColon);
+            string signalName = signalConn.substr(signalColon + 1);
+            string slotProcName = slotConn.substr(0, slotColon);
+            string slotName = slotConn.substr(slotColon + 1);
+
+            Nymph::KTProcessor* signalProc = NULL;
+            if (signalProcName == "worker")
+            {
+                if (signalName != "header" && signalName != "raw-ts" && signalName != "ts" && signalName != "egg-done")
+                {
+                    KTERROR(egglog, "Unknown worker signal <" << signalName << ">");
+                    return false;
+                }
+                signalProc = this;
+                signalName = workerName.str() + "-" + signalName;
+            }
+            else if (procMap.find(signalProcName) != procMap.end())
+            {
+                signalProc = procMap[signalProcName];
+            }
+            if (signalProc == NULL || procMap.find(slotProcName) == procMap.end())
+            {
+                KTERROR(egglog, "Unknown processor in worker-chain connection <" << signalConn << "> --> <" << slotConn << ">");
+                return false;
+            }
+
+            try
+            {
+                signalProc->ConnectASlot(signalName, procMap[slotProcName], slotName);
+            }
+            catch (std::exception& e)
+            {
+                KTERROR(egglog, "Unable to make worker-chain connection <" << signalConn << "> --> <" << slotConn << ">: " << e.what());
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void KTEggProcessor::ClearWorkerChains()
+    {
+        for (std::vector< WorkerChain >::iterator chainIt = fWorkerChains.begin(); chainIt != fWorkerChains.end(); ++chainIt)
+        {
+            for (std::vector< Nymph::KTProcessor* >::iterator procIt = chainIt->fProcessors.begin(); procIt != chainIt->fProcessors.end(); ++procIt)
+            {
+                delete *procIt;
+            }
+            delete chainIt->fHeaderSignal;
+            delete chainIt->fRawDataSignal;
+            delete chainIt->fDataSignal;
+            delete chainIt->fEggDoneSignal;
+        }
+        fWorkerChains.clear();
+        return;
+    }
+
     void KTEggProcessor::NormalizeData(Nymph::KTDataPtr& data)
     {
         if (fNormalizeVoltages)
@@ -11,11 +11,18 @@
 
 #include "KTPrimaryProcessor.hh"
 
+#include "KTConcurrentQueue.hh"
 #include "KTData.hh"
 #include "KTEggHeader.hh"
 #include "KTEggReader.hh"
 #include "KTSlot.hh"
 
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <vector>
+
 
 namespace Katydid
 {
@@ -55,9 +62,25 @@ namespace Katydid
          between slices)
      - "start-time": double -- Specify how far into the file to start (in seconds); if "start-record" is non-zero, this will be ignored
      - "start-record": unsigned -- Specify which record to start on; if "start-time" is present and this is non-zero, start-time will be ignored
+     - "prefetch-records": unsigned -- Number of records to read ahead in a background thread (default: 0, i.e. no read-ahead);
+        currently only used by the "egg3" reader
+     - "zero-copy-slices": bool -- If true, slices that lie entirely within one record are views of the record buffer instead
+        of copies (default: false); requires "prefetch-records" > 0, and is currently only used by the "egg3" reader
+     - "object-pool-capacity": unsigned -- Maximum number of recycled time series and spectra kept for each size
+        (default: 16); when the data for a slice is released, its time series and spectra are kept for reuse by later slices
+        instead of being freed.  Set to 0 to disable recycling.  This is a global setting.
      - "normalize-voltages": bool -- Flag to toggle the normalization of ADC
         values from the egg file (default: true)
      - "dac": object -- configure the DAC
+     - "n-worker-threads": unsigned -- Number of worker threads used to process slices in parallel (default: 0, i.e. all
+        processing happens in the calling thread); see Parallel Processing below
+     - "max-slices-in-flight": unsigned -- Maximum number of slices that have been hatched but not yet emitted in order
+        (default: 0, meaning 2 * n-worker-threads)
+     - "worker-chain": object -- processing chain that is instantiated once per worker thread; see Parallel Processing below
+       - "processors": array of objects -- each has "type" and "name", in the same format as the processor toolbox
+       - "connections": array of objects -- each has "signal" and "slot" in the form "processor:signal/slot";
+          the worker's own signals are available as "worker:header", "worker:raw-ts", "worker:ts" and "worker:egg-done"
+       - [processor name]: object -- configuration for the worker-chain processor with that name
 
      Command-line options defined
      - -n (n-slices): Number of slices to process
@@ -74,6 +97,23 @@ namespace Katydid
      - "summary": void (const KTProcSummary*) -- emitted when a file is 
         finished (after "egg-done")
 
+     Parallel Processing:
+     When "n-worker-threads" is non-zero, slices are hatched in the calling thread (the egg readers are not thread-safe)
+     and handed to a pool of worker threads.  Each worker performs the DAC conversion and then runs its own copy of the
+     "worker-chain" processors on the slice (e.g. windowing, FFT, power conversion, discrimination), so that no processor
+     instance is ever used by two threads.  Finished slices go into a reorder buffer, and the "raw-ts" and "ts" signals are
+     emitted from the calling thread in slice-number order, carrying whatever data the worker chain added to the slice.
+     Stateful processors (track finders, spectrogram collectors, writers) should therefore be connected to "ts" as usual.
+     In parallel mode "raw-ts" is emitted after the DAC conversion, so the slice also holds KTTimeSeriesData at that point.
+     At most "max-slices-in-flight" slices exist between the reader and the ordered signals, which bounds the memory use;
+     because the next slice is hatched before the current one is handed off (so that the last slice can be flagged), at least
+     2 slices are allowed in flight.
+     The DAC is initialized before the workers start, and is only read from by the workers after that.
+     When the slices are done, each worker chain's "egg-done" signal is emitted (after all of the workers have finished),
+     followed by the egg processor's own "egg-done".
+     If processing a slice throws an exception, no further slices are hatched or emitted, the workers are stopped, and the
+     exception is rethrown from the calling thread.
+
      Additional Notes:
      - To use the "rsamat" egg-reader, the user must have installed the Matlab 
        Compiler Runtime (MCR) of version 2014a, and configured Katydid to use 
@@ -99,12 +139,34 @@ namespace Katydid
             MEMBERVARIABLE(unsigned, Stride);
             MEMBERVARIABLE(double, StartTime); // will only be used if fStartRecord is 0
             MEMBERVARIABLE(unsigned, StartRecord);
+            MEMBERVARIABLE(unsigned, PrefetchRecords);
+            MEMBERVARIABLE(bool, ZeroCopySlices);
 
             MEMBERVARIABLE(bool, NormalizeVoltages);
 
+            MEMBERVARIABLE(unsigned, NWorkerThreads);
+            MEMBERVARIABLE(unsigned, MaxSlicesInFlight);
+
+            /// Sets the capacity of the pools used to recycle raw time series, time series, and frequency and power spectra
+            static void SetObjectPoolCapacity(unsigned capacity);
+
         private:
             KTDAC* fDAC;
 
+            struct WorkerChain
+            {
+                std::vector< Nymph::KTProcessor* > fProcessors;
+                Nymph::KTSignalData* fHeaderSignal;
+                Nymph::KTSignalData* fRawDataSignal;
+                Nymph::KTSignalData* fDataSignal;
+                Nymph::KTSignalOneArg< void >* fEggDoneSignal;
+            };
+            std::vector< WorkerChain > fWorkerChains;
+
+            bool BuildWorkerChains(const scarab::param_node* chainNode);
+            bool BuildWorkerChain(const scarab::param_node* chainNode, unsigned iWorker, WorkerChain& chain);
+            void ClearWorkerChains();
+
         public:
             bool Run();
 
@@ -117,6 +179,27 @@ namespace Katydid
             void UnlimitedLoop(KTEggReader* reader);
             void LimitedLoop(KTEggReader* reader);
 
+            struct SliceJob
+            {
+                unsigned fSequence;
+                Nymph::KTDataPtr fData;
+            };
+
+            struct ReorderBuffer
+            {
+                std::mutex fMutex;
+                std::condition_variable fCondition;
+                std::map< unsigned, Nymph::KTDataPtr > fSlices;
+                /// First exception thrown while processing a slice, in either a worker or the calling thread
+                std::exception_ptr fError;
+            };
+
+            void ParallelLoop(KTEggReader* reader);
+            void WorkerLoop(unsigned iWorker, KTConcurrentQueue< SliceJob >* jobs, ReorderBuffer* done);
+            /// Emits all slices that are ready, in order, starting at nextSlice; if waitForNext is true, blocks until nextSlice is ready
+            /// Returns false, without waiting, once a slice has failed
+            bool EmitInOrder(ReorderBuffer& done, unsigned& nextSlice, unsigned& iProgress, bool waitForNext);
+
 
             //***************
             // Signals
@@ -13,6 +13,7 @@
 #include "factory.hh"
 #include "path.hh"
 
+#include <cstdint>
 #include <string>
 
 namespace Katydid
@@ -41,8 +42,37 @@ namespace Katydid
             virtual unsigned GetNRecordsProcessed() const = 0;
             virtual double GetIntegratedTime() const = 0;
 
+            /// Time spent waiting for data to be read, in seconds; only measured by readers that read ahead
+            virtual double GetReadStallTime() const;
+            /// Average number of read-ahead records available when a record was needed; only measured by readers that read ahead
+            virtual double GetMeanReadQueueDepth() const;
+            /// Number of record reads served from records held in memory; only counted by readers that hold records
+            virtual uint64_t GetNRecordCacheHits() const;
+            /// Number of record reads that needed a new record; only counted by readers that hold records
+            virtual uint64_t GetNRecordCacheMisses() const;
+
     };
 
+    inline double KTEggReader::GetReadStallTime() const
+    {
+        return 0.;
+    }
+
+    inline double KTEggReader::GetMeanReadQueueDepth() const
+    {
+        return 0.;
+    }
+
+    inline uint64_t KTEggReader::GetNRecordCacheHits() const
+    {
+        return 0;
+    }
+
+    inline uint64_t KTEggReader::GetNRecordCacheMisses() const
+    {
+        return 0;
+    }
+
     inline Nymph::KTDataPtr KTEggReader::BreakAnEgg(const std::string& filename)
     {
         path_vec filenameVec;
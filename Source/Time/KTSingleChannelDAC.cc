@@ -9,8 +9,10 @@
 
 #include "KTEggHeader.hh"
 #include "KTSliceHeader.hh"
+#include "KTTimeSeriesComplexFloat.hh"
 #include "KTTimeSeriesFFTW.hh"
 #include "KTTimeSeriesReal.hh"
+#include "KTTimeSeriesRealFloat.hh"
 
 #include "digital.hh"
 
@@ -31,8 +33,10 @@ namespace Katydid
             fTimeSeriesType(kUnknownTimeSeries),
             fBitDepthMode(kNoChange),
             fEmulatedNBits(fNBits),
+            fSinglePrecision(false),
             fShouldRunInitialize(true),
             fVoltages(),
+            fVoltagesFloat(),
             fIntLevelOffset(0),
             fConvertTSFunc(NULL),
             fOversamplingBins(1),
@@ -51,8 +55,10 @@ namespace Katydid
             fTimeSeriesType(orig.fTimeSeriesType),
             fBitDepthMode(orig.fBitDepthMode),
             fEmulatedNBits(orig.fEmulatedNBits),
+            fSinglePrecision(orig.fSinglePrecision),
             fShouldRunInitialize(orig.fShouldRunInitialize),
             fVoltages(orig.fVoltages),
+            fVoltagesFloat(orig.fVoltagesFloat),
             fIntLevelOffset(orig.fIntLevelOffset),
             fConvertTSFunc(orig.fConvertTSFunc),
             fOversamplingBins(orig.fOversamplingBins),
@@ -102,6 +108,8 @@ namespace Katydid
             SetEmulatedNBits(node->get_value< unsigned >("n-bits-emulated", fEmulatedNBits));
         }
 
+        SetSinglePrecision(node->get_value< bool >("single-precision", fSinglePrecision));
+
         return true;
     }
 
@@ -112,6 +120,7 @@ namespace Katydid
 
         SetTimeSeriesType(master.GetTimeSeriesType());
         SetEmulatedNBits(master.GetEmulatedNBits());
+        SetSinglePrecision(master.GetSinglePrecision());
 
         return true;
     }
@@ -290,8 +299,27 @@ namespace Katydid
             }
         }
 
+        fVoltagesFloat.clear();
+        if (fSinglePrecision)
+        {
+            fVoltagesFloat.assign(fVoltages.begin(), fVoltages.end());
+        }
+
         // setting the convert function
-        if (fTimeSeriesType == kFFTWTimeSeries)
+        if (fSinglePrecision)
+        {
+            if (fTimeSeriesType == kFFTWTimeSeries)
+            {
+                KTDEBUG(egglog_scdac, "Convert function set to --> single-precision complex");
+                fConvertTSFunc = &KTSingleChannelDAC::ConvertToComplexFloat;
+            }
+            else //(fTimeSeriesType == kRealTimeSeries)
+            {
+                KTDEBUG(egglog_scdac, "Convert function set to --> single-precision real");
+                fConvertTSFunc = &KTSingleChannelDAC::ConvertToRealFloat;
+            }
+        }
+        else if (fTimeSeriesType == kFFTWTimeSeries)
         {
             if (fBitDepthMode != kIncreasing)
             {
@@ -354,6 +382,160 @@ namespace Katydid
         return true;
     }
 
+    KTTimeSeries* KTSingleChannelDAC::DoConvertToFFTWWithKernel(const KTRawTimeSeries& ts, int64_t levelOffset)
+    {
+        KTDEBUG(egglog_scdac, "Converting raw-ts to ts-fftw with the whole-buffer kernel");
+
+        if (fShouldRunInitialize)
+        {
+            if (! Initialize())
+            {
+                KTERROR(egglog_scdac, "Failed to initialize single-channel DAC");
+                return NULL;
+            }
+        }
+
+        // ts.size() is divided by 2 because we have complex samples, and the raw time series sees each sample as 2 bins
+        unsigned nBins = ts.size() / 2;
+        KTTimeSeriesFFTW* newTS = KTTimeSeriesFFTW::Acquire(nBins, ts.GetRangeMin(), ts.GetRangeMax());
+        // fftw_complex is double[2], so the FFTW storage is the interleaved real and imaginary parts, just like the raw data
+        RunKernel(ts, levelOffset, nBins, 2, 1, fVoltages, reinterpret_cast< double* >(newTS->GetData()));
+        return newTS;
+    }
+
+    KTTimeSeries* KTSingleChannelDAC::DoConvertToRealWithKernel(const KTRawTimeSeries& ts, int64_t levelOffset)
+    {
+        KTDEBUG(egglog_scdac, "Converting raw-ts to ts-real with the whole-buffer kernel");
+
+        if (fShouldRunInitialize)
+        {
+            if (! Initialize())
+            {
+                KTERROR(egglog_scdac, "Failed to initialize single-channel DAC");
+                return NULL;
+            }
+        }
+
+        unsigned nBins = ts.size();
+        KTTimeSeriesReal* newTS = KTTimeSeriesReal::Acquire(nBins, ts.GetRangeMin(), ts.GetRangeMax());
+        RunKernel(ts, levelOffset, nBins, 1, 1, fVoltages, newTS->GetData());
+        return newTS;
+    }
+
+    KTTimeSeries* KTSingleChannelDAC::DoConvertToFFTWOversampledWithKernel(const KTRawTimeSeries& ts, int64_t levelOffset)
+    {
+        KTDEBUG(egglog_scdac, "Converting raw-ts to ts-fftw with oversampling with the whole-buffer kernel");
+
+        if (fShouldRunInitialize)
+        {
+            if (! Initialize())
+            {
+                KTERROR(egglog_scdac, "Failed to initialize single-channel DAC");
+                return NULL;
+            }
+        }
+
+        unsigned nBins = ts.size() / 2 / fOversamplingBins;
+        KTTimeSeriesFFTW* newTS = KTTimeSeriesFFTW::Acquire(nBins, ts.GetRangeMin(), ts.GetRangeMax());
+        RunKernel(ts, levelOffset, nBins, 2, fOversamplingBins, fVoltages, reinterpret_cast< double* >(newTS->GetData()));
+#ifndef NDEBUG
+        if (nBins * fOversamplingBins != ts.size() / 2)
+        {
+            KTWARN(egglog_scdac, "Data lost upon oversampling: " << ts.size() / 2 - nBins * fOversamplingBins << " samples");
+        }
+#endif
+        return newTS;
+    }
+
+    KTTimeSeries* KTSingleChannelDAC::DoConvertToRealOversampledWithKernel(const KTRawTimeSeries& ts, int64_t levelOffset)
+    {
+        KTDEBUG(egglog_scdac, "Converting raw-ts to ts-real with oversampling with the whole-buffer kernel");
+
+        if (fShouldRunInitialize)
+        {
+            if (! Initialize())
+            {
+                KTERROR(egglog_scdac, "Failed to initialize single-channel DAC");
+                return NULL;
+            }
+        }
+
+        unsigned nBins = ts.size() / fOversamplingBins;
+        KTTimeSeriesReal* newTS = KTTimeSeriesReal::Acquire(nBins, ts.GetRangeMin(), ts.GetRangeMax());
+        RunKernel(ts, levelOffset, nBins, 1, fOversamplingBins, fVoltages, newTS->GetData());
+#ifndef NDEBUG
+        if (nBins * fOversamplingBins != ts.size())
+        {
+            KTWARN(egglog_scdac, "Data lost upon oversampling: " << ts.size() - nBins * fOversamplingBins << " samples");
+        }
+#endif
+        return newTS;
+    }
+
+    KTTimeSeries* KTSingleChannelDAC::ConvertToRealFloat(KTRawTimeSeries* ts)
+    {
+        KTDEBUG(egglog_scdac, "Converting raw-ts to single-precision real ts");
+
+        if (fShouldRunInitialize)
+        {
+            if (! Initialize())
+            {
+                KTERROR(egglog_scdac, "Failed to initialize single-channel DAC");
+                return NULL;
+            }
+        }
+
+        unsigned nBins = ts->size() / fOversamplingBins;
+        KTTimeSeriesRealFloat* newTS = KTTimeSeriesRealFloat::Acquire(nBins, ts->GetRangeMin(), ts->GetRangeMax());
+        ConvertToFloat(*ts, nBins, 1, newTS->GetData());
+        return newTS;
+    }
+
+    KTTimeSeries* KTSingleChannelDAC::ConvertToComplexFloat(KTRawTimeSeries* ts)
+    {
+        KTDEBUG(egglog_scdac, "Converting raw-ts to single-precision complex ts");
+
+        if (fShouldRunInitialize)
+        {
+            if (! Initialize())
+            {
+                KTERROR(egglog_scdac, "Failed to initialize single-channel DAC");
+                return NULL;
+            }
+        }
+
+        // ts.size() is divided by 2 because we have complex samples, and the raw time series sees each sample as 2 bins
+        unsigned nBins = ts->size() / 2 / fOversamplingBins;
+        KTTimeSeriesComplexFloat* newTS = KTTimeSeriesComplexFloat::Acquire(nBins, ts->GetRangeMin(), ts->GetRangeMax());
+        // std::complex< float > is float[2], so the storage is the interleaved real and imaginary parts, just like the raw data
+        ConvertToFloat(*ts, nBins, 2, reinterpret_cast< float* >(newTS->GetData()));
+        return newTS;
+    }
+
+    void KTSingleChannelDAC::ConvertToFloat(const KTRawTimeSeries& ts, unsigned nOutput, unsigned nComponents, float* output)
+    {
+#ifndef NDEBUG
+        if (nOutput * nComponents * fOversamplingBins != ts.size())
+        {
+            KTWARN(egglog_scdac, "Data lost upon oversampling: " << ts.size() - nOutput * nComponents * fOversamplingBins << " samples");
+        }
+#endif
+        int64_t levelOffset = fDigitizedDataFormat == sDigitizedS ? fIntLevelOffset : 0;
+        if (HasKernel(ts))
+        {
+            RunKernel(ts, levelOffset, nOutput, nComponents, fOversamplingBins, fVoltagesFloat, output);
+        }
+        else if (fDigitizedDataFormat == sDigitizedS)
+        {
+            DoConvertToFloat(KTVarTypePhysicalArray< int64_t >(ts, false), nOutput, nComponents, output);
+        }
+        else
+        {
+            DoConvertToFloat(ts, nOutput, nComponents, output);
+        }
+        return;
+    }
+
     bool KTSingleChannelDAC::SetEmulatedNBits(unsigned nBits)
     {
         if (nBits == fNBits)
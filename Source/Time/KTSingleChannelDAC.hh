@@ -15,8 +15,10 @@
 #include "KTLogger.hh"
 #include "KTMemberVariable.hh"
 #include "KTRawTimeSeries.hh"
+#include "KTTimeSeriesComplexFloat.hh"
 #include "KTTimeSeriesFFTW.hh"
 #include "KTTimeSeriesReal.hh"
+#include "KTTimeSeriesRealFloat.hh"
 
 #include <vector>
 
@@ -31,6 +33,29 @@ namespace Katydid
 
 
 
+    /*!
+     @class KTSingleChannelDAC
+     @author N.S. Oblath
+
+     @brief Digital-to-analog conversion for a single channel
+
+     @details
+     Raw samples are converted to voltages with a lookup table (fVoltages) that's filled in Initialize().
+
+     For 1- and 2-byte raw data, the conversion is done by a kernel that works over the whole raw buffer at once:
+     the raw storage is read directly as its native integer type, and the voltages are written directly into the
+     output time series storage.  The loops have no branches and no per-sample function-pointer calls, so the compiler
+     can vectorize them (the table lookup becomes a gather instruction where the architecture supports it).
+     Other data type sizes use the generic per-sample conversion through the KTVarTypePhysicalArray interface.
+     Both paths give identical results.
+
+     In single-precision mode (SetSinglePrecision(true), or "single-precision" in the configuration) the output time series are
+     KTTimeSeriesRealFloat or KTTimeSeriesComplexFloat instead of KTTimeSeriesReal or KTTimeSeriesFFTW.
+     The voltages are the double-precision voltages rounded to float, and the same kernels are used with a float lookup table,
+     so the conversion reads half as much table and writes half as much output.
+     When oversampling, the rounded voltages are summed in double precision, and the scaled sum is rounded.
+     Single-precision time series are meant for processors that have a float path (e.g. KTWindowedFFTPower); check before using them elsewhere.
+    */
     class KTSingleChannelDAC //: public Nymph::KTProcessor
     {
         public:
@@ -67,6 +92,8 @@ namespace Katydid
 
             bool SetEmulatedNBits(unsigned nBits);
 
+            void SetSinglePrecision(bool flag);
+
             MEMBERVARIABLE_NOSET(unsigned, DataTypeSize);
             MEMBERVARIABLE_NOSET(unsigned, NBits);
             MEMBERVARIABLE_NOSET(double, VoltageOffset);
@@ -77,6 +104,7 @@ namespace Katydid
             MEMBERVARIABLE_NOSET(BitDepthMode, BitDepthMode);
             MEMBERVARIABLE_NOSET(unsigned, EmulatedNBits);
             MEMBERVARIABLE_NOSET(unsigned, BitAlignment);
+            MEMBERVARIABLE_NOSET(bool, SinglePrecision);
 
         public:
             bool InitializeWithHeader(KTChannelHeader* header);
@@ -97,6 +125,10 @@ namespace Katydid
             KTTimeSeries* ConvertSignedToFFTWOversampled(KTRawTimeSeries* ts);
             KTTimeSeries* ConvertSignedToRealOversampled(KTRawTimeSeries* ts);
 
+            /// Single-precision conversions; these handle signed and unsigned data, with or without oversampling
+            KTTimeSeries* ConvertToRealFloat(KTRawTimeSeries* ts);
+            KTTimeSeries* ConvertToComplexFloat(KTRawTimeSeries* ts);
+
             double Convert(uint64_t level);
             double Convert(int64_t level);
 
@@ -111,9 +143,38 @@ namespace Katydid
             template< typename XInterfaceType >
             KTTimeSeries* DoConvertToRealOversampled(const KTVarTypePhysicalArray< XInterfaceType >& ts);
 
+            /// Returns true if there's a whole-buffer conversion kernel for the raw data type
+            bool HasKernel(const KTRawTimeSeries& ts) const;
+
+            /// Converts with the whole-buffer kernels; the level offset is applied to each raw value before the table lookup
+            KTTimeSeries* DoConvertToFFTWWithKernel(const KTRawTimeSeries& ts, int64_t levelOffset);
+            KTTimeSeries* DoConvertToRealWithKernel(const KTRawTimeSeries& ts, int64_t levelOffset);
+            KTTimeSeries* DoConvertToFFTWOversampledWithKernel(const KTRawTimeSeries& ts, int64_t levelOffset);
+            KTTimeSeries* DoConvertToRealOversampledWithKernel(const KTRawTimeSeries& ts, int64_t levelOffset);
+
+            /// Converts nOutput values of nComponents each into single-precision output, with the kernels if possible
+            void ConvertToFloat(const KTRawTimeSeries& ts, unsigned nOutput, unsigned nComponents, float* output);
+            /// Per-sample single-precision conversion for raw data types that don't have a kernel
+            template< typename XInterfaceType >
+            void DoConvertToFloat(const KTVarTypePhysicalArray< XInterfaceType >& ts, unsigned nOutput, unsigned nComponents, float* output);
+
+            /// Selects the kernel for the raw data type and converts nSamples into output, using the given voltage table
+            /// nComponents is 1 for real data, and 2 for interleaved complex data
+            template< typename XValueType >
+            void RunKernel(const KTRawTimeSeries& ts, int64_t levelOffset, unsigned nOutput, unsigned nComponents, unsigned nOversamplingBins, const std::vector< XValueType >& voltageTable, XValueType* output) const;
+
+            /// Conversion kernel: output[i] = voltages[raw[i]]
+            template< typename XRawType, typename XValueType >
+            static void ConvertKernel(const XRawType* raw, unsigned nSamples, const XValueType* voltages, XValueType* output);
+            /// Oversampling conversion kernel: each output value is the scaled sum of nOversamplingBins consecutive samples of the same component
+            template< typename XRawType, typename XValueType >
+            static void ConvertOversampledKernel(const XRawType* raw, unsigned nOutput, unsigned nComponents, unsigned nOversamplingBins, double scale, const XValueType* voltages, XValueType* output);
+
             bool fShouldRunInitialize;
 
             std::vector< double > fVoltages;
+            /// fVoltages rounded to single precision; only filled in single-precision mode
+            std::vector< float > fVoltagesFloat;
             int64_t fIntLevelOffset;
 
             KTTimeSeries* (KTSingleChannelDAC::*fConvertTSFunc)(KTRawTimeSeries*);
@@ -142,41 +203,49 @@ namespace Katydid
 
     inline KTTimeSeries* KTSingleChannelDAC::ConvertUnsignedToFFTW(KTRawTimeSeries* ts)
     {
+        if (HasKernel(*ts)) return DoConvertToFFTWWithKernel(*ts, 0);
         return DoConvertToFFTW(*ts);
     }
 
     inline KTTimeSeries* KTSingleChannelDAC::ConvertUnsignedToReal(KTRawTimeSeries* ts)
     {
+        if (HasKernel(*ts)) return DoConvertToRealWithKernel(*ts, 0);
         return DoConvertToReal(*ts);
     }
 
     inline KTTimeSeries* KTSingleChannelDAC::ConvertSignedToFFTW(KTRawTimeSeries* ts)
     {
+        if (HasKernel(*ts)) return DoConvertToFFTWWithKernel(*ts, fIntLevelOffset);
         return DoConvertToFFTW(KTVarTypePhysicalArray< int64_t >(*ts, false));
     }
 
     inline KTTimeSeries* KTSingleChannelDAC::ConvertSignedToReal(KTRawTimeSeries* ts)
     {
+        if (HasKernel(*ts)) return DoConvertToRealWithKernel(*ts, fIntLevelOffset);
         return DoConvertToReal(KTVarTypePhysicalArray< int64_t >(*ts, false));
     }
 
     inline KTTimeSeries* KTSingleChannelDAC::ConvertUnsignedToFFTWOversampled(KTRawTimeSeries* ts)
     {
+        if (HasKernel(*ts)) return DoConvertToFFTWOversampledWithKernel(*ts, 0);
         return DoConvertToFFTWOversampled(*ts);
     }
 
     inline KTTimeSeries* KTSingleChannelDAC::ConvertUnsignedToRealOversampled(KTRawTimeSeries* ts)
     {
+        if (HasKernel(*ts)) return DoConvertToRealOversampledWithKernel(*ts, 0);
         return DoConvertToRealOversampled(*ts);
     }
 
     inline KTTimeSeries* KTSingleChannelDAC::ConvertSignedToFFTWOversampled(KTRawTimeSeries* ts)
     {
+        if (HasKernel(*ts)) return DoConvertToFFTWOversampledWithKernel(*ts, fIntLevelOffset);
         return DoConvertToFFTWOversampled(KTVarTypePhysicalArray< int64_t >(*ts, false));
     }
 
     inline KTTimeSeries* KTSingleChannelDAC::ConvertSignedToRealOversampled(KTRawTimeSeries* ts)
     {
+        if (HasKernel(*ts)) return DoConvertToRealOversampledWithKernel(*ts, fIntLevelOffset);
         return DoConvertToRealOversampled(KTVarTypePhysicalArray< int64_t >(*ts, false));
     }
 
@@ -187,6 +256,39 @@ namespace Katydid
         return;
     }
 
+    inline void KTSingleChannelDAC::SetSinglePrecision(bool flag)
+    {
+        fSinglePrecision = flag;
+        fShouldRunInitialize = true;
+        return;
+    }
+
+    template< typename XInterfaceType >
+    void KTSingleChannelDAC::DoConvertToFloat(const KTVarTypePhysicalArray< XInterfaceType >& ts, unsigned nOutput, unsigned nComponents, float* output)
+    {
+        // the rounded voltages are summed in the same order as in the oversampling kernel so that the results are identical
+        unsigned blockSize = nComponents * fOversamplingBins;
+        for (unsigned iOutput = 0; iOutput < nOutput; ++iOutput)
+        {
+            unsigned blockStart = iOutput * blockSize;
+            for (unsigned iComp = 0; iComp < nComponents; ++iComp)
+            {
+                if (fOversamplingBins == 1)
+                {
+                    output[iOutput * nComponents + iComp] = Convert(ts(blockStart + iComp));
+                    continue;
+                }
+                double sum = 0.;
+                for (unsigned iOSBin = 0; iOSBin < fOversamplingBins; ++iOSBin)
+                {
+                    sum += float(Convert(ts(blockStart + iOSBin * nComponents + iComp)));
+                }
+                output[iOutput * nComponents + iComp] = sum * fOversamplingScaleFactor;
+            }
+        }
+        return;
+    }
+
     template< typename XInterfaceType >
     KTTimeSeries* KTSingleChannelDAC::DoConvertToFFTW(const KTVarTypePhysicalArray< XInterfaceType >& ts)
     {
@@ -203,7 +305,7 @@ namespace Katydid
 
         // ts.size() is divided by 2 because we have complex samples, and the raw time series sees each sample as 2 bins
         unsigned nBins = ts.size() / 2;
-        KTTimeSeriesFFTW* newTS = new KTTimeSeriesFFTW(nBins, ts.GetRangeMin(), ts.GetRangeMax());
+        KTTimeSeriesFFTW* newTS = KTTimeSeriesFFTW::Acquire(nBins, ts.GetRangeMin(), ts.GetRangeMax());
         for (unsigned bin = 0; bin < nBins; ++bin)
         {
             (*newTS)(bin)[0] = Convert(ts(2 * bin));
@@ -227,7 +329,7 @@ namespace Katydid
         }
 
         unsigned nBins = ts.size();
-        KTTimeSeriesReal* newTS = new KTTimeSeriesReal(nBins, ts.GetRangeMin(), ts.GetRangeMax());
+        KTTimeSeriesReal* newTS = KTTimeSeriesReal::Acquire(nBins, ts.GetRangeMin(), ts.GetRangeMax());
         for (unsigned bin = 0; bin < nBins; ++bin)
         {
             (*newTS)(bin) = Convert((ts)(bin));
@@ -263,7 +365,7 @@ namespace Katydid
 
         // ts.size() is divided by 2 because we have complex samples, and the raw time series sees each sample as 2 bins
         unsigned nBins = ts.size() / 2 / fOversamplingBins;
-        KTTimeSeriesFFTW* newTS = new KTTimeSeriesFFTW(nBins, ts.GetRangeMin(), ts.GetRangeMax());
+        KTTimeSeriesFFTW* newTS = KTTimeSeriesFFTW::Acquire(nBins, ts.GetRangeMin(), ts.GetRangeMax());
         double avgValueReal = 0., avgValueImag = 0.;
         unsigned bin = 0;
         for (unsigned oversampledBin = 0; oversampledBin < nBins; ++oversampledBin)
@@ -303,7 +405,7 @@ namespace Katydid
         }
 
         unsigned nBins = ts.size() / fOversamplingBins;
-        KTTimeSeriesReal* newTS = new KTTimeSeriesReal(nBins, ts.GetRangeMin(), ts.GetRangeMax());
+        KTTimeSeriesReal* newTS = KTTimeSeriesReal::Acquire(nBins, ts.GetRangeMin(), ts.GetRangeMax());
         double avgValue;
         unsigned bin = 0;
         for (unsigned oversampledBin = 0; oversampledBin < nBins; ++oversampledBin)
@@ -327,6 +429,84 @@ namespace Katydid
 
 
 
+    inline bool KTSingleChannelDAC::HasKernel(const KTRawTimeSeries& ts) const
+    {
+        return (ts.GetDataTypeSize() == 1 || ts.GetDataTypeSize() == 2) &&
+                (ts.GetDataFormat() == sDigitizedUS || ts.GetDataFormat() == sDigitizedS);
+    }
+
+    template< typename XValueType >
+    void KTSingleChannelDAC::RunKernel(const KTRawTimeSeries& ts, int64_t levelOffset, unsigned nOutput, unsigned nComponents, unsigned nOversamplingBins, const std::vector< XValueType >& voltageTable, XValueType* output) const
+    {
+        // shifting the table pointer by the level offset lets the kernels index it directly with the raw values
+        const XValueType* voltages = voltageTable.data() + levelOffset;
+        const uint8_t* storage = ts.GetStorage();
+        bool isSigned = ts.GetDataFormat() == sDigitizedS;
+
+        if (nOversamplingBins == 1)
+        {
+            unsigned nSamples = nOutput * nComponents;
+            if (ts.GetDataTypeSize() == 1)
+            {
+                if (isSigned) ConvertKernel(reinterpret_cast< const int8_t* >(storage), nSamples, voltages, output);
+                else ConvertKernel(reinterpret_cast< const uint8_t* >(storage), nSamples, voltages, output);
+            }
+            else
+            {
+                if (isSigned) ConvertKernel(reinterpret_cast< const int16_t* >(storage), nSamples, voltages, output);
+                else ConvertKernel(reinterpret_cast< const uint16_t* >(storage), nSamples, voltages, output);
+            }
+        }
+        else
+        {
+            if (ts.GetDataTypeSize() == 1)
+            {
+                if (isSigned) ConvertOversampledKernel(reinterpret_cast< const int8_t* >(storage), nOutput, nComponents, nOversamplingBins, fOversamplingScaleFactor, voltages, output);
+                else ConvertOversampledKernel(reinterpret_cast< const uint8_t* >(storage), nOutput, nComponents, nOversamplingBins, fOversamplingScaleFactor, voltages, output);
+            }
+            else
+            {
+                if (isSigned) ConvertOversampledKernel(reinterpret_cast< const int16_t* >(storage), nOutput, nComponents, nOversamplingBins, fOversamplingScaleFactor, voltages, output);
+                else ConvertOversampledKernel(reinterpret_cast< const uint16_t* >(storage), nOutput, nComponents, nOversamplingBins, fOversamplingScaleFactor, voltages, output);
+            }
+        }
+        return;
+    }
+
+    template< typename XRawType, typename XValueType >
+    void KTSingleChannelDAC::ConvertKernel(const XRawType* raw, unsigned nSamples, const XValueType* voltages, XValueType* output)
+    {
+#ifdef USE_OPENMP
+        #pragma omp simd
+#endif
+        for (unsigned iSample = 0; iSample < nSamples; ++iSample)
+        {
+            output[iSample] = voltages[raw[iSample]];
+        }
+        return;
+    }
+
+    template< typename XRawType, typename XValueType >
+    void KTSingleChannelDAC::ConvertOversampledKernel(const XRawType* raw, unsigned nOutput, unsigned nComponents, unsigned nOversamplingBins, double scale, const XValueType* voltages, XValueType* output)
+    {
+        // the samples are summed in the same order as the per-sample conversion so that the results are identical
+        unsigned blockSize = nComponents * nOversamplingBins;
+        for (unsigned iOutput = 0; iOutput < nOutput; ++iOutput)
+        {
+            const XRawType* block = raw + iOutput * blockSize;
+            for (unsigned iComp = 0; iComp < nComponents; ++iComp)
+            {
+                double sum = 0.;
+                for (unsigned iOSBin = 0; iOSBin < nOversamplingBins; ++iOSBin)
+                {
+                    sum += voltages[block[iOSBin * nComponents + iComp]];
+                }
+                output[iOutput * nComponents + iComp] = sum * scale;
+            }
+        }
+        return;
+    }
+
     inline double KTSingleChannelDAC::Convert(uint64_t level)
     {
         return fVoltages[level];
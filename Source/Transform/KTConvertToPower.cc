@@ -114,7 +114,13 @@ namespace Katydid
         psData.SetActiveRadius(activeRadius);
         for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
         {
-            KTPowerSpectrum* spectrum = data.GetSpectrum(iComponent)->CreatePowerSpectrum();
+            const KTFrequencySpectrum* fs = data.GetSpectrum(iComponent);
+            if (fs == NULL)
+            {
+                KTERROR(pslog, "Grid point " << iComponent << " has no spectrum; the channel aggregator has to be run with \"store-spectra\" set to true");
+                return false;
+            }
+            KTPowerSpectrum* spectrum = fs->CreatePowerSpectrum();
             spectrum->ConvertToPowerSpectrum();
             psData.SetSpectrum(spectrum, iComponent);
             double gridLocationX, gridLocationY;
@@ -133,7 +139,13 @@ namespace Katydid
         psData.SetActiveRadius(activeRadius);
         for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
         {
-            KTPowerSpectrum* spectrum = data.GetSpectrum(iComponent)->CreatePowerSpectrum();
+            const KTFrequencySpectrum* fs = data.GetSpectrum(iComponent);
+            if (fs == NULL)
+            {
+                KTERROR(pslog, "Grid point " << iComponent << " has no spectrum; the channel aggregator has to be run with \"store-spectra\" set to true");
+                return false;
+            }
+            KTPowerSpectrum* spectrum = fs->CreatePowerSpectrum();
             spectrum->ConvertToPowerSpectralDensity();
             psData.SetSpectrum(spectrum, iComponent);
             double gridLocationX, gridLocationY;
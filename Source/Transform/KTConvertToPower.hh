@@ -40,8 +40,8 @@ namespace Katydid
      - "fs-polar-to-psd": void (Nymph::KTDataPtr) -- Converts a polar FS to a PSD; Requires KTFrequencySpectrumDataPolar; Adds KTPowerSpectrumData; Emits signal "psd"
      - "fs-fftw-to-ps": void (Nymph::KTDataPtr) -- Converts an FFTW FS to a PS; Requires KTFrequencySpectrumDataFFTW; Adds KTPowerSpectrumData; Emits signal "ps"
      - "fs-fftw-to-psd": void (Nymph::KTDataPtr) -- Converts an FFTW FS to a PSD; Requires KTFrequencySpectrumDataFFTW; Adds KTPowerSpectrumData; Emits signal "psd"
-     - "aggfs-fftw-to-ps": void (Nymph::KTDataPtr) -- Converts an aggregated FFTW FS to a PS; Requires KTAggregatedFrequencySpectrumDataFFTW; Adds KTPowerSpectrumData; Emits signal "ps"
-     - "aggfs-fftw-to-psd": void (Nymph::KTDataPtr) -- Converts an FFTW FS to a PSD; Requires KTAggregatedFrequencySpectrumDataFFTW; Adds KTPowerSpectrumData; Emits signal "psd"
+     - "aggfs-fftw-to-ps": void (Nymph::KTDataPtr) -- Converts an aggregated FFTW FS to a PS; Requires KTAggregatedFrequencySpectrumDataFFTW with its spectra (see KTChannelAggregator "store-spectra"); Adds KTPowerSpectrumData; Emits signal "ps"
+     - "aggfs-fftw-to-psd": void (Nymph::KTDataPtr) -- Converts an FFTW FS to a PSD; Requires KTAggregatedFrequencySpectrumDataFFTW with its spectra (see KTChannelAggregator "store-spectra"); Adds KTPowerSpectrumData; Emits signal "psd"
      - "psd-to-ps": void (Nymph::KTDataPtr) -- Converts a PSD to a PS (in place); Requires KTPowerSpectrumData; Does not add additional data; Emits signal "ps"
      - "ps-to-psd": void (Nymph::KTDataPtr) -- Converts a PS to a PSD (in place); Requires KTPowerSpectrumData; Does not add additional data; Emits signal "psd"
 
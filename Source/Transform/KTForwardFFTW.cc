@@ -12,9 +12,11 @@
 #include "KTEggHeader.hh"
 #include "KTFrequencySpectrumDataFFTW.hh"
 #include "KTLogger.hh"
+#include "KTTimeSeriesComplexFloat.hh"
 #include "KTTimeSeriesData.hh"
 #include "KTTimeSeriesFFTW.hh"
 #include "KTTimeSeriesReal.hh"
+#include "KTTimeSeriesRealFloat.hh"
 
 #include <algorithm>
 #include <cmath>
@@ -34,17 +36,36 @@ namespace Katydid
             KTProcessor(name),
             fUseWisdom(true),
             fWisdomFilename("wisdom_complexfft.fftw3"),
+            fSPWisdomFilename("wisdom_complexfft_float.fftw3"),
             fComplexAsIQ(false),
+            fBatchComponents(false),
             fTimeSize(0),
             fFrequencySize(0),
             fTransformFlag("ESTIMATE"),
             fTransformFlagMap(),
             fState(kNone),
             fIsInitialized(false),
+            fBatchPlan(NULL),
+            fBatchSize(0),
+            fBatchState(kNone),
+            fRBatchInputArray(NULL),
+            fCBatchInputArray(NULL),
+            fBatchOutputArray(NULL),
+            fTimeBinWidthCache(-1.),
+            fFreqMinCache(0.),
+            fFreqMaxCache(0.),
             fForwardPlan(),
             fRInputArray(NULL),
             fCInputArray(NULL),
             fOutputArray(NULL),
+#ifdef FFTWF_FOUND
+            fSPPlan(NULL),
+            fSPState(kNone),
+            fSPTimeSize(0),
+            fRSPInputArray(NULL),
+            fCSPInputArray(NULL),
+            fSPOutputArray(NULL),
+#endif
             fFFTSignal("fft", this),
             fHeaderSlot("header", this, &KTForwardFFTW::InitializeWithHeader),
             fTSRealSlot("ts-real", this, &KTForwardFFTW::TransformRealData, &fFFTSignal),
@@ -57,6 +78,10 @@ namespace Katydid
 
     KTForwardFFTW::~KTForwardFFTW()
     {
+        FreeBatch();
+#ifdef FFTWF_FOUND
+        FreeSinglePrecision();
+#endif
         FreeArrays();
         if (fForwardPlan != NULL) fftw_destroy_plan(fForwardPlan);
     }
@@ -70,9 +95,12 @@ namespace Katydid
 
             SetUseWisdom(node->get_value<bool>("use-wisdom", fUseWisdom));
             SetWisdomFilename(node->get_value("wisdom-filename", fWisdomFilename));
+            SetSPWisdomFilename(node->get_value("single-precision-wisdom-filename", fSPWisdomFilename));
 
             SetComplexAsIQ(node->get_value("transform-complex-as-iq", fComplexAsIQ));
 
+            SetBatchComponents(node->get_value< bool >("batch-components", fBatchComponents));
+
             if( node->has("transform-state") )
             {
                 string intendedState(node->get_value("transform-state"));
@@ -161,6 +189,12 @@ namespace Katydid
 
         InitializeMultithreaded();
 
+        // any batched or single-precision plan was made for the previous state and size
+        FreeBatch();
+#ifdef FFTWF_FOUND
+        FreeSinglePrecision();
+#endif
+
         if (intendedState == kR2C)
         {
             KTDEBUG(fftwlog, "Creating R2C plan: " << fTimeSize << " time bins; forward FFT");
@@ -178,7 +212,10 @@ namespace Katydid
             // Add FFTW_PRESERVE_INPUT so that the input array content is not destroyed during the FFT
             fForwardPlan = fftw_plan_dft_1d(fTimeSize, fCInputArray, fOutputArray, FFTW_FORWARD, transformFlag | FFTW_PRESERVE_INPUT);
             // deleting arrays to save space
-            FreeArrays();
+            // input array is kept for windowed transforms; output array is not needed
+            KTDEBUG(fftwlog, "Freeing output array");
+            fftw_free(fOutputArray);
+            fOutputArray = NULL;
         }
         else // intendedState == kRasC2C
         {
@@ -212,6 +249,8 @@ namespace Katydid
         }
 
         fState = intendedState;
+        // the frequency binning depends on the state and the size, so it has to be recalculated for the next transform
+        fTimeBinWidthCache = -1.;
         return true;
     }
 
@@ -264,6 +303,11 @@ namespace Katydid
 
         KTFrequencySpectrumDataFFTW& newData = tsData.Of< KTFrequencySpectrumDataFFTW >().SetNComponents(nComponents);
 
+        if (fBatchComponents && nComponents > 1)
+        {
+            return BatchTransform(tsData, newData);
+        }
+
         for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
         {
             const KTTimeSeriesReal* nextInput = dynamic_cast< const KTTimeSeriesReal* >(tsData.GetTimeSeries(iComponent));
@@ -316,6 +360,11 @@ namespace Katydid
 
         KTFrequencySpectrumDataFFTW& newData = tsData.Of< KTFrequencySpectrumDataFFTW >().SetNComponents(nComponents);
 
+        if (fBatchComponents && nComponents > 1)
+        {
+            return BatchTransform(tsData, newData);
+        }
+
         for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
         {
             const KTTimeSeriesReal* nextInput = dynamic_cast< const KTTimeSeriesReal* >(tsData.GetTimeSeries(iComponent));
@@ -368,6 +417,11 @@ namespace Katydid
 
         KTFrequencySpectrumDataFFTW& newData = tsData.Of< KTFrequencySpectrumDataFFTW >().SetNComponents(nComponents);
 
+        if (fBatchComponents && nComponents > 1)
+        {
+            return BatchTransform(tsData, newData);
+        }
+
         for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
         {
             const KTTimeSeriesFFTW* nextInput = dynamic_cast< const KTTimeSeriesFFTW* >(tsData.GetTimeSeries(iComponent));
@@ -420,6 +474,11 @@ namespace Katydid
 
         KTFrequencySpectrumDataFFTW& newData = tsData.Of< KTFrequencySpectrumDataFFTW >().SetNComponents(nComponents);
 
+        if (fBatchComponents && nComponents > 1)
+        {
+            return BatchTransform(tsData, newData);
+        }
+
         for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
         {
             const KTTimeSeriesFFTW* nextInput = dynamic_cast< const KTTimeSeriesFFTW* >(tsData.GetTimeSeries(iComponent));
@@ -461,7 +520,7 @@ namespace Katydid
 
     KTFrequencySpectrumFFTW* KTForwardFFTW::FastTransform(const KTTimeSeriesReal* ts) const
     {
-        KTFrequencySpectrumFFTW* newFS = new KTFrequencySpectrumFFTW(fFrequencySize, fFreqMinCache, fFreqMaxCache, false);
+        KTFrequencySpectrumFFTW* newFS = KTFrequencySpectrumFFTW::Acquire(fFrequencySize, fFreqMinCache, fFreqMaxCache, false);
 
         DoTransform(ts, newFS);
 
@@ -494,7 +553,7 @@ namespace Katydid
 
     KTFrequencySpectrumFFTW* KTForwardFFTW::FastTransformAsComplex(const KTTimeSeriesReal* ts) const
     {
-        KTFrequencySpectrumFFTW* newFS = new KTFrequencySpectrumFFTW(fFrequencySize, fFreqMinCache, fFreqMaxCache, true);
+        KTFrequencySpectrumFFTW* newFS = KTFrequencySpectrumFFTW::Acquire(fFrequencySize, fFreqMinCache, fFreqMaxCache, true);
 
         DoTransformAsComplex(ts, newFS);
 
@@ -531,7 +590,7 @@ namespace Katydid
 
     KTFrequencySpectrumFFTW* KTForwardFFTW::FastTransform(const KTTimeSeriesFFTW* ts) const
     {
-        KTFrequencySpectrumFFTW* newFS = new KTFrequencySpectrumFFTW(fFrequencySize, fFreqMinCache, fFreqMaxCache, true);
+        KTFrequencySpectrumFFTW* newFS = KTFrequencySpectrumFFTW::Acquire(fFrequencySize, fFreqMinCache, fFreqMaxCache, true);
 
         DoTransform(ts, newFS);
 
@@ -547,6 +606,324 @@ namespace Katydid
         return;
     }
 
+    void KTForwardFFTW::DoWindowedTransform(const KTTimeSeriesReal* tsIn, const double* weights, KTFrequencySpectrumFFTW* fsOut) const
+    {
+        const double* input = tsIn->GetData();
+        for (unsigned iBin = 0; iBin < fTimeSize; ++iBin)
+        {
+            fRInputArray[iBin] = input[iBin] * weights[iBin];
+        }
+        fftw_execute_dft_r2c(fForwardPlan, fRInputArray, fsOut->GetData());
+        return;
+    }
+
+    void KTForwardFFTW::DoWindowedTransform(const KTTimeSeriesFFTW* tsIn, const double* weights, KTFrequencySpectrumFFTW* fsOut) const
+    {
+        const fftw_complex* input = tsIn->GetData();
+        for (unsigned iBin = 0; iBin < fTimeSize; ++iBin)
+        {
+            fCInputArray[iBin][0] = input[iBin][0] * weights[iBin];
+            fCInputArray[iBin][1] = input[iBin][1] * weights[iBin];
+        }
+        fftw_execute_dft(fForwardPlan, fCInputArray, fsOut->GetData());
+        return;
+    }
+
+    bool KTForwardFFTW::BatchTransform(KTTimeSeriesDataCore& tsData, KTFrequencySpectrumDataFFTW& newData)
+    {
+        unsigned nComponents = tsData.GetNComponents();
+
+        if (fBatchPlan == NULL || fBatchSize != nComponents || fBatchState != fState)
+        {
+            if (! InitializeBatch(nComponents))
+            {
+                KTERROR(fftwlog, "Unable to initialize the batched FFT for " << nComponents << " components");
+                return false;
+            }
+        }
+
+        // every component is copied into a slot of fTimeSize bins, so they all have to be that size
+        for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
+        {
+            if (tsData.GetTimeSeries(iComponent)->GetNTimeBins() != fTimeSize)
+            {
+                KTERROR(fftwlog, "Time series for component " << iComponent << " has the wrong size: " << tsData.GetTimeSeries(iComponent)->GetNTimeBins() << " time bins (expected " << fTimeSize << ")");
+                return false;
+            }
+        }
+
+        // copy the components into the contiguous input array
+        for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
+        {
+            if (fState == kC2C)
+            {
+                const KTTimeSeriesFFTW* nextInput = dynamic_cast< const KTTimeSeriesFFTW* >(tsData.GetTimeSeries(iComponent));
+                if (nextInput == NULL)
+                {
+                    KTERROR(fftwlog, "Incorrect time series type: time series did not cast to KTTimeSeriesFFTW.");
+                    return false;
+                }
+                std::copy(&nextInput->GetData()[0][0], &nextInput->GetData()[0][0] + 2 * fTimeSize, &fCBatchInputArray[iComponent * fTimeSize][0]);
+            }
+            else
+            {
+                const KTTimeSeriesReal* nextInput = dynamic_cast< const KTTimeSeriesReal* >(tsData.GetTimeSeries(iComponent));
+                if (nextInput == NULL)
+                {
+                    KTERROR(fftwlog, "Incorrect time series type: time series did not cast to KTTimeSeriesReal.");
+                    return false;
+                }
+                if (fState == kR2C)
+                {
+                    std::copy(nextInput->begin(), nextInput->end(), fRBatchInputArray + iComponent * fTimeSize);
+                }
+                else // fState == kRasC2C
+                {
+                    fftw_complex* componentInput = fCBatchInputArray + iComponent * fTimeSize;
+                    for (unsigned iBin = 0; iBin < fTimeSize; ++iBin)
+                    {
+                        componentInput[iBin][0] = nextInput->GetData()[iBin];
+                        componentInput[iBin][1] = 0;
+                    }
+                }
+            }
+        }
+
+        fftw_execute(fBatchPlan);
+
+        // the normalization is applied while copying each transform into its spectrum
+        double scale = GetOutputScale();
+        for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
+        {
+            KTFrequencySpectrumFFTW* nextResult = KTFrequencySpectrumFFTW::Acquire(fFrequencySize, fFreqMinCache, fFreqMaxCache, fState != kR2C);
+            const fftw_complex* componentOutput = fBatchOutputArray + iComponent * fFrequencySize;
+            fftw_complex* resultData = nextResult->GetData();
+            for (unsigned iBin = 0; iBin < fFrequencySize; ++iBin)
+            {
+                resultData[iBin][0] = componentOutput[iBin][0] * scale;
+                resultData[iBin][1] = componentOutput[iBin][1] * scale;
+            }
+            nextResult->SetNTimeBins(fTimeSize);
+            newData.SetSpectrum(nextResult, iComponent);
+        }
+
+        KTINFO(fftwlog, "Batched FFT complete; " << nComponents << " channel(s) transformed");
+
+        return true;
+    }
+
+    bool KTForwardFFTW::InitializeBatch(unsigned nComponents)
+    {
+        FreeBatch();
+
+        if (fState == kNone)
+        {
+            KTERROR(fftwlog, "Cannot initialize the batched FFT for state <" << fState << ">");
+            return false;
+        }
+
+        TransformFlagMap::const_iterator iter = fTransformFlagMap.find(fTransformFlag);
+        unsigned transformFlag = iter->second;
+
+        // import before planning so that a batched plan made in an earlier run is reused, as for the single-transform plan
+        if (fUseWisdom)
+        {
+            KTDEBUG(fftwlog, "Reading wisdom from file <" << fWisdomFilename << ">");
+            if (fftw_import_wisdom_from_filename(fWisdomFilename.c_str()) == 0)
+            {
+                KTWARN(fftwlog, "Unable to read FFTW wisdom from file <" << fWisdomFilename << ">");
+            }
+        }
+
+        int timeSize = fTimeSize;
+        KTDEBUG(fftwlog, "Allocating batched arrays for " << nComponents << " components");
+        fBatchOutputArray = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * fFrequencySize * nComponents);
+
+        // The input array contents are replaced for each FFT, so FFTW_PRESERVE_INPUT isn't needed
+        if (fState == kR2C)
+        {
+            KTDEBUG(fftwlog, "Creating batched R2C plan: " << nComponents << " x " << fTimeSize << " time bins; forward FFT");
+            fRBatchInputArray = (double*) fftw_malloc(sizeof(double) * fTimeSize * nComponents);
+            fBatchPlan = fftw_plan_many_dft_r2c(1, &timeSize, nComponents,
+                    fRBatchInputArray, NULL, 1, fTimeSize,
+                    fBatchOutputArray, NULL, 1, fFrequencySize,
+                    transformFlag);
+        }
+        else // fState == kC2C or kRasC2C
+        {
+            KTDEBUG(fftwlog, "Creating batched C2C plan: " << nComponents << " x " << fTimeSize << " time bins; forward FFT");
+            fCBatchInputArray = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * fTimeSize * nComponents);
+            fBatchPlan = fftw_plan_many_dft(1, &timeSize, nComponents,
+                    fCBatchInputArray, NULL, 1, fTimeSize,
+                    fBatchOutputArray, NULL, 1, fFrequencySize,
+                    FFTW_FORWARD, transformFlag);
+        }
+
+        if (fBatchPlan == NULL)
+        {
+            KTERROR(fftwlog, "Unable to create the batched forward FFT plan!");
+            FreeBatch();
+            return false;
+        }
+
+        if (fUseWisdom)
+        {
+            if (fftw_export_wisdom_to_filename(fWisdomFilename.c_str()) == 0)
+            {
+                KTWARN(fftwlog, "Unable to write FFTW wisdom to file <" << fWisdomFilename << ">");
+            }
+        }
+
+        fBatchSize = nComponents;
+        fBatchState = fState;
+        return true;
+    }
+
+    void KTForwardFFTW::FreeBatch()
+    {
+        if (fBatchPlan != NULL)
+        {
+            fftw_destroy_plan(fBatchPlan);
+            fBatchPlan = NULL;
+        }
+        if (fRBatchInputArray != NULL)
+        {
+            fftw_free(fRBatchInputArray);
+            fRBatchInputArray = NULL;
+        }
+        if (fCBatchInputArray != NULL)
+        {
+            fftw_free(fCBatchInputArray);
+            fCBatchInputArray = NULL;
+        }
+        if (fBatchOutputArray != NULL)
+        {
+            fftw_free(fBatchOutputArray);
+            fBatchOutputArray = NULL;
+        }
+        fBatchSize = 0;
+        fBatchState = kNone;
+        return;
+    }
+
+#ifdef FFTWF_FOUND
+    bool KTForwardFFTW::InitializeSinglePrecision()
+    {
+        FreeSinglePrecision();
+
+        if (! fIsInitialized || (fState != kR2C && fState != kC2C))
+        {
+            KTERROR(fftwlog, "Cannot initialize the single-precision FFT for state <" << fState << ">; the FFT must be initialized for R2C or C2C");
+            return false;
+        }
+
+        TransformFlagMap::const_iterator iter = fTransformFlagMap.find(fTransformFlag);
+        unsigned transformFlag = iter->second;
+
+        if (fUseWisdom)
+        {
+            KTDEBUG(fftwlog, "Reading single-precision wisdom from file <" << fSPWisdomFilename << ">");
+            if (fftwf_import_wisdom_from_filename(fSPWisdomFilename.c_str()) == 0)
+            {
+                KTWARN(fftwlog, "Unable to read single-precision FFTW wisdom from file <" << fSPWisdomFilename << ">");
+            }
+        }
+
+        KTDEBUG(fftwlog, "Allocating single-precision arrays");
+        fSPOutputArray = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * fFrequencySize);
+
+        // The input array contents are replaced for each FFT, so FFTW_PRESERVE_INPUT isn't needed
+        if (fState == kR2C)
+        {
+            KTDEBUG(fftwlog, "Creating single-precision R2C plan: " << fTimeSize << " time bins; forward FFT");
+            fRSPInputArray = (float*) fftwf_malloc(sizeof(float) * fTimeSize);
+            fSPPlan = fftwf_plan_dft_r2c_1d(fTimeSize, fRSPInputArray, fSPOutputArray, transformFlag);
+        }
+        else // fState == kC2C
+        {
+            KTDEBUG(fftwlog, "Creating single-precision C2C plan: " << fTimeSize << " time bins; forward FFT");
+            fCSPInputArray = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * fTimeSize);
+            fSPPlan = fftwf_plan_dft_1d(fTimeSize, fCSPInputArray, fSPOutputArray, FFTW_FORWARD, transformFlag);
+        }
+
+        if (fSPPlan == NULL)
+        {
+            KTERROR(fftwlog, "Unable to create the single-precision forward FFT plan!");
+            FreeSinglePrecision();
+            return false;
+        }
+
+        if (fUseWisdom)
+        {
+            if (fftwf_export_wisdom_to_filename(fSPWisdomFilename.c_str()) == 0)
+            {
+                KTWARN(fftwlog, "Unable to write single-precision FFTW wisdom to file <" << fSPWisdomFilename << ">");
+            }
+        }
+
+        fSPState = fState;
+        fSPTimeSize = fTimeSize;
+        return true;
+    }
+
+    bool KTForwardFFTW::GetIsSinglePrecisionInitialized() const
+    {
+        return fSPPlan != NULL && fSPState == fState && fSPTimeSize == fTimeSize;
+    }
+
+    void KTForwardFFTW::DoWindowedTransform(const KTTimeSeriesRealFloat* tsIn, const float* weights) const
+    {
+        const float* input = tsIn->GetData();
+        for (unsigned iBin = 0; iBin < fTimeSize; ++iBin)
+        {
+            fRSPInputArray[iBin] = input[iBin] * weights[iBin];
+        }
+        fftwf_execute(fSPPlan);
+        return;
+    }
+
+    void KTForwardFFTW::DoWindowedTransform(const KTTimeSeriesComplexFloat* tsIn, const float* weights) const
+    {
+        // std::complex< float > is float[2], the same as fftwf_complex
+        const float* input = reinterpret_cast< const float* >(tsIn->GetData());
+        float* spInput = &fCSPInputArray[0][0];
+        for (unsigned iBin = 0; iBin < fTimeSize; ++iBin)
+        {
+            spInput[2 * iBin] = input[2 * iBin] * weights[iBin];
+            spInput[2 * iBin + 1] = input[2 * iBin + 1] * weights[iBin];
+        }
+        fftwf_execute(fSPPlan);
+        return;
+    }
+
+    void KTForwardFFTW::FreeSinglePrecision()
+    {
+        if (fSPPlan != NULL)
+        {
+            fftwf_destroy_plan(fSPPlan);
+            fSPPlan = NULL;
+        }
+        if (fRSPInputArray != NULL)
+        {
+            fftwf_free(fRSPInputArray);
+            fRSPInputArray = NULL;
+        }
+        if (fCSPInputArray != NULL)
+        {
+            fftwf_free(fCSPInputArray);
+            fCSPInputArray = NULL;
+        }
+        if (fSPOutputArray != NULL)
+        {
+            fftwf_free(fSPOutputArray);
+            fSPOutputArray = NULL;
+        }
+        fSPState = kNone;
+        fSPTimeSize = 0;
+        return;
+    }
+#endif
+
     void KTForwardFFTW::SetTimeSize(unsigned nBins)
     {
         SetTimeSizeForState(nBins, fState);
@@ -572,6 +949,7 @@ namespace Katydid
 
         // clear things for good measure
         FreeArrays();
+        FreeBatch();
 
         fIsInitialized = false;
         return;
@@ -587,12 +965,19 @@ namespace Katydid
 
         // delete the plan
         if (fForwardPlan != NULL) fftw_destroy_plan(fForwardPlan);
+        FreeBatch();
 
         fTransformFlag = flag;
         fIsInitialized = false;
         return;
     }
 
+    unsigned KTForwardFFTW::GetTransformFlagValue() const
+    {
+        TransformFlagMap::const_iterator iter = fTransformFlagMap.find(fTransformFlag);
+        return iter->second;
+    }
+
     void KTForwardFFTW::SetupInternalMaps()
     {
         // transform flag map
@@ -17,6 +17,7 @@
 
 #include <fftw3.h>
 
+#include <cmath>
 #include <map>
 #include <string>
 #include <vector>
@@ -27,9 +28,13 @@ namespace Katydid
     
     class KTAnalyticAssociateData;
     class KTEggHeader;
+    class KTFrequencySpectrumDataFFTW;
     class KTFrequencySpectrumFFTW;
+    class KTTimeSeriesComplexFloat;
+    class KTTimeSeriesDataCore;
     class KTTimeSeriesFFTW;
     class KTTimeSeriesReal;
+    class KTTimeSeriesRealFloat;
 
     /*!
      @class KTForwardFFTW
@@ -65,8 +70,10 @@ namespace Katydid
      - "transform_flag": string -- flag that determines how much planning is done prior to any transforms (see below)
      - "use-wisdom": bool -- whether or not to use FFTW wisdom to improve FFT performance
      - "wisdom-filename": string -- filename for loading/saving FFTW wisdom
+     - "single-precision-wisdom-filename": string -- filename for loading/saving the wisdom for single-precision FFTW, which is kept separately from the double-precision wisdom
      - "transform-state": string -- "r2c", "c2c", or "rasc2c"; specify the transform state, regardless of the time domain type listed in the egg header; this is useful when a new time domain data type (e.g. aa) has been added to the data object and is being transformed.
      - "transform-complex-as-iq": bool -- specify whether to treat complex data as IQ: the negative frequency bins are assumed to be a continuous extension of the positive frequency bins, and the whole spectrum is shifted so that it starts at DC; this is only used if the transform state has also been specified.
+     - "batch-components": bool -- if true, all of the components of a data object are transformed with a single batched FFTW plan (default: false); see below
 
      Transform flags control how FFTW performs the FFT.
      Currently only the following "rigor" flags are available:
@@ -78,6 +85,23 @@ namespace Katydid
 
      FFTW_PRESERVE_INPUT is automatically added to the transform flag when necessary so that the input data is not destroyed.
 
+     Batched transforms:
+     When "batch-components" is enabled and a data object has more than one component (e.g. many channels for the channel aggregator),
+     the components are copied into one contiguous input array and transformed with a single fftw_plan_many_dft_r2c/fftw_plan_many_dft plan.
+     The FFT normalization is applied while the output is copied into the per-component spectra.
+     One execution of a batched plan makes better use of FFTW's SIMD codelets and threads than many small transforms.
+     The batched plan is created the first time a given number of components is transformed, and is rebuilt if that number changes.
+     Results can differ from the one-at-a-time transforms at the level of floating-point rounding, since FFTW may choose different algorithms.
+
+     Single-precision transforms:
+     If single-precision FFTW (libfftw3f) was found at build time, single-precision time series (KTTimeSeriesRealFloat and KTTimeSeriesComplexFloat)
+     can be transformed with DoWindowedTransform() after the FFT has been initialized for R2C or C2C, and InitializeSinglePrecision() has been called.
+     The window, the FFT, and the FFTW arrays are all single precision.  The output stays in the single-precision array (see GetSinglePrecisionOutput()),
+     and is laid out like the data of the KTFrequencySpectrumFFTW that DoWindowedTransform() would fill in double precision.
+     KTFrequencySpectrumFFTW::CreateScaledPowerSpectrum() can calculate the power spectrum directly from it, in single precision.
+     The single-precision plan is made with the same transform flag, and uses its own wisdom file, since FFTW keeps single- and double-precision wisdom separately.
+     It's not multithreaded, since that would need libfftw3f_threads.
+
      Slots:
      - "header": void (Nymph::KTDataPtr) -- Initialize the FFT from an Egg header; Requires KTEggHeader
      - "ts-real": void (Nymph::KTDataPtr) -- Perform a forward FFT on a real time series; Requires KTTimeSeriesData; Adds KTFrequencySpectrumFFTW; Emits signal "fft"
@@ -111,9 +135,12 @@ namespace Katydid
 
             MEMBERVARIABLE(bool, UseWisdom);
             MEMBERVARIABLEREF(std::string, WisdomFilename);
+            MEMBERVARIABLEREF(std::string, SPWisdomFilename);
 
             MEMBERVARIABLE(bool, ComplexAsIQ);
 
+            MEMBERVARIABLE(bool, BatchComponents);
+
             MEMBERVARIABLE_NOSET(unsigned, TimeSize);
             MEMBERVARIABLE_NOSET(unsigned, FrequencySize);
 
@@ -124,6 +151,8 @@ namespace Katydid
             void SetTimeSize(unsigned nBins);
             /// Change the transform flag; FFT must be initialized after calling this.
             void SetTransformFlag(const std::string& flag);
+            /// Returns the FFTW planner flag that corresponds to the current transform flag
+            unsigned GetTransformFlagValue() const;
 
         private:
             /// note: does not change the state
@@ -180,6 +209,59 @@ namespace Katydid
             /// Forward FFT - Complex Time Series - Output must exist - No size or bin width checks
             void DoTransform(const KTTimeSeriesFFTW* tsIn, KTFrequencySpectrumFFTW* fsOut) const;
 
+            /// Forward FFT - Real Time Series - Window weights are applied while filling the input array - Output must exist - No size or bin width checks
+            /// The output is NOT scaled; multiply by GetOutputScale() to get the same values as DoTransform()
+            void DoWindowedTransform(const KTTimeSeriesReal* tsIn, const double* weights, KTFrequencySpectrumFFTW* fsOut) const;
+            /// Forward FFT - Complex Time Series - Window weights are applied while filling the input array - Output must exist - No size or bin width checks
+            /// The output is NOT scaled; multiply by GetOutputScale() to get the same values as DoTransform()
+            void DoWindowedTransform(const KTTimeSeriesFFTW* tsIn, const double* weights, KTFrequencySpectrumFFTW* fsOut) const;
+
+            /// Returns the factor by which the FFTW output is scaled in the current state
+            double GetOutputScale() const;
+
+#ifdef FFTWF_FOUND
+            /// Creates the single-precision plan for the current state and time size; the FFT must be initialized for R2C or C2C
+            bool InitializeSinglePrecision();
+            /// Returns true if the single-precision plan matches the current state and time size
+            bool GetIsSinglePrecisionInitialized() const;
+
+            /// Single-precision forward FFT - Real Time Series - Window weights are applied while filling the input array - The result is left in GetSinglePrecisionOutput() - No size or bin width checks
+            /// The output is NOT scaled; multiply by GetOutputScale() to get the same values as DoTransform()
+            void DoWindowedTransform(const KTTimeSeriesRealFloat* tsIn, const float* weights) const;
+            /// Single-precision forward FFT - Complex Time Series - Window weights are applied while filling the input array - The result is left in GetSinglePrecisionOutput() - No size or bin width checks
+            /// The output is NOT scaled; multiply by GetOutputScale() to get the same values as DoTransform()
+            void DoWindowedTransform(const KTTimeSeriesComplexFloat* tsIn, const float* weights) const;
+
+            /// Output of the last single-precision transform; GetFrequencySize() bins, in FFTW order
+            const fftwf_complex* GetSinglePrecisionOutput() const;
+
+        private:
+            void FreeSinglePrecision();
+
+            fftwf_plan fSPPlan;
+            State fSPState;
+            unsigned fSPTimeSize;
+
+            float*         fRSPInputArray;
+            fftwf_complex* fCSPInputArray;
+            fftwf_complex* fSPOutputArray;
+#endif
+
+        private:
+            /// Transforms all of the components of a data object with the batched plan
+            bool BatchTransform(KTTimeSeriesDataCore& tsData, KTFrequencySpectrumDataFFTW& newData);
+            /// Creates the batched plan for nComponents transforms in the current state
+            bool InitializeBatch(unsigned nComponents);
+            void FreeBatch();
+
+            fftw_plan fBatchPlan;
+            unsigned fBatchSize;
+            State fBatchState;
+
+            double*       fRBatchInputArray;
+            fftw_complex* fCBatchInputArray;
+            fftw_complex* fBatchOutputArray;
+
         private:
             // binning cache
             void UpdateBinningCache(double timeBinWidth) const;
@@ -252,6 +334,19 @@ namespace Katydid
         }
     }
 
+    inline double KTForwardFFTW::GetOutputScale() const
+    {
+        if (fState == kR2C) return sqrt(2. / (double)fTimeSize);
+        return sqrt(1. / (double)fTimeSize);
+    }
+
+#ifdef FFTWF_FOUND
+    inline const fftwf_complex* KTForwardFFTW::GetSinglePrecisionOutput() const
+    {
+        return fSPOutputArray;
+    }
+
+#endif
     inline void KTForwardFFTW::UpdateBinningCache(double timeBinWidth) const
     {
         if (timeBinWidth == fTimeBinWidthCache) return;
@@ -42,6 +42,7 @@ namespace Katydid
      KTReverseFFTW performs a complex-to-real or complex-to-complex reverse FFT on a one-dimensional frequency spectrum.
 
      The FFT is implemented using FFTW.
+     Only double precision is supported; the single-precision path in KTForwardFFTW ends at the power spectrum, and inverse transforms are not on it.
 
      Configuration name: "reverse-fftw"
 
@@ -0,0 +1,608 @@
+/*
+ * KTStreamingSTFT.cc
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ */
+
+#include "KTStreamingSTFT.hh"
+
+#include "KTEggHeader.hh"
+#include "KTFrequencySpectrumFFTW.hh"
+#include "KTLogger.hh"
+#include "KTMultiPSData.hh"
+#include "KTPowerSpectrum.hh"
+#include "KTPowerSpectrumData.hh"
+#include "KTSpectrogramData.hh"
+#include "KTTimeSeriesData.hh"
+#include "KTTimeSeriesFFTW.hh"
+#include "KTTimeSeriesReal.hh"
+#include "KTWindowFunction.hh"
+
+#include "factory.hh"
+
+#include <algorithm>
+#include <cstring>
+
+using std::string;
+
+
+namespace Katydid
+{
+    KTLOGGER(stftlog, "KTStreamingSTFT");
+
+    KT_REGISTER_PROCESSOR(KTStreamingSTFT, "streaming-stft");
+
+    KTStreamingSTFT::KTStreamingSTFT(const std::string& name) :
+            KTProcessor(name),
+            fWindowSize(0),
+            fHopSize(0),
+            fFramesPerBatch(64),
+            fOutput(kPerFrame),
+            fWindowFunction(NULL),
+            fWindowIsRectangular(true),
+            fFFT(name + "-fft"),
+            fState(KTForwardFFTW::kNone),
+            fNComponents(0),
+            fTimeBinWidth(0.),
+            fIsInitialized(false),
+            fHop(0),
+            fBatchSpan(0),
+            fRealStreams(),
+            fComplexStreams(),
+            fNBuffered(0),
+            fNToSkip(0),
+            fRealFrames(NULL),
+            fComplexFrames(NULL),
+            fFFTOutput(NULL),
+            fPlan(NULL),
+            fFSBuffer(NULL),
+            fStreamHeader(),
+            fStreamStarted(false),
+            fNStreamFrames(0),
+            fNFrames(0),
+            fPSSignal("ps", this),
+            fStripeSignal("stripe", this),
+            fSpectrogramSignal("spectrogram", this),
+            fHeaderSlot("header", this, &KTStreamingSTFT::InitializeWithHeader),
+            fTSRealSlot("ts-real", this, &KTStreamingSTFT::AddRealData),
+            fTSFFTWSlot("ts-fftw", this, &KTStreamingSTFT::AddComplexData),
+            fFlushSlot("flush", this, &KTStreamingSTFT::Flush)
+    {
+        SelectWindowFunction("rectangular");
+    }
+
+    KTStreamingSTFT::~KTStreamingSTFT()
+    {
+        FreeBuffers();
+        delete fWindowFunction;
+    }
+
+    bool KTStreamingSTFT::Configure(const scarab::param_node* node)
+    {
+        if (node == NULL) return fFFT.Configure(node);
+
+        SetWindowSize(node->get_value("window-size", fWindowSize));
+        SetHopSize(node->get_value("hop-size", fHopSize));
+        SetFramesPerBatch(node->get_value("frames-per-batch", fFramesPerBatch));
+        if (fFramesPerBatch == 0)
+        {
+            KTERROR(stftlog, "The number of frames per batch must be greater than 0");
+            return false;
+        }
+
+        string output = node->get_value("output", fOutput == kStripe ? "stripe" : fOutput == kSpectrogram ? "spectrogram" : "ps");
+        if (output == "ps") SetOutput(kPerFrame);
+        else if (output == "stripe") SetOutput(kStripe);
+        else if (output == "spectrogram") SetOutput(kSpectrogram);
+        else
+        {
+            KTERROR(stftlog, "Invalid output mode: <" << output << ">; options are \"ps\", \"stripe\", and \"spectrogram\"");
+            return false;
+        }
+
+        string windowType = node->get_value("window-function-type", "rectangular");
+        if (! SelectWindowFunction(windowType))
+        {
+            return false;
+        }
+
+        if (! fWindowFunction->Configure(node->node_at("window-function")))
+        {
+            return false;
+        }
+
+        // the FFT configuration values are at the same level as the window function type
+        if (! fFFT.Configure(node))
+        {
+            return false;
+        }
+
+        fIsInitialized = false;
+        return true;
+    }
+
+    bool KTStreamingSTFT::SelectWindowFunction(const string& windowType)
+    {
+        KTWindowFunction* tempWF = scarab::factory< KTWindowFunction >::get_instance()->create(windowType);
+        if (tempWF == NULL)
+        {
+            KTERROR(stftlog, "Invalid window function type given: <" << windowType << ">.");
+            return false;
+        }
+        SetWindowFunction(tempWF);
+        return true;
+    }
+
+    void KTStreamingSTFT::SetWindowFunction(KTWindowFunction* wf)
+    {
+        delete fWindowFunction;
+        fWindowFunction = wf;
+        fIsInitialized = false;
+        return;
+    }
+
+    bool KTStreamingSTFT::InitializeWithHeader(KTEggHeader& header)
+    {
+        if (fWindowSize == 0)
+        {
+            SetWindowSize(header.GetChannelHeader(0)->GetSliceSize());
+            KTDEBUG(stftlog, "Window size set from the header: " << fWindowSize);
+        }
+        if (header.GetChannelHeader(0)->GetTSDataType() != KTChannelHeader::kReal)
+        {
+            fFFT.SetComplexAsIQ(header.GetChannelHeader(0)->GetTSDataType() == KTChannelHeader::kIQ);
+        }
+        fIsInitialized = false;
+        return true;
+    }
+
+    bool KTStreamingSTFT::AddRealData(KTSliceHeader& header, KTTimeSeriesData& tsData)
+    {
+        return AddData(header, tsData, KTForwardFFTW::kR2C);
+    }
+
+    bool KTStreamingSTFT::AddComplexData(KTSliceHeader& header, KTTimeSeriesData& tsData)
+    {
+        return AddData(header, tsData, KTForwardFFTW::kC2C);
+    }
+
+    bool KTStreamingSTFT::Initialize(KTForwardFFTW::State state, unsigned nComponents, double timeBinWidth)
+    {
+        FreeBuffers();
+        fIsInitialized = false;
+
+        unsigned windowSize = fWindowSize;
+        fHop = fHopSize != 0 ? fHopSize : windowSize;
+        fBatchSpan = windowSize + (fFramesPerBatch - 1) * fHop;
+
+        fWindowFunction->SetBinWidth(timeBinWidth);
+        fWindowFunction->SetSize(windowSize);
+        fWindowFunction->RebuildWindowFunction();
+        const std::vector< double >& weights = fWindowFunction->GetWeights();
+        fWindowIsRectangular = std::count(weights.begin(), weights.end(), 1.) == (long)weights.size();
+
+        bool fftInitialized = state == KTForwardFFTW::kR2C ? fFFT.InitializeForRealTDD(windowSize) : fFFT.InitializeForComplexTDD(windowSize);
+        if (! fftInitialized)
+        {
+            KTERROR(stftlog, "Unable to initialize the FFT");
+            return false;
+        }
+        unsigned frequencySize = fFFT.GetFrequencySize();
+
+        int timeSize = windowSize;
+        unsigned nFrames = fFramesPerBatch;
+        unsigned transformFlag = fFFT.GetTransformFlagValue();
+        fFFTOutput = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * frequencySize * nFrames);
+
+        // All streams are allocated with fftw_malloc, so they have the same alignment, and the plan can be executed on any of them.
+        // The inputs are only read by these out-of-place plans, so overlapping frames in the stream buffer are fine.
+        if (state == KTForwardFFTW::kR2C)
+        {
+            fRealStreams.resize(nComponents);
+            for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
+            {
+                fRealStreams[iComponent] = (double*) fftw_malloc(sizeof(double) * fBatchSpan);
+            }
+            if (fWindowIsRectangular)
+            {
+                KTDEBUG(stftlog, "Creating strided R2C plan: " << nFrames << " frames of " << windowSize << " bins; hop: " << fHop);
+                fPlan = fftw_plan_many_dft_r2c(1, &timeSize, nFrames,
+                        fRealStreams[0], NULL, 1, fHop,
+                        fFFTOutput, NULL, 1, frequencySize,
+                        transformFlag | FFTW_PRESERVE_INPUT);
+            }
+            else
+            {
+                KTDEBUG(stftlog, "Creating R2C plan for windowed frames: " << nFrames << " frames of " << windowSize << " bins");
+                fRealFrames = (double*) fftw_malloc(sizeof(double) * windowSize * nFrames);
+                fPlan = fftw_plan_many_dft_r2c(1, &timeSize, nFrames,
+                        fRealFrames, NULL, 1, windowSize,
+                        fFFTOutput, NULL, 1, frequencySize,
+                        transformFlag);
+            }
+        }
+        else
+        {
+            fComplexStreams.resize(nComponents);
+            for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
+            {
+                fComplexStreams[iComponent] = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * fBatchSpan);
+            }
+            if (fWindowIsRectangular)
+            {
+                KTDEBUG(stftlog, "Creating strided C2C plan: " << nFrames << " frames of " << windowSize << " bins; hop: " << fHop);
+                fPlan = fftw_plan_many_dft(1, &timeSize, nFrames,
+                        fComplexStreams[0], NULL, 1, fHop,
+                        fFFTOutput, NULL, 1, frequencySize,
+                        FFTW_FORWARD, transformFlag | FFTW_PRESERVE_INPUT);
+            }
+            else
+            {
+                KTDEBUG(stftlog, "Creating C2C plan for windowed frames: " << nFrames << " frames of " << windowSize << " bins");
+                fComplexFrames = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * windowSize * nFrames);
+                fPlan = fftw_plan_many_dft(1, &timeSize, nFrames,
+                        fComplexFrames, NULL, 1, windowSize,
+                        fFFTOutput, NULL, 1, frequencySize,
+                        FFTW_FORWARD, transformFlag);
+            }
+        }
+
+        if (fPlan == NULL)
+        {
+            KTERROR(stftlog, "Unable to create the batched STFT plan");
+            FreeBuffers();
+            return false;
+        }
+
+        // planning can overwrite the arrays; the streams are cleared afterwards so that unfilled samples are never garbage
+        for (unsigned iComponent = 0; iComponent < fRealStreams.size(); ++iComponent)
+        {
+            memset(fRealStreams[iComponent], 0, sizeof(double) * fBatchSpan);
+        }
+        for (unsigned iComponent = 0; iComponent < fComplexStreams.size(); ++iComponent)
+        {
+            memset(fComplexStreams[iComponent], 0, sizeof(fftw_complex) * fBatchSpan);
+        }
+
+        // the spectrum buffer is binned the same way as the spectra created by KTForwardFFTW
+        fFSBuffer = new KTFrequencySpectrumFFTW(frequencySize, fFFT.GetMinFrequency(timeBinWidth), fFFT.GetMaxFrequency(timeBinWidth), state != KTForwardFFTW::kR2C);
+        fFSBuffer->SetNTimeBins(windowSize);
+
+        fState = state;
+        fNComponents = nComponents;
+        fTimeBinWidth = timeBinWidth;
+        fNBuffered = 0;
+        fNToSkip = 0;
+        fIsInitialized = true;
+        return true;
+    }
+
+    void KTStreamingSTFT::FreeBuffers()
+    {
+        if (fPlan != NULL)
+        {
+            fftw_destroy_plan(fPlan);
+            fPlan = NULL;
+        }
+        for (std::vector< double* >::iterator it = fRealStreams.begin(); it != fRealStreams.end(); ++it)
+        {
+            fftw_free(*it);
+        }
+        fRealStreams.clear();
+        for (std::vector< fftw_complex* >::iterator it = fComplexStreams.begin(); it != fComplexStreams.end(); ++it)
+        {
+            fftw_free(*it);
+        }
+        fComplexStreams.clear();
+        if (fRealFrames != NULL)
+        {
+            fftw_free(fRealFrames);
+            fRealFrames = NULL;
+        }
+        if (fComplexFrames != NULL)
+        {
+            fftw_free(fComplexFrames);
+            fComplexFrames = NULL;
+        }
+        if (fFFTOutput != NULL)
+        {
+            fftw_free(fFFTOutput);
+            fFFTOutput = NULL;
+        }
+        delete fFSBuffer;
+        fFSBuffer = NULL;
+        return;
+    }
+
+    void KTStreamingSTFT::RestartStreams()
+    {
+        fNBuffered = 0;
+        fNToSkip = 0;
+        fNStreamFrames = 0;
+        fStreamStarted = false;
+        return;
+    }
+
+    bool KTStreamingSTFT::AddData(KTSliceHeader& header, KTTimeSeriesData& tsData, KTForwardFFTW::State state)
+    {
+        unsigned nComponents = tsData.GetNComponents();
+        if (nComponents == 0) return true;
+
+        unsigned nSamples = tsData.GetTimeSeries(0)->GetNTimeBins();
+        double timeBinWidth = tsData.GetTimeSeries(0)->GetTimeBinWidth();
+
+        if (fWindowSize == 0)
+        {
+            SetWindowSize(nSamples);
+            KTDEBUG(stftlog, "Window size set from the first time series: " << fWindowSize);
+        }
+
+        if (header.GetIsNewAcquisition() && fStreamStarted)
+        {
+            KTDEBUG(stftlog, "New acquisition; restarting the streams");
+            Flush();
+        }
+
+        unsigned hop = fHopSize != 0 ? fHopSize : fWindowSize;
+        if (! fIsInitialized || state != fState || nComponents != fNComponents || timeBinWidth != fTimeBinWidth ||
+                fWindowSize != fFFT.GetTimeSize() || hop != fHop || fWindowSize + (fFramesPerBatch - 1) * hop != fBatchSpan)
+        {
+            if (fStreamStarted)
+            {
+                KTWARN(stftlog, "The stream layout changed; restarting the streams");
+                Flush();
+            }
+            if (! Initialize(state, nComponents, timeBinWidth))
+            {
+                KTERROR(stftlog, "Unable to initialize the streaming STFT");
+                return false;
+            }
+        }
+
+        // check the types and sizes before anything is buffered
+        for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
+        {
+            const KTTimeSeries* ts = tsData.GetTimeSeries(iComponent);
+            bool isCorrectType = state == KTForwardFFTW::kR2C ? dynamic_cast< const KTTimeSeriesReal* >(ts) != NULL : dynamic_cast< const KTTimeSeriesFFTW* >(ts) != NULL;
+            if (! isCorrectType)
+            {
+                KTERROR(stftlog, "Incorrect time series type in component " << iComponent << "; expected " << (state == KTForwardFFTW::kR2C ? "KTTimeSeriesReal" : "KTTimeSeriesFFTW"));
+                return false;
+            }
+            if (ts->GetNTimeBins() != nSamples)
+            {
+                KTERROR(stftlog, "The components have different numbers of samples");
+                return false;
+            }
+        }
+
+        if (! fStreamStarted)
+        {
+            fStreamHeader.CopySliceHeaderOnly(header);
+            fStreamStarted = true;
+        }
+
+        unsigned iSample = 0;
+        while (iSample < nSamples)
+        {
+            if (fNToSkip != 0)
+            {
+                unsigned nToSkip = std::min(fNToSkip, nSamples - iSample);
+                iSample += nToSkip;
+                fNToSkip -= nToSkip;
+                continue;
+            }
+
+            unsigned nToCopy = std::min(fBatchSpan - fNBuffered, nSamples - iSample);
+            for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
+            {
+                if (state == KTForwardFFTW::kR2C)
+                {
+                    const double* input = static_cast< const KTTimeSeriesReal* >(tsData.GetTimeSeries(iComponent))->GetData() + iSample;
+                    memcpy(fRealStreams[iComponent] + fNBuffered, input, sizeof(double) * nToCopy);
+                }
+                else
+                {
+                    const fftw_complex* input = static_cast< const KTTimeSeriesFFTW* >(tsData.GetTimeSeries(iComponent))->GetData() + iSample;
+                    memcpy(fComplexStreams[iComponent] + fNBuffered, input, sizeof(fftw_complex) * nToCopy);
+                }
+            }
+            fNBuffered += nToCopy;
+            iSample += nToCopy;
+
+            if (fNBuffered == fBatchSpan)
+            {
+                TransformBatch(fFramesPerBatch);
+
+                // keep the samples from the start of the next frame onward
+                unsigned nextFrameStart = fFramesPerBatch * fHop;
+                if (nextFrameStart < fBatchSpan)
+                {
+                    fNBuffered = fBatchSpan - nextFrameStart;
+                    for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
+                    {
+                        if (state == KTForwardFFTW::kR2C) memmove(fRealStreams[iComponent], fRealStreams[iComponent] + nextFrameStart, sizeof(double) * fNBuffered);
+                        else memmove(fComplexStreams[iComponent], fComplexStreams[iComponent] + nextFrameStart, sizeof(fftw_complex) * fNBuffered);
+                    }
+                }
+                else
+                {
+                    fNBuffered = 0;
+                    fNToSkip = nextFrameStart - fBatchSpan;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    void KTStreamingSTFT::Flush()
+    {
+        if (fIsInitialized && fNBuffered >= fFFT.GetTimeSize())
+        {
+            unsigned nFrames = (fNBuffered - fFFT.GetTimeSize()) / fHop + 1;
+            KTDEBUG(stftlog, "Flushing " << nFrames << " frame(s)");
+            TransformBatch(nFrames);
+        }
+        RestartStreams();
+        return;
+    }
+
+    void KTStreamingSTFT::ExecuteBatch(unsigned component, unsigned nFrames)
+    {
+        unsigned windowSize = fFFT.GetTimeSize();
+        if (fState == KTForwardFFTW::kR2C)
+        {
+            const double* stream = fRealStreams[component];
+            if (fWindowIsRectangular)
+            {
+                fftw_execute_dft_r2c(fPlan, const_cast< double* >(stream), fFFTOutput);
+                return;
+            }
+            const double* weights = fWindowFunction->GetWeights().data();
+            for (unsigned iFrame = 0; iFrame < nFrames; ++iFrame)
+            {
+                const double* frameIn = stream + iFrame * fHop;
+                double* frameOut = fRealFrames + iFrame * windowSize;
+                for (unsigned iBin = 0; iBin < windowSize; ++iBin)
+                {
+                    frameOut[iBin] = frameIn[iBin] * weights[iBin];
+                }
+            }
+            fftw_execute_dft_r2c(fPlan, fRealFrames, fFFTOutput);
+        }
+        else
+        {
+            const fftw_complex* stream = fComplexStreams[component];
+            if (fWindowIsRectangular)
+            {
+                fftw_execute_dft(fPlan, const_cast< fftw_complex* >(stream), fFFTOutput);
+                return;
+            }
+            const double* weights = fWindowFunction->GetWeights().data();
+            for (unsigned iFrame = 0; iFrame < nFrames; ++iFrame)
+            {
+                const fftw_complex* frameIn = stream + iFrame * fHop;
+                fftw_complex* frameOut = fComplexFrames + iFrame * windowSize;
+                for (unsigned iBin = 0; iBin < windowSize; ++iBin)
+                {
+                    frameOut[iBin][0] = frameIn[iBin][0] * weights[iBin];
+                    frameOut[iBin][1] = frameIn[iBin][1] * weights[iBin];
+                }
+            }
+            fftw_execute_dft(fPlan, fComplexFrames, fFFTOutput);
+        }
+        return;
+    }
+
+    void KTStreamingSTFT::TransformBatch(unsigned nFrames)
+    {
+        // frames past nFrames (only when flushing) are transformed along with the rest, but they're not used
+        unsigned frequencySize = fFFT.GetFrequencySize();
+        double scale = fFFT.GetOutputScale();
+        double hopLength = double(fHop) * fTimeBinWidth;
+
+        std::vector< Nymph::KTDataPtr > newData(fOutput == kPerFrame ? nFrames : 1);
+        for (unsigned iData = 0; iData < newData.size(); ++iData)
+        {
+            newData[iData].reset(new Nymph::KTData());
+        }
+
+        if (fOutput == kStripe)
+        {
+            FillSliceHeader(newData[0]->Of< KTSliceHeader >(), 0, nFrames);
+            newData[0]->Of< KTMultiPSData >().SetNComponents(fNComponents);
+        }
+        else if (fOutput == kSpectrogram)
+        {
+            FillSliceHeader(newData[0]->Of< KTSliceHeader >(), 0, nFrames);
+            newData[0]->Of< KTSpectrogramData >().SetNComponents(fNComponents);
+        }
+        else
+        {
+            for (unsigned iFrame = 0; iFrame < nFrames; ++iFrame)
+            {
+                FillSliceHeader(newData[iFrame]->Of< KTSliceHeader >(), iFrame, 1);
+                newData[iFrame]->Of< KTPowerSpectrumData >().SetNComponents(fNComponents);
+            }
+        }
+
+        for (unsigned iComponent = 0; iComponent < fNComponents; ++iComponent)
+        {
+            ExecuteBatch(iComponent, nFrames);
+
+            KTMultiPS* stripe = NULL;
+            if (fOutput == kStripe)
+            {
+                double startTime = newData[0]->Of< KTSliceHeader >().GetTimeInRun();
+                stripe = new KTMultiPS(nFrames, startTime, startTime + double(nFrames) * hopLength);
+                newData[0]->Of< KTMultiPSData >().SetSpectra(stripe, iComponent);
+            }
+            KTSpectrogram* spectrogram = NULL;
+
+            for (unsigned iFrame = 0; iFrame < nFrames; ++iFrame)
+            {
+                memcpy(fFSBuffer->GetData(), fFFTOutput + iFrame * frequencySize, sizeof(fftw_complex) * frequencySize);
+                KTPowerSpectrum* spectrum = fFSBuffer->CreateScaledPowerSpectrum(scale);
+                spectrum->ConvertToPowerSpectrum();
+                if (fOutput == kStripe) (*stripe)(iFrame) = spectrum;
+                else if (fOutput == kSpectrogram)
+                {
+                    if (spectrogram == NULL)
+                    {
+                        double startTime = newData[0]->Of< KTSliceHeader >().GetTimeInRun();
+                        spectrogram = new KTSpectrogram(nFrames, startTime, startTime + double(nFrames) * hopLength, spectrum->size(), spectrum->GetRangeMin(), spectrum->GetRangeMax());
+                        newData[0]->Of< KTSpectrogramData >().SetSpectrogram(spectrogram, iComponent);
+                    }
+                    spectrogram->SetRow(iFrame, *spectrum);
+                    KTPowerSpectrum::Release(spectrum);
+                }
+                else newData[iFrame]->Of< KTPowerSpectrumData >().SetSpectrum(spectrum, iComponent);
+            }
+        }
+
+        fNStreamFrames += nFrames;
+        fNFrames += nFrames;
+
+        KTDEBUG(stftlog, "Transformed " << nFrames << " frame(s) in " << fNComponents << " component(s)");
+
+        for (unsigned iData = 0; iData < newData.size(); ++iData)
+        {
+            if (fOutput == kStripe) fStripeSignal(newData[iData]);
+            else if (fOutput == kSpectrogram) fSpectrogramSignal(newData[iData]);
+            else fPSSignal(newData[iData]);
+        }
+        return;
+    }
+
+    void KTStreamingSTFT::FillSliceHeader(KTSliceHeader& header, unsigned iFrame, unsigned nFrames)
+    {
+        unsigned windowSize = fFFT.GetTimeSize();
+        unsigned startSample = (fNStreamFrames + iFrame) * fHop;
+        double timeOffset = double(startSample) * fTimeBinWidth;
+
+        header.CopySliceHeaderOnly(fStreamHeader);
+        header.SetTimeInRun(fStreamHeader.GetTimeInRun() + timeOffset);
+        header.SetTimeInAcq(fStreamHeader.GetTimeInAcq() + timeOffset);
+        header.SetSliceNumber(fNFrames + iFrame);
+        header.SetNSlicesIncluded(nFrames);
+        header.SetIsNewAcquisition(fNStreamFrames + iFrame == 0 && fStreamHeader.GetIsNewAcquisition());
+        header.SetRawSliceSize(windowSize);
+        header.SetSliceSize(windowSize);
+        header.SetSampleRate(1. / fTimeBinWidth);
+        header.CalculateBinWidthAndSliceLength();
+        header.SetNonOverlapFrac(fHop >= windowSize ? 1. : double(fHop) / double(windowSize));
+        if (fStreamHeader.GetRecordSize() != 0)
+        {
+            header.SetStartRecordAndSample(fStreamHeader.GetRecordSamplePairAtSample(startSample));
+            header.SetEndRecordAndSample(fStreamHeader.GetRecordSamplePairAtSample(startSample + (nFrames - 1) * fHop + windowSize - 1));
+        }
+        for (unsigned iComponent = 0; iComponent < header.GetNComponents(); ++iComponent)
+        {
+            header.SetTimeStamp(fStreamHeader.GetTimeStamp(iComponent) + uint64_t(timeOffset * 1.e9), iComponent);
+        }
+        return;
+    }
+
+} /* namespace Katydid */
@@ -0,0 +1,217 @@
+/**
+ @file KTStreamingSTFT.hh
+ @brief Contains KTStreamingSTFT
+ @details Computes overlapping power spectra from a contiguous stream of time-series samples
+ @author: N. S. Oblath
+ @date: Oct 17, 2026
+ */
+
+#ifndef KTSTREAMINGSTFT_HH_
+#define KTSTREAMINGSTFT_HH_
+
+#include "KTProcessor.hh"
+
+#include "KTForwardFFTW.hh"
+#include "KTMemberVariable.hh"
+#include "KTSliceHeader.hh"
+#include "KTSlot.hh"
+
+#include <fftw3.h>
+
+#include <string>
+#include <vector>
+
+
+namespace Katydid
+{
+
+    class KTEggHeader;
+    class KTFrequencySpectrumFFTW;
+    class KTTimeSeriesData;
+    class KTWindowFunction;
+
+    /*!
+     @class KTStreamingSTFT
+     @author N. S. Oblath
+
+     @brief Short-time Fourier transform of a contiguous sample stream, with all of the hops in a batch done by one FFTW plan.
+
+     @details
+     The usual way to make a spectrogram with overlapping slices is to give KTEggProcessor a stride that's smaller than the slice size.
+     Each overlapping slice is then read, converted, windowed, and transformed separately.
+     KTStreamingSTFT instead takes contiguous time series (e.g. from KTEggProcessor with the stride equal to the slice size, so each sample is read and converted once)
+     and treats them as one continuous stream per component.
+
+     The stream is buffered until a batch of "frames-per-batch" frames is available.  Frame i starts i * "hop-size" samples after frame 0 and is "window-size" samples long.
+     All of the frames in the batch are transformed by one FFTW plan_many execution:
+     - With a rectangular window the plan reads the frames directly from the stream buffer, with an input distance of one hop;
+     - With any other window the weighted frames are first laid out contiguously, and the plan uses an input distance of one window.
+     The samples that overlap with the next batch are kept, so frames continue seamlessly across the input time series.
+     The stream is restarted when a slice starts a new acquisition; frames that are complete when the stream ends (a new acquisition, or the "flush" slot) are transformed then.
+
+     The power spectra have the same binning and normalization as those from KTWindowedFFTPower (and the chain KTWindower --> KTForwardFFTW --> KTConvertToPower).
+     Each output data object gets its own KTSliceHeader, in which the slice is the frame: the slice size is the window size, and the time in the run is that of the first sample in the frame.
+
+     Real time series are transformed with an r2c transform; complex time series are transformed with a c2c transform.
+     The input time series do not all need to be the same size, but they do need to arrive in order.
+
+     Configuration name: "streaming-stft"
+
+     Available configuration values:
+     - "window-size": unsigned -- number of samples in each frame; if 0, the slice size from the Egg header is used (default: 0)
+     - "hop-size": unsigned -- number of samples between the starts of consecutive frames; if 0, the window size is used (default: 0)
+     - "frames-per-batch": unsigned -- number of frames transformed by each plan execution (default: 64)
+     - "output": string -- "ps" to emit one data object per frame; "stripe" to emit one data object per batch; "spectrogram" to emit one dense spectrogram per batch (default: "ps")
+     - "window-function-type": string -- sets the type of window function to be used (default: "rectangular")
+     - "window-function": subtree -- parent node for the window function configuration
+     - "transform-flag": string -- FFTW planning flag; see KTForwardFFTW
+     - "use-wisdom": bool -- whether or not to use FFTW wisdom; see KTForwardFFTW
+     - "wisdom-filename": string -- filename for loading/saving FFTW wisdom; see KTForwardFFTW
+     - "transform-complex-as-iq": bool -- treat complex data as IQ; see KTForwardFFTW
+
+     Slots:
+     - "header": void (Nymph::KTDataPtr) -- Set the window size (if needed) and the IQ setting from an Egg header; Requires KTEggHeader
+     - "ts-real": void (Nymph::KTDataPtr) -- Adds real time series to the streams; Requires KTSliceHeader and KTTimeSeriesData containing KTTimeSeriesReal; Emits signal "ps", "stripe", or "spectrogram" for each completed frame or batch
+     - "ts-fftw": void (Nymph::KTDataPtr) -- Adds complex time series to the streams; Requires KTSliceHeader and KTTimeSeriesData containing KTTimeSeriesFFTW; Emits signal "ps", "stripe", or "spectrogram" for each completed frame or batch
+     - "flush": void () -- Transforms the complete frames remaining in the streams, and restarts the streams
+
+     Signals:
+     - "ps": void (Nymph::KTDataPtr) -- Emitted for each frame in "ps" output mode; Guarantees KTSliceHeader and KTPowerSpectrumData.
+     - "stripe": void (Nymph::KTDataPtr) -- Emitted for each batch of frames in "stripe" output mode; Guarantees KTSliceHeader and KTMultiPSData.
+     - "spectrogram": void (Nymph::KTDataPtr) -- Emitted for each batch of frames in "spectrogram" output mode; Guarantees KTSliceHeader and KTSpectrogramData.
+    */
+
+    class KTStreamingSTFT : public Nymph::KTProcessor
+    {
+        public:
+            enum OutputMode
+            {
+                kPerFrame,
+                kStripe,
+                kSpectrogram
+            };
+
+        public:
+            KTStreamingSTFT(const std::string& name = "streaming-stft");
+            virtual ~KTStreamingSTFT();
+
+            bool Configure(const scarab::param_node* node);
+
+            MEMBERVARIABLE(unsigned, WindowSize);
+            MEMBERVARIABLE(unsigned, HopSize);
+            MEMBERVARIABLE(unsigned, FramesPerBatch);
+            MEMBERVARIABLE(OutputMode, Output);
+
+            KTWindowFunction* GetWindowFunction() const;
+            void SetWindowFunction(KTWindowFunction* wf);
+            bool SelectWindowFunction(const std::string& windowType);
+
+            KTForwardFFTW& GetFFT();
+
+            /// Number of frames that have been transformed; this is also the slice number of the next frame
+            uint64_t GetNFrames() const;
+
+        public:
+            bool InitializeWithHeader(KTEggHeader& header);
+
+            bool AddRealData(KTSliceHeader& header, KTTimeSeriesData& tsData);
+            bool AddComplexData(KTSliceHeader& header, KTTimeSeriesData& tsData);
+
+            /// Transforms the complete frames remaining in the streams and restarts them
+            void Flush();
+
+        private:
+            bool AddData(KTSliceHeader& header, KTTimeSeriesData& tsData, KTForwardFFTW::State state);
+            /// Prepares the window, the buffers, and the batch plan for the given stream layout
+            bool Initialize(KTForwardFFTW::State state, unsigned nComponents, double timeBinWidth);
+            void FreeBuffers();
+            /// Discards the buffered samples and starts the frame count over
+            void RestartStreams();
+
+            /// Transforms the first nFrames frames in the stream buffers and emits the results
+            void TransformBatch(unsigned nFrames);
+            /// Executes the batch plan for one component; the output is in fFFTOutput
+            void ExecuteBatch(unsigned component, unsigned nFrames);
+
+            /// Fills in the header for nFrames frames, starting with frame iFrame of the batch being transformed
+            void FillSliceHeader(KTSliceHeader& header, unsigned iFrame, unsigned nFrames);
+
+            KTWindowFunction* fWindowFunction;
+            bool fWindowIsRectangular;
+            KTForwardFFTW fFFT;
+
+            // Stream layout that the buffers and plan are set up for
+            KTForwardFFTW::State fState;
+            unsigned fNComponents;
+            double fTimeBinWidth;
+            bool fIsInitialized;
+
+            /// Hop used by the current plan, after the default has been applied
+            unsigned fHop;
+            /// Number of samples covered by one batch: window + (frames - 1) * hop
+            unsigned fBatchSpan;
+
+            /// Per-component stream buffers (fBatchSpan samples each); exactly one of these is used, depending on the state
+            std::vector< double* > fRealStreams;
+            std::vector< fftw_complex* > fComplexStreams;
+            /// Number of samples currently in each stream buffer
+            unsigned fNBuffered;
+            /// Number of incoming samples to drop before buffering; used when the hop is larger than the window
+            unsigned fNToSkip;
+
+            /// Windowed frames, laid out contiguously; not used with a rectangular window
+            double* fRealFrames;
+            fftw_complex* fComplexFrames;
+            /// FFT output for all of the frames in a batch
+            fftw_complex* fFFTOutput;
+            fftw_plan fPlan;
+
+            /// Spectrum used to apply the standard binning and normalization to each frame
+            KTFrequencySpectrumFFTW* fFSBuffer;
+
+            /// Slice header of the data that started the current stream; used as the template for the output headers
+            KTSliceHeader fStreamHeader;
+            bool fStreamStarted;
+            /// Frames transformed since the start of the current stream; used for the frame times
+            uint64_t fNStreamFrames;
+            uint64_t fNFrames;
+
+            //***************
+            // Signals
+            //***************
+
+        private:
+            Nymph::KTSignalData fPSSignal;
+            Nymph::KTSignalData fStripeSignal;
+            Nymph::KTSignalData fSpectrogramSignal;
+
+            //***************
+            // Slots
+            //***************
+
+        private:
+            Nymph::KTSlotDataOneType< KTEggHeader > fHeaderSlot;
+            Nymph::KTSlotDataTwoTypes< KTSliceHeader, KTTimeSeriesData > fTSRealSlot;
+            Nymph::KTSlotDataTwoTypes< KTSliceHeader, KTTimeSeriesData > fTSFFTWSlot;
+            Nymph::KTSlotDone fFlushSlot;
+
+    };
+
+
+    inline KTWindowFunction* KTStreamingSTFT::GetWindowFunction() const
+    {
+        return fWindowFunction;
+    }
+
+    inline KTForwardFFTW& KTStreamingSTFT::GetFFT()
+    {
+        return fFFT;
+    }
+
+    inline uint64_t KTStreamingSTFT::GetNFrames() const
+    {
+        return fNFrames;
+    }
+
+} /* namespace Katydid */
+#endif /* KTSTREAMINGSTFT_HH_ */
@@ -59,6 +59,8 @@ namespace Katydid
 
             virtual double GetWeight(double time) const = 0;
             double GetWeight(unsigned bin) const;
+            /// Returns the cached weights for all bins
+            const std::vector< double >& GetWeights() const;
 
 #ifdef ROOT_FOUND
             TH1D* CreateHistogram(const std::string& name = "hWindowFunction") const;
@@ -110,6 +112,11 @@ namespace Katydid
        return bin < fSize ? fWindowFunction[bin] : 0.;
    }
 
+   inline const std::vector< double >& KTWindowFunction::GetWeights() const
+   {
+       return fWindowFunction;
+   }
+
    inline double KTWindowFunction::GetLength() const
    {
        return fLength;
@@ -0,0 +1,275 @@
+/*
+ * KTWindowedFFTPower.cc
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ */
+
+#include "KTWindowedFFTPower.hh"
+
+#include "KTEggHeader.hh"
+#include "KTFrequencySpectrumFFTW.hh"
+#include "KTLogger.hh"
+#include "KTPowerSpectrum.hh"
+#include "KTPowerSpectrumData.hh"
+#include "KTTimeSeriesComplexFloat.hh"
+#include "KTTimeSeriesData.hh"
+#include "KTTimeSeriesFFTW.hh"
+#include "KTTimeSeriesReal.hh"
+#include "KTTimeSeriesRealFloat.hh"
+#include "KTWindowFunction.hh"
+
+#include "factory.hh"
+
+using std::string;
+
+
+namespace Katydid
+{
+    KTLOGGER(wfplog, "KTWindowedFFTPower");
+
+    KT_REGISTER_PROCESSOR(KTWindowedFFTPower, "windowed-fft-power");
+
+    KTWindowedFFTPower::KTWindowedFFTPower(const std::string& name) :
+            KTProcessor(name),
+            fWindowFunction(NULL),
+            fFFT(name + "-fft"),
+            fFSBuffer(NULL),
+            fFloatWeights(),
+            fFloatWeightsStale(true),
+            fPowerSpectrumSignal("ps", this),
+            fPowerSpectralDensitySignal("psd", this),
+            fHeaderSlot("header", this, &KTWindowedFFTPower::InitializeWithHeader),
+            fTSRealToPSSlot("ts-real-to-ps", this, &KTWindowedFFTPower::TransformRealToPS, &fPowerSpectrumSignal),
+            fTSRealToPSDSlot("ts-real-to-psd", this, &KTWindowedFFTPower::TransformRealToPSD, &fPowerSpectralDensitySignal),
+            fTSFFTWToPSSlot("ts-fftw-to-ps", this, &KTWindowedFFTPower::TransformComplexToPS, &fPowerSpectrumSignal),
+            fTSFFTWToPSDSlot("ts-fftw-to-psd", this, &KTWindowedFFTPower::TransformComplexToPSD, &fPowerSpectralDensitySignal)
+    {
+        SelectWindowFunction("rectangular");
+    }
+
+    KTWindowedFFTPower::~KTWindowedFFTPower()
+    {
+        delete fWindowFunction;
+        delete fFSBuffer;
+    }
+
+    bool KTWindowedFFTPower::Configure(const scarab::param_node* node)
+    {
+        if (node == NULL) return fFFT.Configure(node);
+
+        string windowType = node->get_value("window-function-type", "rectangular");
+        if (! SelectWindowFunction(windowType))
+        {
+            return false;
+        }
+
+        if (! fWindowFunction->Configure(node->node_at("window-function")))
+        {
+            return false;
+        }
+
+        // the FFT configuration values are at the same level as the window function type
+        if (! fFFT.Configure(node))
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    bool KTWindowedFFTPower::SelectWindowFunction(const string& windowType)
+    {
+        KTWindowFunction* tempWF = scarab::factory< KTWindowFunction >::get_instance()->create(windowType);
+        if (tempWF == NULL)
+        {
+            KTERROR(wfplog, "Invalid window function type given: <" << windowType << ">.");
+            return false;
+        }
+        SetWindowFunction(tempWF);
+        return true;
+    }
+
+    void KTWindowedFFTPower::SetWindowFunction(KTWindowFunction* wf)
+    {
+        delete fWindowFunction;
+        fWindowFunction = wf;
+        fFloatWeightsStale = true;
+        return;
+    }
+
+    bool KTWindowedFFTPower::InitializeWithHeader(KTEggHeader& header)
+    {
+        fWindowFunction->SetBinWidth(1. / header.GetAcquisitionRate());
+        fWindowFunction->SetSize(header.GetChannelHeader(0)->GetSliceSize());
+        fWindowFunction->RebuildWindowFunction();
+        fFloatWeightsStale = true;
+
+        if (! fFFT.InitializeWithHeader(header))
+        {
+            KTERROR(wfplog, "Unable to initialize the FFT with the header");
+            return false;
+        }
+
+        delete fFSBuffer;
+        fFSBuffer = NULL;
+
+        KTDEBUG(wfplog, "Window function and FFT initialized with header");
+        return true;
+    }
+
+    bool KTWindowedFFTPower::TransformRealToPS(KTTimeSeriesData& tsData)
+    {
+        return Transform(tsData, KTForwardFFTW::kR2C, false);
+    }
+
+    bool KTWindowedFFTPower::TransformRealToPSD(KTTimeSeriesData& tsData)
+    {
+        return Transform(tsData, KTForwardFFTW::kR2C, true);
+    }
+
+    bool KTWindowedFFTPower::TransformComplexToPS(KTTimeSeriesData& tsData)
+    {
+        return Transform(tsData, KTForwardFFTW::kC2C, false);
+    }
+
+    bool KTWindowedFFTPower::TransformComplexToPSD(KTTimeSeriesData& tsData)
+    {
+        return Transform(tsData, KTForwardFFTW::kC2C, true);
+    }
+
+    bool KTWindowedFFTPower::PrepareFor(KTTimeSeriesData& tsData, KTForwardFFTW::State state)
+    {
+        unsigned nTimeBins = tsData.GetTimeSeries(0)->GetNTimeBins();
+        double timeBinWidth = tsData.GetTimeSeries(0)->GetTimeBinWidth();
+
+        if (nTimeBins != fWindowFunction->GetSize())
+        {
+            fWindowFunction->AdaptTo(&tsData); // this call rebuilds the window, so that doesn't need to be done separately
+            fFloatWeightsStale = true;
+            if (nTimeBins != fWindowFunction->GetSize())
+            {
+                KTERROR(wfplog, "Number of bins in the data provided does not match the number of bins set for the window\n"
+                        << "   Bin expected: " << fWindowFunction->GetSize() << ";   Bins in data: " << nTimeBins);
+                return false;
+            }
+        }
+
+        if (fFFT.GetState() != state || fFFT.GetTimeSize() != nTimeBins || ! fFFT.GetIsInitialized())
+        {
+            bool initialized = state == KTForwardFFTW::kR2C ? fFFT.InitializeForRealTDD(nTimeBins) : fFFT.InitializeForComplexTDD(nTimeBins);
+            if (! initialized)
+            {
+                KTERROR(wfplog, "Unable to initialize the FFT");
+                return false;
+            }
+            delete fFSBuffer;
+            fFSBuffer = NULL;
+        }
+
+        // the spectrum buffer is binned the same way as the spectra created by KTForwardFFTW
+        double freqMin = fFFT.GetMinFrequency(timeBinWidth);
+        double freqMax = fFFT.GetMaxFrequency(timeBinWidth);
+        if (fFSBuffer == NULL || fFSBuffer->GetRangeMin() != freqMin || fFSBuffer->GetRangeMax() != freqMax)
+        {
+            KTDEBUG(wfplog, "Allocating the spectrum buffer: " << fFFT.GetFrequencySize() << " bins; range: " << freqMin << " - " << freqMax);
+            delete fFSBuffer;
+            fFSBuffer = new KTFrequencySpectrumFFTW(fFFT.GetFrequencySize(), freqMin, freqMax, state != KTForwardFFTW::kR2C);
+            fFSBuffer->SetNTimeBins(nTimeBins);
+        }
+
+        return true;
+    }
+
+    bool KTWindowedFFTPower::Transform(KTTimeSeriesData& tsData, KTForwardFFTW::State state, bool toPSD)
+    {
+        if (! PrepareFor(tsData, state))
+        {
+            return false;
+        }
+
+        const double* weights = fWindowFunction->GetWeights().data();
+        double scale = fFFT.GetOutputScale();
+
+        unsigned nComponents = tsData.GetNComponents();
+
+        KTPowerSpectrumData& psData = tsData.Of< KTPowerSpectrumData >().SetNComponents(nComponents);
+
+        for (unsigned iComponent = 0; iComponent < nComponents; ++iComponent)
+        {
+            KTPowerSpectrum* spectrum = NULL;
+            if (state == KTForwardFFTW::kR2C)
+            {
+                const KTTimeSeriesReal* nextInput = dynamic_cast< const KTTimeSeriesReal* >(tsData.GetTimeSeries(iComponent));
+                if (nextInput != NULL)
+                {
+                    fFFT.DoWindowedTransform(nextInput, weights, fFSBuffer);
+                    spectrum = fFSBuffer->CreateScaledPowerSpectrum(scale);
+                }
+                else if ((spectrum = TransformSinglePrecision(tsData.GetTimeSeries(iComponent), state, scale)) == NULL)
+                {
+                    KTERROR(wfplog, "Incorrect time series type: time series did not cast to KTTimeSeriesReal or KTTimeSeriesRealFloat.");
+                    return false;
+                }
+            }
+            else
+            {
+                const KTTimeSeriesFFTW* nextInput = dynamic_cast< const KTTimeSeriesFFTW* >(tsData.GetTimeSeries(iComponent));
+                if (nextInput != NULL)
+                {
+                    fFFT.DoWindowedTransform(nextInput, weights, fFSBuffer);
+                    spectrum = fFSBuffer->CreateScaledPowerSpectrum(scale);
+                }
+                else if ((spectrum = TransformSinglePrecision(tsData.GetTimeSeries(iComponent), state, scale)) == NULL)
+                {
+                    KTERROR(wfplog, "Incorrect time series type: time series did not cast to KTTimeSeriesFFTW or KTTimeSeriesComplexFloat.");
+                    return false;
+                }
+            }
+
+            if (toPSD) spectrum->ConvertToPowerSpectralDensity();
+            else spectrum->ConvertToPowerSpectrum();
+            psData.SetSpectrum(spectrum, iComponent);
+        }
+
+        KTINFO(wfplog, "Windowed FFT and power conversion complete; " << nComponents << " channel(s) transformed");
+
+        return true;
+    }
+
+    KTPowerSpectrum* KTWindowedFFTPower::TransformSinglePrecision(const KTTimeSeries* ts, KTForwardFFTW::State state, double scale)
+    {
+        const KTTimeSeriesRealFloat* realInput = NULL;
+        const KTTimeSeriesComplexFloat* complexInput = NULL;
+        if (state == KTForwardFFTW::kR2C) realInput = dynamic_cast< const KTTimeSeriesRealFloat* >(ts);
+        else complexInput = dynamic_cast< const KTTimeSeriesComplexFloat* >(ts);
+        if (realInput == NULL && complexInput == NULL)
+        {
+            return NULL;
+        }
+
+#ifdef FFTWF_FOUND
+        if (! fFFT.GetIsSinglePrecisionInitialized() && ! fFFT.InitializeSinglePrecision())
+        {
+            KTERROR(wfplog, "Unable to initialize the single-precision FFT");
+            return NULL;
+        }
+
+        if (fFloatWeightsStale)
+        {
+            const std::vector< double >& weights = fWindowFunction->GetWeights();
+            fFloatWeights.assign(weights.begin(), weights.end());
+            fFloatWeightsStale = false;
+        }
+
+        if (realInput != NULL) fFFT.DoWindowedTransform(realInput, fFloatWeights.data());
+        else fFFT.DoWindowedTransform(complexInput, fFloatWeights.data());
+        // The spectrum buffer isn't filled; it only provides the binning of the FFT output
+        return fFSBuffer->CreateScaledPowerSpectrum(fFFT.GetSinglePrecisionOutput(), float(scale));
+#else
+        KTERROR(wfplog, "Single-precision time series can't be transformed: Katydid was built without single-precision FFTW");
+        return NULL;
+#endif
+    }
+
+} /* namespace Katydid */
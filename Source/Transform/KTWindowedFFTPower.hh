@@ -0,0 +1,149 @@
+/**
+ @file KTWindowedFFTPower.hh
+ @brief Contains KTWindowedFFTPower
+ @details Windows a time series, performs a forward FFT, and converts the result to a power spectrum in one step
+ @author: N. S. Oblath
+ @date: Oct 17, 2026
+ */
+
+#ifndef KTWINDOWEDFFTPOWER_HH_
+#define KTWINDOWEDFFTPOWER_HH_
+
+#include "KTProcessor.hh"
+
+#include "KTForwardFFTW.hh"
+#include "KTSlot.hh"
+
+#include <string>
+#include <vector>
+
+
+namespace Katydid
+{
+
+    class KTEggHeader;
+    class KTFrequencySpectrumFFTW;
+    class KTPowerSpectrum;
+    class KTTimeSeries;
+    class KTTimeSeriesData;
+    class KTWindowFunction;
+
+    /*!
+     @class KTWindowedFFTPower
+     @author N. S. Oblath
+
+     @brief Fused window + forward FFT + power conversion.
+
+     @details
+     KTWindowedFFTPower does the work of the chain KTWindower --> KTForwardFFTW --> KTConvertToPower in one step:
+     - The window weights are applied while the FFTW input array is filled;
+     - The FFT plan is executed into a spectrum that is allocated once and reused for every slice;
+     - The FFT normalization is applied while the power spectrum is calculated.
+     The power spectra are bit-for-bit the same as those produced by the three-processor chain.
+
+     Unlike the chain, the input time series is not modified (it's not windowed in place), and no KTFrequencySpectrumDataFFTW is added to the data object.
+
+     Real time series are transformed with an r2c transform; complex time series are transformed with a c2c transform.
+
+     Single-precision time series (KTTimeSeriesRealFloat and KTTimeSeriesComplexFloat, e.g. from KTDAC with "single-precision" set) are accepted by the same slots
+     if single-precision FFTW was found at build time.  The window, the FFT, and the power calculation are then done in single precision (see KTForwardFFTW),
+     with no double-precision copy of the complex spectrum.  Only the resulting powers are stored in double precision, in KTPowerSpectrum,
+     so downstream processors and writers don't need to change.
+
+     Configuration name: "windowed-fft-power"
+
+     Available configuration values:
+     - "window-function-type": string -- sets the type of window function to be used (default: "rectangular")
+     - "window-function": subtree -- parent node for the window function configuration
+     - "transform-flag": string -- FFTW planning flag; see KTForwardFFTW
+     - "use-wisdom": bool -- whether or not to use FFTW wisdom; see KTForwardFFTW
+     - "wisdom-filename": string -- filename for loading/saving FFTW wisdom; see KTForwardFFTW
+     - "single-precision-wisdom-filename": string -- filename for loading/saving single-precision FFTW wisdom; see KTForwardFFTW
+     - "transform-complex-as-iq": bool -- treat complex data as IQ; see KTForwardFFTW
+
+     Slots:
+     - "header": void (Nymph::KTDataPtr) -- Initialize the window function and the FFT from an Egg header; Requires KTEggHeader
+     - "ts-real-to-ps": void (Nymph::KTDataPtr) -- Window, FFT, and convert a real time series to a PS; Requires KTTimeSeriesData containing KTTimeSeriesReal or KTTimeSeriesRealFloat; Adds KTPowerSpectrumData; Emits signal "ps"
+     - "ts-real-to-psd": void (Nymph::KTDataPtr) -- Window, FFT, and convert a real time series to a PSD; Requires KTTimeSeriesData containing KTTimeSeriesReal or KTTimeSeriesRealFloat; Adds KTPowerSpectrumData; Emits signal "psd"
+     - "ts-fftw-to-ps": void (Nymph::KTDataPtr) -- Window, FFT, and convert a complex time series to a PS; Requires KTTimeSeriesData containing KTTimeSeriesFFTW or KTTimeSeriesComplexFloat; Adds KTPowerSpectrumData; Emits signal "ps"
+     - "ts-fftw-to-psd": void (Nymph::KTDataPtr) -- Window, FFT, and convert a complex time series to a PSD; Requires KTTimeSeriesData containing KTTimeSeriesFFTW or KTTimeSeriesComplexFloat; Adds KTPowerSpectrumData; Emits signal "psd"
+
+     Signals:
+     - "ps": void (Nymph::KTDataPtr) -- Emitted upon creation of a power spectrum; Guarantees KTPowerSpectrumData.
+     - "psd": void (Nymph::KTDataPtr) -- Emitted upon creation of a power spectral density; Guarantees KTPowerSpectrumData.
+    */
+
+    class KTWindowedFFTPower : public Nymph::KTProcessor
+    {
+        public:
+            KTWindowedFFTPower(const std::string& name = "windowed-fft-power");
+            virtual ~KTWindowedFFTPower();
+
+            bool Configure(const scarab::param_node* node);
+
+            KTWindowFunction* GetWindowFunction() const;
+            void SetWindowFunction(KTWindowFunction* wf);
+            bool SelectWindowFunction(const std::string& windowType);
+
+            KTForwardFFTW& GetFFT();
+
+        private:
+            KTWindowFunction* fWindowFunction;
+            KTForwardFFTW fFFT;
+
+            /// Spectrum into which the FFT is done; reused for every slice
+            KTFrequencySpectrumFFTW* fFSBuffer;
+
+            /// Single-precision copy of the window weights; rebuilt when the window changes
+            std::vector< float > fFloatWeights;
+            bool fFloatWeightsStale;
+
+        public:
+            bool InitializeWithHeader(KTEggHeader& header);
+
+            bool TransformRealToPS(KTTimeSeriesData& tsData);
+            bool TransformRealToPSD(KTTimeSeriesData& tsData);
+            bool TransformComplexToPS(KTTimeSeriesData& tsData);
+            bool TransformComplexToPSD(KTTimeSeriesData& tsData);
+
+        private:
+            bool Transform(KTTimeSeriesData& tsData, KTForwardFFTW::State state, bool toPSD);
+            /// Prepares the window, the FFT, and the spectrum buffer for the given time series
+            bool PrepareFor(KTTimeSeriesData& tsData, KTForwardFFTW::State state);
+            /// Transforms a single-precision time series and calculates its power spectrum in single precision; returns NULL if the time series isn't single precision or the transform can't be done
+            KTPowerSpectrum* TransformSinglePrecision(const KTTimeSeries* ts, KTForwardFFTW::State state, double scale);
+
+            //***************
+            // Signals
+            //***************
+
+        private:
+            Nymph::KTSignalData fPowerSpectrumSignal;
+            Nymph::KTSignalData fPowerSpectralDensitySignal;
+
+            //***************
+            // Slots
+            //***************
+
+        private:
+            Nymph::KTSlotDataOneType< KTEggHeader > fHeaderSlot;
+            Nymph::KTSlotDataOneType< KTTimeSeriesData > fTSRealToPSSlot;
+            Nymph::KTSlotDataOneType< KTTimeSeriesData > fTSRealToPSDSlot;
+            Nymph::KTSlotDataOneType< KTTimeSeriesData > fTSFFTWToPSSlot;
+            Nymph::KTSlotDataOneType< KTTimeSeriesData > fTSFFTWToPSDSlot;
+
+    };
+
+
+    inline KTWindowFunction* KTWindowedFFTPower::GetWindowFunction() const
+    {
+        return fWindowFunction;
+    }
+
+    inline KTForwardFFTW& KTWindowedFFTPower::GetFFT()
+    {
+        return fFFT;
+    }
+
+} /* namespace Katydid */
+#endif /* KTWINDOWEDFFTPOWER_HH_ */
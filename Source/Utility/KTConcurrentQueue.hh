@@ -0,0 +1,166 @@
+/**
+ @file KTConcurrentQueue.hh
+ @brief Contains KTConcurrentQueue
+ @details Bounded, blocking FIFO for handing work between threads
+ @author: N.S. Oblath
+ @date: Oct 17, 2026
+ */
+
+#ifndef KTCONCURRENTQUEUE_HH_
+#define KTCONCURRENTQUEUE_HH_
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace Katydid
+{
+
+    /*!
+     @class KTConcurrentQueue
+     @author N.S. Oblath
+
+     @brief Bounded, blocking FIFO for handing work between threads
+
+     @details
+     Push() blocks while the queue holds fCapacity items; Pop() blocks while the queue is empty.
+     A capacity of 0 means the queue is unbounded.
+
+     Once Close() has been called, Push() refuses new items, and Pop() returns false as soon as the queue has been drained.
+     This is how producers signal the end of the stream to consumers.
+    */
+    template< typename XItemType >
+    class KTConcurrentQueue
+    {
+        public:
+            KTConcurrentQueue(unsigned capacity = 0);
+            ~KTConcurrentQueue();
+
+            /// Adds an item to the back of the queue; blocks while the queue is full.  Returns false if the queue has been closed.
+            bool Push(const XItemType& item);
+            /// Removes an item from the front of the queue; blocks while the queue is empty.  Returns false if the queue is closed and empty.
+            bool Pop(XItemType& item);
+            /// Non-blocking version of Pop(); returns false if no item was available
+            bool TryPop(XItemType& item);
+
+            /// Wake all waiting threads and refuse further pushes
+            void Close();
+            /// Empty the queue and allow it to be used again
+            void Reset();
+
+            bool IsClosed() const;
+            unsigned Size() const;
+            unsigned GetCapacity() const;
+
+        private:
+            std::deque< XItemType > fItems;
+            unsigned fCapacity;
+            bool fClosed;
+
+            mutable std::mutex fMutex;
+            std::condition_variable fNotEmpty;
+            std::condition_variable fNotFull;
+    };
+
+    template< typename XItemType >
+    KTConcurrentQueue< XItemType >::KTConcurrentQueue(unsigned capacity) :
+            fItems(),
+            fCapacity(capacity),
+            fClosed(false),
+            fMutex(),
+            fNotEmpty(),
+            fNotFull()
+    {
+    }
+
+    template< typename XItemType >
+    KTConcurrentQueue< XItemType >::~KTConcurrentQueue()
+    {
+        Close();
+    }
+
+    template< typename XItemType >
+    bool KTConcurrentQueue< XItemType >::Push(const XItemType& item)
+    {
+        std::unique_lock< std::mutex > lock(fMutex);
+        while (! fClosed && fCapacity != 0 && fItems.size() >= fCapacity)
+        {
+            fNotFull.wait(lock);
+        }
+        if (fClosed) return false;
+        fItems.push_back(item);
+        lock.unlock();
+        fNotEmpty.notify_one();
+        return true;
+    }
+
+    template< typename XItemType >
+    bool KTConcurrentQueue< XItemType >::Pop(XItemType& item)
+    {
+        std::unique_lock< std::mutex > lock(fMutex);
+        while (! fClosed && fItems.empty())
+        {
+            fNotEmpty.wait(lock);
+        }
+        if (fItems.empty()) return false;
+        item = fItems.front();
+        fItems.pop_front();
+        lock.unlock();
+        fNotFull.notify_one();
+        return true;
+    }
+
+    template< typename XItemType >
+    bool KTConcurrentQueue< XItemType >::TryPop(XItemType& item)
+    {
+        std::unique_lock< std::mutex > lock(fMutex);
+        if (fItems.empty()) return false;
+        item = fItems.front();
+        fItems.pop_front();
+        lock.unlock();
+        fNotFull.notify_one();
+        return true;
+    }
+
+    template< typename XItemType >
+    void KTConcurrentQueue< XItemType >::Close()
+    {
+        std::unique_lock< std::mutex > lock(fMutex);
+        fClosed = true;
+        lock.unlock();
+        fNotEmpty.notify_all();
+        fNotFull.notify_all();
+        return;
+    }
+
+    template< typename XItemType >
+    void KTConcurrentQueue< XItemType >::Reset()
+    {
+        std::unique_lock< std::mutex > lock(fMutex);
+        fItems.clear();
+        fClosed = false;
+        return;
+    }
+
+    template< typename XItemType >
+    inline bool KTConcurrentQueue< XItemType >::IsClosed() const
+    {
+        std::unique_lock< std::mutex > lock(fMutex);
+        return fClosed;
+    }
+
+    template< typename XItemType >
+    inline unsigned KTConcurrentQueue< XItemType >::Size() const
+    {
+        std::unique_lock< std::mutex > lock(fMutex);
+        return fItems.size();
+    }
+
+    template< typename XItemType >
+    inline unsigned KTConcurrentQueue< XItemType >::GetCapacity() const
+    {
+        return fCapacity;
+    }
+
+} /* namespace Katydid */
+#endif /* KTCONCURRENTQUEUE_HH_ */
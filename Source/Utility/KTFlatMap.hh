@@ -0,0 +1,336 @@
+/**
+ @file KTFlatMap.hh
+ @brief Contains KTFlatMap
+ @details Sorted associative container stored in a contiguous vector
+ @author: N.S. Oblath
+ @date: Oct 17, 2026
+ */
+
+#ifndef KTFLATMAP_HH_
+#define KTFLATMAP_HH_
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace Katydid
+{
+
+    /*!
+     @class KTFlatMap
+     @author N.S. Oblath
+
+     @brief Sorted associative container stored in a contiguous vector
+
+     @details
+     KTFlatMap provides the subset of the std::map interface used for sets of points (iteration in key order,
+     insert, find, lower/upper_bound, equal_range, erase), with the (key, value) pairs stored contiguously.
+     Iterating over the elements is a linear walk through memory, and there is no per-element allocation.
+
+     Inserting an element with a key larger than all existing keys is an append (amortized constant time);
+     inserting anywhere else costs O(N).  It is therefore intended for data that is produced in key order.
+
+     Unlike std::map, iterators are invalidated by insertions and erasures, and the key in an element
+     accessed through a non-const iterator must not be modified.
+
+     GetRange(min, max) returns the elements with keys in [min, max) with two binary searches.
+    */
+    template< typename XKeyType, typename XValueType, typename XCompare = std::less< XKeyType > >
+    class KTFlatMap
+    {
+        public:
+            typedef XKeyType key_type;
+            typedef XValueType mapped_type;
+            typedef std::pair< XKeyType, XValueType > value_type;
+            typedef XCompare key_compare;
+
+        private:
+            typedef std::vector< value_type > Storage;
+
+        public:
+            typedef typename Storage::size_type size_type;
+            typedef typename Storage::iterator iterator;
+            typedef typename Storage::const_iterator const_iterator;
+            typedef typename Storage::reverse_iterator reverse_iterator;
+            typedef typename Storage::const_reverse_iterator const_reverse_iterator;
+
+            typedef std::pair< const_iterator, const_iterator > const_range;
+
+        public:
+            KTFlatMap();
+            ~KTFlatMap();
+
+            iterator begin();
+            const_iterator begin() const;
+            iterator end();
+            const_iterator end() const;
+            reverse_iterator rbegin();
+            const_reverse_iterator rbegin() const;
+            reverse_iterator rend();
+            const_reverse_iterator rend() const;
+
+            bool empty() const;
+            size_type size() const;
+            void reserve(size_type capacity);
+            void clear();
+
+            /// Inserts the element if its key is not already present; returns the position of the element with that key, and whether the insertion happened
+            std::pair< iterator, bool > insert(const value_type& element);
+            /// Same as insert(element); the hint is ignored
+            iterator insert(const_iterator hint, const value_type& element);
+
+            iterator erase(iterator pos);
+            iterator erase(iterator first, iterator last);
+            size_type erase(const key_type& key);
+
+            iterator find(const key_type& key);
+            const_iterator find(const key_type& key) const;
+            size_type count(const key_type& key) const;
+
+            iterator lower_bound(const key_type& key);
+            const_iterator lower_bound(const key_type& key) const;
+            iterator upper_bound(const key_type& key);
+            const_iterator upper_bound(const key_type& key) const;
+            std::pair< iterator, iterator > equal_range(const key_type& key);
+            const_range equal_range(const key_type& key) const;
+
+            /// Returns the elements with keys in [minKey, maxKey)
+            const_range GetRange(const key_type& minKey, const key_type& maxKey) const;
+
+            /// Two maps are equal if they hold equivalent keys mapped to equal values (requires XValueType::operator==)
+            bool operator==(const KTFlatMap< XKeyType, XValueType, XCompare >& rhs) const;
+            bool operator!=(const KTFlatMap< XKeyType, XValueType, XCompare >& rhs) const;
+
+        private:
+            struct ElementCompare
+            {
+                XCompare fCompare;
+                bool operator()(const value_type& lhs, const key_type& rhs) const {return fCompare(lhs.first, rhs);}
+                bool operator()(const key_type& lhs, const value_type& rhs) const {return fCompare(lhs, rhs.first);}
+            };
+
+            Storage fElements;
+            ElementCompare fCompare;
+    };
+
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    KTFlatMap< XKeyType, XValueType, XCompare >::KTFlatMap() :
+            fElements(),
+            fCompare()
+    {
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    KTFlatMap< XKeyType, XValueType, XCompare >::~KTFlatMap()
+    {
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    inline typename KTFlatMap< XKeyType, XValueType, XCompare >::iterator KTFlatMap< XKeyType, XValueType, XCompare >::begin()
+    {
+        return fElements.begin();
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    inline typename KTFlatMap< XKeyType, XValueType, XCompare >::const_iterator KTFlatMap< XKeyType, XValueType, XCompare >::begin() const
+    {
+        return fElements.begin();
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    inline typename KTFlatMap< XKeyType, XValueType, XCompare >::iterator KTFlatMap< XKeyType, XValueType, XCompare >::end()
+    {
+        return fElements.end();
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    inline typename KTFlatMap< XKeyType, XValueType, XCompare >::const_iterator KTFlatMap< XKeyType, XValueType, XCompare >::end() const
+    {
+        return fElements.end();
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    inline typename KTFlatMap< XKeyType, XValueType, XCompare >::reverse_iterator KTFlatMap< XKeyType, XValueType, XCompare >::rbegin()
+    {
+        return fElements.rbegin();
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    inline typename KTFlatMap< XKeyType, XValueType, XCompare >::const_reverse_iterator KTFlatMap< XKeyType, XValueType, XCompare >::rbegin() const
+    {
+        return fElements.rbegin();
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    inline typename KTFlatMap< XKeyType, XValueType, XCompare >::reverse_iterator KTFlatMap< XKeyType, XValueType, XCompare >::rend()
+    {
+        return fElements.rend();
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    inline typename KTFlatMap< XKeyType, XValueType, XCompare >::const_reverse_iterator KTFlatMap< XKeyType, XValueType, XCompare >::rend() const
+    {
+        return fElements.rend();
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    inline bool KTFlatMap< XKeyType, XValueType, XCompare >::empty() const
+    {
+        return fElements.empty();
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    inline typename KTFlatMap< XKeyType, XValueType, XCompare >::size_type KTFlatMap< XKeyType, XValueType, XCompare >::size() const
+    {
+        return fElements.size();
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    inline void KTFlatMap< XKeyType, XValueType, XCompare >::reserve(size_type capacity)
+    {
+        fElements.reserve(capacity);
+        return;
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    inline void KTFlatMap< XKeyType, XValueType, XCompare >::clear()
+    {
+        fElements.clear();
+        return;
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    std::pair< typename KTFlatMap< XKeyType, XValueType, XCompare >::iterator, bool > KTFlatMap< XKeyType, XValueType, XCompare >::insert(const value_type& element)
+    {
+        // fast path: elements arriving in key order are appended
+        if (fElements.empty() || fCompare.fCompare(fElements.back().first, element.first))
+        {
+            fElements.push_back(element);
+            return std::make_pair(fElements.end() - 1, true);
+        }
+
+        iterator pos = lower_bound(element.first);
+        if (pos != fElements.end() && ! fCompare.fCompare(element.first, pos->first))
+        {
+            // key already present
+            return std::make_pair(pos, false);
+        }
+        return std::make_pair(fElements.insert(pos, element), true);
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    inline typename KTFlatMap< XKeyType, XValueType, XCompare >::iterator KTFlatMap< XKeyType, XValueType, XCompare >::insert(const_iterator, const value_type& element)
+    {
+        return insert(element).first;
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    inline typename KTFlatMap< XKeyType, XValueType, XCompare >::iterator KTFlatMap< XKeyType, XValueType, XCompare >::erase(iterator pos)
+    {
+        return fElements.erase(pos);
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    inline typename KTFlatMap< XKeyType, XValueType, XCompare >::iterator KTFlatMap< XKeyType, XValueType, XCompare >::erase(iterator first, iterator last)
+    {
+        return fElements.erase(first, last);
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    typename KTFlatMap< XKeyType, XValueType, XCompare >::size_type KTFlatMap< XKeyType, XValueType, XCompare >::erase(const key_type& key)
+    {
+        iterator pos = find(key);
+        if (pos == fElements.end()) return 0;
+        fElements.erase(pos);
+        return 1;
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    typename KTFlatMap< XKeyType, XValueType, XCompare >::iterator KTFlatMap< XKeyType, XValueType, XCompare >::find(const key_type& key)
+    {
+        iterator pos = lower_bound(key);
+        if (pos != fElements.end() && ! fCompare.fCompare(key, pos->first)) return pos;
+        return fElements.end();
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    typename KTFlatMap< XKeyType, XValueType, XCompare >::const_iterator KTFlatMap< XKeyType, XValueType, XCompare >::find(const key_type& key) const
+    {
+        const_iterator pos = lower_bound(key);
+        if (pos != fElements.end() && ! fCompare.fCompare(key, pos->first)) return pos;
+        return fElements.end();
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    inline typename KTFlatMap< XKeyType, XValueType, XCompare >::size_type KTFlatMap< XKeyType, XValueType, XCompare >::count(const key_type& key) const
+    {
+        return find(key) == fElements.end() ? 0 : 1;
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    inline typename KTFlatMap< XKeyType, XValueType, XCompare >::iterator KTFlatMap< XKeyType, XValueType, XCompare >::lower_bound(const key_type& key)
+    {
+        return std::lower_bound(fElements.begin(), fElements.end(), key, fCompare);
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    inline typename KTFlatMap< XKeyType, XValueType, XCompare >::const_iterator KTFlatMap< XKeyType, XValueType, XCompare >::lower_bound(const key_type& key) const
+    {
+        return std::lower_bound(fElements.begin(), fElements.end(), key, fCompare);
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    inline typename KTFlatMap< XKeyType, XValueType, XCompare >::iterator KTFlatMap< XKeyType, XValueType, XCompare >::upper_bound(const key_type& key)
+    {
+        return std::upper_bound(fElements.begin(), fElements.end(), key, fCompare);
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    inline typename KTFlatMap< XKeyType, XValueType, XCompare >::const_iterator KTFlatMap< XKeyType, XValueType, XCompare >::upper_bound(const key_type& key) const
+    {
+        return std::upper_bound(fElements.begin(), fElements.end(), key, fCompare);
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    inline std::pair< typename KTFlatMap< XKeyType, XValueType, XCompare >::iterator, typename KTFlatMap< XKeyType, XValueType, XCompare >::iterator > KTFlatMap< XKeyType, XValueType, XCompare >::equal_range(const key_type& key)
+    {
+        return std::equal_range(fElements.begin(), fElements.end(), key, fCompare);
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    inline typename KTFlatMap< XKeyType, XValueType, XCompare >::const_range KTFlatMap< XKeyType, XValueType, XCompare >::equal_range(const key_type& key) const
+    {
+        return std::equal_range(fElements.begin(), fElements.end(), key, fCompare);
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    typename KTFlatMap< XKeyType, XValueType, XCompare >::const_range KTFlatMap< XKeyType, XValueType, XCompare >::GetRange(const key_type& minKey, const key_type& maxKey) const
+    {
+        const_iterator first = lower_bound(minKey);
+        const_iterator last = std::lower_bound(first, fElements.end(), maxKey, fCompare);
+        return const_range(first, last);
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    bool KTFlatMap< XKeyType, XValueType, XCompare >::operator==(const KTFlatMap< XKeyType, XValueType, XCompare >& rhs) const
+    {
+        if (fElements.size() != rhs.fElements.size()) return false;
+        for (const_iterator lIt = fElements.begin(), rIt = rhs.fElements.begin(); lIt != fElements.end(); ++lIt, ++rIt)
+        {
+            if (fCompare.fCompare(lIt->first, rIt->first) || fCompare.fCompare(rIt->first, lIt->first)) return false;
+            if (! (lIt->second == rIt->second)) return false;
+        }
+        return true;
+    }
+
+    template< typename XKeyType, typename XValueType, typename XCompare >
+    inline bool KTFlatMap< XKeyType, XValueType, XCompare >::operator!=(const KTFlatMap< XKeyType, XValueType, XCompare >& rhs) const
+    {
+        return ! (*this == rhs);
+    }
+
+} /* namespace Katydid */
+
+#endif /* KTFLATMAP_HH_ */
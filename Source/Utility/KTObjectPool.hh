@@ -0,0 +1,201 @@
+/**
+ @file KTObjectPool.hh
+ @brief Contains KTObjectPool
+ @details Thread-safe, size-keyed pool of recycled objects
+ @author: N.S. Oblath
+ @date: Oct 17, 2026
+ */
+
+#ifndef KTOBJECTPOOL_HH_
+#define KTOBJECTPOOL_HH_
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <typeinfo>
+#include <vector>
+
+namespace Katydid
+{
+
+    /*!
+     @class KTObjectPool
+     @author N.S. Oblath
+
+     @brief Thread-safe, size-keyed pool of recycled objects
+
+     @details
+     Objects that are no longer needed are given to the pool with Give(), and can be reused with Take().
+     Objects are stored by key (usually the number of bins), so only objects with matching allocations are handed out.
+     The pool does not reset the objects; that's the responsibility of the class that uses the pool.
+
+     There is one pool per object/key type, accessed with GetInstance().
+     The pools are never destroyed, so they can be used safely while other static objects are being destroyed.
+
+     At most fCapacity objects are kept for each key; objects given to a full pool are deleted.
+     A capacity of 0 disables the pool.
+
+     Only objects whose dynamic type is exactly XObjectType are kept; objects of derived types are deleted.
+    */
+    template< typename XObjectType, typename XKeyType = size_t >
+    class KTObjectPool
+    {
+        public:
+            static KTObjectPool< XObjectType, XKeyType >& GetInstance();
+
+            ~KTObjectPool();
+
+            /// Returns an object stored with the given key, or NULL if there isn't one
+            XObjectType* Take(const XKeyType& key);
+            /// Stores an object with the given key; the pool takes ownership of the object
+            void Give(XObjectType* object, const XKeyType& key);
+
+            /// Delete all stored objects
+            void Clear();
+
+            unsigned GetCapacity() const;
+            /// Sets the maximum number of objects stored for each key; objects beyond the new capacity are deleted
+            void SetCapacity(unsigned capacity);
+
+            unsigned GetNHits() const;
+            unsigned GetNMisses() const;
+
+        private:
+            KTObjectPool();
+            KTObjectPool(const KTObjectPool< XObjectType, XKeyType >&) = delete;
+            KTObjectPool< XObjectType, XKeyType >& operator=(const KTObjectPool< XObjectType, XKeyType >&) = delete;
+
+            void ClearNoLock();
+
+            typedef std::map< XKeyType, std::vector< XObjectType* > > Store;
+            Store fStore;
+
+            unsigned fCapacity;
+            unsigned fNHits;
+            unsigned fNMisses;
+
+            mutable std::mutex fMutex;
+    };
+
+
+    template< typename XObjectType, typename XKeyType >
+    KTObjectPool< XObjectType, XKeyType >& KTObjectPool< XObjectType, XKeyType >::GetInstance()
+    {
+        // never destroyed, since the destruction order of statics is undefined and other statics may give objects back at exit;
+        // the stored objects are reclaimed with the rest of the process memory (use Clear() to delete them earlier)
+        static KTObjectPool< XObjectType, XKeyType >* sInstance = new KTObjectPool< XObjectType, XKeyType >();
+        return *sInstance;
+    }
+
+    template< typename XObjectType, typename XKeyType >
+    KTObjectPool< XObjectType, XKeyType >::KTObjectPool() :
+            fStore(),
+            fCapacity(16),
+            fNHits(0),
+            fNMisses(0),
+            fMutex()
+    {
+    }
+
+    template< typename XObjectType, typename XKeyType >
+    KTObjectPool< XObjectType, XKeyType >::~KTObjectPool()
+    {
+        ClearNoLock();
+    }
+
+    template< typename XObjectType, typename XKeyType >
+    XObjectType* KTObjectPool< XObjectType, XKeyType >::Take(const XKeyType& key)
+    {
+        std::unique_lock< std::mutex > lock(fMutex);
+        typename Store::iterator it = fStore.find(key);
+        if (it == fStore.end() || it->second.empty())
+        {
+            ++fNMisses;
+            return NULL;
+        }
+        XObjectType* object = it->second.back();
+        it->second.pop_back();
+        ++fNHits;
+        return object;
+    }
+
+    template< typename XObjectType, typename XKeyType >
+    void KTObjectPool< XObjectType, XKeyType >::Give(XObjectType* object, const XKeyType& key)
+    {
+        if (object == NULL) return;
+        if (typeid(*object) == typeid(XObjectType))
+        {
+            std::unique_lock< std::mutex > lock(fMutex);
+            std::vector< XObjectType* >& objects = fStore[key];
+            if (objects.size() < fCapacity)
+            {
+                objects.push_back(object);
+                return;
+            }
+        }
+        delete object;
+        return;
+    }
+
+    template< typename XObjectType, typename XKeyType >
+    void KTObjectPool< XObjectType, XKeyType >::Clear()
+    {
+        std::unique_lock< std::mutex > lock(fMutex);
+        ClearNoLock();
+        return;
+    }
+
+    template< typename XObjectType, typename XKeyType >
+    void KTObjectPool< XObjectType, XKeyType >::ClearNoLock()
+    {
+        for (typename Store::iterator it = fStore.begin(); it != fStore.end(); ++it)
+        {
+            for (typename std::vector< XObjectType* >::iterator oIt = it->second.begin(); oIt != it->second.end(); ++oIt)
+            {
+                delete *oIt;
+            }
+        }
+        fStore.clear();
+        return;
+    }
+
+    template< typename XObjectType, typename XKeyType >
+    unsigned KTObjectPool< XObjectType, XKeyType >::GetCapacity() const
+    {
+        std::unique_lock< std::mutex > lock(fMutex);
+        return fCapacity;
+    }
+
+    template< typename XObjectType, typename XKeyType >
+    void KTObjectPool< XObjectType, XKeyType >::SetCapacity(unsigned capacity)
+    {
+        std::unique_lock< std::mutex > lock(fMutex);
+        fCapacity = capacity;
+        for (typename Store::iterator it = fStore.begin(); it != fStore.end(); ++it)
+        {
+            while (it->second.size() > fCapacity)
+            {
+                delete it->second.back();
+                it->second.pop_back();
+            }
+        }
+        return;
+    }
+
+    template< typename XObjectType, typename XKeyType >
+    unsigned KTObjectPool< XObjectType, XKeyType >::GetNHits() const
+    {
+        std::unique_lock< std::mutex > lock(fMutex);
+        return fNHits;
+    }
+
+    template< typename XObjectType, typename XKeyType >
+    unsigned KTObjectPool< XObjectType, XKeyType >::GetNMisses() const
+    {
+        std::unique_lock< std::mutex > lock(fMutex);
+        return fNMisses;
+    }
+
+} /* namespace Katydid */
+
+#endif /* KTOBJECTPOOL_HH_ */
@@ -0,0 +1,52 @@
+/*
+ * KTParallelQuery.hh
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: nsoblath
+ *
+ *  Helpers for running read-only queries (e.g. k-d tree searches) over a set of points with OpenMP,
+ *  where each thread collects the indices of the points it selects in its own buffer.
+ */
+
+#ifndef KTPARALLELQUERY_HH_
+#define KTPARALLELQUERY_HH_
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace Katydid
+{
+
+    namespace KTParallelQuery
+    {
+        /// Number of threads to use: nRequested if it's non-zero, and the OpenMP default otherwise; always 1 without OpenMP
+        inline unsigned NThreads(unsigned nRequested)
+        {
+#ifdef USE_OPENMP
+            return nRequested > 0 ? nRequested : omp_get_max_threads();
+#else
+            return 1;
+#endif
+        }
+
+        /// Merges the per-thread buffers into indices, in increasing order.
+        /// The points are usually handed out to the threads dynamically, so sorting gives the same order as a serial pass.
+        inline void MergeIndices(const std::vector< std::vector< size_t > >& threadIndices, std::vector< size_t >& indices)
+        {
+            indices.clear();
+            for (unsigned iThread = 0; iThread < threadIndices.size(); ++iThread)
+            {
+                indices.insert(indices.end(), threadIndices[iThread].begin(), threadIndices[iThread].end());
+            }
+            std::sort(indices.begin(), indices.end());
+            return;
+        }
+    }
+
+} /* namespace Katydid */
+#endif /* KTPARALLELQUERY_HH_ */
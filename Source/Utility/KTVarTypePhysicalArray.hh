@@ -154,6 +154,9 @@ namespace Katydid
                        It is the template argument for the class.
                        If you want to change the interface type, you need to create a new interface object with the interface-only constructor (copyData = false).
 
+     A view (see the view constructor) reads storage that it doesn't own; it is read-only if that was requested when it was constructed,
+     e.g. when the storage is a buffer shared with other objects.  Interface-only arrays share the storage of the original array, and are read-only if it is.
+     For read-only arrays, SetAt() and the non-const GetStorage() throw a Nymph::KTException; the const GetStorage() can always be used to read the data.
     */
     template< typename XInterfaceType >
     class KTVarTypePhysicalArray : public KTAxisProperties< 1 >
@@ -161,6 +164,7 @@ namespace Katydid
         public:
             typedef uint8_t storage_value_type;
             typedef uint8_t* storage_type;
+            typedef const uint8_t* const_storage_type;
             typedef XInterfaceType ifc_value_type;
 
         private:
@@ -183,18 +187,35 @@ namespace Katydid
             /// Axis range values do not have default values to avoid ambiguous function signatures
             KTVarTypePhysicalArray(size_t dataTypeSize, uint32_t dataFormat, size_t nBins, double rangeMin, double rangeMax);
 
-            /// Interface-only (copyData = false) or copy (copyData = true; default) constructor
+            /// View constructor: the array uses the given storage, which it does not own, and which must outlive the array
+            /// If readOnly is true, the storage is never written through the array
+            /// Axis range values do not have default values to avoid ambiguous function signatures
+            KTVarTypePhysicalArray(storage_type data, size_t dataTypeSize, uint32_t dataFormat, size_t nBins, double rangeMin, double rangeMax, bool readOnly);
+
+            /// Interface-only (copyData = false; read-only if the original is) or copy (copyData = true; default) constructor
             template< typename XOrigInterfaceType >
             KTVarTypePhysicalArray(const KTVarTypePhysicalArray< XOrigInterfaceType >& orig, bool copyData = true);
 
+            /// Copy constructor; the copy owns a copy of the data
+            /// (the implicit copy constructor would otherwise be chosen over the template for arrays of the same interface type, and share the storage)
+            KTVarTypePhysicalArray(const KTVarTypePhysicalArray< XInterfaceType >& orig);
+
             virtual ~KTVarTypePhysicalArray();
 
+            /// The array owns a copy of the data after assignment
             template< typename XOrigInterfaceType >
             KTVarTypePhysicalArray& operator=(const KTVarTypePhysicalArray< XOrigInterfaceType >& rhs);
+            KTVarTypePhysicalArray& operator=(const KTVarTypePhysicalArray< XInterfaceType >& rhs);
 
         public:
-            const storage_type& GetStorage() const;
-            storage_type& GetStorage();
+            const_storage_type GetStorage() const;
+            /// Throws a Nymph::KTException if the array is read-only
+            storage_type GetStorage();
+
+            /// Returns true if the array owns its storage (false for views and interface-only arrays)
+            bool GetOwnsStorage() const;
+            /// Returns true if the storage can't be written through the array
+            bool GetReadOnly() const;
 
             size_t GetNBytes() const;
             size_t GetDataTypeSize() const;
@@ -202,6 +223,7 @@ namespace Katydid
 
         protected:
             bool fOwnsStorage;
+            bool fReadOnly;
 
             // storage_type is always uint8_t
             union
@@ -254,6 +276,7 @@ namespace Katydid
             void SetAtI8( ifc_value_type value, unsigned index );
             void SetAtF4( ifc_value_type value, unsigned index );
             void SetAtF8( ifc_value_type value, unsigned index );
+            void SetAtReadOnly( ifc_value_type value, unsigned index );
 
             void (KTVarTypePhysicalArray< XInterfaceType >::*fArraySetFcn)( XInterfaceType, unsigned );
 
@@ -263,6 +286,7 @@ namespace Katydid
     KTVarTypePhysicalArray< XInterfaceType >::KTVarTypePhysicalArray() :
             KTAxisProperties< 1 >(),
             fOwnsStorage(true),
+            fReadOnly(false),
             fUByteData(new uint8_t [1]),
             fNBytes(0),
             fDataTypeSize(0),
@@ -279,6 +303,7 @@ namespace Katydid
     KTVarTypePhysicalArray< XInterfaceType >::KTVarTypePhysicalArray(size_t nBins, double rangeMin, double rangeMax) :
             KTAxisProperties< 1 >(rangeMin, rangeMax),
             fOwnsStorage(true),
+            fReadOnly(false),
             fUByteData(reinterpret_cast< uint8_t* >(new XDataType[ nBins ])),
             fNBytes(nBins * sizeof(XDataType)),
             fDataTypeSize(0),
@@ -310,6 +335,7 @@ namespace Katydid
     KTVarTypePhysicalArray< XInterfaceType >::KTVarTypePhysicalArray(size_t dataTypeSize, uint32_t dataFormat, size_t nBins, double rangeMin, double rangeMax) :
             KTAxisProperties< 1 >(rangeMin, rangeMax),
             fOwnsStorage(true),
+            fReadOnly(false),
             fUByteData(new uint8_t[ nBins * dataTypeSize ]),
             fNBytes(nBins * dataTypeSize),
             fDataTypeSize(dataTypeSize),
@@ -326,11 +352,33 @@ namespace Katydid
     }
 
 
+    template< typename XInterfaceType >
+    KTVarTypePhysicalArray< XInterfaceType >::KTVarTypePhysicalArray(storage_type data, size_t dataTypeSize, uint32_t dataFormat, size_t nBins, double rangeMin, double rangeMax, bool readOnly) :
+            KTAxisProperties< 1 >(rangeMin, rangeMax),
+            fOwnsStorage(false),
+            fReadOnly(readOnly),
+            fUByteData(data),
+            fNBytes(nBins * dataTypeSize),
+            fDataTypeSize(dataTypeSize),
+            fDataFormat(dataFormat),
+            fArrayGetFcn(NULL),
+            fArraySetFcn(NULL)
+    {
+        try
+        {
+            SetInterfaceFunctions( dataTypeSize, dataFormat );
+        }
+        catch( Nymph::KTException& e ) {throw e;}
+        SetNBinsFunc(new KTNBinsInArray< 1, FixedSize >(nBins));
+    }
+
+
     template< typename XInterfaceType >
     template< typename XOrigInterfaceType >
     KTVarTypePhysicalArray< XInterfaceType >::KTVarTypePhysicalArray(const KTVarTypePhysicalArray< XOrigInterfaceType >& orig, bool copyData) :
             KTAxisProperties< 1 >(orig),
             fOwnsStorage(copyData),
+            fReadOnly(! copyData && orig.GetReadOnly()),
             fUByteData(NULL),
             fNBytes(orig.GetNBytes()),
             fDataTypeSize(orig.GetDataTypeSize()),
@@ -347,11 +395,19 @@ namespace Katydid
         }
         else
         {
-            fUByteData = orig.GetStorage();
+            // the storage is never written through the interface if the original is read-only (see SetAtReadOnly and GetStorage)
+            fUByteData = const_cast< storage_type >(orig.GetStorage());
         }
     }
 
 
+    template< typename XInterfaceType >
+    KTVarTypePhysicalArray< XInterfaceType >::KTVarTypePhysicalArray(const KTVarTypePhysicalArray< XInterfaceType >& orig) :
+            KTVarTypePhysicalArray< XInterfaceType >(orig, true)
+    {
+    }
+
+
     template< typename XInterfaceType >
     KTVarTypePhysicalArray< XInterfaceType >::~KTVarTypePhysicalArray()
     {
@@ -366,20 +422,34 @@ namespace Katydid
     template< typename XOrigInterfaceType >
     KTVarTypePhysicalArray< XInterfaceType >& KTVarTypePhysicalArray< XInterfaceType >::operator=(const KTVarTypePhysicalArray< XOrigInterfaceType >& rhs)
     {
-        SetNBinsFunc(new KTNBinsInArray< 1, FixedSize >(rhs.size()));
+        if (static_cast< const void* >(&rhs) == static_cast< const void* >(this)) return *this;
 
-        fDataTypeSize = rhs.GetDataTypeSize();
-        fDataFormat = rhs.GetDataFormat();
-        SetInterfaceFunctions( fDataTypeSize, fDataFormat );
+        SetNBinsFunc(new KTNBinsInArray< 1, FixedSize >(rhs.size()));
 
+        // the result always owns a copy of the data, even if either array was a view
+        if (! fOwnsStorage || fNBytes != rhs.GetNBytes())
+        {
+            if (fOwnsStorage) delete [] fUByteData;
+            fUByteData = new uint8_t[ rhs.GetNBytes() ];
+        }
         fOwnsStorage = true;
+        fReadOnly = false;
         fNBytes = rhs.GetNBytes();
-        fUByteData = new uint8_t[ fNBytes ];
         memcpy( fUByteData, rhs.GetStorage(), fNBytes );
 
+        fDataTypeSize = rhs.GetDataTypeSize();
+        fDataFormat = rhs.GetDataFormat();
+        SetInterfaceFunctions( fDataTypeSize, fDataFormat );
+
         return *this;
     }
 
+    template< typename XInterfaceType >
+    KTVarTypePhysicalArray< XInterfaceType >& KTVarTypePhysicalArray< XInterfaceType >::operator=(const KTVarTypePhysicalArray< XInterfaceType >& rhs)
+    {
+        return operator=< XInterfaceType >(rhs);
+    }
+
 
     template< typename XInterfaceType >
     void KTVarTypePhysicalArray< XInterfaceType >::SetInterfaceFunctions( unsigned aDataTypeSize, uint32_t aDataFormat )
@@ -459,24 +529,45 @@ namespace Katydid
         {
             throw Nymph::KTException() << "Invalid combination of data format <" << aDataFormat << ">, data type size <" << aDataTypeSize << ">";
         }
+
+        if (fReadOnly)
+        {
+            fArraySetFcn = &KTVarTypePhysicalArray< XInterfaceType >::SetAtReadOnly;
+        }
         return;
     }
 
 
     template< typename XInterfaceType >
-    inline const typename KTVarTypePhysicalArray< XInterfaceType >::storage_type& KTVarTypePhysicalArray< XInterfaceType >::GetStorage() const
+    inline typename KTVarTypePhysicalArray< XInterfaceType >::const_storage_type KTVarTypePhysicalArray< XInterfaceType >::GetStorage() const
     {
         return fUByteData;
     }
 
 
     template< typename XInterfaceType >
-    inline typename KTVarTypePhysicalArray< XInterfaceType >::storage_type& KTVarTypePhysicalArray< XInterfaceType >::GetStorage()
+    inline typename KTVarTypePhysicalArray< XInterfaceType >::storage_type KTVarTypePhysicalArray< XInterfaceType >::GetStorage()
     {
+        if (fReadOnly)
+        {
+            throw Nymph::KTException() << "Unable to give write access to read-only storage";
+        }
         return fUByteData;
     }
 
 
+    template< typename XInterfaceType >
+    inline bool KTVarTypePhysicalArray< XInterfaceType >::GetOwnsStorage() const
+    {
+        return fOwnsStorage;
+    }
+
+    template< typename XInterfaceType >
+    inline bool KTVarTypePhysicalArray< XInterfaceType >::GetReadOnly() const
+    {
+        return fReadOnly;
+    }
+
     template< typename XInterfaceType >
     inline size_t KTVarTypePhysicalArray< XInterfaceType >::GetNBytes() const
     {
@@ -635,5 +726,11 @@ namespace Katydid
         fF8BytesData[ index ] = value;
     }
 
+    template< typename XInterfaceType >
+    void KTVarTypePhysicalArray< XInterfaceType >::SetAtReadOnly( XInterfaceType, unsigned index )
+    {
+        throw Nymph::KTException() << "Unable to set bin " << index << " of a read-only array";
+    }
+
 } /* namespace Katydid */
 #endif /* KTVARTYPEPHYSICALARRAY_HH_ */